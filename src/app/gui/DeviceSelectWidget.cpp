@@ -22,6 +22,7 @@ DeviceSelectWidget::DeviceSelectWidget(QWidget *parent)
     , m_disconnectButton(nullptr)
     , m_statusLabel(nullptr)
     , m_autoRefreshTimer(nullptr)
+    , m_deviceMonitor(nullptr)
     , m_connected(false)
     , m_autoRefresh(false)
     , m_autoRefreshInterval(30000)  // 30 seconds
@@ -32,6 +33,11 @@ DeviceSelectWidget::DeviceSelectWidget(QWidget *parent)
     m_autoRefreshTimer = new QTimer(this);
     connect(m_autoRefreshTimer, &QTimer::timeout, this, &DeviceSelectWidget::onAutoRefreshTimer);
 
+    // Refresh when drives come and go; the timer is only a fallback
+    m_deviceMonitor = new DeviceMonitor(this);
+    connect(m_deviceMonitor, &DeviceMonitor::devicesChanged, this, &DeviceSelectWidget::refreshDevices);
+    m_deviceMonitor->start();
+
     // Initial device scan
     refreshDevices();
 }
@@ -104,7 +110,7 @@ void DeviceSelectWidget::setSelectedDevice(const QString &devicePath)
 void DeviceSelectWidget::setAutoRefresh(bool enable)
 {
     m_autoRefresh = enable;
-    if (enable && !m_connected) {
+    if (enable && !m_connected && !m_deviceMonitor->isActive()) {
         m_autoRefreshTimer->start(m_autoRefreshInterval);
     } else {
         m_autoRefreshTimer->stop();
@@ -115,14 +121,16 @@ void DeviceSelectWidget::refreshDevices()
 {
     QString currentDevice = selectedDevice();
 
-    m_devices = device::DeviceEnumerator::enumerate();
+    // Only devices not seen before are queried
+    m_enumerator.refresh();
+    m_devices = m_enumerator.tapeDevices();
 
     m_deviceCombo->clear();
-    for (const device::DeviceInfo &dev : m_devices) {
+    for (const TapeDeviceInfo &dev : m_devices) {
         QString displayText = QString("%1 - %2 %3")
             .arg(dev.devicePath)
             .arg(dev.vendor)
-            .arg(dev.model);
+            .arg(dev.product);
         m_deviceCombo->addItem(displayText, dev.devicePath);
     }
 
@@ -148,7 +156,7 @@ void DeviceSelectWidget::setConnected(bool connected)
     } else {
         m_statusLabel->setStyleSheet("color: gray;");
         m_statusLabel->setToolTip(tr("Not connected"));
-        if (m_autoRefresh) {
+        if (m_autoRefresh && !m_deviceMonitor->isActive()) {
             m_autoRefreshTimer->start(m_autoRefreshInterval);
         }
     }
@@ -17,7 +17,8 @@
 #include <QHBoxLayout>
 #include <QTimer>
 
-#include "DeviceEnumerator.h"
+#include "device/DeviceEnumerator.h"
+#include "device/DeviceMonitor.h"
 
 namespace qltfs {
 namespace app {
@@ -27,7 +28,7 @@ namespace app {
  *
  * A reusable widget for selecting tape devices, featuring:
  * - Dropdown list of available devices
- * - Refresh button
+ * - Refresh button, and refresh on device hotplug
  * - Connect/Disconnect buttons
  * - Device status indicator
  */
@@ -67,7 +68,7 @@ public:
     /**
      * @brief Get the list of available devices
      */
-    QList<device::DeviceInfo> availableDevices() const { return m_devices; }
+    QList<TapeDeviceInfo> availableDevices() const { return m_devices; }
 
 signals:
     /**
@@ -123,7 +124,9 @@ private:
     QLabel *m_statusLabel;
     QTimer *m_autoRefreshTimer;
 
-    QList<device::DeviceInfo> m_devices;
+    DeviceEnumerator m_enumerator;
+    DeviceMonitor *m_deviceMonitor;
+    QList<TapeDeviceInfo> m_devices;
     bool m_connected;
     bool m_autoRefresh;
     int m_autoRefreshInterval;
@@ -11,8 +11,7 @@
 #define FILEBROWSERDIALOG_H
 
 #include <QDialog>
-#include <QTreeWidget>
-#include <QTreeWidgetItem>
+#include <QTreeView>
 #include <QPushButton>
 #include <QCheckBox>
 #include <QVBoxLayout>
@@ -24,48 +23,19 @@
 #include <QInputDialog>
 #include <QMessageBox>
 #include <QRegularExpression>
-#include <QMutex>
 #include <QScopedPointer>
 
-#include "LtfsIndex.h"
+#include "IndexTreeModel.h"
 
 namespace qltfs {
 namespace app {
 
-/**
- * @brief Extended TreeWidget with tri-state checkbox support
- *
- * This class extends QTreeWidget to support three-state checkboxes
- * (Checked, Unchecked, Indeterminate) similar to the VB.NET TreeViewEx.
- */
-class TreeWidgetEx : public QTreeWidget
-{
-    Q_OBJECT
-
-public:
-    explicit TreeWidgetEx(QWidget *parent = nullptr);
-    virtual ~TreeWidgetEx() = default;
-
-    /**
-     * @brief Set the check state for a specific item
-     * @param item The tree item to modify
-     * @param state The check state to set
-     */
-    void setItemCheckState(QTreeWidgetItem *item, Qt::CheckState state);
-
-    /**
-     * @brief Get the check state for a specific item
-     * @param item The tree item to query
-     * @return The current check state
-     */
-    Qt::CheckState itemCheckState(QTreeWidgetItem *item) const;
-};
-
 /**
  * @brief FileBrowserDialog - Complete file browser dialog with checkbox selection
  *
  * This dialog provides a tree-based file browser for LTFS index contents.
- * It supports:
+ * Rows are served lazily by an IndexTreeModel, so large indexes open
+ * without creating an item per file. It supports:
  * - Tri-state checkboxes (Checked, Unchecked, Indeterminate)
  * - Recursive selection (selecting a folder selects all children)
  * - Selection by file size range
@@ -125,17 +95,10 @@ protected:
 private slots:
     /**
      * @brief Handle tree item selection change
-     * @param current Currently selected item
-     * @param previous Previously selected item
-     */
-    void onItemSelectionChanged(QTreeWidgetItem *current, QTreeWidgetItem *previous);
-
-    /**
-     * @brief Handle tree item check state change
-     * @param item The item whose check state changed
-     * @param column The column (always 0)
+     * @param current Currently selected row
+     * @param previous Previously selected row
      */
-    void onItemChanged(QTreeWidgetItem *item, int column);
+    void onItemSelectionChanged(const QModelIndex &current, const QModelIndex &previous);
 
     /**
      * @brief Handle OK button click
@@ -189,57 +152,9 @@ private:
      */
     void saveSettings();
 
-    /**
-     * @brief Populate tree from LTFS index
-     */
-    void populateTree();
-
-    /**
-     * @brief Add contents to tree (recursive helper)
-     * @param parent Parent tree item (nullptr for root)
-     * @param directories List of directories to add
-     * @param files List of files to add
-     */
-    void addContents(QTreeWidgetItem *parent,
-                     const QList<core::LtfsDirectoryEntry> &directories,
-                     const QList<core::LtfsFileEntry> &files);
-
-    /**
-     * @brief Recursively set check state for an item and all its children
-     * @param item The item to set
-     * @param checked Whether to check or uncheck
-     */
-    void recursivelySetCheckState(QTreeWidgetItem *item, bool checked);
-
-    /**
-     * @brief Refresh check state for an item based on its children
-     * @param item The item to refresh
-     * @return The resulting check state
-     */
-    Qt::CheckState refreshCheckState(QTreeWidgetItem *item);
-
-    /**
-     * @brief Update the Selected property in the underlying index data
-     * @param item The tree item
-     * @param selected The selection state
-     */
-    void updateIndexSelection(QTreeWidgetItem *item, bool selected);
-
-    /**
-     * @brief Get all leaf nodes (files) in the tree
-     * @return List of all file tree items
-     */
-    QList<QTreeWidgetItem *> getAllLeafNodes() const;
-
-    /**
-     * @brief Get all leaf nodes recursively from a starting item
-     * @param item Starting item
-     * @param result Output list
-     */
-    void collectLeafNodes(QTreeWidgetItem *item, QList<QTreeWidgetItem *> &result) const;
-
     // UI Components
-    TreeWidgetEx *m_treeWidget;
+    QTreeView *m_treeView;
+    IndexTreeModel *m_model;
     QPushButton *m_okButton;
     QPushButton *m_cancelButton;
     QCheckBox *m_copyInfoCheckBox;
@@ -250,22 +165,6 @@ private:
 
     // Data
     core::LtfsIndex *m_index;
-
-    // Event lock to prevent recursive event handling
-    QMutex m_eventLock;
-    bool m_isUpdating;
-
-    // Tag data types for tree items
-    enum class ItemType {
-        Directory,
-        File
-    };
-
-    // Custom roles for tree item data
-    static constexpr int ItemTypeRole = Qt::UserRole;
-    static constexpr int DirectoryIndexRole = Qt::UserRole + 1;
-    static constexpr int FileIndexRole = Qt::UserRole + 2;
-    static constexpr int PathRole = Qt::UserRole + 3;
 };
 
 } // namespace app
@@ -0,0 +1,457 @@
+/*
+ * QLTOTapeMan - Qt-based LTO Tape Manager
+ *
+ * Copyright (c) 2026 Jeffrey ZHU (zhxsh1225@gmail.com)
+ * https://github.com/Gypsop/QLTOTapeMan
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "IndexTreeModel.h"
+
+#include <QFileIconProvider>
+
+namespace qltfs {
+namespace app {
+
+// Rows a directory exposes per fetchMore()
+static constexpr int FETCH_BATCH_SIZE = 1000;
+
+namespace {
+
+/**
+ * @brief Directories and files below (not including) a directory
+ */
+quint32 countNodes(const QList<core::LtfsDirectoryEntry> &directories,
+                   const QList<core::LtfsFileEntry> &files)
+{
+    quint32 count = static_cast<quint32>(directories.size() + files.size());
+    for (const core::LtfsDirectoryEntry &dir : directories) {
+        count += countNodes(dir.subdirectories, dir.files);
+    }
+    return count;
+}
+
+} // namespace
+
+IndexTreeModel::IndexTreeModel(QObject *parent)
+    : QAbstractItemModel(parent)
+    , m_index(nullptr)
+{
+    QFileIconProvider iconProvider;
+    m_folderIcon = iconProvider.icon(QFileIconProvider::Folder);
+    m_fileIcon = iconProvider.icon(QFileIconProvider::File);
+}
+
+void IndexTreeModel::setIndex(const core::LtfsIndex *index)
+{
+    beginResetModel();
+
+    m_index = index;
+    m_dirs.clear();
+    m_childDirs.clear();
+    m_checked.clear();
+    m_rootDirectories.clear();
+    m_rootFiles.clear();
+
+    if (m_index) {
+        m_rootDirectories = m_index->directories();
+        m_rootFiles = m_index->files();
+
+        // One walk over the entries assigns node IDs and counts; no rows
+        // are created until a view fetches them
+        m_checked.resize(static_cast<qsizetype>(countNodes(m_rootDirectories, m_rootFiles)) + 1);
+        quint32 nextId = 0;
+        build(nullptr, m_rootDirectories, m_rootFiles, -1, 0, nextId);
+    }
+
+    endResetModel();
+}
+
+int IndexTreeModel::build(const core::LtfsDirectoryEntry *entry,
+                          const QList<core::LtfsDirectoryEntry> &subdirectories,
+                          const QList<core::LtfsFileEntry> &files,
+                          int parent, int row, quint32 &nextId)
+{
+    const int ordinal = m_dirs.size();
+
+    DirNode node;
+    node.entry = entry;
+    node.subdirectories = &subdirectories;
+    node.files = &files;
+    node.parent = parent;
+    node.row = row;
+    node.nodeId = nextId++;
+    node.firstChild = m_childDirs.size();
+    m_dirs.append(node);
+    m_childDirs.resize(m_childDirs.size() + subdirectories.size());
+
+    // Subdirectory subtrees come first, then the directory's own files,
+    // matching the row order
+    quint32 totalFiles = static_cast<quint32>(files.size());
+    quint32 checkedFiles = 0;
+    for (int i = 0; i < subdirectories.size(); ++i) {
+        const core::LtfsDirectoryEntry &dir = subdirectories[i];
+        const int child = build(&dir, dir.subdirectories, dir.files, ordinal, i, nextId);
+        m_childDirs[node.firstChild + i] = child;
+        totalFiles += m_dirs[child].totalFiles;
+        checkedFiles += m_dirs[child].checkedFiles;
+    }
+
+    const quint32 fileBase = nextId;
+    for (int i = 0; i < files.size(); ++i) {
+        if (files[i].selected) {
+            m_checked.setBit(fileBase + i);
+            checkedFiles++;
+        }
+    }
+    nextId += static_cast<quint32>(files.size());
+
+    // Directories with nothing below keep their own state
+    if (entry && entry->selected && subdirectories.isEmpty() && files.isEmpty()) {
+        m_checked.setBit(node.nodeId);
+    }
+
+    DirNode &dir = m_dirs[ordinal];
+    dir.fileBase = fileBase;
+    dir.nodeEnd = nextId;
+    dir.dirEnd = m_dirs.size();
+    dir.totalFiles = totalFiles;
+    dir.checkedFiles = checkedFiles;
+    return ordinal;
+}
+
+// ============================================================================
+// Structure
+// ============================================================================
+
+int IndexTreeModel::directoryOrdinal(const QModelIndex &index) const
+{
+    if (m_dirs.isEmpty()) {
+        return -1;
+    }
+    if (!index.isValid()) {
+        return 0;
+    }
+
+    const DirNode &parent = m_dirs[static_cast<int>(index.internalId())];
+    if (index.row() < parent.subdirectories->size()) {
+        return m_childDirs[parent.firstChild + index.row()];
+    }
+    return -1;
+}
+
+QModelIndex IndexTreeModel::directoryIndex(int ordinal) const
+{
+    const DirNode &dir = m_dirs[ordinal];
+    return createIndex(dir.row, 0, static_cast<quintptr>(dir.parent));
+}
+
+QModelIndex IndexTreeModel::index(int row, int column, const QModelIndex &parent) const
+{
+    const int ordinal = directoryOrdinal(parent);
+    if (ordinal < 0 || column != 0 || row < 0 || row >= m_dirs[ordinal].fetched) {
+        return QModelIndex();
+    }
+    // Rows carry the ordinal of their parent directory
+    return createIndex(row, 0, static_cast<quintptr>(ordinal));
+}
+
+QModelIndex IndexTreeModel::parent(const QModelIndex &child) const
+{
+    if (!child.isValid()) {
+        return QModelIndex();
+    }
+
+    const int ordinal = static_cast<int>(child.internalId());
+    if (ordinal == 0) {
+        return QModelIndex();
+    }
+    return directoryIndex(ordinal);
+}
+
+int IndexTreeModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.column() > 0) {
+        return 0;
+    }
+    const int ordinal = directoryOrdinal(parent);
+    return ordinal < 0 ? 0 : m_dirs[ordinal].fetched;
+}
+
+int IndexTreeModel::columnCount(const QModelIndex & /*parent*/) const
+{
+    return 1;
+}
+
+bool IndexTreeModel::hasChildren(const QModelIndex &parent) const
+{
+    const int ordinal = directoryOrdinal(parent);
+    return ordinal >= 0 && m_dirs[ordinal].childCount() > 0;
+}
+
+bool IndexTreeModel::canFetchMore(const QModelIndex &parent) const
+{
+    const int ordinal = directoryOrdinal(parent);
+    return ordinal >= 0 && m_dirs[ordinal].fetched < m_dirs[ordinal].childCount();
+}
+
+void IndexTreeModel::fetchMore(const QModelIndex &parent)
+{
+    const int ordinal = directoryOrdinal(parent);
+    if (ordinal < 0) {
+        return;
+    }
+
+    DirNode &dir = m_dirs[ordinal];
+    const int count = qMin(FETCH_BATCH_SIZE, dir.childCount() - dir.fetched);
+    if (count <= 0) {
+        return;
+    }
+
+    beginInsertRows(parent, dir.fetched, dir.fetched + count - 1);
+    dir.fetched += count;
+    endInsertRows();
+}
+
+// ============================================================================
+// Data
+// ============================================================================
+
+QVariant IndexTreeModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid()) {
+        return QVariant();
+    }
+
+    const DirNode &parent = m_dirs[static_cast<int>(index.internalId())];
+    const int row = index.row();
+    const int subdirectoryCount = parent.subdirectories->size();
+
+    if (row < subdirectoryCount) {
+        const DirNode &dir = m_dirs[m_childDirs[parent.firstChild + row]];
+        switch (role) {
+        case Qt::DisplayRole:
+            return dir.entry->name;
+        case Qt::DecorationRole:
+            return m_folderIcon;
+        case Qt::CheckStateRole:
+            return directoryState(dir);
+        case NodeTypeRole:
+            return static_cast<int>(NodeType::Directory);
+        case NodeIdRole:
+            return dir.nodeId;
+        default:
+            return QVariant();
+        }
+    }
+
+    const int fileRow = row - subdirectoryCount;
+    const quint32 nodeId = parent.fileBase + static_cast<quint32>(fileRow);
+    switch (role) {
+    case Qt::DisplayRole:
+        return parent.files->at(fileRow).name;
+    case Qt::DecorationRole:
+        return m_fileIcon;
+    case Qt::CheckStateRole:
+        return m_checked.testBit(nodeId) ? Qt::Checked : Qt::Unchecked;
+    case NodeTypeRole:
+        return static_cast<int>(NodeType::File);
+    case NodeIdRole:
+        return nodeId;
+    default:
+        return QVariant();
+    }
+}
+
+bool IndexTreeModel::setData(const QModelIndex &index, const QVariant &value, int role)
+{
+    if (!index.isValid() || role != Qt::CheckStateRole) {
+        return false;
+    }
+
+    const bool checked = value.toInt() != Qt::Unchecked;
+    const int ordinal = directoryOrdinal(index);
+    if (ordinal >= 0) {
+        setDirectoryChecked(ordinal, checked);
+    } else {
+        const DirNode &parent = m_dirs[static_cast<int>(index.internalId())];
+        const quint32 fileRow = static_cast<quint32>(index.row() - parent.subdirectories->size());
+        setFileChecked(index, parent.fileBase + fileRow, checked);
+    }
+    return true;
+}
+
+Qt::ItemFlags IndexTreeModel::flags(const QModelIndex &index) const
+{
+    if (!index.isValid()) {
+        return Qt::NoItemFlags;
+    }
+
+    Qt::ItemFlags result = Qt::ItemIsEnabled | Qt::ItemIsSelectable | Qt::ItemIsUserCheckable;
+    if (!isDirectory(index)) {
+        result |= Qt::ItemNeverHasChildren;
+    }
+    return result;
+}
+
+QVariant IndexTreeModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation == Qt::Horizontal && role == Qt::DisplayRole && section == 0) {
+        return tr("Files and Folders");
+    }
+    return QVariant();
+}
+
+bool IndexTreeModel::isDirectory(const QModelIndex &index) const
+{
+    return index.isValid() && directoryOrdinal(index) >= 0;
+}
+
+const core::LtfsDirectoryEntry *IndexTreeModel::directoryEntry(const QModelIndex &index) const
+{
+    if (!index.isValid()) {
+        return nullptr;
+    }
+    const int ordinal = directoryOrdinal(index);
+    return ordinal < 0 ? nullptr : m_dirs[ordinal].entry;
+}
+
+const core::LtfsFileEntry *IndexTreeModel::fileEntry(const QModelIndex &index) const
+{
+    if (!index.isValid() || directoryOrdinal(index) >= 0) {
+        return nullptr;
+    }
+    const DirNode &parent = m_dirs[static_cast<int>(index.internalId())];
+    return &parent.files->at(index.row() - parent.subdirectories->size());
+}
+
+// ============================================================================
+// Check State
+// ============================================================================
+
+Qt::CheckState IndexTreeModel::checkState(const QModelIndex &index) const
+{
+    return static_cast<Qt::CheckState>(data(index, Qt::CheckStateRole).toInt());
+}
+
+Qt::CheckState IndexTreeModel::directoryState(const DirNode &dir) const
+{
+    if (dir.totalFiles == 0) {
+        return m_checked.testBit(dir.nodeId) ? Qt::Checked : Qt::Unchecked;
+    }
+    if (dir.checkedFiles == 0) {
+        return Qt::Unchecked;
+    }
+    return dir.checkedFiles == dir.totalFiles ? Qt::Checked : Qt::PartiallyChecked;
+}
+
+void IndexTreeModel::setAllChecked(bool checked)
+{
+    if (!m_dirs.isEmpty()) {
+        setDirectoryChecked(0, checked);
+    }
+}
+
+void IndexTreeModel::checkFiles(const std::function<bool(const core::LtfsFileEntry &)> &predicate)
+{
+    if (m_dirs.isEmpty()) {
+        return;
+    }
+
+    m_checked.fill(false);
+
+    // Children have higher ordinals than their parent, so walking
+    // backwards finishes every subtree before its directory is counted
+    for (int ordinal = m_dirs.size() - 1; ordinal >= 0; --ordinal) {
+        DirNode &dir = m_dirs[ordinal];
+        quint32 checkedFiles = 0;
+        for (int i = 0; i < dir.files->size(); ++i) {
+            if (predicate(dir.files->at(i))) {
+                m_checked.setBit(dir.fileBase + i);
+                checkedFiles++;
+            }
+        }
+        for (int i = 0; i < dir.subdirectories->size(); ++i) {
+            checkedFiles += m_dirs[m_childDirs[dir.firstChild + i]].checkedFiles;
+        }
+        dir.checkedFiles = checkedFiles;
+    }
+
+    emitSubtreeChanged(0);
+}
+
+quint32 IndexTreeModel::checkedFileCount() const
+{
+    return m_dirs.isEmpty() ? 0 : m_dirs[0].checkedFiles;
+}
+
+quint32 IndexTreeModel::totalFileCount() const
+{
+    return m_dirs.isEmpty() ? 0 : m_dirs[0].totalFiles;
+}
+
+void IndexTreeModel::setDirectoryChecked(int ordinal, bool checked)
+{
+    DirNode &dir = m_dirs[ordinal];
+    const qint64 delta = static_cast<qint64>(checked ? dir.totalFiles : 0) - dir.checkedFiles;
+
+    // The subtree is one ID range and one run of ordinals
+    m_checked.fill(checked, dir.nodeId, dir.nodeEnd);
+    for (int i = ordinal; i < dir.dirEnd; ++i) {
+        m_dirs[i].checkedFiles = checked ? m_dirs[i].totalFiles : 0;
+    }
+
+    adjustAncestors(ordinal, delta);
+    emitSubtreeChanged(ordinal);
+}
+
+void IndexTreeModel::setFileChecked(const QModelIndex &index, quint32 nodeId, bool checked)
+{
+    if (m_checked.testBit(nodeId) == checked) {
+        return;
+    }
+
+    m_checked.setBit(nodeId, checked);
+    emit dataChanged(index, index, {Qt::CheckStateRole});
+
+    const int parent = static_cast<int>(index.internalId());
+    m_dirs[parent].checkedFiles += checked ? 1 : -1;
+    if (parent > 0) {
+        const QModelIndex parentIndex = directoryIndex(parent);
+        emit dataChanged(parentIndex, parentIndex, {Qt::CheckStateRole});
+    }
+    adjustAncestors(parent, checked ? 1 : -1);
+}
+
+void IndexTreeModel::adjustAncestors(int ordinal, qint64 delta)
+{
+    for (int i = m_dirs[ordinal].parent; i >= 0; i = m_dirs[i].parent) {
+        m_dirs[i].checkedFiles = static_cast<quint32>(m_dirs[i].checkedFiles + delta);
+        if (i > 0) {
+            const QModelIndex index = directoryIndex(i);
+            emit dataChanged(index, index, {Qt::CheckStateRole});
+        }
+    }
+}
+
+void IndexTreeModel::emitSubtreeChanged(int ordinal)
+{
+    if (ordinal > 0) {
+        const QModelIndex index = directoryIndex(ordinal);
+        emit dataChanged(index, index, {Qt::CheckStateRole});
+    }
+
+    // Only rows a view has fetched can be on screen
+    for (int i = ordinal; i < m_dirs[ordinal].dirEnd; ++i) {
+        const DirNode &dir = m_dirs[i];
+        if (dir.fetched == 0) {
+            continue;
+        }
+        const QModelIndex parent = i == 0 ? QModelIndex() : directoryIndex(i);
+        emit dataChanged(index(0, 0, parent), index(dir.fetched - 1, 0, parent), {Qt::CheckStateRole});
+    }
+}
+
+} // namespace app
+} // namespace qltfs
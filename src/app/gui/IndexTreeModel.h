@@ -0,0 +1,179 @@
+/*
+ * QLTOTapeMan - Qt-based LTO Tape Manager
+ *
+ * Copyright (c) 2026 Jeffrey ZHU (zhxsh1225@gmail.com)
+ * https://github.com/Gypsop/QLTOTapeMan
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef INDEXTREEMODEL_H
+#define INDEXTREEMODEL_H
+
+#include <QAbstractItemModel>
+#include <QBitArray>
+#include <QIcon>
+#include <QVector>
+
+#include <functional>
+
+#include "LtfsIndex.h"
+
+namespace qltfs {
+namespace app {
+
+/**
+ * @brief Lazy, checkable tree model over the contents of an LTFS index
+ *
+ * Rows are not created up front: each directory exposes its children in
+ * batches through canFetchMore() / fetchMore() as the view scrolls or
+ * expands, and rows refer straight to the index entries, so opening a
+ * tape with millions of files costs no per-file objects.
+ *
+ * Every directory and file gets a node ID in depth-first order, which
+ * makes each directory's subtree one contiguous ID range. Check state is
+ * a bitset over node IDs plus a checked-file count per directory, so
+ * checking a directory is a range fill and tri-state propagation only
+ * touches the ancestors of the changed node.
+ */
+class IndexTreeModel : public QAbstractItemModel
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Kind of entry a row refers to
+     */
+    enum class NodeType {
+        Directory,
+        File
+    };
+
+    /**
+     * @brief Custom data roles
+     */
+    enum Roles {
+        NodeTypeRole = Qt::UserRole,    ///< NodeType as int
+        NodeIdRole                      ///< Node ID used for check state
+    };
+
+    explicit IndexTreeModel(QObject *parent = nullptr);
+    ~IndexTreeModel() override = default;
+
+    /**
+     * @brief Set the index to show
+     *
+     * The index must stay alive and unchanged while set. Initial check
+     * states come from the entries' selected flags.
+     *
+     * @param index LTFS index (ownership not transferred), or nullptr
+     */
+    void setIndex(const core::LtfsIndex *index);
+
+    // QAbstractItemModel
+    QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex &child) const override;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    bool hasChildren(const QModelIndex &parent = QModelIndex()) const override;
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole) override;
+    Qt::ItemFlags flags(const QModelIndex &index) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    /**
+     * @brief Check if a row is a directory
+     */
+    bool isDirectory(const QModelIndex &index) const;
+
+    /**
+     * @brief Directory entry of a row, or nullptr for a file row
+     */
+    const core::LtfsDirectoryEntry *directoryEntry(const QModelIndex &index) const;
+
+    /**
+     * @brief File entry of a row, or nullptr for a directory row
+     */
+    const core::LtfsFileEntry *fileEntry(const QModelIndex &index) const;
+
+    /**
+     * @brief Check state of a row (directories are derived from their files)
+     */
+    Qt::CheckState checkState(const QModelIndex &index) const;
+
+    /**
+     * @brief Check or uncheck every entry
+     */
+    void setAllChecked(bool checked);
+
+    /**
+     * @brief Replace the check state: check exactly the files matching a predicate
+     *
+     * Walks the index entries, not the rows, so unfetched files are
+     * included.
+     */
+    void checkFiles(const std::function<bool(const core::LtfsFileEntry &)> &predicate);
+
+    /**
+     * @brief Number of checked files
+     */
+    quint32 checkedFileCount() const;
+
+    /**
+     * @brief Number of files in the index
+     */
+    quint32 totalFileCount() const;
+
+private:
+    /**
+     * @brief A directory of the index (ordinal 0 is the index root)
+     */
+    struct DirNode {
+        const core::LtfsDirectoryEntry *entry = nullptr;    ///< nullptr for the root
+        const QList<core::LtfsDirectoryEntry> *subdirectories = nullptr;
+        const QList<core::LtfsFileEntry> *files = nullptr;
+        int parent = -1;            ///< Ordinal of the parent directory
+        int row = 0;                ///< Row within the parent
+        int firstChild = 0;         ///< Start of the child ordinals in m_childDirs
+        int dirEnd = 0;             ///< One past the last directory ordinal of the subtree
+        quint32 nodeId = 0;         ///< Node ID of the directory itself
+        quint32 nodeEnd = 0;        ///< One past the last node ID of the subtree
+        quint32 fileBase = 0;       ///< Node ID of the first direct file
+        quint32 totalFiles = 0;     ///< Files in the subtree
+        quint32 checkedFiles = 0;   ///< Checked files in the subtree
+        int fetched = 0;            ///< Rows exposed to views so far
+
+        int childCount() const { return static_cast<int>(subdirectories->size() + files->size()); }
+    };
+
+    int build(const core::LtfsDirectoryEntry *entry,
+              const QList<core::LtfsDirectoryEntry> &subdirectories,
+              const QList<core::LtfsFileEntry> &files,
+              int parent, int row, quint32 &nextId);
+
+    int directoryOrdinal(const QModelIndex &index) const;
+    QModelIndex directoryIndex(int ordinal) const;
+    Qt::CheckState directoryState(const DirNode &dir) const;
+
+    void setDirectoryChecked(int ordinal, bool checked);
+    void setFileChecked(const QModelIndex &index, quint32 nodeId, bool checked);
+    void adjustAncestors(int ordinal, qint64 delta);
+    void emitSubtreeChanged(int ordinal);
+
+    const core::LtfsIndex *m_index;
+    QList<core::LtfsDirectoryEntry> m_rootDirectories;  ///< Shared copies, keep the entries in place
+    QList<core::LtfsFileEntry> m_rootFiles;
+    QVector<DirNode> m_dirs;        ///< Directories in depth-first order
+    QVector<int> m_childDirs;       ///< Child directory ordinals, grouped per parent
+    QBitArray m_checked;            ///< Check state per node ID
+
+    QIcon m_folderIcon;
+    QIcon m_fileIcon;
+};
+
+} // namespace app
+} // namespace qltfs
+
+#endif // INDEXTREEMODEL_H
@@ -10,6 +10,9 @@
 #include "LtfsWriterWindow.h"
 #include "FileBrowserDialog.h"
 
+#include "core/IndexCache.h"
+#include "xml/IndexParser.h"
+
 #include <QCloseEvent>
 #include <QDragEnterEvent>
 #include <QDropEvent>
@@ -443,9 +446,10 @@ void LtfsWriterWindow::createFileListView()
 {
     // Left panel - source files/queue
     m_treeView = new QTreeView(this);
-    m_treeModel = new QStandardItemModel(this);
-    m_treeModel->setHorizontalHeaderLabels({tr("Name"), tr("Size"), tr("Status")});
+    m_treeModel = new TransferQueueModel(this);
     m_treeView->setModel(m_treeModel);
+    m_treeView->setRootIsDecorated(false);
+    m_treeView->setUniformRowHeights(true);
     m_treeView->setAlternatingRowColors(true);
     m_treeView->setSelectionMode(QAbstractItemView::ExtendedSelection);
     m_treeView->setContextMenuPolicy(Qt::CustomContextMenu);
@@ -458,9 +462,10 @@ void LtfsWriterWindow::createFileListView()
     rightLayout->setContentsMargins(0, 0, 0, 0);
 
     m_listView = new QTableView(this);
-    m_listModel = new QStandardItemModel(this);
-    m_listModel->setHorizontalHeaderLabels({tr("Name"), tr("Size"), tr("Modified"), tr("Hash")});
+    m_listModel = new TapeContentsModel(this);
     m_listView->setModel(m_listModel);
+    m_listView->verticalHeader()->hide();
+    m_listView->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
     m_listView->setAlternatingRowColors(true);
     m_listView->setSelectionMode(QAbstractItemView::ExtendedSelection);
     m_listView->setSelectionBehavior(QAbstractItemView::SelectRows);
@@ -709,39 +714,48 @@ void LtfsWriterWindow::onSpeedHistoryTimer()
 
 void LtfsWriterWindow::addFiles(const QStringList &paths)
 {
+    QList<TransferItem> items;
+    items.reserve(paths.size());
+
     for (const QString &path : paths) {
         QFileInfo info(path);
         if (!info.exists()) {
             continue;
         }
 
-        QList<QStandardItem *> row;
-        row.append(new QStandardItem(info.fileName()));
-        row.append(new QStandardItem(info.isDir() ? tr("<DIR>") : formatSize(info.size())));
-        row.append(new QStandardItem(tr("Pending")));
-
-        m_treeModel->appendRow(row);
+        TransferItem item;
+        item.sourcePath = info.absoluteFilePath();
+        item.relativePath = info.fileName();
+        item.size = info.isDir() ? 0 : info.size();
+        item.isDirectory = info.isDir();
+        item.modifiedTime = info.lastModified();
+        items.append(item);
     }
 
+    // Rows reach the view in batches
+    m_treeModel->appendItems(items);
+
     setModified(true);
     printMessage(tr("Added %1 items to queue").arg(paths.size()));
 }
 
 void LtfsWriterWindow::removeSelectedItems()
 {
-    QModelIndexList selected = m_treeView->selectionModel()->selectedRows();
-    
-    // Remove in reverse order to maintain indices
-    for (int i = selected.size() - 1; i >= 0; --i) {
-        m_treeModel->removeRow(selected[i].row());
+    const QModelIndexList selected = m_treeView->selectionModel()->selectedRows();
+
+    QList<int> rows;
+    rows.reserve(selected.size());
+    for (const QModelIndex &index : selected) {
+        rows.append(index.row());
     }
+    m_treeModel->removeItems(rows);
 
     setModified(true);
 }
 
 void LtfsWriterWindow::clearQueue()
 {
-    m_treeModel->removeRows(0, m_treeModel->rowCount());
+    m_treeModel->clear();
     setModified(true);
 }
 
@@ -797,13 +811,8 @@ void LtfsWriterWindow::ejectTape()
 
 void LtfsWriterWindow::refreshView()
 {
-    // Refresh the tape contents view
-    m_listModel->removeRows(0, m_listModel->rowCount());
-
-    if (m_schema) {
-        // Populate from schema
-        // TODO: Traverse LtfsIndex and populate list
-    }
+    // Refresh the tape contents view; rows are fetched again as needed
+    m_listModel->setIndex(m_listModel->compactIndex());
 }
 
 void LtfsWriterWindow::showFileBrowser()
@@ -833,7 +842,7 @@ void LtfsWriterWindow::onNewSession()
     }
 
     clearQueue();
-    m_listModel->removeRows(0, m_listModel->rowCount());
+    m_listModel->setIndex(nullptr);
     m_speedHistory.clear();
     m_statistics = WriteStatistics();
     m_statistics.startTime = QDateTime::currentDateTime();
@@ -852,8 +861,27 @@ void LtfsWriterWindow::onOpenIndex()
         return;
     }
 
-    // TODO: Parse index file
-    printMessage(tr("Opened index: %1").arg(fileName));
+    // Large indexes are read into the compact form, which the tape view
+    // reads directly
+    IndexParser parser;
+    QSharedPointer<CompactIndex> index = parser.parseCompactFile(fileName);
+    if (!index) {
+        QMessageBox::warning(this, tr("Open LTFS Index"),
+            tr("Failed to parse index: %1").arg(parser.errorMessage()));
+        return;
+    }
+
+    m_listModel->setIndex(index);
+    printMessage(tr("Opened index: %1 (%2 files)").arg(fileName).arg(index->fileCount()));
+
+    // Cataloged, a later mount of this volume is identified from MAM
+    // without reading its label and index from tape
+    if (!index->header().volumeUuid.isNull()) {
+        IndexCache cache;
+        if (!cache.store(*index)) {
+            printMessage(tr("Index not cataloged: %1").arg(cache.lastError()));
+        }
+    }
 }
 
 void LtfsWriterWindow::onSaveIndex()
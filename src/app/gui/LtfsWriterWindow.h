@@ -28,12 +28,13 @@
 #include <QChartView>
 #include <QLineSeries>
 #include <QValueAxis>
-#include <QStandardItemModel>
 #include <QFileSystemModel>
 
 #include "LtfsIndex.h"
 #include "LtfsLabel.h"
 #include "TapeDevice.h"
+#include "TapeContentsModel.h"
+#include "TransferQueueModel.h"
 
 namespace qltfs {
 namespace app {
@@ -317,11 +318,11 @@ private:
 
     // Left panel - File browser / queue
     QTreeView *m_treeView;
-    QStandardItemModel *m_treeModel;
+    TransferQueueModel *m_treeModel;
 
     // Right panel - Tape contents
     QTableView *m_listView;
-    QStandardItemModel *m_listModel;
+    TapeContentsModel *m_listModel;
 
     // Bottom panel - Speed chart
     QChartView *m_chartView;
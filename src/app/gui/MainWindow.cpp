@@ -27,6 +27,7 @@
 #include "SettingsDialog.h"
 #include "AboutDialog.h"
 
+#include "core/IndexCache.h"
 #include "xml/IndexParser.h"
 #include "xml/IndexWriter.h"
 
@@ -159,6 +160,11 @@ void MainWindow::setupConnections()
     // Device combo box
     connect(ui->comboDevice, QOverload<int>::of(&QComboBox::currentIndexChanged),
             this, &MainWindow::onDeviceChanged);
+
+    // Hotplug keeps the list current; without it, Refresh Devices does
+    connect(&m_deviceMonitor, &qltfs::DeviceMonitor::devicesChanged,
+            this, &MainWindow::refreshDeviceList);
+    m_deviceMonitor.start();
 }
 
 void MainWindow::loadSettings()
@@ -192,6 +198,7 @@ void MainWindow::saveSettings()
 
 void MainWindow::refreshDeviceList()
 {
+    const QString selected = ui->comboDevice->currentData().toString();
     ui->comboDevice->clear();
     ui->comboDevice->addItem(tr("-- Select Device --"), QString());
 
@@ -206,6 +213,11 @@ void MainWindow::refreshDeviceList()
         ui->comboDevice->addItem(device.displayName(), device.devicePath);
     }
 
+    const int index = ui->comboDevice->findData(selected);
+    if (!selected.isEmpty() && index > 0) {
+        ui->comboDevice->setCurrentIndex(index);
+    }
+
     statusBar()->showMessage(tr("Found %1 tape device(s)").arg(devices.size()), 3000);
 }
 
@@ -636,6 +648,42 @@ void MainWindow::onMountTape()
     }
 
     if (m_device->testReady()) {
+        // A volume unchanged since an index we have cached is known from
+        // MAM alone; neither the label nor the index is read from tape
+        const qltfs::TapeVolumeIdentity identity = m_device->readVolumeIdentity();
+        QSharedPointer<qltfs::CompactIndex> cached;
+        if (identity.isCurrent()) {
+            cached = qltfs::IndexCache().load(identity.volumeUuid, identity.generationNumber);
+        }
+
+        if (cached) {
+            const qltfs::CompactIndex::Header &header = cached->header();
+            auto index = QSharedPointer<qltfs::LtfsIndex>::create();
+            index->setVersion(header.version);
+            index->setCreator(header.creator);
+            index->setVolumeUuid(header.volumeUuid);
+            index->setGenerationNumber(header.generationNumber);
+            index->setUpdateTime(qltfs::CompactIndex::toDateTime(header.updateTime));
+            index->setSelfLocation(header.selfLocation);
+            index->setPreviousGenerationLocation(header.previousGenerationLocation);
+            index->setAllowPolicyUpdate(header.allowPolicyUpdate);
+            index->setHighestFileUid(header.highestFileUid);
+            index->setRootDirectory(cached->toLtfsDirectory(0));
+            m_currentIndex = index;
+            m_currentIndexPath.clear();
+            updateUiState();
+
+            showInfo(tr("Tape Mounted"),
+                    tr("LTFS Volume: %1\n"
+                       "UUID: %2\n"
+                       "Index generation %3 loaded from the local catalog")
+                    .arg(identity.barcode,
+                         identity.volumeUuid.toString(QUuid::WithoutBraces),
+                         QString::number(identity.generationNumber)));
+            updateTapeInfo();
+            return;
+        }
+
         // Try to read LTFS label
         auto label = m_device->readLabel();
         if (label.isValid()) {
@@ -25,6 +25,7 @@
 #include <QSharedPointer>
 
 #include "device/DeviceEnumerator.h"
+#include "device/DeviceMonitor.h"
 #include "device/TapeDevice.h"
 #include "core/LtfsIndex.h"
 
@@ -112,6 +113,7 @@ private:
     QSettings m_settings;
 
     qltfs::DeviceEnumerator m_enumerator;
+    qltfs::DeviceMonitor m_deviceMonitor;
     QSharedPointer<qltfs::TapeDevice> m_device;
     QSharedPointer<qltfs::LtfsIndex> m_currentIndex;
 
@@ -25,9 +25,7 @@ ProgressDialog::ProgressDialog(QWidget *parent)
     , m_progress(0)
     , m_bytesProcessed(0)
     , m_bytesTotal(0)
-    , m_lastBytes(0)
-    , m_lastTime(0)
-    , m_currentSpeed(0)
+    , m_source(nullptr)
 {
     setupUi();
 }
@@ -155,13 +153,11 @@ void ProgressDialog::setBytesProcessed(qint64 bytes)
 {
     m_bytesProcessed = bytes;
     
-    // Calculate progress if total is known
+    // Calculate progress if total is known; labels follow on the next tick
     if (m_bytesTotal > 0) {
         int percent = static_cast<int>(bytes * 100 / m_bytesTotal);
         setProgress(percent);
     }
-
-    updateDisplay();
 }
 
 void ProgressDialog::setBytesTotal(qint64 bytes)
@@ -176,6 +172,15 @@ void ProgressDialog::setCancelable(bool cancelable)
     m_cancelButton->setEnabled(cancelable);
 }
 
+void ProgressDialog::setProgressSource(const TransferProgress *progress)
+{
+    m_source = progress;
+    m_throughput.reset();
+    if (m_source) {
+        updateDisplay();
+    }
+}
+
 void ProgressDialog::setIndeterminate(bool indeterminate)
 {
     m_indeterminate = indeterminate;
@@ -197,9 +202,7 @@ void ProgressDialog::reset()
     m_progress = 0;
     m_bytesProcessed = 0;
     m_bytesTotal = 0;
-    m_lastBytes = 0;
-    m_lastTime = 0;
-    m_currentSpeed = 0;
+    m_throughput.reset();
 
     m_progressBar->setValue(0);
     m_progressLabel->setText("0%");
@@ -254,22 +257,26 @@ void ProgressDialog::updateDisplay()
     qint64 elapsedMs = m_elapsedTimer.elapsed();
     qint64 elapsedSec = elapsedMs / 1000;
 
+    // Pull the transfer counters at our own rate
+    if (m_source) {
+        const TransferProgressSnapshot snapshot = m_source->snapshot();
+        if (snapshot.totalBytes != m_bytesTotal) {
+            setBytesTotal(snapshot.totalBytes);
+        }
+        m_bytesProcessed = snapshot.completedBytes;
+        setProgress(snapshot.progressPercent());
+    }
+
     // Update elapsed time
     m_timeLabel->setText(tr("Elapsed: %1").arg(formatTime(elapsedSec)));
 
-    // Calculate speed
-    qint64 deltaBytes = m_bytesProcessed - m_lastBytes;
-    qint64 deltaTime = elapsedMs - m_lastTime;
-
-    if (deltaTime >= 500 && deltaBytes >= 0) {  // Update speed every 500ms
-        m_currentSpeed = static_cast<double>(deltaBytes) * 1000.0 / deltaTime;
-        m_lastBytes = m_bytesProcessed;
-        m_lastTime = elapsedMs;
-    }
+    // Speed over the last few seconds, not since the start
+    m_throughput.addSample(elapsedMs, m_bytesProcessed);
+    const double speed = m_throughput.bytesPerSecond();
 
     // Update speed display
-    if (m_currentSpeed > 0) {
-        m_speedLabel->setText(formatSpeed(m_currentSpeed));
+    if (speed > 0) {
+        m_speedLabel->setText(formatSpeed(speed));
     }
 
     // Update status (bytes processed / total)
@@ -279,9 +286,8 @@ void ProgressDialog::updateDisplay()
             .arg(formatSize(m_bytesTotal)));
 
         // Calculate ETA
-        if (m_currentSpeed > 0 && m_bytesProcessed > 0) {
-            qint64 remaining = m_bytesTotal - m_bytesProcessed;
-            qint64 etaSec = static_cast<qint64>(remaining / m_currentSpeed);
+        if (speed > 0 && m_bytesProcessed > 0) {
+            qint64 etaSec = m_throughput.estimatedRemainingMs(m_bytesTotal - m_bytesProcessed) / 1000;
             m_timeLabel->setText(tr("Elapsed: %1 | ETA: %2")
                 .arg(formatTime(elapsedSec))
                 .arg(formatTime(etaSec)));
@@ -17,6 +17,8 @@
 #include <QElapsedTimer>
 #include <QTimer>
 
+#include "io/TransferProgress.h"
+
 namespace qltfs {
 namespace app {
 
@@ -27,7 +29,8 @@ namespace app {
  * - Overall progress with percentage
  * - Current file/operation name
  * - Elapsed and estimated time
- * - Speed display
+ * - Speed display over a sliding window
+ * - Polling the counters of a running TapeIO
  * - Cancel button with confirmation
  */
 class ProgressDialog : public QDialog
@@ -70,6 +73,17 @@ public:
      */
     bool wasCanceled() const { return m_canceled; }
 
+    /**
+     * @brief Poll transfer counters instead of being fed progress
+     *
+     * Progress, bytes and total are read from the counters on every
+     * display update, so the transfer never signals the dialog per
+     * block. The counters must outlive the dialog or be cleared first.
+     *
+     * @param progress Counters to poll (nullptr = fed via setters)
+     */
+    void setProgressSource(const TransferProgress *progress);
+
     /**
      * @brief Set indeterminate mode (unknown total)
      */
@@ -126,12 +140,13 @@ private:
     qint64 m_bytesProcessed;
     qint64 m_bytesTotal;
 
+    // Polled counters (not owned)
+    const TransferProgress *m_source;
+
     // Timing
     QElapsedTimer m_elapsedTimer;
     QTimer *m_updateTimer;
-    qint64 m_lastBytes;
-    qint64 m_lastTime;
-    double m_currentSpeed;
+    ThroughputEstimator m_throughput;
 };
 
 } // namespace app
@@ -142,6 +142,7 @@ void SettingsDialog::createWriteTab()
     m_blockSizeCombo->addItem("512 KiB (Default)", 524288);
     m_blockSizeCombo->addItem("256 KiB", 262144);
     m_blockSizeCombo->addItem("1 MiB", 1048576);
+    m_blockSizeCombo->addItem(tr("Automatic (per drive)"), 0);
     blockLayout->addRow(tr("Block Size:"), m_blockSizeCombo);
 
     m_compressCheck = new QCheckBox(tr("Enable hardware compression"), tab);
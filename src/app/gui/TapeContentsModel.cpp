@@ -0,0 +1,130 @@
+/*
+ * QLTOTapeMan - Qt-based LTO Tape Manager
+ *
+ * Copyright (c) 2026 Jeffrey ZHU (zhxsh1225@gmail.com)
+ * https://github.com/Gypsop/QLTOTapeMan
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "TapeContentsModel.h"
+
+#include "util/LtfsUtility.h"
+
+#include <QByteArrayView>
+#include <QLocale>
+
+namespace qltfs {
+namespace app {
+
+// Rows handed to views per fetchMore()
+static constexpr int FETCH_BATCH_SIZE = 10000;
+
+// Prefix of the extended attributes holding file hashes
+static constexpr char HASH_ATTRIBUTE_PREFIX[] = "ltfs.hash.";
+
+TapeContentsModel::TapeContentsModel(QObject *parent)
+    : QAbstractTableModel(parent)
+    , m_fetched(0)
+{
+}
+
+void TapeContentsModel::setIndex(QSharedPointer<CompactIndex> index)
+{
+    beginResetModel();
+    m_index = index;
+    m_fetched = 0;
+    endResetModel();
+}
+
+int TapeContentsModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_fetched;
+}
+
+int TapeContentsModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+bool TapeContentsModel::canFetchMore(const QModelIndex &parent) const
+{
+    return !parent.isValid() && m_index && m_fetched < m_index->fileCount();
+}
+
+void TapeContentsModel::fetchMore(const QModelIndex &parent)
+{
+    if (!canFetchMore(parent)) {
+        return;
+    }
+
+    const int count = qMin(FETCH_BATCH_SIZE, m_index->fileCount() - m_fetched);
+    beginInsertRows(QModelIndex(), m_fetched, m_fetched + count - 1);
+    m_fetched += count;
+    endInsertRows();
+}
+
+QVariant TapeContentsModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || !m_index || index.row() >= m_fetched) {
+        return QVariant();
+    }
+
+    const quint32 fileIndex = static_cast<quint32>(index.row());
+    const CompactIndex::File &file = m_index->file(fileIndex);
+
+    if (role == Qt::DisplayRole) {
+        switch (index.column()) {
+        case NameColumn:
+            return m_index->filePath(fileIndex);
+        case SizeColumn:
+            return util::LtfsUtility::formatSize(file.length);
+        case ModifiedColumn:
+            if (file.times.modify == CompactIndex::NO_TIME) {
+                return QVariant();
+            }
+            return QLocale().toString(CompactIndex::toDateTime(file.times.modify).toLocalTime(),
+                                      QLocale::ShortFormat);
+        case HashColumn:
+            return hashOf(fileIndex);
+        default:
+            break;
+        }
+    } else if (role == Qt::TextAlignmentRole && index.column() == SizeColumn) {
+        return static_cast<int>(Qt::AlignRight | Qt::AlignVCenter);
+    }
+    return QVariant();
+}
+
+QVariant TapeContentsModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QAbstractTableModel::headerData(section, orientation, role);
+    }
+
+    switch (section) {
+    case NameColumn:     return tr("Name");
+    case SizeColumn:     return tr("Size");
+    case ModifiedColumn: return tr("Modified");
+    case HashColumn:     return tr("Hash");
+    default:             return QVariant();
+    }
+}
+
+QString TapeContentsModel::hashOf(quint32 file) const
+{
+    // Files carry a handful of attributes; show the first hash found
+    const CompactIndex::File &record = m_index->file(file);
+    for (quint32 i = 0; i < record.attributeCount; ++i) {
+        const CompactIndex::Attribute &attribute = m_index->attribute(record.firstAttribute + i);
+        const QUtf8StringView key = m_index->stringView(attribute.key);
+        if (QByteArrayView(reinterpret_cast<const char *>(key.data()), key.size())
+                .startsWith(HASH_ATTRIBUTE_PREFIX)) {
+            return m_index->string(attribute.value);
+        }
+    }
+    return QString();
+}
+
+} // namespace app
+} // namespace qltfs
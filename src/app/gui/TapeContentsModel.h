@@ -0,0 +1,76 @@
+/*
+ * QLTOTapeMan - Qt-based LTO Tape Manager
+ *
+ * Copyright (c) 2026 Jeffrey ZHU (zhxsh1225@gmail.com)
+ * https://github.com/Gypsop/QLTOTapeMan
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef TAPECONTENTSMODEL_H
+#define TAPECONTENTSMODEL_H
+
+#include <QAbstractTableModel>
+#include <QSharedPointer>
+
+#include "core/CompactIndex.h"
+
+namespace qltfs {
+namespace app {
+
+/**
+ * @brief Flat table of the files on a tape
+ *
+ * Reads straight from a CompactIndex: one row per file record, cells
+ * are decoded from the index arrays only when a view asks for them.
+ * Rows are handed to views in batches through canFetchMore() /
+ * fetchMore(), so a tape with millions of files opens immediately.
+ */
+class TapeContentsModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Columns of the tape view
+     */
+    enum Column {
+        NameColumn,
+        SizeColumn,
+        ModifiedColumn,
+        HashColumn,
+        ColumnCount
+    };
+
+    explicit TapeContentsModel(QObject *parent = nullptr);
+    ~TapeContentsModel() override = default;
+
+    /**
+     * @brief Show the files of an index (nullptr to clear)
+     */
+    void setIndex(QSharedPointer<CompactIndex> index);
+
+    /**
+     * @brief Index currently shown
+     */
+    QSharedPointer<CompactIndex> compactIndex() const { return m_index; }
+
+    // QAbstractItemModel
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+private:
+    QString hashOf(quint32 file) const;
+
+    QSharedPointer<CompactIndex> m_index;
+    int m_fetched;                  ///< Rows exposed to views so far
+};
+
+} // namespace app
+} // namespace qltfs
+
+#endif // TAPECONTENTSMODEL_H
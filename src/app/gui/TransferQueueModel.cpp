@@ -0,0 +1,152 @@
+/*
+ * QLTOTapeMan - Qt-based LTO Tape Manager
+ *
+ * Copyright (c) 2026 Jeffrey ZHU (zhxsh1225@gmail.com)
+ * https://github.com/Gypsop/QLTOTapeMan
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "TransferQueueModel.h"
+
+#include "util/LtfsUtility.h"
+
+namespace qltfs {
+namespace app {
+
+// Longest time appended items wait before views are told about them
+static constexpr int BATCH_INTERVAL_MS = 100;
+
+TransferQueueModel::TransferQueueModel(QObject *parent)
+    : QAbstractTableModel(parent)
+{
+    m_batchTimer.setSingleShot(true);
+    m_batchTimer.setInterval(BATCH_INTERVAL_MS);
+    connect(&m_batchTimer, &QTimer::timeout, this, &TransferQueueModel::flush);
+}
+
+int TransferQueueModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_queue.size();
+}
+
+int TransferQueueModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant TransferQueueModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_queue.size()) {
+        return QVariant();
+    }
+
+    const int row = index.row();
+    if (role == Qt::DisplayRole) {
+        switch (index.column()) {
+        case NameColumn:
+            return m_queue.sourceName(row).toString();
+        case SizeColumn:
+            return m_queue.isDirectory(row) ? tr("<DIR>")
+                                            : util::LtfsUtility::formatSize(m_queue.itemSize(row));
+        case StatusColumn:
+            return statusText(m_queue.status(row));
+        default:
+            break;
+        }
+    } else if (role == Qt::ToolTipRole && index.column() == NameColumn) {
+        return m_queue.sourcePath(row);
+    } else if (role == Qt::TextAlignmentRole && index.column() == SizeColumn) {
+        return static_cast<int>(Qt::AlignRight | Qt::AlignVCenter);
+    }
+    return QVariant();
+}
+
+QVariant TransferQueueModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QVariant();
+    }
+
+    switch (section) {
+    case NameColumn:   return tr("Name");
+    case SizeColumn:   return tr("Size");
+    case StatusColumn: return tr("Status");
+    default:           return QVariant();
+    }
+}
+
+void TransferQueueModel::appendItems(const QList<TransferItem> &items)
+{
+    if (items.isEmpty()) {
+        return;
+    }
+
+    m_pending.append(items);
+    if (!m_batchTimer.isActive()) {
+        m_batchTimer.start();
+    }
+}
+
+void TransferQueueModel::flush()
+{
+    m_batchTimer.stop();
+    if (m_pending.isEmpty()) {
+        return;
+    }
+
+    const int first = m_queue.size();
+    beginInsertRows(QModelIndex(), first, first + m_pending.size() - 1);
+    m_queue.append(m_pending);
+    endInsertRows();
+    m_pending.clear();
+}
+
+void TransferQueueModel::removeItems(const QList<int> &rows)
+{
+    if (rows.isEmpty()) {
+        return;
+    }
+
+    // One reset is far cheaper for views than a removal signal per row
+    beginResetModel();
+    m_queue.remove(rows);
+    endResetModel();
+}
+
+void TransferQueueModel::clear()
+{
+    m_batchTimer.stop();
+    m_pending.clear();
+
+    beginResetModel();
+    m_queue.clear();
+    endResetModel();
+}
+
+void TransferQueueModel::setStatus(int row, TransferStatus status)
+{
+    if (row < 0 || row >= m_queue.size() || m_queue.status(row) == status) {
+        return;
+    }
+
+    m_queue.setStatus(row, status);
+    const QModelIndex cell = index(row, StatusColumn);
+    emit dataChanged(cell, cell, {Qt::DisplayRole});
+}
+
+QString TransferQueueModel::statusText(TransferStatus status)
+{
+    switch (status) {
+    case TransferStatus::Pending:    return tr("Pending");
+    case TransferStatus::InProgress: return tr("In Progress");
+    case TransferStatus::Completed:  return tr("Completed");
+    case TransferStatus::Failed:     return tr("Failed");
+    case TransferStatus::Skipped:    return tr("Skipped");
+    case TransferStatus::Cancelled:  return tr("Cancelled");
+    }
+    return QString();
+}
+
+} // namespace app
+} // namespace qltfs
@@ -0,0 +1,105 @@
+/*
+ * QLTOTapeMan - Qt-based LTO Tape Manager
+ *
+ * Copyright (c) 2026 Jeffrey ZHU (zhxsh1225@gmail.com)
+ * https://github.com/Gypsop/QLTOTapeMan
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef TRANSFERQUEUEMODEL_H
+#define TRANSFERQUEUEMODEL_H
+
+#include <QAbstractTableModel>
+#include <QList>
+#include <QTimer>
+
+#include "io/TransferQueue.h"
+
+namespace qltfs {
+namespace app {
+
+/**
+ * @brief Table model over the write queue
+ *
+ * Items live in a TransferQueue, the same compact table TapeIO uses, and
+ * cells are formatted from it on demand, so there is no per-cell object.
+ * Appended items are collected and announced to views in one
+ * rowsInserted per batch interval, which keeps the view responsive
+ * while a large staging area is being added.
+ */
+class TransferQueueModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Columns of the queue view
+     */
+    enum Column {
+        NameColumn,
+        SizeColumn,
+        StatusColumn,
+        ColumnCount
+    };
+
+    explicit TransferQueueModel(QObject *parent = nullptr);
+    ~TransferQueueModel() override = default;
+
+    // QAbstractItemModel
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    /**
+     * @brief Queue items; views see them with the next batch
+     */
+    void appendItems(const QList<TransferItem> &items);
+
+    /**
+     * @brief Announce items still waiting for the next batch now
+     */
+    void flush();
+
+    /**
+     * @brief Remove rows in one pass
+     * @param rows Rows to remove, in any order
+     */
+    void removeItems(const QList<int> &rows);
+
+    /**
+     * @brief Remove every item
+     */
+    void clear();
+
+    /**
+     * @brief Change the status shown for a row
+     */
+    void setStatus(int row, TransferStatus status);
+
+    /**
+     * @brief The queue as shown (excludes items not yet flushed)
+     */
+    const TransferQueue &queue() const { return m_queue; }
+
+    /**
+     * @brief Items queued, including those not yet flushed
+     */
+    int itemCount() const { return m_queue.size() + m_pending.size(); }
+
+    /**
+     * @brief Display text of a transfer status
+     */
+    static QString statusText(TransferStatus status);
+
+private:
+    TransferQueue m_queue;
+    QList<TransferItem> m_pending;  ///< Appended, not yet announced
+    QTimer m_batchTimer;
+};
+
+} // namespace app
+} // namespace qltfs
+
+#endif // TRANSFERQUEUEMODEL_H
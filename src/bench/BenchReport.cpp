@@ -0,0 +1,100 @@
+/*
+ * QLTOTapeMan - Qt-based LTO Tape Manager
+ *
+ * Copyright (c) 2026 Jeffrey ZHU (zhxsh1225@gmail.com)
+ * https://github.com/Gypsop/QLTOTapeMan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "BenchReport.h"
+
+#include <QSysInfo>
+#include <QThread>
+
+#include <algorithm>
+#include <cstring>
+
+namespace bench {
+
+QJsonObject timing(double seconds, qint64 bytes)
+{
+    QJsonObject result;
+    result[QStringLiteral("seconds")] = seconds;
+    if (bytes >= 0) {
+        result[QStringLiteral("bytes")] = bytes;
+        result[QStringLiteral("MBps")] = seconds > 0 ? bytes / seconds / 1.0e6 : 0.0;
+    }
+    return result;
+}
+
+QJsonObject latency(QList<qint64> nanoseconds)
+{
+    QJsonObject result;
+    result[QStringLiteral("count")] = nanoseconds.size();
+    if (nanoseconds.isEmpty()) {
+        return result;
+    }
+
+    std::sort(nanoseconds.begin(), nanoseconds.end());
+    auto us = [](qint64 ns) { return ns / 1000.0; };
+    const int p99 = qMin(static_cast<int>(nanoseconds.size() * 0.99), static_cast<int>(nanoseconds.size()) - 1);
+
+    double sum = 0.0;
+    for (qint64 ns : nanoseconds) {
+        sum += ns;
+    }
+
+    result[QStringLiteral("minUs")] = us(nanoseconds.first());
+    result[QStringLiteral("medianUs")] = us(nanoseconds[nanoseconds.size() / 2]);
+    result[QStringLiteral("p99Us")] = us(nanoseconds[p99]);
+    result[QStringLiteral("maxUs")] = us(nanoseconds.last());
+    result[QStringLiteral("meanUs")] = sum / nanoseconds.size() / 1000.0;
+    return result;
+}
+
+void fillRandom(char *data, qint64 size, quint64 seed)
+{
+    quint64 state = seed;
+    qint64 i = 0;
+    for (; i + 8 <= size; i += 8) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        std::memcpy(data + i, &state, sizeof(state));
+    }
+    for (; i < size; ++i) {
+        data[i] = static_cast<char>(i * 131);
+    }
+}
+
+QByteArray randomData(qint64 size)
+{
+    QByteArray data(static_cast<qsizetype>(size), Qt::Uninitialized);
+    fillRandom(data.data(), size);
+    return data;
+}
+
+QJsonObject hostInfo()
+{
+    QJsonObject result;
+    result[QStringLiteral("os")] = QSysInfo::prettyProductName();
+    result[QStringLiteral("kernel")] = QSysInfo::kernelVersion();
+    result[QStringLiteral("cpu")] = QSysInfo::currentCpuArchitecture();
+    result[QStringLiteral("threads")] = QThread::idealThreadCount();
+    result[QStringLiteral("qt")] = QString::fromLatin1(qVersion());
+    return result;
+}
+
+} // namespace bench
@@ -0,0 +1,75 @@
+/*
+ * QLTOTapeMan - Qt-based LTO Tape Manager
+ *
+ * Copyright (c) 2026 Jeffrey ZHU (zhxsh1225@gmail.com)
+ * https://github.com/Gypsop/QLTOTapeMan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QList>
+
+namespace bench {
+
+/**
+ * @brief Wall clock for one measured section
+ */
+class Stopwatch
+{
+public:
+    Stopwatch() { m_timer.start(); }
+
+    void restart() { m_timer.restart(); }
+    qint64 nanoseconds() const { return m_timer.nsecsElapsed(); }
+    double seconds() const { return m_timer.nsecsElapsed() / 1.0e9; }
+
+private:
+    QElapsedTimer m_timer;
+};
+
+/**
+ * @brief Result entry with a duration and an optional byte count
+ *
+ * Adds "seconds" and, for a byte count, "bytes" and "MBps" (10^6 bytes).
+ */
+QJsonObject timing(double seconds, qint64 bytes = -1);
+
+/**
+ * @brief Latency distribution of repeated operations
+ *
+ * Adds "count", "minUs", "medianUs", "p99Us", "maxUs" and "meanUs".
+ */
+QJsonObject latency(QList<qint64> nanoseconds);
+
+/**
+ * @brief Fill @p data with incompressible bytes (xorshift64)
+ */
+void fillRandom(char *data, qint64 size, quint64 seed = 0x9E3779B97F4A7C15ULL);
+
+/**
+ * @brief Buffer of incompressible bytes
+ */
+QByteArray randomData(qint64 size);
+
+/**
+ * @brief Host details recorded with every report
+ */
+QJsonObject hostInfo();
+
+} // namespace bench
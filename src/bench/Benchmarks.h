@@ -0,0 +1,50 @@
+/*
+ * QLTOTapeMan - Qt-based LTO Tape Manager
+ *
+ * Copyright (c) 2026 Jeffrey ZHU (zhxsh1225@gmail.com)
+ * https://github.com/Gypsop/QLTOTapeMan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QJsonObject>
+#include <QString>
+
+namespace bench {
+
+/**
+ * @brief Sizes and targets shared by all benchmarks
+ */
+struct BenchConfig {
+    qint64 hashBytes = 256LL * 1024 * 1024;     ///< Data hashed per mode
+    int indexFiles = 1000000;                   ///< Files in the synthetic index
+    int filesPerDirectory = 1000;
+    qint64 pipelineBytes = 1024LL * 1024 * 1024; ///< Source file size for the pipeline run
+    quint32 blockSize = 512 * 1024;
+    int ringSlots = 32;
+    int commandLatencyUs = 200;                 ///< Simulated fixed cost per tape command
+    double driveBytesPerSecond = 400.0e6;       ///< Simulated drive rate (0 = unlimited)
+    QString workDir;                            ///< Where temporary files go
+    QString device;                             ///< Drive for SCSI round trips (empty = skip)
+    int scsiIterations = 1000;
+};
+
+QJsonObject runHashBench(const BenchConfig &config);
+QJsonObject runIndexBench(const BenchConfig &config);
+QJsonObject runPipelineBench(const BenchConfig &config);
+QJsonObject runScsiBench(const BenchConfig &config);
+
+} // namespace bench
@@ -0,0 +1,77 @@
+/*
+ * QLTOTapeMan - Qt-based LTO Tape Manager
+ *
+ * Copyright (c) 2026 Jeffrey ZHU (zhxsh1225@gmail.com)
+ * https://github.com/Gypsop/QLTOTapeMan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "Benchmarks.h"
+#include "BenchReport.h"
+
+#include "io/HashCalculator.h"
+
+#include <QByteArray>
+#include <QJsonArray>
+
+namespace bench {
+
+using qltfs::HashCalculator;
+using qltfs::HashMode;
+using qltfs::HashResult;
+
+QJsonObject runHashBench(const BenchConfig &config)
+{
+    // Streamed in pipeline-sized pieces, as TapeIO feeds the hasher
+    const qint64 chunk = config.blockSize;
+    const QByteArray data = randomData(qMin<qint64>(config.hashBytes, 1024LL * 1024 * 1024));
+
+    const HashMode modes[] = {
+        HashMode::MD5, HashMode::SHA1, HashMode::SHA256, HashMode::SHA512,
+        HashMode::XXH64, HashMode::XXH3, HashMode::XXH128, HashMode::BLAKE3
+    };
+
+    QJsonArray results;
+    for (HashMode mode : modes) {
+        HashCalculator hasher(mode);
+
+        Stopwatch watch;
+        for (qint64 offset = 0; offset < data.size(); offset += chunk) {
+            hasher.addData(data.constData() + offset, qMin<qint64>(chunk, data.size() - offset));
+        }
+        const HashResult streamed = hasher.result();
+        const double streamSeconds = watch.seconds();
+
+        // One call over the whole buffer lets BLAKE3 spread over threads
+        watch.restart();
+        const HashResult whole = hasher.hash(data);
+        const double wholeSeconds = watch.seconds();
+
+        QJsonObject entry;
+        entry[QStringLiteral("mode")] = HashCalculator::modeToString(mode);
+        entry[QStringLiteral("implementation")] = HashCalculator::implementationName(mode);
+        entry[QStringLiteral("streamed")] = timing(streamSeconds, data.size());
+        entry[QStringLiteral("oneShot")] = timing(wholeSeconds, data.size());
+        entry[QStringLiteral("consistent")] = streamed.success && whole.success && streamed.hash == whole.hash;
+        results.append(entry);
+    }
+
+    QJsonObject result;
+    result[QStringLiteral("chunkBytes")] = chunk;
+    result[QStringLiteral("modes")] = results;
+    return result;
+}
+
+} // namespace bench
@@ -0,0 +1,164 @@
+/*
+ * QLTOTapeMan - Qt-based LTO Tape Manager
+ *
+ * Copyright (c) 2026 Jeffrey ZHU (zhxsh1225@gmail.com)
+ * https://github.com/Gypsop/QLTOTapeMan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "Benchmarks.h"
+#include "BenchReport.h"
+
+#include "core/CompactIndex.h"
+#include "core/LtfsIndex.h"
+#include "xml/IndexParser.h"
+#include "xml/IndexWriter.h"
+
+#include <QByteArray>
+
+namespace bench {
+
+using qltfs::CompactIndex;
+using qltfs::IndexParser;
+using qltfs::IndexWriter;
+using qltfs::LtfsIndex;
+
+namespace {
+
+/**
+ * @brief LTFS index XML with @p files files spread over directories
+ */
+QByteArray syntheticIndex(int files, int filesPerDirectory)
+{
+    static const char TIME[] = "2026-01-01T00:00:00.000000000Z";
+
+    QByteArray xml;
+    xml.reserve(static_cast<qsizetype>(files) * 700);
+    xml += "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+           "<ltfsindex version=\"2.4.0\">"
+           "<creator>qltfs_bench</creator>"
+           "<volumeuuid>00000000-0000-4000-8000-000000000000</volumeuuid>"
+           "<generationnumber>1</generationnumber>"
+           "<updatetime>";
+    xml += TIME;
+    xml += "</updatetime>"
+           "<location><partition>a</partition><startblock>5</startblock></location>"
+           "<allowpolicyupdate>true</allowpolicyupdate>"
+           "<highestfileuid>";
+    xml += QByteArray::number(files + files / qMax(1, filesPerDirectory) + 1);
+    xml += "</highestfileuid>"
+           "<directory><name></name><readonly>false</readonly>";
+
+    auto times = [&xml]() {
+        for (const char *tag : {"creationtime", "changetime", "modifytime", "accesstime", "backuptime"}) {
+            xml += '<'; xml += tag; xml += '>';
+            xml += TIME;
+            xml += "</"; xml += tag; xml += '>';
+        }
+    };
+    times();
+    xml += "<uid>1</uid><contents>";
+
+    quint64 uid = 2;
+    quint64 block = 100;
+    for (int first = 0; first < files; first += filesPerDirectory) {
+        xml += "<directory><name>dir";
+        xml += QByteArray::number(first / filesPerDirectory);
+        xml += "</name><readonly>false</readonly>";
+        times();
+        xml += "<uid>";
+        xml += QByteArray::number(uid++);
+        xml += "</uid><contents>";
+
+        const int last = qMin(files, first + filesPerDirectory);
+        for (int i = first; i < last; ++i) {
+            const qint64 length = 4096 + (i % 97) * 65536;
+            xml += "<file><name>file";
+            xml += QByteArray::number(i);
+            xml += ".dat</name><length>";
+            xml += QByteArray::number(length);
+            xml += "</length><readonly>false</readonly>";
+            times();
+            xml += "<uid>";
+            xml += QByteArray::number(uid++);
+            xml += "</uid><extentinfo><extent><fileoffset>0</fileoffset>"
+                   "<partition>b</partition><startblock>";
+            xml += QByteArray::number(block);
+            xml += "</startblock><byteoffset>0</byteoffset><bytecount>";
+            xml += QByteArray::number(length);
+            xml += "</bytecount></extent></extentinfo>"
+                   "<extendedattributes><extendedattribute><key>ltfs.hash.sha256sum</key><value>";
+            xml += QByteArray::number(uid * 2654435761ULL, 16).rightJustified(64, '0');
+            xml += "</value></extendedattribute></extendedattributes></file>";
+            block += (length + 524287) / 524288 + 1;
+        }
+        xml += "</contents></directory>";
+    }
+
+    xml += "</contents></directory></ltfsindex>\n";
+    return xml;
+}
+
+} // namespace
+
+QJsonObject runIndexBench(const BenchConfig &config)
+{
+    QJsonObject result;
+    result[QStringLiteral("files")] = config.indexFiles;
+
+    Stopwatch watch;
+    const QByteArray xml = syntheticIndex(config.indexFiles, config.filesPerDirectory);
+    result[QStringLiteral("generate")] = timing(watch.seconds(), xml.size());
+
+    IndexParser parser;
+    watch.restart();
+    QSharedPointer<LtfsIndex> index = parser.parse(xml);
+    result[QStringLiteral("parse")] = timing(watch.seconds(), xml.size());
+    if (!index) {
+        result[QStringLiteral("error")] = parser.errorMessage();
+        return result;
+    }
+
+    watch.restart();
+    QSharedPointer<CompactIndex> compact = parser.parseCompact(xml);
+    result[QStringLiteral("parseCompact")] = timing(watch.seconds(), xml.size());
+
+    IndexWriter writer;
+    watch.restart();
+    const QByteArray written = writer.write(*index);
+    result[QStringLiteral("write")] = timing(watch.seconds(), written.size());
+
+    // Streamed to a sink that drops the blocks, once cold and once with
+    // every directory cached
+    qint64 streamed = 0;
+    auto sink = [&streamed](const char *, qint64 length) {
+        streamed += length;
+        return true;
+    };
+
+    watch.restart();
+    writer.writeBlocks(*index, config.blockSize, sink);
+    result[QStringLiteral("writeBlocks")] = timing(watch.seconds(), streamed);
+
+    streamed = 0;
+    watch.restart();
+    writer.writeBlocks(*index, config.blockSize, sink);
+    result[QStringLiteral("writeBlocksCached")] = timing(watch.seconds(), streamed);
+    result[QStringLiteral("compactLoaded")] = !compact.isNull();
+
+    return result;
+}
+
+} // namespace bench
@@ -0,0 +1,243 @@
+/*
+ * QLTOTapeMan - Qt-based LTO Tape Manager
+ *
+ * Copyright (c) 2026 Jeffrey ZHU (zhxsh1225@gmail.com)
+ * https://github.com/Gypsop/QLTOTapeMan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "Benchmarks.h"
+#include "BenchReport.h"
+
+#include "io/BlockManager.h"
+#include "io/BlockRing.h"
+#include "io/HashCalculator.h"
+#include "io/SourceReader.h"
+
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QScopedPointer>
+#include <QTemporaryFile>
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrent>
+
+namespace bench {
+
+using qltfs::BlockPool;
+using qltfs::BlockRing;
+using qltfs::BlockSlot;
+using qltfs::HashCalculator;
+using qltfs::HashMode;
+using qltfs::SourceReader;
+using qltfs::SourceReadMode;
+
+namespace {
+
+/**
+ * @brief Stand-in for the drive: a fixed cost per command plus the transfer time
+ */
+class MockDrive
+{
+public:
+    MockDrive(int latencyUs, double bytesPerSecond)
+        : m_latencyNs(static_cast<qint64>(latencyUs) * 1000)
+        , m_bytesPerSecond(bytesPerSecond)
+    {
+    }
+
+    void write(quint32 length)
+    {
+        qint64 ns = m_latencyNs;
+        if (m_bytesPerSecond > 0) {
+            ns += static_cast<qint64>(length * 1.0e9 / m_bytesPerSecond);
+        }
+        m_commands++;
+
+        // Sleep for the bulk and spin the rest; sleeps alone overshoot
+        QElapsedTimer timer;
+        timer.start();
+        if (ns > 2000000) {
+            QThread::usleep(static_cast<unsigned long>((ns - 1000000) / 1000));
+        }
+        while (timer.nsecsElapsed() < ns) {
+        }
+    }
+
+    qint64 commands() const { return m_commands; }
+
+private:
+    qint64 m_latencyNs;
+    double m_bytesPerSecond;
+    qint64 m_commands = 0;
+};
+
+/**
+ * @brief Same read-ahead loop as TapeIO's reader thread
+ */
+void fillRing(QFile &file, BlockRing &ring)
+{
+    for (;;) {
+        BlockSlot *slot = ring.acquireWrite();
+        if (!slot) {
+            return;
+        }
+
+        qint64 filled = 0;
+        while (filled < slot->capacity) {
+            const qint64 n = file.read(slot->data + filled, slot->capacity - filled);
+            if (n <= 0) {
+                break;
+            }
+            filled += n;
+        }
+
+        const bool last = filled < slot->capacity || file.atEnd();
+        ring.commitWrite(static_cast<uint32_t>(filled), last);
+        if (last) {
+            return;
+        }
+    }
+}
+
+QString readModeName(SourceReadMode mode)
+{
+    switch (mode) {
+    case SourceReadMode::Buffered:   return QStringLiteral("buffered");
+    case SourceReadMode::Sequential: return QStringLiteral("sequential");
+    case SourceReadMode::Direct:     return QStringLiteral("direct");
+    }
+    return QString();
+}
+
+QJsonObject runPipeline(const BenchConfig &config, const QString &path, HashMode mode,
+                        int latencyUs, double bytesPerSecond,
+                        SourceReadMode readMode = SourceReadMode::Buffered)
+{
+    QFile file(path);
+    SourceReader source;
+    const bool buffered = readMode == SourceReadMode::Buffered;
+    if (buffered ? !file.open(QIODevice::ReadOnly) : !source.open(path, readMode)) {
+        QJsonObject failed;
+        failed[QStringLiteral("error")] = buffered ? file.errorString() : source.errorString();
+        return failed;
+    }
+
+    BlockPool pool(config.blockSize, config.ringSlots);
+    BlockRing ring(&pool, config.ringSlots);
+    MockDrive drive(latencyUs, bytesPerSecond);
+
+    QScopedPointer<HashCalculator> hasher;
+    if (mode != HashMode::None) {
+        hasher.reset(new HashCalculator(mode));
+    }
+    QThreadPool hashPool;
+    hashPool.setMaxThreadCount(1);
+
+    Stopwatch watch;
+    QString readError;
+    QScopedPointer<QThread> reader(buffered
+        ? QThread::create(fillRing, std::ref(file), std::ref(ring))
+        : QThread::create([&source, &ring, &readError]() { source.fillRing(0, -1, ring, readError); }));
+    reader->start();
+
+    qint64 bytes = 0;
+    for (;;) {
+        BlockSlot *slot = ring.acquireRead();
+        if (!slot) {
+            break;
+        }
+
+        // Hash the slot while the drive "writes" it, as TapeIO does
+        QFuture<void> hashJob;
+        if (hasher && slot->length > 0) {
+            hashJob = QtConcurrent::run(&hashPool, [&hasher, slot]() {
+                hasher->addData(slot->data, slot->length);
+            });
+        }
+        if (slot->length > 0) {
+            drive.write(slot->length);
+        }
+        hashJob.waitForFinished();
+
+        bytes += slot->length;
+        const bool last = slot->last;
+        ring.releaseRead();
+        if (last) {
+            break;
+        }
+    }
+    reader->wait();
+
+    QJsonObject result = timing(watch.seconds(), bytes);
+    result[QStringLiteral("hash")] = HashCalculator::modeToString(mode);
+    result[QStringLiteral("sourceRead")] = readModeName(buffered ? readMode : source.mode());
+    if (!buffered) {
+        result[QStringLiteral("async")] = source.isAsync();
+    }
+    if (!readError.isEmpty()) {
+        result[QStringLiteral("error")] = readError;
+    }
+    result[QStringLiteral("commandLatencyUs")] = latencyUs;
+    result[QStringLiteral("driveMBps")] = bytesPerSecond / 1.0e6;
+    result[QStringLiteral("commands")] = drive.commands();
+    result[QStringLiteral("underruns")] = static_cast<qint64>(ring.underruns());
+    result[QStringLiteral("overruns")] = static_cast<qint64>(ring.overruns());
+    return result;
+}
+
+} // namespace
+
+QJsonObject runPipelineBench(const BenchConfig &config)
+{
+    QJsonObject result;
+
+    QTemporaryFile source(QDir(config.workDir).filePath(QStringLiteral("qltfs_bench_XXXXXX.dat")));
+    if (!source.open()) {
+        result[QStringLiteral("error")] = source.errorString();
+        return result;
+    }
+
+    // Written once; the runs read it back (usually from the page cache)
+    Stopwatch watch;
+    const QByteArray chunk = randomData(4 * 1024 * 1024);
+    for (qint64 written = 0; written < config.pipelineBytes; written += chunk.size()) {
+        if (source.write(chunk) != chunk.size()) {
+            result[QStringLiteral("error")] = source.errorString();
+            return result;
+        }
+    }
+    source.flush();
+    result[QStringLiteral("sourceWrite")] = timing(watch.seconds(), source.size());
+
+    result[QStringLiteral("blockSize")] = static_cast<qint64>(config.blockSize);
+    result[QStringLiteral("ringSlots")] = config.ringSlots;
+
+    // Source and ring alone, then with a drive and the hashes TapeIO may run
+    QJsonArray runs;
+    runs.append(runPipeline(config, source.fileName(), HashMode::None, 0, 0.0));
+    for (SourceReadMode readMode : {SourceReadMode::Sequential, SourceReadMode::Direct}) {
+        runs.append(runPipeline(config, source.fileName(), HashMode::None, 0, 0.0, readMode));
+    }
+    for (HashMode mode : {HashMode::None, HashMode::XXH3, HashMode::SHA256, HashMode::BLAKE3}) {
+        runs.append(runPipeline(config, source.fileName(), mode,
+                                config.commandLatencyUs, config.driveBytesPerSecond));
+    }
+    result[QStringLiteral("runs")] = runs;
+    return result;
+}
+
+} // namespace bench
@@ -0,0 +1,91 @@
+/*
+ * QLTOTapeMan - Qt-based LTO Tape Manager
+ *
+ * Copyright (c) 2026 Jeffrey ZHU (zhxsh1225@gmail.com)
+ * https://github.com/Gypsop/QLTOTapeMan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "Benchmarks.h"
+#include "BenchReport.h"
+
+#include "device/ScsiCommand.h"
+
+#include <functional>
+
+namespace bench {
+
+using qltfs::ScsiCommand;
+using qltfs::ScsiCommandResult;
+
+namespace {
+
+// Supported log pages list: small, always present, no side effects
+constexpr quint8 LOG_PAGE_SUPPORTED = 0x00;
+
+QJsonObject measure(int iterations, const std::function<ScsiCommandResult()> &command)
+{
+    QList<qint64> samples;
+    samples.reserve(iterations);
+    int failures = 0;
+    QString lastError;
+
+    for (int i = 0; i < iterations; ++i) {
+        Stopwatch watch;
+        const ScsiCommandResult result = command();
+        samples.append(watch.nanoseconds());
+        if (!result.success) {
+            failures++;
+            lastError = result.errorMessage();
+        }
+    }
+
+    QJsonObject entry = latency(samples);
+    entry[QStringLiteral("failures")] = failures;
+    if (!lastError.isEmpty()) {
+        entry[QStringLiteral("lastError")] = lastError;
+    }
+    return entry;
+}
+
+} // namespace
+
+QJsonObject runScsiBench(const BenchConfig &config)
+{
+    QJsonObject result;
+    result[QStringLiteral("device")] = config.device;
+
+    ScsiCommand scsi(config.device);
+    if (!scsi.open()) {
+        result[QStringLiteral("error")] = QStringLiteral("Failed to open device");
+        return result;
+    }
+
+    // Commands without data movement on tape, so the head does not move
+    result[QStringLiteral("testUnitReady")] = measure(config.scsiIterations, [&scsi]() {
+        return scsi.testUnitReady();
+    });
+    result[QStringLiteral("readPosition")] = measure(config.scsiIterations, [&scsi]() {
+        return scsi.readPosition(0);
+    });
+    result[QStringLiteral("logSense")] = measure(config.scsiIterations, [&scsi]() {
+        return scsi.logSense(LOG_PAGE_SUPPORTED, 0, 256);
+    });
+
+    scsi.close();
+    return result;
+}
+
+} // namespace bench
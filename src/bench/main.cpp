@@ -0,0 +1,157 @@
+/*
+ * QLTOTapeMan - Qt-based LTO Tape Manager
+ *
+ * Copyright (c) 2026 Jeffrey ZHU (zhxsh1225@gmail.com)
+ * https://github.com/Gypsop/QLTOTapeMan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "Benchmarks.h"
+#include "BenchReport.h"
+
+#include "util/Tracer.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QJsonDocument>
+#include <QTextStream>
+
+using namespace bench;
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationName(QStringLiteral("qltfs_bench"));
+    app.setOrganizationName(QStringLiteral("QLTOTapeMan"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Benchmarks for the libqltfs I/O stack. Prints JSON."));
+    parser.addHelpOption();
+
+    const QCommandLineOption suitesOption(QStringLiteral("suite"),
+        QStringLiteral("Benchmark to run: hash, index, pipeline, scsi (repeatable; default all but scsi)."),
+        QStringLiteral("name"));
+    const QCommandLineOption hashOption(QStringLiteral("hash-mib"),
+        QStringLiteral("MiB hashed per mode."), QStringLiteral("n"), QStringLiteral("256"));
+    const QCommandLineOption filesOption(QStringLiteral("index-files"),
+        QStringLiteral("Files in the synthetic index."), QStringLiteral("n"), QStringLiteral("1000000"));
+    const QCommandLineOption pipelineOption(QStringLiteral("pipeline-mib"),
+        QStringLiteral("MiB streamed through the write pipeline."), QStringLiteral("n"), QStringLiteral("1024"));
+    const QCommandLineOption blockOption(QStringLiteral("block-kib"),
+        QStringLiteral("Block size in KiB."), QStringLiteral("n"), QStringLiteral("512"));
+    const QCommandLineOption latencyOption(QStringLiteral("latency-us"),
+        QStringLiteral("Simulated cost per tape command."), QStringLiteral("us"), QStringLiteral("200"));
+    const QCommandLineOption rateOption(QStringLiteral("drive-mbps"),
+        QStringLiteral("Simulated drive rate in MB/s (0 = unlimited)."), QStringLiteral("n"), QStringLiteral("400"));
+    const QCommandLineOption deviceOption(QStringLiteral("device"),
+        QStringLiteral("Tape drive for SCSI round trips (enables the scsi suite)."), QStringLiteral("path"));
+    const QCommandLineOption iterationsOption(QStringLiteral("scsi-iterations"),
+        QStringLiteral("Commands issued per SCSI measurement."), QStringLiteral("n"), QStringLiteral("1000"));
+    const QCommandLineOption workDirOption(QStringLiteral("work-dir"),
+        QStringLiteral("Directory for temporary files."), QStringLiteral("path"), QDir::tempPath());
+    const QCommandLineOption outputOption(QStringLiteral("output"),
+        QStringLiteral("Write the JSON report to a file instead of stdout."), QStringLiteral("file"));
+    const QCommandLineOption traceOption(QStringLiteral("trace"),
+        QStringLiteral("Record trace spans into a file (.json: Chrome, .pftrace: Perfetto)."), QStringLiteral("file"));
+
+    parser.addOptions({suitesOption, hashOption, filesOption, pipelineOption, blockOption, latencyOption,
+                       rateOption, deviceOption, iterationsOption, workDirOption, outputOption, traceOption});
+    parser.process(app);
+
+    BenchConfig config;
+    config.hashBytes = parser.value(hashOption).toLongLong() * 1024 * 1024;
+    config.indexFiles = parser.value(filesOption).toInt();
+    config.pipelineBytes = parser.value(pipelineOption).toLongLong() * 1024 * 1024;
+    config.blockSize = parser.value(blockOption).toUInt() * 1024;
+    config.commandLatencyUs = parser.value(latencyOption).toInt();
+    config.driveBytesPerSecond = parser.value(rateOption).toDouble() * 1.0e6;
+    config.device = parser.value(deviceOption);
+    config.scsiIterations = parser.value(iterationsOption).toInt();
+    config.workDir = parser.value(workDirOption);
+
+    if (config.blockSize == 0 || config.hashBytes <= 0 || config.indexFiles < 0 || config.pipelineBytes <= 0) {
+        QTextStream(stderr) << "Invalid size argument\n";
+        return 2;
+    }
+
+    QStringList suites = parser.values(suitesOption);
+    if (suites.isEmpty()) {
+        suites = {QStringLiteral("hash"), QStringLiteral("index"), QStringLiteral("pipeline")};
+        if (!config.device.isEmpty()) {
+            suites.append(QStringLiteral("scsi"));
+        }
+    }
+
+    if (parser.isSet(traceOption)) {
+        qltfs::Tracer::instance().setThreadName(QStringLiteral("Main"));
+        qltfs::Tracer::instance().setEnabled(true);
+    }
+
+    QJsonObject report;
+    report[QStringLiteral("timestamp")] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    report[QStringLiteral("host")] = hostInfo();
+
+    QJsonObject results;
+    for (const QString &suite : suites) {
+        if (suite == QLatin1String("hash")) {
+            results[suite] = runHashBench(config);
+        } else if (suite == QLatin1String("index")) {
+            results[suite] = runIndexBench(config);
+        } else if (suite == QLatin1String("pipeline")) {
+            results[suite] = runPipelineBench(config);
+        } else if (suite == QLatin1String("scsi")) {
+            if (config.device.isEmpty()) {
+                QTextStream(stderr) << "The scsi suite needs --device\n";
+                return 2;
+            }
+            results[suite] = runScsiBench(config);
+        } else {
+            QTextStream(stderr) << "Unknown suite: " << suite << '\n';
+            return 2;
+        }
+    }
+    report[QStringLiteral("results")] = results;
+
+    if (parser.isSet(traceOption)) {
+        qltfs::Tracer &tracer = qltfs::Tracer::instance();
+        tracer.setEnabled(false);
+        const QString tracePath = parser.value(traceOption);
+        QString error;
+        if (!tracer.exportTrace(tracePath, qltfs::Tracer::formatForFile(tracePath), &error)) {
+            QTextStream(stderr) << error << '\n';
+            return 1;
+        }
+        QJsonObject trace;
+        trace[QStringLiteral("file")] = tracePath;
+        trace[QStringLiteral("events")] = tracer.eventCount();
+        trace[QStringLiteral("dropped")] = static_cast<qint64>(tracer.droppedEvents());
+        report[QStringLiteral("trace")] = trace;
+    }
+
+    const QByteArray json = QJsonDocument(report).toJson(QJsonDocument::Indented);
+    if (parser.isSet(outputOption)) {
+        QFile file(parser.value(outputOption));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(json) != json.size()) {
+            QTextStream(stderr) << "Failed to write " << file.fileName() << ": " << file.errorString() << '\n';
+            return 1;
+        }
+    } else {
+        QTextStream(stdout) << json;
+    }
+    return 0;
+}
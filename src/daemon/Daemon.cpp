@@ -0,0 +1,268 @@
+/*
+ * QLTOTapeMan - Qt-based LTO Tape Manager
+ *
+ * Copyright (c) 2026 Jeffrey ZHU (zhxsh1225@gmail.com)
+ * https://github.com/Gypsop/QLTOTapeMan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "Daemon.h"
+#include "DriveWorker.h"
+
+#include <QDir>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QSet>
+
+using namespace qltfs;
+
+namespace qltfsd {
+
+// Longest request line accepted from a client
+static constexpr qint64 MAX_REQUEST_BYTES = 1024 * 1024;
+
+Daemon::Daemon(const DaemonConfig &config, QObject *parent)
+    : QObject(parent)
+    , m_config(config)
+    , m_queue(QDir(config.stateDir).filePath(QStringLiteral("jobs.json")))
+{
+    if (m_config.socketName.isEmpty()) {
+        m_config.socketName = defaultSocketName();
+    }
+    connect(&m_monitor, &DeviceMonitor::devicesChanged, this, &Daemon::refreshDrives);
+}
+
+Daemon::~Daemon()
+{
+    stop();
+}
+
+QString Daemon::defaultSocketName()
+{
+    return QStringLiteral("qltfsd");
+}
+
+bool Daemon::start()
+{
+    if (!QDir().mkpath(m_config.stateDir)) {
+        m_lastError = QStringLiteral("Cannot create state directory %1").arg(m_config.stateDir);
+        return false;
+    }
+    if (!m_queue.load()) {
+        m_lastError = m_queue.lastError();
+        return false;
+    }
+
+    m_server = new QLocalServer(this);
+    m_server->setSocketOptions(QLocalServer::UserAccessOption);
+    // A socket left behind by a crashed instance would block listen()
+    QLocalServer::removeServer(m_config.socketName);
+    if (!m_server->listen(m_config.socketName)) {
+        m_lastError = QStringLiteral("Cannot listen on %1: %2").arg(m_config.socketName, m_server->errorString());
+        return false;
+    }
+    connect(m_server, &QLocalServer::newConnection, this, &Daemon::acceptConnections);
+
+    // Without notifications drives present at start are all we use
+    m_monitor.start();
+    refreshDrives();
+    return true;
+}
+
+void Daemon::stop()
+{
+    m_monitor.stop();
+    if (m_server) {
+        m_server->close();
+    }
+
+    // Signal every drive first so they wind down in parallel
+    for (auto &entry : m_workers) {
+        entry.second->requestStop();
+    }
+    m_workers.clear();
+}
+
+void Daemon::refreshDrives()
+{
+    m_enumerator.refresh();
+
+    QSet<QString> serials;
+    for (const auto &entry : m_workers) {
+        serials.insert(entry.second->status().value(QStringLiteral("serial")).toString());
+    }
+
+    for (const TapeDeviceInfo &info : m_enumerator.tapeDevices()) {
+        if (!m_config.drives.isEmpty() && !m_config.drives.contains(info.devicePath)) {
+            continue;
+        }
+        if (m_workers.count(info.devicePath) > 0) {
+            continue;
+        }
+        // One worker per drive, however many nodes lead to it
+        if (!info.serialNumber.isEmpty() && serials.contains(info.serialNumber)) {
+            continue;
+        }
+        serials.insert(info.serialNumber);
+
+        auto worker = std::make_unique<DriveWorker>(info, &m_queue, m_config.stateDir, m_config.options);
+        worker->start();
+        m_workers.emplace(info.devicePath, std::move(worker));
+    }
+}
+
+void Daemon::acceptConnections()
+{
+    while (QLocalSocket *socket = m_server->nextPendingConnection()) {
+        connect(socket, &QLocalSocket::disconnected, socket, &QObject::deleteLater);
+        connect(socket, &QLocalSocket::readyRead, this, [this, socket]() { readRequests(socket); });
+    }
+}
+
+void Daemon::readRequests(QLocalSocket *socket)
+{
+    while (socket->canReadLine()) {
+        const QByteArray line = socket->readLine().trimmed();
+        if (line.isEmpty()) {
+            continue;
+        }
+
+        QJsonObject response;
+        QJsonParseError parseError;
+        const QJsonDocument request = QJsonDocument::fromJson(line, &parseError);
+        if (!request.isObject()) {
+            response[QStringLiteral("error")] = QStringLiteral("Invalid request: %1").arg(parseError.errorString());
+        } else {
+            response = handleRequest(request.object());
+        }
+        socket->write(QJsonDocument(response).toJson(QJsonDocument::Compact) + '\n');
+    }
+
+    if (socket->bytesAvailable() > MAX_REQUEST_BYTES) {
+        socket->abort();
+    }
+}
+
+QJsonObject Daemon::handleRequest(const QJsonObject &request)
+{
+    const QString method = request.value(QStringLiteral("method")).toString();
+    const QJsonObject params = request.value(QStringLiteral("params")).toObject();
+    const quint64 id = params.value(QStringLiteral("id")).toString().toULongLong();
+
+    QJsonObject response;
+    response[QStringLiteral("id")] = request.value(QStringLiteral("id"));
+
+    QString error;
+    if (method == QLatin1String("submit")) {
+        const QJsonObject result = submitJob(params, error);
+        if (error.isEmpty()) {
+            response[QStringLiteral("result")] = result;
+        }
+    } else if (method == QLatin1String("list")) {
+        JobState filter = JobState::Queued;
+        const QString state = params.value(QStringLiteral("state")).toString();
+        if (!state.isEmpty() && !parseJobState(state, filter)) {
+            error = QStringLiteral("Unknown state %1").arg(state);
+        } else {
+            QJsonArray jobs;
+            for (const Job &job : m_queue.jobs()) {
+                if (state.isEmpty() || job.state == filter) {
+                    jobs.append(job.toJson());
+                }
+            }
+            response[QStringLiteral("result")] = jobs;
+        }
+    } else if (method == QLatin1String("get")) {
+        Job job;
+        if (m_queue.find(id, job)) {
+            response[QStringLiteral("result")] = job.toJson();
+        } else {
+            error = QStringLiteral("No job %1").arg(id);
+        }
+    } else if (method == QLatin1String("cancel")) {
+        bool running = false;
+        if (cancelJob(id, running, error)) {
+            QJsonObject result;
+            result[QStringLiteral("running")] = running;
+            response[QStringLiteral("result")] = result;
+        }
+    } else if (method == QLatin1String("drives")) {
+        QJsonArray drives;
+        for (const auto &entry : m_workers) {
+            drives.append(entry.second->status());
+        }
+        response[QStringLiteral("result")] = drives;
+    } else {
+        error = QStringLiteral("Unknown method %1").arg(method);
+    }
+
+    if (!error.isEmpty()) {
+        response[QStringLiteral("error")] = error;
+    }
+    return response;
+}
+
+QJsonObject Daemon::submitJob(const QJsonObject &params, QString &error)
+{
+    Job job = Job::fromJson(params);
+    if (!parseJobType(params.value(QStringLiteral("type")).toString(), job.type)) {
+        error = QStringLiteral("Unknown job type");
+        return QJsonObject();
+    }
+    error = job.validate();
+    if (!error.isEmpty()) {
+        return QJsonObject();
+    }
+
+    // Only what the client asked for; the rest is the queue's own bookkeeping
+    Job request;
+    request.type = job.type;
+    request.priority = job.priority;
+    request.sources = job.sources;
+    request.destination = job.destination;
+    request.indexPath = job.indexPath;
+    request.drive = job.drive;
+    request.volume = job.volume;
+
+    const quint64 id = m_queue.submit(request);
+    if (id == 0) {
+        error = m_queue.lastError();
+        return QJsonObject();
+    }
+
+    QJsonObject result;
+    result[QStringLiteral("id")] = QString::number(id);
+    return result;
+}
+
+bool Daemon::cancelJob(quint64 id, bool &running, QString &error)
+{
+    if (!m_queue.cancel(id, running)) {
+        error = m_queue.lastError();
+        return false;
+    }
+    if (running) {
+        for (auto &entry : m_workers) {
+            if (entry.second->cancelJob(id)) {
+                break;
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace qltfsd
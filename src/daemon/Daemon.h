@@ -0,0 +1,118 @@
+/*
+ * QLTOTapeMan - Qt-based LTO Tape Manager
+ *
+ * Copyright (c) 2026 Jeffrey ZHU (zhxsh1225@gmail.com)
+ * https://github.com/Gypsop/QLTOTapeMan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "JobQueue.h"
+
+#include "device/DeviceEnumerator.h"
+#include "device/DeviceMonitor.h"
+#include "io/TapeIO.h"
+
+#include <QJsonObject>
+#include <QObject>
+#include <QStringList>
+
+#include <map>
+#include <memory>
+
+class QLocalServer;
+class QLocalSocket;
+
+namespace qltfsd {
+
+class DriveWorker;
+
+/**
+ * @brief Settings of a daemon instance
+ */
+struct DaemonConfig {
+    QString stateDir;               ///< Queue file and write journals
+    QString socketName;             ///< Local socket the RPC interface listens on
+    QStringList drives;             ///< Device paths to use (empty = every drive found)
+    qltfs::TransferOptions options; ///< Applied to every job
+};
+
+/**
+ * @brief Headless job service for all drives of the host
+ *
+ * Keeps the job queue, one DriveWorker per drive and a local socket
+ * (Unix domain socket or named pipe, owner only) speaking JSON lines:
+ * each request is {"id", "method", "params"} on one line and gets one
+ * line back with the same "id" and either "result" or "error".
+ *
+ * Methods:
+ * - submit: params are a job (Job::toJson() fields); result {"id"}
+ * - list: optional "state" filter; result is an array of jobs
+ * - get: "id"; result is the job
+ * - cancel: "id"; result {"running"}, true if a drive is stopping it
+ * - drives: result is an array of DriveWorker::status()
+ *
+ * Drives that appear later (hotplug, a library powering up) get a
+ * worker once DeviceMonitor reports them. Write jobs end as "written",
+ * not "completed": the daemon puts data on tape but writes no LTFS
+ * index, so the journal of each one stays in the state directory and
+ * records where on tape each file landed until an index is written.
+ */
+class Daemon : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit Daemon(const DaemonConfig &config, QObject *parent = nullptr);
+    ~Daemon() override;
+
+    /**
+     * @brief Load the queue, start the drive workers and listen
+     */
+    bool start();
+
+    /**
+     * @brief Stop listening and stop every worker
+     *
+     * Running jobs are interrupted and queued again for the next start.
+     */
+    void stop();
+
+    QString lastError() const { return m_lastError; }
+
+    /**
+     * @brief Socket name used when none is configured
+     */
+    static QString defaultSocketName();
+
+private:
+    void refreshDrives();
+    void acceptConnections();
+    void readRequests(QLocalSocket *socket);
+    QJsonObject handleRequest(const QJsonObject &request);
+    QJsonObject submitJob(const QJsonObject &params, QString &error);
+    bool cancelJob(quint64 id, bool &running, QString &error);
+
+    DaemonConfig m_config;
+    JobQueue m_queue;
+    qltfs::DeviceEnumerator m_enumerator;
+    qltfs::DeviceMonitor m_monitor;
+    QLocalServer *m_server = nullptr;
+    std::map<QString, std::unique_ptr<DriveWorker>> m_workers;  ///< By device path
+    QString m_lastError;
+};
+
+} // namespace qltfsd
@@ -0,0 +1,298 @@
+/*
+ * QLTOTapeMan - Qt-based LTO Tape Manager
+ *
+ * Copyright (c) 2026 Jeffrey ZHU (zhxsh1225@gmail.com)
+ * https://github.com/Gypsop/QLTOTapeMan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "DriveWorker.h"
+#include "JobQueue.h"
+
+#include "xml/IndexParser.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QMutexLocker>
+
+using namespace qltfs;
+
+namespace qltfsd {
+
+// Medium serial number MAM attribute, identifies the cartridge
+static constexpr quint16 MAM_MEDIUM_SERIAL_NUMBER = 0x0401;
+
+// Wait before trying a drive again that could not be opened or was empty
+static constexpr int RETRY_INTERVAL_MS = 30000;
+
+// Longest wait for new work before the cartridge is checked again
+static constexpr int IDLE_POLL_MS = 5000;
+
+// How often progress of a running write is copied into the queue
+static constexpr int PROGRESS_INTERVAL_MS = 1000;
+
+DriveWorker::DriveWorker(const TapeDeviceInfo &info, JobQueue *queue, const QString &stateDir,
+                         const TransferOptions &options)
+    : m_info(info)
+    , m_queue(queue)
+    , m_stateDir(stateDir)
+    , m_options(options)
+    , m_state(QStringLiteral("offline"))
+{
+}
+
+DriveWorker::~DriveWorker()
+{
+    stop();
+}
+
+void DriveWorker::start()
+{
+    if (m_thread) {
+        return;
+    }
+    m_stopping = false;
+    m_thread.reset(QThread::create([this]() { run(); }));
+    m_thread->start();
+}
+
+void DriveWorker::requestStop()
+{
+    m_stopping = true;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_io) {
+            m_io->cancel();
+        }
+    }
+    m_queue->wakeAll();
+}
+
+void DriveWorker::stop()
+{
+    if (!m_thread) {
+        return;
+    }
+
+    requestStop();
+    m_thread->wait();
+    m_thread.reset();
+}
+
+bool DriveWorker::cancelJob(quint64 id)
+{
+    QMutexLocker locker(&m_mutex);
+    if (id == 0 || m_jobId != id) {
+        return false;
+    }
+    m_cancelled = true;
+    if (m_io) {
+        m_io->cancel();
+    }
+    return true;
+}
+
+QJsonObject DriveWorker::status() const
+{
+    QMutexLocker locker(&m_mutex);
+    QJsonObject object;
+    object[QStringLiteral("device")] = m_info.devicePath;
+    object[QStringLiteral("name")] = m_info.displayName();
+    object[QStringLiteral("serial")] = m_info.serialNumber;
+    object[QStringLiteral("state")] = m_state;
+    object[QStringLiteral("volume")] = m_volume;
+    object[QStringLiteral("job")] = m_jobId ? QString::number(m_jobId) : QString();
+    object[QStringLiteral("error")] = m_error;
+    return object;
+}
+
+QString DriveWorker::journalPath(const QString &stateDir, quint64 id)
+{
+    return QDir(stateDir).filePath(QStringLiteral("job-%1.journal").arg(id));
+}
+
+void DriveWorker::run()
+{
+    TapeDevice device(m_info);
+
+    while (!m_stopping) {
+        if (!device.isOpen() && !device.open()) {
+            setState(QStringLiteral("offline"), QString(), device.lastError());
+            m_queue->waitForWork(RETRY_INTERVAL_MS);
+            continue;
+        }
+        if (!device.testReady()) {
+            setState(QStringLiteral("empty"));
+            m_queue->waitForWork(RETRY_INTERVAL_MS);
+            continue;
+        }
+
+        // Read every round: operators swap cartridges between jobs
+        const QString volume = QString::fromLatin1(
+            device.readMamAttributes().value(MAM_MEDIUM_SERIAL_NUMBER)).trimmed();
+
+        Job job;
+        if (!m_queue->takeNext(m_info.devicePath, volume, job)) {
+            setState(QStringLiteral("idle"), volume);
+            m_queue->waitForWork(IDLE_POLL_MS);
+            continue;
+        }
+
+        {
+            QMutexLocker locker(&m_mutex);
+            m_state = QStringLiteral("busy");
+            m_volume = volume;
+            m_error.clear();
+            m_jobId = job.id;
+            m_cancelled = false;
+        }
+        runJob(device, job);
+        {
+            QMutexLocker locker(&m_mutex);
+            if (m_stopping && !m_cancelled && !job.hasSucceeded()) {
+                // Not the client's doing; run it again on the next start
+                job.state = JobState::Queued;
+                job.error = QStringLiteral("Interrupted by shutdown");
+            }
+            m_jobId = 0;
+        }
+        m_queue->finish(job);
+    }
+
+    device.close();
+    setState(QStringLiteral("offline"));
+}
+
+void DriveWorker::runJob(TapeDevice &device, Job &job)
+{
+    TapeIO io(&device);
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_cancelled || m_stopping) {
+            job.state = JobState::Cancelled;
+            return;
+        }
+        m_io = &io;
+    }
+
+    if (job.type == JobType::Write) {
+        runWrite(io, job);
+    } else {
+        runVerify(io, job);
+    }
+
+    QMutexLocker locker(&m_mutex);
+    m_io = nullptr;
+    if (m_cancelled && !job.hasSucceeded()) {
+        job.state = JobState::Cancelled;
+    }
+}
+
+void DriveWorker::runWrite(TapeIO &io, Job &job)
+{
+    // A rerun of an interrupted job skips what its journal has on tape
+    TransferOptions options = m_options;
+    options.journalPath = journalPath(m_stateDir, job.id);
+    io.setOptions(options);
+
+    for (const QString &source : job.sources) {
+        const QFileInfo info(source);
+        if (info.isDir()) {
+            const QString destDir = job.destination.isEmpty()
+                ? QString() : job.destination + QLatin1Char('/') + QDir(source).dirName();
+            io.scanDirectory(source, destDir);
+        } else {
+            io.addFiles({source}, job.destination);
+        }
+    }
+
+    if (!io.startWrite()) {
+        io.cancelScan();
+        job.state = JobState::Failed;
+        job.error = io.lastError();
+        return;
+    }
+
+    TransferStats stats;
+    while (!io.waitForCompletion(PROGRESS_INTERVAL_MS)) {
+        stats = io.statistics();
+        job.totalBytes = stats.totalBytes;
+        job.completedBytes = stats.completedBytes;
+        job.completedFiles = stats.completedFiles;
+        job.failedFiles = stats.failedFiles;
+        m_queue->updateProgress(job);
+    }
+
+    stats = io.statistics();
+    job.totalBytes = stats.totalBytes;
+    job.completedBytes = stats.completedBytes;
+    job.completedFiles = stats.completedFiles;
+    job.failedFiles = stats.failedFiles;
+
+    if (stats.failedFiles > 0 || stats.completedFiles + stats.skippedFiles < stats.totalFiles) {
+        job.state = JobState::Failed;
+        job.error = io.lastError().isEmpty()
+            ? QStringLiteral("%1 files failed").arg(stats.failedFiles) : io.lastError();
+    } else {
+        // TapeIO only journals extents; the cartridge has no index yet
+        job.state = JobState::Written;
+        job.error = QStringLiteral("Data written, no LTFS index on tape; journal kept in %1")
+            .arg(options.journalPath);
+    }
+}
+
+void DriveWorker::runVerify(TapeIO &io, Job &job)
+{
+    IndexParser parser;
+    QSharedPointer<LtfsIndex> index = parser.parseFile(job.indexPath);
+    if (!index) {
+        job.state = JobState::Failed;
+        job.error = QStringLiteral("Cannot read index %1").arg(job.indexPath);
+        return;
+    }
+
+    io.setOptions(m_options);
+    io.setIndex(index);
+
+    // verifyIndex() runs on this thread; count files as they complete
+    QObject::connect(&io, &TapeIO::fileCompleted, [this, &job](const TransferItem &item) {
+        job.completedFiles++;
+        job.completedBytes += item.size;
+        m_queue->updateProgress(job);
+    });
+    QObject::connect(&io, &TapeIO::fileError, [this, &job](const TransferItem &, const QString &) {
+        job.failedFiles++;
+        m_queue->updateProgress(job);
+    });
+
+    const bool ok = io.verifyIndex();
+    job.totalBytes = io.statistics().totalBytes;
+    if (ok) {
+        job.state = JobState::Completed;
+    } else {
+        job.state = JobState::Failed;
+        job.error = io.lastError();
+    }
+}
+
+void DriveWorker::setState(const QString &state, const QString &volume, const QString &error)
+{
+    QMutexLocker locker(&m_mutex);
+    m_state = state;
+    m_volume = volume;
+    m_error = error;
+}
+
+} // namespace qltfsd
@@ -0,0 +1,119 @@
+/*
+ * QLTOTapeMan - Qt-based LTO Tape Manager
+ *
+ * Copyright (c) 2026 Jeffrey ZHU (zhxsh1225@gmail.com)
+ * https://github.com/Gypsop/QLTOTapeMan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "Job.h"
+
+#include "device/DeviceEnumerator.h"
+#include "io/TapeIO.h"
+
+#include <QJsonObject>
+#include <QMutex>
+#include <QScopedPointer>
+#include <QThread>
+
+#include <atomic>
+
+namespace qltfsd {
+
+class JobQueue;
+
+/**
+ * @brief Runs queued jobs on one drive
+ *
+ * Owns a thread that keeps the drive open and takes the next job it can
+ * run as soon as the previous one ends, so the drive streams back to
+ * back while work is queued. The cartridge serial number is read from
+ * MAM before each job; jobs tied to another cartridge are left for the
+ * drive holding it. A drive that cannot be opened or has no cartridge
+ * is retried periodically.
+ */
+class DriveWorker
+{
+public:
+    /**
+     * @param info Drive to run on
+     * @param queue Queue to take jobs from
+     * @param stateDir Directory for the write journals
+     * @param options Transfer options applied to every job
+     */
+    DriveWorker(const qltfs::TapeDeviceInfo &info, JobQueue *queue, const QString &stateDir,
+                const qltfs::TransferOptions &options);
+    ~DriveWorker();
+
+    DriveWorker(const DriveWorker &) = delete;
+    DriveWorker &operator=(const DriveWorker &) = delete;
+
+    void start();
+
+    /**
+     * @brief Ask the thread to end without waiting
+     *
+     * A running job is interrupted and handed back to the queue.
+     */
+    void requestStop();
+
+    /**
+     * @brief Interrupt the running job and wait for the thread to end
+     */
+    void stop();
+
+    QString devicePath() const { return m_info.devicePath; }
+
+    /**
+     * @brief Cancel a job if it is the one running on this drive
+     */
+    bool cancelJob(quint64 id);
+
+    /**
+     * @brief Drive state as reported over RPC
+     */
+    QJsonObject status() const;
+
+    /**
+     * @brief Journal of a write job, kept as its record of what is on tape
+     */
+    static QString journalPath(const QString &stateDir, quint64 id);
+
+private:
+    void run();
+    void runJob(qltfs::TapeDevice &device, Job &job);
+    void runWrite(qltfs::TapeIO &io, Job &job);
+    void runVerify(qltfs::TapeIO &io, Job &job);
+    void setState(const QString &state, const QString &volume = QString(), const QString &error = QString());
+
+    qltfs::TapeDeviceInfo m_info;
+    JobQueue *m_queue;
+    QString m_stateDir;
+    qltfs::TransferOptions m_options;
+    QScopedPointer<QThread> m_thread;
+    std::atomic<bool> m_stopping{false};
+
+    mutable QMutex m_mutex;         ///< Guards the members below
+    QString m_state;                ///< offline, empty, idle or busy
+    QString m_volume;               ///< Serial number of the loaded cartridge
+    QString m_error;
+    quint64 m_jobId = 0;            ///< Job being run, 0 = none
+    bool m_cancelled = false;       ///< Cancel requested for m_jobId
+    qltfs::TapeIO *m_io = nullptr;  ///< Transfer of m_jobId once created
+};
+
+} // namespace qltfsd
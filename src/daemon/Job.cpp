@@ -0,0 +1,159 @@
+/*
+ * QLTOTapeMan - Qt-based LTO Tape Manager
+ *
+ * Copyright (c) 2026 Jeffrey ZHU (zhxsh1225@gmail.com)
+ * https://github.com/Gypsop/QLTOTapeMan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "Job.h"
+
+#include <QDir>
+#include <QJsonArray>
+
+namespace qltfsd {
+
+bool Job::isFinished() const
+{
+    return hasSucceeded() || state == JobState::Failed || state == JobState::Cancelled;
+}
+
+bool Job::hasSucceeded() const
+{
+    return state == JobState::Completed || state == JobState::Written;
+}
+
+QString Job::validate() const
+{
+    if (type == JobType::Write) {
+        if (sources.isEmpty()) {
+            return QStringLiteral("Write job has no sources");
+        }
+        // The daemon does not share the client's working directory
+        for (const QString &source : sources) {
+            if (!QDir::isAbsolutePath(source)) {
+                return QStringLiteral("Source path is not absolute: %1").arg(source);
+            }
+        }
+    } else if (indexPath.isEmpty()) {
+        return QStringLiteral("Verify job has no index");
+    } else if (volume.isEmpty() && drive.isEmpty()) {
+        // Any loaded cartridge would do otherwise, and most would fail
+        return QStringLiteral("Verify job needs a volume or drive");
+    }
+    return QString();
+}
+
+QJsonObject Job::toJson() const
+{
+    QJsonObject object;
+    object[QStringLiteral("id")] = QString::number(id);
+    object[QStringLiteral("type")] = jobTypeName(type);
+    object[QStringLiteral("state")] = jobStateName(state);
+    object[QStringLiteral("priority")] = priority;
+    object[QStringLiteral("sources")] = QJsonArray::fromStringList(sources);
+    object[QStringLiteral("destination")] = destination;
+    object[QStringLiteral("index")] = indexPath;
+    object[QStringLiteral("drive")] = drive;
+    object[QStringLiteral("volume")] = volume;
+    object[QStringLiteral("submitted")] = submitted.toString(Qt::ISODateWithMs);
+    object[QStringLiteral("started")] = started.toString(Qt::ISODateWithMs);
+    object[QStringLiteral("finished")] = finished.toString(Qt::ISODateWithMs);
+    object[QStringLiteral("runningOn")] = runningOn;
+    object[QStringLiteral("attempts")] = attempts;
+    object[QStringLiteral("totalBytes")] = totalBytes;
+    object[QStringLiteral("completedBytes")] = completedBytes;
+    object[QStringLiteral("completedFiles")] = completedFiles;
+    object[QStringLiteral("failedFiles")] = failedFiles;
+    object[QStringLiteral("error")] = error;
+    return object;
+}
+
+Job Job::fromJson(const QJsonObject &object)
+{
+    Job job;
+    // 64-bit ids travel as strings; JSON numbers are doubles
+    job.id = object.value(QStringLiteral("id")).toString().toULongLong();
+    parseJobType(object.value(QStringLiteral("type")).toString(), job.type);
+    parseJobState(object.value(QStringLiteral("state")).toString(), job.state);
+    job.priority = object.value(QStringLiteral("priority")).toInt();
+    for (const QJsonValue &source : object.value(QStringLiteral("sources")).toArray()) {
+        job.sources.append(source.toString());
+    }
+    job.destination = object.value(QStringLiteral("destination")).toString();
+    job.indexPath = object.value(QStringLiteral("index")).toString();
+    job.drive = object.value(QStringLiteral("drive")).toString();
+    job.volume = object.value(QStringLiteral("volume")).toString();
+    job.submitted = QDateTime::fromString(object.value(QStringLiteral("submitted")).toString(), Qt::ISODateWithMs);
+    job.started = QDateTime::fromString(object.value(QStringLiteral("started")).toString(), Qt::ISODateWithMs);
+    job.finished = QDateTime::fromString(object.value(QStringLiteral("finished")).toString(), Qt::ISODateWithMs);
+    job.runningOn = object.value(QStringLiteral("runningOn")).toString();
+    job.attempts = object.value(QStringLiteral("attempts")).toInt();
+    job.totalBytes = object.value(QStringLiteral("totalBytes")).toInteger();
+    job.completedBytes = object.value(QStringLiteral("completedBytes")).toInteger();
+    job.completedFiles = object.value(QStringLiteral("completedFiles")).toInteger();
+    job.failedFiles = object.value(QStringLiteral("failedFiles")).toInteger();
+    job.error = object.value(QStringLiteral("error")).toString();
+    return job;
+}
+
+QString jobTypeName(JobType type)
+{
+    switch (type) {
+    case JobType::Write:  return QStringLiteral("write");
+    case JobType::Verify: return QStringLiteral("verify");
+    }
+    return QString();
+}
+
+bool parseJobType(const QString &name, JobType &type)
+{
+    if (name == QLatin1String("write")) {
+        type = JobType::Write;
+    } else if (name == QLatin1String("verify")) {
+        type = JobType::Verify;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+QString jobStateName(JobState state)
+{
+    switch (state) {
+    case JobState::Queued:    return QStringLiteral("queued");
+    case JobState::Running:   return QStringLiteral("running");
+    case JobState::Completed: return QStringLiteral("completed");
+    case JobState::Written:   return QStringLiteral("written");
+    case JobState::Failed:    return QStringLiteral("failed");
+    case JobState::Cancelled: return QStringLiteral("cancelled");
+    }
+    return QString();
+}
+
+bool parseJobState(const QString &name, JobState &state)
+{
+    static const JobState states[] = {JobState::Queued, JobState::Running, JobState::Completed,
+                                      JobState::Written, JobState::Failed, JobState::Cancelled};
+    for (JobState candidate : states) {
+        if (name == jobStateName(candidate)) {
+            state = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace qltfsd
@@ -0,0 +1,96 @@
+/*
+ * QLTOTapeMan - Qt-based LTO Tape Manager
+ *
+ * Copyright (c) 2026 Jeffrey ZHU (zhxsh1225@gmail.com)
+ * https://github.com/Gypsop/QLTOTapeMan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QDateTime>
+#include <QJsonObject>
+#include <QString>
+#include <QStringList>
+
+namespace qltfsd {
+
+/**
+ * @brief What a job does with its cartridge
+ */
+enum class JobType {
+    Write,      ///< Append local files and directories
+    Verify      ///< Read back every file of an index and compare hashes
+};
+
+/**
+ * @brief Life cycle of a job
+ */
+enum class JobState {
+    Queued,
+    Running,
+    Completed,
+    Written,                        ///< Write: data on tape, no LTFS index written yet
+    Failed,
+    Cancelled
+};
+
+/**
+ * @brief One unit of work for a drive
+ *
+ * Jobs are plain values: the queue owns the authoritative copy and
+ * workers run on a snapshot, reporting back through JobQueue.
+ */
+struct Job {
+    quint64 id = 0;
+    JobType type = JobType::Write;
+    JobState state = JobState::Queued;
+    int priority = 0;               ///< Higher runs first
+    QStringList sources;            ///< Write: local files and directories
+    QString destination;            ///< Write: directory on tape
+    QString indexPath;              ///< Verify: LTFS index file of the cartridge
+    QString drive;                  ///< Device path to run on (empty = any drive)
+    QString volume;                 ///< Cartridge serial number the drive must hold (empty = any)
+    QDateTime submitted;
+    QDateTime started;
+    QDateTime finished;
+    QString runningOn;              ///< Drive of the current or last run
+    int attempts = 0;               ///< Runs started, including interrupted ones
+    qint64 totalBytes = 0;
+    qint64 completedBytes = 0;
+    qint64 completedFiles = 0;
+    qint64 failedFiles = 0;
+    QString error;                  ///< Failure reason, or a warning for Written
+
+    bool isFinished() const;
+    bool hasSucceeded() const;      ///< Completed or Written
+
+    /**
+     * @brief Check the fields a client must set
+     * @return Error message, empty if the job can be queued
+     */
+    QString validate() const;
+
+    QJsonObject toJson() const;
+    static Job fromJson(const QJsonObject &object);
+};
+
+QString jobTypeName(JobType type);
+bool parseJobType(const QString &name, JobType &type);
+
+QString jobStateName(JobState state);
+bool parseJobState(const QString &name, JobState &state);
+
+} // namespace qltfsd
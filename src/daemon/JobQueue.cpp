@@ -0,0 +1,285 @@
+/*
+ * QLTOTapeMan - Qt-based LTO Tape Manager
+ *
+ * Copyright (c) 2026 Jeffrey ZHU (zhxsh1225@gmail.com)
+ * https://github.com/Gypsop/QLTOTapeMan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "JobQueue.h"
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QMutexLocker>
+#include <QSaveFile>
+
+namespace qltfsd {
+
+// Finished jobs kept for listing; older ones are dropped from the file
+static constexpr int FINISHED_JOB_LIMIT = 1000;
+
+JobQueue::JobQueue(const QString &path)
+    : m_path(path)
+{
+}
+
+bool JobQueue::load()
+{
+    QMutexLocker locker(&m_mutex);
+
+    QFile file(m_path);
+    if (!file.exists()) {
+        return true;
+    }
+    if (!file.open(QIODevice::ReadOnly)) {
+        m_lastError = QStringLiteral("Cannot open %1: %2").arg(m_path, file.errorString());
+        return false;
+    }
+
+    QJsonParseError parseError;
+    const QJsonDocument document = QJsonDocument::fromJson(file.readAll(), &parseError);
+    if (!document.isObject()) {
+        m_lastError = QStringLiteral("Cannot parse %1: %2").arg(m_path, parseError.errorString());
+        return false;
+    }
+
+    const QJsonObject root = document.object();
+    m_nextId = qMax<quint64>(1, root.value(QStringLiteral("nextId")).toString().toULongLong());
+    m_jobs.clear();
+    for (const QJsonValue &value : root.value(QStringLiteral("jobs")).toArray()) {
+        Job job = Job::fromJson(value.toObject());
+        if (job.id == 0) {
+            continue;
+        }
+        if (job.state == JobState::Running) {
+            // Interrupted by a stop or crash; writes resume from their journal
+            job.state = JobState::Queued;
+            job.error = QStringLiteral("Interrupted on %1").arg(job.runningOn);
+        }
+        m_nextId = qMax(m_nextId, job.id + 1);
+        m_jobs.append(job);
+    }
+    return saveLocked();
+}
+
+quint64 JobQueue::submit(Job job)
+{
+    QMutexLocker locker(&m_mutex);
+
+    job.id = m_nextId++;
+    job.state = JobState::Queued;
+    job.submitted = QDateTime::currentDateTimeUtc();
+    m_jobs.append(job);
+    if (!saveLocked()) {
+        m_jobs.removeLast();
+        return 0;
+    }
+
+    m_changed.wakeAll();
+    return job.id;
+}
+
+bool JobQueue::cancel(quint64 id, bool &running)
+{
+    QMutexLocker locker(&m_mutex);
+
+    running = false;
+    const int index = indexOfLocked(id);
+    if (index < 0 || m_jobs[index].isFinished()) {
+        m_lastError = QStringLiteral("No active job %1").arg(id);
+        return false;
+    }
+
+    if (m_jobs[index].state == JobState::Running) {
+        running = true;
+        m_cancelRequested.insert(id);
+        return true;
+    }
+
+    m_jobs[index].state = JobState::Cancelled;
+    m_jobs[index].finished = QDateTime::currentDateTimeUtc();
+    return saveLocked();
+}
+
+bool JobQueue::find(quint64 id, Job &job) const
+{
+    QMutexLocker locker(&m_mutex);
+    const int index = indexOfLocked(id);
+    if (index < 0) {
+        return false;
+    }
+    job = m_jobs[index];
+    return true;
+}
+
+QList<Job> JobQueue::jobs() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_jobs;
+}
+
+bool JobQueue::takeNext(const QString &drive, const QString &volume, Job &job)
+{
+    QMutexLocker locker(&m_mutex);
+
+    int best = -1;
+    for (int i = 0; i < m_jobs.size(); ++i) {
+        const Job &candidate = m_jobs[i];
+        if (candidate.state != JobState::Queued
+            || (!candidate.drive.isEmpty() && candidate.drive != drive)
+            || (!candidate.volume.isEmpty() && candidate.volume != volume)) {
+            continue;
+        }
+        if (best < 0) {
+            best = i;
+            continue;
+        }
+
+        // Writes keep the drive streaming; verifies only fill idle time.
+        // The list is in submission order, so ties stay first come, first served.
+        const Job &current = m_jobs[best];
+        const bool candidateWrite = candidate.type == JobType::Write;
+        const bool currentWrite = current.type == JobType::Write;
+        if (candidateWrite != currentWrite) {
+            if (candidateWrite) {
+                best = i;
+            }
+        } else if (candidate.priority > current.priority) {
+            best = i;
+        }
+    }
+    if (best < 0) {
+        return false;
+    }
+
+    Job &taken = m_jobs[best];
+    taken.state = JobState::Running;
+    taken.runningOn = drive;
+    taken.started = QDateTime::currentDateTimeUtc();
+    taken.finished = QDateTime();
+    taken.attempts++;
+    taken.error.clear();
+    saveLocked();
+
+    job = taken;
+    return true;
+}
+
+void JobQueue::updateProgress(const Job &job)
+{
+    QMutexLocker locker(&m_mutex);
+    const int index = indexOfLocked(job.id);
+    if (index < 0) {
+        return;
+    }
+    Job &stored = m_jobs[index];
+    stored.totalBytes = job.totalBytes;
+    stored.completedBytes = job.completedBytes;
+    stored.completedFiles = job.completedFiles;
+    stored.failedFiles = job.failedFiles;
+}
+
+void JobQueue::finish(Job job)
+{
+    QMutexLocker locker(&m_mutex);
+
+    const int index = indexOfLocked(job.id);
+    if (index < 0) {
+        return;
+    }
+    if (m_cancelRequested.remove(job.id) && !job.hasSucceeded()) {
+        job.state = JobState::Cancelled;
+    }
+    if (job.isFinished()) {
+        job.finished = QDateTime::currentDateTimeUtc();
+    }
+    m_jobs[index] = job;
+
+    pruneLocked();
+    saveLocked();
+    m_changed.wakeAll();
+}
+
+void JobQueue::waitForWork(int timeoutMs)
+{
+    QMutexLocker locker(&m_mutex);
+    m_changed.wait(&m_mutex, timeoutMs);
+}
+
+void JobQueue::wakeAll()
+{
+    QMutexLocker locker(&m_mutex);
+    m_changed.wakeAll();
+}
+
+QString JobQueue::lastError() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_lastError;
+}
+
+bool JobQueue::saveLocked()
+{
+    QJsonArray jobs;
+    for (const Job &job : m_jobs) {
+        jobs.append(job.toJson());
+    }
+    QJsonObject root;
+    root[QStringLiteral("nextId")] = QString::number(m_nextId);
+    root[QStringLiteral("jobs")] = jobs;
+
+    QSaveFile file(m_path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        m_lastError = QStringLiteral("Cannot write %1: %2").arg(m_path, file.errorString());
+        return false;
+    }
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Indented));
+    if (!file.commit()) {
+        m_lastError = QStringLiteral("Cannot write %1: %2").arg(m_path, file.errorString());
+        return false;
+    }
+    return true;
+}
+
+void JobQueue::pruneLocked()
+{
+    int finished = 0;
+    for (const Job &job : m_jobs) {
+        finished += job.isFinished() ? 1 : 0;
+    }
+
+    // Oldest first, the list is in submission order
+    for (int i = 0; i < m_jobs.size() && finished > FINISHED_JOB_LIMIT;) {
+        if (m_jobs[i].isFinished()) {
+            m_jobs.removeAt(i);
+            --finished;
+        } else {
+            ++i;
+        }
+    }
+}
+
+int JobQueue::indexOfLocked(quint64 id) const
+{
+    for (int i = 0; i < m_jobs.size(); ++i) {
+        if (m_jobs[i].id == id) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+} // namespace qltfsd
@@ -0,0 +1,123 @@
+/*
+ * QLTOTapeMan - Qt-based LTO Tape Manager
+ *
+ * Copyright (c) 2026 Jeffrey ZHU (zhxsh1225@gmail.com)
+ * https://github.com/Gypsop/QLTOTapeMan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "Job.h"
+
+#include <QList>
+#include <QMutex>
+#include <QSet>
+#include <QString>
+#include <QWaitCondition>
+
+namespace qltfsd {
+
+/**
+ * @brief Persistent, thread-safe queue of jobs
+ *
+ * The whole queue is rewritten atomically (QSaveFile) on every state
+ * change, so a crash or power loss leaves either the old or the new
+ * file. Progress counters are kept in memory between state changes.
+ * Jobs that were running when the daemon stopped are queued again on
+ * load; write jobs then resume from their journal.
+ *
+ * Drive workers block in waitForWork() and take jobs with takeNext():
+ * writes come first, so drives stream back to back while writes are
+ * waiting, and verify jobs fill the gaps. Within a type the highest
+ * priority runs first, then the oldest job.
+ */
+class JobQueue
+{
+public:
+    explicit JobQueue(const QString &path);
+
+    /**
+     * @brief Read the queue file; a missing file is an empty queue
+     */
+    bool load();
+
+    /**
+     * @brief Queue a job
+     * @return Id assigned to the job, 0 if the queue could not be saved
+     */
+    quint64 submit(Job job);
+
+    /**
+     * @brief Cancel a job
+     *
+     * Queued jobs are cancelled at once. For a running job the request
+     * is recorded and @p running set; the job ends as cancelled once
+     * its worker reports back.
+     *
+     * @return false if there is no such job or it already finished
+     */
+    bool cancel(quint64 id, bool &running);
+
+    bool find(quint64 id, Job &job) const;
+    QList<Job> jobs() const;
+
+    /**
+     * @brief Take the next job a drive can run and mark it running
+     * @param drive Device path of the drive
+     * @param volume Serial number of the cartridge in the drive
+     */
+    bool takeNext(const QString &drive, const QString &volume, Job &job);
+
+    /**
+     * @brief Record progress of a running job (not saved until it ends)
+     */
+    void updateProgress(const Job &job);
+
+    /**
+     * @brief Hand back a job taken with takeNext()
+     *
+     * Normally with its final state; a job set back to queued is
+     * offered to the drives again.
+     */
+    void finish(Job job);
+
+    /**
+     * @brief Wait until jobs are submitted or finish, or for the timeout
+     */
+    void waitForWork(int timeoutMs);
+
+    /**
+     * @brief Wake every waiting worker
+     */
+    void wakeAll();
+
+    QString lastError() const;
+
+private:
+    bool saveLocked();
+    void pruneLocked();
+    int indexOfLocked(quint64 id) const;
+
+    QString m_path;
+    mutable QMutex m_mutex;
+    QWaitCondition m_changed;
+    QList<Job> m_jobs;              ///< In submission order
+    QSet<quint64> m_cancelRequested;
+    quint64 m_nextId = 1;
+    QString m_lastError;
+};
+
+} // namespace qltfsd
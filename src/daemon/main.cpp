@@ -0,0 +1,212 @@
+/*
+ * QLTOTapeMan - Qt-based LTO Tape Manager
+ *
+ * Copyright (c) 2026 Jeffrey ZHU (zhxsh1225@gmail.com)
+ * https://github.com/Gypsop/QLTOTapeMan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "Daemon.h"
+
+#include "io/HashCalculator.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QLocalSocket>
+#include <QSocketNotifier>
+#include <QStandardPaths>
+#include <QTextStream>
+
+#ifdef Q_OS_UNIX
+#include <csignal>
+#include <unistd.h>
+#endif
+
+using namespace qltfsd;
+
+// How long the client waits for the daemon to answer
+static constexpr int CLIENT_TIMEOUT_MS = 30000;
+
+#ifdef Q_OS_UNIX
+// Written by the signal handler, read on the event loop
+static int s_signalPipe[2] = {-1, -1};
+
+static void handleTerminationSignal(int)
+{
+    const char byte = 1;
+    (void)::write(s_signalPipe[1], &byte, 1);
+}
+
+// Quit the event loop on SIGINT / SIGTERM so running jobs are requeued
+static void installSignalHandlers(QCoreApplication &app)
+{
+    if (::pipe(s_signalPipe) != 0) {
+        return;
+    }
+    auto *notifier = new QSocketNotifier(s_signalPipe[0], QSocketNotifier::Read, &app);
+    QObject::connect(notifier, &QSocketNotifier::activated, &app, &QCoreApplication::quit);
+    std::signal(SIGINT, handleTerminationSignal);
+    std::signal(SIGTERM, handleTerminationSignal);
+}
+#endif
+
+static int sendRequest(const QString &socketName, const QString &method, const QJsonObject &params)
+{
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    QLocalSocket socket;
+    socket.connectToServer(socketName);
+    if (!socket.waitForConnected(CLIENT_TIMEOUT_MS)) {
+        err << "Cannot connect to " << socketName << ": " << socket.errorString() << Qt::endl;
+        return 1;
+    }
+
+    QJsonObject request;
+    request[QStringLiteral("id")] = 1;
+    request[QStringLiteral("method")] = method;
+    request[QStringLiteral("params")] = params;
+    socket.write(QJsonDocument(request).toJson(QJsonDocument::Compact) + '\n');
+
+    while (!socket.canReadLine()) {
+        if (!socket.waitForReadyRead(CLIENT_TIMEOUT_MS)) {
+            err << "No answer from " << socketName << ": " << socket.errorString() << Qt::endl;
+            return 1;
+        }
+    }
+
+    const QJsonObject response = QJsonDocument::fromJson(socket.readLine()).object();
+    if (response.contains(QStringLiteral("error"))) {
+        err << response.value(QStringLiteral("error")).toString() << Qt::endl;
+        return 1;
+    }
+
+    const QJsonValue result = response.value(QStringLiteral("result"));
+    const QJsonDocument document = result.isArray() ? QJsonDocument(result.toArray())
+                                                    : QJsonDocument(result.toObject());
+    out << document.toJson(QJsonDocument::Indented);
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationName(QStringLiteral("qltfsd"));
+    app.setOrganizationName(QStringLiteral("QLTOTapeMan"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral(
+        "Job daemon keeping every tape drive of the host busy. "
+        "Without a client option it runs the daemon; with one it talks to a running daemon."));
+    parser.addHelpOption();
+
+    const QCommandLineOption stateDirOption(QStringLiteral("state-dir"),
+        QStringLiteral("Directory for the job queue and write journals."), QStringLiteral("path"),
+        QStandardPaths::writableLocation(QStandardPaths::AppDataLocation));
+    const QCommandLineOption socketOption(QStringLiteral("socket"),
+        QStringLiteral("Local socket of the RPC interface."), QStringLiteral("name"), Daemon::defaultSocketName());
+    const QCommandLineOption driveOption(QStringLiteral("drive"),
+        QStringLiteral("Daemon: drive to use (repeatable; default all). Submit: drive to run the job on."),
+        QStringLiteral("path"));
+    const QCommandLineOption hashOption(QStringLiteral("hash"),
+        QStringLiteral("Daemon: hash recorded on write and compared on verify."), QStringLiteral("mode"),
+        QStringLiteral("SHA256"));
+    const QCommandLineOption writeOption(QStringLiteral("submit-write"),
+        QStringLiteral("Queue a write of the files and directories given as arguments."));
+    const QCommandLineOption verifyOption(QStringLiteral("submit-verify"),
+        QStringLiteral("Queue a verify of every file in an LTFS index."), QStringLiteral("index"));
+    const QCommandLineOption destOption(QStringLiteral("dest"),
+        QStringLiteral("Submit: directory on tape to write into."), QStringLiteral("path"));
+    const QCommandLineOption volumeOption(QStringLiteral("volume"),
+        QStringLiteral("Submit: serial number of the cartridge the job needs."), QStringLiteral("serial"));
+    const QCommandLineOption priorityOption(QStringLiteral("priority"),
+        QStringLiteral("Submit: higher runs first."), QStringLiteral("n"), QStringLiteral("0"));
+    const QCommandLineOption listOption(QStringLiteral("list"),
+        QStringLiteral("List jobs, optionally only those in a state given as argument."));
+    const QCommandLineOption statusOption(QStringLiteral("status"),
+        QStringLiteral("Show one job."), QStringLiteral("id"));
+    const QCommandLineOption cancelOption(QStringLiteral("cancel"),
+        QStringLiteral("Cancel a job."), QStringLiteral("id"));
+    const QCommandLineOption drivesOption(QStringLiteral("drives"),
+        QStringLiteral("Show the drives and what they are doing."));
+
+    parser.addOptions({stateDirOption, socketOption, driveOption, hashOption, writeOption, verifyOption,
+                       destOption, volumeOption, priorityOption, listOption, statusOption, cancelOption,
+                       drivesOption});
+    parser.addPositionalArgument(QStringLiteral("sources"), QStringLiteral("Files and directories to write."),
+                                 QStringLiteral("[sources...]"));
+    parser.process(app);
+
+    const QString socketName = parser.value(socketOption);
+
+    if (parser.isSet(writeOption) || parser.isSet(verifyOption)) {
+        QJsonObject params;
+        params[QStringLiteral("priority")] = parser.value(priorityOption).toInt();
+        params[QStringLiteral("drive")] = parser.value(driveOption);
+        params[QStringLiteral("volume")] = parser.value(volumeOption);
+        if (parser.isSet(writeOption)) {
+            QJsonArray sources;
+            for (const QString &source : parser.positionalArguments()) {
+                sources.append(QDir(source).absolutePath());
+            }
+            params[QStringLiteral("type")] = jobTypeName(JobType::Write);
+            params[QStringLiteral("sources")] = sources;
+            params[QStringLiteral("destination")] = parser.value(destOption);
+        } else {
+            params[QStringLiteral("type")] = jobTypeName(JobType::Verify);
+            params[QStringLiteral("index")] = QDir(parser.value(verifyOption)).absolutePath();
+        }
+        return sendRequest(socketName, QStringLiteral("submit"), params);
+    }
+    if (parser.isSet(listOption)) {
+        QJsonObject params;
+        params[QStringLiteral("state")] = parser.positionalArguments().value(0);
+        return sendRequest(socketName, QStringLiteral("list"), params);
+    }
+    if (parser.isSet(statusOption) || parser.isSet(cancelOption)) {
+        const bool cancel = parser.isSet(cancelOption);
+        QJsonObject params;
+        params[QStringLiteral("id")] = parser.value(cancel ? cancelOption : statusOption);
+        return sendRequest(socketName, cancel ? QStringLiteral("cancel") : QStringLiteral("get"), params);
+    }
+    if (parser.isSet(drivesOption)) {
+        return sendRequest(socketName, QStringLiteral("drives"), QJsonObject());
+    }
+
+    DaemonConfig config;
+    config.stateDir = parser.value(stateDirOption);
+    config.socketName = socketName;
+    config.drives = parser.values(driveOption);
+    config.options.hashMode = qltfs::HashCalculator::stringToMode(parser.value(hashOption));
+    if (config.options.hashMode == qltfs::HashMode::None) {
+        QTextStream(stderr) << "Unknown hash mode " << parser.value(hashOption) << Qt::endl;
+        return 1;
+    }
+
+    Daemon service(config);
+    if (!service.start()) {
+        QTextStream(stderr) << service.lastError() << Qt::endl;
+        return 1;
+    }
+
+#ifdef Q_OS_UNIX
+    installSignalHandlers(app);
+#endif
+
+    return app.exec();
+}
@@ -0,0 +1,307 @@
+/*
+ * QLTOTapeMan - Qt-based LTO Tape Manager
+ * libqltfs - LTFS Core Library
+ *
+ * Copyright (c) 2026 Jeffrey ZHU (zhxsh1225@gmail.com)
+ * https://github.com/Gypsop/QLTOTapeMan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "CompactIndex.h"
+
+#include <QAnyStringView>
+#include <QDateTime>
+
+namespace qltfs {
+
+namespace {
+
+/**
+ * @brief Append @p text to @p target as UTF-8
+ *
+ * Names in LTFS indexes are nearly always ASCII; those are narrowed in
+ * place without a temporary.
+ */
+void appendUtf8(QByteArray &target, QStringView text)
+{
+    const QChar *chars = text.data();
+    const qsizetype length = text.size();
+
+    bool ascii = true;
+    for (qsizetype i = 0; i < length; ++i) {
+        if (chars[i].unicode() >= 0x80) {
+            ascii = false;
+            break;
+        }
+    }
+
+    if (!ascii) {
+        target.append(text.toUtf8());
+        return;
+    }
+
+    const qsizetype offset = target.size();
+    target.resize(offset + length);
+    char *out = target.data() + offset;
+    for (qsizetype i = 0; i < length; ++i) {
+        out[i] = static_cast<char>(chars[i].unicode());
+    }
+}
+
+QList<ExtendedAttribute> toAttributes(const CompactIndex &index, quint32 first, quint32 count)
+{
+    QList<ExtendedAttribute> attributes;
+    attributes.reserve(static_cast<int>(count));
+    for (quint32 i = first; i < first + count; ++i) {
+        const CompactIndex::Attribute &attr = index.attribute(i);
+        ExtendedAttribute converted;
+        converted.key = index.string(attr.key);
+        converted.value = index.string(attr.value);
+        attributes.append(converted);
+    }
+    return attributes;
+}
+
+} // namespace
+
+// ============================================================================
+// CompactIndex Implementation
+// ============================================================================
+
+CompactIndex::CompactIndex() = default;
+
+CompactIndex::~CompactIndex() = default;
+
+QString CompactIndex::string(StringRef ref) const
+{
+    return QString::fromUtf8(m_strings.constData() + ref.offset, static_cast<qsizetype>(ref.length));
+}
+
+QString CompactIndex::fileAttribute(quint32 file, QStringView key) const
+{
+    const File &record = m_files[file];
+    for (quint32 i = record.firstAttribute; i < record.firstAttribute + record.attributeCount; ++i) {
+        const Attribute &attr = m_attributes[i];
+        if (QAnyStringView::compare(stringView(attr.key), key) == 0) {
+            return string(attr.value);
+        }
+    }
+    return QString();
+}
+
+QString CompactIndex::filePath(quint32 file) const
+{
+    const File &record = m_files[file];
+    QString path = string(record.name);
+
+    // The root directory's own name is not part of the path
+    for (quint32 dir = record.directory; dir != NONE && m_directories[dir].parent != NONE;
+         dir = m_directories[dir].parent) {
+        path.prepend(QLatin1Char('/'));
+        path.prepend(string(m_directories[dir].name));
+    }
+    return path;
+}
+
+qint64 CompactIndex::memoryUsage() const
+{
+    return static_cast<qint64>(m_directories.capacity()) * sizeof(Directory) +
+           static_cast<qint64>(m_files.capacity()) * sizeof(File) +
+           static_cast<qint64>(m_extents.capacity()) * sizeof(Extent) +
+           static_cast<qint64>(m_attributes.capacity()) * sizeof(Attribute) +
+           m_strings.capacity();
+}
+
+QDateTime CompactIndex::toDateTime(qint64 nanoseconds)
+{
+    if (nanoseconds == NO_TIME) {
+        return QDateTime();
+    }
+
+    // Round towards negative infinity so pre-1970 times stay correct
+    qint64 msecs = nanoseconds / 1000000;
+    if (nanoseconds % 1000000 < 0) {
+        --msecs;
+    }
+    return QDateTime::fromMSecsSinceEpoch(msecs, Qt::UTC);
+}
+
+LtfsFile CompactIndex::toLtfsFile(quint32 file) const
+{
+    const File &record = m_files[file];
+
+    LtfsFile converted;
+    converted.setName(string(record.name));
+    converted.setUid(record.uid);
+    converted.setLength(record.length);
+    converted.setReadonly(record.readonly);
+    converted.setCreationTime(toDateTime(record.times.creation));
+    converted.setChangeTime(toDateTime(record.times.change));
+    converted.setModifyTime(toDateTime(record.times.modify));
+    converted.setAccessTime(toDateTime(record.times.access));
+    converted.setBackupTime(toDateTime(record.times.backup));
+
+    QList<LtfsExtent> extents;
+    extents.reserve(static_cast<int>(record.extentCount));
+    for (quint32 i = record.firstExtent; i < record.firstExtent + record.extentCount; ++i) {
+        const Extent &source = m_extents[i];
+        LtfsExtent extent;
+        extent.setPartition(source.partition);
+        extent.setStartBlock(source.startBlock);
+        extent.setFileOffset(source.fileOffset);
+        extent.setByteOffset(source.byteOffset);
+        extent.setByteCount(source.byteCount);
+        extents.append(extent);
+    }
+    converted.setExtentInfo(extents);
+    converted.setExtendedAttributes(toAttributes(*this, record.firstAttribute, record.attributeCount));
+
+    return converted;
+}
+
+LtfsDirectory CompactIndex::toLtfsDirectory(quint32 directory, bool recursive) const
+{
+    const Directory &record = m_directories[directory];
+
+    LtfsDirectory converted;
+    converted.setName(string(record.name));
+    converted.setUid(record.uid);
+    converted.setReadonly(record.readonly);
+    converted.setCreationTime(toDateTime(record.times.creation));
+    converted.setChangeTime(toDateTime(record.times.change));
+    converted.setModifyTime(toDateTime(record.times.modify));
+    converted.setAccessTime(toDateTime(record.times.access));
+    converted.setBackupTime(toDateTime(record.times.backup));
+    converted.setExtendedAttributes(toAttributes(*this, record.firstAttribute, record.attributeCount));
+
+    for (quint32 file = record.firstFile; file != NONE; file = m_files[file].nextSibling) {
+        converted.addFile(toLtfsFile(file));
+    }
+
+    if (recursive) {
+        for (quint32 subdir = record.firstSubdirectory; subdir != NONE;
+             subdir = m_directories[subdir].nextSibling) {
+            converted.addSubdirectory(toLtfsDirectory(subdir, true));
+        }
+    }
+
+    return converted;
+}
+
+CompactIndex::StringRef CompactIndex::addString(QStringView text)
+{
+    StringRef ref;
+    ref.offset = static_cast<quint32>(m_strings.size());
+    appendUtf8(m_strings, text);
+    ref.length = static_cast<quint32>(m_strings.size()) - ref.offset;
+    return ref;
+}
+
+CompactIndex::StringRef CompactIndex::internString(QStringView text)
+{
+    m_encodeBuffer.resize(0);
+    appendUtf8(m_encodeBuffer, text);
+
+    auto it = m_interned.constFind(m_encodeBuffer);
+    if (it != m_interned.constEnd()) {
+        return it.value();
+    }
+
+    StringRef ref;
+    ref.offset = static_cast<quint32>(m_strings.size());
+    ref.length = static_cast<quint32>(m_encodeBuffer.size());
+    m_strings.append(m_encodeBuffer);
+    m_interned.insert(m_encodeBuffer, ref);
+    return ref;
+}
+
+quint32 CompactIndex::addDirectory(quint32 parent)
+{
+    const quint32 index = static_cast<quint32>(m_directories.size());
+
+    Directory directory;
+    directory.parent = parent;
+    m_directories.append(directory);
+    m_lastSubdirectory.append(NONE);
+    m_lastFile.append(NONE);
+
+    if (parent != NONE) {
+        quint32 &last = m_lastSubdirectory[parent];
+        if (last == NONE) {
+            m_directories[parent].firstSubdirectory = index;
+        } else {
+            m_directories[last].nextSibling = index;
+        }
+        last = index;
+    }
+
+    return index;
+}
+
+quint32 CompactIndex::addFile(quint32 directory)
+{
+    const quint32 index = static_cast<quint32>(m_files.size());
+
+    File file;
+    file.directory = directory;
+    file.firstExtent = static_cast<quint32>(m_extents.size());
+    file.firstAttribute = static_cast<quint32>(m_attributes.size());
+    m_files.append(file);
+
+    quint32 &last = m_lastFile[directory];
+    if (last == NONE) {
+        m_directories[directory].firstFile = index;
+    } else {
+        m_files[last].nextSibling = index;
+    }
+    last = index;
+
+    return index;
+}
+
+void CompactIndex::addExtent(quint32 file, const Extent &extent)
+{
+    File &record = m_files[file];
+    if (record.extentCount == 0) {
+        record.firstExtent = static_cast<quint32>(m_extents.size());
+    }
+    m_extents.append(extent);
+    record.extentCount++;
+}
+
+quint32 CompactIndex::addAttribute(StringRef key, StringRef value)
+{
+    Attribute attribute;
+    attribute.key = key;
+    attribute.value = value;
+    m_attributes.append(attribute);
+    return static_cast<quint32>(m_attributes.size() - 1);
+}
+
+void CompactIndex::squeeze()
+{
+    m_lastSubdirectory = QVector<quint32>();
+    m_lastFile = QVector<quint32>();
+    m_interned = QHash<QByteArray, StringRef>();
+    m_encodeBuffer = QByteArray();
+
+    m_directories.squeeze();
+    m_files.squeeze();
+    m_extents.squeeze();
+    m_attributes.squeeze();
+    m_strings.squeeze();
+}
+
+} // namespace qltfs
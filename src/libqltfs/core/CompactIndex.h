@@ -0,0 +1,261 @@
+/*
+ * QLTOTapeMan - Qt-based LTO Tape Manager
+ * libqltfs - LTFS Core Library
+ *
+ * Copyright (c) 2026 Jeffrey ZHU (zhxsh1225@gmail.com)
+ * https://github.com/Gypsop/QLTOTapeMan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "libqltfs_global.h"
+#include "core/LtfsTypes.h"
+#include "core/LtfsIndex.h"
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+#include <QStringView>
+#include <QUtf8StringView>
+#include <QUuid>
+#include <QVector>
+
+#include <limits>
+
+namespace qltfs {
+
+/**
+ * @brief Read-only LTFS index held in a few flat arrays
+ *
+ * Built by IndexParser::parseCompact() for indexes too large for the
+ * LtfsDirectory / LtfsFile value tree. Directories, files, extents and
+ * extended attributes are plain records in contiguous vectors that refer
+ * to each other by position, and every name and attribute value is
+ * stored once in a shared UTF-8 string arena; attribute keys are
+ * interned. Timestamps keep the full nanosecond precision of the index.
+ *
+ * Directory 0 is the root. Children of a directory are chained through
+ * nextSibling in index order; extents and attributes of a node are
+ * consecutive records. Use toLtfsFile() / toLtfsDirectory() to get the
+ * regular types for the subset being restored or displayed.
+ */
+class LIBQLTFS_EXPORT CompactIndex
+{
+public:
+    /// Marks an absent record reference
+    static constexpr quint32 NONE = 0xFFFFFFFF;
+
+    /// Marks an absent timestamp
+    static constexpr qint64 NO_TIME = std::numeric_limits<qint64>::min();
+
+    /**
+     * @brief Location of a string in the arena
+     */
+    struct StringRef {
+        quint32 offset = 0;
+        quint32 length = 0;         ///< Length in UTF-8 bytes
+    };
+
+    /**
+     * @brief Timestamps of a directory or file, in nanoseconds since the Unix epoch (UTC)
+     */
+    struct Times {
+        qint64 creation = NO_TIME;
+        qint64 change = NO_TIME;
+        qint64 modify = NO_TIME;
+        qint64 access = NO_TIME;
+        qint64 backup = NO_TIME;
+    };
+
+    struct Directory {
+        StringRef name;
+        quint32 parent = NONE;
+        quint32 firstSubdirectory = NONE;
+        quint32 firstFile = NONE;
+        quint32 nextSibling = NONE;     ///< Next subdirectory of the parent
+        quint32 firstAttribute = 0;
+        quint32 attributeCount = 0;
+        quint64 uid = 0;
+        Times times;
+        bool readonly = false;
+    };
+
+    struct File {
+        StringRef name;
+        quint32 directory = NONE;       ///< Containing directory
+        quint32 nextSibling = NONE;     ///< Next file of the same directory
+        quint32 firstExtent = 0;
+        quint32 extentCount = 0;
+        quint32 firstAttribute = 0;
+        quint32 attributeCount = 0;
+        quint64 uid = 0;
+        qint64 length = 0;
+        Times times;
+        bool readonly = false;
+    };
+
+    struct Extent {
+        quint64 startBlock = 0;
+        qint64 fileOffset = 0;
+        qint64 byteOffset = 0;
+        qint64 byteCount = 0;
+        PartitionLabel partition = PartitionLabel::DataPartition;
+    };
+
+    struct Attribute {
+        StringRef key;
+        StringRef value;
+    };
+
+    /**
+     * @brief Volume-level fields of the index
+     */
+    struct Header {
+        QString version;
+        QString creator;
+        QUuid volumeUuid;
+        quint64 generationNumber = 0;
+        qint64 updateTime = NO_TIME;
+        LocationData selfLocation;
+        LocationData previousGenerationLocation;
+        bool allowPolicyUpdate = false;
+        quint64 highestFileUid = 0;
+    };
+
+    CompactIndex();
+    ~CompactIndex();
+
+    // Disable copy
+    CompactIndex(const CompactIndex &) = delete;
+    CompactIndex &operator=(const CompactIndex &) = delete;
+
+    // === Access ===
+
+    const Header &header() const { return m_header; }
+
+    int directoryCount() const { return m_directories.size(); }
+    int fileCount() const { return m_files.size(); }
+    int extentCount() const { return m_extents.size(); }
+    int attributeCount() const { return m_attributes.size(); }
+
+    const Directory &directory(quint32 index) const { return m_directories[index]; }
+    const File &file(quint32 index) const { return m_files[index]; }
+    const Extent &extent(quint32 index) const { return m_extents[index]; }
+    const Attribute &attribute(quint32 index) const { return m_attributes[index]; }
+
+    /**
+     * @brief View of a string in the arena (valid while the index lives)
+     */
+    QUtf8StringView stringView(StringRef ref) const
+    {
+        return QUtf8StringView(m_strings.constData() + ref.offset, ref.length);
+    }
+
+    /**
+     * @brief Decoded copy of a string in the arena
+     */
+    QString string(StringRef ref) const;
+
+    /**
+     * @brief Value of the attribute with @p key on a file, or an empty string
+     */
+    QString fileAttribute(quint32 file, QStringView key) const;
+
+    /**
+     * @brief Path of a file from the root, '/'-separated, without the root name
+     */
+    QString filePath(quint32 file) const;
+
+    /**
+     * @brief Approximate heap memory used by the index in bytes
+     */
+    qint64 memoryUsage() const;
+
+    // === Conversion ===
+
+    static QDateTime toDateTime(qint64 nanoseconds);
+
+    LtfsFile toLtfsFile(quint32 file) const;
+
+    /**
+     * @brief Convert a directory, optionally with everything below it
+     */
+    LtfsDirectory toLtfsDirectory(quint32 directory, bool recursive = true) const;
+
+    // === Building (used by IndexParser) ===
+
+    Header &header() { return m_header; }
+    Directory &directory(quint32 index) { return m_directories[index]; }
+    File &file(quint32 index) { return m_files[index]; }
+
+    /**
+     * @brief Copy a string into the arena
+     */
+    StringRef addString(QStringView text);
+
+    /**
+     * @brief Like addString(), but identical texts share one copy
+     */
+    StringRef internString(QStringView text);
+
+    /**
+     * @brief Append a directory and link it as the last subdirectory of @p parent
+     * @param parent Parent directory, or NONE for the root
+     * @return Index of the new directory
+     */
+    quint32 addDirectory(quint32 parent);
+
+    /**
+     * @brief Append a file and link it as the last file of @p directory
+     * @return Index of the new file
+     */
+    quint32 addFile(quint32 directory);
+
+    /**
+     * @brief Append an extent to the extents of @p file
+     */
+    void addExtent(quint32 file, const Extent &extent);
+
+    /**
+     * @brief Append an attribute record
+     * @return Index of the new attribute
+     */
+    quint32 addAttribute(StringRef key, StringRef value);
+
+    /**
+     * @brief Release build-time bookkeeping and spare capacity
+     */
+    void squeeze();
+
+private:
+    friend class IndexCache;
+
+    Header m_header;
+    QVector<Directory> m_directories;
+    QVector<File> m_files;
+    QVector<Extent> m_extents;
+    QVector<Attribute> m_attributes;
+    QByteArray m_strings;                       ///< UTF-8 arena for all names and values
+
+    // Build-time only, released by squeeze()
+    QVector<quint32> m_lastSubdirectory;        ///< Tail of each directory's subdirectory chain
+    QVector<quint32> m_lastFile;                ///< Tail of each directory's file chain
+    QHash<QByteArray, StringRef> m_interned;    ///< Interned UTF-8 texts
+    QByteArray m_encodeBuffer;                  ///< Reused for interning lookups
+};
+
+} // namespace qltfs
@@ -0,0 +1,385 @@
+/*
+ * QLTOTapeMan - Qt-based LTO Tape Manager
+ * libqltfs - LTFS Core Library
+ *
+ * Copyright (c) 2026 Jeffrey ZHU (zhxsh1225@gmail.com)
+ * https://github.com/Gypsop/QLTOTapeMan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "IndexCache.h"
+#include "io/HashKernels.h"
+
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include <cstring>
+#include <type_traits>
+
+namespace qltfs {
+
+namespace {
+
+constexpr char CACHE_MAGIC[8] = {'Q', 'L', 'T', 'F', 'S', 'I', 'D', 'X'};
+constexpr quint32 CACHE_FORMAT_VERSION = 1;
+constexpr quint32 CACHE_BYTE_ORDER = 0x01020304;
+constexpr qint64 CACHE_ALIGNMENT = 8;
+
+static_assert(std::is_trivially_copyable<CompactIndex::Directory>::value, "tables are stored as raw arrays");
+static_assert(std::is_trivially_copyable<CompactIndex::File>::value, "tables are stored as raw arrays");
+static_assert(std::is_trivially_copyable<CompactIndex::Extent>::value, "tables are stored as raw arrays");
+static_assert(std::is_trivially_copyable<CompactIndex::Attribute>::value, "tables are stored as raw arrays");
+
+/**
+ * @brief Fixed header at the start of a cache file
+ *
+ * Tables follow the volume fields, each aligned to CACHE_ALIGNMENT. The
+ * record sizes and byte order guard against files written by a build
+ * with a different layout; those are treated as a cache miss.
+ */
+struct CacheFileHeader {
+    char magic[8];
+    quint32 formatVersion;
+    quint32 byteOrder;
+    quint32 directorySize;
+    quint32 fileSize;
+    quint32 extentSize;
+    quint32 attributeSize;
+    quint64 generationNumber;
+    quint64 volumeSize;         ///< Bytes of serialized volume fields
+    quint64 directoryCount;
+    quint64 fileCount;
+    quint64 extentCount;
+    quint64 attributeCount;
+    quint64 stringBytes;
+    quint32 checksum;           ///< CRC32C of everything after the header
+    quint32 reserved;
+};
+
+qint64 aligned(qint64 offset)
+{
+    return (offset + CACHE_ALIGNMENT - 1) & ~(CACHE_ALIGNMENT - 1);
+}
+
+QByteArray serializeVolume(const CompactIndex::Header &header)
+{
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << header.version << header.creator << header.volumeUuid
+        << header.updateTime
+        << static_cast<qint32>(header.selfLocation.partition) << header.selfLocation.startBlock
+        << static_cast<qint32>(header.previousGenerationLocation.partition)
+        << header.previousGenerationLocation.startBlock
+        << header.allowPolicyUpdate << header.highestFileUid;
+    return data;
+}
+
+bool deserializeVolume(const QByteArray &data, CompactIndex::Header &header)
+{
+    QDataStream in(data);
+    in.setVersion(QDataStream::Qt_6_0);
+
+    qint32 selfPartition = 0;
+    qint32 previousPartition = 0;
+    in >> header.version >> header.creator >> header.volumeUuid
+       >> header.updateTime
+       >> selfPartition >> header.selfLocation.startBlock
+       >> previousPartition >> header.previousGenerationLocation.startBlock
+       >> header.allowPolicyUpdate >> header.highestFileUid;
+    header.selfLocation.partition = static_cast<PartitionLabel>(selfPartition);
+    header.previousGenerationLocation.partition = static_cast<PartitionLabel>(previousPartition);
+
+    return in.status() == QDataStream::Ok;
+}
+
+/**
+ * @brief Size of a table in bytes, or -1 if it does not fit the file
+ */
+qint64 tableBytes(quint64 count, quint32 recordSize, qint64 available)
+{
+    if (count > static_cast<quint64>(std::numeric_limits<int>::max()) ||
+        count * recordSize > static_cast<quint64>(available)) {
+        return -1;
+    }
+    return static_cast<qint64>(count * recordSize);
+}
+
+template<typename T>
+void copyTable(QVector<T> &table, const uchar *data, quint64 count)
+{
+    table.resize(static_cast<int>(count));
+    if (count > 0) {
+        memcpy(static_cast<void *>(table.data()), data, count * sizeof(T));
+    }
+}
+
+} // namespace
+
+// ============================================================================
+// IndexCache Private Implementation
+// ============================================================================
+
+class IndexCache::Private
+{
+public:
+    QString directory;
+    QString lastError;
+
+    bool readHeader(QFile &file, CacheFileHeader &header);
+};
+
+bool IndexCache::Private::readHeader(QFile &file, CacheFileHeader &header)
+{
+    if (file.read(reinterpret_cast<char *>(&header), sizeof(header)) != sizeof(header)) {
+        return false;
+    }
+
+    return memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) == 0 &&
+           header.formatVersion == CACHE_FORMAT_VERSION &&
+           header.byteOrder == CACHE_BYTE_ORDER &&
+           header.directorySize == sizeof(CompactIndex::Directory) &&
+           header.fileSize == sizeof(CompactIndex::File) &&
+           header.extentSize == sizeof(CompactIndex::Extent) &&
+           header.attributeSize == sizeof(CompactIndex::Attribute);
+}
+
+// ============================================================================
+// IndexCache Implementation
+// ============================================================================
+
+IndexCache::IndexCache(const QString &directory)
+    : d(new Private)
+{
+    d->directory = directory;
+    if (d->directory.isEmpty()) {
+        d->directory = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) +
+                       QStringLiteral("/indexes");
+    }
+}
+
+IndexCache::~IndexCache()
+{
+    delete d;
+}
+
+QString IndexCache::directory() const
+{
+    return d->directory;
+}
+
+QString IndexCache::cachePath(const QUuid &volumeUuid) const
+{
+    return d->directory + QLatin1Char('/') +
+           volumeUuid.toString(QUuid::WithoutBraces) + QStringLiteral(".qltfsidx");
+}
+
+bool IndexCache::contains(const QUuid &volumeUuid, quint64 generationNumber) const
+{
+    QFile file(cachePath(volumeUuid));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    CacheFileHeader header;
+    return d->readHeader(file, header) && header.generationNumber == generationNumber;
+}
+
+QSharedPointer<CompactIndex> IndexCache::load(const QUuid &volumeUuid, quint64 generationNumber)
+{
+    d->lastError.clear();
+
+    QFile file(cachePath(volumeUuid));
+    if (!file.open(QIODevice::ReadOnly)) {
+        d->lastError = QStringLiteral("Volume not cached");
+        return nullptr;
+    }
+
+    CacheFileHeader header;
+    if (!d->readHeader(file, header)) {
+        d->lastError = QStringLiteral("Cache file has an incompatible format");
+        return nullptr;
+    }
+    if (header.generationNumber != generationNumber) {
+        d->lastError = QStringLiteral("Cached index is generation %1, tape has %2")
+                           .arg(header.generationNumber).arg(generationNumber);
+        return nullptr;
+    }
+
+    const qint64 size = file.size();
+    uchar *data = file.map(0, size);
+    if (!data) {
+        d->lastError = QStringLiteral("Failed to map cache file: %1").arg(file.errorString());
+        return nullptr;
+    }
+
+    const uchar *payload = data + sizeof(CacheFileHeader);
+    const qint64 payloadSize = size - static_cast<qint64>(sizeof(CacheFileHeader));
+
+    auto fail = [&](const QString &message) -> QSharedPointer<CompactIndex> {
+        d->lastError = message;
+        file.unmap(data);
+        return nullptr;
+    };
+
+    if (Crc32c::extend(0, payload, static_cast<size_t>(payloadSize)) != header.checksum) {
+        return fail(QStringLiteral("Cache file is corrupted"));
+    }
+
+    // Locate the tables
+    qint64 offset = 0;
+    if (header.volumeSize > static_cast<quint64>(payloadSize)) {
+        return fail(QStringLiteral("Cache file is truncated"));
+    }
+    const QByteArray volume = QByteArray::fromRawData(reinterpret_cast<const char *>(payload),
+                                                      static_cast<qsizetype>(header.volumeSize));
+    offset = aligned(static_cast<qint64>(header.volumeSize));
+
+    const quint64 counts[] = {header.directoryCount, header.fileCount, header.extentCount,
+                              header.attributeCount, header.stringBytes};
+    const quint32 recordSizes[] = {header.directorySize, header.fileSize, header.extentSize,
+                                   header.attributeSize, 1};
+    qint64 offsets[5];
+    for (int i = 0; i < 5; ++i) {
+        const qint64 bytes = tableBytes(counts[i], recordSizes[i], payloadSize - qMin(offset, payloadSize));
+        if (bytes < 0) {
+            return fail(QStringLiteral("Cache file is truncated"));
+        }
+        offsets[i] = offset;
+        offset = aligned(offset + bytes);
+    }
+
+    auto index = QSharedPointer<CompactIndex>::create();
+    if (!deserializeVolume(volume, index->m_header)) {
+        return fail(QStringLiteral("Cache file is corrupted"));
+    }
+    index->m_header.generationNumber = header.generationNumber;
+
+    copyTable(index->m_directories, payload + offsets[0], header.directoryCount);
+    copyTable(index->m_files, payload + offsets[1], header.fileCount);
+    copyTable(index->m_extents, payload + offsets[2], header.extentCount);
+    copyTable(index->m_attributes, payload + offsets[3], header.attributeCount);
+    index->m_strings = QByteArray(reinterpret_cast<const char *>(payload + offsets[4]),
+                                  static_cast<qsizetype>(header.stringBytes));
+
+    file.unmap(data);
+    return index;
+}
+
+bool IndexCache::store(const CompactIndex &index)
+{
+    d->lastError.clear();
+
+    if (index.m_header.volumeUuid.isNull()) {
+        d->lastError = QStringLiteral("Index has no volume UUID");
+        return false;
+    }
+
+    if (!QDir().mkpath(d->directory)) {
+        d->lastError = QStringLiteral("Failed to create cache directory: %1").arg(d->directory);
+        return false;
+    }
+
+    CacheFileHeader header = {};
+    memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.formatVersion = CACHE_FORMAT_VERSION;
+    header.byteOrder = CACHE_BYTE_ORDER;
+    header.directorySize = sizeof(CompactIndex::Directory);
+    header.fileSize = sizeof(CompactIndex::File);
+    header.extentSize = sizeof(CompactIndex::Extent);
+    header.attributeSize = sizeof(CompactIndex::Attribute);
+    header.generationNumber = index.m_header.generationNumber;
+
+    const QByteArray volume = serializeVolume(index.m_header);
+    header.volumeSize = static_cast<quint64>(volume.size());
+    header.directoryCount = static_cast<quint64>(index.m_directories.size());
+    header.fileCount = static_cast<quint64>(index.m_files.size());
+    header.extentCount = static_cast<quint64>(index.m_extents.size());
+    header.attributeCount = static_cast<quint64>(index.m_attributes.size());
+    header.stringBytes = static_cast<quint64>(index.m_strings.size());
+
+    const struct {
+        const void *data;
+        qint64 bytes;
+    } sections[] = {
+        {volume.constData(), volume.size()},
+        {index.m_directories.constData(), index.m_directories.size() * qint64(sizeof(CompactIndex::Directory))},
+        {index.m_files.constData(), index.m_files.size() * qint64(sizeof(CompactIndex::File))},
+        {index.m_extents.constData(), index.m_extents.size() * qint64(sizeof(CompactIndex::Extent))},
+        {index.m_attributes.constData(), index.m_attributes.size() * qint64(sizeof(CompactIndex::Attribute))},
+        {index.m_strings.constData(), index.m_strings.size()},
+    };
+    static const char padding[CACHE_ALIGNMENT] = {};
+
+    // The checksum goes into the header, so it is computed over the
+    // sections first rather than over a copy of the whole payload
+    quint32 checksum = 0;
+    for (const auto &section : sections) {
+        checksum = Crc32c::extend(checksum, section.data, static_cast<size_t>(section.bytes));
+        checksum = Crc32c::extend(checksum, padding,
+                                  static_cast<size_t>(aligned(section.bytes) - section.bytes));
+    }
+    header.checksum = checksum;
+
+    // Replace the previous generation atomically
+    QSaveFile file(cachePath(index.m_header.volumeUuid));
+    if (!file.open(QIODevice::WriteOnly)) {
+        d->lastError = QStringLiteral("Failed to create cache file: %1").arg(file.errorString());
+        return false;
+    }
+
+    bool ok = file.write(reinterpret_cast<const char *>(&header), sizeof(header)) == sizeof(header);
+    for (const auto &section : sections) {
+        const qint64 pad = aligned(section.bytes) - section.bytes;
+        ok = ok && file.write(static_cast<const char *>(section.data), section.bytes) == section.bytes;
+        ok = ok && file.write(padding, pad) == pad;
+    }
+
+    if (!ok) {
+        d->lastError = QStringLiteral("Failed to write cache file: %1").arg(file.errorString());
+        file.cancelWriting();
+        return false;
+    }
+
+    if (!file.commit()) {
+        d->lastError = QStringLiteral("Failed to write cache file: %1").arg(file.errorString());
+        return false;
+    }
+    return true;
+}
+
+bool IndexCache::remove(const QUuid &volumeUuid)
+{
+    QFile file(cachePath(volumeUuid));
+    if (!file.exists()) {
+        return true;
+    }
+    if (!file.remove()) {
+        d->lastError = QStringLiteral("Failed to remove cache file: %1").arg(file.errorString());
+        return false;
+    }
+    return true;
+}
+
+QString IndexCache::lastError() const
+{
+    return d->lastError;
+}
+
+} // namespace qltfs
@@ -0,0 +1,105 @@
+/*
+ * QLTOTapeMan - Qt-based LTO Tape Manager
+ * libqltfs - LTFS Core Library
+ *
+ * Copyright (c) 2026 Jeffrey ZHU (zhxsh1225@gmail.com)
+ * https://github.com/Gypsop/QLTOTapeMan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "libqltfs_global.h"
+#include "core/CompactIndex.h"
+
+#include <QSharedPointer>
+#include <QString>
+#include <QUuid>
+
+namespace qltfs {
+
+/**
+ * @brief On-disk binary cache of parsed indexes, keyed by volume
+ *
+ * Stores a CompactIndex as a single file per volume UUID: a fixed header,
+ * the volume fields, then the directory, file, extent and attribute
+ * tables and the string arena as raw arrays. Loading maps the file and
+ * copies each table in one block, so re-mounting a known tape costs a
+ * few milliseconds regardless of the number of files.
+ *
+ * Only the latest generation of each volume is kept. load() returns null
+ * when the cached generation differs from the one on tape, in which case
+ * the XML index has to be parsed and stored again.
+ */
+class LIBQLTFS_EXPORT IndexCache
+{
+public:
+    /**
+     * @brief Constructor
+     * @param directory Cache directory (default: "indexes" in the application cache location)
+     */
+    explicit IndexCache(const QString &directory = QString());
+    ~IndexCache();
+
+    // Disable copy
+    IndexCache(const IndexCache &) = delete;
+    IndexCache &operator=(const IndexCache &) = delete;
+
+    /**
+     * @brief Get the cache directory
+     */
+    QString directory() const;
+
+    /**
+     * @brief Get the cache file used for a volume
+     */
+    QString cachePath(const QUuid &volumeUuid) const;
+
+    /**
+     * @brief Check if a volume is cached at a given generation
+     */
+    bool contains(const QUuid &volumeUuid, quint64 generationNumber) const;
+
+    /**
+     * @brief Load a cached index
+     * @param volumeUuid Volume UUID from the tape label
+     * @param generationNumber Generation of the index on tape
+     * @return Index, or null if not cached, stale or unreadable
+     */
+    QSharedPointer<CompactIndex> load(const QUuid &volumeUuid, quint64 generationNumber);
+
+    /**
+     * @brief Store an index, replacing any older generation of the volume
+     * @return true if successful
+     */
+    bool store(const CompactIndex &index);
+
+    /**
+     * @brief Remove the cached index of a volume
+     */
+    bool remove(const QUuid &volumeUuid);
+
+    /**
+     * @brief Get last error message
+     */
+    QString lastError() const;
+
+private:
+    class Private;
+    Private *d;
+};
+
+} // namespace qltfs
@@ -0,0 +1,472 @@
+/*
+ * QLTOTapeMan - Qt-based LTO Tape Manager
+ * libqltfs - LTFS Core Library
+ *
+ * Copyright (c) 2026 Jeffrey ZHU (zhxsh1225@gmail.com)
+ * https://github.com/Gypsop/QLTOTapeMan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "IndexQuery.h"
+#include "CompactIndex.h"
+
+#include <QtConcurrent>
+
+#include <cstring>
+#include <functional>
+#include <limits>
+
+namespace qltfs {
+
+// Files per unit of work handed to the thread pool
+static constexpr int CHUNK_FILES = 16384;
+
+namespace {
+
+char foldAscii(char c)
+{
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+bool sameByte(char a, char b, bool fold)
+{
+    return a == b || (fold && foldAscii(a) == foldAscii(b));
+}
+
+/**
+ * @brief Match a '[...]' class at @p p against @p c
+ * @return Position after the class, or nullptr if the class is not closed
+ */
+const char *matchClass(const char *p, const char *pe, char c, bool fold, bool &matched)
+{
+    matched = false;
+    ++p;    // '['
+    const bool negate = p < pe && (*p == '!' || *p == '^');
+    if (negate) {
+        ++p;
+    }
+
+    bool first = true;
+    while (p < pe && (*p != ']' || first)) {
+        first = false;
+        char low = *p++;
+        if (low == '\\' && p < pe) {
+            low = *p++;
+        }
+        char high = low;
+        if (p + 1 < pe && *p == '-' && p[1] != ']') {
+            high = p[1];
+            p += 2;
+        }
+        if ((c >= low && c <= high) ||
+            (fold && foldAscii(c) >= foldAscii(low) && foldAscii(c) <= foldAscii(high))) {
+            matched = true;
+        }
+    }
+    if (p == pe) {
+        return nullptr;
+    }
+    matched = matched != negate;
+    return p + 1;
+}
+
+/**
+ * @brief Glob match over UTF-8 bytes
+ *
+ * Backtracks only at stars, which is cheap for the short names and
+ * patterns of an index. With @p paths set, '*' and '?' do not match '/'.
+ */
+bool globMatch(const char *p, const char *pe, const char *s, const char *se, bool fold, bool paths)
+{
+    while (p < pe) {
+        if (*p == '*') {
+            const bool crossing = !paths || (p + 1 < pe && p[1] == '*');
+            while (p < pe && *p == '*') {
+                ++p;
+            }
+            if (p == pe) {
+                return crossing || !std::memchr(s, '/', static_cast<size_t>(se - s));
+            }
+            // "**/" also stands for no directory at all
+            if (paths && crossing && *p == '/' && globMatch(p + 1, pe, s, se, fold, paths)) {
+                return true;
+            }
+            for (const char *t = s; ; ++t) {
+                if (globMatch(p, pe, t, se, fold, paths)) {
+                    return true;
+                }
+                if (t == se || (!crossing && *t == '/')) {
+                    return false;
+                }
+            }
+        }
+
+        if (s == se) {
+            return false;
+        }
+
+        if (*p == '?') {
+            if (paths && *s == '/') {
+                return false;
+            }
+            // One character, however many UTF-8 bytes it takes
+            ++s;
+            while (s < se && (static_cast<unsigned char>(*s) & 0xC0) == 0x80) {
+                ++s;
+            }
+            ++p;
+            continue;
+        }
+
+        if (*p == '[') {
+            bool matched = false;
+            const char *next = matchClass(p, pe, *s, fold, matched);
+            if (next) {
+                if (!matched || (paths && *s == '/')) {
+                    return false;
+                }
+                p = next;
+                ++s;
+                continue;
+            }
+            // Unclosed '[' is an ordinary character
+        }
+
+        if (*p == '\\' && p + 1 < pe) {
+            ++p;
+        }
+        if (!sameByte(*p, *s, fold)) {
+            return false;
+        }
+        ++p;
+        ++s;
+    }
+    return s == se;
+}
+
+bool equalsFolded(const char *a, qsizetype aLength, const QByteArray &b)
+{
+    if (aLength != b.size()) {
+        return false;
+    }
+    for (qsizetype i = 0; i < aLength; ++i) {
+        if (!sameByte(a[i], b[i], true)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+qint64 toNanoseconds(const QDateTime &time, qint64 open)
+{
+    return time.isValid() ? time.toMSecsSinceEpoch() * 1000000 : open;
+}
+
+} // namespace
+
+/**
+ * @brief Criteria of a query prepared for scanning
+ */
+class IndexQuery::Matcher
+{
+public:
+    explicit Matcher(const IndexQuery &query)
+        : m_query(query)
+        , m_timed(query.m_modifiedFrom.isValid() || query.m_modifiedTo.isValid())
+        , m_from(toNanoseconds(query.m_modifiedFrom, std::numeric_limits<qint64>::min()))
+        , m_to(toNanoseconds(query.m_modifiedTo, std::numeric_limits<qint64>::max()))
+    {
+    }
+
+    bool needsPath() const { return m_query.m_matchPath; }
+
+    /**
+     * @brief Test everything but the path and the attributes
+     */
+    bool matchesRecord(qint64 length, qint64 modifyNs, bool hasTime) const
+    {
+        if (length < m_query.m_minSize || (m_query.m_maxSize >= 0 && length > m_query.m_maxSize)) {
+            return false;
+        }
+        return !m_timed || (hasTime && modifyNs >= m_from && modifyNs < m_to);
+    }
+
+    bool matchesName(const char *text, qsizetype length) const
+    {
+        const QByteArray &pattern = m_query.m_pattern;
+        return pattern.isEmpty() ||
+               globMatch(pattern.constData(), pattern.constData() + pattern.size(), text, text + length,
+                         m_query.m_caseSensitivity == Qt::CaseInsensitive, true);
+    }
+
+    /**
+     * @brief Test the attribute criteria
+     * @param value Looks up an attribute: (key, &data, &length) -> found
+     */
+    template<typename Lookup>
+    bool matchesAttributes(Lookup value) const
+    {
+        for (const AttributeCriterion &criterion : m_query.m_attributes) {
+            const char *data = nullptr;
+            qsizetype length = 0;
+            if (!value(criterion.key, data, length)) {
+                return false;
+            }
+            if (criterion.hash) {
+                if (!equalsFolded(data, length, criterion.value)) {
+                    return false;
+                }
+            } else if (!criterion.value.isEmpty() &&
+                       !globMatch(criterion.value.constData(), criterion.value.constData() + criterion.value.size(),
+                                  data, data + length, false, false)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    const IndexQuery &m_query;
+    bool m_timed;
+    qint64 m_from;
+    qint64 m_to;
+};
+
+// ============================================================================
+// IndexQuery Implementation
+// ============================================================================
+
+IndexQuery::IndexQuery()
+{
+}
+
+void IndexQuery::setPathPattern(const QString &pattern, Qt::CaseSensitivity caseSensitivity)
+{
+    m_pattern = pattern.toUtf8();
+    while (m_pattern.startsWith('/')) {
+        m_pattern.remove(0, 1);
+    }
+    m_matchPath = m_pattern.contains('/');
+    m_caseSensitivity = caseSensitivity;
+}
+
+void IndexQuery::setSizeRange(qint64 minimum, qint64 maximum)
+{
+    m_minSize = minimum;
+    m_maxSize = maximum;
+}
+
+void IndexQuery::setModifiedRange(const QDateTime &from, const QDateTime &to)
+{
+    m_modifiedFrom = from;
+    m_modifiedTo = to;
+}
+
+void IndexQuery::addAttribute(const QString &key, const QString &valuePattern)
+{
+    AttributeCriterion criterion;
+    criterion.key = key.toUtf8();
+    criterion.value = valuePattern.toUtf8();
+    m_attributes.append(criterion);
+}
+
+void IndexQuery::addHash(const QString &attributeKey, const QString &hash)
+{
+    AttributeCriterion criterion;
+    criterion.key = attributeKey.toUtf8();
+    criterion.value = hash.toUtf8();
+    criterion.hash = true;
+    m_attributes.append(criterion);
+}
+
+void IndexQuery::clear()
+{
+    *this = IndexQuery();
+}
+
+bool IndexQuery::matchGlob(const QByteArray &pattern, const QByteArray &text, Qt::CaseSensitivity caseSensitivity)
+{
+    return globMatch(pattern.constData(), pattern.constData() + pattern.size(),
+                     text.constData(), text.constData() + text.size(),
+                     caseSensitivity == Qt::CaseInsensitive, true);
+}
+
+QVector<quint32> IndexQuery::findFiles(const CompactIndex &index) const
+{
+    const Matcher matcher(*this);
+
+    // Parents always precede their subdirectories, so paths are built
+    // in one pass; only needed when the pattern spans directories
+    QVector<QByteArray> directoryPaths;
+    if (matcher.needsPath()) {
+        directoryPaths.resize(index.directoryCount());
+        for (int i = 0; i < index.directoryCount(); ++i) {
+            const CompactIndex::Directory &directory = index.directory(i);
+            if (directory.parent != CompactIndex::NONE) {
+                const QByteArray &parent = directoryPaths[directory.parent];
+                const QUtf8StringView name = index.stringView(directory.name);
+                QByteArray &path = directoryPaths[i];
+                path.reserve(parent.size() + 1 + name.size());
+                if (!parent.isEmpty()) {
+                    path.append(parent).append('/');
+                }
+                path.append(name.data(), name.size());
+            }
+        }
+    }
+
+    struct Chunk {
+        int begin = 0;
+        int end = 0;
+        QVector<quint32> files;
+    };
+    QVector<Chunk> chunks;
+    for (int begin = 0; begin < index.fileCount(); begin += CHUNK_FILES) {
+        Chunk chunk;
+        chunk.begin = begin;
+        chunk.end = qMin(index.fileCount(), begin + CHUNK_FILES);
+        chunks.append(chunk);
+    }
+
+    QtConcurrent::blockingMap(chunks, [&](Chunk &chunk) {
+        QByteArray path;    // Reused for every file of the chunk
+        for (int i = chunk.begin; i < chunk.end; ++i) {
+            const CompactIndex::File &file = index.file(i);
+            if (!matcher.matchesRecord(file.length, file.times.modify, file.times.modify != CompactIndex::NO_TIME)) {
+                continue;
+            }
+
+            const QUtf8StringView name = index.stringView(file.name);
+            if (matcher.needsPath()) {
+                const QByteArray &directory = directoryPaths[file.directory];
+                path.clear();
+                if (!directory.isEmpty()) {
+                    path.append(directory).append('/');
+                }
+                path.append(name.data(), name.size());
+                if (!matcher.matchesName(path.constData(), path.size())) {
+                    continue;
+                }
+            } else if (!matcher.matchesName(name.data(), name.size())) {
+                continue;
+            }
+
+            const bool attributes = matcher.matchesAttributes(
+                [&index, &file](const QByteArray &key, const char *&data, qsizetype &length) {
+                    for (quint32 a = file.firstAttribute; a < file.firstAttribute + file.attributeCount; ++a) {
+                        const CompactIndex::Attribute &attribute = index.attribute(a);
+                        const QUtf8StringView candidate = index.stringView(attribute.key);
+                        if (candidate.size() == key.size() &&
+                            std::memcmp(candidate.data(), key.constData(), static_cast<size_t>(key.size())) == 0) {
+                            const QUtf8StringView value = index.stringView(attribute.value);
+                            data = value.data();
+                            length = value.size();
+                            return true;
+                        }
+                    }
+                    return false;
+                });
+            if (attributes) {
+                chunk.files.append(static_cast<quint32>(i));
+            }
+        }
+    });
+
+    QVector<quint32> files;
+    for (const Chunk &chunk : chunks) {
+        files += chunk.files;
+    }
+    return files;
+}
+
+IndexQuery::Result IndexQuery::select(const CompactIndex &index) const
+{
+    Result result;
+    for (quint32 file : findFiles(index)) {
+        result.files.append(index.toLtfsFile(file));
+        result.paths.append(index.filePath(file));
+        result.totalBytes += index.file(file).length;
+    }
+    return result;
+}
+
+IndexQuery::Result IndexQuery::select(const LtfsIndex &index) const
+{
+    // Flatten the tree first so the files can be tested in parallel
+    struct Candidate {
+        LtfsFile file;
+        QString path;
+        bool matched = false;
+    };
+    QVector<Candidate> candidates;
+
+    std::function<void(const LtfsDirectory &, const QString &)> collect =
+        [&candidates, &collect](const LtfsDirectory &directory, const QString &path) {
+            for (const auto &file : directory.files()) {
+                Candidate candidate;
+                candidate.file = file;
+                candidate.path = path.isEmpty() ? file.name() : path + QLatin1Char('/') + file.name();
+                candidates.append(candidate);
+            }
+            for (const auto &subdir : directory.subdirectories()) {
+                collect(subdir, path.isEmpty() ? subdir.name() : path + QLatin1Char('/') + subdir.name());
+            }
+        };
+    collect(index.rootDirectory(), QString());
+
+    const Matcher matcher(*this);
+    QtConcurrent::blockingMap(candidates, [&matcher](Candidate &candidate) {
+        const LtfsFile &file = candidate.file;
+        const QDateTime modified = file.modifyTime();
+        const qint64 modifyNs = modified.isValid() ? modified.toMSecsSinceEpoch() * 1000000 : 0;
+        if (!matcher.matchesRecord(file.length(), modifyNs, modified.isValid())) {
+            return;
+        }
+
+        const QByteArray name = (matcher.needsPath() ? candidate.path : file.name()).toUtf8();
+        if (!matcher.matchesName(name.constData(), name.size())) {
+            return;
+        }
+
+        const QList<ExtendedAttribute> attributes = file.extendedAttributes();
+        QByteArray value;   // Holds the data handed out by the lookup
+        candidate.matched = matcher.matchesAttributes(
+            [&attributes, &value](const QByteArray &key, const char *&data, qsizetype &length) {
+                const QString wanted = QString::fromUtf8(key);
+                for (const auto &attribute : attributes) {
+                    if (attribute.key == wanted) {
+                        value = attribute.value.toUtf8();
+                        data = value.constData();
+                        length = value.size();
+                        return true;
+                    }
+                }
+                return false;
+            });
+    });
+
+    Result result;
+    for (const Candidate &candidate : candidates) {
+        if (candidate.matched) {
+            result.files.append(candidate.file);
+            result.paths.append(candidate.path);
+            result.totalBytes += candidate.file.length();
+        }
+    }
+    return result;
+}
+
+} // namespace qltfs
@@ -0,0 +1,163 @@
+/*
+ * QLTOTapeMan - Qt-based LTO Tape Manager
+ * libqltfs - LTFS Core Library
+ *
+ * Copyright (c) 2026 Jeffrey ZHU (zhxsh1225@gmail.com)
+ * https://github.com/Gypsop/QLTOTapeMan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "libqltfs_global.h"
+#include "core/LtfsIndex.h"
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+namespace qltfs {
+
+class CompactIndex;
+
+/**
+ * @brief Filter over the files of an index
+ *
+ * All criteria set must hold for a file to match:
+ * - a path glob: '*' and '?' stay within one path component, '**'
+ *   also crosses '/' ("**" followed by '/' matches zero or more
+ *   directories), '[...]' is a byte class (ASCII ranges, '!' or '^'
+ *   negates) and '\' escapes. A pattern without '/' is matched against
+ *   the file name, otherwise against the full path from the root
+ * - a size range and a modification time range
+ * - extended attributes: present, or with a value matching a glob, or
+ *   a recorded hash (compared case-insensitively)
+ *
+ * The compact index is scanned in place, in chunks spread over the
+ * global thread pool, without converting any record that does not
+ * match. Results come back in index order; hand the files to
+ * TapeIO::scheduleRestore(), readFiles() or exportFiles() to get them
+ * in tape order.
+ *
+ * Example: all .mxf files over 50 GB modified in 2025
+ * @code
+ * IndexQuery query;
+ * query.setPathPattern(QStringLiteral("*.mxf"));
+ * query.setSizeRange(50LL * 1000 * 1000 * 1000);
+ * query.setModifiedRange(QDateTime(QDate(2025, 1, 1), QTime(), Qt::UTC),
+ *                        QDateTime(QDate(2026, 1, 1), QTime(), Qt::UTC));
+ * IndexQuery::Result result = query.select(compactIndex);
+ * @endcode
+ */
+class LIBQLTFS_EXPORT IndexQuery
+{
+public:
+    /**
+     * @brief Matching files with their paths
+     */
+    struct Result {
+        QList<LtfsFile> files;
+        QStringList paths;          ///< '/'-separated from the root, without the root name
+        qint64 totalBytes = 0;
+    };
+
+    IndexQuery();
+
+    /**
+     * @brief Match file names or paths against a glob
+     * @param caseSensitivity Qt::CaseInsensitive folds ASCII letters only
+     */
+    void setPathPattern(const QString &pattern, Qt::CaseSensitivity caseSensitivity = Qt::CaseSensitive);
+
+    /**
+     * @brief Limit the file length
+     * @param minimum Smallest length in bytes
+     * @param maximum Largest length in bytes, -1 = no limit
+     */
+    void setSizeRange(qint64 minimum, qint64 maximum = -1);
+
+    /**
+     * @brief Limit the modification time to [@p from, @p to)
+     *
+     * An invalid bound leaves that end open. Files without a
+     * modification time never match a time range.
+     */
+    void setModifiedRange(const QDateTime &from, const QDateTime &to);
+
+    /**
+     * @brief Require an extended attribute
+     * @param key Attribute key, compared exactly
+     * @param valuePattern Glob the value must match; empty = any value
+     */
+    void addAttribute(const QString &key, const QString &valuePattern = QString());
+
+    /**
+     * @brief Require a recorded content hash
+     * @param attributeKey Hash attribute key (see HashCalculator::attributeKey())
+     * @param hash Hash value, compared case-insensitively
+     */
+    void addHash(const QString &attributeKey, const QString &hash);
+
+    /**
+     * @brief Remove all criteria, so every file matches
+     */
+    void clear();
+
+    /**
+     * @brief Find matching files in a compact index
+     * @return Indices of the files, ascending
+     */
+    QVector<quint32> findFiles(const CompactIndex &index) const;
+
+    /**
+     * @brief Find matching files in a compact index and convert them
+     */
+    Result select(const CompactIndex &index) const;
+
+    /**
+     * @brief Find matching files in an index tree
+     */
+    Result select(const LtfsIndex &index) const;
+
+    /**
+     * @brief Match a name or path against a glob (see setPathPattern())
+     */
+    static bool matchGlob(const QByteArray &pattern, const QByteArray &text,
+                          Qt::CaseSensitivity caseSensitivity = Qt::CaseSensitive);
+
+private:
+    struct AttributeCriterion {
+        QByteArray key;
+        QByteArray value;           ///< Glob, or the hash for a hash criterion
+        bool hash = false;
+    };
+
+    class Matcher;
+
+    QByteArray m_pattern;           ///< UTF-8, leading '/' removed
+    bool m_matchPath = false;       ///< Pattern contains '/'
+    Qt::CaseSensitivity m_caseSensitivity = Qt::CaseSensitive;
+    qint64 m_minSize = 0;
+    qint64 m_maxSize = -1;
+    QDateTime m_modifiedFrom;
+    QDateTime m_modifiedTo;
+    QList<AttributeCriterion> m_attributes;
+};
+
+} // namespace qltfs
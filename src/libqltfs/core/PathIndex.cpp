@@ -0,0 +1,288 @@
+/*
+ * QLTOTapeMan - Qt-based LTO Tape Manager
+ * libqltfs - LTFS Core Library
+ *
+ * Copyright (c) 2026 Jeffrey ZHU (zhxsh1225@gmail.com)
+ * https://github.com/Gypsop/QLTOTapeMan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "PathIndex.h"
+#include "CompactIndex.h"
+
+#include <QVector>
+
+namespace qltfs {
+
+namespace {
+
+const QLatin1String HASH_ATTRIBUTE_PREFIX("ltfs.hash.");
+
+QString childPath(const QString &parent, const QString &name)
+{
+    return parent.isEmpty() ? name : parent + QLatin1Char('/') + name;
+}
+
+QString parentPath(const QString &path)
+{
+    const qsizetype slash = path.lastIndexOf(QLatin1Char('/'));
+    return slash < 0 ? QString() : path.left(slash);
+}
+
+} // namespace
+
+PathIndex::PathIndex()
+{
+}
+
+void PathIndex::build(const LtfsIndex &index)
+{
+    clear();
+    buildDirectory(index.rootDirectory(), QString());
+}
+
+void PathIndex::build(const CompactIndex &index)
+{
+    clear();
+    m_entries.reserve(index.directoryCount() + index.fileCount());
+
+    // Parents always precede their subdirectories, so paths can be built in one pass
+    QVector<QString> directoryPaths(index.directoryCount());
+    for (int i = 0; i < index.directoryCount(); ++i) {
+        const CompactIndex::Directory &directory = index.directory(i);
+        if (directory.parent != CompactIndex::NONE) {
+            directoryPaths[i] = childPath(directoryPaths[directory.parent], index.string(directory.name));
+        }
+
+        Entry entry;
+        entry.directory = true;
+        entry.modifyTime = directory.times.modify == CompactIndex::NO_TIME
+                               ? 0 : CompactIndex::toDateTime(directory.times.modify).toMSecsSinceEpoch();
+        entry.uid = directory.uid;
+        m_entries.insert(directoryPaths[i], entry);
+    }
+
+    for (int i = 0; i < index.fileCount(); ++i) {
+        const CompactIndex::File &file = index.file(i);
+
+        Entry entry;
+        entry.length = file.length;
+        entry.modifyTime = file.times.modify == CompactIndex::NO_TIME
+                               ? 0 : CompactIndex::toDateTime(file.times.modify).toMSecsSinceEpoch();
+        entry.uid = file.uid;
+        for (quint32 a = 0; a < file.attributeCount; ++a) {
+            const CompactIndex::Attribute &attribute = index.attribute(file.firstAttribute + a);
+            const QString key = index.string(attribute.key);
+            if (key.startsWith(HASH_ATTRIBUTE_PREFIX)) {
+                entry.hashes.append(contentKey(key, index.string(attribute.value)));
+            }
+        }
+
+        addFileEntry(childPath(directoryPaths.value(file.directory), index.string(file.name)), entry);
+    }
+}
+
+void PathIndex::buildDirectory(const LtfsDirectory &directory, const QString &path)
+{
+    Entry entry;
+    entry.directory = true;
+    entry.modifyTime = directory.modifyTime().toMSecsSinceEpoch();
+    entry.uid = directory.uid();
+    m_entries.insert(path, entry);
+
+    for (const auto &file : directory.files()) {
+        addFile(childPath(path, file.name()), file);
+    }
+    for (const auto &subdir : directory.subdirectories()) {
+        buildDirectory(subdir, childPath(path, subdir.name()));
+    }
+}
+
+void PathIndex::clear()
+{
+    m_entries.clear();
+    m_hashes.clear();
+    m_lengths.clear();
+    m_fileCount = 0;
+}
+
+void PathIndex::addFile(const QString &path, const LtfsFile &file)
+{
+    Entry entry;
+    entry.length = file.length();
+    entry.modifyTime = file.modifyTime().toMSecsSinceEpoch();
+    entry.uid = file.uid();
+    for (const auto &attr : file.extendedAttributes()) {
+        if (attr.key.startsWith(HASH_ATTRIBUTE_PREFIX)) {
+            entry.hashes.append(contentKey(attr.key, attr.value));
+        }
+    }
+    entry.extents = file.extentInfo();
+
+    addFileEntry(normalizePath(path), entry);
+}
+
+bool PathIndex::addCopy(const QString &path, const QString &existingPath, qint64 modifyTime)
+{
+    const Entry *existing = find(existingPath);
+    if (!existing || existing->directory) {
+        return false;
+    }
+
+    Entry entry = *existing;
+    entry.modifyTime = modifyTime;
+    entry.uid = 0;
+    addFileEntry(normalizePath(path), entry);
+    return true;
+}
+
+void PathIndex::addFileEntry(const QString &normalizedPath, Entry entry)
+{
+    auto it = m_entries.find(normalizedPath);
+    if (it != m_entries.end()) {
+        // Replacing an existing file (or a directory of the same name)
+        if (it->directory) {
+            remove(normalizedPath);
+        } else {
+            removeHashes(normalizedPath, *it);
+            removeLength(it->length);
+            m_fileCount--;
+        }
+    }
+
+    addDirectoryEntries(parentPath(normalizedPath));
+
+    for (const QString &key : entry.hashes) {
+        m_hashes.insert(key, normalizedPath);
+    }
+    m_lengths[entry.length]++;
+    m_entries.insert(normalizedPath, entry);
+    m_fileCount++;
+}
+
+void PathIndex::addDirectory(const QString &path)
+{
+    addDirectoryEntries(normalizePath(path));
+}
+
+void PathIndex::addDirectoryEntries(const QString &normalizedPath)
+{
+    // Walk up until an existing directory is found
+    QString path = normalizedPath;
+    for (;;) {
+        auto it = m_entries.find(path);
+        if (it != m_entries.end() && it->directory) {
+            return;
+        }
+
+        Entry entry;
+        entry.directory = true;
+        m_entries.insert(path, entry);
+
+        if (path.isEmpty()) {
+            return;
+        }
+        path = parentPath(path);
+    }
+}
+
+bool PathIndex::remove(const QString &path)
+{
+    const QString key = normalizePath(path);
+    auto it = m_entries.find(key);
+    if (it == m_entries.end()) {
+        return false;
+    }
+
+    if (!it->directory) {
+        removeHashes(key, *it);
+        removeLength(it->length);
+        m_entries.erase(it);
+        m_fileCount--;
+        return true;
+    }
+
+    // Directories take everything below them along
+    const QString prefix = key.isEmpty() ? QString() : key + QLatin1Char('/');
+    for (auto entry = m_entries.begin(); entry != m_entries.end();) {
+        if (entry.key() == key || entry.key().startsWith(prefix)) {
+            if (!entry->directory) {
+                removeHashes(entry.key(), *entry);
+                removeLength(entry->length);
+                m_fileCount--;
+            }
+            entry = m_entries.erase(entry);
+        } else {
+            ++entry;
+        }
+    }
+    return true;
+}
+
+void PathIndex::removeHashes(const QString &normalizedPath, const Entry &entry)
+{
+    for (const QString &key : entry.hashes) {
+        auto it = m_hashes.find(key);
+        if (it != m_hashes.end() && it.value() == normalizedPath) {
+            m_hashes.erase(it);
+        }
+    }
+}
+
+void PathIndex::removeLength(qint64 length)
+{
+    auto it = m_lengths.find(length);
+    if (it != m_lengths.end() && --it.value() == 0) {
+        m_lengths.erase(it);
+    }
+}
+
+bool PathIndex::contains(const QString &path) const
+{
+    return m_entries.contains(normalizePath(path));
+}
+
+const PathIndex::Entry *PathIndex::find(const QString &path) const
+{
+    auto it = m_entries.constFind(normalizePath(path));
+    return it == m_entries.constEnd() ? nullptr : &it.value();
+}
+
+QString PathIndex::findByHash(const QString &attributeKey, const QString &hash) const
+{
+    if (attributeKey.isEmpty() || hash.isEmpty()) {
+        return QString();
+    }
+    return m_hashes.value(contentKey(attributeKey, hash));
+}
+
+QString PathIndex::normalizePath(const QString &path)
+{
+    // Fast path: already normalized
+    if (!path.startsWith(QLatin1Char('/')) && !path.endsWith(QLatin1Char('/')) &&
+        !path.contains(QLatin1String("//"))) {
+        return path;
+    }
+
+    return path.split(QLatin1Char('/'), Qt::SkipEmptyParts).join(QLatin1Char('/'));
+}
+
+QString PathIndex::contentKey(const QString &attributeKey, const QString &hash)
+{
+    return attributeKey + QLatin1Char('=') + hash.trimmed().toLower();
+}
+
+} // namespace qltfs
@@ -0,0 +1,161 @@
+/*
+ * QLTOTapeMan - Qt-based LTO Tape Manager
+ * libqltfs - LTFS Core Library
+ *
+ * Copyright (c) 2026 Jeffrey ZHU (zhxsh1225@gmail.com)
+ * https://github.com/Gypsop/QLTOTapeMan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "libqltfs_global.h"
+#include "core/LtfsIndex.h"
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+
+namespace qltfs {
+
+class CompactIndex;
+
+/**
+ * @brief Hash lookup of index entries by full path and by content hash
+ *
+ * Kept next to an LtfsIndex or CompactIndex so write sessions can decide
+ * skip / overwrite per file without walking the directory tree. Paths
+ * are '/'-separated and relative to the root ("" is the root itself);
+ * leading, trailing and repeated separators are ignored.
+ *
+ * Files carrying ltfs.hash.* extended attributes are also indexed by
+ * hash, so content already on tape can be found before a duplicate is
+ * written. Hash values are compared case-insensitively.
+ */
+class LIBQLTFS_EXPORT PathIndex
+{
+public:
+    /**
+     * @brief What is known about an entry
+     */
+    struct Entry {
+        bool directory = false;
+        qint64 length = 0;
+        qint64 modifyTime = 0;      ///< Milliseconds since the Unix epoch (UTC)
+        quint64 uid = 0;
+        QStringList hashes;         ///< Content keys of this file (see contentKey())
+        QList<LtfsExtent> extents;  ///< Data on tape (empty when built from a CompactIndex)
+    };
+
+    PathIndex();
+
+    /**
+     * @brief Rebuild from an index
+     */
+    void build(const LtfsIndex &index);
+    void build(const CompactIndex &index);
+
+    /**
+     * @brief Remove all entries
+     */
+    void clear();
+
+    // === Updates ===
+
+    /**
+     * @brief Add or replace a file, creating entries for its parent directories
+     * @param path Full path of the file
+     * @param file File entry as written to the index
+     */
+    void addFile(const QString &path, const LtfsFile &file);
+
+    /**
+     * @brief Add a file that shares the data of one already indexed
+     *
+     * The new entry reuses the length, extents and hashes of
+     * @p existingPath; LTFS allows several files to reference the same
+     * blocks.
+     *
+     * @param path Full path of the new file
+     * @param existingPath File whose data it shares
+     * @param modifyTime Modification time of the new file (ms since the epoch, UTC)
+     * @return false if @p existingPath is not a file
+     */
+    bool addCopy(const QString &path, const QString &existingPath, qint64 modifyTime);
+
+    /**
+     * @brief Add a directory and its parents
+     */
+    void addDirectory(const QString &path);
+
+    /**
+     * @brief Remove an entry; directories are removed with everything below them
+     * @return true if the entry existed
+     */
+    bool remove(const QString &path);
+
+    // === Lookup ===
+
+    bool contains(const QString &path) const;
+
+    /**
+     * @brief Find an entry
+     * @return Entry, or nullptr if the path is not in the index
+     */
+    const Entry *find(const QString &path) const;
+
+    /**
+     * @brief Find a file with the given content hash
+     * @param attributeKey Hash attribute key (see HashCalculator::attributeKey())
+     * @param hash Hash value as stored in the attribute
+     * @return Path of a matching file, or an empty string
+     */
+    QString findByHash(const QString &attributeKey, const QString &hash) const;
+
+    /**
+     * @brief Whether any file has exactly @p length bytes
+     *
+     * Lets a duplicate check rule out most sources without hashing them.
+     */
+    bool containsLength(qint64 length) const { return m_lengths.contains(length); }
+
+    int fileCount() const { return m_fileCount; }
+    int directoryCount() const { return m_entries.size() - m_fileCount; }
+
+    /**
+     * @brief Normalize a path to the form used as key
+     */
+    static QString normalizePath(const QString &path);
+
+    /**
+     * @brief Key under which a hash attribute is indexed
+     */
+    static QString contentKey(const QString &attributeKey, const QString &hash);
+
+private:
+    void addDirectoryEntries(const QString &normalizedPath);
+    void addFileEntry(const QString &normalizedPath, Entry entry);
+    void removeHashes(const QString &normalizedPath, const Entry &entry);
+    void removeLength(qint64 length);
+    void buildDirectory(const LtfsDirectory &directory, const QString &path);
+
+    QHash<QString, Entry> m_entries;
+    QHash<QString, QString> m_hashes;       ///< Content key to path of a file with that content
+    QHash<qint64, int> m_lengths;           ///< File length to number of files with it
+    int m_fileCount = 0;
+};
+
+} // namespace qltfs
@@ -21,23 +21,23 @@
 
 #include "DeviceEnumerator.h"
 #include "ScsiCommand.h"
+#include "platform/VirtualTape.h"
 
+#include <QDateTime>
 #include <QDir>
 #include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QRegularExpression>
 #include <QTextStream>
+#include <QThreadPool>
+#include <QtConcurrent>
 #include <QDebug>
 
+#include <algorithm>
+
 #ifdef Q_OS_WIN
 #include <windows.h>
-#include <setupapi.h>
-#include <cfgmgr32.h>
-#include <ntddscsi.h>
-#include <initguid.h>
-#include <ntddstor.h>
-// GUID for tape drives
-DEFINE_GUID(GUID_DEVINTERFACE_TAPE, 0x53F5630B, 0xB6BF, 0x11D0, 0x94, 0xF2, 0x00, 0xA0, 0xC9, 0x1E, 0xFB, 0x8B);
-// GUID for medium changers
-DEFINE_GUID(GUID_DEVINTERFACE_MEDIUMCHANGER, 0x53F56310, 0xB6BF, 0x11D0, 0x94, 0xF2, 0x00, 0xA0, 0xC9, 0x1E, 0xFB, 0x8B);
 #elif defined(Q_OS_LINUX)
 #include <dirent.h>
 #include <fcntl.h>
@@ -100,58 +100,181 @@ bool ChangerDeviceInfo::isValid() const
 // DeviceEnumerator Private Implementation
 // ============================================================================
 
+// Most devices queried at once on a refresh
+static constexpr int MAX_PARALLEL_PROBES = 16;
+
 class DeviceEnumerator::Private
 {
 public:
+    /**
+     * @brief How a device node is queried
+     */
+    enum class NodeKind {
+        Tape,           ///< Tape drive node (st, nst, \\.\TapeN)
+        Changer,        ///< Dedicated changer node (sch, \\.\ChangerN)
+        Generic         ///< SCSI generic node; a changer only if INQUIRY says so
+    };
+
+    /**
+     * @brief A device node present on the system
+     */
+    struct Node {
+        QString path;
+        NodeKind kind = NodeKind::Tape;
+        qint64 stamp = 0;           ///< Changes when the node is recreated (0 = not known)
+    };
+
+    /**
+     * @brief What was learned about a node the last time it was queried
+     */
+    struct CachedDevice {
+        qint64 stamp = 0;
+        DeviceType type = DeviceType::Unknown;
+        TapeDeviceInfo tape;
+        ChangerDeviceInfo changer;
+    };
+
     QList<TapeDeviceInfo> tapeDevices;
     QList<ChangerDeviceInfo> changerDevices;
+    QHash<QString, CachedDevice> cache;
     QString lastError;
 
-    bool enumerateTapeDevices();
-    bool enumerateChangerDevices();
-    TapeDeviceInfo queryTapeDeviceInfo(const QString &devicePath, const QString &genericPath = QString());
-    ChangerDeviceInfo queryChangerDeviceInfo(const QString &devicePath);
+    bool update(RefreshMode mode);
+    bool listNodes(QList<Node> &nodes);
+    CachedDevice probe(const Node &node) const;
+    TapeDeviceInfo queryTapeDeviceInfo(const QString &devicePath, const QString &genericPath = QString()) const;
+    ChangerDeviceInfo queryChangerDeviceInfo(const QString &devicePath) const;
 
 #ifdef Q_OS_WIN
-    bool enumerateWindowsDevices(const GUID &interfaceGuid, bool isTape);
-    QString getDevicePropertyString(HDEVINFO devInfo, PSP_DEVINFO_DATA devInfoData, DWORD property);
+    bool listWindowsNodes(QList<Node> &nodes);
 #elif defined(Q_OS_LINUX)
-    bool enumerateLinuxTapeDevices();
-    bool enumerateLinuxChangerDevices();
-    QString readSysfsAttribute(const QString &path);
-    QString findGenericDevice(const QString &tapeDevice);
+    bool listLinuxNodes(QList<Node> &nodes);
+    QString readSysfsAttribute(const QString &path) const;
+    QString findGenericDevice(const QString &tapeDevice) const;
 #endif
 };
 
-bool DeviceEnumerator::Private::enumerateTapeDevices()
+bool DeviceEnumerator::Private::update(RefreshMode mode)
 {
+    QList<Node> nodes;
+    if (!listNodes(nodes)) {
+        return false;
+    }
+
+    // Keep what is known about nodes that are still there; a node that
+    // was recreated under the same name may be a different device
+    QHash<QString, CachedDevice> next;
+    QList<Node> pending;
+    for (const Node &node : nodes) {
+        auto it = cache.constFind(node.path);
+        if (mode == RefreshMode::Incremental && it != cache.constEnd() && it->stamp == node.stamp) {
+            next.insert(node.path, *it);
+        } else {
+            pending.append(node);
+        }
+    }
+
+    // Each query is several SCSI round trips, and the drives answer
+    // independently, so new devices are queried side by side
+    if (!pending.isEmpty()) {
+        QThreadPool pool;
+        pool.setMaxThreadCount(qMin(static_cast<int>(pending.size()), MAX_PARALLEL_PROBES));
+        const QList<CachedDevice> probed = QtConcurrent::blockingMapped<QList<CachedDevice>>(
+            &pool, pending, [this](const Node &node) { return probe(node); });
+        for (int i = 0; i < pending.size(); ++i) {
+            next.insert(pending[i].path, probed[i]);
+        }
+    }
+    cache = next;
+
+    // Report in node order, so the list does not reshuffle between refreshes
     tapeDevices.clear();
+    changerDevices.clear();
+    for (const Node &node : nodes) {
+        const CachedDevice &device = cache[node.path];
+        if (node.kind == NodeKind::Tape) {
+            if (device.type == DeviceType::TapeDrive) {
+                tapeDevices.append(device.tape);
+            }
+            continue;
+        }
 
+        if (device.type != DeviceType::MediumChanger || !device.changer.isValid()) {
+            continue;
+        }
+
+        // A changer may be reachable through both its sch and sg node
+        bool found = false;
+        for (const auto &existing : changerDevices) {
+            if (existing.serialNumber == device.changer.serialNumber &&
+                !device.changer.serialNumber.isEmpty()) {
+                found = true;
+                break;
+            }
+        }
+        if (!found) {
+            changerDevices.append(device.changer);
+        }
+    }
+
+    return true;
+}
+
+bool DeviceEnumerator::Private::listNodes(QList<Node> &nodes)
+{
 #ifdef Q_OS_WIN
-    return enumerateWindowsDevices(GUID_DEVINTERFACE_TAPE, true);
+    return listWindowsNodes(nodes);
 #elif defined(Q_OS_LINUX)
-    return enumerateLinuxTapeDevices();
+    return listLinuxNodes(nodes);
 #else
+    Q_UNUSED(nodes)
     lastError = QStringLiteral("Unsupported platform");
     return false;
 #endif
 }
 
-bool DeviceEnumerator::Private::enumerateChangerDevices()
+DeviceEnumerator::Private::CachedDevice DeviceEnumerator::Private::probe(const Node &node) const
 {
-    changerDevices.clear();
+    CachedDevice device;
+    device.stamp = node.stamp;
 
-#ifdef Q_OS_WIN
-    return enumerateWindowsDevices(GUID_DEVINTERFACE_MEDIUMCHANGER, false);
-#elif defined(Q_OS_LINUX)
-    return enumerateLinuxChangerDevices();
+    switch (node.kind) {
+    case NodeKind::Tape: {
+#ifdef Q_OS_LINUX
+        device.tape = queryTapeDeviceInfo(node.path, findGenericDevice(node.path));
 #else
-    lastError = QStringLiteral("Unsupported platform");
-    return false;
+        device.tape = queryTapeDeviceInfo(node.path);
 #endif
+        device.type = device.tape.type;
+        break;
+    }
+    case NodeKind::Changer:
+        device.changer = queryChangerDeviceInfo(node.path);
+        device.type = DeviceType::MediumChanger;
+        break;
+    case NodeKind::Generic: {
+        // Only the device type; most generic nodes belong to disks and drives
+        ScsiCommand scsi(node.path);
+        if (!scsi.open()) {
+            break;
+        }
+        auto result = scsi.inquiry(false, 0, 36);
+        scsi.close();
+
+        if (result.success && result.data.size() >= 1) {
+            device.type = DeviceEnumerator::scsiDeviceType(static_cast<quint8>(result.data[0]) & 0x1F);
+            if (device.type == DeviceType::MediumChanger) {
+                device.changer = queryChangerDeviceInfo(node.path);
+            }
+        }
+        break;
+    }
+    }
+
+    return device;
 }
 
-TapeDeviceInfo DeviceEnumerator::Private::queryTapeDeviceInfo(const QString &devicePath, const QString &genericPath)
+TapeDeviceInfo DeviceEnumerator::Private::queryTapeDeviceInfo(const QString &devicePath, const QString &genericPath) const
 {
     TapeDeviceInfo info;
     info.devicePath = devicePath;
@@ -199,7 +322,7 @@ TapeDeviceInfo DeviceEnumerator::Private::queryTapeDeviceInfo(const QString &dev
     return info;
 }
 
-ChangerDeviceInfo DeviceEnumerator::Private::queryChangerDeviceInfo(const QString &devicePath)
+ChangerDeviceInfo DeviceEnumerator::Private::queryChangerDeviceInfo(const QString &devicePath) const
 {
     ChangerDeviceInfo info;
     info.devicePath = devicePath;
@@ -234,25 +357,17 @@ ChangerDeviceInfo DeviceEnumerator::Private::queryChangerDeviceInfo(const QStrin
 
     // Get element status via Mode Sense (Element Address Assignment page 0x1D)
     result = scsi.modeSense10(0x1D, 0, 256);
-    if (result.success && result.data.size() >= 24) {
-        // Parse element counts from mode page
-        // Format varies by vendor, this is a simplified parse
+    if (result.success && result.data.size() >= 8) {
         const quint8 *data = reinterpret_cast<const quint8 *>(result.data.constData());
 
-        // Skip mode parameter header (8 bytes for mode sense 10)
-        int offset = 8;
-        if (static_cast<int>(result.data.size()) > offset + 18) {
-            // Medium transport (robot) first element address and count
-            info.mediumTransportElements = (data[offset + 2] << 8) | data[offset + 3];
-
-            // Storage elements
-            info.storageElements = (data[offset + 6] << 8) | data[offset + 7];
-
-            // Import/Export elements
-            info.importExportElements = (data[offset + 10] << 8) | data[offset + 11];
-
-            // Data transfer (drive) elements
-            info.dataTransferElements = (data[offset + 14] << 8) | data[offset + 15];
+        // Skip mode parameter header (8 bytes for mode sense 10) and block descriptors
+        int offset = 8 + ((data[6] << 8) | data[7]);
+        if (static_cast<int>(result.data.size()) >= offset + 18 && (data[offset] & 0x3F) == 0x1D) {
+            // Each element type is a first address followed by a count
+            info.mediumTransportElements = (data[offset + 4] << 8) | data[offset + 5];
+            info.storageElements = (data[offset + 8] << 8) | data[offset + 9];
+            info.importExportElements = (data[offset + 12] << 8) | data[offset + 13];
+            info.dataTransferElements = (data[offset + 16] << 8) | data[offset + 17];
         }
     }
 
@@ -262,264 +377,99 @@ ChangerDeviceInfo DeviceEnumerator::Private::queryChangerDeviceInfo(const QStrin
 
 #ifdef Q_OS_WIN
 
-bool DeviceEnumerator::Private::enumerateWindowsDevices(const GUID &interfaceGuid, bool isTape)
+bool DeviceEnumerator::Private::listWindowsNodes(QList<Node> &nodes)
 {
-    HDEVINFO devInfo = SetupDiGetClassDevsW(
-        &interfaceGuid,
-        nullptr,
-        nullptr,
-        DIGCF_PRESENT | DIGCF_DEVICEINTERFACE
-    );
-
-    if (devInfo == INVALID_HANDLE_VALUE) {
-        lastError = QStringLiteral("SetupDiGetClassDevs failed: %1").arg(GetLastError());
-        return false;
+    // The DOS device names list every TapeN and ChangerN without opening
+    // them, so drives in use by another application are not disturbed
+    QVector<wchar_t> buffer(16384);
+    while (QueryDosDeviceW(nullptr, buffer.data(), static_cast<DWORD>(buffer.size())) == 0) {
+        if (GetLastError() != ERROR_INSUFFICIENT_BUFFER) {
+            lastError = QStringLiteral("QueryDosDevice failed: %1").arg(GetLastError());
+            return false;
+        }
+        buffer.resize(buffer.size() * 2);
     }
 
-    SP_DEVICE_INTERFACE_DATA interfaceData;
-    interfaceData.cbSize = sizeof(SP_DEVICE_INTERFACE_DATA);
+    static const QRegularExpression tapeRx(QStringLiteral("^Tape(\\d+)$"), QRegularExpression::CaseInsensitiveOption);
+    static const QRegularExpression changerRx(QStringLiteral("^Changer(\\d+)$"), QRegularExpression::CaseInsensitiveOption);
 
-    for (DWORD i = 0; SetupDiEnumDeviceInterfaces(devInfo, nullptr, &interfaceGuid, i, &interfaceData); ++i) {
-        // Get required buffer size
-        DWORD requiredSize = 0;
-        SetupDiGetDeviceInterfaceDetailW(devInfo, &interfaceData, nullptr, 0, &requiredSize, nullptr);
+    QList<QPair<int, Node>> tapes;
+    QList<QPair<int, Node>> changers;
+    for (const wchar_t *name = buffer.constData(); *name; name += wcslen(name) + 1) {
+        const QString dosName = QString::fromWCharArray(name);
+        Node node;
+        node.path = QStringLiteral("\\\\.\\") + dosName;
 
-        if (requiredSize == 0) {
+        QRegularExpressionMatch match = tapeRx.match(dosName);
+        if (match.hasMatch()) {
+            node.kind = NodeKind::Tape;
+            tapes.append(qMakePair(match.captured(1).toInt(), node));
             continue;
         }
-
-        // Allocate buffer
-        auto *detailData = static_cast<PSP_DEVICE_INTERFACE_DETAIL_DATA_W>(malloc(requiredSize));
-        if (!detailData) {
-            continue;
-        }
-
-        detailData->cbSize = sizeof(SP_DEVICE_INTERFACE_DETAIL_DATA_W);
-
-        SP_DEVINFO_DATA devInfoData;
-        devInfoData.cbSize = sizeof(SP_DEVINFO_DATA);
-
-        if (SetupDiGetDeviceInterfaceDetailW(devInfo, &interfaceData, detailData, requiredSize, nullptr, &devInfoData)) {
-            QString devicePath = QString::fromWCharArray(detailData->DevicePath);
-
-            if (isTape) {
-                // Convert interface path to tape device path
-                // Interface path: \\?\scsi#sequential...
-                // We need: \\.\Tape0, \\.\Tape1, etc.
-
-                // Try to find the tape number from registry or iterate
-                for (int tapeNum = 0; tapeNum < 16; ++tapeNum) {
-                    QString tapePath = QStringLiteral("\\\\.\\Tape%1").arg(tapeNum);
-
-                    // Check if this tape device exists and matches
-                    HANDLE hTest = CreateFileW(
-                        reinterpret_cast<LPCWSTR>(tapePath.utf16()),
-                        GENERIC_READ,
-                        FILE_SHARE_READ | FILE_SHARE_WRITE,
-                        nullptr,
-                        OPEN_EXISTING,
-                        0,
-                        nullptr
-                    );
-
-                    if (hTest != INVALID_HANDLE_VALUE) {
-                        CloseHandle(hTest);
-
-                        // Query this device
-                        TapeDeviceInfo info = queryTapeDeviceInfo(tapePath);
-                        if (info.type == DeviceType::TapeDrive) {
-                            // Check if we already have this device
-                            bool found = false;
-                            for (const auto &existing : tapeDevices) {
-                                if (existing.devicePath == info.devicePath) {
-                                    found = true;
-                                    break;
-                                }
-                            }
-                            if (!found) {
-                                tapeDevices.append(info);
-                            }
-                        }
-                    }
-                }
-            } else {
-                // Medium changer
-                // Try changer device paths
-                for (int changerNum = 0; changerNum < 16; ++changerNum) {
-                    QString changerPath = QStringLiteral("\\\\.\\Changer%1").arg(changerNum);
-
-                    HANDLE hTest = CreateFileW(
-                        reinterpret_cast<LPCWSTR>(changerPath.utf16()),
-                        GENERIC_READ,
-                        FILE_SHARE_READ | FILE_SHARE_WRITE,
-                        nullptr,
-                        OPEN_EXISTING,
-                        0,
-                        nullptr
-                    );
-
-                    if (hTest != INVALID_HANDLE_VALUE) {
-                        CloseHandle(hTest);
-
-                        ChangerDeviceInfo info = queryChangerDeviceInfo(changerPath);
-                        if (info.isValid()) {
-                            bool found = false;
-                            for (const auto &existing : changerDevices) {
-                                if (existing.devicePath == info.devicePath) {
-                                    found = true;
-                                    break;
-                                }
-                            }
-                            if (!found) {
-                                changerDevices.append(info);
-                            }
-                        }
-                    }
-                }
-            }
+        match = changerRx.match(dosName);
+        if (match.hasMatch()) {
+            node.kind = NodeKind::Changer;
+            changers.append(qMakePair(match.captured(1).toInt(), node));
         }
-
-        free(detailData);
     }
 
-    SetupDiDestroyDeviceInfoList(devInfo);
-    return true;
-}
-
-QString DeviceEnumerator::Private::getDevicePropertyString(HDEVINFO devInfo, PSP_DEVINFO_DATA devInfoData, DWORD property)
-{
-    DWORD requiredSize = 0;
-    SetupDiGetDeviceRegistryPropertyW(devInfo, devInfoData, property, nullptr, nullptr, 0, &requiredSize);
-
-    if (requiredSize == 0) {
-        return QString();
+    auto byNumber = [](const QPair<int, Node> &a, const QPair<int, Node> &b) { return a.first < b.first; };
+    std::sort(tapes.begin(), tapes.end(), byNumber);
+    std::sort(changers.begin(), changers.end(), byNumber);
+    for (const auto &tape : tapes) {
+        nodes.append(tape.second);
     }
-
-    QByteArray buffer(static_cast<int>(requiredSize), 0);
-    if (SetupDiGetDeviceRegistryPropertyW(devInfo, devInfoData, property, nullptr,
-                                          reinterpret_cast<PBYTE>(buffer.data()), requiredSize, nullptr)) {
-        return QString::fromWCharArray(reinterpret_cast<LPCWSTR>(buffer.constData()));
+    for (const auto &changer : changers) {
+        nodes.append(changer.second);
     }
-
-    return QString();
+    return true;
 }
 
 #elif defined(Q_OS_LINUX)
 
-bool DeviceEnumerator::Private::enumerateLinuxTapeDevices()
+bool DeviceEnumerator::Private::listLinuxNodes(QList<Node> &nodes)
 {
-    // Enumerate /dev/st* and /dev/nst* devices
     QDir devDir(QStringLiteral("/dev"));
 
+    // The inode is new when udev recreates a node for a replaced device
+    auto makeNode = [](const QString &name, NodeKind kind) {
+        Node node;
+        node.path = QStringLiteral("/dev/") + name;
+        node.kind = kind;
+        const QDateTime changed = QFileInfo(node.path).metadataChangeTime();
+        node.stamp = changed.isValid() ? changed.toMSecsSinceEpoch() : 0;
+        return node;
+    };
+
+    // Enumerate /dev/st* and /dev/nst* devices, preferring the
+    // non-rewind nst* node of each drive
     QStringList filters;
     filters << QStringLiteral("st[0-9]*") << QStringLiteral("nst[0-9]*");
-
-    QStringList devices = devDir.entryList(filters, QDir::System);
-
-    // Prefer non-rewind devices (nst*)
-    QStringList nstDevices;
-    QStringList stDevices;
+    const QStringList devices = devDir.entryList(filters, QDir::System);
 
     for (const QString &dev : devices) {
         if (dev.startsWith(QLatin1String("nst"))) {
-            nstDevices.append(dev);
-        } else {
-            stDevices.append(dev);
+            nodes.append(makeNode(dev, NodeKind::Tape));
         }
     }
-
-    // Process non-rewind devices first
-    for (const QString &dev : nstDevices) {
-        QString devicePath = QStringLiteral("/dev/") + dev;
-        QString genericPath = findGenericDevice(devicePath);
-
-        TapeDeviceInfo info = queryTapeDeviceInfo(devicePath, genericPath);
-        if (info.type == DeviceType::TapeDrive) {
-            tapeDevices.append(info);
-        }
-    }
-
-    // Add rewind devices if no corresponding non-rewind found
-    for (const QString &dev : stDevices) {
-        QString devicePath = QStringLiteral("/dev/") + dev;
-
-        // Check if we already have the non-rewind version
-        QString nstDev = QStringLiteral("/dev/n") + dev;
-        bool hasNst = false;
-        for (const auto &existing : tapeDevices) {
-            if (existing.devicePath == nstDev) {
-                hasNst = true;
-                break;
-            }
-        }
-
-        if (!hasNst) {
-            QString genericPath = findGenericDevice(devicePath);
-            TapeDeviceInfo info = queryTapeDeviceInfo(devicePath, genericPath);
-            if (info.type == DeviceType::TapeDrive) {
-                tapeDevices.append(info);
-            }
+    for (const QString &dev : devices) {
+        if (dev.startsWith(QLatin1String("st")) && !devices.contains(QStringLiteral("n") + dev)) {
+            nodes.append(makeNode(dev, NodeKind::Tape));
         }
     }
 
-    return true;
-}
-
-bool DeviceEnumerator::Private::enumerateLinuxChangerDevices()
-{
-    // Enumerate /dev/sch* or /dev/sg* devices that are changers
-    QDir devDir(QStringLiteral("/dev"));
-
-    // First try /dev/sch* (dedicated changer devices)
-    QStringList schDevices = devDir.entryList(QStringList() << QStringLiteral("sch[0-9]*"), QDir::System);
-    for (const QString &dev : schDevices) {
-        QString devicePath = QStringLiteral("/dev/") + dev;
-        ChangerDeviceInfo info = queryChangerDeviceInfo(devicePath);
-        if (info.isValid()) {
-            changerDevices.append(info);
-        }
+    // Dedicated changer nodes first, then generic nodes that may be changers
+    for (const QString &dev : devDir.entryList(QStringList() << QStringLiteral("sch[0-9]*"), QDir::System)) {
+        nodes.append(makeNode(dev, NodeKind::Changer));
     }
-
-    // Also check /dev/sg* devices for changers
-    QStringList sgDevices = devDir.entryList(QStringList() << QStringLiteral("sg[0-9]*"), QDir::System);
-    for (const QString &dev : sgDevices) {
-        QString devicePath = QStringLiteral("/dev/") + dev;
-
-        // Query device type
-        ScsiCommand scsi(devicePath);
-        if (!scsi.open()) {
-            continue;
-        }
-
-        auto result = scsi.inquiry(false, 0, 36);
-        scsi.close();
-
-        if (result.success && result.data.size() >= 1) {
-            quint8 deviceType = static_cast<quint8>(result.data[0]) & 0x1F;
-            if (deviceType == SCSI_TYPE_CHANGER) {
-                ChangerDeviceInfo info = queryChangerDeviceInfo(devicePath);
-                if (info.isValid()) {
-                    // Check if already found via sch*
-                    bool found = false;
-                    for (const auto &existing : changerDevices) {
-                        if (existing.serialNumber == info.serialNumber &&
-                            !info.serialNumber.isEmpty()) {
-                            found = true;
-                            break;
-                        }
-                    }
-                    if (!found) {
-                        changerDevices.append(info);
-                    }
-                }
-            }
-        }
+    for (const QString &dev : devDir.entryList(QStringList() << QStringLiteral("sg[0-9]*"), QDir::System)) {
+        nodes.append(makeNode(dev, NodeKind::Generic));
     }
 
     return true;
 }
 
-QString DeviceEnumerator::Private::readSysfsAttribute(const QString &path)
+QString DeviceEnumerator::Private::readSysfsAttribute(const QString &path) const
 {
     QFile file(path);
     if (file.open(QIODevice::ReadOnly | QIODevice::Text)) {
@@ -528,7 +478,7 @@ QString DeviceEnumerator::Private::readSysfsAttribute(const QString &path)
     return QString();
 }
 
-QString DeviceEnumerator::Private::findGenericDevice(const QString &tapeDevice)
+QString DeviceEnumerator::Private::findGenericDevice(const QString &tapeDevice) const
 {
     // Find the corresponding /dev/sg* device for a tape device
     // This is done by matching the SCSI host:channel:id:lun
@@ -599,14 +549,10 @@ DeviceEnumerator::~DeviceEnumerator()
     delete d;
 }
 
-bool DeviceEnumerator::refresh()
+bool DeviceEnumerator::refresh(RefreshMode mode)
 {
     d->lastError.clear();
-
-    bool tapeOk = d->enumerateTapeDevices();
-    bool changerOk = d->enumerateChangerDevices();
-
-    return tapeOk && changerOk;
+    return d->update(mode);
 }
 
 QList<TapeDeviceInfo> DeviceEnumerator::tapeDevices() const
@@ -710,6 +656,10 @@ QString DeviceEnumerator::deviceTypeName(DeviceType type)
 
 bool DeviceEnumerator::isValidTapeDevicePath(const QString &path)
 {
+    if (VirtualTape::isVirtualPath(path)) {
+        return true;
+    }
+
 #ifdef Q_OS_WIN
     // Windows: \\.\Tape0, \\.\Tape1, etc.
     static QRegularExpression rx(QStringLiteral("^\\\\\\\\.\\\\Tape\\d+$"));
@@ -67,7 +67,7 @@ struct LIBQLTFS_EXPORT TapeDeviceInfo {
     QString revision;           ///< Firmware revision
     QString serialNumber;       ///< Device serial number
     DeviceType type = DeviceType::Unknown;
-    bool isReady = false;       ///< Device has media and is ready
+    bool isReady = false;       ///< Device had media and was ready when first queried
 
     /**
      * @brief Get display name for this device
@@ -109,13 +109,27 @@ struct LIBQLTFS_EXPORT ChangerDeviceInfo {
  * @brief Enumerates tape drives and medium changers on the system
  *
  * Platform-independent interface for discovering tape devices.
- * Uses platform-specific APIs:
- * - Windows: SetupAPI device enumeration
- * - Linux: /sys/class/scsi_tape, /sys/class/scsi_changer enumeration
+ * Lists the device nodes with platform-specific APIs:
+ * - Windows: TapeN / ChangerN DOS device names
+ * - Linux: /dev/st*, /dev/nst*, /dev/sch* and /dev/sg* nodes
+ *
+ * Keeps a registry of what each node answered: a refresh only lists
+ * the nodes, which is cheap, and sends INQUIRY only to nodes it has not
+ * seen before, in parallel. Drives already known, possibly busy with
+ * another application, are left alone. Pair with DeviceMonitor to
+ * refresh when devices come and go instead of on a timer.
  */
 class LIBQLTFS_EXPORT DeviceEnumerator
 {
 public:
+    /**
+     * @brief How much of the registry a refresh rebuilds
+     */
+    enum class RefreshMode {
+        Incremental,    ///< Query only nodes not seen before (or recreated since)
+        Full            ///< Query every node again
+    };
+
     DeviceEnumerator();
     ~DeviceEnumerator();
 
@@ -126,12 +140,14 @@ public:
     /**
      * @brief Refresh device list
      *
-     * Scans the system for tape drives and medium changers.
-     * This operation may take a few seconds.
+     * Scans the system for tape drives and medium changers. Devices no
+     * longer present are dropped; a full refresh may take a few seconds
+     * on hosts with many drives.
      *
+     * @param mode Query new nodes only, or all of them
      * @return true if enumeration succeeded
      */
-    bool refresh();
+    bool refresh(RefreshMode mode = RefreshMode::Incremental);
 
     /**
      * @brief Get list of detected tape drives
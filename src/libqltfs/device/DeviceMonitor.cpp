@@ -0,0 +1,278 @@
+/*
+ * QLTOTapeMan - Qt-based LTO Tape Manager
+ * libqltfs - LTFS Core Library
+ *
+ * Copyright (c) 2026 Jeffrey ZHU (zhxsh1225@gmail.com)
+ * https://github.com/Gypsop/QLTOTapeMan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "DeviceMonitor.h"
+
+#include <QScopedPointer>
+#include <QTimer>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#include <cfgmgr32.h>
+#include <initguid.h>
+#include <ntddstor.h>
+#elif defined(Q_OS_LINUX)
+#include <QSocketNotifier>
+
+#include <cerrno>
+#include <cstring>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <linux/netlink.h>
+#endif
+
+namespace qltfs {
+
+// Quiet time after the last event before devicesChanged() is emitted
+static constexpr int SETTLE_MS = 500;
+
+// ============================================================================
+// DeviceMonitor Private Implementation
+// ============================================================================
+
+class DeviceMonitor::Private
+{
+public:
+    explicit Private(DeviceMonitor *q)
+        : q(q)
+    {
+        settleTimer.setSingleShot(true);
+        settleTimer.setInterval(SETTLE_MS);
+        QObject::connect(&settleTimer, &QTimer::timeout, q, &DeviceMonitor::devicesChanged);
+    }
+
+    DeviceMonitor *q;
+    QTimer settleTimer;
+    QString lastError;
+    bool active = false;
+
+    /**
+     * @brief Note an event; restarts the settle time
+     */
+    void schedule()
+    {
+        settleTimer.start();
+    }
+
+#ifdef Q_OS_WIN
+    HCMNOTIFICATION tapeNotification = nullptr;
+    HCMNOTIFICATION changerNotification = nullptr;
+
+    bool registerInterface(const GUID &guid, HCMNOTIFICATION &handle);
+    static DWORD CALLBACK notify(HCMNOTIFICATION notification, PVOID context, CM_NOTIFY_ACTION action,
+                                 PCM_NOTIFY_EVENT_DATA eventData, DWORD eventDataSize);
+#elif defined(Q_OS_LINUX)
+    int socket = -1;
+    QScopedPointer<QSocketNotifier> notifier;
+
+    void readEvents();
+    static bool isDeviceEvent(const char *message, ssize_t length);
+#endif
+};
+
+#ifdef Q_OS_WIN
+
+bool DeviceMonitor::Private::registerInterface(const GUID &guid, HCMNOTIFICATION &handle)
+{
+    CM_NOTIFY_FILTER filter = {};
+    filter.cbSize = sizeof(filter);
+    filter.FilterType = CM_NOTIFY_FILTER_TYPE_DEVICEINTERFACE;
+    filter.u.DeviceInterface.ClassGuid = guid;
+
+    CONFIGRET result = CM_Register_Notification(&filter, this, &Private::notify, &handle);
+    if (result != CR_SUCCESS) {
+        handle = nullptr;
+        lastError = QStringLiteral("CM_Register_Notification failed: %1").arg(result);
+        return false;
+    }
+    return true;
+}
+
+DWORD CALLBACK DeviceMonitor::Private::notify(HCMNOTIFICATION notification, PVOID context,
+                                            CM_NOTIFY_ACTION action, PCM_NOTIFY_EVENT_DATA eventData,
+                                            DWORD eventDataSize)
+{
+    Q_UNUSED(notification)
+    Q_UNUSED(eventData)
+    Q_UNUSED(eventDataSize)
+
+    if (action != CM_NOTIFY_ACTION_DEVICEINTERFACEARRIVAL &&
+        action != CM_NOTIFY_ACTION_DEVICEINTERFACEREMOVAL) {
+        return ERROR_SUCCESS;
+    }
+
+    // Runs on a system thread pool thread; the timer lives on the
+    // monitor's thread. stop() unregisters, which waits for callbacks
+    // in progress, before Private goes away.
+    auto *d = static_cast<Private *>(context);
+    QMetaObject::invokeMethod(d->q, [d]() { d->schedule(); }, Qt::QueuedConnection);
+    return ERROR_SUCCESS;
+}
+
+#elif defined(Q_OS_LINUX)
+
+void DeviceMonitor::Private::readEvents()
+{
+    // One datagram per uevent: "ACTION@DEVPATH\0KEY=VALUE\0..."
+    char buffer[8192];
+    bool relevant = false;
+    for (;;) {
+        ssize_t length = ::recv(socket, buffer, sizeof(buffer) - 1, MSG_DONTWAIT);
+        if (length < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == ENOBUFS) {
+                // Events were dropped; assume one of them was ours
+                relevant = true;
+                continue;
+            }
+            break;
+        }
+        if (length == 0) {
+            break;
+        }
+        buffer[length] = '\0';
+        relevant = relevant || isDeviceEvent(buffer, length);
+    }
+
+    if (relevant) {
+        schedule();
+    }
+}
+
+bool DeviceMonitor::Private::isDeviceEvent(const char *message, ssize_t length)
+{
+    // Attribute changes (media loads, bind/unbind) do not alter the device list
+    if (std::strncmp(message, "add@", 4) != 0 && std::strncmp(message, "remove@", 7) != 0) {
+        return false;
+    }
+
+    const char *end = message + length;
+
+    for (const char *field = message + std::strlen(message) + 1; field < end;
+         field += std::strlen(field) + 1) {
+        if (std::strncmp(field, "SUBSYSTEM=", 10) == 0) {
+            const char *subsystem = field + 10;
+            return std::strcmp(subsystem, "scsi_tape") == 0 ||
+                   std::strcmp(subsystem, "scsi_changer") == 0 ||
+                   std::strcmp(subsystem, "scsi_generic") == 0;
+        }
+    }
+    return false;
+}
+
+#endif
+
+// ============================================================================
+// DeviceMonitor Implementation
+// ============================================================================
+
+DeviceMonitor::DeviceMonitor(QObject *parent)
+    : QObject(parent)
+    , d(new Private(this))
+{
+}
+
+DeviceMonitor::~DeviceMonitor()
+{
+    stop();
+    delete d;
+}
+
+bool DeviceMonitor::start()
+{
+    if (d->active) {
+        return true;
+    }
+    d->lastError.clear();
+
+#ifdef Q_OS_WIN
+    if (!d->registerInterface(GUID_DEVINTERFACE_TAPE, d->tapeNotification) ||
+        !d->registerInterface(GUID_DEVINTERFACE_MEDIUMCHANGER, d->changerNotification)) {
+        stop();
+        return false;
+    }
+    d->active = true;
+    return true;
+#elif defined(Q_OS_LINUX)
+    d->socket = ::socket(AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, NETLINK_KOBJECT_UEVENT);
+    if (d->socket < 0) {
+        d->lastError = QStringLiteral("Cannot open uevent socket: %1").arg(QString::fromLocal8Bit(std::strerror(errno)));
+        return false;
+    }
+
+    // Kernel uevents (group 1); arrive without udevd, the settle time
+    // covers the device node being created after the event
+    sockaddr_nl address = {};
+    address.nl_family = AF_NETLINK;
+    address.nl_groups = 1;
+    if (::bind(d->socket, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0) {
+        d->lastError = QStringLiteral("Cannot bind uevent socket: %1").arg(QString::fromLocal8Bit(std::strerror(errno)));
+        ::close(d->socket);
+        d->socket = -1;
+        return false;
+    }
+
+    d->notifier.reset(new QSocketNotifier(d->socket, QSocketNotifier::Read));
+    connect(d->notifier.data(), &QSocketNotifier::activated, this, [this]() { d->readEvents(); });
+    d->active = true;
+    return true;
+#else
+    d->lastError = QStringLiteral("Unsupported platform");
+    return false;
+#endif
+}
+
+void DeviceMonitor::stop()
+{
+#ifdef Q_OS_WIN
+    if (d->tapeNotification) {
+        CM_Unregister_Notification(d->tapeNotification);
+        d->tapeNotification = nullptr;
+    }
+    if (d->changerNotification) {
+        CM_Unregister_Notification(d->changerNotification);
+        d->changerNotification = nullptr;
+    }
+#elif defined(Q_OS_LINUX)
+    d->notifier.reset();
+    if (d->socket >= 0) {
+        ::close(d->socket);
+        d->socket = -1;
+    }
+#endif
+
+    d->settleTimer.stop();
+    d->active = false;
+}
+
+bool DeviceMonitor::isActive() const
+{
+    return d->active;
+}
+
+QString DeviceMonitor::lastError() const
+{
+    return d->lastError;
+}
+
+} // namespace qltfs
@@ -0,0 +1,90 @@
+/*
+ * QLTOTapeMan - Qt-based LTO Tape Manager
+ * libqltfs - LTFS Core Library
+ *
+ * Copyright (c) 2026 Jeffrey ZHU (zhxsh1225@gmail.com)
+ * https://github.com/Gypsop/QLTOTapeMan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "libqltfs_global.h"
+
+#include <QObject>
+#include <QString>
+
+namespace qltfs {
+
+/**
+ * @brief Watches the system for tape drives and changers coming and going
+ *
+ * Listens for hotplug notifications instead of polling:
+ * - Linux: kernel uevents on a NETLINK_KOBJECT_UEVENT socket, filtered to
+ *   the scsi_tape, scsi_changer and scsi_generic subsystems
+ * - Windows: CM_Register_Notification for the tape and medium changer
+ *   device interface classes
+ *
+ * Bursts of events (a library powering up announces every drive at
+ * once) are coalesced into one devicesChanged() after a short settle
+ * time, which also gives the system time to create the device nodes.
+ * Connect it to DeviceEnumerator::refresh(); only new devices are
+ * queried.
+ */
+class LIBQLTFS_EXPORT DeviceMonitor : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit DeviceMonitor(QObject *parent = nullptr);
+    ~DeviceMonitor() override;
+
+    // Disable copy
+    DeviceMonitor(const DeviceMonitor &) = delete;
+    DeviceMonitor &operator=(const DeviceMonitor &) = delete;
+
+    /**
+     * @brief Start listening
+     * @return false if notifications are not available; poll instead
+     */
+    bool start();
+
+    /**
+     * @brief Stop listening
+     */
+    void stop();
+
+    /**
+     * @brief Check if notifications are being received
+     */
+    bool isActive() const;
+
+    /**
+     * @brief Get last error message
+     */
+    QString lastError() const;
+
+signals:
+    /**
+     * @brief Emitted once a burst of device arrivals or removals has settled
+     */
+    void devicesChanged();
+
+private:
+    class Private;
+    Private *d;
+};
+
+} // namespace qltfs
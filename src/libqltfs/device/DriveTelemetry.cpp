@@ -0,0 +1,228 @@
+/*
+ * QLTOTapeMan - Qt-based LTO Tape Manager
+ * libqltfs - LTFS Core Library
+ *
+ * Copyright (c) 2026 Jeffrey ZHU (zhxsh1225@gmail.com)
+ * https://github.com/Gypsop/QLTOTapeMan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "DriveTelemetry.h"
+
+#include <QElapsedTimer>
+#include <QHash>
+
+namespace qltfs {
+
+// Log page codes
+static constexpr quint8 LOG_PAGE_DATA_COMPRESSION = 0x1B;
+
+// ============================================================================
+// DriveTelemetrySample Implementation
+// ============================================================================
+
+bool DriveTelemetrySample::isStreaming() const
+{
+    return driveBufferObjects > 0 || driveBufferBytes > 0;
+}
+
+// ============================================================================
+// DriveTelemetry Private Implementation
+// ============================================================================
+
+class DriveTelemetry::Private
+{
+public:
+    TapeDevice *device = nullptr;
+    int intervalMs = 0;
+    quint64 driveBufferSize = 0;
+    int historySize = 600;
+
+    quint8 vendorPage = 0;
+    quint16 speedMatchParameter = 0;
+    quint16 backhitchParameter = 0;
+
+    QElapsedTimer clock;            ///< Started by reset()
+    QElapsedTimer sinceSample;
+    bool haveBaseline = false;
+    qint64 baselineMs = 0;
+    quint64 hostBytes = 0;          ///< Counters at the previous sample
+    quint64 tapeBytes = 0;
+    qint64 backhitchBase = -1;
+
+    DriveTelemetrySample last;
+    QList<DriveTelemetrySample> history;
+};
+
+// ============================================================================
+// DriveTelemetry Implementation
+// ============================================================================
+
+DriveTelemetry::DriveTelemetry(TapeDevice *device)
+    : d(new Private)
+{
+    d->device = device;
+    reset();
+}
+
+DriveTelemetry::~DriveTelemetry()
+{
+    delete d;
+}
+
+void DriveTelemetry::setInterval(int ms)
+{
+    d->intervalMs = qMax(0, ms);
+}
+
+int DriveTelemetry::interval() const
+{
+    return d->intervalMs;
+}
+
+void DriveTelemetry::setDriveBufferSize(quint64 bytes)
+{
+    d->driveBufferSize = bytes;
+}
+
+quint64 DriveTelemetry::driveBufferSize() const
+{
+    return d->driveBufferSize;
+}
+
+void DriveTelemetry::setVendorCounters(quint8 pageCode, quint16 speedMatchParameter, quint16 backhitchParameter)
+{
+    d->vendorPage = pageCode;
+    d->speedMatchParameter = speedMatchParameter;
+    d->backhitchParameter = backhitchParameter;
+}
+
+void DriveTelemetry::setHistorySize(int samples)
+{
+    d->historySize = qMax(1, samples);
+    while (d->history.size() > d->historySize) {
+        d->history.removeFirst();
+    }
+}
+
+void DriveTelemetry::reset()
+{
+    d->clock.start();
+    d->sinceSample.invalidate();
+    d->haveBaseline = false;
+    d->backhitchBase = -1;
+    d->last = DriveTelemetrySample();
+    d->history.clear();
+}
+
+bool DriveTelemetry::isDue() const
+{
+    if (d->intervalMs <= 0) {
+        return false;
+    }
+    return !d->sinceSample.isValid() || d->sinceSample.elapsed() >= d->intervalMs;
+}
+
+bool DriveTelemetry::sample()
+{
+    d->sinceSample.start();
+    if (!d->device || !d->device->isOpen()) {
+        return false;
+    }
+
+    DriveTelemetrySample sample;
+    sample.elapsedMs = d->clock.elapsed();
+    sample.driveBufferEmpty = d->last.driveBufferEmpty;
+
+    // Host and tape byte counters; each is whole MiB plus remaining bytes
+    QHash<quint16, quint64> counters;
+    const bool haveCounters = d->device->readLogParameters(LOG_PAGE_DATA_COMPRESSION, counters);
+    const quint64 hostBytes = counters.value(0x0006) * 1024 * 1024 + counters.value(0x0007);
+    const quint64 tapeBytes = counters.value(0x0008) * 1024 * 1024 + counters.value(0x0009);
+
+    TapeBufferStatus buffer;
+    const bool haveBuffer = d->device->readBufferStatus(buffer);
+    if (haveBuffer) {
+        sample.driveBufferBytes = buffer.bytes;
+        sample.driveBufferObjects = buffer.objects;
+        if (d->driveBufferSize > 0) {
+            sample.driveBufferFillPercent = static_cast<int>(qMin<quint64>(100, buffer.bytes * 100 / d->driveBufferSize));
+        }
+    }
+
+    if (d->vendorPage != 0) {
+        QHash<quint16, quint64> vendor;
+        if (d->device->readLogParameters(d->vendorPage, vendor)) {
+            if (vendor.contains(d->speedMatchParameter)) {
+                sample.speedMatchRate = static_cast<qint64>(vendor.value(d->speedMatchParameter));
+            }
+            if (vendor.contains(d->backhitchParameter)) {
+                const qint64 count = static_cast<qint64>(vendor.value(d->backhitchParameter));
+                if (d->backhitchBase < 0 || count < d->backhitchBase) {
+                    d->backhitchBase = count;
+                }
+                sample.backhitches = count - d->backhitchBase;
+            }
+        }
+    }
+
+    if (!haveCounters && !haveBuffer) {
+        return false;
+    }
+
+    if (haveCounters && d->haveBaseline && hostBytes >= d->hostBytes && tapeBytes >= d->tapeBytes) {
+        const qint64 ms = sample.elapsedMs - d->baselineMs;
+        const quint64 host = hostBytes - d->hostBytes;
+        const quint64 tape = tapeBytes - d->tapeBytes;
+        if (ms > 0) {
+            sample.hostBytesPerSecond = host * 1000.0 / ms;
+            sample.tapeBytesPerSecond = tape * 1000.0 / ms;
+        }
+        if (host > 0 && tape > 0) {
+            sample.compressionRatio = static_cast<double>(host) / static_cast<double>(tape);
+        }
+
+        // Data arrived, yet none was waiting: the drive ran dry and had to stop
+        if (haveBuffer && host > 0 && !sample.isStreaming()) {
+            sample.driveBufferEmpty++;
+        }
+    }
+
+    if (haveCounters) {
+        d->haveBaseline = true;
+        d->baselineMs = sample.elapsedMs;
+        d->hostBytes = hostBytes;
+        d->tapeBytes = tapeBytes;
+    }
+
+    d->last = sample;
+    d->history.append(sample);
+    if (d->history.size() > d->historySize) {
+        d->history.removeFirst();
+    }
+    return true;
+}
+
+DriveTelemetrySample DriveTelemetry::last() const
+{
+    return d->last;
+}
+
+QList<DriveTelemetrySample> DriveTelemetry::history() const
+{
+    return d->history;
+}
+
+} // namespace qltfs
@@ -0,0 +1,139 @@
+/*
+ * QLTOTapeMan - Qt-based LTO Tape Manager
+ * libqltfs - LTFS Core Library
+ *
+ * Copyright (c) 2026 Jeffrey ZHU (zhxsh1225@gmail.com)
+ * https://github.com/Gypsop/QLTOTapeMan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "libqltfs_global.h"
+#include "device/TapeDevice.h"
+
+#include <QList>
+
+namespace qltfs {
+
+/**
+ * @brief One telemetry reading taken during a transfer
+ *
+ * Rates are averages since the previous sample. Fields that the drive
+ * could not supply keep their "unknown" value.
+ */
+struct LIBQLTFS_EXPORT DriveTelemetrySample {
+    qint64 elapsedMs = 0;               ///< Time since DriveTelemetry::reset()
+    double hostBytesPerSecond = 0.0;    ///< Data accepted from the host
+    double tapeBytesPerSecond = 0.0;    ///< Data written to tape, after compression
+    double compressionRatio = 0.0;      ///< Host bytes per tape byte in this interval (0 = unknown)
+    quint64 driveBufferBytes = 0;       ///< Data waiting in the drive buffer
+    quint32 driveBufferObjects = 0;     ///< Blocks waiting in the drive buffer
+    int driveBufferFillPercent = -1;    ///< Relative to DriveTelemetry::driveBufferSize() (-1 = unknown)
+    qint64 driveBufferEmpty = 0;        ///< Samples since reset that found the buffer drained while writing
+    qint64 speedMatchRate = -1;         ///< Vendor speed matching counter (-1 = not configured)
+    qint64 backhitches = -1;            ///< Vendor backhitch count since reset (-1 = not configured)
+    int hostBufferFillPercent = -1;     ///< Host read-ahead ring fill, filled in by TapeIO (-1 = unknown)
+
+    /**
+     * @brief Check if the drive kept up with the host in this interval
+     *
+     * True when the drive buffer was not drained, i.e. the tape did not
+     * have to stop and reposition for lack of data.
+     */
+    bool isStreaming() const;
+};
+
+/**
+ * @brief Samples drive performance log pages during a transfer
+ *
+ * Each sample reads the data compression log page (host and tape byte
+ * counters) and the drive buffer level from an extended READ POSITION.
+ * Speed matching and backhitch counters are vendor specific; they are
+ * read once a vendor log page and its parameter codes are configured
+ * from the drive's SCSI reference.
+ *
+ * The device handle is not thread-safe and the commands must not race
+ * queued data transfers. The thread running the transfer therefore
+ * calls sample() whenever isDue() and no commands are in flight; the
+ * interval acts as the timer.
+ */
+class LIBQLTFS_EXPORT DriveTelemetry
+{
+public:
+    explicit DriveTelemetry(TapeDevice *device);
+    ~DriveTelemetry();
+
+    // Disable copy
+    DriveTelemetry(const DriveTelemetry &) = delete;
+    DriveTelemetry &operator=(const DriveTelemetry &) = delete;
+
+    /**
+     * @brief Sampling period in milliseconds (0 = off)
+     */
+    void setInterval(int ms);
+    int interval() const;
+
+    /**
+     * @brief Capacity of the drive's data buffer, for the fill percentage (0 = unknown)
+     */
+    void setDriveBufferSize(quint64 bytes);
+    quint64 driveBufferSize() const;
+
+    /**
+     * @brief Read speed matching and backhitch counters from a vendor log page
+     * @param pageCode Vendor log page (0 = none)
+     * @param speedMatchParameter Parameter code of the speed matching rate
+     * @param backhitchParameter Parameter code of the backhitch (repositioning) count
+     */
+    void setVendorCounters(quint8 pageCode, quint16 speedMatchParameter, quint16 backhitchParameter);
+
+    /**
+     * @brief Number of samples kept in history()
+     */
+    void setHistorySize(int samples);
+
+    /**
+     * @brief Start a new series; the next sample() only takes the baseline
+     */
+    void reset();
+
+    /**
+     * @brief Check if the interval has passed since the last sample
+     */
+    bool isDue() const;
+
+    /**
+     * @brief Take a sample now
+     * @return false if nothing could be read (the series continues)
+     */
+    bool sample();
+
+    /**
+     * @brief Most recent sample
+     */
+    DriveTelemetrySample last() const;
+
+    /**
+     * @brief Recent samples, oldest first
+     */
+    QList<DriveTelemetrySample> history() const;
+
+private:
+    class Private;
+    Private *d;
+};
+
+} // namespace qltfs
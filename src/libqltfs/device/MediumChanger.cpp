@@ -0,0 +1,441 @@
+/*
+ * QLTOTapeMan - Qt-based LTO Tape Manager
+ * libqltfs - LTFS Core Library
+ *
+ * Copyright (c) 2026 Jeffrey ZHU (zhxsh1225@gmail.com)
+ * https://github.com/Gypsop/QLTOTapeMan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "MediumChanger.h"
+#include "ScsiCommand.h"
+#include "../util/Tracer.h"
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QScopedPointer>
+#include <QThreadPool>
+#include <QtConcurrent>
+
+#include <algorithm>
+
+namespace qltfs {
+
+// A robot move includes the drive ejecting or threading the cartridge
+static constexpr int MOVE_TIMEOUT_SECONDS = 15 * 60;
+
+// A full barcode scan of a large library
+static constexpr int INVENTORY_TIMEOUT_SECONDS = 60 * 60;
+
+// Upper bound of one element descriptor: header, two volume tags, device identifier
+static constexpr quint32 MAX_DESCRIPTOR_LENGTH = 12 + 36 + 36 + 4 + 64;
+
+// Element Address Assignment mode page
+static constexpr quint8 ELEMENT_ADDRESS_PAGE = 0x1D;
+
+namespace {
+
+quint16 readU16(const quint8 *data)
+{
+    return static_cast<quint16>((data[0] << 8) | data[1]);
+}
+
+quint32 readU24(const quint8 *data)
+{
+    return (static_cast<quint32>(data[0]) << 16) | (static_cast<quint32>(data[1]) << 8) | data[2];
+}
+
+} // namespace
+
+// ============================================================================
+// MediumChanger Private Implementation
+// ============================================================================
+
+class MediumChanger::Private
+{
+public:
+    struct Range {
+        quint16 first = 0;
+        quint16 count = 0;
+    };
+
+    QString devicePath;
+    QScopedPointer<ScsiCommand> scsi;
+
+    // One SCSI command at a time on the changer handle
+    QMutex robotMutex;
+
+    // Guards the fields below; never held across a command
+    mutable QMutex stateMutex;
+    QList<ChangerElement> elements;
+    Range ranges[5];                ///< Indexed by ChangerElementType
+    QString lastError;
+
+    // Runs queued moves in order
+    QThreadPool robotPool;
+
+    void setError(const QString &message)
+    {
+        QMutexLocker locker(&stateMutex);
+        lastError = message;
+    }
+
+    bool readAssignment(Range (&layout)[5]);
+    bool readStatus(ChangerElementType type, const Range &range, QList<ChangerElement> &out);
+    bool refresh();
+    static void parseStatus(const QByteArray &data, ChangerElementType type, QList<ChangerElement> &out);
+};
+
+bool MediumChanger::Private::readAssignment(Range (&layout)[5])
+{
+    auto result = scsi->modeSense10(ELEMENT_ADDRESS_PAGE, 0, 256);
+    if (!result.success || result.data.size() < 8) {
+        setError(QStringLiteral("Cannot read element address assignment: %1").arg(result.errorMessage()));
+        return false;
+    }
+
+    const quint8 *data = reinterpret_cast<const quint8 *>(result.data.constData());
+    const int page = 8 + readU16(data + 6);     // Skip header and block descriptors
+    if (result.data.size() < page + 18 || (data[page] & 0x3F) != ELEMENT_ADDRESS_PAGE) {
+        setError(QStringLiteral("Malformed element address assignment page"));
+        return false;
+    }
+
+    const ChangerElementType order[] = {
+        ChangerElementType::MediumTransport, ChangerElementType::Storage,
+        ChangerElementType::ImportExport, ChangerElementType::DataTransfer
+    };
+    for (int i = 0; i < 4; ++i) {
+        Range &range = layout[static_cast<int>(order[i])];
+        range.first = readU16(data + page + 2 + i * 4);
+        range.count = readU16(data + page + 4 + i * 4);
+    }
+    return true;
+}
+
+bool MediumChanger::Private::readStatus(ChangerElementType type, const Range &range,
+                                        QList<ChangerElement> &out)
+{
+    if (range.count == 0) {
+        return true;
+    }
+
+    const quint32 length = qMin<quint32>(16 + range.count * MAX_DESCRIPTOR_LENGTH, 0xFFFFFF);
+    const bool drives = type == ChangerElementType::DataTransfer;
+    auto result = scsi->readElementStatus(static_cast<quint8>(type), range.first, range.count,
+                                          length, true, drives);
+    if (!result.success && drives) {
+        // Older changers do not know DVCID; drives are then matched by address only
+        result = scsi->readElementStatus(static_cast<quint8>(type), range.first, range.count,
+                                         length, true, false);
+    }
+    if (!result.success) {
+        setError(QStringLiteral("READ ELEMENT STATUS failed: %1").arg(result.errorMessage()));
+        return false;
+    }
+
+    parseStatus(result.data, type, out);
+    return true;
+}
+
+void MediumChanger::Private::parseStatus(const QByteArray &bytes, ChangerElementType type,
+                                         QList<ChangerElement> &out)
+{
+    if (bytes.size() < 8) {
+        return;
+    }
+
+    const quint8 *data = reinterpret_cast<const quint8 *>(bytes.constData());
+    const int end = static_cast<int>(qMin<qint64>(8 + readU24(data + 5), bytes.size()));
+
+    // Element status data header, then one page per element type
+    int pos = 8;
+    while (pos + 8 <= end) {
+        const bool primaryTag = data[pos + 1] & 0x80;
+        const bool alternateTag = data[pos + 1] & 0x40;
+        const int descriptorLength = readU16(data + pos + 2);
+        const int pageEnd = static_cast<int>(qMin<qint64>(pos + 8 + readU24(data + pos + 5), end));
+        pos += 8;
+        if (descriptorLength < 12) {
+            break;
+        }
+
+        for (; pos + descriptorLength <= pageEnd; pos += descriptorLength) {
+            const quint8 *descriptor = data + pos;
+            ChangerElement element;
+            element.type = type;
+            element.address = readU16(descriptor);
+            element.full = descriptor[2] & 0x01;
+            element.exception = descriptor[2] & 0x04;
+            element.accessible = type == ChangerElementType::MediumTransport || (descriptor[2] & 0x08);
+            element.asc = descriptor[4];
+            element.ascq = descriptor[5];
+            element.sourceValid = descriptor[9] & 0x80;
+            element.sourceAddress = readU16(descriptor + 10);
+
+            int offset = 12;
+            if (primaryTag && offset + 36 <= descriptorLength) {
+                element.volumeTag = QString::fromLatin1(reinterpret_cast<const char *>(descriptor + offset), 32).trimmed();
+                offset += 36;
+            }
+            if (alternateTag) {
+                offset += 36;
+            }
+            if (offset + 4 <= descriptorLength) {
+                const int idLength = qMin<int>(descriptor[offset + 3], descriptorLength - offset - 4);
+                element.identifier = QString::fromLatin1(reinterpret_cast<const char *>(descriptor + offset + 4),
+                                                         idLength).trimmed();
+            }
+            out.append(element);
+        }
+        pos = pageEnd;
+    }
+}
+
+bool MediumChanger::Private::refresh()
+{
+    QMutexLocker robot(&robotMutex);
+    if (!scsi || !scsi->isOpen()) {
+        setError(QStringLiteral("Changer is not open"));
+        return false;
+    }
+
+    Range layout[5];
+    if (!readAssignment(layout)) {
+        return false;
+    }
+
+    QList<ChangerElement> table;
+    for (int type = 1; type <= 4; ++type) {
+        if (!readStatus(static_cast<ChangerElementType>(type), layout[type], table)) {
+            return false;
+        }
+    }
+    std::sort(table.begin(), table.end(), [](const ChangerElement &a, const ChangerElement &b) {
+        return a.address < b.address;
+    });
+
+    QMutexLocker locker(&stateMutex);
+    elements = table;
+    std::copy(std::begin(layout), std::end(layout), std::begin(ranges));
+    return true;
+}
+
+// ============================================================================
+// MediumChanger Implementation
+// ============================================================================
+
+MediumChanger::MediumChanger(const QString &devicePath)
+    : d(new Private)
+{
+    d->devicePath = devicePath;
+    d->robotPool.setMaxThreadCount(1);
+}
+
+MediumChanger::~MediumChanger()
+{
+    close();
+    delete d;
+}
+
+bool MediumChanger::open()
+{
+    {
+        QMutexLocker robot(&d->robotMutex);
+        if (!d->scsi) {
+            d->scsi.reset(new ScsiCommand(d->devicePath));
+        }
+        if (!d->scsi->isOpen() && !d->scsi->open()) {
+            d->setError(QStringLiteral("Cannot open changer %1").arg(d->devicePath));
+            return false;
+        }
+    }
+    return d->refresh();
+}
+
+void MediumChanger::close()
+{
+    d->robotPool.waitForDone();
+
+    QMutexLocker robot(&d->robotMutex);
+    if (d->scsi) {
+        d->scsi->close();
+    }
+}
+
+bool MediumChanger::isOpen() const
+{
+    QMutexLocker robot(&d->robotMutex);
+    return d->scsi && d->scsi->isOpen();
+}
+
+QString MediumChanger::devicePath() const
+{
+    return d->devicePath;
+}
+
+bool MediumChanger::refresh()
+{
+    return d->refresh();
+}
+
+bool MediumChanger::inventory()
+{
+    {
+        QMutexLocker robot(&d->robotMutex);
+        if (!d->scsi || !d->scsi->isOpen()) {
+            d->setError(QStringLiteral("Changer is not open"));
+            return false;
+        }
+
+        const int timeout = d->scsi->timeout();
+        d->scsi->setTimeout(INVENTORY_TIMEOUT_SECONDS);
+        auto result = d->scsi->initializeElementStatus();
+        d->scsi->setTimeout(timeout);
+        if (!result.success) {
+            d->setError(QStringLiteral("INITIALIZE ELEMENT STATUS failed: %1").arg(result.errorMessage()));
+            return false;
+        }
+    }
+    return d->refresh();
+}
+
+QList<ChangerElement> MediumChanger::elements(ChangerElementType type) const
+{
+    QMutexLocker locker(&d->stateMutex);
+    if (type == ChangerElementType::All) {
+        return d->elements;
+    }
+
+    QList<ChangerElement> result;
+    for (const ChangerElement &element : d->elements) {
+        if (element.type == type) {
+            result.append(element);
+        }
+    }
+    return result;
+}
+
+bool MediumChanger::findElement(quint16 address, ChangerElement &element) const
+{
+    QMutexLocker locker(&d->stateMutex);
+    for (const ChangerElement &candidate : d->elements) {
+        if (candidate.address == address) {
+            element = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+int MediumChanger::findVolume(const QString &volumeTag) const
+{
+    QMutexLocker locker(&d->stateMutex);
+    for (const ChangerElement &element : d->elements) {
+        if (element.full && element.volumeTag.compare(volumeTag, Qt::CaseInsensitive) == 0) {
+            return element.address;
+        }
+    }
+    return -1;
+}
+
+int MediumChanger::findDrive(const QString &serialNumber) const
+{
+    if (serialNumber.isEmpty()) {
+        return -1;
+    }
+
+    QMutexLocker locker(&d->stateMutex);
+    for (const ChangerElement &element : d->elements) {
+        if (element.type == ChangerElementType::DataTransfer && element.identifier.contains(serialNumber)) {
+            return element.address;
+        }
+    }
+    return -1;
+}
+
+int MediumChanger::findEmptySlot() const
+{
+    QMutexLocker locker(&d->stateMutex);
+    for (const ChangerElement &element : d->elements) {
+        if (element.type == ChangerElementType::Storage && !element.full && element.accessible) {
+            return element.address;
+        }
+    }
+    return -1;
+}
+
+bool MediumChanger::moveMedium(quint16 source, quint16 destination)
+{
+    QLTFS_TRACE_SPAN("changer", "moveMedium");
+
+    QMutexLocker robot(&d->robotMutex);
+    if (!d->scsi || !d->scsi->isOpen()) {
+        d->setError(QStringLiteral("Changer is not open"));
+        return false;
+    }
+
+    quint16 transport;
+    {
+        QMutexLocker locker(&d->stateMutex);
+        const Private::Range &robots = d->ranges[static_cast<int>(ChangerElementType::MediumTransport)];
+        transport = robots.count > 0 ? robots.first : 0;
+    }
+
+    const int timeout = d->scsi->timeout();
+    d->scsi->setTimeout(MOVE_TIMEOUT_SECONDS);
+    auto result = d->scsi->moveMedium(transport, source, destination);
+    d->scsi->setTimeout(timeout);
+
+    if (!result.success) {
+        d->setError(QStringLiteral("Cannot move medium from element %1 to %2: %3")
+                        .arg(source).arg(destination).arg(result.errorMessage()));
+        return false;
+    }
+
+    // Track the cartridge without another READ ELEMENT STATUS
+    QMutexLocker locker(&d->stateMutex);
+    auto find = [this](quint16 address) {
+        return std::find_if(d->elements.begin(), d->elements.end(),
+                            [address](const ChangerElement &element) { return element.address == address; });
+    };
+    auto from = find(source);
+    auto to = find(destination);
+    if (from != d->elements.end() && to != d->elements.end()) {
+        to->full = true;
+        to->volumeTag = from->volumeTag;
+        to->sourceValid = true;
+        to->sourceAddress = source;
+        from->full = false;
+        from->volumeTag.clear();
+        from->sourceValid = false;
+    }
+    return true;
+}
+
+QFuture<bool> MediumChanger::moveMediumAsync(quint16 source, quint16 destination)
+{
+    return QtConcurrent::run(&d->robotPool, [this, source, destination]() {
+        return moveMedium(source, destination);
+    });
+}
+
+QString MediumChanger::lastError() const
+{
+    QMutexLocker locker(&d->stateMutex);
+    return d->lastError;
+}
+
+} // namespace qltfs
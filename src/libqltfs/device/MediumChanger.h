@@ -0,0 +1,165 @@
+/*
+ * QLTOTapeMan - Qt-based LTO Tape Manager
+ * libqltfs - LTFS Core Library
+ *
+ * Copyright (c) 2026 Jeffrey ZHU (zhxsh1225@gmail.com)
+ * https://github.com/Gypsop/QLTOTapeMan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "libqltfs_global.h"
+
+#include <QFuture>
+#include <QList>
+#include <QString>
+
+namespace qltfs {
+
+/**
+ * @brief Kinds of changer elements (SMC-3 element type codes)
+ */
+enum class ChangerElementType : quint8 {
+    All             = 0x00,     ///< Every element (queries only)
+    MediumTransport = 0x01,     ///< Robot arm
+    Storage         = 0x02,     ///< Storage slot
+    ImportExport    = 0x03,     ///< Mail slot
+    DataTransfer    = 0x04      ///< Tape drive
+};
+
+/**
+ * @brief State of one changer element
+ */
+struct LIBQLTFS_EXPORT ChangerElement {
+    ChangerElementType type = ChangerElementType::Storage;
+    quint16 address = 0;            ///< Element address used by MOVE MEDIUM
+    bool full = false;              ///< Holds a cartridge
+    bool accessible = true;         ///< Robot can reach the element
+    bool exception = false;         ///< Element is in an abnormal state (see asc/ascq)
+    quint8 asc = 0;
+    quint8 ascq = 0;
+    bool sourceValid = false;       ///< sourceAddress holds where the cartridge came from
+    quint16 sourceAddress = 0;
+    QString volumeTag;              ///< Primary volume tag (barcode label)
+    QString identifier;             ///< Device identifier of a drive (usually vendor, model and serial)
+};
+
+/**
+ * @brief Drives the robot of a tape library or autoloader
+ *
+ * Reads the element layout from the Element Address Assignment mode
+ * page and the element states with READ ELEMENT STATUS, and moves
+ * cartridges with MOVE MEDIUM. The element table is kept up to date
+ * after every move, so refresh() is only needed when the library may
+ * have been changed by someone else.
+ *
+ * A changer has one robot: moves are carried out one at a time, in
+ * the order they were requested, on a thread of the changer's own.
+ * moveMediumAsync() lets a caller keep a drive writing while the robot
+ * works. All methods are thread-safe.
+ */
+class LIBQLTFS_EXPORT MediumChanger
+{
+public:
+    /**
+     * @brief Constructor
+     * @param devicePath Changer device path (/dev/sch0, /dev/sgN, \\.\Changer0)
+     */
+    explicit MediumChanger(const QString &devicePath);
+    ~MediumChanger();
+
+    // Disable copy
+    MediumChanger(const MediumChanger &) = delete;
+    MediumChanger &operator=(const MediumChanger &) = delete;
+
+    /**
+     * @brief Open the changer and read its elements
+     */
+    bool open();
+
+    /**
+     * @brief Close the changer; waits for moves still queued
+     */
+    void close();
+
+    bool isOpen() const;
+    QString devicePath() const;
+
+    /**
+     * @brief Read the state of every element again
+     */
+    bool refresh();
+
+    /**
+     * @brief Take a new inventory (scans barcodes; may take minutes), then refresh()
+     */
+    bool inventory();
+
+    // === Elements ===
+
+    /**
+     * @brief Elements of one type, in address order
+     */
+    QList<ChangerElement> elements(ChangerElementType type = ChangerElementType::All) const;
+
+    /**
+     * @brief Look up one element by address
+     * @return false if there is no such element
+     */
+    bool findElement(quint16 address, ChangerElement &element) const;
+
+    /**
+     * @brief Element holding the cartridge with a volume tag
+     * @return Element address, or -1 if not found
+     */
+    int findVolume(const QString &volumeTag) const;
+
+    /**
+     * @brief Drive element whose device identifier contains a serial number
+     * @return Element address, or -1 if not found
+     */
+    int findDrive(const QString &serialNumber) const;
+
+    /**
+     * @brief First empty storage slot
+     * @return Element address, or -1 if every slot is full
+     */
+    int findEmptySlot() const;
+
+    // === Moves ===
+
+    /**
+     * @brief Move a cartridge; blocks until the robot is done
+     */
+    bool moveMedium(quint16 source, quint16 destination);
+
+    /**
+     * @brief Queue a move for the robot
+     * @return Future holding the result of the move
+     */
+    QFuture<bool> moveMediumAsync(quint16 source, quint16 destination);
+
+    /**
+     * @brief Get last error message
+     */
+    QString lastError() const;
+
+private:
+    class Private;
+    Private *d;
+};
+
+} // namespace qltfs
@@ -20,8 +20,11 @@
  */
 
 #include "ScsiCommand.h"
+#include "platform/VirtualTape.h"
+#include "../util/Tracer.h"
 
 #include <QDebug>
+#include <QThread>
 
 #ifdef Q_OS_WIN
 #include <windows.h>
@@ -33,6 +36,7 @@
 #include <sys/ioctl.h>
 #include <scsi/sg.h>
 #include <scsi/scsi.h>
+#include <linux/fs.h>
 #endif
 
 namespace qltfs {
@@ -52,6 +56,46 @@ static constexpr int MAX_CDB_LENGTH = 16;
 // Sense data buffer size
 static constexpr int SENSE_BUFFER_SIZE = 252;
 
+/**
+ * @brief Span name for a command in traces
+ */
+static const char *traceName(const QByteArray &cdb)
+{
+    if (cdb.isEmpty()) {
+        return "Empty";
+    }
+
+    switch (static_cast<ScsiOpCode>(static_cast<quint8>(cdb.at(0)))) {
+    case ScsiOpCode::TestUnitReady:     return "TestUnitReady";
+    case ScsiOpCode::Rewind:            return "Rewind";
+    case ScsiOpCode::RequestSense:      return "RequestSense";
+    case ScsiOpCode::Read6:             return "Read6";
+    case ScsiOpCode::Write6:            return "Write6";
+    case ScsiOpCode::WriteFilemark:     return "WriteFilemark";
+    case ScsiOpCode::Space:             return "Space";
+    case ScsiOpCode::Inquiry:           return "Inquiry";
+    case ScsiOpCode::ModeSelect6:       return "ModeSelect6";
+    case ScsiOpCode::ModeSense6:        return "ModeSense6";
+    case ScsiOpCode::ModeSelect10:      return "ModeSelect10";
+    case ScsiOpCode::ModeSense10:       return "ModeSense10";
+    case ScsiOpCode::LoadUnload:        return "LoadUnload";
+    case ScsiOpCode::Erase:             return "Erase";
+    case ScsiOpCode::Locate10:          return "Locate10";
+    case ScsiOpCode::Locate16:          return "Locate16";
+    case ScsiOpCode::ReadPosition:      return "ReadPosition";
+    case ScsiOpCode::LogSelect:         return "LogSelect";
+    case ScsiOpCode::LogSense:          return "LogSense";
+    case ScsiOpCode::ReadAttribute:     return "ReadAttribute";
+    case ScsiOpCode::WriteAttribute:    return "WriteAttribute";
+    case ScsiOpCode::FormatMedium:      return "FormatMedium";
+    case ScsiOpCode::ReadBlockLimits:   return "ReadBlockLimits";
+    case ScsiOpCode::ReadElementStatus: return "ReadElementStatus";
+    case ScsiOpCode::MoveMedium:        return "MoveMedium";
+    case ScsiOpCode::InitializeElementStatus: return "InitializeElementStatus";
+    default:                            return "Command";
+    }
+}
+
 // ============================================================================
 // ScsiSenseData Implementation
 // ============================================================================
@@ -121,6 +165,7 @@ ScsiSenseData ScsiSenseData::fromRawData(const QByteArray &data)
         // Fixed format sense data
         sense.valid = (bytes[0] & 0x80) != 0;
         sense.senseKey = static_cast<ScsiSenseKey>(bytes[2] & 0x0F);
+        sense.filemark = (bytes[2] & 0x80) != 0;
 
         // Information field (bytes 3-6)
         sense.information = (static_cast<quint32>(bytes[3]) << 24) |
@@ -144,6 +189,11 @@ ScsiSenseData ScsiSenseData::fromRawData(const QByteArray &data)
         sense.valid = true;
     }
 
+    // FILEMARK DETECTED also covers descriptor format, which has no FILEMARK bit here
+    if (sense.additionalSenseCode == 0x00 && sense.additionalSenseCodeQualifier == 0x01) {
+        sense.filemark = true;
+    }
+
     return sense;
 }
 
@@ -183,6 +233,7 @@ class ScsiCommand::Private
 public:
     QString devicePath;
     int timeoutSeconds = DEFAULT_TIMEOUT;
+    QSharedPointer<VirtualTape> virtualTape;    ///< Set for vtape: paths
 
 #ifdef Q_OS_WIN
     HANDLE hDevice = INVALID_HANDLE_VALUE;
@@ -192,6 +243,10 @@ public:
 
     bool isOpen() const
     {
+        if (virtualTape) {
+            return true;
+        }
+
 #ifdef Q_OS_WIN
         return hDevice != INVALID_HANDLE_VALUE;
 #elif defined(Q_OS_LINUX)
@@ -205,6 +260,17 @@ public:
                               ScsiDataDirection direction,
                               QByteArray &data,
                               quint32 dataLength);
+
+    /**
+     * @brief Execute with a caller-owned buffer
+     *
+     * The buffer is passed straight to SG_IO / SPTI without being
+     * copied, resized or cleared. result.data is not populated.
+     */
+    ScsiCommandResult execute(const QByteArray &cdb,
+                              ScsiDataDirection direction,
+                              void *buffer,
+                              quint32 bufferLength);
 };
 
 ScsiCommandResult ScsiCommand::Private::execute(const QByteArray &cdb,
@@ -212,6 +278,39 @@ ScsiCommandResult ScsiCommand::Private::execute(const QByteArray &cdb,
                                                  QByteArray &data,
                                                  quint32 dataLength)
 {
+    // Set up data buffer
+    if (direction == ScsiDataDirection::FromDevice) {
+        data.resize(static_cast<int>(dataLength));
+        data.fill(0);
+    }
+
+    void *buffer = nullptr;
+    quint32 bufferLength = 0;
+    if (direction != ScsiDataDirection::None && !data.isEmpty()) {
+        buffer = data.data();
+        bufferLength = static_cast<quint32>(data.size());
+    }
+
+    ScsiCommandResult result = execute(cdb, direction, buffer, bufferLength);
+
+    if (direction == ScsiDataDirection::FromDevice) {
+        if (result.bytesTransferred < bufferLength) {
+            data.resize(static_cast<int>(result.bytesTransferred));
+        }
+        result.data = data;
+    }
+
+    return result;
+}
+
+ScsiCommandResult ScsiCommand::Private::execute(const QByteArray &cdb,
+                                                 ScsiDataDirection direction,
+                                                 void *buffer,
+                                                 quint32 bufferLength)
+{
+    TraceSpan span("scsi", traceName(cdb));
+    span.setArg("bytes", bufferLength);
+
     ScsiCommandResult result;
 
     if (!isOpen()) {
@@ -219,6 +318,14 @@ ScsiCommandResult ScsiCommand::Private::execute(const QByteArray &cdb,
         return result;
     }
 
+    if (virtualTape) {
+        result = virtualTape->execute(cdb, direction, buffer, bufferLength);
+        if (virtualTape->commandLatencyUs() > 0) {
+            QThread::usleep(static_cast<unsigned long>(virtualTape->commandLatencyUs()));
+        }
+        return result;
+    }
+
 #ifdef Q_OS_WIN
     // Windows implementation using SCSI_PASS_THROUGH_DIRECT
     struct SPT_WITH_SENSE {
@@ -245,15 +352,9 @@ ScsiCommandResult ScsiCommand::Private::execute(const QByteArray &cdb,
         break;
     }
 
-    // Set up data buffer
-    if (direction == ScsiDataDirection::FromDevice) {
-        data.resize(static_cast<int>(dataLength));
-        data.fill(0);
-    }
-
-    if (direction != ScsiDataDirection::None && !data.isEmpty()) {
-        sptd.spt.DataBuffer = data.data();
-        sptd.spt.DataTransferLength = static_cast<ULONG>(data.size());
+    if (direction != ScsiDataDirection::None && buffer && bufferLength > 0) {
+        sptd.spt.DataBuffer = buffer;
+        sptd.spt.DataTransferLength = static_cast<ULONG>(bufferLength);
     } else {
         sptd.spt.DataBuffer = nullptr;
         sptd.spt.DataTransferLength = 0;
@@ -291,9 +392,6 @@ ScsiCommandResult ScsiCommand::Private::execute(const QByteArray &cdb,
     }
 
     result.success = (result.scsiStatus == SCSI_STATUS_GOOD);
-    if (direction == ScsiDataDirection::FromDevice) {
-        result.data = data;
-    }
 
 #elif defined(Q_OS_LINUX)
     // Linux implementation using SG_IO ioctl
@@ -319,15 +417,9 @@ ScsiCommandResult ScsiCommand::Private::execute(const QByteArray &cdb,
         break;
     }
 
-    // Set up data buffer
-    if (direction == ScsiDataDirection::FromDevice) {
-        data.resize(static_cast<int>(dataLength));
-        data.fill(0);
-    }
-
-    if (direction != ScsiDataDirection::None && !data.isEmpty()) {
-        io_hdr.dxferp = data.data();
-        io_hdr.dxfer_len = static_cast<unsigned int>(data.size());
+    if (direction != ScsiDataDirection::None && buffer && bufferLength > 0) {
+        io_hdr.dxferp = buffer;
+        io_hdr.dxfer_len = static_cast<unsigned int>(bufferLength);
     }
 
     int ret = ioctl(fd, SG_IO, &io_hdr);
@@ -341,7 +433,7 @@ ScsiCommandResult ScsiCommand::Private::execute(const QByteArray &cdb,
     result.driverStatus = io_hdr.driver_status;
     result.scsiStatus = io_hdr.status;
     result.residual = io_hdr.resid;
-    result.bytesTransferred = dataLength - io_hdr.resid;
+    result.bytesTransferred = io_hdr.dxfer_len - io_hdr.resid;
 
     // Parse sense data
     if (io_hdr.sb_len_wr > 0) {
@@ -354,17 +446,12 @@ ScsiCommandResult ScsiCommand::Private::execute(const QByteArray &cdb,
                      io_hdr.driver_status == 0 &&
                      result.scsiStatus == SCSI_STATUS_GOOD);
 
-    if (direction == ScsiDataDirection::FromDevice) {
-        data.resize(static_cast<int>(result.bytesTransferred));
-        result.data = data;
-    }
-
 #else
     // Unsupported platform
     Q_UNUSED(cdb)
     Q_UNUSED(direction)
-    Q_UNUSED(data)
-    Q_UNUSED(dataLength)
+    Q_UNUSED(buffer)
+    Q_UNUSED(bufferLength)
     result.success = false;
 #endif
 
@@ -393,6 +480,15 @@ bool ScsiCommand::open()
         return true;
     }
 
+    if (VirtualTape::isVirtualPath(d->devicePath)) {
+        QString error;
+        d->virtualTape = VirtualTape::attach(d->devicePath, &error);
+        if (!d->virtualTape) {
+            qWarning() << "ScsiCommand: cannot open virtual tape:" << error;
+        }
+        return !d->virtualTape.isNull();
+    }
+
 #ifdef Q_OS_WIN
     // Windows: Open device with GENERIC_READ | GENERIC_WRITE
     d->hDevice = CreateFileW(
@@ -419,6 +515,8 @@ bool ScsiCommand::open()
 
 void ScsiCommand::close()
 {
+    d->virtualTape.reset();
+
 #ifdef Q_OS_WIN
     if (d->hDevice != INVALID_HANDLE_VALUE) {
         CloseHandle(d->hDevice);
@@ -452,6 +550,44 @@ int ScsiCommand::timeout() const
     return d->timeoutSeconds;
 }
 
+quint32 ScsiCommand::maxTransferLength() const
+{
+    if (!d->isOpen()) {
+        return 0;
+    }
+
+    if (d->virtualTape) {
+        return VirtualTape::MAX_TRANSFER_LENGTH;
+    }
+
+#ifdef Q_OS_WIN
+    IO_SCSI_CAPABILITIES caps = {};
+    DWORD bytesReturned = 0;
+    BOOL ok = DeviceIoControl(
+        d->hDevice,
+        IOCTL_SCSI_GET_CAPABILITIES,
+        nullptr,
+        0,
+        &caps,
+        sizeof(caps),
+        &bytesReturned,
+        nullptr
+    );
+    return ok ? static_cast<quint32>(caps.MaximumTransferLength) : 0;
+
+#elif defined(Q_OS_LINUX)
+    // The sg driver reports the queue limit in bytes
+    int maxBytes = 0;
+    if (ioctl(d->fd, BLKSECTGET, &maxBytes) < 0 || maxBytes <= 0) {
+        return 0;
+    }
+    return static_cast<quint32>(maxBytes);
+
+#else
+    return 0;
+#endif
+}
+
 ScsiCommandResult ScsiCommand::testUnitReady()
 {
     QByteArray cdb(6, 0);
@@ -518,6 +654,25 @@ ScsiCommandResult ScsiCommand::modeSelect10(const QByteArray &data, bool savePag
     return d->execute(cdb, ScsiDataDirection::ToDevice, writeData, static_cast<quint32>(data.size()));
 }
 
+ScsiCommandResult ScsiCommand::setDataProtection(LbpMethod method, bool protectWrite, bool protectRead)
+{
+    // Mode parameter header (8 bytes, no block descriptor) followed by the
+    // Control Data Protection page (0x0A, subpage 0xF0, SPF format)
+    QByteArray modeData(8 + 32, 0);
+    char *page = modeData.data() + 8;
+
+    page[0] = static_cast<char>(0x40 | 0x0A);   // SPF, page code
+    page[1] = static_cast<char>(0xF0);          // Subpage code
+    page[3] = 0x1C;                             // Page length
+    page[4] = static_cast<char>(method);
+    if (method != LbpMethod::None) {
+        page[5] = static_cast<char>(PROTECTION_INFO_LENGTH);
+        page[6] = static_cast<char>((protectWrite ? 0x80 : 0x00) | (protectRead ? 0x40 : 0x00));
+    }
+
+    return modeSelect10(modeData, false);
+}
+
 ScsiCommandResult ScsiCommand::logSense(quint8 pageCode, quint8 subPageCode, quint16 allocationLength)
 {
     QByteArray cdb(10, 0);
@@ -617,21 +772,27 @@ ScsiCommandResult ScsiCommand::read6(QByteArray &buffer, quint32 blockCount, boo
     return d->execute(cdb, ScsiDataDirection::FromDevice, buffer, dataLength);
 }
 
-ScsiCommandResult ScsiCommand::write6(const QByteArray &data, bool fixedBlock)
+ScsiCommandResult ScsiCommand::read6(char *buffer, quint32 bufferSize,
+                                     quint32 transferLength, bool fixedBlock)
 {
-    QByteArray cdb(6, 0);
-    cdb[0] = static_cast<char>(ScsiOpCode::Write6);
-    cdb[1] = fixedBlock ? 0x01 : 0x00;
+    return d->execute(read6Cdb(transferLength, fixedBlock),
+                      ScsiDataDirection::FromDevice, buffer, bufferSize);
+}
 
+ScsiCommandResult ScsiCommand::write6(const QByteArray &data, bool fixedBlock)
+{
     // For fixed block mode, count is number of blocks
     // For variable block mode, count is byte count
     quint32 count = static_cast<quint32>(data.size());
-    cdb[2] = static_cast<char>((count >> 16) & 0xFF);
-    cdb[3] = static_cast<char>((count >> 8) & 0xFF);
-    cdb[4] = static_cast<char>(count & 0xFF);
+    return write6(data.constData(), static_cast<quint32>(data.size()), count, fixedBlock);
+}
 
-    QByteArray writeData = data;
-    return d->execute(cdb, ScsiDataDirection::ToDevice, writeData, static_cast<quint32>(data.size()));
+ScsiCommandResult ScsiCommand::write6(const char *data, quint32 length,
+                                      quint32 transferLength, bool fixedBlock)
+{
+    // The driver only reads from the buffer on a data-out transfer
+    return d->execute(write6Cdb(transferLength, fixedBlock),
+                      ScsiDataDirection::ToDevice, const_cast<char *>(data), length);
 }
 
 ScsiCommandResult ScsiCommand::writeFilemark(quint32 count, bool setMark, bool immediate)
@@ -659,11 +820,13 @@ ScsiCommandResult ScsiCommand::erase(bool longErase, bool immediate)
     return d->execute(cdb, ScsiDataDirection::None, data, 0);
 }
 
-ScsiCommandResult ScsiCommand::readAttribute(quint8 serviceAction, quint16 attributeId, quint32 allocationLength)
+ScsiCommandResult ScsiCommand::readAttribute(quint8 serviceAction, quint16 attributeId, quint32 allocationLength,
+                                             quint8 partition)
 {
     QByteArray cdb(16, 0);
     cdb[0] = static_cast<char>(ScsiOpCode::ReadAttribute);
     cdb[1] = static_cast<char>(serviceAction & 0x1F);
+    cdb[7] = static_cast<char>(partition);
 
     // Attribute ID
     cdb[8] = static_cast<char>((attributeId >> 8) & 0xFF);
@@ -679,11 +842,12 @@ ScsiCommandResult ScsiCommand::readAttribute(quint8 serviceAction, quint16 attri
     return d->execute(cdb, ScsiDataDirection::FromDevice, data, allocationLength);
 }
 
-ScsiCommandResult ScsiCommand::writeAttribute(const QByteArray &data)
+ScsiCommandResult ScsiCommand::writeAttribute(const QByteArray &data, quint8 partition)
 {
     QByteArray cdb(16, 0);
     cdb[0] = static_cast<char>(ScsiOpCode::WriteAttribute);
     cdb[1] = 0x01;  // Write through
+    cdb[7] = static_cast<char>(partition);
 
     quint32 paramLength = static_cast<quint32>(data.size());
     cdb[10] = static_cast<char>((paramLength >> 24) & 0xFF);
@@ -705,6 +869,39 @@ ScsiCommandResult ScsiCommand::allowOverwrite(quint8 mode)
     return d->execute(cdb, ScsiDataDirection::None, data, 0);
 }
 
+ScsiCommandResult ScsiCommand::generateRecommendedAccessOrder(const QByteArray &parameterList)
+{
+    QByteArray cdb(16, 0);
+    cdb[0] = static_cast<char>(ScsiOpCode::MaintenanceOut);
+    cdb[1] = 0x1D;  // Service action: GRAO
+    cdb[2] = 0x00;  // Process: reorder the segments
+    cdb[3] = 0x00;  // UDS type: no geometry
+
+    quint32 paramLength = static_cast<quint32>(parameterList.size());
+    cdb[6] = static_cast<char>((paramLength >> 24) & 0xFF);
+    cdb[7] = static_cast<char>((paramLength >> 16) & 0xFF);
+    cdb[8] = static_cast<char>((paramLength >> 8) & 0xFF);
+    cdb[9] = static_cast<char>(paramLength & 0xFF);
+
+    QByteArray writeData = parameterList;
+    return d->execute(cdb, ScsiDataDirection::ToDevice, writeData, paramLength);
+}
+
+ScsiCommandResult ScsiCommand::receiveRecommendedAccessOrder(quint32 allocationLength)
+{
+    QByteArray cdb(16, 0);
+    cdb[0] = static_cast<char>(ScsiOpCode::MaintenanceIn);
+    cdb[1] = 0x1D;  // Service action: RRAO
+    cdb[6] = static_cast<char>((allocationLength >> 24) & 0xFF);
+    cdb[7] = static_cast<char>((allocationLength >> 16) & 0xFF);
+    cdb[8] = static_cast<char>((allocationLength >> 8) & 0xFF);
+    cdb[9] = static_cast<char>(allocationLength & 0xFF);
+    cdb[10] = 0x00;  // UDS type: no geometry
+
+    QByteArray data;
+    return d->execute(cdb, ScsiDataDirection::FromDevice, data, allocationLength);
+}
+
 ScsiCommandResult ScsiCommand::preventAllowMediumRemoval(bool prevent)
 {
     QByteArray cdb(6, 0);
@@ -715,6 +912,50 @@ ScsiCommandResult ScsiCommand::preventAllowMediumRemoval(bool prevent)
     return d->execute(cdb, ScsiDataDirection::None, data, 0);
 }
 
+ScsiCommandResult ScsiCommand::readElementStatus(quint8 elementType, quint16 startAddress, quint16 count,
+                                                 quint32 allocationLength, bool volumeTag, bool deviceId)
+{
+    QByteArray cdb(12, 0);
+    cdb[0] = static_cast<char>(ScsiOpCode::ReadElementStatus);
+    cdb[1] = static_cast<char>((volumeTag ? 0x10 : 0x00) | (elementType & 0x0F));
+    cdb[2] = static_cast<char>((startAddress >> 8) & 0xFF);
+    cdb[3] = static_cast<char>(startAddress & 0xFF);
+    cdb[4] = static_cast<char>((count >> 8) & 0xFF);
+    cdb[5] = static_cast<char>(count & 0xFF);
+    cdb[6] = deviceId ? 0x01 : 0x00;  // DVCID
+    cdb[7] = static_cast<char>((allocationLength >> 16) & 0xFF);
+    cdb[8] = static_cast<char>((allocationLength >> 8) & 0xFF);
+    cdb[9] = static_cast<char>(allocationLength & 0xFF);
+
+    QByteArray data;
+    return d->execute(cdb, ScsiDataDirection::FromDevice, data, allocationLength);
+}
+
+ScsiCommandResult ScsiCommand::moveMedium(quint16 transportAddress, quint16 sourceAddress,
+                                          quint16 destinationAddress)
+{
+    QByteArray cdb(12, 0);
+    cdb[0] = static_cast<char>(ScsiOpCode::MoveMedium);
+    cdb[2] = static_cast<char>((transportAddress >> 8) & 0xFF);
+    cdb[3] = static_cast<char>(transportAddress & 0xFF);
+    cdb[4] = static_cast<char>((sourceAddress >> 8) & 0xFF);
+    cdb[5] = static_cast<char>(sourceAddress & 0xFF);
+    cdb[6] = static_cast<char>((destinationAddress >> 8) & 0xFF);
+    cdb[7] = static_cast<char>(destinationAddress & 0xFF);
+
+    QByteArray data;
+    return d->execute(cdb, ScsiDataDirection::None, data, 0);
+}
+
+ScsiCommandResult ScsiCommand::initializeElementStatus()
+{
+    QByteArray cdb(6, 0);
+    cdb[0] = static_cast<char>(ScsiOpCode::InitializeElementStatus);
+
+    QByteArray data;
+    return d->execute(cdb, ScsiDataDirection::None, data, 0);
+}
+
 ScsiCommandResult ScsiCommand::formatMedium(quint8 format, bool partition)
 {
     QByteArray cdb(6, 0);
@@ -740,6 +981,35 @@ ScsiCommandResult ScsiCommand::reportDensitySupport(bool mediaType, quint16 allo
     return d->execute(cdb, ScsiDataDirection::FromDevice, data, allocationLength);
 }
 
+QByteArray ScsiCommand::read6Cdb(quint32 transferLength, bool fixedBlock)
+{
+    QByteArray cdb(6, 0);
+    cdb[0] = static_cast<char>(ScsiOpCode::Read6);
+    // Variable mode: set SILI so a block shorter than the buffer is not an error
+    cdb[1] = fixedBlock ? 0x01 : 0x02;
+
+    // Transfer length (24-bit): blocks in fixed mode, bytes in variable mode
+    cdb[2] = static_cast<char>((transferLength >> 16) & 0xFF);
+    cdb[3] = static_cast<char>((transferLength >> 8) & 0xFF);
+    cdb[4] = static_cast<char>(transferLength & 0xFF);
+
+    return cdb;
+}
+
+QByteArray ScsiCommand::write6Cdb(quint32 transferLength, bool fixedBlock)
+{
+    QByteArray cdb(6, 0);
+    cdb[0] = static_cast<char>(ScsiOpCode::Write6);
+    cdb[1] = fixedBlock ? 0x01 : 0x00;
+
+    // Transfer length (24-bit): blocks in fixed mode, bytes in variable mode
+    cdb[2] = static_cast<char>((transferLength >> 16) & 0xFF);
+    cdb[3] = static_cast<char>((transferLength >> 8) & 0xFF);
+    cdb[4] = static_cast<char>(transferLength & 0xFF);
+
+    return cdb;
+}
+
 ScsiCommandResult ScsiCommand::executeRaw(const QByteArray &cdb,
                                           ScsiDataDirection direction,
                                           QByteArray &data,
@@ -49,6 +49,7 @@ enum class ScsiOpCode : quint8 {
     ModeSense6          = 0x1A,
     LoadUnload          = 0x1B,
     ReadBlockLimits     = 0x05,
+    InitializeElementStatus = 0x07,
     PreventAllowMediumRemoval = 0x1E,
     ReadCapacity        = 0x25,
     Read10              = 0x28,
@@ -62,6 +63,10 @@ enum class ScsiOpCode : quint8 {
     ModeSelect10        = 0x55,
     ModeSense10         = 0x5A,
     ReportLuns          = 0xA0,
+    MaintenanceIn       = 0xA3,
+    MaintenanceOut      = 0xA4,
+    MoveMedium          = 0xA5,
+    ReadElementStatus   = 0xB8,
     Read16              = 0x88,
     Write16             = 0x8A,
     Verify16            = 0x8F,
@@ -75,6 +80,15 @@ enum class ScsiOpCode : quint8 {
     SetCapacity         = 0x0B,
 };
 
+/**
+ * @brief Logical block protection methods (Control Data Protection mode page)
+ */
+enum class LbpMethod : quint8 {
+    None            = 0x00,     ///< No protection information
+    ReedSolomonCrc  = 0x01,     ///< ECMA-319 Reed-Solomon CRC
+    Crc32c          = 0x02      ///< CRC32C (Castagnoli)
+};
+
 /**
  * @brief SCSI command direction
  */
@@ -114,6 +128,7 @@ struct LIBQLTFS_EXPORT ScsiSenseData {
     quint8 additionalSenseCode = 0;         ///< ASC
     quint8 additionalSenseCodeQualifier = 0; ///< ASCQ
     quint32 information = 0;
+    bool filemark = false;                  ///< A read or space stopped at a filemark
     QByteArray rawData;
 
     /**
@@ -153,7 +168,8 @@ struct LIBQLTFS_EXPORT ScsiCommandResult {
  *
  * Provides platform-independent interface for constructing and
  * executing SCSI commands. Platform-specific implementation is
- * selected at runtime.
+ * selected at runtime. Paths starting with "vtape:" are executed by
+ * the VirtualTape emulator instead of a real drive.
  */
 class LIBQLTFS_EXPORT ScsiCommand
 {
@@ -200,6 +216,16 @@ public:
      */
     int timeout() const;
 
+    /**
+     * @brief Get largest data transfer the host adapter accepts per command
+     *
+     * Queried from the driver (BLKSECTGET on Linux sg nodes,
+     * IOCTL_SCSI_GET_CAPABILITIES on Windows).
+     *
+     * @return Maximum transfer length in bytes, or 0 if unknown
+     */
+    quint32 maxTransferLength() const;
+
     // === SCSI Commands ===
 
     /**
@@ -244,6 +270,22 @@ public:
      */
     ScsiCommandResult modeSelect10(const QByteArray &data, bool savePages = false);
 
+    /**
+     * @brief Set logical block protection via the Control Data Protection mode page
+     *
+     * With @p protectWrite set, every block sent to the drive must be
+     * followed by PROTECTION_INFO_LENGTH bytes of protection information,
+     * which the drive checks before writing. With @p protectRead set, the
+     * drive appends the protection information to every block it returns.
+     * Transfer lengths in bytes grow accordingly; block lengths in the
+     * mode block descriptor do not.
+     *
+     * @param method Protection method (LbpMethod::None disables protection)
+     * @param protectWrite Set LBP_W
+     * @param protectRead Set LBP_R
+     */
+    ScsiCommandResult setDataProtection(LbpMethod method, bool protectWrite, bool protectRead);
+
     /**
      * @brief Log Sense - Get log pages
      * @param pageCode Log page code
@@ -304,6 +346,35 @@ public:
      */
     ScsiCommandResult write6(const QByteArray &data, bool fixedBlock = true);
 
+    /**
+     * @brief Read (6) into a caller-owned buffer
+     *
+     * The buffer is passed to the driver directly, without copying or
+     * clearing it; result.data stays empty. Page-aligned buffers allow
+     * the kernel to map them for direct I/O.
+     *
+     * @param buffer Destination buffer
+     * @param bufferSize Size of the buffer in bytes
+     * @param transferLength Blocks (fixed mode) or bytes (variable mode)
+     * @param fixedBlock Fixed block mode
+     */
+    ScsiCommandResult read6(char *buffer,
+                            quint32 bufferSize,
+                            quint32 transferLength,
+                            bool fixedBlock);
+
+    /**
+     * @brief Write (6) from a caller-owned buffer without copying it
+     * @param data Data to write
+     * @param length Number of bytes to write
+     * @param transferLength Blocks (fixed mode) or bytes (variable mode)
+     * @param fixedBlock Fixed block mode
+     */
+    ScsiCommandResult write6(const char *data,
+                             quint32 length,
+                             quint32 transferLength,
+                             bool fixedBlock);
+
     /**
      * @brief Write Filemarks
      * @param count Number of filemarks to write
@@ -326,16 +397,19 @@ public:
      * @param serviceAction Service action
      * @param attributeId Attribute ID to read
      * @param allocationLength Buffer size
+     * @param partition Partition whose partition-specific attributes are returned
      */
     ScsiCommandResult readAttribute(quint8 serviceAction,
                                     quint16 attributeId,
-                                    quint32 allocationLength = 16384);
+                                    quint32 allocationLength = 16384,
+                                    quint8 partition = 0);
 
     /**
      * @brief Write Attribute - Write MAM attributes
      * @param data Attribute data
+     * @param partition Partition the attributes are set for
      */
-    ScsiCommandResult writeAttribute(const QByteArray &data);
+    ScsiCommandResult writeAttribute(const QByteArray &data, quint8 partition = 0);
 
     /**
      * @brief Allow Overwrite - Allow data overwrite at current position
@@ -343,12 +417,57 @@ public:
      */
     ScsiCommandResult allowOverwrite(quint8 mode);
 
+    /**
+     * @brief Generate Recommended Access Order - Submit segments for reordering
+     * @param parameterList GRAO list header followed by UDS descriptors
+     */
+    ScsiCommandResult generateRecommendedAccessOrder(const QByteArray &parameterList);
+
+    /**
+     * @brief Receive Recommended Access Order - Read back the reordered segments
+     * @param allocationLength Buffer size
+     */
+    ScsiCommandResult receiveRecommendedAccessOrder(quint32 allocationLength);
+
     /**
      * @brief Prevent/Allow Medium Removal
      * @param prevent true to prevent, false to allow
      */
     ScsiCommandResult preventAllowMediumRemoval(bool prevent);
 
+    // === Medium changer commands (SMC-3) ===
+
+    /**
+     * @brief Read Element Status - Get the state of changer elements
+     * @param elementType Element type code (0=all, 1=transport, 2=storage, 3=I/E, 4=drive)
+     * @param startAddress First element address to report
+     * @param count Number of elements to report
+     * @param allocationLength Buffer size
+     * @param volumeTag Report volume tags (barcodes)
+     * @param deviceId Report device identifiers of drive elements (DVCID)
+     */
+    ScsiCommandResult readElementStatus(quint8 elementType,
+                                        quint16 startAddress,
+                                        quint16 count,
+                                        quint32 allocationLength,
+                                        bool volumeTag = true,
+                                        bool deviceId = true);
+
+    /**
+     * @brief Move Medium - Move a cartridge between two elements
+     * @param transportAddress Robot (medium transport element) to use
+     * @param sourceAddress Element holding the cartridge
+     * @param destinationAddress Empty element to move it to
+     */
+    ScsiCommandResult moveMedium(quint16 transportAddress,
+                                 quint16 sourceAddress,
+                                 quint16 destinationAddress);
+
+    /**
+     * @brief Initialize Element Status - Take a new inventory (barcode scan)
+     */
+    ScsiCommandResult initializeElementStatus();
+
     /**
      * @brief Format Medium - Format or partition tape
      * @param format Format type
@@ -377,6 +496,25 @@ public:
                                  QByteArray &data,
                                  quint32 dataLength);
 
+    /// Bytes of protection information per block for the CRC methods
+    static constexpr quint32 PROTECTION_INFO_LENGTH = 4;
+
+    // === CDB builders (shared with ScsiCommandQueue users) ===
+
+    /**
+     * @brief Build a Read (6) CDB
+     * @param transferLength Blocks (fixed mode) or bytes (variable mode, SILI set)
+     * @param fixedBlock Fixed block mode
+     */
+    static QByteArray read6Cdb(quint32 transferLength, bool fixedBlock);
+
+    /**
+     * @brief Build a Write (6) CDB
+     * @param transferLength Blocks (fixed mode) or bytes (variable mode)
+     * @param fixedBlock Fixed block mode
+     */
+    static QByteArray write6Cdb(quint32 transferLength, bool fixedBlock);
+
 private:
     class Private;
     Private *d;
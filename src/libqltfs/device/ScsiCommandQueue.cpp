@@ -0,0 +1,51 @@
+/*
+ * QLTOTapeMan - Qt-based LTO Tape Manager
+ * libqltfs - LTFS Core Library
+ *
+ * Copyright (c) 2026 Jeffrey ZHU (zhxsh1225@gmail.com)
+ * https://github.com/Gypsop/QLTOTapeMan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ScsiCommandQueue.h"
+#include "platform/VirtualTape.h"
+#include "platform/VirtualTapeQueue.h"
+
+#if defined(Q_OS_WIN)
+#include "platform/WinScsiQueue.h"
+#elif defined(Q_OS_LINUX)
+#include "platform/LinuxScsiQueue.h"
+#endif
+
+namespace qltfs {
+
+ScsiCommandQueue *ScsiCommandQueue::create(const QString &devicePath, int depth)
+{
+    if (VirtualTape::isVirtualPath(devicePath)) {
+        return new VirtualTapeQueue(devicePath, depth);
+    }
+
+#if defined(Q_OS_WIN)
+    return new WinScsiQueue(devicePath, depth);
+#elif defined(Q_OS_LINUX)
+    return new LinuxScsiQueue(devicePath, depth);
+#else
+    Q_UNUSED(devicePath)
+    Q_UNUSED(depth)
+    return nullptr;
+#endif
+}
+
+} // namespace qltfs
@@ -0,0 +1,143 @@
+/*
+ * QLTOTapeMan - Qt-based LTO Tape Manager
+ * libqltfs - LTFS Core Library
+ *
+ * Copyright (c) 2026 Jeffrey ZHU (zhxsh1225@gmail.com)
+ * https://github.com/Gypsop/QLTOTapeMan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "libqltfs_global.h"
+#include "device/ScsiCommand.h"
+
+#include <QByteArray>
+#include <QString>
+
+namespace qltfs {
+
+/**
+ * @brief Completion record returned by ScsiCommandQueue::reap()
+ */
+struct LIBQLTFS_EXPORT ScsiQueueCompletion {
+    quint64 tag = 0;                ///< Tag passed to submit()
+    ScsiCommandResult result;       ///< Status, sense data and byte count (data is not copied)
+};
+
+/**
+ * @brief Asynchronous SCSI command queue
+ *
+ * Keeps several commands in flight on one device so that per-command
+ * round-trip latency is hidden and the drive buffer stays full. Commands
+ * are submitted with a caller-chosen tag and reaped separately.
+ *
+ * Buffers passed to submit() are used in place and must stay valid and
+ * untouched until the matching completion has been reaped.
+ *
+ * Platform back ends:
+ * - Linux: sg driver write()/read() interface (LinuxScsiQueue)
+ * - Windows: overlapped pass-through on an I/O completion port (WinScsiQueue)
+ * - vtape: paths: worker thread on the emulated drive (VirtualTapeQueue)
+ *
+ * Not thread-safe: submit and reap from the same thread.
+ */
+class LIBQLTFS_EXPORT ScsiCommandQueue
+{
+public:
+    virtual ~ScsiCommandQueue() = default;
+
+    // Disable copy
+    ScsiCommandQueue(const ScsiCommandQueue &) = delete;
+    ScsiCommandQueue &operator=(const ScsiCommandQueue &) = delete;
+
+    /**
+     * @brief Open the device for queued command execution
+     */
+    virtual bool open() = 0;
+
+    /**
+     * @brief Close the device (outstanding commands are waited for)
+     */
+    virtual void close() = 0;
+
+    /**
+     * @brief Check if the queue is open
+     */
+    virtual bool isOpen() const = 0;
+
+    /**
+     * @brief Maximum number of commands in flight
+     */
+    virtual int depth() const = 0;
+
+    /**
+     * @brief Number of submitted commands not yet reaped
+     */
+    virtual int pending() const = 0;
+
+    /**
+     * @brief Submit a command without waiting for it
+     * @param tag Caller-chosen identifier echoed in the completion
+     * @param cdb Command Descriptor Block
+     * @param direction Data transfer direction
+     * @param buffer Data buffer (caller-owned, must outlive the command)
+     * @param length Buffer length in bytes
+     * @return false if the queue is full or submission failed
+     */
+    virtual bool submit(quint64 tag,
+                        const QByteArray &cdb,
+                        ScsiDataDirection direction,
+                        void *buffer,
+                        quint32 length) = 0;
+
+    /**
+     * @brief Wait for the next completed command
+     * @param completion Receives the tag and result
+     * @param timeoutMs Timeout in milliseconds (-1 = infinite)
+     * @return false on timeout, error, or if nothing is pending
+     */
+    virtual bool reap(ScsiQueueCompletion &completion, int timeoutMs = -1) = 0;
+
+    /**
+     * @brief Get last error message
+     */
+    virtual QString lastError() const = 0;
+
+    /**
+     * @brief Set command timeout in seconds
+     */
+    void setTimeout(int seconds) { m_timeoutSeconds = seconds; }
+
+    /**
+     * @brief Get command timeout in seconds
+     */
+    int timeout() const { return m_timeoutSeconds; }
+
+    /**
+     * @brief Create the queue implementation for the current platform
+     * @param devicePath Device path (tape or generic SCSI node)
+     * @param depth Requested number of commands in flight
+     * @return New queue (not yet opened), or nullptr if unsupported
+     */
+    static ScsiCommandQueue *create(const QString &devicePath, int depth);
+
+protected:
+    ScsiCommandQueue() = default;
+
+    int m_timeoutSeconds = 60;
+};
+
+} // namespace qltfs
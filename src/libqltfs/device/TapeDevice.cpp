@@ -20,10 +20,17 @@
  */
 
 #include "TapeDevice.h"
+#include "io/HashKernels.h"
 
 #include <QDebug>
 #include <QThread>
 #include <QElapsedTimer>
+#include <QHash>
+#include <QQueue>
+#include <QVector>
+#include <QtEndian>
+
+#include <cstring>
 
 namespace qltfs {
 
@@ -46,12 +53,39 @@ static constexpr quint8 LOG_PAGE_TAPE_CAPACITY = 0x31;
 static constexpr quint8 LOG_PAGE_DATA_COMPRESSION = 0x1B;
 static constexpr quint8 LOG_PAGE_TAPE_USAGE = 0x30;
 
+// READ POSITION service actions
+static constexpr quint8 READ_POSITION_EXTENDED = 0x08;
+
 // Mode page codes
 static constexpr quint8 MODE_PAGE_CONTROL = 0x0A;
+static constexpr quint8 MODE_SUBPAGE_DATA_PROTECTION = 0xF0;
 static constexpr quint8 MODE_PAGE_DATA_COMPRESSION = 0x0F;
 static constexpr quint8 MODE_PAGE_DEVICE_CONFIG = 0x10;
 static constexpr quint8 MODE_PAGE_MEDIUM_PARTITION = 0x11;
 
+// Per-command transfer limit assumed when the host adapter cannot be queried
+static constexpr quint32 MAX_TRANSFER_FALLBACK = 4 * 1024 * 1024;
+
+// Recommended Access Order parameter lists
+static constexpr int RAO_HEADER_SIZE = 8;
+static constexpr int RAO_DESCRIPTOR_SIZE = 32;
+static constexpr int RAO_NAME_OFFSET = 3;
+static constexpr int RAO_NAME_LENGTH = 10;
+static constexpr int RAO_MAX_SEGMENTS = 2048;
+
+// MAM attributes identifying a volume without moving the tape
+static constexpr quint16 MAM_VOLUME_CHANGE_REFERENCE = 0x0009;
+static constexpr quint16 MAM_MEDIUM_SERIAL_NUMBER = 0x0401;
+static constexpr quint16 MAM_BARCODE = 0x0806;
+static constexpr quint16 MAM_VOLUME_COHERENCY_INFO = 0x080C;
+
+// Attribute header: id (2), format (1), length (2)
+static constexpr int MAM_ATTRIBUTE_HEADER = 5;
+
+// Application client part of LTFS coherency info: "LTFS\0", UUID text + NUL, version
+static constexpr int LTFS_COHERENCY_NAME_LENGTH = 5;
+static constexpr int LTFS_COHERENCY_UUID_LENGTH = 37;
+
 // ============================================================================
 // TapeMediaInfo Implementation
 // ============================================================================
@@ -64,6 +98,16 @@ QString TapeMediaInfo::formatString() const
         .arg(formatSize(remainingCapacity));
 }
 
+// ============================================================================
+// TapeVolumeIdentity Implementation
+// ============================================================================
+
+bool TapeVolumeIdentity::isCurrent() const
+{
+    return hasCoherency && !volumeUuid.isNull() && volumeChangeReference != 0 &&
+           coherencyChangeReference == volumeChangeReference;
+}
+
 // ============================================================================
 // TapeLogData Implementation
 // ============================================================================
@@ -73,6 +117,22 @@ bool TapeLogData::isValid() const
     return totalBytesWritten > 0 || totalBytesRead > 0 || loadCount > 0;
 }
 
+double TapeLogData::writeCompressionRatio() const
+{
+    if (hostBytesWritten == 0 || tapeBytesWritten == 0) {
+        return 1.0;
+    }
+    return static_cast<double>(hostBytesWritten) / static_cast<double>(tapeBytesWritten);
+}
+
+double TapeLogData::readCompressionRatio() const
+{
+    if (hostBytesRead == 0 || tapeBytesRead == 0) {
+        return 1.0;
+    }
+    return static_cast<double>(hostBytesRead) / static_cast<double>(tapeBytesRead);
+}
+
 // ============================================================================
 // TapeDevice Private Implementation
 // ============================================================================
@@ -89,20 +149,109 @@ public:
     TapeLogData logData;
     BlockLimits blockLimits;
     TapePosition position;
+    bool positionValid = false;     ///< position reflects the drive
+    bool atEndOfData = false;       ///< Head known to be at end of data
+    bool raoSupported = true;       ///< Cleared when the drive rejects RAO
 
     quint32 currentBlockSize = DEFAULT_BLOCK_SIZE;
+    bool fixedBlockMode = false;    ///< Drive block length set to currentBlockSize
     bool compressionEnabled = true;
+    bool compressionKnown = false;  ///< compressionEnabled was set on the drive by us
+    bool blockProtection = false;   ///< CRC32C appended on write and checked on read
+    QByteArray protectedData;       ///< Blocks with their CRCs for synchronous transfers
+    QVector<QByteArray> spareBuffers;   ///< Recycled transfer buffers of queued commands
 
     QString lastError;
     ScsiSenseData lastSenseData;
 
+    /**
+     * @brief Bookkeeping for a command submitted to the queue
+     */
+    struct QueuedCommand {
+        quint32 blocks = 0;         ///< Blocks the position advances by on success
+        bool write = false;
+        quint32 blockSize = 0;      ///< Data bytes per block (0 = one variable-length block)
+        QByteArray protectedData;   ///< Transfer buffer with CRCs (block protection only)
+        char *readBuffer = nullptr; ///< Caller buffer the checked data is copied to
+        quint32 length = 0;         ///< Data bytes of the command, without CRCs
+    };
+
+    QScopedPointer<ScsiCommandQueue> queue;     ///< Set while asynchronous I/O is active
+    int requestedQueueDepth = 1;
+    QHash<quint64, QueuedCommand> inFlight;     ///< Submitted to the queue, keyed by tag
+    QQueue<TapeCompletion> completed;           ///< Finished, not yet reaped by the caller
+
     QString densityCodeToString(quint8 code) const;
     bool parsePositionData(const QByteArray &data);
     bool parseBlockLimits(const QByteArray &data);
     bool parseMediaInfo(ScsiCommand *scsi);
     bool parseLogData(ScsiCommand *scsi);
+    bool parseCompressionLog(ScsiCommand *scsi);
+
+    quint32 protectedLength(quint32 length, quint32 blockSize) const;
+    void protectBlocks(char *dest, const char *data, quint32 length, quint32 blockSize) const;
+    qint64 unprotectBlocks(char *dest, quint32 destSize, const char *data, quint32 transferred,
+                           quint32 blockSize, QString &error) const;
+    QByteArray takeSpareBuffer(quint32 size);
 };
 
+quint32 TapeDevice::Private::protectedLength(quint32 length, quint32 blockSize) const
+{
+    const quint32 crcSize = ScsiCommand::PROTECTION_INFO_LENGTH;
+    return blockSize > 0 ? length / blockSize * (blockSize + crcSize) : length + crcSize;
+}
+
+void TapeDevice::Private::protectBlocks(char *dest, const char *data, quint32 length, quint32 blockSize) const
+{
+    // Each block is followed by its CRC32C, least significant byte first
+    const quint32 crcSize = ScsiCommand::PROTECTION_INFO_LENGTH;
+    quint32 step = blockSize > 0 ? blockSize : length;
+    quint32 blocks = blockSize > 0 ? length / blockSize : 1;
+    for (quint32 i = 0; i < blocks; ++i) {
+        quint32 crc = Crc32c::extend(0, data, step);
+        memcpy(dest, data, step);
+        qToLittleEndian(crc, dest + step);
+        data += step;
+        dest += step + crcSize;
+    }
+}
+
+qint64 TapeDevice::Private::unprotectBlocks(char *dest, quint32 destSize, const char *data,
+                                            quint32 transferred, quint32 blockSize, QString &error) const
+{
+    const quint32 crcSize = ScsiCommand::PROTECTION_INFO_LENGTH;
+    if (transferred < crcSize) {
+        error = QStringLiteral("block of %1 bytes has no protection information").arg(transferred);
+        return -1;
+    }
+
+    quint32 step = blockSize > 0 ? blockSize : transferred - crcSize;
+    quint32 blocks = transferred / (step + crcSize);
+    if (static_cast<quint64>(blocks) * step > destSize) {
+        error = QStringLiteral("block larger than the buffer");
+        return -1;
+    }
+
+    for (quint32 i = 0; i < blocks; ++i) {
+        const char *block = data + static_cast<size_t>(i) * (step + crcSize);
+        quint32 expected = qFromLittleEndian<quint32>(block + step);
+        if (Crc32c::extend(0, block, step) != expected) {
+            error = QStringLiteral("CRC32C mismatch in block %1").arg(position.blockNumber + i);
+            return -1;
+        }
+        memcpy(dest + static_cast<size_t>(i) * step, block, step);
+    }
+
+    return static_cast<qint64>(blocks) * step;
+}
+
+QByteArray TapeDevice::Private::takeSpareBuffer(quint32 size)
+{
+    QByteArray buffer = spareBuffers.isEmpty() ? QByteArray() : spareBuffers.takeLast();
+    buffer.resize(static_cast<int>(size));
+    return buffer;
+}
+
 QString TapeDevice::Private::densityCodeToString(quint8 code) const
 {
     switch (code) {
@@ -320,6 +469,52 @@ bool TapeDevice::Private::parseLogData(ScsiCommand *scsi)
         }
     }
 
+    parseCompressionLog(scsi);
+
+    return true;
+}
+
+bool TapeDevice::Private::parseCompressionLog(ScsiCommand *scsi)
+{
+    auto result = scsi->logSense(LOG_PAGE_DATA_COMPRESSION, 0, 256);
+    if (!result.success || result.data.size() < 8) {
+        return false;
+    }
+
+    const quint8 *data = reinterpret_cast<const quint8 *>(result.data.constData());
+    int offset = 4;
+
+    // Each counter is split into whole MiB and the remaining bytes
+    quint64 counters[10] = {};
+    while (offset + 4 <= result.data.size()) {
+        quint16 paramCode = (static_cast<quint16>(data[offset]) << 8) | data[offset + 1];
+        quint8 paramLen = data[offset + 3];
+
+        if (offset + 4 + paramLen > result.data.size()) {
+            break;
+        }
+
+        quint64 value = 0;
+        for (int i = 0; i < qMin(static_cast<int>(paramLen), 8); ++i) {
+            value = (value << 8) | data[offset + 4 + i];
+        }
+
+        // 0002h/0003h to host, 0004h/0005h from tape,
+        // 0006h/0007h from host, 0008h/0009h to tape
+        if (paramCode < 10) {
+            counters[paramCode] = value;
+        }
+
+        offset += 4 + paramLen;
+    }
+
+    auto total = [&counters](int mib) {
+        return counters[mib] * 1024 * 1024 + counters[mib + 1];
+    };
+    logData.hostBytesRead = total(2);
+    logData.tapeBytesRead = total(4);
+    logData.hostBytesWritten = total(6);
+    logData.tapeBytesWritten = total(8);
     return true;
 }
 
@@ -366,16 +561,31 @@ bool TapeDevice::open()
 
     // Get initial status
     refreshStatus();
+    refreshPosition();
+
+    if (d->requestedQueueDepth > 1) {
+        setQueueDepth(d->requestedQueueDepth);
+    }
 
     return true;
 }
 
 void TapeDevice::close()
 {
+    // Waits for outstanding commands before the buffers go away
+    d->queue.reset();
+    d->inFlight.clear();
+    d->completed.clear();
+
     if (d->scsi) {
         d->scsi->close();
         d->scsi.reset();
         d->status = TapeStatus::Unknown;
+        d->fixedBlockMode = false;
+        d->compressionKnown = false;
+        d->positionValid = false;
+        d->atEndOfData = false;
+        d->raoSupported = true;
         emit openChanged(false);
     }
 }
@@ -400,6 +610,9 @@ void TapeDevice::setTimeout(int seconds)
     if (d->scsi) {
         d->scsi->setTimeout(seconds);
     }
+    if (d->queue) {
+        d->queue->setTimeout(seconds);
+    }
 }
 
 int TapeDevice::timeout() const
@@ -518,6 +731,79 @@ bool TapeDevice::refreshLogData()
     return d->parseLogData(d->scsi.data());
 }
 
+bool TapeDevice::readLogParameters(quint8 pageCode, QHash<quint16, quint64> &parameters, quint8 subPageCode)
+{
+    if (!checkOpen("readLogParameters")) {
+        return false;
+    }
+
+    auto result = d->scsi->logSense(pageCode, subPageCode, 4096);
+    d->lastSenseData = result.senseData;
+    if (!result.success || result.data.size() < 4) {
+        setQueryError(QStringLiteral("Log sense failed: %1").arg(result.errorMessage()));
+        return false;
+    }
+
+    const quint8 *data = reinterpret_cast<const quint8 *>(result.data.constData());
+    const int pageLength = qMin(result.data.size(), 4 + ((static_cast<int>(data[2]) << 8) | data[3]));
+    int offset = 4;
+
+    parameters.clear();
+    while (offset + 4 <= pageLength) {
+        quint16 paramCode = (static_cast<quint16>(data[offset]) << 8) | data[offset + 1];
+        quint8 paramLen = data[offset + 3];
+
+        if (offset + 4 + paramLen > pageLength) {
+            break;
+        }
+
+        quint64 value = 0;
+        for (int i = 0; i < qMin(static_cast<int>(paramLen), 8); ++i) {
+            value = (value << 8) | data[offset + 4 + i];
+        }
+        parameters.insert(paramCode, value);
+
+        offset += 4 + paramLen;
+    }
+
+    return true;
+}
+
+bool TapeDevice::readBufferStatus(TapeBufferStatus &status)
+{
+    if (!checkOpen("readBufferStatus")) {
+        return false;
+    }
+
+    auto result = d->scsi->readPosition(READ_POSITION_EXTENDED);
+    d->lastSenseData = result.senseData;
+    if (!result.success || result.data.size() < 32) {
+        setQueryError(QStringLiteral("Read position failed: %1").arg(result.errorMessage()));
+        return false;
+    }
+
+    // Extended form: objects in buffer at bytes 5-7, bytes in buffer at 24-31
+    const quint8 *bytes = reinterpret_cast<const quint8 *>(result.data.constData());
+    status.objects = (static_cast<quint32>(bytes[5]) << 16) |
+                     (static_cast<quint32>(bytes[6]) << 8) |
+                     static_cast<quint32>(bytes[7]);
+    status.bytes = qFromBigEndian<quint64>(bytes + 24);
+    return true;
+}
+
+bool TapeDevice::refreshCompressionData()
+{
+    if (!checkOpen("refreshCompressionData")) {
+        return false;
+    }
+
+    if (!d->parseCompressionLog(d->scsi.data())) {
+        setQueryError(QStringLiteral("Failed to read data compression log page"));
+        return false;
+    }
+    return true;
+}
+
 BlockLimits TapeDevice::blockLimits() const
 {
     return d->blockLimits;
@@ -528,6 +814,59 @@ TapePosition TapeDevice::position() const
     return d->position;
 }
 
+bool TapeDevice::isPositionKnown() const
+{
+    return d->positionValid;
+}
+
+bool TapeDevice::refreshPosition()
+{
+    if (!checkOpen("refreshPosition")) {
+        return false;
+    }
+
+    auto result = d->scsi->readPosition(0);  // Short form
+    d->lastSenseData = result.senseData;
+
+    if (!result.success || !d->parsePositionData(result.data)) {
+        d->positionValid = false;
+        d->atEndOfData = false;
+        d->lastError = QStringLiteral("Read position failed: %1").arg(result.errorMessage());
+        return false;
+    }
+
+    d->positionValid = !d->position.blockPositionUnknown;
+    return d->positionValid;
+}
+
+bool TapeDevice::verifyPosition()
+{
+    TapePosition cached = d->position;
+    bool wasValid = d->positionValid;
+
+    if (!refreshPosition()) {
+        return false;
+    }
+
+    bool matches = wasValid &&
+                   cached.partition == d->position.partition &&
+                   cached.blockNumber == d->position.blockNumber;
+    if (!matches) {
+        if (wasValid) {
+            qWarning() << "TapeDevice: cached position" << cached.partition << cached.blockNumber
+                       << "does not match drive position" << d->position.partition << d->position.blockNumber;
+        }
+        d->atEndOfData = false;
+    }
+
+    return matches;
+}
+
+bool TapeDevice::isAtEndOfData() const
+{
+    return d->positionValid && d->atEndOfData;
+}
+
 bool TapeDevice::load(bool wait)
 {
     if (!checkOpen("load")) {
@@ -543,8 +882,12 @@ bool TapeDevice::load(bool wait)
         return false;
     }
 
+    d->positionValid = false;
+    d->atEndOfData = false;
+
     if (wait) {
         refreshStatus();
+        refreshPosition();
     }
 
     return true;
@@ -565,6 +908,9 @@ bool TapeDevice::unload(bool wait)
         return false;
     }
 
+    d->positionValid = false;
+    d->atEndOfData = false;
+
     if (wait) {
         setStatus(TapeStatus::NoMedia);
     }
@@ -587,8 +933,12 @@ bool TapeDevice::rewind(bool wait)
         return false;
     }
 
+    d->atEndOfData = false;
+    d->positionValid = wait;
+
     if (wait) {
         setStatus(TapeStatus::Ready);
+        d->position.partition = 0;
         d->position.blockNumber = 0;
         d->position.fileNumber = 0;
         d->position.beginOfPartition = true;
@@ -638,6 +988,11 @@ bool TapeDevice::locate(quint8 partition, quint64 blockNumber)
         return false;
     }
 
+    // Reading in tape order often finds the head already in place
+    if (d->positionValid && d->position.partition == partition && d->position.blockNumber == blockNumber) {
+        return true;
+    }
+
     setStatus(TapeStatus::Locating);
     auto result = d->scsi->locate16(partition, blockNumber);
     d->lastSenseData = result.senseData;
@@ -650,6 +1005,8 @@ bool TapeDevice::locate(quint8 partition, quint64 blockNumber)
 
     d->position.partition = partition;
     d->position.blockNumber = blockNumber;
+    d->positionValid = true;
+    d->atEndOfData = false;
     setStatus(TapeStatus::Ready);
 
     return true;
@@ -670,6 +1027,7 @@ bool TapeDevice::spaceBlocks(qint32 count)
     }
 
     d->position.blockNumber += count;
+    d->atEndOfData = false;
 
     return true;
 }
@@ -688,11 +1046,43 @@ bool TapeDevice::spaceFilemarks(qint32 count)
         return false;
     }
 
+    // The number of blocks skipped is unknown
     d->position.fileNumber += count;
+    d->positionValid = false;
+    d->atEndOfData = false;
 
     return true;
 }
 
+qint64 TapeDevice::readThrough(quint64 blockNumber, char *buffer, quint32 bufferSize)
+{
+    if (!checkOpen("readThrough")) {
+        return -1;
+    }
+    if (!d->positionValid || blockNumber < d->position.blockNumber) {
+        setError(QStringLiteral("Read through failed: target is not ahead of a known position"));
+        return -1;
+    }
+
+    setStatus(TapeStatus::Reading);
+    qint64 discarded = 0;
+    while (d->position.blockNumber < blockNumber) {
+        qint64 bytesRead = readBlock(buffer, bufferSize);
+        if (bytesRead < 0 || (bytesRead == 0 && d->atEndOfData)) {
+            if (bytesRead == 0) {
+                setError(QStringLiteral("Read through failed: end of data before block %1").arg(blockNumber));
+            }
+            d->positionValid = false;
+            refreshStatus();
+            return -1;
+        }
+        discarded += bytesRead;
+    }
+    setStatus(TapeStatus::Ready);
+
+    return discarded;
+}
+
 bool TapeDevice::spaceToEndOfData()
 {
     if (!checkOpen("spaceToEndOfData")) {
@@ -707,11 +1097,89 @@ bool TapeDevice::spaceToEndOfData()
         return false;
     }
 
-    d->position.endOfPartition = true;
+    // One READ POSITION makes the cache authoritative for the appends
+    // that follow
+    refreshPosition();
+    d->atEndOfData = true;
 
     return true;
 }
 
+QList<int> TapeDevice::recommendedAccessOrder(const QList<TapeSegment> &segments)
+{
+    QList<int> order;
+
+    if (segments.isEmpty() || segments.size() > RAO_MAX_SEGMENTS || !d->raoSupported) {
+        return order;
+    }
+
+    if (!checkOpen("recommendedAccessOrder")) {
+        return order;
+    }
+
+    auto putBigEndian = [](char *dest, quint64 value, int bytes) {
+        for (int i = bytes - 1; i >= 0; --i) {
+            dest[i] = static_cast<char>(value & 0xFF);
+            value >>= 8;
+        }
+    };
+
+    // GRAO parameter list: header, then one user data segment (UDS)
+    // descriptor per segment, named by its index
+    QByteArray list(RAO_HEADER_SIZE + segments.size() * RAO_DESCRIPTOR_SIZE, 0);
+    putBigEndian(list.data() + 4, static_cast<quint64>(list.size() - RAO_HEADER_SIZE), 4);
+
+    for (int i = 0; i < segments.size(); ++i) {
+        char *desc = list.data() + RAO_HEADER_SIZE + i * RAO_DESCRIPTOR_SIZE;
+        putBigEndian(desc, RAO_DESCRIPTOR_SIZE - 2, 2);  // Descriptor length
+
+        QByteArray name = QByteArray::number(i).rightJustified(RAO_NAME_LENGTH, '0');
+        memcpy(desc + RAO_NAME_OFFSET, name.constData(), RAO_NAME_LENGTH);
+
+        desc[13] = static_cast<char>(segments[i].partition);
+        putBigEndian(desc + 14, segments[i].firstBlock, 8);
+        putBigEndian(desc + 22, segments[i].lastBlock, 8);
+    }
+
+    auto result = d->scsi->generateRecommendedAccessOrder(list);
+    if (result.success) {
+        result = d->scsi->receiveRecommendedAccessOrder(static_cast<quint32>(list.size()));
+    }
+    d->lastSenseData = result.senseData;
+
+    if (!result.success) {
+        if (result.senseData.senseKey == ScsiSenseKey::IllegalRequest) {
+            qDebug() << "TapeDevice: drive does not support Recommended Access Order";
+            d->raoSupported = false;
+        }
+        return order;
+    }
+
+    // RRAO returns the same descriptors in the recommended order
+    const QByteArray &data = result.data;
+    QVector<bool> seen(segments.size(), false);
+    for (int offset = RAO_HEADER_SIZE; offset + RAO_DESCRIPTOR_SIZE <= data.size(); offset += RAO_DESCRIPTOR_SIZE) {
+        bool ok = false;
+        int index = data.mid(offset + RAO_NAME_OFFSET, RAO_NAME_LENGTH).toInt(&ok);
+        if (ok && index >= 0 && index < segments.size() && !seen[index]) {
+            seen[index] = true;
+            order.append(index);
+        }
+    }
+
+    // A partial answer is not safe to use
+    if (order.size() != segments.size()) {
+        order.clear();
+    }
+
+    return order;
+}
+
+int TapeDevice::maxAccessOrderSegments()
+{
+    return RAO_MAX_SEGMENTS;
+}
+
 bool TapeDevice::seekToBeginning(quint8 partition)
 {
     return locate(partition, 0);
@@ -719,45 +1187,108 @@ bool TapeDevice::seekToBeginning(quint8 partition)
 
 bool TapeDevice::seekToEnd(quint8 partition)
 {
+    // Appending right after the previous write needs no repositioning
+    if (isAtEndOfData() && d->position.partition == partition) {
+        return true;
+    }
+
     if (!locate(partition, 0)) {
         return false;
     }
     return spaceToEndOfData();
 }
 
+bool TapeDevice::locateForOverwrite(quint8 partition, quint64 blockNumber)
+{
+    if (!locate(partition, blockNumber) || !allowOverwrite()) {
+        return false;
+    }
+
+    // Writing here truncates the partition, so this is the append point
+    d->atEndOfData = true;
+    return true;
+}
+
 qint64 TapeDevice::readBlock(QByteArray &data, quint32 maxSize)
+{
+    data.resize(static_cast<int>(maxSize));
+    qint64 bytesRead = readBlock(data.data(), maxSize);
+    data.resize(bytesRead > 0 ? static_cast<int>(bytesRead) : 0);
+    return bytesRead;
+}
+
+qint64 TapeDevice::writeBlock(const QByteArray &data)
+{
+    return writeBlock(data.constData(), static_cast<quint32>(data.size()));
+}
+
+qint64 TapeDevice::readBlock(char *buffer, quint32 maxSize)
 {
     if (!checkOpen("readBlock")) {
         return -1;
     }
 
-    data.resize(static_cast<int>(maxSize));
-    auto result = d->scsi->read6(data, 1, false);  // Variable block mode
+    ScsiCommandResult result;
+    if (d->blockProtection) {
+        quint32 transferLength = d->protectedLength(maxSize, 0);
+        d->protectedData.resize(static_cast<int>(transferLength));
+        result = d->scsi->read6(d->protectedData.data(), transferLength, transferLength, false);
+    } else {
+        result = d->scsi->read6(buffer, maxSize, maxSize, false);  // Variable block mode
+    }
     d->lastSenseData = result.senseData;
 
     if (!result.success) {
         // Check for blank check (end of data)
         if (result.senseData.senseKey == ScsiSenseKey::BlankCheck) {
+            d->atEndOfData = true;
             return 0;  // EOF
         }
+        // A filemark is a logical object of its own; the drive is now past it
+        if (result.senseData.filemark && result.senseData.senseKey == ScsiSenseKey::NoSense) {
+            d->position.blockNumber++;
+            d->position.fileNumber++;
+            d->atEndOfData = false;
+            return 0;
+        }
         setError(QStringLiteral("Read failed: %1").arg(result.errorMessage()));
         return -1;
     }
 
-    data = result.data;
+    qint64 bytesRead = static_cast<qint64>(result.bytesTransferred);
+    QString protectionError;
+    if (d->blockProtection) {
+        bytesRead = d->unprotectBlocks(buffer, maxSize, d->protectedData.constData(),
+                                       result.bytesTransferred, 0, protectionError);
+    }
+
     d->position.blockNumber++;
+    d->atEndOfData = false;
 
-    return data.size();
+    if (bytesRead < 0) {
+        setError(QStringLiteral("Read failed: %1").arg(protectionError));
+        return -1;
+    }
+
+    return bytesRead;
 }
 
-qint64 TapeDevice::writeBlock(const QByteArray &data)
+qint64 TapeDevice::writeBlock(const char *data, quint32 length)
 {
     if (!checkOpen("writeBlock")) {
         return -1;
     }
 
     setStatus(TapeStatus::Writing);
-    auto result = d->scsi->write6(data, false);  // Variable block mode
+    ScsiCommandResult result;
+    if (d->blockProtection) {
+        quint32 transferLength = d->protectedLength(length, 0);
+        d->protectedData.resize(static_cast<int>(transferLength));
+        d->protectBlocks(d->protectedData.data(), data, length, 0);
+        result = d->scsi->write6(d->protectedData.constData(), transferLength, transferLength, false);
+    } else {
+        result = d->scsi->write6(data, length, length, false);  // Variable block mode
+    }
     d->lastSenseData = result.senseData;
 
     if (!result.success) {
@@ -766,47 +1297,103 @@ qint64 TapeDevice::writeBlock(const QByteArray &data)
         return -1;
     }
 
+    // A write always leaves the head at the new end of data
     d->position.blockNumber++;
+    d->atEndOfData = true;
     setStatus(TapeStatus::Ready);
 
-    return static_cast<qint64>(result.bytesTransferred);
+    return d->blockProtection ? static_cast<qint64>(length) : static_cast<qint64>(result.bytesTransferred);
 }
 
 qint64 TapeDevice::readBlocks(QByteArray &data, quint32 blockCount, quint32 blockSize)
+{
+    data.resize(static_cast<int>(blockCount * blockSize));
+    qint64 bytesRead = readBlocks(data.data(), blockCount, blockSize);
+    data.resize(bytesRead > 0 ? static_cast<int>(bytesRead) : 0);
+    return bytesRead;
+}
+
+qint64 TapeDevice::writeBlocks(const QByteArray &data, quint32 blockSize)
+{
+    if (blockSize == 0) {
+        setError(QStringLiteral("Write blocks failed: invalid block size"));
+        return -1;
+    }
+
+    quint32 blockCount = static_cast<quint32>(data.size()) / blockSize;
+    return writeBlocks(data.constData(), blockCount, blockSize);
+}
+
+qint64 TapeDevice::readBlocks(char *buffer, quint32 blockCount, quint32 blockSize)
 {
     if (!checkOpen("readBlocks")) {
         return -1;
     }
 
-    // Set block size for fixed block mode
-    data.resize(static_cast<int>(blockCount * blockSize));
-    auto result = d->scsi->read6(data, blockCount, true);  // Fixed block mode
+    // Fixed block mode needs the drive's block length to match
+    if ((!d->fixedBlockMode || d->currentBlockSize != blockSize) && !setBlockSize(blockSize)) {
+        return -1;
+    }
+
+    ScsiCommandResult result;
+    if (d->blockProtection) {
+        quint32 transferLength = d->protectedLength(blockCount * blockSize, blockSize);
+        d->protectedData.resize(static_cast<int>(transferLength));
+        result = d->scsi->read6(d->protectedData.data(), transferLength, blockCount, true);
+    } else {
+        result = d->scsi->read6(buffer, blockCount * blockSize, blockCount, true);
+    }
     d->lastSenseData = result.senseData;
 
     if (!result.success) {
         if (result.senseData.senseKey == ScsiSenseKey::BlankCheck) {
+            d->atEndOfData = true;
             return 0;
         }
         setError(QStringLiteral("Read blocks failed: %1").arg(result.errorMessage()));
         return -1;
     }
 
-    data = result.data;
+    qint64 bytesRead = static_cast<qint64>(result.bytesTransferred);
+    QString protectionError;
+    if (d->blockProtection) {
+        bytesRead = d->unprotectBlocks(buffer, blockCount * blockSize, d->protectedData.constData(),
+                                       result.bytesTransferred, blockSize, protectionError);
+    }
+
     d->position.blockNumber += blockCount;
+    d->atEndOfData = false;
 
-    return data.size();
+    if (bytesRead < 0) {
+        setError(QStringLiteral("Read blocks failed: %1").arg(protectionError));
+        return -1;
+    }
+
+    return bytesRead;
 }
 
-qint64 TapeDevice::writeBlocks(const QByteArray &data, quint32 blockSize)
+qint64 TapeDevice::writeBlocks(const char *data, quint32 blockCount, quint32 blockSize)
 {
     if (!checkOpen("writeBlocks")) {
         return -1;
     }
 
-    quint32 blockCount = static_cast<quint32>(data.size()) / blockSize;
+    // Fixed block mode needs the drive's block length to match
+    if ((!d->fixedBlockMode || d->currentBlockSize != blockSize) && !setBlockSize(blockSize)) {
+        return -1;
+    }
 
     setStatus(TapeStatus::Writing);
-    auto result = d->scsi->write6(data, true);  // Fixed block mode
+    quint32 length = blockCount * blockSize;
+    ScsiCommandResult result;
+    if (d->blockProtection) {
+        quint32 transferLength = d->protectedLength(length, blockSize);
+        d->protectedData.resize(static_cast<int>(transferLength));
+        d->protectBlocks(d->protectedData.data(), data, length, blockSize);
+        result = d->scsi->write6(d->protectedData.constData(), transferLength, blockCount, true);
+    } else {
+        result = d->scsi->write6(data, length, blockCount, true);
+    }
     d->lastSenseData = result.senseData;
 
     if (!result.success) {
@@ -816,9 +1403,270 @@ qint64 TapeDevice::writeBlocks(const QByteArray &data, quint32 blockSize)
     }
 
     d->position.blockNumber += blockCount;
+    d->atEndOfData = true;
     setStatus(TapeStatus::Ready);
 
-    return static_cast<qint64>(result.bytesTransferred);
+    return d->blockProtection ? static_cast<qint64>(length) : static_cast<qint64>(result.bytesTransferred);
+}
+
+quint32 TapeDevice::maxBlocksPerCommand(quint32 blockSize, quint32 requested) const
+{
+    if (blockSize == 0 || requested <= 1 || !isOpen()) {
+        return 1;
+    }
+
+    // Fixed mode is only possible for block sizes the drive accepts
+    const BlockLimits &limits = d->blockLimits;
+    if (limits.maxBlockLength > 0 &&
+        (blockSize > limits.maxBlockLength || blockSize < limits.minBlockLength)) {
+        return 1;
+    }
+    if (limits.granularity > 0 && (blockSize % (1u << limits.granularity)) != 0) {
+        return 1;
+    }
+
+    // Stay within the host adapter transfer limit; if it cannot be
+    // queried, assume the largest LTFS block size is safe
+    quint32 maxTransfer = d->scsi->maxTransferLength();
+    if (maxTransfer == 0) {
+        maxTransfer = MAX_TRANSFER_FALLBACK;
+    }
+
+    // Protected blocks carry their CRC in the same transfer
+    quint32 transferBlockSize = blockSize + (d->blockProtection ? ScsiCommand::PROTECTION_INFO_LENGTH : 0);
+    quint32 count = qMin(requested, maxTransfer / transferBlockSize);
+    // The Write(6)/Read(6) transfer length field is 24 bits
+    count = qMin(count, 0xFFFFFFu);
+    return qMax(1u, count);
+}
+
+bool TapeDevice::setQueueDepth(int depth)
+{
+    d->requestedQueueDepth = qMax(1, depth);
+
+    drainQueue();
+    d->queue.reset();
+
+    if (d->requestedQueueDepth <= 1 || !isOpen()) {
+        return false;
+    }
+
+    // The asynchronous interface is only offered by the generic SCSI node
+    const QString path = d->deviceInfo.genericPath.isEmpty() ? d->devicePath : d->deviceInfo.genericPath;
+    QScopedPointer<ScsiCommandQueue> queue(ScsiCommandQueue::create(path, d->requestedQueueDepth));
+    if (!queue) {
+        return false;
+    }
+
+    queue->setTimeout(d->scsi->timeout());
+    if (!queue->open()) {
+        qWarning() << "TapeDevice: command queue unavailable, using synchronous I/O:" << queue->lastError();
+        return false;
+    }
+
+    d->queue.reset(queue.take());
+    return true;
+}
+
+int TapeDevice::queueDepth() const
+{
+    return d->queue ? d->queue->depth() : 1;
+}
+
+bool TapeDevice::isQueued() const
+{
+    return !d->queue.isNull();
+}
+
+bool TapeDevice::submitWrite(quint64 tag, const char *data, quint32 length, quint32 blockSize)
+{
+    if (!isOpen()) {
+        d->lastError = QStringLiteral("Device not open for operation: submitWrite");
+        return false;
+    }
+
+    if (blockSize > 0 && (length == 0 || length % blockSize != 0)) {
+        setError(QStringLiteral("Queued write failed: length %1 is not a multiple of block size %2")
+                     .arg(length).arg(blockSize));
+        return false;
+    }
+
+    if (!d->queue) {
+        // Synchronous fallback, reported like a queued command
+        qint64 written = blockSize > 0 ? writeBlocks(data, length / blockSize, blockSize)
+                                       : writeBlock(data, length);
+        TapeCompletion completion;
+        completion.tag = tag;
+        completion.success = written >= 0;
+        completion.bytesTransferred = written > 0 ? static_cast<quint32>(written) : 0;
+        completion.senseData = d->lastSenseData;
+        if (!completion.success) {
+            completion.error = d->lastError;
+        }
+        d->completed.enqueue(completion);
+        return true;
+    }
+
+    if (d->inFlight.contains(tag)) {
+        setError(QStringLiteral("Queued write failed: tag %1 already pending").arg(tag));
+        return false;
+    }
+
+    // Switching the block length is a synchronous command and drains the queue
+    bool fixed = blockSize > 0;
+    if (fixed && (!d->fixedBlockMode || d->currentBlockSize != blockSize) && !setBlockSize(blockSize)) {
+        return false;
+    }
+
+    while (d->queue->pending() >= d->queue->depth()) {
+        TapeCompletion completion;
+        if (!reapQueued(completion, -1)) {
+            return false;
+        }
+        d->completed.enqueue(completion);
+    }
+
+    quint32 blocks = fixed ? length / blockSize : 1;
+    Private::QueuedCommand command;
+    command.blocks = blocks;
+    command.write = true;
+    command.blockSize = blockSize;
+
+    // Protected blocks are staged in a buffer owned by the command, so the
+    // caller's buffer is not touched after this call either way
+    char *transferData = const_cast<char *>(data);
+    quint32 transferLength = length;
+    if (d->blockProtection) {
+        transferLength = d->protectedLength(length, blockSize);
+        command.protectedData = d->takeSpareBuffer(transferLength);
+        command.length = length;
+        transferData = command.protectedData.data();
+        d->protectBlocks(transferData, data, length, blockSize);
+    }
+
+    setStatus(TapeStatus::Writing);
+    if (!d->queue->submit(tag, ScsiCommand::write6Cdb(fixed ? blocks : transferLength, fixed),
+                          ScsiDataDirection::ToDevice, transferData, transferLength)) {
+        setError(QStringLiteral("Queued write failed: %1").arg(d->queue->lastError()));
+        return false;
+    }
+
+    d->inFlight.insert(tag, command);
+
+    return true;
+}
+
+bool TapeDevice::submitRead(quint64 tag, char *buffer, quint32 length, quint32 blockSize)
+{
+    if (!isOpen()) {
+        d->lastError = QStringLiteral("Device not open for operation: submitRead");
+        return false;
+    }
+
+    if (blockSize > 0 && (length == 0 || length % blockSize != 0)) {
+        setError(QStringLiteral("Queued read failed: length %1 is not a multiple of block size %2")
+                     .arg(length).arg(blockSize));
+        return false;
+    }
+
+    if (!d->queue) {
+        qint64 bytesRead = blockSize > 0 ? readBlocks(buffer, length / blockSize, blockSize)
+                                         : readBlock(buffer, length);
+        TapeCompletion completion;
+        completion.tag = tag;
+        completion.success = bytesRead >= 0;
+        completion.endOfData = bytesRead == 0;
+        completion.bytesTransferred = bytesRead > 0 ? static_cast<quint32>(bytesRead) : 0;
+        completion.senseData = d->lastSenseData;
+        if (!completion.success) {
+            completion.error = d->lastError;
+        }
+        d->completed.enqueue(completion);
+        return true;
+    }
+
+    if (d->inFlight.contains(tag)) {
+        setError(QStringLiteral("Queued read failed: tag %1 already pending").arg(tag));
+        return false;
+    }
+
+    bool fixed = blockSize > 0;
+    if (fixed && (!d->fixedBlockMode || d->currentBlockSize != blockSize) && !setBlockSize(blockSize)) {
+        return false;
+    }
+
+    while (d->queue->pending() >= d->queue->depth()) {
+        TapeCompletion completion;
+        if (!reapQueued(completion, -1)) {
+            return false;
+        }
+        d->completed.enqueue(completion);
+    }
+
+    quint32 blocks = fixed ? length / blockSize : 1;
+    Private::QueuedCommand command;
+    command.blocks = blocks;
+    command.write = false;
+    command.blockSize = blockSize;
+
+    // Protected blocks arrive in a buffer owned by the command and are
+    // checked and copied to the caller's buffer when reaped
+    char *transferData = buffer;
+    quint32 transferLength = length;
+    if (d->blockProtection) {
+        transferLength = d->protectedLength(length, blockSize);
+        command.protectedData = d->takeSpareBuffer(transferLength);
+        command.readBuffer = buffer;
+        command.length = length;
+        transferData = command.protectedData.data();
+    }
+
+    setStatus(TapeStatus::Reading);
+    if (!d->queue->submit(tag, ScsiCommand::read6Cdb(fixed ? blocks : transferLength, fixed),
+                          ScsiDataDirection::FromDevice, transferData, transferLength)) {
+        setError(QStringLiteral("Queued read failed: %1").arg(d->queue->lastError()));
+        return false;
+    }
+
+    d->inFlight.insert(tag, command);
+
+    return true;
+}
+
+bool TapeDevice::reapCompletion(TapeCompletion &completion, int timeoutMs)
+{
+    if (!d->completed.isEmpty()) {
+        completion = d->completed.dequeue();
+        return true;
+    }
+
+    if (!d->queue || d->inFlight.isEmpty()) {
+        d->lastError = QStringLiteral("No commands pending");
+        return false;
+    }
+
+    return reapQueued(completion, timeoutMs);
+}
+
+int TapeDevice::pendingCommands() const
+{
+    return d->inFlight.size() + d->completed.size();
+}
+
+bool TapeDevice::drainQueue()
+{
+    bool allSucceeded = true;
+
+    while (d->queue && !d->inFlight.isEmpty()) {
+        TapeCompletion completion;
+        if (!reapQueued(completion, -1)) {
+            return false;
+        }
+        allSucceeded = allSucceeded && completion.success;
+        d->completed.enqueue(completion);
+    }
+
+    return allSucceeded;
 }
 
 bool TapeDevice::writeFilemark(quint32 count)
@@ -835,7 +1683,10 @@ bool TapeDevice::writeFilemark(quint32 count)
         return false;
     }
 
+    // Filemarks occupy logical object positions like blocks
+    d->position.blockNumber += count;
     d->position.fileNumber += count;
+    d->atEndOfData = true;
 
     return true;
 }
@@ -847,7 +1698,7 @@ bool TapeDevice::setBlockSize(quint32 blockSize)
     }
 
     // Build mode select data for block descriptor
-    QByteArray modeData(12, 0);
+    QByteArray modeData(16, 0);
 
     // Mode parameter header (8 bytes for mode select 10)
     // Byte 0-1: Mode data length (filled by drive)
@@ -862,15 +1713,12 @@ bool TapeDevice::setBlockSize(quint32 blockSize)
     // Byte 0: Density code (0 = current)
     // Byte 1-3: Number of blocks (0 = all)
     // Byte 4: Reserved
-    // Byte 5-7: Block length
+    // Byte 5-7: Block length (0 = variable)
 
     modeData[8] = 0;  // Current density
-    modeData[11] = static_cast<char>((blockSize >> 16) & 0xFF);
-    modeData[12] = static_cast<char>((blockSize >> 8) & 0xFF);
-    modeData[13] = static_cast<char>(blockSize & 0xFF);
-
-    // Need to resize to include block descriptor
-    modeData.resize(16);
+    modeData[13] = static_cast<char>((blockSize >> 16) & 0xFF);
+    modeData[14] = static_cast<char>((blockSize >> 8) & 0xFF);
+    modeData[15] = static_cast<char>(blockSize & 0xFF);
 
     auto result = d->scsi->modeSelect10(modeData, false);
     d->lastSenseData = result.senseData;
@@ -881,6 +1729,7 @@ bool TapeDevice::setBlockSize(quint32 blockSize)
     }
 
     d->currentBlockSize = blockSize;
+    d->fixedBlockMode = (blockSize != 0);
 
     return true;
 }
@@ -890,12 +1739,21 @@ quint32 TapeDevice::blockSize() const
     return d->currentBlockSize;
 }
 
+bool TapeDevice::isFixedBlockMode() const
+{
+    return d->fixedBlockMode;
+}
+
 bool TapeDevice::setCompression(bool enabled)
 {
     if (!checkOpen("setCompression")) {
         return false;
     }
 
+    if (d->compressionKnown && d->compressionEnabled == enabled) {
+        return true;
+    }
+
     // Get current data compression mode page
     auto result = d->scsi->modeSense10(MODE_PAGE_DATA_COMPRESSION, 0, 256);
     if (!result.success || result.data.size() < 24) {
@@ -938,6 +1796,7 @@ bool TapeDevice::setCompression(bool enabled)
     }
 
     d->compressionEnabled = enabled;
+    d->compressionKnown = true;
 
     return true;
 }
@@ -947,6 +1806,38 @@ bool TapeDevice::compressionEnabled() const
     return d->compressionEnabled;
 }
 
+bool TapeDevice::setBlockProtection(bool enabled)
+{
+    if (!checkOpen("setBlockProtection")) {
+        return false;
+    }
+
+    // Drives before LTO-5 do not have the Control Data Protection page
+    auto result = d->scsi->modeSense10(MODE_PAGE_CONTROL, MODE_SUBPAGE_DATA_PROTECTION, 256);
+    if (!result.success) {
+        d->lastSenseData = result.senseData;
+        setError(QStringLiteral("Drive does not support logical block protection: %1").arg(result.errorMessage()));
+        return false;
+    }
+
+    result = d->scsi->setDataProtection(enabled ? LbpMethod::Crc32c : LbpMethod::None, enabled, enabled);
+    d->lastSenseData = result.senseData;
+
+    if (!result.success) {
+        setError(QStringLiteral("Set block protection failed: %1").arg(result.errorMessage()));
+        return false;
+    }
+
+    d->blockProtection = enabled;
+
+    return true;
+}
+
+bool TapeDevice::blockProtectionEnabled() const
+{
+    return d->blockProtection;
+}
+
 LtfsLabel TapeDevice::readLabel(PartitionLabel partition)
 {
     LtfsLabel label;
@@ -1031,23 +1922,17 @@ bool TapeDevice::isLtfsFormatted()
     return label.isValid();
 }
 
-QMap<quint16, QByteArray> TapeDevice::readMamAttributes()
+/**
+ * @brief Split READ ATTRIBUTE (ATTRIBUTE VALUES) data into attributes by id
+ */
+static QMap<quint16, QByteArray> parseAttributeList(const QByteArray &list)
 {
     QMap<quint16, QByteArray> attributes;
-
-    if (!checkOpen("readMamAttributes")) {
+    if (list.size() < 4) {
         return attributes;
     }
 
-    // Read all attributes (service action 0)
-    auto result = d->scsi->readAttribute(0, 0, 16384);
-    d->lastSenseData = result.senseData;
-
-    if (!result.success || result.data.size() < 4) {
-        return attributes;
-    }
-
-    const quint8 *data = reinterpret_cast<const quint8 *>(result.data.constData());
+    const quint8 *data = reinterpret_cast<const quint8 *>(list.constData());
 
     // Parse attribute list
     quint32 availableData = (static_cast<quint32>(data[0]) << 24) |
@@ -1056,24 +1941,102 @@ QMap<quint16, QByteArray> TapeDevice::readMamAttributes()
                            static_cast<quint32>(data[3]);
 
     int offset = 4;
-    while (offset + 5 <= result.data.size() && offset < static_cast<int>(availableData + 4)) {
+    while (offset + MAM_ATTRIBUTE_HEADER <= list.size() && offset < static_cast<int>(availableData + 4)) {
         quint16 attrId = (static_cast<quint16>(data[offset]) << 8) | data[offset + 1];
         // Byte 2 is format/readonly
         quint16 attrLen = (static_cast<quint16>(data[offset + 3]) << 8) | data[offset + 4];
 
-        if (offset + 5 + attrLen > result.data.size()) {
+        if (offset + MAM_ATTRIBUTE_HEADER + attrLen > list.size()) {
             break;
         }
 
-        QByteArray attrData = result.data.mid(offset + 5, attrLen);
+        QByteArray attrData = list.mid(offset + MAM_ATTRIBUTE_HEADER, attrLen);
         attributes[attrId] = attrData;
 
-        offset += 5 + attrLen;
+        offset += MAM_ATTRIBUTE_HEADER + attrLen;
     }
 
     return attributes;
 }
 
+/**
+ * @brief Big-endian unsigned integer of up to 8 bytes
+ */
+static quint64 bigEndianValue(const QByteArray &bytes)
+{
+    quint64 value = 0;
+    for (qsizetype i = 0; i < qMin<qsizetype>(bytes.size(), 8); ++i) {
+        value = (value << 8) | static_cast<quint8>(bytes[i]);
+    }
+    return value;
+}
+
+QMap<quint16, QByteArray> TapeDevice::readMamAttributes()
+{
+    if (!checkOpen("readMamAttributes")) {
+        return QMap<quint16, QByteArray>();
+    }
+
+    // Read all attributes (service action 0)
+    auto result = d->scsi->readAttribute(0, 0, 16384);
+    d->lastSenseData = result.senseData;
+
+    if (!result.success) {
+        return QMap<quint16, QByteArray>();
+    }
+    return parseAttributeList(result.data);
+}
+
+TapeVolumeIdentity TapeDevice::readVolumeIdentity(PartitionLabel partition)
+{
+    TapeVolumeIdentity identity;
+
+    if (!checkOpen("readVolumeIdentity")) {
+        return identity;
+    }
+
+    // Every attribute in one command; the coherency record is the one of @p partition
+    auto result = d->scsi->readAttribute(0, 0, 16384, static_cast<quint8>(partition));
+    d->lastSenseData = result.senseData;
+
+    if (!result.success) {
+        setQueryError(QStringLiteral("Read MAM attributes failed: %1").arg(result.errorMessage()));
+        return identity;
+    }
+
+    const QMap<quint16, QByteArray> attributes = parseAttributeList(result.data);
+    identity.serialNumber = QString::fromLatin1(attributes.value(MAM_MEDIUM_SERIAL_NUMBER)).trimmed();
+    identity.barcode = QString::fromLatin1(attributes.value(MAM_BARCODE)).trimmed();
+    identity.volumeChangeReference = bigEndianValue(attributes.value(MAM_VOLUME_CHANGE_REFERENCE));
+
+    // VCR length (2), VCR, generation (8), index block (8), client info length (2), client info
+    const QByteArray coherency = attributes.value(MAM_VOLUME_COHERENCY_INFO);
+    if (coherency.size() < 2) {
+        return identity;
+    }
+    const int vcrLength = (static_cast<quint8>(coherency[0]) << 8) | static_cast<quint8>(coherency[1]);
+    int offset = 2 + vcrLength;
+    if (coherency.size() < offset + 18) {
+        return identity;
+    }
+    identity.coherencyChangeReference = bigEndianValue(coherency.mid(2, vcrLength));
+    identity.generationNumber = bigEndianValue(coherency.mid(offset, 8));
+    identity.indexBlock = bigEndianValue(coherency.mid(offset + 8, 8));
+    offset += 16;
+
+    const int clientLength = (static_cast<quint8>(coherency[offset]) << 8) | static_cast<quint8>(coherency[offset + 1]);
+    const QByteArray client = coherency.mid(offset + 2, clientLength);
+    if (client.size() < LTFS_COHERENCY_NAME_LENGTH + LTFS_COHERENCY_UUID_LENGTH ||
+        !client.startsWith(QByteArray("LTFS", LTFS_COHERENCY_NAME_LENGTH))) {
+        return identity;    // Written by something other than LTFS
+    }
+    identity.volumeUuid = QUuid::fromString(QLatin1String(
+        client.mid(LTFS_COHERENCY_NAME_LENGTH, LTFS_COHERENCY_UUID_LENGTH - 1)));
+    identity.hasCoherency = true;
+
+    return identity;
+}
+
 bool TapeDevice::writeMamAttribute(quint16 attributeId, const QByteArray &data)
 {
     if (!checkOpen("writeMamAttribute")) {
@@ -1154,6 +2117,7 @@ bool TapeDevice::formatForLtfs(const LtfsLabel &label, TapeProgressCallback call
     // This is done via Format Medium command with partition bit set
     auto result = d->scsi->formatMedium(0x0E, true);  // 0x0E = default format, partition
     d->lastSenseData = result.senseData;
+    d->positionValid = false;
 
     if (!result.success) {
         // Some drives require mode select to set partition sizes first
@@ -1262,6 +2226,7 @@ bool TapeDevice::quickErase()
     // Write EOD marker at beginning
     auto result = d->scsi->erase(false, false);  // Short erase, wait
     d->lastSenseData = result.senseData;
+    d->positionValid = false;
 
     if (!result.success) {
         setError(QStringLiteral("Quick erase failed: %1").arg(result.errorMessage()));
@@ -1284,6 +2249,7 @@ bool TapeDevice::longErase(TapeProgressCallback callback)
     // Long erase with immediate return
     auto result = d->scsi->erase(true, true);  // Long erase, immediate
     d->lastSenseData = result.senseData;
+    d->positionValid = false;
 
     if (!result.success) {
         setError(QStringLiteral("Long erase failed: %1").arg(result.errorMessage()));
@@ -1357,17 +2323,95 @@ void TapeDevice::setStatus(TapeStatus status)
 
 void TapeDevice::setError(const QString &message)
 {
+    // After any failure the drive may be somewhere else than we think
+    d->positionValid = false;
+    d->atEndOfData = false;
+
     d->lastError = message;
     setStatus(TapeStatus::Error);
     emit errorOccurred(message);
 }
 
+void TapeDevice::setQueryError(const QString &message)
+{
+    // Log pages, buffer status and MAM do not move the tape, so the
+    // position cache still holds; a missing page is not a drive error
+    d->lastError = message;
+}
+
 bool TapeDevice::checkOpen(const char *operation)
 {
     if (!isOpen()) {
         d->lastError = QStringLiteral("Device not open for operation: %1").arg(QString::fromLatin1(operation));
         return false;
     }
+
+    // Queued commands must reach the drive before anything issued now
+    if (d->queue && !d->inFlight.isEmpty()) {
+        drainQueue();
+    }
+    return true;
+}
+
+bool TapeDevice::reapQueued(TapeCompletion &completion, int timeoutMs)
+{
+    ScsiQueueCompletion queued;
+    if (!d->queue->reap(queued, timeoutMs)) {
+        d->lastError = QStringLiteral("Waiting for queued command failed: %1").arg(d->queue->lastError());
+        return false;
+    }
+
+    const Private::QueuedCommand command = d->inFlight.take(queued.tag);
+    const ScsiCommandResult &result = queued.result;
+
+    completion = TapeCompletion();
+    completion.tag = queued.tag;
+    completion.success = result.success;
+    completion.bytesTransferred = result.bytesTransferred;
+    completion.senseData = result.senseData;
+    d->lastSenseData = result.senseData;
+
+    if (result.success && !command.protectedData.isEmpty()) {
+        // Report data bytes only, after checking the CRCs of a read
+        if (command.write) {
+            completion.bytesTransferred = command.length;
+        } else {
+            QString protectionError;
+            qint64 bytesRead = d->unprotectBlocks(command.readBuffer, command.length,
+                                                  command.protectedData.constData(),
+                                                  result.bytesTransferred, command.blockSize,
+                                                  protectionError);
+            if (bytesRead < 0) {
+                completion.success = false;
+                completion.error = QStringLiteral("Queued read failed: %1").arg(protectionError);
+                setError(completion.error);
+            } else {
+                completion.bytesTransferred = static_cast<quint32>(bytesRead);
+            }
+        }
+    }
+    if (!command.protectedData.isEmpty()) {
+        d->spareBuffers.append(command.protectedData);
+    }
+
+    if (result.success) {
+        d->position.blockNumber += command.blocks;
+        d->atEndOfData = command.write;
+    } else if (!command.write && result.senseData.senseKey == ScsiSenseKey::BlankCheck) {
+        completion.success = true;
+        completion.endOfData = true;
+        d->atEndOfData = true;
+    } else {
+        completion.error = QStringLiteral("%1 failed: %2")
+                               .arg(command.write ? QStringLiteral("Queued write") : QStringLiteral("Queued read"),
+                                    result.errorMessage());
+        setError(completion.error);
+    }
+
+    if (d->inFlight.isEmpty() && (d->status == TapeStatus::Writing || d->status == TapeStatus::Reading)) {
+        setStatus(TapeStatus::Ready);
+    }
+
     return true;
 }
 
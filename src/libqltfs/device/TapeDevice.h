@@ -25,12 +25,15 @@
 #include "core/LtfsTypes.h"
 #include "core/LtfsLabel.h"
 #include "device/ScsiCommand.h"
+#include "device/ScsiCommandQueue.h"
 #include "device/DeviceEnumerator.h"
 
 #include <QObject>
 #include <QString>
 #include <QByteArray>
+#include <QHash>
 #include <QSharedPointer>
+#include <QUuid>
 #include <functional>
 
 namespace qltfs {
@@ -84,7 +87,77 @@ struct LIBQLTFS_EXPORT TapeLogData {
     quint32 loadCount = 0;
     quint32 cleaningRequired = 0;
 
+    // Data compression log page (counters since the last load or reset)
+    quint64 hostBytesWritten = 0;   ///< Bytes received from the host
+    quint64 tapeBytesWritten = 0;   ///< Bytes written to tape after compression
+    quint64 hostBytesRead = 0;      ///< Bytes returned to the host
+    quint64 tapeBytesRead = 0;      ///< Bytes read from tape before decompression
+
     bool isValid() const;
+
+    /**
+     * @brief Host bytes per tape byte written (1.0 if unknown)
+     */
+    double writeCompressionRatio() const;
+
+    /**
+     * @brief Host bytes per tape byte read (1.0 if unknown)
+     */
+    double readCompressionRatio() const;
+};
+
+/**
+ * @brief Range of logical objects on tape, for access order planning
+ */
+struct LIBQLTFS_EXPORT TapeSegment {
+    quint8 partition = 0;
+    quint64 firstBlock = 0;
+    quint64 lastBlock = 0;          ///< Inclusive
+};
+
+/**
+ * @brief Data held in the drive buffer (extended READ POSITION)
+ */
+struct LIBQLTFS_EXPORT TapeBufferStatus {
+    quint32 objects = 0;            ///< Logical objects not yet written to tape
+    quint64 bytes = 0;              ///< Bytes not yet written to tape
+};
+
+/**
+ * @brief Completion of a queued read or write
+ */
+struct LIBQLTFS_EXPORT TapeCompletion {
+    quint64 tag = 0;                ///< Tag given to submitWrite() / submitRead()
+    bool success = false;
+    bool endOfData = false;         ///< Read hit blank tape (end of data)
+    quint32 bytesTransferred = 0;
+    ScsiSenseData senseData;
+    QString error;                  ///< Error message if the command failed
+};
+
+/**
+ * @brief What MAM says about the cartridge and its LTFS volume
+ *
+ * The volume fields come from the Volume Coherency Information an LTFS
+ * implementation records next to each index it writes: the index
+ * generation and block, the volume UUID and the Volume Change Reference
+ * (VCR) at that time. The drive bumps the VCR on every write, so an
+ * unchanged VCR means nothing was written since that index.
+ */
+struct LIBQLTFS_EXPORT TapeVolumeIdentity {
+    QString serialNumber;           ///< Medium serial number
+    QString barcode;                ///< Barcode recorded by the formatting application
+    quint64 volumeChangeReference = 0;  ///< Current VCR of the medium
+    bool hasCoherency = false;      ///< Volume Coherency Information was found
+    quint64 coherencyChangeReference = 0;   ///< VCR when the index was written
+    quint64 generationNumber = 0;   ///< Generation of that index
+    quint64 indexBlock = 0;         ///< Block the index starts at
+    QUuid volumeUuid;
+
+    /**
+     * @brief Check if the recorded index is the latest one on the partition
+     */
+    bool isCurrent() const;
 };
 
 /**
@@ -202,6 +275,32 @@ public:
      */
     bool refreshLogData();
 
+    /**
+     * @brief Refresh only the data compression counters of logData()
+     *
+     * A single LOG SENSE, cheap enough to call between files while
+     * writing to follow the live compression ratio.
+     */
+    bool refreshCompressionData();
+
+    /**
+     * @brief Read all parameters of a log page
+     *
+     * Values longer than 8 bytes keep their first 8 bytes.
+     *
+     * @param pageCode Log page code
+     * @param parameters Receives the values keyed by parameter code
+     * @param subPageCode Log subpage code
+     */
+    bool readLogParameters(quint8 pageCode, QHash<quint16, quint64> &parameters, quint8 subPageCode = 0);
+
+    /**
+     * @brief Read how much data is waiting in the drive buffer
+     *
+     * Does not change the cached position.
+     */
+    bool readBufferStatus(TapeBufferStatus &status);
+
     /**
      * @brief Get block limits
      */
@@ -209,9 +308,40 @@ public:
 
     /**
      * @brief Get current tape position
+     *
+     * Cached: kept up to date by every positioning, read and write
+     * command, and only re-read from the drive by refreshPosition().
      */
     TapePosition position() const;
 
+    /**
+     * @brief Check if the cached position is known to match the drive
+     */
+    bool isPositionKnown() const;
+
+    /**
+     * @brief Read the current position from the drive into the cache
+     */
+    bool refreshPosition();
+
+    /**
+     * @brief Compare the cached position with the drive's
+     *
+     * Issues one READ POSITION; meant for session boundaries. On a
+     * mismatch the drive's position replaces the cache.
+     *
+     * @return true if the cache was valid and matched
+     */
+    bool verifyPosition();
+
+    /**
+     * @brief Check if the cached position is known to be at end of data
+     *
+     * True after a write, a filemark or a space to end of data, until
+     * the tape is moved by anything else.
+     */
+    bool isAtEndOfData() const;
+
     // === Media Control ===
 
     /**
@@ -268,6 +398,38 @@ public:
      */
     bool spaceToEndOfData();
 
+    /**
+     * @brief Move forward to a block by reading and discarding what lies before it
+     *
+     * Keeps the drive streaming where a LOCATE would stop it and
+     * reposition, which wins for short gaps. Filemarks on the way are
+     * read past. The position must be known and @p blockNumber at or
+     * ahead of it in the current partition.
+     *
+     * @param blockNumber Block to stop in front of
+     * @param buffer Scratch space for the discarded blocks
+     * @param bufferSize Size of @p buffer, at least the largest block on tape
+     * @return Bytes discarded, or -1 on error (position then unknown)
+     */
+    qint64 readThrough(quint64 blockNumber, char *buffer, quint32 bufferSize);
+
+    /**
+     * @brief Ask the drive for the fastest order to read segments
+     *
+     * Uses Generate / Receive Recommended Access Order (RAO). A drive
+     * that rejects RAO is not asked again until the device is reopened.
+     *
+     * @param segments Segments to read (at most maxAccessOrderSegments())
+     * @return Indices into @p segments in recommended order, or an empty
+     *         list if the drive cannot provide one
+     */
+    QList<int> recommendedAccessOrder(const QList<TapeSegment> &segments);
+
+    /**
+     * @brief Largest number of segments passed to one RAO request
+     */
+    static int maxAccessOrderSegments();
+
     /**
      * @brief Seek to beginning of partition
      * @param partition Partition number
@@ -276,10 +438,26 @@ public:
 
     /**
      * @brief Seek to end of partition
+     *
+     * No command is issued if the cached position is already at the end
+     * of data of @p partition.
+     *
      * @param partition Partition number
      */
     bool seekToEnd(quint8 partition = 1);
 
+    /**
+     * @brief Position to write over everything from a block on
+     *
+     * The next write at @p blockNumber becomes the new end of data and
+     * drops whatever followed it, so seekToEnd() issues no command until
+     * then and appends there instead of behind the old data.
+     *
+     * @param partition Partition number
+     * @param blockNumber First block to overwrite
+     */
+    bool locateForOverwrite(quint8 partition, quint64 blockNumber);
+
     // === Read/Write ===
 
     /**
@@ -297,6 +475,26 @@ public:
      */
     qint64 writeBlock(const QByteArray &data);
 
+    /**
+     * @brief Read one block into a caller-owned buffer
+     *
+     * Zero-copy variant of readBlock(): the buffer is passed to the
+     * driver directly. Use page-aligned buffers for direct I/O.
+     *
+     * @param buffer Buffer to receive data
+     * @param maxSize Size of the buffer (largest block accepted)
+     * @return Number of bytes read, 0 at end of data, or -1 on error
+     */
+    qint64 readBlock(char *buffer, quint32 maxSize);
+
+    /**
+     * @brief Write one block from a caller-owned buffer without copying it
+     * @param data Data to write
+     * @param length Block length in bytes
+     * @return Number of bytes written, or -1 on error
+     */
+    qint64 writeBlock(const char *data, quint32 length);
+
     /**
      * @brief Read multiple blocks
      * @param data Buffer to receive data
@@ -314,6 +512,123 @@ public:
      */
     qint64 writeBlocks(const QByteArray &data, quint32 blockSize);
 
+    /**
+     * @brief Read several fixed-size blocks with one command
+     *
+     * Switches the drive to fixed-block mode with @p blockSize if needed
+     * and reads straight into the caller's buffer.
+     *
+     * @param buffer Buffer of at least blockCount * blockSize bytes
+     * @param blockCount Number of blocks to read
+     * @param blockSize Size of each block
+     * @return Number of bytes read, 0 at end of data, or -1 on error
+     */
+    qint64 readBlocks(char *buffer, quint32 blockCount, quint32 blockSize);
+
+    /**
+     * @brief Write several fixed-size blocks with one command
+     *
+     * Switches the drive to fixed-block mode with @p blockSize if needed.
+     * Variable-mode writeBlock() remains valid afterwards for short blocks.
+     *
+     * @param data Data of exactly blockCount * blockSize bytes
+     * @param blockCount Number of blocks to write
+     * @param blockSize Size of each block
+     * @return Number of bytes written, or -1 on error
+     */
+    qint64 writeBlocks(const char *data, quint32 blockCount, quint32 blockSize);
+
+    /**
+     * @brief Get how many blocks of @p blockSize fit in one command
+     *
+     * Bounded by the block limits of the drive and the maximum transfer
+     * length of the host adapter.
+     *
+     * @param blockSize Block size in bytes
+     * @param requested Desired number of blocks per command
+     * @return Usable number of blocks per command (at least 1)
+     */
+    quint32 maxBlocksPerCommand(quint32 blockSize, quint32 requested) const;
+
+    // === Queued Read/Write ===
+
+    /**
+     * @brief Set how many data commands may be in flight at once
+     *
+     * A depth above 1 opens an asynchronous command queue on the drive
+     * (sg write/read interface on Linux, overlapped pass-through with an
+     * I/O completion port on Windows) so the next buffer is already
+     * queued at the adapter when the current one completes. If no queue
+     * is available on this platform or device, submitted commands are
+     * executed synchronously and reported through the same completion
+     * interface.
+     *
+     * Outstanding commands are always completed before any other tape
+     * command is issued.
+     *
+     * @param depth Maximum commands in flight (1 = synchronous)
+     * @return true if an asynchronous queue is active
+     */
+    bool setQueueDepth(int depth);
+
+    /**
+     * @brief Get the effective queue depth (1 when synchronous)
+     */
+    int queueDepth() const;
+
+    /**
+     * @brief Check if submitted commands run asynchronously
+     */
+    bool isQueued() const;
+
+    /**
+     * @brief Queue a write from a caller-owned buffer
+     *
+     * The buffer must stay valid and unchanged until the completion
+     * with @p tag has been reaped.
+     *
+     * @param tag Caller-chosen identifier, unique among pending commands
+     * @param data Data to write
+     * @param length Length in bytes
+     * @param blockSize 0 to write one variable-length block, otherwise
+     *        write length / blockSize fixed-size blocks
+     * @return true if the command was accepted
+     */
+    bool submitWrite(quint64 tag, const char *data, quint32 length, quint32 blockSize = 0);
+
+    /**
+     * @brief Queue a read into a caller-owned buffer
+     * @param tag Caller-chosen identifier, unique among pending commands
+     * @param buffer Buffer to receive data
+     * @param length Size of the buffer in bytes
+     * @param blockSize 0 to read one variable-length block, otherwise
+     *        read length / blockSize fixed-size blocks
+     * @return true if the command was accepted
+     */
+    bool submitRead(quint64 tag, char *buffer, quint32 length, quint32 blockSize = 0);
+
+    /**
+     * @brief Wait for the next completed command
+     * @param completion Receives the completion
+     * @param timeoutMs Timeout in milliseconds (-1 = infinite)
+     * @return true if a completion was returned
+     */
+    bool reapCompletion(TapeCompletion &completion, int timeoutMs = -1);
+
+    /**
+     * @brief Number of submitted commands not yet reaped
+     */
+    int pendingCommands() const;
+
+    /**
+     * @brief Wait until all submitted commands have finished
+     *
+     * Their completions remain available to reapCompletion().
+     *
+     * @return true if every drained command succeeded
+     */
+    bool drainQueue();
+
     /**
      * @brief Write filemark(s)
      * @param count Number of filemarks
@@ -321,7 +636,7 @@ public:
     bool writeFilemark(quint32 count = 1);
 
     /**
-     * @brief Set block size for fixed-block mode
+     * @brief Set block size for fixed-block mode (0 = variable-block mode)
      */
     bool setBlockSize(quint32 blockSize);
 
@@ -330,8 +645,19 @@ public:
      */
     quint32 blockSize() const;
 
+    /**
+     * @brief Check if the drive was switched to fixed-block mode
+     *
+     * True after setBlockSize() with a non-zero size (including the
+     * implicit switch done by readBlocks() / writeBlocks()).
+     */
+    bool isFixedBlockMode() const;
+
     /**
      * @brief Enable or disable hardware compression
+     *
+     * No command is issued when the drive is already known to be in the
+     * requested state, so this may be called for every file.
      */
     bool setCompression(bool enabled);
 
@@ -340,6 +666,25 @@ public:
      */
     bool compressionEnabled() const;
 
+    /**
+     * @brief Enable or disable logical block protection (LTO-5 and later)
+     *
+     * While enabled, a CRC32C is appended to every block written and the
+     * drive rejects any block whose data no longer matches it. Blocks
+     * read come back with the CRC the drive checked, which is verified
+     * again before the data is handed to the caller; a mismatch fails the
+     * read. All read and write calls, queued or not, keep their normal
+     * buffer sizes and return values.
+     *
+     * @return false if the drive does not support CRC32C protection
+     */
+    bool setBlockProtection(bool enabled);
+
+    /**
+     * @brief Check if logical block protection is enabled
+     */
+    bool blockProtectionEnabled() const;
+
     // === LTFS Operations ===
 
     /**
@@ -367,6 +712,19 @@ public:
      */
     QMap<quint16, QByteArray> readMamAttributes();
 
+    /**
+     * @brief Identify the cartridge and its LTFS volume from MAM alone
+     *
+     * One READ ATTRIBUTE command returns the serial number, barcode,
+     * VCR and the Volume Coherency Information of @p partition, without
+     * moving the tape. Together with an IndexCache this lets a mount skip
+     * readLabel() and the index read when the volume has not changed.
+     * The coherency information is whatever the LTFS implementation that
+     * last wrote an index recorded; libqltfs writes no index to tape and
+     * so never records it.
+     */
+    TapeVolumeIdentity readVolumeIdentity(PartitionLabel partition = PartitionLabel::IndexPartition);
+
     /**
      * @brief Write MAM attribute
      * @param attributeId Attribute ID
@@ -460,7 +818,9 @@ private:
 
     void setStatus(TapeStatus status);
     void setError(const QString &message);
+    void setQueryError(const QString &message);     ///< Failed read-only query: lastError only
     bool checkOpen(const char *operation);
+    bool reapQueued(TapeCompletion &completion, int timeoutMs);
 };
 
 } // namespace qltfs
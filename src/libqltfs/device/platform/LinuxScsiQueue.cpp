@@ -0,0 +1,326 @@
+/**
+ * QLTOTapeMan - Qt-based LTO Tape Manager
+ * Linux Asynchronous SCSI Queue Implementation
+ *
+ * Copyright (c) 2026 Jeffrey ZHU (zhxsh1225@gmail.com)
+ * https://github.com/Gypsop/QLTOTapeMan
+ */
+
+#include "LinuxScsiQueue.h"
+
+#if defined(Q_OS_LINUX)
+
+#include <QDir>
+#include <QFileInfo>
+#include <QElapsedTimer>
+#include <QDebug>
+
+#include <sys/ioctl.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <scsi/sg.h>
+
+namespace qltfs {
+
+static constexpr quint8 SCSI_STATUS_GOOD = 0x00;
+
+// =============================================================================
+// Constructor / Destructor
+// =============================================================================
+
+LinuxScsiQueue::LinuxScsiQueue(const QString& devicePath, int depth)
+    : m_devicePath(devicePath)
+    , m_fd(-1)
+    , m_depth(qBound(1, depth, SG_MAX_QUEUE))
+    , m_pending(0)
+{
+    m_slots.resize(m_depth);
+}
+
+LinuxScsiQueue::~LinuxScsiQueue()
+{
+    close();
+}
+
+// =============================================================================
+// Device Open / Close
+// =============================================================================
+
+bool LinuxScsiQueue::open()
+{
+    if (isOpen()) {
+        return true;
+    }
+
+    m_genericPath = resolveGenericPath(m_devicePath);
+    if (m_genericPath.isEmpty()) {
+        m_lastError = QStringLiteral("No sg device found for %1").arg(m_devicePath);
+        return false;
+    }
+
+    m_fd = ::open(m_genericPath.toLocal8Bit().constData(), O_RDWR | O_NONBLOCK);
+    if (m_fd < 0) {
+        m_lastError = QStringLiteral("Failed to open %1: %2")
+                          .arg(m_genericPath, QString::fromLocal8Bit(strerror(errno)));
+        return false;
+    }
+
+    // The write()/read() interface with sg_io_hdr needs sg version 3
+    int version = 0;
+    if (ioctl(m_fd, SG_GET_VERSION_NUM, &version) < 0 || version < 30000) {
+        m_lastError = QStringLiteral("%1 does not support the sg v3 interface").arg(m_genericPath);
+        ::close(m_fd);
+        m_fd = -1;
+        return false;
+    }
+
+    // Allow more than one outstanding command on this file descriptor
+    int commandQueueing = 1;
+    ioctl(m_fd, SG_SET_COMMAND_Q, &commandQueueing);
+
+    m_pending = 0;
+    for (Slot& slot : m_slots) {
+        slot.busy = false;
+    }
+
+    return true;
+}
+
+void LinuxScsiQueue::close()
+{
+    if (m_fd < 0) {
+        return;
+    }
+
+    // Buffers of outstanding commands belong to the caller; do not let
+    // the kernel write into them after we return
+    ScsiQueueCompletion completion;
+    while (m_pending > 0) {
+        if (!reap(completion, m_timeoutSeconds * 1000)) {
+            qWarning() << "LinuxScsiQueue: dropping" << m_pending << "outstanding commands:" << m_lastError;
+            break;
+        }
+    }
+
+    ::close(m_fd);
+    m_fd = -1;
+    m_pending = 0;
+}
+
+bool LinuxScsiQueue::isOpen() const
+{
+    return m_fd >= 0;
+}
+
+// =============================================================================
+// Submission / Completion
+// =============================================================================
+
+bool LinuxScsiQueue::submit(quint64 tag,
+                            const QByteArray& cdb,
+                            ScsiDataDirection direction,
+                            void* buffer,
+                            quint32 length)
+{
+    if (!isOpen()) {
+        m_lastError = QStringLiteral("Queue not open");
+        return false;
+    }
+
+    if (m_pending >= m_depth) {
+        m_lastError = QStringLiteral("Command queue full");
+        return false;
+    }
+
+    if (cdb.isEmpty() || cdb.size() > static_cast<int>(sizeof(Slot::cdb))) {
+        m_lastError = QStringLiteral("Invalid CDB length: %1").arg(cdb.size());
+        return false;
+    }
+
+    int index = 0;
+    while (index < m_slots.size() && m_slots[index].busy) {
+        ++index;
+    }
+
+    Slot& slot = m_slots[index];
+    memcpy(slot.cdb, cdb.constData(), static_cast<size_t>(cdb.size()));
+    memset(slot.sense, 0, sizeof(slot.sense));
+
+    sg_io_hdr_t hdr = {};
+    hdr.interface_id = 'S';
+    hdr.cmd_len = static_cast<unsigned char>(cdb.size());
+    hdr.cmdp = slot.cdb;
+    hdr.mx_sb_len = sizeof(slot.sense);
+    hdr.sbp = slot.sense;
+    hdr.timeout = static_cast<unsigned int>(m_timeoutSeconds) * 1000;
+    hdr.pack_id = index;
+
+    switch (direction) {
+    case ScsiDataDirection::None:
+        hdr.dxfer_direction = SG_DXFER_NONE;
+        break;
+    case ScsiDataDirection::ToDevice:
+        hdr.dxfer_direction = SG_DXFER_TO_DEV;
+        break;
+    case ScsiDataDirection::FromDevice:
+        hdr.dxfer_direction = SG_DXFER_FROM_DEV;
+        break;
+    }
+
+    if (direction != ScsiDataDirection::None && buffer && length > 0) {
+        hdr.dxferp = buffer;
+        hdr.dxfer_len = length;
+        // Map the caller's buffer directly; sg falls back to an
+        // indirect copy if direct I/O is disabled (allow_dio)
+        hdr.flags = SG_FLAG_DIRECT_IO;
+    }
+
+    ssize_t written;
+    do {
+        written = ::write(m_fd, &hdr, sizeof(hdr));
+    } while (written < 0 && errno == EINTR);
+
+    if (written < 0) {
+        m_lastError = QStringLiteral("sg submit failed: %1").arg(QString::fromLocal8Bit(strerror(errno)));
+        return false;
+    }
+
+    slot.busy = true;
+    slot.tag = tag;
+    slot.length = hdr.dxfer_len;
+    m_pending++;
+
+    return true;
+}
+
+bool LinuxScsiQueue::reap(ScsiQueueCompletion& completion, int timeoutMs)
+{
+    if (!isOpen()) {
+        m_lastError = QStringLiteral("Queue not open");
+        return false;
+    }
+
+    if (m_pending == 0) {
+        m_lastError = QStringLiteral("No commands pending");
+        return false;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    sg_io_hdr_t hdr = {};
+    for (;;) {
+        int waitMs = -1;
+        if (timeoutMs >= 0) {
+            waitMs = static_cast<int>(qMax<qint64>(0, timeoutMs - timer.elapsed()));
+        }
+
+        struct pollfd pfd = {};
+        pfd.fd = m_fd;
+        pfd.events = POLLIN;
+
+        int ret = poll(&pfd, 1, waitMs);
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            m_lastError = QStringLiteral("poll failed: %1").arg(QString::fromLocal8Bit(strerror(errno)));
+            return false;
+        }
+        if (ret == 0) {
+            m_lastError = QStringLiteral("Timed out waiting for command completion");
+            return false;
+        }
+
+        // pack_id -1 returns whichever command finished first
+        memset(&hdr, 0, sizeof(hdr));
+        hdr.interface_id = 'S';
+        hdr.pack_id = -1;
+
+        ssize_t n = ::read(m_fd, &hdr, sizeof(hdr));
+        if (n >= 0) {
+            break;
+        }
+        if (errno == EAGAIN || errno == EINTR) {
+            continue;
+        }
+        m_lastError = QStringLiteral("sg read failed: %1").arg(QString::fromLocal8Bit(strerror(errno)));
+        return false;
+    }
+
+    if (hdr.pack_id < 0 || hdr.pack_id >= m_slots.size() || !m_slots[hdr.pack_id].busy) {
+        m_lastError = QStringLiteral("Unexpected sg completion (pack id %1)").arg(hdr.pack_id);
+        return false;
+    }
+
+    Slot& slot = m_slots[hdr.pack_id];
+
+    completion = ScsiQueueCompletion();
+    completion.tag = slot.tag;
+
+    ScsiCommandResult& result = completion.result;
+    result.hostStatus = hdr.host_status;
+    result.driverStatus = hdr.driver_status;
+    result.scsiStatus = hdr.status;
+    result.residual = static_cast<quint32>(hdr.resid);
+    result.bytesTransferred = slot.length - static_cast<quint32>(qMax(0, hdr.resid));
+
+    if (hdr.sb_len_wr > 0) {
+        result.senseData = ScsiSenseData::fromRawData(
+            QByteArray(reinterpret_cast<const char*>(slot.sense), hdr.sb_len_wr));
+    }
+
+    result.success = (hdr.host_status == 0 &&
+                      hdr.driver_status == 0 &&
+                      result.scsiStatus == SCSI_STATUS_GOOD);
+
+    slot.busy = false;
+    m_pending--;
+
+    return true;
+}
+
+// =============================================================================
+// Utility
+// =============================================================================
+
+QString LinuxScsiQueue::resolveGenericPath(const QString& devicePath)
+{
+    QFileInfo info(devicePath);
+    QString canonical = info.canonicalFilePath();
+    if (canonical.isEmpty()) {
+        return QString();
+    }
+
+    QString name = QFileInfo(canonical).fileName();
+    if (name.startsWith(QLatin1String("sg"))) {
+        return canonical;
+    }
+
+    // nst0 / st0 / nst0a / st0l ... all share the scsi_tape entry "st0"
+    if (name.startsWith(QLatin1Char('n'))) {
+        name.remove(0, 1);
+    }
+    if (!name.startsWith(QLatin1String("st"))) {
+        return QString();
+    }
+    while (name.size() > 2 && !name.back().isDigit()) {
+        name.chop(1);
+    }
+
+    QDir genericDir(QStringLiteral("/sys/class/scsi_tape/%1/device/scsi_generic").arg(name));
+    const QStringList entries = genericDir.entryList(QStringList() << QStringLiteral("sg*"),
+                                                     QDir::Dirs | QDir::NoDotAndDotDot);
+    if (entries.isEmpty()) {
+        return QString();
+    }
+
+    return QStringLiteral("/dev/") + entries.first();
+}
+
+} // namespace qltfs
+
+#endif // Q_OS_LINUX
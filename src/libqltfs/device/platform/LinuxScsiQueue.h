@@ -0,0 +1,99 @@
+/**
+ * QLTOTapeMan - Qt-based LTO Tape Manager
+ * Linux Asynchronous SCSI Queue Header
+ *
+ * Copyright (c) 2026 Jeffrey ZHU (zhxsh1225@gmail.com)
+ * https://github.com/Gypsop/QLTOTapeMan
+ */
+
+#ifndef QLTFS_LINUXSCSIQUEUE_H
+#define QLTFS_LINUXSCSIQUEUE_H
+
+#include "../../libqltfs_global.h"
+#include "../ScsiCommandQueue.h"
+
+#include <QString>
+#include <QVector>
+
+#if defined(Q_OS_LINUX)
+
+namespace qltfs {
+
+/**
+ * @brief Asynchronous SCSI command queue on the Linux sg driver
+ *
+ * Submits sg_io_hdr (v3) requests with write() and reaps completions
+ * with read(), so several data commands can be queued to the HBA while
+ * the caller prepares the next buffers. Tape device nodes (/dev/nstX,
+ * /dev/stX) are mapped to their generic /dev/sgN node through sysfs,
+ * since only sg supports the asynchronous interface.
+ *
+ * Works alongside LinuxScsi / ScsiCommand on the same device; callers
+ * must reap all outstanding commands before issuing synchronous ones.
+ */
+class LIBQLTFS_EXPORT LinuxScsiQueue : public ScsiCommandQueue
+{
+public:
+    /**
+     * @brief Construct queue
+     * @param devicePath Tape or sg device path
+     * @param depth Commands in flight (clamped to the sg per-fd limit)
+     */
+    LinuxScsiQueue(const QString& devicePath, int depth);
+    ~LinuxScsiQueue() override;
+
+    bool open() override;
+    void close() override;
+    bool isOpen() const override;
+
+    int depth() const override { return m_depth; }
+    int pending() const override { return m_pending; }
+
+    bool submit(quint64 tag,
+                const QByteArray& cdb,
+                ScsiDataDirection direction,
+                void* buffer,
+                quint32 length) override;
+
+    bool reap(ScsiQueueCompletion& completion, int timeoutMs = -1) override;
+
+    QString lastError() const override { return m_lastError; }
+
+    /**
+     * @brief Get the sg node actually opened
+     */
+    QString genericPath() const { return m_genericPath; }
+
+    /**
+     * @brief Map a tape device path to its sg node
+     * @param devicePath /dev/sgN, /dev/stX, /dev/nstX or a symlink to one
+     * @return sg device path, or empty string if none was found
+     */
+    static QString resolveGenericPath(const QString& devicePath);
+
+private:
+    /**
+     * @brief Per-command storage that must live until the command is reaped
+     */
+    struct Slot {
+        bool busy = false;
+        quint64 tag = 0;
+        quint32 length = 0;
+        uint8_t cdb[16] = {};
+        uint8_t sense[252] = {};
+    };
+
+    QString m_devicePath;       ///< Path given by the caller
+    QString m_genericPath;      ///< Resolved sg node
+    int m_fd;                   ///< sg file descriptor
+    int m_depth;                ///< Maximum commands in flight
+    int m_pending;              ///< Submitted, not yet reaped
+    QVector<Slot> m_slots;
+    QString m_lastError;
+};
+
+} // namespace qltfs
+
+#endif // Q_OS_LINUX
+
+#endif // QLTFS_LINUXSCSIQUEUE_H
@@ -0,0 +1,1300 @@
+/**
+ * QLTOTapeMan - Qt-based LTO Tape Manager
+ * Virtual Tape Drive Implementation
+ *
+ * Copyright (c) 2026 Jeffrey ZHU (zhxsh1225@gmail.com)
+ * https://github.com/Gypsop/QLTOTapeMan
+ */
+
+#include "VirtualTape.h"
+
+#include <QBuffer>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QMutexLocker>
+#include <QThread>
+#include <QWeakPointer>
+#include <QtEndian>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace qltfs {
+
+static constexpr quint8 SCSI_STATUS_CHECK_CONDITION = 0x02;
+
+// Partition image layout: magic, then per record a little-endian
+// flags/length header followed by the payload
+static const char IMAGE_MAGIC[8] = { 'Q', 'L', 'T', 'F', 'S', 'V', 'T', '1' };
+static constexpr qint64 RECORD_HEADER_SIZE = 8;
+static constexpr quint32 RECORD_FILEMARK = 0x01;
+static constexpr quint32 RECORD_DISCARDED = 0x02;
+
+// Sense data flag bits (byte 2 of fixed format sense)
+static constexpr quint8 SENSE_FILEMARK = 0x80;
+static constexpr quint8 SENSE_EOM = 0x40;
+static constexpr quint8 SENSE_ILI = 0x20;
+
+// MAM attributes created with a new image
+static constexpr quint16 MAM_MEDIUM_MANUFACTURER = 0x0400;
+static constexpr quint16 MAM_MEDIUM_SERIAL = 0x0401;
+
+static const QString DEVICE_PREFIX = QStringLiteral("vtape:");
+
+namespace {
+
+QMutex &registryMutex()
+{
+    static QMutex mutex;
+    return mutex;
+}
+
+QHash<QString, QWeakPointer<VirtualTape>> &registry()
+{
+    static QHash<QString, QWeakPointer<VirtualTape>> drives;
+    return drives;
+}
+
+quint32 be24(const quint8 *p)
+{
+    return (static_cast<quint32>(p[0]) << 16) | (static_cast<quint32>(p[1]) << 8) | p[2];
+}
+
+void putBe24(quint8 *p, quint32 value)
+{
+    p[0] = static_cast<quint8>((value >> 16) & 0xFF);
+    p[1] = static_cast<quint8>((value >> 8) & 0xFF);
+    p[2] = static_cast<quint8>(value & 0xFF);
+}
+
+/**
+ * @brief Append one log parameter with a big-endian value
+ */
+void appendLogParameter(QByteArray &page, quint16 code, quint64 value, int size)
+{
+    const int offset = page.size();
+    page.resize(offset + 4 + size);
+    quint8 *p = reinterpret_cast<quint8 *>(page.data()) + offset;
+    qToBigEndian<quint16>(code, p);
+    p[2] = 0x60;    // Target save disable, list format binary
+    p[3] = static_cast<quint8>(size);
+    for (int i = 0; i < size; ++i) {
+        p[4 + i] = static_cast<quint8>((value >> (8 * (size - 1 - i))) & 0xFF);
+    }
+}
+
+/**
+ * @brief Parse a READ/WRITE ATTRIBUTE parameter list into id -> format + value
+ */
+void parseAttributeList(const quint8 *data, quint32 length, QMap<quint16, QByteArray> &attributes)
+{
+    if (length < 4) {
+        return;
+    }
+
+    const quint32 end = qMin(length, 4 + qFromBigEndian<quint32>(data));
+    quint32 offset = 4;
+    while (offset + 5 <= end) {
+        const quint16 id = qFromBigEndian<quint16>(data + offset);
+        const quint8 format = data[offset + 2];
+        const quint16 valueLength = qFromBigEndian<quint16>(data + offset + 3);
+        if (offset + 5 + valueLength > end) {
+            break;
+        }
+
+        // A zero-length value deletes the attribute
+        if (valueLength == 0) {
+            attributes.remove(id);
+        } else {
+            QByteArray value(1, static_cast<char>(format & 0x83));
+            value.append(reinterpret_cast<const char *>(data + offset + 5), valueLength);
+            attributes.insert(id, value);
+        }
+        offset += 5 + valueLength;
+    }
+}
+
+QByteArray buildAttributeList(const QMap<quint16, QByteArray> &attributes, quint16 firstId, bool valuesIncluded)
+{
+    QByteArray list(4, 0);
+    for (auto it = attributes.constBegin(); it != attributes.constEnd(); ++it) {
+        if (it.key() < firstId) {
+            continue;
+        }
+
+        char id[2];
+        qToBigEndian<quint16>(it.key(), id);
+        list.append(id, 2);
+        if (!valuesIncluded) {
+            continue;
+        }
+
+        const QByteArray value = it.value().mid(1);
+        char header[3];
+        header[0] = it.value().at(0);
+        qToBigEndian<quint16>(static_cast<quint16>(value.size()), header + 1);
+        list.append(header, 3);
+        list.append(value);
+    }
+    qToBigEndian<quint32>(static_cast<quint32>(list.size() - 4), list.data());
+    return list;
+}
+
+} // namespace
+
+// =============================================================================
+// VirtualTapeConfig
+// =============================================================================
+
+VirtualTapeConfig VirtualTapeConfig::fromDevicePath(const QString& devicePath, QString* error)
+{
+    VirtualTapeConfig config;
+    if (!devicePath.startsWith(DEVICE_PREFIX)) {
+        if (error) {
+            *error = QStringLiteral("Not a virtual tape path: %1").arg(devicePath);
+        }
+        return config;
+    }
+
+    const QString spec = devicePath.mid(DEVICE_PREFIX.size());
+    const int query = spec.indexOf(QLatin1Char('?'));
+    const QString path = query < 0 ? spec : spec.left(query);
+    if (!path.isEmpty() && path != QLatin1String("memory")) {
+        config.imagePath = path;
+    }
+
+    if (query < 0) {
+        return config;
+    }
+
+    const QStringList options = spec.mid(query + 1).split(QLatin1Char('&'), Qt::SkipEmptyParts);
+    for (const QString &option : options) {
+        const int eq = option.indexOf(QLatin1Char('='));
+        const QString key = option.left(eq).trimmed().toLower();
+        const QString text = eq < 0 ? QString() : option.mid(eq + 1).trimmed();
+        bool ok = true;
+        const double value = key == QLatin1String("density") ? text.toUInt(&ok, 0) : text.toDouble(&ok);
+
+        if (!ok || value < 0) {
+            if (error) {
+                *error = QStringLiteral("Invalid value for virtual tape option %1: %2").arg(key, text);
+            }
+            continue;
+        }
+
+        if (key == QLatin1String("latency")) {
+            config.commandLatencyUs = static_cast<int>(value);
+        } else if (key == QLatin1String("rate")) {
+            config.maxRate = value * 1e6;
+        } else if (key == QLatin1String("minrate")) {
+            config.minRate = value * 1e6;
+        } else if (key == QLatin1String("backhitch")) {
+            config.backhitchMs = static_cast<int>(value);
+        } else if (key == QLatin1String("buffer")) {
+            config.bufferSize = static_cast<quint64>(value * 1024 * 1024);
+        } else if (key == QLatin1String("capacity")) {
+            config.dataCapacity = static_cast<quint64>(value * 1e9);
+        } else if (key == QLatin1String("indexcap")) {
+            config.indexCapacity = static_cast<quint64>(value * 1e9);
+        } else if (key == QLatin1String("locate")) {
+            config.locateRate = value * 1e6;
+        } else if (key == QLatin1String("density")) {
+            config.densityCode = static_cast<quint8>(value);
+        } else if (key == QLatin1String("discard")) {
+            config.discardData = value != 0;
+        } else if (error) {
+            *error = QStringLiteral("Unknown virtual tape option: %1").arg(key);
+        }
+    }
+
+    return config;
+}
+
+// =============================================================================
+// Constructor / Destructor
+// =============================================================================
+
+VirtualTape::VirtualTape(const VirtualTapeConfig& config)
+    : m_config(config)
+    , m_partition(0)
+    , m_position(0)
+    , m_loaded(true)
+    , m_fixedBlockSize(0)
+    , m_compression(true)
+    , m_protectionMethod(0)
+    , m_hostBytesWritten(0)
+    , m_hostBytesRead(0)
+    , m_bufferBytes(0)
+    , m_lastWriteLength(0)
+    , m_speed(config.maxRate)
+    , m_hostRate(0)
+    , m_lastDrainNs(0)
+    , m_lastWriteNs(0)
+    , m_penalty(0)
+    , m_streaming(false)
+    , m_started(false)
+    , m_backhitches(0)
+{
+    m_clock.start();
+}
+
+VirtualTape::~VirtualTape()
+{
+    for (Partition &partition : m_partitions) {
+        if (partition.store) {
+            partition.store->close();
+        }
+    }
+}
+
+bool VirtualTape::isVirtualPath(const QString& devicePath)
+{
+    return devicePath.startsWith(DEVICE_PREFIX);
+}
+
+QSharedPointer<VirtualTape> VirtualTape::attach(const QString& devicePath, QString* error)
+{
+    QString parseError;
+    const VirtualTapeConfig config = VirtualTapeConfig::fromDevicePath(devicePath, &parseError);
+    if (!parseError.isEmpty()) {
+        if (error) {
+            *error = parseError;
+        }
+        return QSharedPointer<VirtualTape>();
+    }
+
+    // Handles on one image share the drive; the first one sets the timing
+    const QString key = config.imagePath.isEmpty()
+        ? devicePath
+        : QDir::cleanPath(QFileInfo(config.imagePath).absoluteFilePath());
+
+    QMutexLocker locker(&registryMutex());
+    QSharedPointer<VirtualTape> tape = registry().value(key).toStrongRef();
+    if (tape) {
+        return tape;
+    }
+
+    tape.reset(new VirtualTape(config));
+    if (!tape->load(error)) {
+        return QSharedPointer<VirtualTape>();
+    }
+
+    registry().insert(key, tape);
+    return tape;
+}
+
+// =============================================================================
+// Image Storage
+// =============================================================================
+
+bool VirtualTape::load(QString* error)
+{
+    if (!m_config.imagePath.isEmpty() && !QDir().mkpath(m_config.imagePath)) {
+        if (error) {
+            *error = QStringLiteral("Cannot create virtual tape image: %1").arg(m_config.imagePath);
+        }
+        return false;
+    }
+
+    for (int i = 0; i < 2; ++i) {
+        if (!openPartition(i, error)) {
+            return false;
+        }
+    }
+
+    if (!loadAttributes()) {
+        const quint32 id = static_cast<quint32>(qHash(m_config.imagePath));
+        const QByteArray serial = QStringLiteral("VT%1").arg(id, 8, 16, QLatin1Char('0')).toUpper().toLatin1();
+        m_attributes.insert(MAM_MEDIUM_MANUFACTURER, QByteArray(1, 0x01) + QByteArray("QLTFS   "));
+        m_attributes.insert(MAM_MEDIUM_SERIAL, QByteArray(1, 0x01) + serial.leftJustified(32, ' '));
+        saveAttributes();
+    }
+
+    return true;
+}
+
+bool VirtualTape::openPartition(int index, QString* error)
+{
+    Partition &partition = m_partitions[index];
+    partition.capacity = index == 0 ? m_config.indexCapacity : m_config.dataCapacity;
+
+    if (m_config.imagePath.isEmpty()) {
+        QBuffer *buffer = new QBuffer;
+        partition.store.reset(buffer);
+        buffer->open(QIODevice::ReadWrite);
+        buffer->write(IMAGE_MAGIC, sizeof(IMAGE_MAGIC));
+        return true;
+    }
+
+    const QString fileName = QDir(m_config.imagePath).filePath(QStringLiteral("partition%1.vtape").arg(index));
+    QFile *file = new QFile(fileName);
+    partition.store.reset(file);
+    if (!file->open(QIODevice::ReadWrite)) {
+        if (error) {
+            *error = QStringLiteral("Cannot open %1: %2").arg(fileName, file->errorString());
+        }
+        return false;
+    }
+
+    if (file->size() == 0) {
+        file->write(IMAGE_MAGIC, sizeof(IMAGE_MAGIC));
+        return true;
+    }
+
+    if (file->read(sizeof(IMAGE_MAGIC)) != QByteArray(IMAGE_MAGIC, sizeof(IMAGE_MAGIC))) {
+        if (error) {
+            *error = QStringLiteral("%1 is not a virtual tape image").arg(fileName);
+        }
+        return false;
+    }
+
+    // Rebuild the block index; a record cut short by a crash is dropped
+    const qint64 end = file->size();
+    qint64 pos = sizeof(IMAGE_MAGIC);
+    quint8 header[RECORD_HEADER_SIZE];
+    while (pos + RECORD_HEADER_SIZE <= end) {
+        if (!file->seek(pos) || file->read(reinterpret_cast<char *>(header), RECORD_HEADER_SIZE) != RECORD_HEADER_SIZE) {
+            break;
+        }
+
+        Record record;
+        record.flags = qFromLittleEndian<quint32>(header);
+        record.length = qFromLittleEndian<quint32>(header + 4);
+        record.offset = pos + RECORD_HEADER_SIZE;
+
+        const bool payload = (record.flags & (RECORD_FILEMARK | RECORD_DISCARDED)) == 0;
+        const qint64 next = record.offset + (payload ? record.length : 0);
+        if (next > end) {
+            break;
+        }
+
+        if (record.flags & RECORD_FILEMARK) {
+            partition.filemarks.append(static_cast<quint64>(partition.records.size()));
+        } else {
+            partition.bytes += record.length;
+        }
+        partition.records.append(record);
+        pos = next;
+    }
+
+    if (pos != end) {
+        file->resize(pos);
+    }
+
+    return true;
+}
+
+bool VirtualTape::loadAttributes()
+{
+    if (m_config.imagePath.isEmpty()) {
+        return false;
+    }
+
+    QFile file(QDir(m_config.imagePath).filePath(QStringLiteral("attributes.vtape")));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    const QByteArray data = file.readAll();
+    parseAttributeList(reinterpret_cast<const quint8 *>(data.constData()),
+                       static_cast<quint32>(data.size()), m_attributes);
+    return true;
+}
+
+void VirtualTape::saveAttributes()
+{
+    if (m_config.imagePath.isEmpty()) {
+        return;
+    }
+
+    QFile file(QDir(m_config.imagePath).filePath(QStringLiteral("attributes.vtape")));
+    if (file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        file.write(buildAttributeList(m_attributes, 0, true));
+    }
+}
+
+bool VirtualTape::appendRecord(const char* data, quint32 length, quint32 flags)
+{
+    Partition &partition = m_partitions[m_partition];
+    if (!(flags & RECORD_FILEMARK) && m_partition == 1 && m_config.discardData) {
+        flags |= RECORD_DISCARDED;
+    }
+
+    quint8 header[RECORD_HEADER_SIZE];
+    qToLittleEndian<quint32>(flags, header);
+    qToLittleEndian<quint32>(length, header + 4);
+
+    const qint64 pos = partition.store->size();
+    if (!partition.store->seek(pos) ||
+        partition.store->write(reinterpret_cast<const char *>(header), RECORD_HEADER_SIZE) != RECORD_HEADER_SIZE) {
+        return false;
+    }
+
+    const bool payload = (flags & (RECORD_FILEMARK | RECORD_DISCARDED)) == 0;
+    if (payload && partition.store->write(data, length) != static_cast<qint64>(length)) {
+        return false;
+    }
+
+    Record record;
+    record.offset = pos + RECORD_HEADER_SIZE;
+    record.length = length;
+    record.flags = flags;
+
+    if (flags & RECORD_FILEMARK) {
+        partition.filemarks.append(static_cast<quint64>(partition.records.size()));
+    } else {
+        partition.bytes += length;
+    }
+    partition.records.append(record);
+    m_position = static_cast<quint64>(partition.records.size());
+    return true;
+}
+
+void VirtualTape::truncateAt(quint64 position)
+{
+    Partition &partition = m_partitions[m_partition];
+    if (position >= static_cast<quint64>(partition.records.size())) {
+        return;
+    }
+
+    const qint64 end = partition.records.at(static_cast<int>(position)).offset - RECORD_HEADER_SIZE;
+    for (int i = static_cast<int>(position); i < partition.records.size(); ++i) {
+        if (!(partition.records.at(i).flags & RECORD_FILEMARK)) {
+            partition.bytes -= partition.records.at(i).length;
+        }
+    }
+    partition.records.resize(static_cast<int>(position));
+    while (!partition.filemarks.isEmpty() && partition.filemarks.last() >= position) {
+        partition.filemarks.removeLast();
+    }
+
+    if (QFile *file = qobject_cast<QFile *>(partition.store.data())) {
+        file->resize(end);
+    } else if (QBuffer *buffer = qobject_cast<QBuffer *>(partition.store.data())) {
+        buffer->buffer().resize(static_cast<qsizetype>(end));
+    }
+}
+
+void VirtualTape::moveTo(quint8 partition, quint64 position)
+{
+    if (m_config.locateRate > 0) {
+        // Charge the distance at the partition's average block size;
+        // changing partition goes through the beginning of the tape
+        const Partition &target = m_partitions[partition];
+        const qint64 blocks = target.records.size() - target.filemarks.size();
+        const double blockSize = blocks > 0 ? static_cast<double>(target.bytes) / blocks : 0.0;
+        const double distance = partition == m_partition
+            ? std::fabs(static_cast<double>(position) - static_cast<double>(m_position))
+            : static_cast<double>(position + m_position);
+        throttle(distance * blockSize / m_config.locateRate);
+    }
+
+    if (partition != m_partition || position != m_position) {
+        // A deliberate stop, not a backhitch
+        m_started = false;
+    }
+
+    m_partition = partition;
+    m_position = position;
+}
+
+// =============================================================================
+// Timing Model
+// =============================================================================
+
+void VirtualTape::drainBuffer(qint64 nowNs)
+{
+    double elapsed = (nowNs - m_lastDrainNs) / 1e9;
+    m_lastDrainNs = nowNs;
+    if (m_bufferBytes <= 0 || elapsed <= 0) {
+        return;
+    }
+
+    if (m_penalty > 0) {
+        const double used = qMin(elapsed, m_penalty);
+        m_penalty -= used;
+        elapsed -= used;
+    }
+
+    m_bufferBytes -= m_speed * elapsed;
+    if (m_bufferBytes <= 0) {
+        // Host fell behind: the tape has stopped
+        m_bufferBytes = 0;
+        m_streaming = false;
+    }
+}
+
+void VirtualTape::acceptWrite(quint64 bytes)
+{
+    if (m_config.maxRate <= 0) {
+        return;
+    }
+
+    const qint64 now = m_clock.nsecsElapsed();
+    drainBuffer(now);
+
+    if (!m_streaming) {
+        // Restarting after the buffer ran dry costs a reposition
+        if (m_started) {
+            m_backhitches++;
+            m_penalty = m_config.backhitchMs / 1000.0;
+        }
+        m_streaming = true;
+        m_started = true;
+    }
+
+    if (m_lastWriteNs > 0 && now > m_lastWriteNs) {
+        const double rate = bytes * 1e9 / (now - m_lastWriteNs);
+        m_hostRate = m_hostRate > 0 ? 0.8 * m_hostRate + 0.2 * rate : rate;
+    }
+    m_lastWriteNs = now;
+
+    // Speed matching: follow the host between the slowest and native
+    // speed, and run flat out when the buffer is nearly full
+    const double minRate = m_config.minRate > 0 ? qMin(m_config.minRate, m_config.maxRate) : m_config.maxRate / 3;
+    if (m_hostRate <= 0 || m_bufferBytes > 0.75 * m_config.bufferSize) {
+        m_speed = m_config.maxRate;
+    } else {
+        m_speed = qBound(minRate, m_hostRate, m_config.maxRate);
+    }
+
+    const double excess = m_bufferBytes + bytes - static_cast<double>(m_config.bufferSize);
+    if (excess > 0) {
+        throttle(m_penalty + excess / m_speed);
+        drainBuffer(m_clock.nsecsElapsed());
+    }
+
+    m_bufferBytes = qMin(m_bufferBytes + bytes, static_cast<double>(m_config.bufferSize));
+}
+
+void VirtualTape::flushBuffer()
+{
+    drainBuffer(m_clock.nsecsElapsed());
+    if (m_bufferBytes > 0 && m_speed > 0) {
+        throttle(m_penalty + m_bufferBytes / m_speed);
+        m_lastDrainNs = m_clock.nsecsElapsed();
+    }
+
+    m_bufferBytes = 0;
+    m_penalty = 0;
+    m_streaming = false;
+}
+
+void VirtualTape::throttle(double seconds)
+{
+    if (seconds > 0) {
+        QThread::usleep(static_cast<unsigned long>(seconds * 1e6));
+    }
+}
+
+// =============================================================================
+// Command Dispatch
+// =============================================================================
+
+ScsiCommandResult VirtualTape::good(quint32 bytesTransferred) const
+{
+    ScsiCommandResult result;
+    result.success = true;
+    result.bytesTransferred = bytesTransferred;
+    return result;
+}
+
+ScsiCommandResult VirtualTape::checkCondition(ScsiSenseKey key, quint8 asc, quint8 ascq,
+                                              quint8 flags, quint32 information,
+                                              quint32 bytesTransferred) const
+{
+    // Fixed format sense data
+    QByteArray sense(18, 0);
+    quint8 *s = reinterpret_cast<quint8 *>(sense.data());
+    s[0] = information != 0 ? 0xF0 : 0x70;
+    s[2] = flags | static_cast<quint8>(key);
+    qToBigEndian<quint32>(information, s + 3);
+    s[7] = 10;
+    s[12] = asc;
+    s[13] = ascq;
+
+    ScsiCommandResult result;
+    result.success = false;
+    result.scsiStatus = SCSI_STATUS_CHECK_CONDITION;
+    result.senseData = ScsiSenseData::fromRawData(sense);
+    result.bytesTransferred = bytesTransferred;
+    return result;
+}
+
+ScsiCommandResult VirtualTape::execute(const QByteArray& cdb,
+                                       ScsiDataDirection direction,
+                                       void* buffer,
+                                       quint32 length)
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (cdb.isEmpty()) {
+        return checkCondition(ScsiSenseKey::IllegalRequest, 0x20, 0x00);
+    }
+
+    const quint8 *c = reinterpret_cast<const quint8 *>(cdb.constData());
+    quint8 *data = static_cast<quint8 *>(buffer);
+    const quint32 dataLength = (direction == ScsiDataDirection::None || !buffer) ? 0 : length;
+    const ScsiOpCode op = static_cast<ScsiOpCode>(c[0]);
+
+    switch (op) {
+    case ScsiOpCode::Inquiry:
+    case ScsiOpCode::RequestSense:
+    case ScsiOpCode::LoadUnload:
+    case ScsiOpCode::ReadBlockLimits:
+        break;
+    default:
+        if (!m_loaded) {
+            return checkCondition(ScsiSenseKey::NotReady, 0x3A, 0x00);
+        }
+        break;
+    }
+
+    switch (op) {
+    case ScsiOpCode::TestUnitReady:
+    case ScsiOpCode::PreventAllowMediumRemoval:
+    case ScsiOpCode::Reserve:
+    case ScsiOpCode::Release:
+    case ScsiOpCode::AllowOverwrite:
+    case ScsiOpCode::LogSelect:
+        return good();
+
+    case ScsiOpCode::Inquiry:
+        return inquiry(c, data, dataLength);
+
+    case ScsiOpCode::RequestSense: {
+        if (dataLength < 18) {
+            return checkCondition(ScsiSenseKey::IllegalRequest, 0x24, 0x00);
+        }
+        memset(data, 0, 18);
+        data[0] = 0x70;
+        data[7] = 10;
+        return good(18);
+    }
+
+    case ScsiOpCode::ReadBlockLimits:
+        if (dataLength < 6) {
+            return checkCondition(ScsiSenseKey::IllegalRequest, 0x24, 0x00);
+        }
+        data[0] = 0;    // Granularity
+        putBe24(data + 1, MAX_TRANSFER_LENGTH);
+        qToBigEndian<quint16>(1, data + 4);
+        return good(6);
+
+    case ScsiOpCode::ModeSense10:
+        return modeSense(c, data, dataLength);
+
+    case ScsiOpCode::ModeSelect10:
+        return modeSelect(data, qMin<quint32>(dataLength, qFromBigEndian<quint16>(c + 7)));
+
+    case ScsiOpCode::LogSense:
+        return logSense(c, data, dataLength);
+
+    case ScsiOpCode::ReadPosition:
+        return readPosition(c, data, dataLength);
+
+    case ScsiOpCode::Read6:
+        return read(c, data, dataLength);
+
+    case ScsiOpCode::Write6:
+        return write(c, data, dataLength);
+
+    case ScsiOpCode::WriteFilemark:
+        return writeFilemarks(c);
+
+    case ScsiOpCode::Space:
+        return space(c);
+
+    case ScsiOpCode::Locate10:
+        return locate(c[8], qFromBigEndian<quint32>(c + 3), (c[1] & 0x02) != 0);
+
+    case ScsiOpCode::Locate16:
+        return locate(c[3], qFromBigEndian<quint64>(c + 4), (c[1] & 0x02) != 0);
+
+    case ScsiOpCode::Rewind:
+        flushBuffer();
+        moveTo(0, 0);
+        return good();
+
+    case ScsiOpCode::LoadUnload:
+        flushBuffer();
+        moveTo(0, 0);
+        m_loaded = (c[4] & 0x01) != 0;
+        return good();
+
+    case ScsiOpCode::Erase:
+        flushBuffer();
+        truncateAt(m_position);
+        return good();
+
+    case ScsiOpCode::FormatMedium:
+        flushBuffer();
+        for (quint8 p = 0; p < 2; ++p) {
+            m_partition = p;
+            truncateAt(0);
+        }
+        moveTo(0, 0);
+        return good();
+
+    case ScsiOpCode::ReadAttribute:
+        return readAttribute(c, data, dataLength);
+
+    case ScsiOpCode::WriteAttribute:
+        return writeAttribute(data, qMin<quint32>(dataLength, qFromBigEndian<quint32>(c + 10)));
+
+    default:
+        // RAO, REPORT DENSITY SUPPORT and the rest are not emulated
+        return checkCondition(ScsiSenseKey::IllegalRequest, 0x20, 0x00);
+    }
+}
+
+// =============================================================================
+// Command Handlers
+// =============================================================================
+
+ScsiCommandResult VirtualTape::inquiry(const quint8* cdb, quint8* buffer, quint32 length)
+{
+    QByteArray response;
+
+    if (cdb[1] & 0x01) {
+        const QByteArray serial = m_attributes.value(MAM_MEDIUM_SERIAL).mid(1).trimmed();
+        switch (cdb[2]) {
+        case 0x00:
+            response = QByteArray::fromHex("01000002" "0080");
+            break;
+        case 0x80:
+            response = QByteArray::fromHex("018000");
+            response.append(static_cast<char>(serial.size()));
+            response.append(serial);
+            break;
+        default:
+            return checkCondition(ScsiSenseKey::IllegalRequest, 0x24, 0x00);
+        }
+    } else {
+        response = QByteArray(36, 0);
+        response[0] = 0x01;     // Sequential access device
+        response[1] = static_cast<char>(0x80);  // Removable medium
+        response[2] = 0x06;     // SPC-4
+        response[3] = 0x02;
+        response[4] = 31;
+        response[7] = 0x02;     // Command queuing
+        memcpy(response.data() + 8, "QLTFS   ", 8);
+        memcpy(response.data() + 16, "VIRTUAL LTO     ", 16);
+        memcpy(response.data() + 32, "0001", 4);
+    }
+
+    const quint32 n = qMin(length, static_cast<quint32>(response.size()));
+    memcpy(buffer, response.constData(), n);
+    return good(n);
+}
+
+ScsiCommandResult VirtualTape::modeSense(const quint8* cdb, quint8* buffer, quint32 length)
+{
+    const quint8 pageCode = cdb[2] & 0x3F;
+    const quint8 subPageCode = cdb[3];
+
+    // Header and one block descriptor
+    QByteArray response(16, 0);
+    quint8 *r = reinterpret_cast<quint8 *>(response.data());
+    r[3] = 0x10;                // Buffered mode 1
+    r[7] = 8;                   // Block descriptor length
+    r[8] = m_config.densityCode;
+    putBe24(r + 13, m_fixedBlockSize);
+
+    auto appendCompressionPage = [this, &response]() {
+        QByteArray page(16, 0);
+        page[0] = 0x0F;
+        page[1] = 0x0E;
+        page[2] = static_cast<char>((m_compression ? 0x80 : 0x00) | 0x40);    // DCE, DCC
+        page[3] = static_cast<char>(0x80);                                  // DDE
+        page[7] = 0x01;         // Compression algorithm
+        page[11] = 0x01;        // Decompression algorithm
+        response.append(page);
+    };
+    auto appendDeviceConfigPage = [&response]() {
+        QByteArray page(16, 0);
+        page[0] = 0x10;
+        page[1] = 0x0E;
+        response.append(page);
+    };
+    auto appendPartitionPage = [this, &response]() {
+        QByteArray page(12, 0);
+        quint8 *p = reinterpret_cast<quint8 *>(page.data());
+        p[0] = 0x11;
+        p[1] = 0x0A;
+        p[2] = 1;               // Maximum additional partitions
+        p[3] = 1;               // Additional partitions defined
+        p[4] = 0x20 | 0x18;     // IDP, sizes in units of 10^p[6] bytes
+        p[5] = 0x03;            // Medium format recognition
+        p[6] = 9;               // Gigabytes
+        qToBigEndian<quint16>(static_cast<quint16>(qMin<quint64>(0xFFFF, m_config.indexCapacity / 1000000000ULL)), p + 8);
+        qToBigEndian<quint16>(static_cast<quint16>(qMin<quint64>(0xFFFF, m_config.dataCapacity / 1000000000ULL)), p + 10);
+        response.append(page);
+    };
+
+    switch (pageCode) {
+    case 0x00:
+        break;
+    case 0x0A: {
+        if (subPageCode != 0xF0) {
+            return checkCondition(ScsiSenseKey::IllegalRequest, 0x24, 0x00);
+        }
+        QByteArray page(32, 0);
+        page[0] = 0x40 | 0x0A;
+        page[1] = static_cast<char>(0xF0);
+        page[3] = 0x1C;
+        page[4] = static_cast<char>(m_protectionMethod);
+        page[5] = m_protectionMethod ? 4 : 0;
+        page[6] = static_cast<char>(m_protectionMethod ? 0xC0 : 0x00);
+        response.append(page);
+        break;
+    }
+    case 0x0F:
+        appendCompressionPage();
+        break;
+    case 0x10:
+        appendDeviceConfigPage();
+        break;
+    case 0x11:
+        appendPartitionPage();
+        break;
+    case 0x3F:
+        appendCompressionPage();
+        appendDeviceConfigPage();
+        appendPartitionPage();
+        break;
+    default:
+        return checkCondition(ScsiSenseKey::IllegalRequest, 0x24, 0x00);
+    }
+
+    qToBigEndian<quint16>(static_cast<quint16>(response.size() - 2), response.data());
+
+    const quint32 n = qMin(length, static_cast<quint32>(response.size()));
+    memcpy(buffer, response.constData(), n);
+    return good(n);
+}
+
+ScsiCommandResult VirtualTape::modeSelect(const quint8* buffer, quint32 length)
+{
+    if (length < 8) {
+        return checkCondition(ScsiSenseKey::IllegalRequest, 0x1A, 0x00);
+    }
+
+    const quint16 blockDescLength = qFromBigEndian<quint16>(buffer + 6);
+    if (blockDescLength >= 8 && length >= 16) {
+        const quint32 blockSize = be24(buffer + 13);
+        if (blockSize > MAX_TRANSFER_LENGTH) {
+            return checkCondition(ScsiSenseKey::IllegalRequest, 0x26, 0x00);
+        }
+        m_fixedBlockSize = blockSize;
+    }
+
+    quint32 offset = 8 + blockDescLength;
+    while (offset + 2 <= length) {
+        const quint8 pageCode = buffer[offset] & 0x3F;
+        const bool subPageFormat = (buffer[offset] & 0x40) != 0;
+        quint32 headerLength = 2;
+        quint32 pageLength = buffer[offset + 1];
+        if (subPageFormat) {
+            if (offset + 4 > length) {
+                break;
+            }
+            headerLength = 4;
+            pageLength = qFromBigEndian<quint16>(buffer + offset + 2);
+        }
+        if (offset + headerLength + pageLength > length) {
+            break;
+        }
+
+        if (pageCode == 0x0F && !subPageFormat && pageLength >= 1) {
+            m_compression = (buffer[offset + 2] & 0x80) != 0;
+        } else if (pageCode == 0x0A && subPageFormat && buffer[offset + 1] == 0xF0 && pageLength >= 1) {
+            // Protection information is stored and returned with the blocks
+            m_protectionMethod = buffer[offset + 4];
+        }
+
+        offset += headerLength + pageLength;
+    }
+
+    return good();
+}
+
+ScsiCommandResult VirtualTape::logSense(const quint8* cdb, quint8* buffer, quint32 length)
+{
+    const quint8 pageCode = cdb[2] & 0x3F;
+    drainBuffer(m_clock.nsecsElapsed());
+
+    QByteArray page(4, 0);
+    page[0] = static_cast<char>(pageCode);
+
+    // The drive does not compress; tape and host counters are equal
+    static constexpr quint64 MIB = 1024 * 1024;
+    switch (pageCode) {
+    case 0x00:
+        page.append(QByteArray::fromHex("0002030D1B303137"));
+        break;
+    case 0x02:
+    case 0x03:
+        break;
+    case 0x0D:
+        appendLogParameter(page, 0x0000, 35, 2);
+        break;
+    case 0x1B:
+        appendLogParameter(page, 0x0002, m_hostBytesRead / MIB, 4);
+        appendLogParameter(page, 0x0003, m_hostBytesRead % MIB, 4);
+        appendLogParameter(page, 0x0004, m_hostBytesRead / MIB, 4);
+        appendLogParameter(page, 0x0005, m_hostBytesRead % MIB, 4);
+        appendLogParameter(page, 0x0006, m_hostBytesWritten / MIB, 4);
+        appendLogParameter(page, 0x0007, m_hostBytesWritten % MIB, 4);
+        appendLogParameter(page, 0x0008, m_hostBytesWritten / MIB, 4);
+        appendLogParameter(page, 0x0009, m_hostBytesWritten % MIB, 4);
+        break;
+    case 0x30:
+        appendLogParameter(page, 0x0001, m_hostBytesWritten / MIB, 4);
+        appendLogParameter(page, 0x0002, m_hostBytesRead / MIB, 4);
+        appendLogParameter(page, 0x0008, 1, 4);
+        break;
+    case 0x31:
+        for (int i = 0; i < 2; ++i) {
+            const Partition &partition = m_partitions[i];
+            const quint64 used = qMin(partition.bytes, partition.capacity);
+            appendLogParameter(page, static_cast<quint16>(0x0001 + i), (partition.capacity - used) / MIB, 4);
+        }
+        for (int i = 0; i < 2; ++i) {
+            appendLogParameter(page, static_cast<quint16>(0x0003 + i), m_partitions[i].capacity / MIB, 4);
+        }
+        break;
+    case VENDOR_LOG_PAGE:
+        appendLogParameter(page, VENDOR_SPEED_PARAMETER,
+                           m_streaming ? static_cast<quint64>(m_speed / 1e6 + 0.5) : 0, 4);
+        appendLogParameter(page, VENDOR_BACKHITCH_PARAMETER, m_backhitches, 4);
+        break;
+    default:
+        return checkCondition(ScsiSenseKey::IllegalRequest, 0x24, 0x00);
+    }
+
+    qToBigEndian<quint16>(static_cast<quint16>(page.size() - 4), page.data() + 2);
+
+    const quint32 n = qMin(length, static_cast<quint32>(page.size()));
+    memcpy(buffer, page.constData(), n);
+    return good(n);
+}
+
+ScsiCommandResult VirtualTape::readPosition(const quint8* cdb, quint8* buffer, quint32 length)
+{
+    drainBuffer(m_clock.nsecsElapsed());
+
+    const Partition &partition = m_partitions[m_partition];
+    const quint32 objects = m_lastWriteLength > 0
+        ? static_cast<quint32>(std::ceil(m_bufferBytes / m_lastWriteLength)) : 0;
+    const quint64 bufferedBytes = static_cast<quint64>(m_bufferBytes);
+    const quint64 last = m_position - qMin<quint64>(m_position, objects);
+
+    quint8 flags = 0;
+    if (m_position == 0) {
+        flags |= 0x80;          // Beginning of partition
+    }
+    if (partition.bytes >= partition.capacity) {
+        flags |= 0x40;          // End of partition
+    }
+
+    QByteArray response;
+    switch (cdb[1] & 0x1F) {
+    case 0x00:
+    case 0x01: {
+        response = QByteArray(20, 0);
+        quint8 *r = reinterpret_cast<quint8 *>(response.data());
+        if (m_position > 0xFFFFFFFFULL) {
+            flags |= 0x04;      // Position does not fit the short form
+        }
+        r[0] = flags;
+        r[1] = m_partition;
+        qToBigEndian<quint32>(static_cast<quint32>(m_position), r + 4);
+        qToBigEndian<quint32>(static_cast<quint32>(last), r + 8);
+        putBe24(r + 13, objects);
+        qToBigEndian<quint32>(static_cast<quint32>(qMin<quint64>(bufferedBytes, 0xFFFFFFFFULL)), r + 16);
+        break;
+    }
+    case 0x06: {
+        response = QByteArray(32, 0);
+        quint8 *r = reinterpret_cast<quint8 *>(response.data());
+        const auto before = std::lower_bound(partition.filemarks.constBegin(), partition.filemarks.constEnd(), m_position);
+        r[0] = flags;
+        qToBigEndian<quint32>(m_partition, r + 4);
+        qToBigEndian<quint64>(m_position, r + 8);
+        qToBigEndian<quint64>(static_cast<quint64>(before - partition.filemarks.constBegin()), r + 16);
+        break;
+    }
+    case 0x08: {
+        response = QByteArray(32, 0);
+        quint8 *r = reinterpret_cast<quint8 *>(response.data());
+        r[0] = flags;
+        r[1] = m_partition;
+        qToBigEndian<quint16>(0x1C, r + 2);
+        putBe24(r + 5, objects);
+        qToBigEndian<quint64>(m_position, r + 8);
+        qToBigEndian<quint64>(last, r + 16);
+        qToBigEndian<quint64>(bufferedBytes, r + 24);
+        break;
+    }
+    default:
+        return checkCondition(ScsiSenseKey::IllegalRequest, 0x24, 0x00);
+    }
+
+    const quint32 n = qMin(length, static_cast<quint32>(response.size()));
+    memcpy(buffer, response.constData(), n);
+    return good(n);
+}
+
+ScsiCommandResult VirtualTape::read(const quint8* cdb, quint8* buffer, quint32 length)
+{
+    const bool fixed = (cdb[1] & 0x01) != 0;
+    const bool sili = (cdb[1] & 0x02) != 0;
+    const quint32 count = be24(cdb + 2);
+
+    if (fixed && (m_fixedBlockSize == 0 || static_cast<quint64>(count) * m_fixedBlockSize > length)) {
+        return checkCondition(ScsiSenseKey::IllegalRequest, 0x24, 0x00);
+    }
+    if (!fixed && count > length) {
+        return checkCondition(ScsiSenseKey::IllegalRequest, 0x24, 0x00);
+    }
+
+    // Buffered writes reach the tape before it can be read
+    flushBuffer();
+
+    Partition &partition = m_partitions[m_partition];
+    const quint32 blocks = fixed ? count : 1;
+    const quint32 blockLength = fixed ? m_fixedBlockSize : count;
+    quint32 transferred = 0;
+    ScsiCommandResult result = good();
+
+    for (quint32 i = 0; i < blocks; ++i) {
+        const quint32 residue = fixed ? blocks - i : count;
+        if (m_position >= static_cast<quint64>(partition.records.size())) {
+            result = checkCondition(ScsiSenseKey::BlankCheck, 0x00, 0x05, SENSE_EOM, residue, transferred);
+            break;
+        }
+
+        const Record &record = partition.records.at(static_cast<int>(m_position));
+        m_position++;
+        if (record.flags & RECORD_FILEMARK) {
+            result = checkCondition(ScsiSenseKey::NoSense, 0x00, 0x01, SENSE_FILEMARK, residue, transferred);
+            break;
+        }
+
+        const quint32 n = qMin(record.length, blockLength);
+        quint8 *dest = buffer + transferred;
+        if (record.flags & RECORD_DISCARDED) {
+            memset(dest, 0, n);
+        } else if (!partition.store->seek(record.offset) ||
+                   partition.store->read(reinterpret_cast<char *>(dest), n) != static_cast<qint64>(n)) {
+            result = checkCondition(ScsiSenseKey::MediumError, 0x11, 0x00, 0, residue, transferred);
+            break;
+        }
+        transferred += n;
+
+        if (record.length != blockLength) {
+            // Short blocks are fine in variable mode with SILI set
+            if (!fixed && sili && record.length < blockLength) {
+                result = good(transferred);
+                result.residual = blockLength - record.length;
+            } else {
+                const quint32 information = fixed ? blocks - i - 1 : blockLength - record.length;
+                result = checkCondition(ScsiSenseKey::NoSense, 0x00, 0x00, SENSE_ILI, information, transferred);
+            }
+            break;
+        }
+    }
+
+    if (result.success) {
+        result.bytesTransferred = transferred;
+    }
+
+    m_hostBytesRead += transferred;
+    if (m_config.maxRate > 0) {
+        throttle(transferred / m_config.maxRate);
+    }
+    return result;
+}
+
+ScsiCommandResult VirtualTape::write(const quint8* cdb, const quint8* buffer, quint32 length)
+{
+    const bool fixed = (cdb[1] & 0x01) != 0;
+    const quint32 count = be24(cdb + 2);
+    const quint32 blockLength = fixed ? m_fixedBlockSize : count;
+    const quint32 blocks = fixed ? count : 1;
+    const quint64 total = static_cast<quint64>(blocks) * blockLength;
+
+    if ((fixed && m_fixedBlockSize == 0) || total > length || blockLength > MAX_TRANSFER_LENGTH) {
+        return checkCondition(ScsiSenseKey::IllegalRequest, 0x24, 0x00);
+    }
+    if (total == 0) {
+        return good();
+    }
+
+    // Writing in the middle discards everything after it
+    truncateAt(m_position);
+
+    Partition &partition = m_partitions[m_partition];
+    if (partition.bytes + total > partition.capacity) {
+        return checkCondition(ScsiSenseKey::VolumeOverflow, 0x00, 0x02, SENSE_EOM, count);
+    }
+
+    const char *data = reinterpret_cast<const char *>(buffer);
+    for (quint32 i = 0; i < blocks; ++i) {
+        if (!appendRecord(data + static_cast<quint64>(i) * blockLength, blockLength, 0)) {
+            return checkCondition(ScsiSenseKey::MediumError, 0x0C, 0x00, 0, fixed ? blocks - i : count,
+                                  i * blockLength);
+        }
+    }
+
+    m_hostBytesWritten += total;
+    m_lastWriteLength = blockLength;
+    acceptWrite(total);
+    return good(static_cast<quint32>(total));
+}
+
+ScsiCommandResult VirtualTape::writeFilemarks(const quint8* cdb)
+{
+    const bool immediate = (cdb[1] & 0x01) != 0;
+    const quint32 count = be24(cdb + 2);
+
+    // Without the IMMED bit the drive synchronizes its buffer first
+    if (!immediate) {
+        flushBuffer();
+    }
+
+    truncateAt(m_position);
+    for (quint32 i = 0; i < count; ++i) {
+        if (!appendRecord(nullptr, 0, RECORD_FILEMARK)) {
+            return checkCondition(ScsiSenseKey::MediumError, 0x0C, 0x00, 0, count - i);
+        }
+    }
+
+    return good();
+}
+
+ScsiCommandResult VirtualTape::space(const quint8* cdb)
+{
+    const quint8 code = cdb[1] & 0x07;
+    qint32 count = static_cast<qint32>(be24(cdb + 2));
+    if (count & 0x800000) {
+        count -= 0x1000000;
+    }
+
+    flushBuffer();
+
+    const Partition &partition = m_partitions[m_partition];
+    const quint64 end = static_cast<quint64>(partition.records.size());
+    quint64 position = m_position;
+    ScsiCommandResult result = good();
+
+    switch (code) {
+    case 0: // Blocks
+        if (count >= 0) {
+            for (qint32 i = 0; i < count; ++i) {
+                if (position >= end) {
+                    result = checkCondition(ScsiSenseKey::BlankCheck, 0x00, 0x05, SENSE_EOM, count - i);
+                    break;
+                }
+                if (partition.records.at(static_cast<int>(position++)).flags & RECORD_FILEMARK) {
+                    result = checkCondition(ScsiSenseKey::NoSense, 0x00, 0x01, SENSE_FILEMARK, count - i);
+                    break;
+                }
+            }
+        } else {
+            for (qint32 i = 0; i < -count; ++i) {
+                if (position == 0) {
+                    result = checkCondition(ScsiSenseKey::NoSense, 0x00, 0x04, SENSE_EOM, -count - i);
+                    break;
+                }
+                if (partition.records.at(static_cast<int>(position - 1)).flags & RECORD_FILEMARK) {
+                    // Stop on the beginning-of-partition side of the filemark
+                    position--;
+                    result = checkCondition(ScsiSenseKey::NoSense, 0x00, 0x01, SENSE_FILEMARK, -count - i);
+                    break;
+                }
+                position--;
+            }
+        }
+        break;
+
+    case 1: { // Filemarks
+        const auto it = std::lower_bound(partition.filemarks.constBegin(), partition.filemarks.constEnd(), position);
+        const qint64 before = it - partition.filemarks.constBegin();
+        const qint64 target = count >= 0 ? before + count - 1 : before + count;
+        if (count == 0) {
+            break;
+        }
+        if (target < 0) {
+            position = 0;
+            result = checkCondition(ScsiSenseKey::NoSense, 0x00, 0x04, SENSE_EOM, static_cast<quint32>(-target));
+        } else if (target >= partition.filemarks.size()) {
+            position = end;
+            result = checkCondition(ScsiSenseKey::BlankCheck, 0x00, 0x05, SENSE_EOM,
+                                    static_cast<quint32>(target - partition.filemarks.size() + 1));
+        } else {
+            const quint64 filemark = partition.filemarks.at(static_cast<int>(target));
+            position = count >= 0 ? filemark + 1 : filemark;
+        }
+        break;
+    }
+
+    case 3: // End of data
+        position = end;
+        break;
+
+    default:
+        return checkCondition(ScsiSenseKey::IllegalRequest, 0x24, 0x00);
+    }
+
+    moveTo(m_partition, position);
+    return result;
+}
+
+ScsiCommandResult VirtualTape::locate(quint8 partition, quint64 block, bool changePartition)
+{
+    const quint8 target = changePartition ? partition : m_partition;
+    if (target > 1) {
+        return checkCondition(ScsiSenseKey::IllegalRequest, 0x24, 0x00);
+    }
+
+    flushBuffer();
+
+    const quint64 end = static_cast<quint64>(m_partitions[target].records.size());
+    moveTo(target, qMin(block, end));
+    if (block > end) {
+        return checkCondition(ScsiSenseKey::BlankCheck, 0x00, 0x05, SENSE_EOM);
+    }
+    return good();
+}
+
+ScsiCommandResult VirtualTape::readAttribute(const quint8* cdb, quint8* buffer, quint32 length)
+{
+    const quint8 serviceAction = cdb[1] & 0x1F;
+    const quint16 firstId = qFromBigEndian<quint16>(cdb + 8);
+    if (serviceAction > 1) {
+        return checkCondition(ScsiSenseKey::IllegalRequest, 0x24, 0x00);
+    }
+
+    const QByteArray response = buildAttributeList(m_attributes, firstId, serviceAction == 0);
+    const quint32 n = qMin(length, static_cast<quint32>(response.size()));
+    memcpy(buffer, response.constData(), n);
+    return good(n);
+}
+
+ScsiCommandResult VirtualTape::writeAttribute(const quint8* buffer, quint32 length)
+{
+    if (length < 4) {
+        return checkCondition(ScsiSenseKey::IllegalRequest, 0x1A, 0x00);
+    }
+
+    parseAttributeList(buffer, length, m_attributes);
+    saveAttributes();
+    return good();
+}
+
+} // namespace qltfs
@@ -0,0 +1,233 @@
+/**
+ * QLTOTapeMan - Qt-based LTO Tape Manager
+ * Virtual Tape Drive Header
+ *
+ * Copyright (c) 2026 Jeffrey ZHU (zhxsh1225@gmail.com)
+ * https://github.com/Gypsop/QLTOTapeMan
+ */
+
+#ifndef QLTFS_VIRTUALTAPE_H
+#define QLTFS_VIRTUALTAPE_H
+
+#include "../../libqltfs_global.h"
+#include "../ScsiCommand.h"
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QMap>
+#include <QMutex>
+#include <QScopedPointer>
+#include <QSharedPointer>
+#include <QString>
+#include <QVector>
+
+QT_BEGIN_NAMESPACE
+class QIODevice;
+QT_END_NAMESPACE
+
+namespace qltfs {
+
+/**
+ * @brief Settings of an emulated drive, parsed from its device path
+ *
+ * Device path syntax:
+ * @code
+ * vtape:<image directory>[?key=value&key=value...]
+ * vtape:memory[?...]
+ * @endcode
+ *
+ * Keys: latency (per-command latency, microseconds), rate (native
+ * streaming speed, MB/s), minrate (slowest speed matching step, MB/s),
+ * backhitch (reposition penalty, ms), buffer (drive buffer, MiB),
+ * capacity (data partition, GB), indexcap (index partition, GB),
+ * locate (positioning speed, MB/s), density (density code) and
+ * discard (1 = keep only block lengths on the data partition).
+ */
+struct LIBQLTFS_EXPORT VirtualTapeConfig {
+    QString imagePath;                      ///< Image directory (empty = in memory)
+    quint64 dataCapacity = 18000000000000ULL;   ///< Partition 1 capacity in bytes
+    quint64 indexCapacity = 37500000000ULL;     ///< Partition 0 capacity in bytes
+    int commandLatencyUs = 0;               ///< Transport latency added to every command
+    double maxRate = 0;                     ///< Native streaming speed in bytes/s (0 = unthrottled)
+    double minRate = 0;                     ///< Lowest speed matching step in bytes/s (0 = maxRate / 3)
+    int backhitchMs = 0;                    ///< Penalty when the drive restarts after its buffer ran dry
+    quint64 bufferSize = 1024ULL * 1024 * 1024; ///< Drive buffer in bytes
+    double locateRate = 0;                  ///< Bytes/s passed over by LOCATE and SPACE (0 = instant)
+    quint8 densityCode = 0x5E;              ///< Reported density (LTO-9)
+    bool discardData = false;               ///< Drop data partition payloads, return zeros on read
+
+    /**
+     * @brief Parse a vtape: device path
+     * @param devicePath Path as given to ScsiCommand
+     * @param error Set when a key or value is not understood
+     */
+    static VirtualTapeConfig fromDevicePath(const QString& devicePath, QString* error = nullptr);
+};
+
+/**
+ * @brief File-backed emulation of a two-partition LTO drive
+ *
+ * Stands in for the platform pass-through layer: ScsiCommand and
+ * ScsiCommandQueue hand it the same CDBs they would send to a real
+ * drive when the device path starts with "vtape:", so TapeDevice,
+ * TapeIO and everything above run unmodified against it.
+ *
+ * Each partition is an append-only record file in the image directory
+ * (partition0.vtape, partition1.vtape) holding blocks and filemarks;
+ * the block index is rebuilt from it on open, writes in the middle
+ * truncate the partition there like a real drive does. MAM attributes
+ * are kept in attributes.vtape. With discard set, data partition blocks
+ * are stored as length only, which keeps multi-terabyte runs sparse.
+ *
+ * Timing model: every command pays the configured latency. Writes go
+ * into a drive buffer that drains at a speed matched to the host rate
+ * between minRate and maxRate; when the host cannot keep up the buffer
+ * runs dry, the drive stops and the next write pays a backhitch.
+ * Filemarks, LOCATE, SPACE and reads wait for the buffer to flush.
+ * Buffer level is reported by extended READ POSITION and speed and
+ * backhitch count by vendor log page VENDOR_LOG_PAGE.
+ *
+ * Drives are shared by image: every handle opened on the same path
+ * (synchronous commands, the command queue) sees one tape. An in-memory
+ * tape lives as long as one of its handles is open. Commands are
+ * executed one at a time.
+ */
+class LIBQLTFS_EXPORT VirtualTape
+{
+public:
+    /// Vendor log page with the emulated drive counters
+    static constexpr quint8 VENDOR_LOG_PAGE = 0x37;
+    /// Parameter of VENDOR_LOG_PAGE: current tape speed in MB/s
+    static constexpr quint16 VENDOR_SPEED_PARAMETER = 0x0001;
+    /// Parameter of VENDOR_LOG_PAGE: backhitches since load
+    static constexpr quint16 VENDOR_BACKHITCH_PARAMETER = 0x0002;
+    /// Largest transfer accepted per command
+    static constexpr quint32 MAX_TRANSFER_LENGTH = 8 * 1024 * 1024;
+
+    ~VirtualTape();
+
+    // Prevent copying
+    VirtualTape(const VirtualTape&) = delete;
+    VirtualTape& operator=(const VirtualTape&) = delete;
+
+    /**
+     * @brief Check if a device path names a virtual drive
+     */
+    static bool isVirtualPath(const QString& devicePath);
+
+    /**
+     * @brief Get the drive for a device path, loading its image on first use
+     * @param devicePath vtape: path
+     * @param error Set on failure
+     * @return Shared drive, or null if the path or image is invalid
+     */
+    static QSharedPointer<VirtualTape> attach(const QString& devicePath, QString* error = nullptr);
+
+    /**
+     * @brief Execute one command against the emulated drive
+     *
+     * Thread-safe. Does not include the transport latency; callers add
+     * commandLatencyUs() the way their real counterpart would see it.
+     */
+    ScsiCommandResult execute(const QByteArray& cdb,
+                              ScsiDataDirection direction,
+                              void* buffer,
+                              quint32 length);
+
+    /**
+     * @brief Configured per-command latency in microseconds
+     */
+    int commandLatencyUs() const { return m_config.commandLatencyUs; }
+
+    /**
+     * @brief Settings the drive was created with
+     */
+    VirtualTapeConfig config() const { return m_config; }
+
+private:
+    /**
+     * @brief One block or filemark
+     */
+    struct Record {
+        qint64 offset = 0;          ///< Payload offset in the partition file
+        quint32 length = 0;         ///< Block length (0 for filemarks)
+        quint32 flags = 0;          ///< RECORD_* flags
+    };
+
+    struct Partition {
+        QScopedPointer<QIODevice> store;
+        QVector<Record> records;
+        QVector<quint64> filemarks; ///< Record numbers of filemarks, ascending
+        quint64 bytes = 0;          ///< Payload bytes written
+        quint64 capacity = 0;
+    };
+
+    explicit VirtualTape(const VirtualTapeConfig& config);
+
+    bool load(QString* error);
+    bool openPartition(int index, QString* error);
+    bool loadAttributes();
+    void saveAttributes();
+
+    // Command handlers
+    ScsiCommandResult inquiry(const quint8* cdb, quint8* buffer, quint32 length);
+    ScsiCommandResult modeSense(const quint8* cdb, quint8* buffer, quint32 length);
+    ScsiCommandResult modeSelect(const quint8* buffer, quint32 length);
+    ScsiCommandResult logSense(const quint8* cdb, quint8* buffer, quint32 length);
+    ScsiCommandResult readPosition(const quint8* cdb, quint8* buffer, quint32 length);
+    ScsiCommandResult read(const quint8* cdb, quint8* buffer, quint32 length);
+    ScsiCommandResult write(const quint8* cdb, const quint8* buffer, quint32 length);
+    ScsiCommandResult writeFilemarks(const quint8* cdb);
+    ScsiCommandResult space(const quint8* cdb);
+    ScsiCommandResult locate(quint8 partition, quint64 block, bool changePartition);
+    ScsiCommandResult readAttribute(const quint8* cdb, quint8* buffer, quint32 length);
+    ScsiCommandResult writeAttribute(const quint8* buffer, quint32 length);
+
+    // Tape operations
+    bool appendRecord(const char* data, quint32 length, quint32 flags);
+    void truncateAt(quint64 position);
+    void moveTo(quint8 partition, quint64 position);
+
+    // Timing model
+    void drainBuffer(qint64 nowNs);
+    void acceptWrite(quint64 bytes);
+    void flushBuffer();
+    void throttle(double seconds);
+
+    ScsiCommandResult good(quint32 bytesTransferred = 0) const;
+    ScsiCommandResult checkCondition(ScsiSenseKey key, quint8 asc, quint8 ascq,
+                                     quint8 flags = 0, quint32 information = 0,
+                                     quint32 bytesTransferred = 0) const;
+
+    VirtualTapeConfig m_config;
+    Partition m_partitions[2];
+    quint8 m_partition;             ///< Current partition
+    quint64 m_position;             ///< Current record number
+    bool m_loaded;
+    quint32 m_fixedBlockSize;       ///< 0 = variable block mode
+    bool m_compression;
+    quint8 m_protectionMethod;
+    QMap<quint16, QByteArray> m_attributes; ///< Id -> format byte + value
+
+    quint64 m_hostBytesWritten;
+    quint64 m_hostBytesRead;
+
+    // Drive buffer state
+    QElapsedTimer m_clock;
+    double m_bufferBytes;
+    quint32 m_lastWriteLength;
+    double m_speed;                 ///< Current tape speed in bytes/s
+    double m_hostRate;              ///< Smoothed host write rate in bytes/s
+    qint64 m_lastDrainNs;
+    qint64 m_lastWriteNs;
+    double m_penalty;               ///< Backhitch time still to be paid, seconds
+    bool m_streaming;
+    bool m_started;
+    quint64 m_backhitches;
+
+    mutable QMutex m_mutex;
+};
+
+} // namespace qltfs
+
+#endif // QLTFS_VIRTUALTAPE_H
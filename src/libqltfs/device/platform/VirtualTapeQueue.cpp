@@ -0,0 +1,188 @@
+/**
+ * QLTOTapeMan - Qt-based LTO Tape Manager
+ * Virtual Tape Command Queue Implementation
+ *
+ * Copyright (c) 2026 Jeffrey ZHU (zhxsh1225@gmail.com)
+ * https://github.com/Gypsop/QLTOTapeMan
+ */
+
+#include "VirtualTapeQueue.h"
+#include "VirtualTape.h"
+
+#include <QMutexLocker>
+#include <QThread>
+
+namespace qltfs {
+
+static constexpr int MAX_QUEUE_DEPTH = 64;
+
+// =============================================================================
+// Constructor / Destructor
+// =============================================================================
+
+VirtualTapeQueue::VirtualTapeQueue(const QString& devicePath, int depth)
+    : m_devicePath(devicePath)
+    , m_depth(qBound(1, depth, MAX_QUEUE_DEPTH))
+    , m_pending(0)
+    , m_stopping(false)
+{
+}
+
+VirtualTapeQueue::~VirtualTapeQueue()
+{
+    close();
+}
+
+// =============================================================================
+// Device Open / Close
+// =============================================================================
+
+bool VirtualTapeQueue::open()
+{
+    if (isOpen()) {
+        return true;
+    }
+
+    m_tape = VirtualTape::attach(m_devicePath, &m_lastError);
+    if (!m_tape) {
+        return false;
+    }
+
+    m_clock.start();
+    m_stopping = false;
+    m_worker.reset(QThread::create([this]() { run(); }));
+    m_worker->start();
+    return true;
+}
+
+void VirtualTapeQueue::close()
+{
+    if (!m_tape) {
+        return;
+    }
+
+    // The worker finishes every submitted command before it exits, so
+    // no caller buffer is touched after we return
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stopping = true;
+        m_submitted.wakeAll();
+    }
+    m_worker->wait();
+    m_worker.reset();
+
+    m_completions.clear();
+    m_pending = 0;
+    m_tape.reset();
+}
+
+bool VirtualTapeQueue::isOpen() const
+{
+    return !m_tape.isNull();
+}
+
+// =============================================================================
+// Submission / Completion
+// =============================================================================
+
+bool VirtualTapeQueue::submit(quint64 tag,
+                              const QByteArray& cdb,
+                              ScsiDataDirection direction,
+                              void* buffer,
+                              quint32 length)
+{
+    if (!isOpen()) {
+        m_lastError = QStringLiteral("Queue not open");
+        return false;
+    }
+
+    if (m_pending >= m_depth) {
+        m_lastError = QStringLiteral("Command queue full");
+        return false;
+    }
+
+    Command command;
+    command.tag = tag;
+    command.cdb = cdb;
+    command.direction = direction;
+    command.buffer = buffer;
+    command.length = length;
+
+    QMutexLocker locker(&m_mutex);
+    m_commands.enqueue(command);
+    m_pending++;
+    m_submitted.wakeOne();
+    return true;
+}
+
+bool VirtualTapeQueue::reap(ScsiQueueCompletion& completion, int timeoutMs)
+{
+    if (!isOpen()) {
+        m_lastError = QStringLiteral("Queue not open");
+        return false;
+    }
+
+    if (m_pending == 0) {
+        m_lastError = QStringLiteral("No commands pending");
+        return false;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    QMutexLocker locker(&m_mutex);
+    while (m_completions.isEmpty()) {
+        if (timeoutMs < 0) {
+            m_completed.wait(&m_mutex);
+            continue;
+        }
+
+        const qint64 remaining = timeoutMs - timer.elapsed();
+        if (remaining <= 0) {
+            m_lastError = QStringLiteral("Timed out waiting for command completion");
+            return false;
+        }
+        m_completed.wait(&m_mutex, static_cast<unsigned long>(remaining));
+    }
+
+    const Completion done = m_completions.dequeue();
+    locker.unlock();
+
+    const qint64 waitNs = done.readyNs - m_clock.nsecsElapsed();
+    if (waitNs > 0) {
+        QThread::usleep(static_cast<unsigned long>(waitNs / 1000));
+    }
+
+    completion.tag = done.tag;
+    completion.result = done.result;
+    m_pending--;
+    return true;
+}
+
+void VirtualTapeQueue::run()
+{
+    QMutexLocker locker(&m_mutex);
+    for (;;) {
+        while (m_commands.isEmpty() && !m_stopping) {
+            m_submitted.wait(&m_mutex);
+        }
+        if (m_commands.isEmpty()) {
+            return;
+        }
+
+        const Command command = m_commands.dequeue();
+        locker.unlock();
+
+        Completion done;
+        done.tag = command.tag;
+        done.result = m_tape->execute(command.cdb, command.direction, command.buffer, command.length);
+        // The latency overlaps with the commands queued behind this one
+        done.readyNs = m_clock.nsecsElapsed() + static_cast<qint64>(m_tape->commandLatencyUs()) * 1000;
+
+        locker.relock();
+        m_completions.enqueue(done);
+        m_completed.wakeAll();
+    }
+}
+
+} // namespace qltfs
@@ -0,0 +1,103 @@
+/**
+ * QLTOTapeMan - Qt-based LTO Tape Manager
+ * Virtual Tape Command Queue Header
+ *
+ * Copyright (c) 2026 Jeffrey ZHU (zhxsh1225@gmail.com)
+ * https://github.com/Gypsop/QLTOTapeMan
+ */
+
+#ifndef QLTFS_VIRTUALTAPEQUEUE_H
+#define QLTFS_VIRTUALTAPEQUEUE_H
+
+#include "../../libqltfs_global.h"
+#include "../ScsiCommandQueue.h"
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QQueue>
+#include <QScopedPointer>
+#include <QSharedPointer>
+#include <QString>
+#include <QWaitCondition>
+
+QT_BEGIN_NAMESPACE
+class QThread;
+QT_END_NAMESPACE
+
+namespace qltfs {
+
+class VirtualTape;
+
+/**
+ * @brief Asynchronous command queue on a VirtualTape
+ *
+ * A worker thread executes submitted commands in order against the
+ * shared drive while the caller keeps submitting. Each completion only
+ * becomes reapable once the drive's command latency has passed, so
+ * queue depth hides latency the same way it does on real hardware.
+ */
+class LIBQLTFS_EXPORT VirtualTapeQueue : public ScsiCommandQueue
+{
+public:
+    /**
+     * @brief Construct queue
+     * @param devicePath vtape: device path
+     * @param depth Commands in flight
+     */
+    VirtualTapeQueue(const QString& devicePath, int depth);
+    ~VirtualTapeQueue() override;
+
+    bool open() override;
+    void close() override;
+    bool isOpen() const override;
+
+    int depth() const override { return m_depth; }
+    int pending() const override { return m_pending; }
+
+    bool submit(quint64 tag,
+                const QByteArray& cdb,
+                ScsiDataDirection direction,
+                void* buffer,
+                quint32 length) override;
+
+    bool reap(ScsiQueueCompletion& completion, int timeoutMs = -1) override;
+
+    QString lastError() const override { return m_lastError; }
+
+private:
+    struct Command {
+        quint64 tag = 0;
+        QByteArray cdb;
+        ScsiDataDirection direction = ScsiDataDirection::None;
+        void* buffer = nullptr;
+        quint32 length = 0;
+    };
+
+    struct Completion {
+        quint64 tag = 0;
+        ScsiCommandResult result;
+        qint64 readyNs = 0;     ///< When the initiator sees the completion
+    };
+
+    void run();
+
+    QString m_devicePath;
+    int m_depth;
+    int m_pending;              ///< Submitted, not yet reaped
+    QSharedPointer<VirtualTape> m_tape;
+    QScopedPointer<QThread> m_worker;
+    QElapsedTimer m_clock;
+
+    QMutex m_mutex;
+    QWaitCondition m_submitted;
+    QWaitCondition m_completed;
+    QQueue<Command> m_commands;
+    QQueue<Completion> m_completions;
+    bool m_stopping;
+
+    QString m_lastError;
+};
+
+} // namespace qltfs
+
+#endif // QLTFS_VIRTUALTAPEQUEUE_H
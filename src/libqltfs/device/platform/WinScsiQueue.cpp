@@ -0,0 +1,267 @@
+/**
+ * QLTOTapeMan - Qt-based LTO Tape Manager
+ * Windows Asynchronous SCSI Queue Implementation
+ *
+ * Copyright (c) 2026 Jeffrey ZHU (zhxsh1225@gmail.com)
+ * https://github.com/Gypsop/QLTOTapeMan
+ */
+
+#include "WinScsiQueue.h"
+#include "WinScsi.h"
+
+#ifdef Q_OS_WIN
+
+#include <QDebug>
+
+namespace qltfs {
+
+static constexpr UCHAR SCSI_STATUS_GOOD = 0x00;
+
+// Upper bound on requests kept outstanding per handle
+static constexpr int MAX_QUEUE_DEPTH = 64;
+
+// =============================================================================
+// Constructor / Destructor
+// =============================================================================
+
+WinScsiQueue::WinScsiQueue(const QString& devicePath, int depth)
+    : m_devicePath(devicePath)
+    , m_deviceHandle(INVALID_HANDLE_VALUE)
+    , m_completionPort(nullptr)
+    , m_depth(qBound(1, depth, MAX_QUEUE_DEPTH))
+    , m_pending(0)
+    , m_slots(new Slot[static_cast<size_t>(m_depth)])
+{
+}
+
+WinScsiQueue::~WinScsiQueue()
+{
+    close();
+}
+
+// =============================================================================
+// Device Open / Close
+// =============================================================================
+
+bool WinScsiQueue::open()
+{
+    if (isOpen()) {
+        return true;
+    }
+
+    QString winPath = m_devicePath;
+    if (!winPath.startsWith(QStringLiteral("\\\\.\\"))) {
+        winPath = QStringLiteral("\\\\.\\") + winPath;
+    }
+
+    m_deviceHandle = CreateFileW(
+        reinterpret_cast<LPCWSTR>(winPath.utf16()),
+        GENERIC_READ | GENERIC_WRITE,
+        FILE_SHARE_READ | FILE_SHARE_WRITE,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OVERLAPPED,
+        nullptr
+    );
+
+    if (m_deviceHandle == INVALID_HANDLE_VALUE) {
+        m_lastError = QStringLiteral("Failed to open %1: %2")
+                          .arg(m_devicePath, WinScsi::formatWinError(GetLastError()));
+        return false;
+    }
+
+    // One completion port per handle; only this queue waits on it
+    m_completionPort = CreateIoCompletionPort(m_deviceHandle, nullptr, 0, 1);
+    if (!m_completionPort) {
+        m_lastError = QStringLiteral("Failed to create completion port: %1")
+                          .arg(WinScsi::formatWinError(GetLastError()));
+        CloseHandle(m_deviceHandle);
+        m_deviceHandle = INVALID_HANDLE_VALUE;
+        return false;
+    }
+
+    m_pending = 0;
+    for (int i = 0; i < m_depth; ++i) {
+        m_slots[i].busy = false;
+    }
+
+    return true;
+}
+
+void WinScsiQueue::close()
+{
+    if (m_deviceHandle == INVALID_HANDLE_VALUE) {
+        return;
+    }
+
+    // The kernel still references the slots and the caller's buffers of
+    // outstanding requests; wait for them before releasing anything
+    ScsiQueueCompletion completion;
+    while (m_pending > 0) {
+        if (!reap(completion, m_timeoutSeconds * 1000)) {
+            qWarning() << "WinScsiQueue: cancelling" << m_pending << "outstanding requests:" << m_lastError;
+            CancelIoEx(m_deviceHandle, nullptr);
+            while (m_pending > 0 && reap(completion, m_timeoutSeconds * 1000)) {
+            }
+            break;
+        }
+    }
+
+    CloseHandle(m_deviceHandle);
+    m_deviceHandle = INVALID_HANDLE_VALUE;
+
+    if (m_completionPort) {
+        CloseHandle(m_completionPort);
+        m_completionPort = nullptr;
+    }
+
+    m_pending = 0;
+}
+
+bool WinScsiQueue::isOpen() const
+{
+    return m_deviceHandle != INVALID_HANDLE_VALUE;
+}
+
+// =============================================================================
+// Submission / Completion
+// =============================================================================
+
+bool WinScsiQueue::submit(quint64 tag,
+                          const QByteArray& cdb,
+                          ScsiDataDirection direction,
+                          void* buffer,
+                          quint32 length)
+{
+    if (!isOpen()) {
+        m_lastError = QStringLiteral("Queue not open");
+        return false;
+    }
+
+    if (m_pending >= m_depth) {
+        m_lastError = QStringLiteral("Command queue full");
+        return false;
+    }
+
+    if (cdb.isEmpty() || cdb.size() > 16) {
+        m_lastError = QStringLiteral("Invalid CDB length: %1").arg(cdb.size());
+        return false;
+    }
+
+    int index = 0;
+    while (index < m_depth && m_slots[index].busy) {
+        ++index;
+    }
+
+    Slot& slot = m_slots[index];
+    slot.overlapped = OVERLAPPED();
+    slot.request = {};
+
+    SCSI_PASS_THROUGH_DIRECT& sptd = slot.request.sptd;
+    sptd.Length = sizeof(SCSI_PASS_THROUGH_DIRECT);
+    sptd.CdbLength = static_cast<UCHAR>(cdb.size());
+    sptd.SenseInfoLength = sizeof(slot.request.sense);
+    sptd.SenseInfoOffset = static_cast<ULONG>(offsetof(decltype(slot.request), sense));
+    sptd.TimeOutValue = static_cast<ULONG>(m_timeoutSeconds);
+    memcpy(sptd.Cdb, cdb.constData(), static_cast<size_t>(cdb.size()));
+
+    switch (direction) {
+    case ScsiDataDirection::None:
+        sptd.DataIn = SCSI_IOCTL_DATA_UNSPECIFIED;
+        break;
+    case ScsiDataDirection::ToDevice:
+        sptd.DataIn = SCSI_IOCTL_DATA_OUT;
+        break;
+    case ScsiDataDirection::FromDevice:
+        sptd.DataIn = SCSI_IOCTL_DATA_IN;
+        break;
+    }
+
+    if (direction != ScsiDataDirection::None && buffer && length > 0) {
+        sptd.DataBuffer = buffer;
+        sptd.DataTransferLength = static_cast<ULONG>(length);
+    }
+
+    BOOL ok = DeviceIoControl(
+        m_deviceHandle,
+        IOCTL_SCSI_PASS_THROUGH_DIRECT,
+        &slot.request,
+        sizeof(slot.request),
+        &slot.request,
+        sizeof(slot.request),
+        nullptr,
+        &slot.overlapped
+    );
+
+    // Immediate success is still reported through the completion port
+    if (!ok && GetLastError() != ERROR_IO_PENDING) {
+        m_lastError = QStringLiteral("DeviceIoControl failed: %1").arg(WinScsi::formatWinError(GetLastError()));
+        return false;
+    }
+
+    slot.busy = true;
+    slot.tag = tag;
+    m_pending++;
+
+    return true;
+}
+
+bool WinScsiQueue::reap(ScsiQueueCompletion& completion, int timeoutMs)
+{
+    if (!isOpen()) {
+        m_lastError = QStringLiteral("Queue not open");
+        return false;
+    }
+
+    if (m_pending == 0) {
+        m_lastError = QStringLiteral("No commands pending");
+        return false;
+    }
+
+    DWORD bytesReturned = 0;
+    ULONG_PTR key = 0;
+    LPOVERLAPPED overlapped = nullptr;
+
+    BOOL ok = GetQueuedCompletionStatus(m_completionPort, &bytesReturned, &key, &overlapped,
+                                        timeoutMs < 0 ? INFINITE : static_cast<DWORD>(timeoutMs));
+    DWORD error = ok ? ERROR_SUCCESS : GetLastError();
+
+    if (!overlapped) {
+        m_lastError = error == WAIT_TIMEOUT
+            ? QStringLiteral("Timed out waiting for command completion")
+            : QStringLiteral("GetQueuedCompletionStatus failed: %1").arg(WinScsi::formatWinError(error));
+        return false;
+    }
+
+    Slot* slot = CONTAINING_RECORD(overlapped, Slot, overlapped);
+    const SCSI_PASS_THROUGH_DIRECT& sptd = slot->request.sptd;
+
+    completion = ScsiQueueCompletion();
+    completion.tag = slot->tag;
+
+    ScsiCommandResult& result = completion.result;
+    if (!ok) {
+        // The request itself failed (cancelled, device removed, ...)
+        result.hostStatus = static_cast<int>(error);
+        result.success = false;
+    } else {
+        result.scsiStatus = sptd.ScsiStatus;
+        result.bytesTransferred = sptd.DataTransferLength;
+
+        if (sptd.SenseInfoLength > 0 && sptd.ScsiStatus != SCSI_STATUS_GOOD) {
+            result.senseData = ScsiSenseData::fromRawData(
+                QByteArray(reinterpret_cast<const char*>(slot->request.sense), sptd.SenseInfoLength));
+        }
+
+        result.success = (sptd.ScsiStatus == SCSI_STATUS_GOOD);
+    }
+
+    slot->busy = false;
+    m_pending--;
+
+    return true;
+}
+
+} // namespace qltfs
+
+#endif // Q_OS_WIN
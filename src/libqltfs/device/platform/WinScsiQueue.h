@@ -0,0 +1,91 @@
+/**
+ * QLTOTapeMan - Qt-based LTO Tape Manager
+ * Windows Asynchronous SCSI Queue Header
+ *
+ * Copyright (c) 2026 Jeffrey ZHU (zhxsh1225@gmail.com)
+ * https://github.com/Gypsop/QLTOTapeMan
+ */
+
+#ifndef QLTFS_WINSCSIQUEUE_H
+#define QLTFS_WINSCSIQUEUE_H
+
+#include "../../libqltfs_global.h"
+#include "../ScsiCommandQueue.h"
+
+#ifdef Q_OS_WIN
+
+#include <QString>
+#include <memory>
+#include <windows.h>
+#include <winioctl.h>
+#include <ntddscsi.h>
+
+namespace qltfs {
+
+/**
+ * @brief Asynchronous SCSI command queue on overlapped pass-through I/O
+ *
+ * Opens the device with FILE_FLAG_OVERLAPPED and issues
+ * IOCTL_SCSI_PASS_THROUGH_DIRECT without waiting; completions are
+ * collected from an I/O completion port bound to the handle. Keeps up
+ * to depth() requests outstanding on the drive.
+ *
+ * Works alongside WinScsi / ScsiCommand on the same device; callers
+ * must reap all outstanding commands before issuing synchronous ones.
+ */
+class LIBQLTFS_EXPORT WinScsiQueue : public ScsiCommandQueue
+{
+public:
+    /**
+     * @brief Construct queue
+     * @param devicePath Windows device path (e.g., \\.\Tape0)
+     * @param depth Commands in flight
+     */
+    WinScsiQueue(const QString& devicePath, int depth);
+    ~WinScsiQueue() override;
+
+    bool open() override;
+    void close() override;
+    bool isOpen() const override;
+
+    int depth() const override { return m_depth; }
+    int pending() const override { return m_pending; }
+
+    bool submit(quint64 tag,
+                const QByteArray& cdb,
+                ScsiDataDirection direction,
+                void* buffer,
+                quint32 length) override;
+
+    bool reap(ScsiQueueCompletion& completion, int timeoutMs = -1) override;
+
+    QString lastError() const override { return m_lastError; }
+
+private:
+    /**
+     * @brief Pass-through request and its OVERLAPPED, alive until reaped
+     */
+    struct Slot {
+        OVERLAPPED overlapped = {};
+        struct {
+            SCSI_PASS_THROUGH_DIRECT sptd;
+            UCHAR sense[252];
+        } request = {};
+        bool busy = false;
+        quint64 tag = 0;
+    };
+
+    QString m_devicePath;
+    HANDLE m_deviceHandle;
+    HANDLE m_completionPort;
+    int m_depth;                    ///< Maximum requests in flight
+    int m_pending;                  ///< Submitted, not yet reaped
+    std::unique_ptr<Slot[]> m_slots; ///< Fixed addresses, the kernel holds pointers into them
+    QString m_lastError;
+};
+
+} // namespace qltfs
+
+#endif // Q_OS_WIN
+
+#endif // QLTFS_WINSCSIQUEUE_H
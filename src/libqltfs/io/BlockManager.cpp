@@ -10,6 +10,14 @@
 
 #include <QDebug>
 
+#ifdef Q_OS_WIN
+#include <windows.h>
+#include <malloc.h>
+#else
+#include <unistd.h>
+#include <stdlib.h>
+#endif
+
 namespace qltfs {
 
 // =============================================================================
@@ -202,4 +210,176 @@ bool BlockManager::isValidBlockSize(uint32_t size)
     return (size % MIN_BLOCK_SIZE) == 0; // Multiple of 4KB
 }
 
+// =============================================================================
+// BlockPool
+// =============================================================================
+
+namespace {
+
+void *allocateAligned(size_t size, size_t alignment)
+{
+#ifdef Q_OS_WIN
+    return _aligned_malloc(size, alignment);
+#else
+    void *ptr = nullptr;
+    return posix_memalign(&ptr, alignment, size) == 0 ? ptr : nullptr;
+#endif
+}
+
+void freeAligned(void *ptr)
+{
+#ifdef Q_OS_WIN
+    _aligned_free(ptr);
+#else
+    free(ptr);
+#endif
+}
+
+} // namespace
+
+BlockPool::BlockPool(uint32_t blockSize, int blockCount)
+    : m_blockSize(blockSize)
+    , m_stride(0)
+    , m_blockCount(qMax(0, blockCount))
+    , m_arena(nullptr)
+    , m_freeHead(0)
+    , m_inUse(0)
+    , m_highWaterMark(0)
+    , m_acquires(0)
+    , m_exhausted(0)
+{
+    const size_t page = pageSize();
+    m_stride = (static_cast<size_t>(blockSize) + page - 1) / page * page;
+
+    if (m_blockCount > 0 && m_stride > 0) {
+        m_arena = static_cast<char *>(allocateAligned(m_stride * m_blockCount, page));
+    }
+    if (!m_arena) {
+        if (m_blockCount > 0) {
+            qWarning() << "BlockPool: failed to allocate" << m_blockCount << "blocks of" << blockSize;
+        }
+        m_blockCount = 0;
+        return;
+    }
+
+    // Chain all blocks into the free list
+    m_next.reset(new std::atomic<int>[m_blockCount]);
+    for (int i = 0; i < m_blockCount; ++i) {
+        m_next[i].store(i + 1 < m_blockCount ? i + 2 : 0, std::memory_order_relaxed);
+    }
+    m_freeHead.store(1, std::memory_order_release);
+}
+
+BlockPool::~BlockPool()
+{
+    if (m_inUse.load() != 0) {
+        qWarning() << "BlockPool destroyed with" << m_inUse.load() << "blocks still in use";
+    }
+    freeAligned(m_arena);
+}
+
+char *BlockPool::acquire()
+{
+    uint64_t head = m_freeHead.load(std::memory_order_acquire);
+
+    for (;;) {
+        uint32_t link = static_cast<uint32_t>(head & 0xFFFFFFFFu);
+        if (link == 0) {
+            m_exhausted.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        int index = static_cast<int>(link) - 1;
+        uint64_t next = static_cast<uint32_t>(m_next[index].load(std::memory_order_relaxed));
+        uint64_t tag = (head >> 32) + 1;
+        uint64_t newHead = (tag << 32) | next;
+
+        if (m_freeHead.compare_exchange_weak(head, newHead,
+                                             std::memory_order_acq_rel,
+                                             std::memory_order_acquire)) {
+            int used = m_inUse.fetch_add(1, std::memory_order_relaxed) + 1;
+            int peak = m_highWaterMark.load(std::memory_order_relaxed);
+            while (used > peak &&
+                   !m_highWaterMark.compare_exchange_weak(peak, used, std::memory_order_relaxed)) {
+            }
+            m_acquires.fetch_add(1, std::memory_order_relaxed);
+            return m_arena + static_cast<size_t>(index) * m_stride;
+        }
+    }
+}
+
+void BlockPool::release(char *block)
+{
+    int index = indexOf(block);
+    if (index < 0) {
+        if (block) {
+            qWarning() << "BlockPool: released a block that does not belong to the pool";
+        }
+        return;
+    }
+
+    uint64_t head = m_freeHead.load(std::memory_order_relaxed);
+    for (;;) {
+        m_next[index].store(static_cast<int>(head & 0xFFFFFFFFu), std::memory_order_relaxed);
+        uint64_t tag = (head >> 32) + 1;
+        uint64_t newHead = (tag << 32) | static_cast<uint32_t>(index + 1);
+
+        if (m_freeHead.compare_exchange_weak(head, newHead,
+                                             std::memory_order_release,
+                                             std::memory_order_relaxed)) {
+            break;
+        }
+    }
+
+    m_inUse.fetch_sub(1, std::memory_order_relaxed);
+}
+
+bool BlockPool::owns(const char *block) const
+{
+    return indexOf(block) >= 0;
+}
+
+int BlockPool::indexOf(const char *block) const
+{
+    if (!block || !m_arena || block < m_arena) {
+        return -1;
+    }
+
+    size_t offset = static_cast<size_t>(block - m_arena);
+    if (offset % m_stride != 0 || offset / m_stride >= static_cast<size_t>(m_blockCount)) {
+        return -1;
+    }
+    return static_cast<int>(offset / m_stride);
+}
+
+BlockPoolStats BlockPool::statistics() const
+{
+    BlockPoolStats stats;
+    stats.blockCount = m_blockCount;
+    stats.inUse = m_inUse.load(std::memory_order_relaxed);
+    stats.highWaterMark = m_highWaterMark.load(std::memory_order_relaxed);
+    stats.acquires = m_acquires.load(std::memory_order_relaxed);
+    stats.exhausted = m_exhausted.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void BlockPool::resetStatistics()
+{
+    m_highWaterMark.store(m_inUse.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    m_acquires.store(0, std::memory_order_relaxed);
+    m_exhausted.store(0, std::memory_order_relaxed);
+}
+
+size_t BlockPool::pageSize()
+{
+#ifdef Q_OS_WIN
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return static_cast<size_t>(info.dwPageSize);
+#else
+    long page = sysconf(_SC_PAGESIZE);
+    return page > 0 ? static_cast<size_t>(page) : 4096;
+#endif
+}
+
 } // namespace qltfs
@@ -16,6 +16,9 @@
 #include <QVector>
 #include <QMutex>
 
+#include <atomic>
+#include <memory>
+
 namespace qltfs {
 
 /**
@@ -229,6 +232,151 @@ private:
     mutable QMutex m_mutex;
 };
 
+/**
+ * @brief Usage statistics of a BlockPool
+ */
+struct LIBQLTFS_EXPORT BlockPoolStats {
+    int blockCount = 0;             ///< Blocks owned by the pool
+    int inUse = 0;                  ///< Blocks currently acquired
+    int highWaterMark = 0;          ///< Largest number of blocks in use at once
+    uint64_t acquires = 0;          ///< Successful acquire() calls
+    uint64_t exhausted = 0;         ///< acquire() calls that found the pool empty
+};
+
+/**
+ * @brief Fixed pool of page-aligned block buffers
+ *
+ * All blocks live in one page-aligned arena allocated up front, and each
+ * block starts on a page boundary so it satisfies SG direct I/O and SPTI
+ * alignment requirements. Blocks are recycled across files and transfers
+ * instead of being reallocated.
+ *
+ * acquire() and release() are lock-free (tagged free list) and may be
+ * called from any thread.
+ */
+class LIBQLTFS_EXPORT BlockPool
+{
+public:
+    /**
+     * @brief Constructor
+     * @param blockSize Size of each block in bytes
+     * @param blockCount Number of blocks in the pool
+     */
+    BlockPool(uint32_t blockSize, int blockCount);
+    ~BlockPool();
+
+    // Prevent copying
+    BlockPool(const BlockPool&) = delete;
+    BlockPool& operator=(const BlockPool&) = delete;
+
+    /**
+     * @brief Take a block from the pool
+     * @return Page-aligned block, or nullptr if all blocks are in use
+     */
+    char *acquire();
+
+    /**
+     * @brief Return a block obtained with acquire()
+     * @param block Block pointer (nullptr is ignored)
+     */
+    void release(char *block);
+
+    /**
+     * @brief Check if a pointer is a block of this pool
+     */
+    bool owns(const char *block) const;
+
+    /**
+     * @brief Get block size
+     */
+    uint32_t blockSize() const { return m_blockSize; }
+
+    /**
+     * @brief Get number of blocks in the pool
+     */
+    int blockCount() const { return m_blockCount; }
+
+    /**
+     * @brief Get number of blocks currently acquired
+     */
+    int inUse() const { return m_inUse.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Get usage statistics
+     */
+    BlockPoolStats statistics() const;
+
+    /**
+     * @brief Reset high-water mark and counters (keeps blocks in use)
+     */
+    void resetStatistics();
+
+    /**
+     * @brief Get the system memory page size
+     */
+    static size_t pageSize();
+
+private:
+    int indexOf(const char *block) const;
+
+    uint32_t m_blockSize;           ///< Usable size of each block
+    size_t m_stride;                ///< Distance between blocks (page multiple)
+    int m_blockCount;
+    char *m_arena;                  ///< Page-aligned backing memory
+
+    // Free list: low 32 bits hold (index + 1), high 32 bits an ABA tag
+    std::atomic<uint64_t> m_freeHead;
+    std::unique_ptr<std::atomic<int>[]> m_next;
+
+    std::atomic<int> m_inUse;
+    std::atomic<int> m_highWaterMark;
+    std::atomic<uint64_t> m_acquires;
+    std::atomic<uint64_t> m_exhausted;
+};
+
+/**
+ * @brief Scoped block taken from a BlockPool, released on destruction
+ */
+class LIBQLTFS_EXPORT PooledBlock
+{
+public:
+    explicit PooledBlock(BlockPool *pool)
+        : m_pool(pool)
+        , m_data(pool ? pool->acquire() : nullptr)
+    {
+    }
+
+    ~PooledBlock()
+    {
+        if (m_pool) {
+            m_pool->release(m_data);
+        }
+    }
+
+    // Prevent copying
+    PooledBlock(const PooledBlock&) = delete;
+    PooledBlock& operator=(const PooledBlock&) = delete;
+
+    /**
+     * @brief Get block storage (nullptr if the pool was exhausted)
+     */
+    char *data() const { return m_data; }
+
+    /**
+     * @brief Check if no block could be acquired
+     */
+    bool isNull() const { return m_data == nullptr; }
+
+    /**
+     * @brief Get block size in bytes
+     */
+    uint32_t size() const { return m_data ? m_pool->blockSize() : 0; }
+
+private:
+    BlockPool *m_pool;
+    char *m_data;
+};
+
 } // namespace qltfs
 
 #endif // QLTFS_BLOCKMANAGER_H
@@ -0,0 +1,247 @@
+/**
+ * QLTOTapeMan - Qt-based LTO Tape Manager
+ * Block Ring Implementation
+ *
+ * Copyright (c) 2026 Jeffrey ZHU (zhxsh1225@gmail.com)
+ * https://github.com/Gypsop/QLTOTapeMan
+ */
+
+#include "BlockRing.h"
+
+#include <QMutexLocker>
+
+namespace qltfs {
+
+// =============================================================================
+// Constructor / Destructor
+// =============================================================================
+
+BlockRing::BlockRing(int slotCount, uint32_t slotSize)
+    : m_ownedPool(new BlockPool(slotSize, qMax(2, slotCount)))
+    , m_pool(nullptr)
+    , m_slotSize(slotSize)
+    , m_writeIndex(0)
+    , m_readIndex(0)
+    , m_releaseIndex(0)
+    , m_filled(0)
+    , m_inUse(0)
+    , m_writeHeld(0)
+    , m_aborted(false)
+    , m_underruns(0)
+    , m_overruns(0)
+{
+    attachPool(m_ownedPool.data(), qMax(2, slotCount));
+}
+
+BlockRing::BlockRing(BlockPool *pool, int slotCount)
+    : m_pool(nullptr)
+    , m_slotSize(pool ? pool->blockSize() : 0)
+    , m_writeIndex(0)
+    , m_readIndex(0)
+    , m_releaseIndex(0)
+    , m_filled(0)
+    , m_inUse(0)
+    , m_writeHeld(0)
+    , m_aborted(false)
+    , m_underruns(0)
+    , m_overruns(0)
+{
+    attachPool(pool, slotCount);
+}
+
+BlockRing::~BlockRing()
+{
+    abort();
+
+    if (m_pool) {
+        for (const BlockSlot &slot : m_slots) {
+            m_pool->release(slot.data);
+        }
+    }
+}
+
+void BlockRing::attachPool(BlockPool *pool, int slotCount)
+{
+    m_pool = pool;
+    if (!m_pool) {
+        return;
+    }
+
+    m_slots.reserve(slotCount);
+    for (int i = 0; i < slotCount; ++i) {
+        char *block = m_pool->acquire();
+        if (!block) {
+            break;
+        }
+
+        BlockSlot slot;
+        slot.data = block;
+        slot.capacity = m_slotSize;
+        m_slots.append(slot);
+    }
+}
+
+// =============================================================================
+// Producer
+// =============================================================================
+
+BlockSlot *BlockRing::acquireWrite()
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (m_slots.isEmpty()) {
+        return nullptr;
+    }
+
+    if (!m_aborted && m_inUse + m_writeHeld >= m_slots.size()) {
+        m_overruns++;
+        while (!m_aborted && m_inUse + m_writeHeld >= m_slots.size()) {
+            m_notFull.wait(&m_mutex);
+        }
+    }
+
+    if (m_aborted) {
+        return nullptr;
+    }
+
+    return takeWriteSlot();
+}
+
+BlockSlot *BlockRing::tryAcquireWrite()
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (m_aborted || m_inUse + m_writeHeld >= m_slots.size()) {
+        return nullptr;
+    }
+
+    return takeWriteSlot();
+}
+
+BlockSlot *BlockRing::takeWriteSlot()
+{
+    // Called with m_mutex held and a slot known to be free
+    BlockSlot *slot = &m_slots[(m_writeIndex + m_writeHeld) % m_slots.size()];
+    slot->length = 0;
+    slot->last = false;
+    m_writeHeld++;
+    return slot;
+}
+
+void BlockRing::commitWrite(uint32_t length, bool last)
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (m_writeHeld == 0 || m_aborted) {
+        return;
+    }
+
+    BlockSlot &slot = m_slots[m_writeIndex];
+    slot.length = qMin(length, slot.capacity);
+    slot.last = last;
+
+    m_writeIndex = (m_writeIndex + 1) % m_slots.size();
+    m_writeHeld--;
+    m_filled++;
+    m_inUse++;
+
+    m_notEmpty.wakeOne();
+}
+
+// =============================================================================
+// Consumer
+// =============================================================================
+
+BlockSlot *BlockRing::acquireRead()
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (m_slots.isEmpty()) {
+        return nullptr;
+    }
+
+    if (!m_aborted && m_filled == 0) {
+        m_underruns++;
+        while (!m_aborted && m_filled == 0) {
+            m_notEmpty.wait(&m_mutex);
+        }
+    }
+
+    if (m_aborted) {
+        return nullptr;
+    }
+
+    BlockSlot *slot = &m_slots[m_readIndex];
+    m_readIndex = (m_readIndex + 1) % m_slots.size();
+    m_filled--;
+    return slot;
+}
+
+void BlockRing::releaseRead()
+{
+    QMutexLocker locker(&m_mutex);
+
+    // Only slots already handed to the consumer can be released
+    if (m_inUse - m_filled <= 0) {
+        return;
+    }
+
+    m_releaseIndex = (m_releaseIndex + 1) % m_slots.size();
+    m_inUse--;
+
+    m_notFull.wakeOne();
+}
+
+// =============================================================================
+// Control
+// =============================================================================
+
+void BlockRing::abort()
+{
+    QMutexLocker locker(&m_mutex);
+    m_aborted = true;
+    m_notFull.wakeAll();
+    m_notEmpty.wakeAll();
+}
+
+bool BlockRing::isAborted() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_aborted;
+}
+
+void BlockRing::reset()
+{
+    QMutexLocker locker(&m_mutex);
+    m_writeIndex = 0;
+    m_readIndex = 0;
+    m_releaseIndex = 0;
+    m_filled = 0;
+    m_inUse = 0;
+    m_writeHeld = 0;
+    m_aborted = false;
+}
+
+// =============================================================================
+// Statistics
+// =============================================================================
+
+int BlockRing::fillLevel() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_filled;
+}
+
+uint64_t BlockRing::underruns() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_underruns;
+}
+
+uint64_t BlockRing::overruns() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_overruns;
+}
+
+} // namespace qltfs
@@ -0,0 +1,187 @@
+/**
+ * QLTOTapeMan - Qt-based LTO Tape Manager
+ * Block Ring Header
+ *
+ * Copyright (c) 2026 Jeffrey ZHU (zhxsh1225@gmail.com)
+ * https://github.com/Gypsop/QLTOTapeMan
+ */
+
+#ifndef QLTFS_BLOCKRING_H
+#define QLTFS_BLOCKRING_H
+
+#include "../libqltfs_global.h"
+#include "BlockManager.h"
+
+#include <QScopedPointer>
+#include <QVector>
+#include <QMutex>
+#include <QWaitCondition>
+
+namespace qltfs {
+
+/**
+ * @brief One preallocated block in a BlockRing
+ */
+struct LIBQLTFS_EXPORT BlockSlot {
+    char *data = nullptr;           ///< Block storage (taken from the ring's pool)
+    uint32_t capacity = 0;          ///< Size of the storage in bytes
+    uint32_t length = 0;            ///< Valid bytes in this block
+    bool last = false;              ///< True if this is the final block of the stream
+};
+
+/**
+ * @brief Bounded single-producer / single-consumer ring of block buffers
+ *
+ * Decouples the disk side of a transfer from the tape side so the drive
+ * keeps streaming while the next blocks are being read. Slot storage is
+ * taken from a BlockPool once up front and recycled; no allocation
+ * happens per block.
+ *
+ * The producer calls acquireWrite() / commitWrite(), the consumer calls
+ * acquireRead() / releaseRead(). Either side may hold several slots at
+ * once (for reads or writes still in flight); commitWrite() always hands
+ * over the oldest acquired slot and releaseRead() always returns the
+ * oldest one to the producer.
+ */
+class LIBQLTFS_EXPORT BlockRing
+{
+public:
+    /**
+     * @brief Constructor
+     * @param slotCount Number of blocks in the ring (see BlockManager::recommendedBufferCount)
+     * @param slotSize Size of each block in bytes
+     */
+    BlockRing(int slotCount, uint32_t slotSize);
+
+    /**
+     * @brief Constructor using blocks from a shared pool
+     *
+     * Takes up to @p slotCount blocks from @p pool and returns them when
+     * the ring is destroyed. capacity() reports how many were obtained.
+     *
+     * @param pool Pool to take slot storage from (must outlive the ring)
+     * @param slotCount Desired number of blocks in the ring
+     */
+    BlockRing(BlockPool *pool, int slotCount);
+    ~BlockRing();
+
+    // Prevent copying
+    BlockRing(const BlockRing&) = delete;
+    BlockRing& operator=(const BlockRing&) = delete;
+
+    // === Producer ===
+
+    /**
+     * @brief Get the next free slot, waiting while the ring is full
+     * @return Slot to fill, or nullptr if the ring was aborted or has no slots
+     */
+    BlockSlot *acquireWrite();
+
+    /**
+     * @brief Get the next free slot without waiting
+     *
+     * For a producer that already holds slots: waiting for a free slot
+     * there could wait on a consumer that waits for those slots.
+     *
+     * @return Slot to fill, or nullptr if none is free or the ring was aborted
+     */
+    BlockSlot *tryAcquireWrite();
+
+    /**
+     * @brief Hand the oldest slot returned by acquireWrite() to the consumer
+     * @param length Valid bytes written into the slot
+     * @param last True if no more blocks will follow
+     */
+    void commitWrite(uint32_t length, bool last = false);
+
+    // === Consumer ===
+
+    /**
+     * @brief Get the next filled slot, waiting while the ring is empty
+     * @return Filled slot, or nullptr if the ring was aborted
+     */
+    BlockSlot *acquireRead();
+
+    /**
+     * @brief Return the oldest slot obtained with acquireRead() to the producer
+     */
+    void releaseRead();
+
+    // === Control ===
+
+    /**
+     * @brief Wake both sides and make all further acquires fail
+     */
+    void abort();
+
+    /**
+     * @brief Check if the ring was aborted
+     */
+    bool isAborted() const;
+
+    /**
+     * @brief Discard all queued blocks and clear the abort flag
+     *
+     * Must only be called while neither side is using the ring.
+     */
+    void reset();
+
+    // === Statistics ===
+
+    /**
+     * @brief Number of slots in the ring
+     */
+    int capacity() const { return m_slots.size(); }
+
+    /**
+     * @brief Size of each slot in bytes
+     */
+    uint32_t slotSize() const { return m_slotSize; }
+
+    /**
+     * @brief Number of filled slots not yet picked up by the consumer
+     */
+    int fillLevel() const;
+
+    /**
+     * @brief Number of times the consumer had to wait for data
+     *
+     * A high count means the source is the bottleneck.
+     */
+    uint64_t underruns() const;
+
+    /**
+     * @brief Number of times the producer had to wait for a free slot
+     *
+     * A high count means the destination is the bottleneck.
+     */
+    uint64_t overruns() const;
+
+private:
+    void attachPool(BlockPool *pool, int slotCount);
+    BlockSlot *takeWriteSlot();
+
+    QScopedPointer<BlockPool> m_ownedPool;  ///< Set when the ring allocated its own storage
+    BlockPool *m_pool;              ///< Pool the slot storage came from
+    QVector<BlockSlot> m_slots;
+    uint32_t m_slotSize;
+
+    int m_writeIndex;               ///< Next slot the producer fills
+    int m_readIndex;                ///< Next slot handed to the consumer
+    int m_releaseIndex;             ///< Oldest slot held by the consumer
+    int m_filled;                   ///< Committed, not yet acquired for read
+    int m_inUse;                    ///< Committed, not yet released
+    int m_writeHeld;                ///< Acquired by the producer, not yet committed
+    bool m_aborted;
+
+    uint64_t m_underruns;
+    uint64_t m_overruns;
+
+    mutable QMutex m_mutex;
+    QWaitCondition m_notFull;
+    QWaitCondition m_notEmpty;
+};
+
+} // namespace qltfs
+
+#endif // QLTFS_BLOCKRING_H
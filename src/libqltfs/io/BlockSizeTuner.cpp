@@ -0,0 +1,285 @@
+/*
+ * QLTOTapeMan - Qt-based LTO Tape Manager
+ * libqltfs - LTFS Core Library
+ *
+ * Copyright (c) 2026 Jeffrey ZHU (zhxsh1225@gmail.com)
+ * https://github.com/Gypsop/QLTOTapeMan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "BlockSizeTuner.h"
+#include "BlockManager.h"
+#include "util/LtfsUtility.h"
+
+#include <QElapsedTimer>
+#include <QSettings>
+
+#include <cstring>
+
+namespace qltfs {
+
+namespace {
+
+const QString SETTINGS_GROUP = QStringLiteral("DriveBlockSize");
+
+constexpr quint32 MIN_CANDIDATE = 256 * 1024;
+
+} // namespace
+
+// ============================================================================
+// BlockSizeTuner Private Implementation
+// ============================================================================
+
+class BlockSizeTuner::Private
+{
+public:
+    TapeDevice *device = nullptr;
+    QList<BlockSizeProbe> results;
+    QString lastError;
+
+    /**
+     * @brief Largest block size both the drive and BlockManager accept
+     */
+    quint32 upperLimit() const
+    {
+        quint32 limit = BlockManager::MAX_BLOCK_SIZE;
+        if (device) {
+            const quint32 driveMax = device->blockLimits().maxBlockLength;
+            if (driveMax > 0) {
+                limit = qMin(limit, driveMax);
+            }
+        }
+        return limit;
+    }
+
+    quint32 lowerLimit() const
+    {
+        quint32 limit = BlockManager::MIN_BLOCK_SIZE;
+        if (device) {
+            limit = qMax<quint32>(limit, device->blockLimits().minBlockLength);
+        }
+        return limit;
+    }
+
+    bool writePass(quint8 partition, quint64 startBlock, const char *data, quint32 blockSize,
+                   qint64 bytes, double &bytesPerSecond)
+    {
+        if (!device->locate(partition, startBlock)) {
+            lastError = QStringLiteral("Failed to locate scratch region: %1").arg(device->lastError());
+            return false;
+        }
+
+        QElapsedTimer timer;
+        timer.start();
+        for (qint64 written = 0; written < bytes; written += blockSize) {
+            if (device->writeBlock(data, blockSize) < 0) {
+                lastError = QStringLiteral("Write error with %1 byte blocks: %2")
+                                .arg(blockSize).arg(device->lastError());
+                return false;
+            }
+        }
+
+        // The filemark waits until the drive buffer is on tape
+        if (!device->writeFilemark(1)) {
+            lastError = QStringLiteral("Failed to write filemark: %1").arg(device->lastError());
+            return false;
+        }
+
+        const qint64 ms = qMax<qint64>(1, timer.elapsed());
+        bytesPerSecond = static_cast<double>(bytes) * 1000.0 / ms;
+        return true;
+    }
+};
+
+// ============================================================================
+// BlockSizeTuner Implementation
+// ============================================================================
+
+BlockSizeTuner::BlockSizeTuner(TapeDevice *device)
+    : d(new Private)
+{
+    d->device = device;
+}
+
+BlockSizeTuner::~BlockSizeTuner()
+{
+    delete d;
+}
+
+quint32 BlockSizeTuner::recommendedBlockSize(const QString &barcode) const
+{
+    if (d->device) {
+        const quint32 stored = storedBlockSize(d->device->deviceInfo().serialNumber);
+        if (stored > 0) {
+            return clamp(stored);
+        }
+    }
+
+    int generation = barcode.isEmpty() ? 0 : LtfsUtility::getLtoGenerationFromBarcode(barcode);
+    if (generation == 0 && d->device) {
+        generation = generationFromMediaType(d->device->mediaInfo().mediaType);
+    }
+
+    const quint32 table = generationBlockSize(generation);
+    return clamp(table > 0 ? table : BlockManager::DEFAULT_BLOCK_SIZE);
+}
+
+QList<quint32> BlockSizeTuner::candidates() const
+{
+    QList<quint32> sizes;
+    const quint32 upper = d->upperLimit();
+    for (quint32 size = qMax(MIN_CANDIDATE, d->lowerLimit()); size <= upper; size *= 2) {
+        sizes.append(size);
+    }
+    if (sizes.isEmpty()) {
+        sizes.append(clamp(BlockManager::DEFAULT_BLOCK_SIZE));
+    }
+    return sizes;
+}
+
+quint32 BlockSizeTuner::clamp(quint32 blockSize) const
+{
+    return qBound(d->lowerLimit(), blockSize, qMax(d->lowerLimit(), d->upperLimit()));
+}
+
+bool BlockSizeTuner::probe(quint8 partition, quint64 startBlock, qint64 bytesPerCandidate)
+{
+    d->results.clear();
+
+    if (!d->device || !d->device->isOpen()) {
+        d->lastError = QStringLiteral("Device not open");
+        return false;
+    }
+
+    const QList<quint32> sizes = candidates();
+    BlockPool pool(sizes.last(), 1);
+    char *data = pool.acquire();
+    if (!data) {
+        d->lastError = QStringLiteral("Failed to allocate probe buffer");
+        return false;
+    }
+
+    // Incompressible pattern, so hardware compression does not flatter the rate
+    quint64 state = 0x9E3779B97F4A7C15ULL;
+    for (quint32 i = 0; i + sizeof(quint64) <= sizes.last(); i += sizeof(quint64)) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        std::memcpy(data + i, &state, sizeof(state));
+    }
+
+    const bool wasFixed = d->device->isFixedBlockMode();
+    const quint32 previousBlockSize = d->device->blockSize();
+    if (wasFixed) {
+        d->device->setBlockSize(0);
+    }
+
+    bool ok = true;
+    for (quint32 size : sizes) {
+        BlockSizeProbe result;
+        result.blockSize = size;
+        const qint64 bytes = qMax<qint64>(size, bytesPerCandidate / size * size);
+        if (!d->writePass(partition, startBlock, data, size, bytes, result.bytesPerSecond)) {
+            ok = false;
+            break;
+        }
+        d->results.append(result);
+    }
+
+    pool.release(data);
+    d->device->locate(partition, startBlock);
+    if (wasFixed) {
+        d->device->setBlockSize(previousBlockSize);
+    }
+
+    if (ok && bestBlockSize() > 0) {
+        storeBlockSize(d->device->deviceInfo().serialNumber, bestBlockSize());
+    }
+    return ok;
+}
+
+QList<BlockSizeProbe> BlockSizeTuner::results() const
+{
+    return d->results;
+}
+
+quint32 BlockSizeTuner::bestBlockSize() const
+{
+    const BlockSizeProbe *best = nullptr;
+    for (const BlockSizeProbe &result : d->results) {
+        if (!best || result.bytesPerSecond > best->bytesPerSecond) {
+            best = &result;
+        }
+    }
+    return best ? best->blockSize : 0;
+}
+
+QString BlockSizeTuner::lastError() const
+{
+    return d->lastError;
+}
+
+quint32 BlockSizeTuner::generationBlockSize(int generation)
+{
+    // Larger blocks pay off as the native rate goes up
+    if (generation >= 7) {
+        return 1024 * 1024;
+    }
+    if (generation >= 5) {
+        return 512 * 1024;
+    }
+    if (generation >= 1) {
+        return 256 * 1024;
+    }
+    return 0;
+}
+
+int BlockSizeTuner::generationFromMediaType(const QString &mediaType)
+{
+    if (!mediaType.startsWith(QLatin1String("LTO-"))) {
+        return 0;
+    }
+    bool ok = false;
+    const int generation = mediaType.mid(4).toInt(&ok);
+    return ok ? generation : 0;
+}
+
+quint32 BlockSizeTuner::storedBlockSize(const QString &serialNumber)
+{
+    if (serialNumber.isEmpty()) {
+        return 0;
+    }
+
+    QSettings settings;
+    settings.beginGroup(SETTINGS_GROUP);
+    return settings.value(serialNumber.trimmed(), 0).toUInt();
+}
+
+void BlockSizeTuner::storeBlockSize(const QString &serialNumber, quint32 blockSize)
+{
+    if (serialNumber.isEmpty()) {
+        return;
+    }
+
+    QSettings settings;
+    settings.beginGroup(SETTINGS_GROUP);
+    if (blockSize == 0) {
+        settings.remove(serialNumber.trimmed());
+    } else {
+        settings.setValue(serialNumber.trimmed(), blockSize);
+    }
+}
+
+} // namespace qltfs
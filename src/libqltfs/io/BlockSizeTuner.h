@@ -0,0 +1,135 @@
+/*
+ * QLTOTapeMan - Qt-based LTO Tape Manager
+ * libqltfs - LTFS Core Library
+ *
+ * Copyright (c) 2026 Jeffrey ZHU (zhxsh1225@gmail.com)
+ * https://github.com/Gypsop/QLTOTapeMan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "libqltfs_global.h"
+#include "device/TapeDevice.h"
+
+#include <QList>
+#include <QString>
+
+namespace qltfs {
+
+/**
+ * @brief Sustained write rate measured for one block size
+ */
+struct LIBQLTFS_EXPORT BlockSizeProbe {
+    quint32 blockSize = 0;
+    double bytesPerSecond = 0.0;
+};
+
+/**
+ * @brief Picks the write block size for a drive
+ *
+ * The choice, in order of preference:
+ * 1. The size stored for the drive's serial number by an earlier probe()
+ * 2. The table value for the cartridge's LTO generation
+ * 3. BlockManager::DEFAULT_BLOCK_SIZE
+ *
+ * Every result is limited to what both the drive (READ BLOCK LIMITS)
+ * and BlockManager accept. The block size of an LTFS volume is fixed
+ * by its label, so the result is meant for formatting and for writes
+ * to volumes labelled with it.
+ */
+class LIBQLTFS_EXPORT BlockSizeTuner
+{
+public:
+    /**
+     * @brief Constructor
+     * @param device Open tape device
+     */
+    explicit BlockSizeTuner(TapeDevice *device);
+    ~BlockSizeTuner();
+
+    // Disable copy
+    BlockSizeTuner(const BlockSizeTuner &) = delete;
+    BlockSizeTuner &operator=(const BlockSizeTuner &) = delete;
+
+    /**
+     * @brief Block size for the drive and its loaded cartridge
+     * @param barcode Cartridge barcode if known; otherwise the media type reported by the drive is used
+     */
+    quint32 recommendedBlockSize(const QString &barcode = QString()) const;
+
+    /**
+     * @brief Block sizes worth probing on this drive, smallest first
+     */
+    QList<quint32> candidates() const;
+
+    /**
+     * @brief Limit a block size to the drive and BlockManager limits
+     */
+    quint32 clamp(quint32 blockSize) const;
+
+    /**
+     * @brief Measure the sustained write rate of each candidate
+     *
+     * Writes @p bytesPerCandidate of incompressible data per candidate
+     * from @p startBlock, each pass over the same stretch of tape and
+     * ended by a filemark so the drive buffer is flushed inside the
+     * measurement. The fastest size is stored for the drive serial.
+     *
+     * @warning Destroys all data from @p startBlock on @p partition.
+     *          Use a scratch cartridge or a blank one before formatting.
+     *
+     * @return false (with lastError() set) if a write failed
+     */
+    bool probe(quint8 partition, quint64 startBlock, qint64 bytesPerCandidate = 1024LL * 1024 * 1024);
+
+    /**
+     * @brief Rates measured by the last probe(), in candidate order
+     */
+    QList<BlockSizeProbe> results() const;
+
+    /**
+     * @brief Fastest block size of the last probe() (0 if none)
+     */
+    quint32 bestBlockSize() const;
+
+    QString lastError() const;
+
+    /**
+     * @brief Table block size for an LTO generation (0 if unknown)
+     */
+    static quint32 generationBlockSize(int generation);
+
+    /**
+     * @brief LTO generation from a media type such as "LTO-8" (0 if unknown)
+     */
+    static int generationFromMediaType(const QString &mediaType);
+
+    /**
+     * @brief Block size stored for a drive serial number (0 if none)
+     */
+    static quint32 storedBlockSize(const QString &serialNumber);
+
+    /**
+     * @brief Store the block size for a drive serial number (0 removes it)
+     */
+    static void storeBlockSize(const QString &serialNumber, quint32 blockSize);
+
+private:
+    class Private;
+    Private *d;
+};
+
+} // namespace qltfs
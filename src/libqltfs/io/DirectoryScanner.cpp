@@ -0,0 +1,507 @@
+/*
+ * QLTOTapeMan - Qt-based LTO Tape Manager
+ * libqltfs - LTFS Core Library
+ *
+ * Copyright (c) 2026 Jeffrey ZHU (zhxsh1225@gmail.com)
+ * https://github.com/Gypsop/QLTOTapeMan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "DirectoryScanner.h"
+
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QScopedPointer>
+#include <QThread>
+#include <QWaitCondition>
+
+#include <atomic>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#if defined(Q_OS_LINUX)
+#include <cstddef>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#elif defined(Q_OS_WIN)
+#include <windows.h>
+#endif
+
+namespace qltfs {
+
+namespace {
+
+/**
+ * @brief A directory waiting to be listed
+ */
+struct ScanTask {
+    QString path;
+    QString relativePath;
+};
+
+/**
+ * @brief Per-thread stack of directories; the owner pops the newest, thieves take the oldest
+ */
+struct ScanQueue {
+    QMutex mutex;
+    std::deque<ScanTask> tasks;
+};
+
+QString childRelative(const QString &parent, const QString &name)
+{
+    return parent.isEmpty() ? name : parent + QLatin1Char('/') + name;
+}
+
+#if defined(Q_OS_LINUX)
+
+/// Fixed part of struct linux_dirent64; the name follows d_type
+struct LinuxDirent64 {
+    quint64 d_ino;
+    qint64 d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+};
+
+constexpr size_t DIRENT_NAME_OFFSET = offsetof(LinuxDirent64, d_type) + 1;
+constexpr size_t DIRENT_BUFFER_SIZE = 256 * 1024;   ///< Entries fetched per getdents64 call
+
+#endif
+
+} // namespace
+
+// ============================================================================
+// DirectoryScanner Private Implementation
+// ============================================================================
+
+class DirectoryScanner::Private
+{
+public:
+    int threadCount = 4;
+    int batchSize = 1024;
+
+    std::vector<std::unique_ptr<ScanQueue>> queues;
+    std::atomic<qint64> outstanding{0};     ///< Directories queued or being listed
+    QMutex idleMutex;
+    QWaitCondition workAvailable;
+    std::atomic<bool> cancelled{false};
+
+    QMutex callbackMutex;
+    const ScanBatchCallback *callback = nullptr;
+
+    std::atomic<qint64> files{0};
+    std::atomic<qint64> directories{0};
+    std::atomic<qint64> bytes{0};
+    mutable QMutex errorMutex;
+    QStringList errors;
+    QString lastError;
+
+    void run(int worker);
+    bool nextTask(int worker, ScanTask &task);
+    void push(int worker, ScanTask task);
+    void finishTask();
+    void deliver(QList<ScanEntry> &batch);
+    bool list(int worker, const ScanTask &task, QList<ScanEntry> &batch, std::vector<char> &buffer);
+    void addEntry(int worker, const ScanTask &task, const QString &name, bool isDirectory,
+                  bool descend, qint64 size, qint64 mtimeMs, QList<ScanEntry> &batch);
+    void recordError(const QString &path);
+};
+
+void DirectoryScanner::Private::run(int worker)
+{
+    QList<ScanEntry> batch;
+    batch.reserve(batchSize);
+    std::vector<char> buffer;
+
+    ScanTask task;
+    while (nextTask(worker, task)) {
+        if (!list(worker, task, batch, buffer)) {
+            recordError(task.path);
+        }
+        finishTask();
+
+        if (batch.size() >= batchSize) {
+            deliver(batch);
+        }
+    }
+
+    if (!cancelled) {
+        deliver(batch);
+    }
+}
+
+bool DirectoryScanner::Private::nextTask(int worker, ScanTask &task)
+{
+    const int count = static_cast<int>(queues.size());
+
+    for (;;) {
+        if (cancelled) {
+            return false;
+        }
+
+        // Own stack first (depth first keeps it small), then steal the
+        // oldest, and so usually largest, subtree of another worker
+        for (int i = 0; i < count; ++i) {
+            ScanQueue &queue = *queues[(worker + i) % count];
+            QMutexLocker locker(&queue.mutex);
+            if (!queue.tasks.empty()) {
+                if (i == 0) {
+                    task = std::move(queue.tasks.back());
+                    queue.tasks.pop_back();
+                } else {
+                    task = std::move(queue.tasks.front());
+                    queue.tasks.pop_front();
+                }
+                return true;
+            }
+        }
+
+        QMutexLocker locker(&idleMutex);
+        if (outstanding == 0) {
+            return false;
+        }
+
+        bool anyWork = false;
+        for (const auto &queue : queues) {
+            QMutexLocker queueLocker(&queue->mutex);
+            anyWork = anyWork || !queue->tasks.empty();
+        }
+        if (!anyWork && !cancelled) {
+            workAvailable.wait(&idleMutex);
+        }
+    }
+}
+
+void DirectoryScanner::Private::push(int worker, ScanTask task)
+{
+    outstanding++;
+    {
+        QMutexLocker locker(&queues[worker]->mutex);
+        queues[worker]->tasks.push_back(std::move(task));
+    }
+
+    QMutexLocker locker(&idleMutex);
+    workAvailable.wakeOne();
+}
+
+void DirectoryScanner::Private::finishTask()
+{
+    if (--outstanding == 0) {
+        QMutexLocker locker(&idleMutex);
+        workAvailable.wakeAll();
+    }
+}
+
+void DirectoryScanner::Private::deliver(QList<ScanEntry> &batch)
+{
+    if (batch.isEmpty()) {
+        return;
+    }
+
+    QMutexLocker locker(&callbackMutex);
+    if (!cancelled) {
+        (*callback)(batch);
+    }
+    batch.clear();
+}
+
+void DirectoryScanner::Private::addEntry(int worker, const ScanTask &task, const QString &name,
+                                         bool isDirectory, bool descend, qint64 size,
+                                         qint64 mtimeMs, QList<ScanEntry> &batch)
+{
+    ScanEntry entry;
+    entry.path = task.path + QLatin1Char('/') + name;
+    entry.relativePath = childRelative(task.relativePath, name);
+    entry.isDirectory = isDirectory;
+    entry.size = isDirectory ? 0 : size;
+    entry.modifiedTime = QDateTime::fromMSecsSinceEpoch(mtimeMs, Qt::UTC);
+
+    if (isDirectory) {
+        directories++;
+        if (descend) {
+            push(worker, ScanTask{entry.path, entry.relativePath});
+        }
+    } else {
+        files++;
+        bytes += entry.size;
+    }
+
+    batch.append(std::move(entry));
+}
+
+bool DirectoryScanner::Private::list(int worker, const ScanTask &task, QList<ScanEntry> &batch,
+                                     std::vector<char> &buffer)
+{
+#if defined(Q_OS_LINUX)
+    const int fd = ::open(QFile::encodeName(task.path).constData(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+
+    buffer.resize(DIRENT_BUFFER_SIZE);
+    bool ok = true;
+    for (;;) {
+        const long read = ::syscall(SYS_getdents64, fd, buffer.data(), buffer.size());
+        if (read <= 0) {
+            ok = read == 0;
+            break;
+        }
+
+        for (long pos = 0; pos < read && !cancelled;) {
+            const char *record = buffer.data() + pos;
+            LinuxDirent64 header;
+            memcpy(&header, record, sizeof(header));
+            pos += header.d_reclen;
+
+            const char *name = record + DIRENT_NAME_OFFSET;
+            if (name[0] == '.') {
+                continue;   // ".", ".." and hidden entries
+            }
+
+            // QFileInfo semantics: links are reported as their target
+            struct stat st;
+            if (::fstatat(fd, name, &st, 0) != 0) {
+                continue;   // Broken link or vanished
+            }
+
+            bool link = header.d_type == DT_LNK;
+            if (header.d_type == DT_UNKNOWN) {
+                struct stat lst;
+                link = ::fstatat(fd, name, &lst, AT_SYMLINK_NOFOLLOW) == 0 && S_ISLNK(lst.st_mode);
+            }
+
+            const bool isDirectory = S_ISDIR(st.st_mode);
+            if (!isDirectory && !S_ISREG(st.st_mode)) {
+                continue;   // Devices, sockets, pipes
+            }
+
+            const qint64 mtimeMs = static_cast<qint64>(st.st_mtim.tv_sec) * 1000 + st.st_mtim.tv_nsec / 1000000;
+            addEntry(worker, task, QFile::decodeName(name), isDirectory, isDirectory && !link,
+                     static_cast<qint64>(st.st_size), mtimeMs, batch);
+        }
+    }
+
+    ::close(fd);
+    return ok;
+#elif defined(Q_OS_WIN)
+    Q_UNUSED(buffer);
+
+    const QString pattern = QDir::toNativeSeparators(task.path) + QStringLiteral("\\*");
+    WIN32_FIND_DATAW data;
+    HANDLE handle = FindFirstFileExW(reinterpret_cast<const wchar_t *>(pattern.utf16()),
+                                     FindExInfoBasic, &data, FindExSearchNameMatch,
+                                     nullptr, FIND_FIRST_EX_LARGE_FETCH);
+    if (handle == INVALID_HANDLE_VALUE) {
+        return GetLastError() == ERROR_FILE_NOT_FOUND;
+    }
+
+    do {
+        if (cancelled) {
+            break;
+        }
+
+        const QString name = QString::fromWCharArray(data.cFileName);
+        if (name == QLatin1String(".") || name == QLatin1String("..") ||
+            (data.dwFileAttributes & (FILE_ATTRIBUTE_HIDDEN | FILE_ATTRIBUTE_SYSTEM))) {
+            continue;
+        }
+
+        const bool isDirectory = data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY;
+        const bool link = data.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT;
+        const qint64 size = (static_cast<qint64>(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+
+        // FILETIME counts 100 ns intervals since 1601-01-01
+        const qint64 fileTime = (static_cast<qint64>(data.ftLastWriteTime.dwHighDateTime) << 32) |
+                                data.ftLastWriteTime.dwLowDateTime;
+        const qint64 mtimeMs = (fileTime - 116444736000000000LL) / 10000;
+
+        addEntry(worker, task, name, isDirectory, isDirectory && !link, size, mtimeMs, batch);
+    } while (FindNextFileW(handle, &data));
+
+    FindClose(handle);
+    return true;
+#else
+    Q_UNUSED(buffer);
+
+    QDir dir(task.path);
+    if (!dir.isReadable()) {
+        return false;
+    }
+
+    QDirIterator it(task.path, QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot);
+    while (it.hasNext() && !cancelled) {
+        it.next();
+        const QFileInfo info = it.fileInfo();
+        addEntry(worker, task, info.fileName(), info.isDir(), info.isDir() && !info.isSymLink(),
+                 info.size(), info.lastModified().toMSecsSinceEpoch(), batch);
+    }
+    return true;
+#endif
+}
+
+void DirectoryScanner::Private::recordError(const QString &path)
+{
+    QMutexLocker locker(&errorMutex);
+    errors.append(path);
+}
+
+// ============================================================================
+// DirectoryScanner Implementation
+// ============================================================================
+
+DirectoryScanner::DirectoryScanner(int threadCount)
+    : d(new Private)
+{
+    // Listing is mostly waiting for the file system, so use more threads than cores
+    d->threadCount = threadCount > 0 ? threadCount : qBound(4, QThread::idealThreadCount() * 2, 32);
+}
+
+DirectoryScanner::~DirectoryScanner()
+{
+    delete d;
+}
+
+void DirectoryScanner::setBatchSize(int size)
+{
+    d->batchSize = qMax(1, size);
+}
+
+int DirectoryScanner::batchSize() const
+{
+    return d->batchSize;
+}
+
+bool DirectoryScanner::scan(const QString &rootPath, const ScanBatchCallback &callback)
+{
+    d->cancelled = false;
+    d->files = 0;
+    d->directories = 0;
+    d->bytes = 0;
+    d->outstanding = 0;
+    d->errors.clear();
+    d->lastError.clear();
+
+    QFileInfo root(rootPath);
+    if (!root.isDir()) {
+        d->lastError = QStringLiteral("Directory does not exist: %1").arg(rootPath);
+        return false;
+    }
+    if (!callback) {
+        d->lastError = QStringLiteral("No callback");
+        return false;
+    }
+
+    d->callback = &callback;
+    d->queues.clear();
+    for (int i = 0; i < d->threadCount; ++i) {
+        d->queues.push_back(std::make_unique<ScanQueue>());
+    }
+
+    const QString basePath = root.absoluteFilePath();
+
+    // The root is listed by the calling thread before the others start
+    QList<ScanEntry> batch;
+    std::vector<char> buffer;
+    d->outstanding++;
+    const bool rootListed = d->list(0, ScanTask{basePath, QString()}, batch, buffer);
+    d->finishTask();
+    if (!rootListed) {
+        d->lastError = QStringLiteral("Failed to read directory: %1").arg(basePath);
+        d->callback = nullptr;
+        return false;
+    }
+    d->deliver(batch);
+
+    // Spread the first level over all workers
+    for (int i = 1; i < d->threadCount; ++i) {
+        QMutexLocker from(&d->queues[0]->mutex);
+        if (d->queues[0]->tasks.size() <= 1) {
+            break;
+        }
+        QMutexLocker to(&d->queues[i]->mutex);
+        d->queues[i]->tasks.push_back(std::move(d->queues[0]->tasks.front()));
+        d->queues[0]->tasks.pop_front();
+    }
+
+    std::vector<std::unique_ptr<QThread>> threads;
+    for (int i = 1; i < d->threadCount; ++i) {
+        threads.emplace_back(QThread::create([this, i]() { d->run(i); }));
+        threads.back()->start();
+    }
+    d->run(0);
+    for (auto &thread : threads) {
+        thread->wait();
+    }
+
+    d->callback = nullptr;
+    d->queues.clear();
+
+    if (d->cancelled) {
+        d->lastError = QStringLiteral("Scan cancelled");
+        return false;
+    }
+    if (!d->errors.isEmpty()) {
+        d->lastError = QStringLiteral("%1 directories could not be read").arg(d->errors.size());
+    }
+    return true;
+}
+
+void DirectoryScanner::cancel()
+{
+    d->cancelled = true;
+    QMutexLocker locker(&d->idleMutex);
+    d->workAvailable.wakeAll();
+}
+
+bool DirectoryScanner::isCancelled() const
+{
+    return d->cancelled;
+}
+
+qint64 DirectoryScanner::fileCount() const
+{
+    return d->files;
+}
+
+qint64 DirectoryScanner::directoryCount() const
+{
+    return d->directories;
+}
+
+qint64 DirectoryScanner::totalBytes() const
+{
+    return d->bytes;
+}
+
+QStringList DirectoryScanner::errors() const
+{
+    QMutexLocker locker(&d->errorMutex);
+    return d->errors;
+}
+
+QString DirectoryScanner::lastError() const
+{
+    return d->lastError;
+}
+
+} // namespace qltfs
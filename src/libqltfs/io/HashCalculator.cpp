@@ -20,11 +20,30 @@
  */
 
 #include "HashCalculator.h"
+#include "HashKernels.h"
+#include "BlockManager.h"
+#include "../util/Tracer.h"
 
 #include <QFile>
 #include <QDebug>
+#include <QMutexLocker>
+#include <QPromise>
+#include <QThreadPool>
 #include <QtConcurrent>
 
+#include <algorithm>
+#include <atomic>
+#include <numeric>
+
+#if defined(Q_OS_LINUX)
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <linux/fs.h>
+#include <linux/fiemap.h>
+#endif
+
 namespace qltfs {
 
 // Simple xxHash64 implementation for non-cryptographic fast hashing
@@ -200,6 +219,43 @@ private:
     int m_bufferSize = 0;
 };
 
+/**
+ * @brief Sort key approximating where a file's data sits on disk
+ *
+ * The physical offset of the first extent where the filesystem reports
+ * it, otherwise the inode number, which on most filesystems follows
+ * allocation order. Returns 0 where neither is available.
+ */
+static quint64 diskLocation(const QString &path)
+{
+#if defined(Q_OS_LINUX)
+    int fd = ::open(QFile::encodeName(path).constData(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return 0;
+    }
+
+    // Room for the header and a single extent
+    alignas(struct fiemap) char request[sizeof(struct fiemap) + sizeof(struct fiemap_extent)] = {};
+    struct fiemap *map = reinterpret_cast<struct fiemap *>(request);
+    map->fm_length = FIEMAP_MAX_OFFSET;
+    map->fm_extent_count = 1;
+
+    quint64 location = 0;
+    struct stat st;
+    if (ioctl(fd, FS_IOC_FIEMAP, map) == 0 && map->fm_mapped_extents > 0) {
+        location = map->fm_extents[0].fe_physical;
+    } else if (fstat(fd, &st) == 0) {
+        location = st.st_ino;
+    }
+
+    ::close(fd);
+    return location;
+#else
+    Q_UNUSED(path)
+    return 0;
+#endif
+}
+
 // ============================================================================
 // HashResult Implementation
 // ============================================================================
@@ -226,6 +282,10 @@ public:
     HashMode mode = HashMode::SHA256;
     QCryptographicHash *qtHash = nullptr;
     XXHash64 *xxHash = nullptr;
+    Sha256 *sha256 = nullptr;
+    Blake3 *blake3 = nullptr;
+    Xxh3 *xxh3 = nullptr;
+    QThreadPool *pool = QThreadPool::globalInstance();
     qint64 bytesProcessed = 0;
 
     void createHasher()
@@ -234,6 +294,12 @@ public:
         qtHash = nullptr;
         delete xxHash;
         xxHash = nullptr;
+        delete sha256;
+        sha256 = nullptr;
+        delete blake3;
+        blake3 = nullptr;
+        delete xxh3;
+        xxh3 = nullptr;
 
         switch (mode) {
         case HashMode::None:
@@ -245,7 +311,7 @@ public:
             qtHash = new QCryptographicHash(QCryptographicHash::Sha1);
             break;
         case HashMode::SHA256:
-            qtHash = new QCryptographicHash(QCryptographicHash::Sha256);
+            sha256 = new Sha256();
             break;
         case HashMode::SHA512:
             qtHash = new QCryptographicHash(QCryptographicHash::Sha512);
@@ -253,6 +319,14 @@ public:
         case HashMode::XXH64:
             xxHash = new XXHash64();
             break;
+        case HashMode::BLAKE3:
+            blake3 = new Blake3();
+            blake3->setThreadPool(pool);
+            break;
+        case HashMode::XXH3:
+        case HashMode::XXH128:
+            xxh3 = new Xxh3();
+            break;
         }
     }
 
@@ -264,22 +338,44 @@ public:
         if (xxHash) {
             xxHash->reset();
         }
+        if (sha256) {
+            sha256->reset();
+        }
+        if (blake3) {
+            blake3->reset();
+        }
+        if (xxh3) {
+            xxh3->reset();
+        }
         bytesProcessed = 0;
     }
 
     void addData(const char *data, qint64 length)
     {
+        TraceSpan span("hash", "update");
+        span.setArg("bytes", length);
+
         if (qtHash) {
             qtHash->addData(QByteArrayView(data, static_cast<qsizetype>(length)));
         }
         if (xxHash) {
             xxHash->update(data, static_cast<size_t>(length));
         }
+        if (sha256) {
+            sha256->update(data, static_cast<size_t>(length));
+        }
+        if (blake3) {
+            blake3->update(data, static_cast<size_t>(length));
+        }
+        if (xxh3) {
+            xxh3->update(data, static_cast<size_t>(length));
+        }
         bytesProcessed += length;
     }
 
     HashResult getResult() const
     {
+        QLTFS_TRACE_SPAN("hash", "finalize");
         HashResult result;
         result.mode = mode;
         result.bytesProcessed = bytesProcessed;
@@ -297,6 +393,30 @@ public:
             }
             result.hexString = QStringLiteral("%1").arg(h, 16, 16, QLatin1Char('0'));
             result.base64String = QString::fromLatin1(result.hash.toBase64());
+        } else if (sha256 || blake3) {
+            result.hash.resize(32);
+            quint8 *digest = reinterpret_cast<quint8 *>(result.hash.data());
+            if (sha256) {
+                sha256->finish(digest);
+            } else {
+                blake3->finish(digest);
+            }
+            result.hexString = QString::fromLatin1(result.hash.toHex());
+            result.base64String = QString::fromLatin1(result.hash.toBase64());
+        } else if (xxh3) {
+            // Canonical (big-endian) form, as printed by xxhsum
+            quint64 words[2] = {0, xxh3->digest64()};
+            if (mode == HashMode::XXH128) {
+                xxh3->digest128(words[0], words[1]);
+            }
+            int first = mode == HashMode::XXH128 ? 0 : 1;
+            for (int w = first; w < 2; ++w) {
+                for (int i = 7; i >= 0; --i) {
+                    result.hash.append(static_cast<char>((words[w] >> (i * 8)) & 0xFF));
+                }
+            }
+            result.hexString = QString::fromLatin1(result.hash.toHex());
+            result.base64String = QString::fromLatin1(result.hash.toBase64());
         } else if (mode == HashMode::None) {
             result.success = true;
         } else {
@@ -311,6 +431,9 @@ public:
     {
         delete qtHash;
         delete xxHash;
+        delete sha256;
+        delete blake3;
+        delete xxh3;
     }
 };
 
@@ -344,6 +467,14 @@ void HashCalculator::setMode(HashMode mode)
     }
 }
 
+void HashCalculator::setThreadPool(QThreadPool *pool)
+{
+    d->pool = pool;
+    if (d->blake3) {
+        d->blake3->setThreadPool(pool);
+    }
+}
+
 void HashCalculator::reset()
 {
     d->reset();
@@ -378,8 +509,20 @@ HashResult HashCalculator::hash(const QByteArray &data)
 
 HashResult HashCalculator::hashFile(const QString &filePath, HashProgressCallback callback)
 {
+    // Read in 4MB chunks, enough for BLAKE3 to spread each across the pool
+    static constexpr qint64 BUFFER_SIZE = 4 * 1024 * 1024;
+    QByteArray buffer(static_cast<int>(BUFFER_SIZE), Qt::Uninitialized);
+    return hashFileInto(filePath, buffer.data(), BUFFER_SIZE, callback);
+}
+
+HashResult HashCalculator::hashFileInto(const QString &filePath, char *buffer, qint64 bufferSize,
+                                        HashProgressCallback callback)
+{
+    QLTFS_TRACE_SPAN("hash", "hashFile");
+
     HashResult result;
     result.mode = d->mode;
+    result.filePath = filePath;
 
     QFile file(filePath);
     if (!file.open(QIODevice::ReadOnly)) {
@@ -391,20 +534,18 @@ HashResult HashCalculator::hashFile(const QString &filePath, HashProgressCallbac
     qint64 totalSize = file.size();
     reset();
 
-    // Read in 1MB chunks
-    static constexpr qint64 BUFFER_SIZE = 1024 * 1024;
-    QByteArray buffer;
-    buffer.reserve(static_cast<int>(BUFFER_SIZE));
-
-    while (!file.atEnd()) {
-        buffer = file.read(BUFFER_SIZE);
-        if (buffer.isEmpty() && file.error() != QFile::NoError) {
+    for (;;) {
+        qint64 bytesRead = file.read(buffer, bufferSize);
+        if (bytesRead < 0) {
             result.success = false;
             result.errorMessage = QStringLiteral("Read error: %1").arg(file.errorString());
             return result;
         }
+        if (bytesRead == 0) {
+            break;
+        }
 
-        addData(buffer);
+        addData(buffer, bytesRead);
 
         if (callback) {
             callback(d->bytesProcessed, totalSize);
@@ -413,7 +554,9 @@ HashResult HashCalculator::hashFile(const QString &filePath, HashProgressCallbac
         emit progressChanged(d->bytesProcessed, totalSize);
     }
 
-    return this->result();
+    result = this->result();
+    result.filePath = filePath;
+    return result;
 }
 
 QFuture<HashResult> HashCalculator::hashFileAsync(const QString &filePath)
@@ -426,6 +569,71 @@ QFuture<HashResult> HashCalculator::hashFileAsync(const QString &filePath)
     });
 }
 
+QFuture<HashResult> HashCalculator::hashFilesAsync(const QStringList &filePaths,
+                                                   const HashBatchOptions &options)
+{
+    HashMode mode = d->mode;
+
+    return QtConcurrent::run([filePaths, options, mode](QPromise<HashResult> &promise) {
+        const int concurrency = qBound(1, options.maxConcurrency, 64);
+        const qint64 bufferSize = qMax<qint64>(64 * 1024, options.bufferSize);
+
+        promise.setProgressRange(0, static_cast<int>(filePaths.size()));
+
+        // Read order; sorting costs one metadata lookup per file but
+        // turns a scattered staging area into a mostly forward sweep
+        QVector<int> order(filePaths.size());
+        std::iota(order.begin(), order.end(), 0);
+        if (options.sortByLocation && filePaths.size() > 1) {
+            QVector<quint64> location(filePaths.size());
+            for (int i = 0; i < filePaths.size() && !promise.isCanceled(); ++i) {
+                location[i] = diskLocation(filePaths[i]);
+            }
+            std::stable_sort(order.begin(), order.end(), [&location](int a, int b) {
+                return location[a] < location[b];
+            });
+        }
+
+        BlockPool buffers(static_cast<uint32_t>(bufferSize), concurrency);
+        QThreadPool workers;
+        workers.setMaxThreadCount(concurrency);
+
+        std::atomic<int> next{0};
+        QMutex resultMutex;
+        int done = 0;
+
+        auto worker = [&]() {
+            PooledBlock buffer(&buffers);
+            HashCalculator calc(mode);
+
+            for (;;) {
+                int i = next.fetch_add(1);
+                if (i >= order.size() || promise.isCanceled()) {
+                    return;
+                }
+
+                HashResult result;
+                if (buffer.isNull()) {
+                    result.mode = mode;
+                    result.filePath = filePaths[order[i]];
+                    result.errorMessage = QStringLiteral("Failed to allocate read buffer");
+                } else {
+                    result = calc.hashFileInto(filePaths[order[i]], buffer.data(), buffer.size(), nullptr);
+                }
+
+                QMutexLocker locker(&resultMutex);
+                promise.addResult(result);
+                promise.setProgressValue(++done);
+            }
+        };
+
+        for (int i = 0; i < concurrency; ++i) {
+            workers.start(worker);
+        }
+        workers.waitForDone();
+    });
+}
+
 QString HashCalculator::md5(const QByteArray &data)
 {
     return QString::fromLatin1(QCryptographicHash::hash(data, QCryptographicHash::Md5).toHex());
@@ -433,7 +641,8 @@ QString HashCalculator::md5(const QByteArray &data)
 
 QString HashCalculator::sha256(const QByteArray &data)
 {
-    return QString::fromLatin1(QCryptographicHash::hash(data, QCryptographicHash::Sha256).toHex());
+    HashCalculator calc(HashMode::SHA256);
+    return calc.hash(data).hexString;
 }
 
 QString HashCalculator::sha256File(const QString &filePath)
@@ -457,6 +666,9 @@ QString HashCalculator::modeToString(HashMode mode)
     case HashMode::SHA256: return QStringLiteral("sha256");
     case HashMode::SHA512: return QStringLiteral("sha512");
     case HashMode::XXH64:  return QStringLiteral("xxh64");
+    case HashMode::BLAKE3: return QStringLiteral("blake3");
+    case HashMode::XXH3:   return QStringLiteral("xxh3");
+    case HashMode::XXH128: return QStringLiteral("xxh128");
     }
     return QStringLiteral("unknown");
 }
@@ -469,6 +681,9 @@ HashMode HashCalculator::stringToMode(const QString &str)
     if (lower == QLatin1String("sha256") || lower == QLatin1String("sha-256")) return HashMode::SHA256;
     if (lower == QLatin1String("sha512") || lower == QLatin1String("sha-512")) return HashMode::SHA512;
     if (lower == QLatin1String("xxh64") || lower == QLatin1String("xxhash64")) return HashMode::XXH64;
+    if (lower == QLatin1String("blake3") || lower == QLatin1String("b3")) return HashMode::BLAKE3;
+    if (lower == QLatin1String("xxh3") || lower == QLatin1String("xxhash3")) return HashMode::XXH3;
+    if (lower == QLatin1String("xxh128") || lower == QLatin1String("xxhash128")) return HashMode::XXH128;
     return HashMode::None;
 }
 
@@ -481,8 +696,49 @@ int HashCalculator::hashLength(HashMode mode)
     case HashMode::SHA256: return 32;
     case HashMode::SHA512: return 64;
     case HashMode::XXH64:  return 8;
+    case HashMode::BLAKE3: return 32;
+    case HashMode::XXH3:   return 8;
+    case HashMode::XXH128: return 16;
     }
     return 0;
 }
 
+QString HashCalculator::attributeKey(HashMode mode)
+{
+    switch (mode) {
+    case HashMode::None:   return QString();
+    case HashMode::MD5:    return QStringLiteral("ltfs.hash.md5sum");
+    case HashMode::SHA1:   return QStringLiteral("ltfs.hash.sha1sum");
+    case HashMode::SHA256: return QStringLiteral("ltfs.hash.sha256sum");
+    case HashMode::SHA512: return QStringLiteral("ltfs.hash.sha512sum");
+    case HashMode::XXH64:  return QStringLiteral("ltfs.hash.xxhash64sum");
+    case HashMode::BLAKE3: return QStringLiteral("ltfs.hash.blake3sum");
+    case HashMode::XXH3:   return QStringLiteral("ltfs.hash.xxhash3sum");
+    case HashMode::XXH128: return QStringLiteral("ltfs.hash.xxhash128sum");
+    }
+    return QString();
+}
+
+QString HashCalculator::implementationName(HashMode mode)
+{
+    switch (mode) {
+    case HashMode::SHA256:
+        return QString::fromLatin1(Sha256::backendName());
+    case HashMode::BLAKE3:
+        return QStringLiteral("portable, tree-parallel");
+    case HashMode::XXH64:
+        return QStringLiteral("portable");
+    case HashMode::XXH3:
+    case HashMode::XXH128:
+        return QString::fromLatin1(Xxh3::backendName());
+    case HashMode::MD5:
+    case HashMode::SHA1:
+    case HashMode::SHA512:
+        return QStringLiteral("qt");
+    case HashMode::None:
+        break;
+    }
+    return QStringLiteral("none");
+}
+
 } // namespace qltfs
@@ -27,10 +27,13 @@
 #include <QObject>
 #include <QByteArray>
 #include <QString>
+#include <QStringList>
 #include <QCryptographicHash>
 #include <QFuture>
 #include <functional>
 
+class QThreadPool;
+
 namespace qltfs {
 
 /**
@@ -42,7 +45,10 @@ enum class HashMode {
     SHA1,       ///< SHA-1 hash (160-bit)
     SHA256,     ///< SHA-256 hash (256-bit)
     SHA512,     ///< SHA-512 hash (512-bit)
-    XXH64       ///< xxHash 64-bit (fast, non-cryptographic)
+    XXH64,      ///< xxHash 64-bit (fast, non-cryptographic)
+    BLAKE3,     ///< BLAKE3 256-bit (cryptographic, multithreaded on large inputs)
+    XXH3,       ///< XXH3 64-bit (fast, non-cryptographic, SIMD)
+    XXH128      ///< XXH3 128-bit (fast, non-cryptographic, SIMD)
 };
 
 /**
@@ -51,6 +57,7 @@ enum class HashMode {
 struct LIBQLTFS_EXPORT HashResult {
     bool success = false;
     HashMode mode = HashMode::None;
+    QString filePath;           ///< File the hash belongs to (file hashing only)
     QByteArray hash;            ///< Raw hash bytes
     QString hexString;          ///< Hex-encoded hash string
     QString base64String;       ///< Base64-encoded hash string
@@ -68,6 +75,15 @@ struct LIBQLTFS_EXPORT HashResult {
     bool matchesHex(const QString &hex) const;
 };
 
+/**
+ * @brief Options for hashing many files at once
+ */
+struct LIBQLTFS_EXPORT HashBatchOptions {
+    int maxConcurrency = 2;                 ///< Files read and hashed at the same time
+    qint64 bufferSize = 4 * 1024 * 1024;    ///< Read buffer per concurrent file (from one shared pool)
+    bool sortByLocation = true;             ///< Read files in on-disk order where the platform reports it
+};
+
 /**
  * @brief Progress callback for hash operations
  */
@@ -78,6 +94,11 @@ using HashProgressCallback = std::function<void(qint64 bytesProcessed, qint64 to
  *
  * Supports various hash algorithms for file verification.
  * Can calculate hashes incrementally or from complete data.
+ *
+ * SHA-256 runs on the CPU's SHA instructions where available (see
+ * CpuFeatures). BLAKE3 splits large updates across a thread pool, so a
+ * single file can be hashed on several cores. XXH3 and XXH128 use AVX2
+ * when present and are the cheapest choice for bulk verification.
  */
 class LIBQLTFS_EXPORT HashCalculator : public QObject
 {
@@ -106,6 +127,15 @@ public:
      */
     void setMode(HashMode mode);
 
+    /**
+     * @brief Set the pool used by modes that hash in parallel
+     *
+     * Only BLAKE3 uses it. Defaults to QThreadPool::globalInstance().
+     *
+     * @param pool Thread pool, or nullptr to hash on the calling thread
+     */
+    void setThreadPool(QThreadPool *pool);
+
     // === Incremental hashing ===
 
     /**
@@ -161,6 +191,28 @@ public:
      */
     QFuture<HashResult> hashFileAsync(const QString &filePath);
 
+    /**
+     * @brief Hash a list of files with bounded parallelism
+     *
+     * At most HashBatchOptions::maxConcurrency files are read at once,
+     * each through a buffer from one shared pool, so a large staging
+     * area is hashed without thrashing the disk. With sortByLocation the
+     * files are read in the order their data sits on disk (first extent
+     * on Linux, falling back to the inode number).
+     *
+     * Results are reported as each file finishes, in completion order;
+     * use HashResult::filePath to match them up and
+     * QFutureWatcher::resultReadyAt() to consume them incrementally.
+     * Progress is the number of files done. Cancelling the future stops
+     * the batch after the files in progress.
+     *
+     * @param filePaths Files to hash
+     * @param options Concurrency and ordering options
+     * @return Future receiving one result per file
+     */
+    QFuture<HashResult> hashFilesAsync(const QStringList &filePaths,
+                                       const HashBatchOptions &options = HashBatchOptions());
+
     // === Static convenience methods ===
 
     /**
@@ -193,11 +245,27 @@ public:
      */
     static HashMode stringToMode(const QString &str);
 
+    /**
+     * @brief LTFS extended attribute name a hash is recorded under
+     *
+     * Follows the "ltfs.hash.<name>sum" convention used by other LTFS
+     * tools, e.g. "ltfs.hash.sha256sum" or "ltfs.hash.xxhash3sum".
+     */
+    static QString attributeKey(HashMode mode);
+
     /**
      * @brief Get hash length in bytes for a mode
      */
     static int hashLength(HashMode mode);
 
+    /**
+     * @brief Describe the implementation used for a mode on this CPU
+     *
+     * For example "sha-ni" or "portable" for SHA-256; useful in logs
+     * when comparing throughput between hosts.
+     */
+    static QString implementationName(HashMode mode);
+
 signals:
     /**
      * @brief Emitted during file hashing
@@ -210,6 +278,9 @@ signals:
     void hashCompleted(const HashResult &result);
 
 private:
+    HashResult hashFileInto(const QString &filePath, char *buffer, qint64 bufferSize,
+                            HashProgressCallback callback);
+
     class Private;
     Private *d;
 };
@@ -0,0 +1,1533 @@
+/*
+ * QLTOTapeMan - Qt-based LTO Tape Manager
+ * libqltfs - LTFS Core Library
+ *
+ * Copyright (c) 2026 Jeffrey ZHU (zhxsh1225@gmail.com)
+ * https://github.com/Gypsop/QLTOTapeMan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "HashKernels.h"
+
+#include <QThreadPool>
+#include <QtConcurrent>
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#  define QLTFS_HASH_X86 1
+#  include <immintrin.h>
+#  if defined(_MSC_VER)
+#    include <intrin.h>
+#  else
+#    include <cpuid.h>
+#  endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#  define QLTFS_HASH_ARM64 1
+#  include <arm_neon.h>
+#  if defined(__ARM_FEATURE_CRC32) || defined(_M_ARM64)
+#    include <arm_acle.h>
+#  endif
+#  if defined(__linux__)
+#    include <sys/auxv.h>
+#    include <asm/hwcap.h>
+#  elif defined(_WIN32)
+#    include <windows.h>
+#  endif
+#endif
+
+// GCC and Clang only emit extension instructions inside functions that
+// ask for them; MSVC accepts the intrinsics anywhere
+#if defined(__GNUC__) || defined(__clang__)
+#  define QLTFS_TARGET(features) __attribute__((target(features)))
+#else
+#  define QLTFS_TARGET(features)
+#endif
+
+namespace qltfs {
+
+// ============================================================================
+// CPU Feature Detection
+// ============================================================================
+
+namespace {
+
+CpuFeatures detectCpuFeatures()
+{
+    CpuFeatures features;
+
+#if defined(QLTFS_HASH_X86)
+    unsigned int regs[4] = {0, 0, 0, 0};
+    auto cpuid = [&regs](unsigned int leaf, unsigned int subleaf) {
+#  if defined(_MSC_VER)
+        int out[4];
+        __cpuidex(out, static_cast<int>(leaf), static_cast<int>(subleaf));
+        for (int i = 0; i < 4; ++i) {
+            regs[i] = static_cast<unsigned int>(out[i]);
+        }
+#  else
+        __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#  endif
+    };
+
+    cpuid(0, 0);
+    unsigned int maxLeaf = regs[0];
+
+    cpuid(1, 0);
+    features.ssse3 = (regs[2] & (1u << 9)) != 0;
+    features.sse41 = (regs[2] & (1u << 19)) != 0;
+    features.sse42 = (regs[2] & (1u << 20)) != 0;
+    features.pclmul = (regs[2] & (1u << 1)) != 0;
+    bool osxsave = (regs[2] & (1u << 27)) != 0;
+    bool avx = (regs[2] & (1u << 28)) != 0;
+
+    // AVX2 also needs the OS to save the YMM registers
+    bool ymmEnabled = false;
+    if (osxsave && avx) {
+#  if defined(_MSC_VER)
+        ymmEnabled = (_xgetbv(0) & 0x6) == 0x6;
+#  else
+        unsigned int eax, edx;
+        __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+        ymmEnabled = (eax & 0x6) == 0x6;
+#  endif
+    }
+
+    if (maxLeaf >= 7) {
+        cpuid(7, 0);
+        features.avx2 = ymmEnabled && (regs[1] & (1u << 5)) != 0;
+        features.shaNi = features.ssse3 && features.sse41 && (regs[1] & (1u << 29)) != 0;
+    }
+#elif defined(QLTFS_HASH_ARM64)
+#  if defined(__APPLE__)
+    features.armSha2 = true;     // Every Apple arm64 CPU has the crypto extensions
+    features.armCrc32 = true;
+#  elif defined(__linux__)
+    unsigned long hwcap = getauxval(AT_HWCAP);
+    features.armSha2 = (hwcap & HWCAP_SHA2) != 0;
+    features.armCrc32 = (hwcap & HWCAP_CRC32) != 0;
+#  elif defined(_WIN32)
+    features.armSha2 = IsProcessorFeaturePresent(PF_ARM_V8_CRYPTO_INSTRUCTIONS_AVAILABLE) != 0;
+    features.armCrc32 = IsProcessorFeaturePresent(PF_ARM_V8_CRC32_INSTRUCTIONS_AVAILABLE) != 0;
+#  endif
+#endif
+
+    return features;
+}
+
+} // namespace
+
+const CpuFeatures &CpuFeatures::host()
+{
+    static const CpuFeatures features = detectCpuFeatures();
+    return features;
+}
+
+// ============================================================================
+// SHA-256 Kernels
+// ============================================================================
+
+namespace {
+
+alignas(16) const quint32 SHA256_K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+const quint32 SHA256_IV[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+};
+
+using Sha256Compress = void (*)(quint32 state[8], const quint8 *data, size_t blocks);
+
+inline quint32 rotr32(quint32 x, int n)
+{
+    return (x >> n) | (x << (32 - n));
+}
+
+inline quint32 loadBE32(const quint8 *p)
+{
+    return (static_cast<quint32>(p[0]) << 24) | (static_cast<quint32>(p[1]) << 16) |
+           (static_cast<quint32>(p[2]) << 8) | static_cast<quint32>(p[3]);
+}
+
+inline quint32 loadLE32(const quint8 *p)
+{
+    return static_cast<quint32>(p[0]) | (static_cast<quint32>(p[1]) << 8) |
+           (static_cast<quint32>(p[2]) << 16) | (static_cast<quint32>(p[3]) << 24);
+}
+
+inline void storeLE32(quint8 *p, quint32 v)
+{
+    p[0] = static_cast<quint8>(v);
+    p[1] = static_cast<quint8>(v >> 8);
+    p[2] = static_cast<quint8>(v >> 16);
+    p[3] = static_cast<quint8>(v >> 24);
+}
+
+void sha256CompressPortable(quint32 state[8], const quint8 *data, size_t blocks)
+{
+    quint32 w[64];
+
+    while (blocks--) {
+        for (int i = 0; i < 16; ++i) {
+            w[i] = loadBE32(data + i * 4);
+        }
+        for (int i = 16; i < 64; ++i) {
+            quint32 s0 = rotr32(w[i - 15], 7) ^ rotr32(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            quint32 s1 = rotr32(w[i - 2], 17) ^ rotr32(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+
+        quint32 a = state[0], b = state[1], c = state[2], d = state[3];
+        quint32 e = state[4], f = state[5], g = state[6], h = state[7];
+
+        for (int i = 0; i < 64; ++i) {
+            quint32 s1 = rotr32(e, 6) ^ rotr32(e, 11) ^ rotr32(e, 25);
+            quint32 ch = (e & f) ^ (~e & g);
+            quint32 t1 = h + s1 + ch + SHA256_K[i] + w[i];
+            quint32 s0 = rotr32(a, 2) ^ rotr32(a, 13) ^ rotr32(a, 22);
+            quint32 maj = (a & b) ^ (a & c) ^ (b & c);
+            quint32 t2 = s0 + maj;
+            h = g; g = f; f = e; e = d + t1;
+            d = c; c = b; b = a; a = t1 + t2;
+        }
+
+        state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+        state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+        data += 64;
+    }
+}
+
+#if defined(QLTFS_HASH_X86)
+QLTFS_TARGET("sha,sse4.1,ssse3")
+void sha256CompressShaNi(quint32 state[8], const quint8 *data, size_t blocks)
+{
+    const __m128i byteSwap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+    // The SHA instructions keep the state as ABEF / CDGH
+    __m128i tmp = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(&state[0])), 0xB1);
+    __m128i state1 = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(&state[4])), 0x1B);
+    __m128i state0 = _mm_alignr_epi8(tmp, state1, 8);
+    state1 = _mm_blend_epi16(state1, tmp, 0xF0);
+
+    while (blocks--) {
+        const __m128i abefSave = state0;
+        const __m128i cdghSave = state1;
+        __m128i w[4];
+
+        for (int i = 0; i < 16; ++i) {
+            if (i < 4) {
+                w[i] = _mm_shuffle_epi8(
+                    _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i * 16)), byteSwap);
+            } else {
+                __m128i t = _mm_add_epi32(_mm_sha256msg1_epu32(w[i & 3], w[(i + 1) & 3]),
+                                          _mm_alignr_epi8(w[(i + 3) & 3], w[(i + 2) & 3], 4));
+                w[i & 3] = _mm_sha256msg2_epu32(t, w[(i + 3) & 3]);
+            }
+
+            __m128i msg = _mm_add_epi32(w[i & 3],
+                _mm_load_si128(reinterpret_cast<const __m128i *>(&SHA256_K[i * 4])));
+            state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+            state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(msg, 0x0E));
+        }
+
+        state0 = _mm_add_epi32(state0, abefSave);
+        state1 = _mm_add_epi32(state1, cdghSave);
+        data += 64;
+    }
+
+    tmp = _mm_shuffle_epi32(state0, 0x1B);
+    state1 = _mm_shuffle_epi32(state1, 0xB1);
+    state0 = _mm_blend_epi16(tmp, state1, 0xF0);
+    state1 = _mm_alignr_epi8(state1, tmp, 8);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(&state[0]), state0);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(&state[4]), state1);
+}
+#endif
+
+#if defined(QLTFS_HASH_ARM64) && (defined(__ARM_FEATURE_SHA2) || defined(__ARM_FEATURE_CRYPTO) || defined(_M_ARM64))
+#  define QLTFS_HASH_ARM_SHA2 1
+void sha256CompressArmv8(quint32 state[8], const quint8 *data, size_t blocks)
+{
+    uint32x4_t state0 = vld1q_u32(&state[0]);
+    uint32x4_t state1 = vld1q_u32(&state[4]);
+
+    while (blocks--) {
+        const uint32x4_t abcdSave = state0;
+        const uint32x4_t efghSave = state1;
+        uint32x4_t w[4];
+
+        for (int i = 0; i < 16; ++i) {
+            if (i < 4) {
+                w[i] = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(data + i * 16)));
+            } else {
+                w[i & 3] = vsha256su1q_u32(vsha256su0q_u32(w[i & 3], w[(i + 1) & 3]),
+                                           w[(i + 2) & 3], w[(i + 3) & 3]);
+            }
+
+            uint32x4_t msg = vaddq_u32(w[i & 3], vld1q_u32(&SHA256_K[i * 4]));
+            uint32x4_t abcd = state0;
+            state0 = vsha256hq_u32(state0, state1, msg);
+            state1 = vsha256h2q_u32(state1, abcd, msg);
+        }
+
+        state0 = vaddq_u32(state0, abcdSave);
+        state1 = vaddq_u32(state1, efghSave);
+        data += 64;
+    }
+
+    vst1q_u32(&state[0], state0);
+    vst1q_u32(&state[4], state1);
+}
+#endif
+
+struct Sha256Backend {
+    Sha256Compress compress;
+    const char *name;
+};
+
+const Sha256Backend &sha256Backend()
+{
+    static const Sha256Backend backend = []() -> Sha256Backend {
+        const CpuFeatures &cpu = CpuFeatures::host();
+        Q_UNUSED(cpu)
+#if defined(QLTFS_HASH_X86)
+        if (cpu.shaNi) {
+            return {sha256CompressShaNi, "sha-ni"};
+        }
+#endif
+#if defined(QLTFS_HASH_ARM_SHA2)
+        if (cpu.armSha2) {
+            return {sha256CompressArmv8, "armv8"};
+        }
+#endif
+        return {sha256CompressPortable, "portable"};
+    }();
+    return backend;
+}
+
+} // namespace
+
+// ============================================================================
+// Sha256 Implementation
+// ============================================================================
+
+Sha256::Sha256()
+{
+    reset();
+}
+
+void Sha256::reset()
+{
+    memcpy(m_state, SHA256_IV, sizeof(m_state));
+    m_bufferSize = 0;
+    m_totalLength = 0;
+}
+
+void Sha256::update(const void *data, size_t length)
+{
+    const quint8 *p = static_cast<const quint8 *>(data);
+    Sha256Compress compress = sha256Backend().compress;
+    m_totalLength += length;
+
+    if (m_bufferSize > 0) {
+        size_t fill = qMin(length, sizeof(m_buffer) - m_bufferSize);
+        memcpy(m_buffer + m_bufferSize, p, fill);
+        m_bufferSize += fill;
+        p += fill;
+        length -= fill;
+        if (m_bufferSize < sizeof(m_buffer)) {
+            return;
+        }
+        compress(m_state, m_buffer, 1);
+        m_bufferSize = 0;
+    }
+
+    // Whole blocks go to the kernel straight from the caller's buffer
+    size_t blocks = length / 64;
+    if (blocks > 0) {
+        compress(m_state, p, blocks);
+        p += blocks * 64;
+        length -= blocks * 64;
+    }
+
+    if (length > 0) {
+        memcpy(m_buffer, p, length);
+        m_bufferSize = length;
+    }
+}
+
+void Sha256::finish(quint8 *digest) const
+{
+    quint32 state[8];
+    memcpy(state, m_state, sizeof(state));
+
+    quint8 tail[128] = {};
+    memcpy(tail, m_buffer, m_bufferSize);
+    tail[m_bufferSize] = 0x80;
+
+    size_t tailLength = m_bufferSize + 9 <= 64 ? 64 : 128;
+    quint64 bits = m_totalLength * 8;
+    for (int i = 0; i < 8; ++i) {
+        tail[tailLength - 1 - i] = static_cast<quint8>(bits >> (i * 8));
+    }
+    sha256Backend().compress(state, tail, tailLength / 64);
+
+    for (int i = 0; i < 8; ++i) {
+        digest[i * 4] = static_cast<quint8>(state[i] >> 24);
+        digest[i * 4 + 1] = static_cast<quint8>(state[i] >> 16);
+        digest[i * 4 + 2] = static_cast<quint8>(state[i] >> 8);
+        digest[i * 4 + 3] = static_cast<quint8>(state[i]);
+    }
+}
+
+const char *Sha256::backendName()
+{
+    return sha256Backend().name;
+}
+
+// ============================================================================
+// BLAKE3 Compression
+// ============================================================================
+
+namespace {
+
+constexpr quint32 BLAKE3_CHUNK_START = 1u << 0;
+constexpr quint32 BLAKE3_CHUNK_END = 1u << 1;
+constexpr quint32 BLAKE3_PARENT = 1u << 2;
+constexpr quint32 BLAKE3_ROOT = 1u << 3;
+
+constexpr int BLAKE3_SCHEDULE[7][16] = {
+    {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15},
+    {2, 6, 3, 10, 7, 0, 4, 13, 1, 11, 12, 5, 9, 14, 15, 8},
+    {3, 4, 10, 12, 13, 2, 7, 14, 6, 5, 9, 0, 11, 15, 8, 1},
+    {10, 7, 12, 9, 14, 3, 13, 15, 4, 0, 11, 2, 5, 8, 1, 6},
+    {12, 13, 9, 11, 15, 10, 14, 8, 7, 2, 5, 3, 0, 1, 6, 4},
+    {9, 14, 11, 5, 8, 12, 15, 1, 13, 3, 0, 10, 2, 6, 4, 7},
+    {11, 15, 5, 0, 1, 9, 8, 6, 14, 10, 2, 12, 3, 4, 7, 13},
+};
+
+inline void blake3G(quint32 *s, int a, int b, int c, int d, quint32 x, quint32 y)
+{
+    s[a] = s[a] + s[b] + x;
+    s[d] = rotr32(s[d] ^ s[a], 16);
+    s[c] = s[c] + s[d];
+    s[b] = rotr32(s[b] ^ s[c], 12);
+    s[a] = s[a] + s[b] + y;
+    s[d] = rotr32(s[d] ^ s[a], 8);
+    s[c] = s[c] + s[d];
+    s[b] = rotr32(s[b] ^ s[c], 7);
+}
+
+/**
+ * @brief BLAKE3 compression function, producing the new chaining value
+ */
+void blake3Compress(const quint32 cv[8], const quint8 block[64], quint64 counter,
+                    quint32 blockLength, quint32 flags, quint32 out[8])
+{
+    quint32 m[16];
+    for (int i = 0; i < 16; ++i) {
+        m[i] = loadLE32(block + i * 4);
+    }
+
+    quint32 s[16] = {
+        cv[0], cv[1], cv[2], cv[3], cv[4], cv[5], cv[6], cv[7],
+        SHA256_IV[0], SHA256_IV[1], SHA256_IV[2], SHA256_IV[3],
+        static_cast<quint32>(counter), static_cast<quint32>(counter >> 32), blockLength, flags
+    };
+
+    for (const auto &r : BLAKE3_SCHEDULE) {
+        blake3G(s, 0, 4, 8, 12, m[r[0]], m[r[1]]);
+        blake3G(s, 1, 5, 9, 13, m[r[2]], m[r[3]]);
+        blake3G(s, 2, 6, 10, 14, m[r[4]], m[r[5]]);
+        blake3G(s, 3, 7, 11, 15, m[r[6]], m[r[7]]);
+        blake3G(s, 0, 5, 10, 15, m[r[8]], m[r[9]]);
+        blake3G(s, 1, 6, 11, 12, m[r[10]], m[r[11]]);
+        blake3G(s, 2, 7, 8, 13, m[r[12]], m[r[13]]);
+        blake3G(s, 3, 4, 9, 14, m[r[14]], m[r[15]]);
+    }
+
+    for (int i = 0; i < 8; ++i) {
+        out[i] = s[i] ^ s[i + 8];
+    }
+}
+
+void blake3Parent(const quint32 left[8], const quint32 right[8], quint32 flags, quint32 out[8])
+{
+    quint8 block[64];
+    for (int i = 0; i < 8; ++i) {
+        storeLE32(block + i * 4, left[i]);
+        storeLE32(block + 32 + i * 4, right[i]);
+    }
+    blake3Compress(SHA256_IV, block, 0, 64, BLAKE3_PARENT | flags, out);
+}
+
+/**
+ * @brief Chaining value of one complete, non-final 1 KiB chunk
+ */
+void blake3ChunkCv(const quint8 *data, quint64 counter, quint32 out[8])
+{
+    memcpy(out, SHA256_IV, sizeof(SHA256_IV));
+    for (int i = 0; i < 16; ++i) {
+        quint32 flags = (i == 0 ? BLAKE3_CHUNK_START : 0) | (i == 15 ? BLAKE3_CHUNK_END : 0);
+        blake3Compress(out, data + i * 64, counter, 64, flags, out);
+    }
+}
+
+/**
+ * @brief Chaining value of a complete subtree of Blake3::SUBTREE_CHUNKS chunks
+ */
+void blake3SubtreeCv(const quint8 *data, quint64 firstChunk, quint32 out[8])
+{
+    quint32 stack[8][8];
+    int depth = 0;
+
+    for (quint64 i = 0; i < Blake3::SUBTREE_CHUNKS; ++i) {
+        quint32 cv[8];
+        blake3ChunkCv(data + i * Blake3::CHUNK_SIZE, firstChunk + i, cv);
+
+        // Merge every subtree this chunk completes
+        for (quint64 total = i + 1; (total & 1) == 0; total >>= 1) {
+            blake3Parent(stack[--depth], cv, 0, cv);
+        }
+        memcpy(stack[depth++], cv, sizeof(cv));
+    }
+
+    memcpy(out, stack[0], sizeof(stack[0]));
+}
+
+} // namespace
+
+// ============================================================================
+// Blake3 Implementation
+// ============================================================================
+
+Blake3::Blake3()
+    : m_stackSize(0)
+    , m_pool(nullptr)
+{
+    reset();
+}
+
+void Blake3::reset()
+{
+    m_stackSize = 0;
+    startChunk(0);
+}
+
+void Blake3::setThreadPool(QThreadPool *pool)
+{
+    m_pool = pool;
+}
+
+void Blake3::startChunk(quint64 counter)
+{
+    memcpy(m_chunk.cv, SHA256_IV, sizeof(m_chunk.cv));
+    memset(m_chunk.block, 0, sizeof(m_chunk.block));
+    m_chunk.counter = counter;
+    m_chunk.blockLength = 0;
+    m_chunk.blocksCompressed = 0;
+}
+
+void Blake3::updateChunk(const quint8 *data, size_t length)
+{
+    while (length > 0) {
+        // A full block is only compressed once more input arrives,
+        // since the final block of a chunk needs CHUNK_END
+        if (m_chunk.blockLength == 64) {
+            quint32 flags = m_chunk.blocksCompressed == 0 ? BLAKE3_CHUNK_START : 0;
+            blake3Compress(m_chunk.cv, m_chunk.block, m_chunk.counter, 64, flags, m_chunk.cv);
+            m_chunk.blocksCompressed++;
+            m_chunk.blockLength = 0;
+            memset(m_chunk.block, 0, sizeof(m_chunk.block));
+        }
+
+        size_t take = qMin(length, static_cast<size_t>(64 - m_chunk.blockLength));
+        memcpy(m_chunk.block + m_chunk.blockLength, data, take);
+        m_chunk.blockLength += static_cast<quint32>(take);
+        data += take;
+        length -= take;
+    }
+}
+
+void Blake3::pushSubtree(quint32 cv[8], quint64 totalChunks, int levels)
+{
+    // Each trailing zero above the subtree's own height is a completed
+    // left sibling waiting on the stack
+    for (quint64 total = totalChunks >> levels; (total & 1) == 0; total >>= 1) {
+        blake3Parent(m_stack[--m_stackSize], cv, 0, cv);
+    }
+    memcpy(m_stack[m_stackSize++], cv, sizeof(m_stack[0]));
+}
+
+void Blake3::hashSubtrees(const quint8 *data, size_t count)
+{
+    const quint64 firstChunk = m_chunk.counter;
+    std::vector<std::array<quint32, 8>> cvs(count);
+
+    // Contiguous runs of subtrees per thread; each writes its own CVs
+    int runs = qMax(1, qMin(static_cast<int>(count), m_pool->maxThreadCount()));
+    std::vector<std::pair<size_t, size_t>> ranges;
+    for (int r = 0; r < runs; ++r) {
+        ranges.emplace_back(count * r / runs, count * (r + 1) / runs);
+    }
+
+    QtConcurrent::blockingMap(m_pool, ranges, [&](const std::pair<size_t, size_t> &range) {
+        for (size_t i = range.first; i < range.second; ++i) {
+            blake3SubtreeCv(data + i * SUBTREE_CHUNKS * CHUNK_SIZE,
+                            firstChunk + i * SUBTREE_CHUNKS, cvs[i].data());
+        }
+    });
+
+    for (size_t i = 0; i < count; ++i) {
+        pushSubtree(cvs[i].data(), firstChunk + (i + 1) * SUBTREE_CHUNKS, 6);
+    }
+    startChunk(firstChunk + count * SUBTREE_CHUNKS);
+}
+
+void Blake3::update(const void *data, size_t length)
+{
+    static_assert(SUBTREE_CHUNKS == 64, "pushSubtree() levels assume 64-chunk subtrees");
+
+    const quint8 *p = static_cast<const quint8 *>(data);
+
+    while (length > 0) {
+        // A full chunk is finalised only once more input arrives,
+        // since the last chunk of the input belongs to the root
+        if (m_chunk.length() == CHUNK_SIZE) {
+            quint32 cv[8];
+            quint32 flags = BLAKE3_CHUNK_END | (m_chunk.blocksCompressed == 0 ? BLAKE3_CHUNK_START : 0);
+            blake3Compress(m_chunk.cv, m_chunk.block, m_chunk.counter, m_chunk.blockLength, flags, cv);
+            pushSubtree(cv, m_chunk.counter + 1, 0);
+            startChunk(m_chunk.counter + 1);
+        }
+
+        // On a subtree boundary, hash whole subtrees across the pool;
+        // at least one byte is left over for the serial path
+        if (m_pool && length > PARALLEL_MIN_BYTES && m_chunk.length() == 0 &&
+            m_chunk.counter % SUBTREE_CHUNKS == 0) {
+            const size_t subtreeBytes = SUBTREE_CHUNKS * CHUNK_SIZE;
+            size_t count = (length - 1) / subtreeBytes;
+            hashSubtrees(p, count);
+            p += count * subtreeBytes;
+            length -= count * subtreeBytes;
+            continue;
+        }
+
+        size_t take = qMin(length, CHUNK_SIZE - m_chunk.length());
+        updateChunk(p, take);
+        p += take;
+        length -= take;
+    }
+}
+
+void Blake3::finish(quint8 *digest) const
+{
+    quint32 flags = BLAKE3_CHUNK_END | (m_chunk.blocksCompressed == 0 ? BLAKE3_CHUNK_START : 0);
+    quint32 cv[8];
+    memcpy(cv, m_chunk.cv, sizeof(cv));
+    quint8 block[64];
+    memcpy(block, m_chunk.block, sizeof(block));
+    quint64 counter = m_chunk.counter;
+    quint32 blockLength = m_chunk.blockLength;
+
+    // Fold the stack into the final node; the last compression is the root
+    for (int i = m_stackSize - 1; i >= 0; --i) {
+        quint32 right[8];
+        blake3Compress(cv, block, counter, blockLength, flags, right);
+        for (int j = 0; j < 8; ++j) {
+            storeLE32(block + j * 4, m_stack[i][j]);
+            storeLE32(block + 32 + j * 4, right[j]);
+        }
+        memcpy(cv, SHA256_IV, sizeof(cv));
+        counter = 0;
+        blockLength = 64;
+        flags = BLAKE3_PARENT;
+    }
+
+    quint32 out[8];
+    blake3Compress(cv, block, counter, blockLength, flags | BLAKE3_ROOT, out);
+    for (int i = 0; i < 8; ++i) {
+        storeLE32(digest + i * 4, out[i]);
+    }
+}
+
+// ============================================================================
+// XXH3 Kernels
+// ============================================================================
+
+namespace {
+
+constexpr quint32 XXH_PRIME32_1 = 0x9E3779B1U;
+constexpr quint32 XXH_PRIME32_2 = 0x85EBCA77U;
+constexpr quint32 XXH_PRIME32_3 = 0xC2B2AE3DU;
+constexpr quint64 XXH_PRIME64_1 = 0x9E3779B185EBCA87ULL;
+constexpr quint64 XXH_PRIME64_2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr quint64 XXH_PRIME64_3 = 0x165667B19E3779F9ULL;
+constexpr quint64 XXH_PRIME64_4 = 0x85EBCA77C2B2AE63ULL;
+constexpr quint64 XXH_PRIME64_5 = 0x27D4EB2F165667C5ULL;
+constexpr quint64 XXH_PRIME_MX1 = 0x165667919E3779F9ULL;
+constexpr quint64 XXH_PRIME_MX2 = 0x9FB21C651E98DF25ULL;
+
+constexpr size_t XXH3_SECRET_SIZE = 192;
+constexpr size_t XXH3_STRIPES_PER_BLOCK = (XXH3_SECRET_SIZE - 64) / 8;
+constexpr size_t XXH3_MIDSIZE_MAX = 240;
+
+alignas(64) const quint8 XXH3_SECRET[XXH3_SECRET_SIZE] = {
+    0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c, 0xf7, 0x21, 0xad, 0x1c,
+    0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb, 0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f,
+    0xcb, 0x79, 0xe6, 0x4e, 0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+    0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6, 0x81, 0x3a, 0x26, 0x4c,
+    0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb, 0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3,
+    0x71, 0x64, 0x48, 0x97, 0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+    0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7, 0xc7, 0x0b, 0x4f, 0x1d,
+    0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31, 0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64,
+    0xea, 0xc5, 0xac, 0x83, 0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+    0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26, 0x29, 0xd4, 0x68, 0x9e,
+    0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc, 0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce,
+    0x45, 0xcb, 0x3a, 0x8f, 0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e,
+};
+
+const quint64 XXH3_INIT_ACC[8] = {
+    XXH_PRIME32_3, XXH_PRIME64_1, XXH_PRIME64_2, XXH_PRIME64_3,
+    XXH_PRIME64_4, XXH_PRIME32_2, XXH_PRIME64_5, XXH_PRIME32_1
+};
+
+inline quint64 loadLE64(const quint8 *p)
+{
+    return static_cast<quint64>(loadLE32(p)) | (static_cast<quint64>(loadLE32(p + 4)) << 32);
+}
+
+inline quint64 rotl64(quint64 x, int r)
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+inline quint32 swap32(quint32 x)
+{
+    return ((x << 24) & 0xff000000U) | ((x << 8) & 0x00ff0000U) |
+           ((x >> 8) & 0x0000ff00U) | ((x >> 24) & 0x000000ffU);
+}
+
+inline quint64 swap64(quint64 x)
+{
+    return (static_cast<quint64>(swap32(static_cast<quint32>(x))) << 32) |
+           swap32(static_cast<quint32>(x >> 32));
+}
+
+#if defined(__SIZEOF_INT128__)
+// __extension__ keeps -Wpedantic quiet about the GCC / Clang type
+__extension__ typedef unsigned __int128 u128;
+#endif
+
+/**
+ * @brief Full 64x64 -> 128-bit product
+ */
+inline void mul128(quint64 a, quint64 b, quint64 &low, quint64 &high)
+{
+#if defined(__SIZEOF_INT128__)
+    u128 product = static_cast<u128>(a) * b;
+    low = static_cast<quint64>(product);
+    high = static_cast<quint64>(product >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    low = _umul128(a, b, &high);
+#else
+    quint64 loLo = (a & 0xFFFFFFFF) * (b & 0xFFFFFFFF);
+    quint64 hiLo = (a >> 32) * (b & 0xFFFFFFFF);
+    quint64 loHi = (a & 0xFFFFFFFF) * (b >> 32);
+    quint64 hiHi = (a >> 32) * (b >> 32);
+    quint64 cross = (loLo >> 32) + (hiLo & 0xFFFFFFFF) + loHi;
+    high = (hiLo >> 32) + (cross >> 32) + hiHi;
+    low = (cross << 32) | (loLo & 0xFFFFFFFF);
+#endif
+}
+
+inline quint64 mul128Fold64(quint64 a, quint64 b)
+{
+    quint64 low, high;
+    mul128(a, b, low, high);
+    return low ^ high;
+}
+
+inline quint64 xxh64Avalanche(quint64 h)
+{
+    h ^= h >> 33;
+    h *= XXH_PRIME64_2;
+    h ^= h >> 29;
+    h *= XXH_PRIME64_3;
+    h ^= h >> 32;
+    return h;
+}
+
+inline quint64 xxh3Avalanche(quint64 h)
+{
+    h ^= h >> 37;
+    h *= XXH_PRIME_MX1;
+    h ^= h >> 32;
+    return h;
+}
+
+inline quint64 xxh3Rrmxmx(quint64 h, quint64 length)
+{
+    h ^= rotl64(h, 49) ^ rotl64(h, 24);
+    h *= XXH_PRIME_MX2;
+    h ^= (h >> 35) + length;
+    h *= XXH_PRIME_MX2;
+    h ^= h >> 28;
+    return h;
+}
+
+inline quint64 xxh3Mix16(const quint8 *input, const quint8 *secret)
+{
+    return mul128Fold64(loadLE64(input) ^ loadLE64(secret),
+                        loadLE64(input + 8) ^ loadLE64(secret + 8));
+}
+
+/**
+ * @brief Two 16-byte lanes mixed into a 128-bit accumulator (XXH128 mid sizes)
+ */
+inline void xxh3Mix32(quint64 &low, quint64 &high, const quint8 *input1, const quint8 *input2,
+                      const quint8 *secret)
+{
+    low += xxh3Mix16(input1, secret);
+    low ^= loadLE64(input2) + loadLE64(input2 + 8);
+    high += xxh3Mix16(input2, secret + 16);
+    high ^= loadLE64(input1) + loadLE64(input1 + 8);
+}
+
+quint64 xxh3MergeAccs(const quint64 acc[8], const quint8 *secret, quint64 start)
+{
+    quint64 result = start;
+    for (int i = 0; i < 4; ++i) {
+        result += mul128Fold64(acc[2 * i] ^ loadLE64(secret + 16 * i),
+                               acc[2 * i + 1] ^ loadLE64(secret + 16 * i + 8));
+    }
+    return xxh3Avalanche(result);
+}
+
+// --- XXH3-64 for inputs of at most 240 bytes ---
+
+quint64 xxh3Short64(const quint8 *input, size_t length)
+{
+    const quint8 *secret = XXH3_SECRET;
+
+    if (length == 0) {
+        return xxh64Avalanche(loadLE64(secret + 56) ^ loadLE64(secret + 64));
+    }
+
+    if (length <= 3) {
+        quint32 combined = (static_cast<quint32>(input[0]) << 16) |
+                           (static_cast<quint32>(input[length >> 1]) << 24) |
+                           static_cast<quint32>(input[length - 1]) |
+                           (static_cast<quint32>(length) << 8);
+        quint64 bitflip = loadLE32(secret) ^ loadLE32(secret + 4);
+        return xxh64Avalanche(combined ^ bitflip);
+    }
+
+    if (length <= 8) {
+        quint64 input64 = loadLE32(input + length - 4) +
+                          (static_cast<quint64>(loadLE32(input)) << 32);
+        quint64 bitflip = loadLE64(secret + 8) ^ loadLE64(secret + 16);
+        return xxh3Rrmxmx(input64 ^ bitflip, length);
+    }
+
+    if (length <= 16) {
+        quint64 inputLow = loadLE64(input) ^ (loadLE64(secret + 24) ^ loadLE64(secret + 32));
+        quint64 inputHigh = loadLE64(input + length - 8) ^ (loadLE64(secret + 40) ^ loadLE64(secret + 48));
+        quint64 acc = length + swap64(inputLow) + inputHigh + mul128Fold64(inputLow, inputHigh);
+        return xxh3Avalanche(acc);
+    }
+
+    quint64 acc = length * XXH_PRIME64_1;
+
+    if (length <= 128) {
+        if (length > 32) {
+            if (length > 64) {
+                if (length > 96) {
+                    acc += xxh3Mix16(input + 48, secret + 96);
+                    acc += xxh3Mix16(input + length - 64, secret + 112);
+                }
+                acc += xxh3Mix16(input + 32, secret + 64);
+                acc += xxh3Mix16(input + length - 48, secret + 80);
+            }
+            acc += xxh3Mix16(input + 16, secret + 32);
+            acc += xxh3Mix16(input + length - 32, secret + 48);
+        }
+        acc += xxh3Mix16(input, secret);
+        acc += xxh3Mix16(input + length - 16, secret + 16);
+        return xxh3Avalanche(acc);
+    }
+
+    const size_t rounds = length / 16;
+    for (size_t i = 0; i < 8; ++i) {
+        acc += xxh3Mix16(input + 16 * i, secret + 16 * i);
+    }
+    acc = xxh3Avalanche(acc);
+    for (size_t i = 8; i < rounds; ++i) {
+        acc += xxh3Mix16(input + 16 * i, secret + 16 * (i - 8) + 3);
+    }
+    acc += xxh3Mix16(input + length - 16, secret + 136 - 17);
+    return xxh3Avalanche(acc);
+}
+
+// --- XXH128 for inputs of at most 240 bytes ---
+
+void xxh3Short128(const quint8 *input, size_t length, quint64 &high, quint64 &low)
+{
+    const quint8 *secret = XXH3_SECRET;
+
+    if (length == 0) {
+        low = xxh64Avalanche(loadLE64(secret + 64) ^ loadLE64(secret + 72));
+        high = xxh64Avalanche(loadLE64(secret + 80) ^ loadLE64(secret + 88));
+        return;
+    }
+
+    if (length <= 3) {
+        quint32 combinedLow = (static_cast<quint32>(input[0]) << 16) |
+                              (static_cast<quint32>(input[length >> 1]) << 24) |
+                              static_cast<quint32>(input[length - 1]) |
+                              (static_cast<quint32>(length) << 8);
+        quint32 swapped = swap32(combinedLow);
+        quint32 combinedHigh = (swapped << 13) | (swapped >> 19);
+        quint64 bitflipLow = loadLE32(secret) ^ loadLE32(secret + 4);
+        quint64 bitflipHigh = loadLE32(secret + 8) ^ loadLE32(secret + 12);
+        low = xxh64Avalanche(combinedLow ^ bitflipLow);
+        high = xxh64Avalanche(combinedHigh ^ bitflipHigh);
+        return;
+    }
+
+    if (length <= 8) {
+        quint64 input64 = loadLE32(input) + (static_cast<quint64>(loadLE32(input + length - 4)) << 32);
+        quint64 keyed = input64 ^ (loadLE64(secret + 16) ^ loadLE64(secret + 24));
+        quint64 mLow, mHigh;
+        mul128(keyed, XXH_PRIME64_1 + (static_cast<quint64>(length) << 2), mLow, mHigh);
+        mHigh += mLow << 1;
+        mLow ^= mHigh >> 3;
+        mLow ^= mLow >> 35;
+        mLow *= XXH_PRIME_MX2;
+        mLow ^= mLow >> 28;
+        low = mLow;
+        high = xxh3Avalanche(mHigh);
+        return;
+    }
+
+    if (length <= 16) {
+        quint64 bitflipLow = loadLE64(secret + 32) ^ loadLE64(secret + 40);
+        quint64 bitflipHigh = loadLE64(secret + 48) ^ loadLE64(secret + 56);
+        quint64 inputLow = loadLE64(input);
+        quint64 inputHigh = loadLE64(input + length - 8);
+        quint64 mLow, mHigh;
+        mul128(inputLow ^ inputHigh ^ bitflipLow, XXH_PRIME64_1, mLow, mHigh);
+        mLow += static_cast<quint64>(length - 1) << 54;
+        inputHigh ^= bitflipHigh;
+        mHigh += inputHigh + static_cast<quint64>(static_cast<quint32>(inputHigh)) * (XXH_PRIME32_2 - 1);
+        mLow ^= swap64(mHigh);
+        quint64 hLow, hHigh;
+        mul128(mLow, XXH_PRIME64_2, hLow, hHigh);
+        hHigh += mHigh * XXH_PRIME64_2;
+        low = xxh3Avalanche(hLow);
+        high = xxh3Avalanche(hHigh);
+        return;
+    }
+
+    quint64 accLow = length * XXH_PRIME64_1;
+    quint64 accHigh = 0;
+
+    if (length <= 128) {
+        if (length > 32) {
+            if (length > 64) {
+                if (length > 96) {
+                    xxh3Mix32(accLow, accHigh, input + 48, input + length - 64, secret + 96);
+                }
+                xxh3Mix32(accLow, accHigh, input + 32, input + length - 48, secret + 64);
+            }
+            xxh3Mix32(accLow, accHigh, input + 16, input + length - 32, secret + 32);
+        }
+        xxh3Mix32(accLow, accHigh, input, input + length - 16, secret);
+    } else {
+        for (size_t i = 32; i < 160; i += 32) {
+            xxh3Mix32(accLow, accHigh, input + i - 32, input + i - 16, secret + i - 32);
+        }
+        accLow = xxh3Avalanche(accLow);
+        accHigh = xxh3Avalanche(accHigh);
+        for (size_t i = 160; i <= length; i += 32) {
+            xxh3Mix32(accLow, accHigh, input + i - 32, input + i - 16, secret + 3 + i - 160);
+        }
+        xxh3Mix32(accLow, accHigh, input + length - 16, input + length - 32, secret + 136 - 17 - 16);
+    }
+
+    low = xxh3Avalanche(accLow + accHigh);
+    high = 0 - xxh3Avalanche(accLow * XXH_PRIME64_1 + accHigh * XXH_PRIME64_4 +
+                             length * XXH_PRIME64_2);
+}
+
+// --- Long input accumulation ---
+
+/**
+ * @brief Consume @p stripes 64-byte stripes into the accumulators
+ *
+ * @p stripesInBlock tracks the position in the current secret block and
+ * triggers the scramble round after each full block.
+ */
+using Xxh3Consume = void (*)(quint64 acc[8], size_t &stripesInBlock, const quint8 *data, size_t stripes);
+
+void xxh3AccumulatePortable(quint64 acc[8], const quint8 *data, const quint8 *secret)
+{
+    for (int i = 0; i < 8; ++i) {
+        quint64 value = loadLE64(data + 8 * i);
+        quint64 key = value ^ loadLE64(secret + 8 * i);
+        acc[i ^ 1] += value;
+        acc[i] += static_cast<quint64>(static_cast<quint32>(key)) * (key >> 32);
+    }
+}
+
+void xxh3ScramblePortable(quint64 acc[8], const quint8 *secret)
+{
+    for (int i = 0; i < 8; ++i) {
+        quint64 a = acc[i];
+        a ^= a >> 47;
+        a ^= loadLE64(secret + 8 * i);
+        a *= XXH_PRIME32_1;
+        acc[i] = a;
+    }
+}
+
+void xxh3ConsumePortable(quint64 acc[8], size_t &stripesInBlock, const quint8 *data, size_t stripes)
+{
+    for (size_t s = 0; s < stripes; ++s) {
+        xxh3AccumulatePortable(acc, data + s * 64, XXH3_SECRET + stripesInBlock * 8);
+        if (++stripesInBlock == XXH3_STRIPES_PER_BLOCK) {
+            xxh3ScramblePortable(acc, XXH3_SECRET + XXH3_SECRET_SIZE - 64);
+            stripesInBlock = 0;
+        }
+    }
+}
+
+#if defined(QLTFS_HASH_X86)
+QLTFS_TARGET("avx2")
+void xxh3ConsumeAvx2(quint64 acc[8], size_t &stripesInBlock, const quint8 *data, size_t stripes)
+{
+    __m256i a[2] = {
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(acc)),
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(acc + 4))
+    };
+    const __m256i prime = _mm256_set1_epi32(static_cast<int>(XXH_PRIME32_1));
+
+    for (size_t s = 0; s < stripes; ++s) {
+        const quint8 *stripe = data + s * 64;
+        const quint8 *secret = XXH3_SECRET + stripesInBlock * 8;
+
+        for (int i = 0; i < 2; ++i) {
+            __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(stripe + 32 * i));
+            __m256i key = _mm256_xor_si256(value,
+                _mm256_loadu_si256(reinterpret_cast<const __m256i *>(secret + 32 * i)));
+            // low 32 bits times high 32 bits of each keyed lane
+            __m256i product = _mm256_mul_epu32(key, _mm256_shuffle_epi32(key, 0x31));
+            // each lane also adds the raw value of its neighbour
+            __m256i swapped = _mm256_shuffle_epi32(value, 0x4E);
+            a[i] = _mm256_add_epi64(a[i], _mm256_add_epi64(product, swapped));
+        }
+
+        if (++stripesInBlock == XXH3_STRIPES_PER_BLOCK) {
+            const quint8 *scramble = XXH3_SECRET + XXH3_SECRET_SIZE - 64;
+            for (int i = 0; i < 2; ++i) {
+                __m256i v = _mm256_xor_si256(a[i], _mm256_srli_epi64(a[i], 47));
+                v = _mm256_xor_si256(v,
+                    _mm256_loadu_si256(reinterpret_cast<const __m256i *>(scramble + 32 * i)));
+                __m256i productLow = _mm256_mul_epu32(v, prime);
+                __m256i productHigh = _mm256_mul_epu32(_mm256_shuffle_epi32(v, 0x31), prime);
+                a[i] = _mm256_add_epi64(productLow, _mm256_slli_epi64(productHigh, 32));
+            }
+            stripesInBlock = 0;
+        }
+    }
+
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(acc), a[0]);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(acc + 4), a[1]);
+}
+#endif
+
+struct Xxh3Backend {
+    Xxh3Consume consume;
+    const char *name;
+};
+
+const Xxh3Backend &xxh3Backend()
+{
+    static const Xxh3Backend backend = []() -> Xxh3Backend {
+#if defined(QLTFS_HASH_X86)
+        if (CpuFeatures::host().avx2) {
+            return {xxh3ConsumeAvx2, "avx2"};
+        }
+#endif
+        return {xxh3ConsumePortable, "portable"};
+    }();
+    return backend;
+}
+
+} // namespace
+
+// ============================================================================
+// Xxh3 Implementation
+// ============================================================================
+
+Xxh3::Xxh3()
+{
+    reset();
+}
+
+void Xxh3::reset()
+{
+    memcpy(m_acc, XXH3_INIT_ACC, sizeof(m_acc));
+    memset(m_lastStripe, 0, sizeof(m_lastStripe));
+    m_bufferSize = 0;
+    m_stripesInBlock = 0;
+    m_totalLength = 0;
+}
+
+void Xxh3::update(const void *data, size_t length)
+{
+    const quint8 *p = static_cast<const quint8 *>(data);
+    Xxh3Consume consume = xxh3Backend().consume;
+    m_totalLength += length;
+
+    // A stripe is only consumed once at least one more byte follows it,
+    // since the final stripe of the input is processed differently
+    if (m_bufferSize + length <= BUFFER_SIZE) {
+        memcpy(m_buffer + m_bufferSize, p, length);
+        m_bufferSize += length;
+        return;
+    }
+
+    if (m_bufferSize > 0) {
+        size_t fill = BUFFER_SIZE - m_bufferSize;
+        memcpy(m_buffer + m_bufferSize, p, fill);
+        p += fill;
+        length -= fill;
+        consume(m_acc, m_stripesInBlock, m_buffer, BUFFER_SIZE / STRIPE_SIZE);
+        memcpy(m_lastStripe, m_buffer + BUFFER_SIZE - STRIPE_SIZE, STRIPE_SIZE);
+        m_bufferSize = 0;
+    }
+
+    // Stripes straight from the caller's buffer, keeping the tail back
+    if (length > BUFFER_SIZE) {
+        size_t stripes = (length - 1) / STRIPE_SIZE;
+        consume(m_acc, m_stripesInBlock, p, stripes);
+        p += stripes * STRIPE_SIZE;
+        length -= stripes * STRIPE_SIZE;
+        memcpy(m_lastStripe, p - STRIPE_SIZE, STRIPE_SIZE);
+    }
+
+    memcpy(m_buffer, p, length);
+    m_bufferSize = length;
+}
+
+bool Xxh3::finishAccumulators(quint64 acc[8]) const
+{
+    if (m_totalLength <= XXH3_MIDSIZE_MAX) {
+        return false;
+    }
+
+    memcpy(acc, m_acc, sizeof(m_acc));
+    size_t stripesInBlock = m_stripesInBlock;
+    Xxh3Consume consume = xxh3Backend().consume;
+
+    // Everything but the final stripe in the normal way, then the final
+    // stripe against its own slice of the secret
+    quint8 last[STRIPE_SIZE];
+    if (m_bufferSize >= STRIPE_SIZE) {
+        consume(acc, stripesInBlock, m_buffer, (m_bufferSize - 1) / STRIPE_SIZE);
+        memcpy(last, m_buffer + m_bufferSize - STRIPE_SIZE, STRIPE_SIZE);
+    } else {
+        size_t carry = STRIPE_SIZE - m_bufferSize;
+        memcpy(last, m_lastStripe + STRIPE_SIZE - carry, carry);
+        memcpy(last + carry, m_buffer, m_bufferSize);
+    }
+    xxh3AccumulatePortable(acc, last, XXH3_SECRET + XXH3_SECRET_SIZE - STRIPE_SIZE - 7);
+    return true;
+}
+
+quint64 Xxh3::digest64() const
+{
+    quint64 acc[8];
+    if (!finishAccumulators(acc)) {
+        return xxh3Short64(m_buffer, m_bufferSize);
+    }
+    return xxh3MergeAccs(acc, XXH3_SECRET + 11, m_totalLength * XXH_PRIME64_1);
+}
+
+void Xxh3::digest128(quint64 &high, quint64 &low) const
+{
+    quint64 acc[8];
+    if (!finishAccumulators(acc)) {
+        xxh3Short128(m_buffer, m_bufferSize, high, low);
+        return;
+    }
+    low = xxh3MergeAccs(acc, XXH3_SECRET + 11, m_totalLength * XXH_PRIME64_1);
+    high = xxh3MergeAccs(acc, XXH3_SECRET + XXH3_SECRET_SIZE - 64 - 11,
+                         ~(m_totalLength * XXH_PRIME64_2));
+}
+
+const char *Xxh3::backendName()
+{
+    return xxh3Backend().name;
+}
+
+// ============================================================================
+// CRC-32 Kernels
+// ============================================================================
+
+namespace {
+
+/**
+ * @brief Slice-by-8 lookup tables for a reflected CRC-32 polynomial
+ *
+ * table[0] is the classic byte-at-a-time table; table[k] advances a byte
+ * through k further zero bytes, so eight input bytes can be folded with
+ * eight independent lookups.
+ */
+struct Crc32Tables {
+    quint32 table[8][256];
+};
+
+constexpr Crc32Tables makeCrc32Tables(quint32 polynomial)
+{
+    Crc32Tables tables{};
+    for (quint32 i = 0; i < 256; ++i) {
+        quint32 crc = i;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 1) ? (crc >> 1) ^ polynomial : crc >> 1;
+        }
+        tables.table[0][i] = crc;
+    }
+    for (quint32 i = 0; i < 256; ++i) {
+        for (int k = 1; k < 8; ++k) {
+            quint32 prev = tables.table[k - 1][i];
+            tables.table[k][i] = (prev >> 8) ^ tables.table[0][prev & 0xFF];
+        }
+    }
+    return tables;
+}
+
+// Built at compile time, so there is nothing to initialize (or race on) at runtime
+constexpr Crc32Tables CRC32_TABLES = makeCrc32Tables(0xEDB88320);
+constexpr Crc32Tables CRC32C_TABLES = makeCrc32Tables(0x82F63B78);
+
+// The kernels work on the raw register (pre- and post-inversion are done
+// by the caller)
+using Crc32Kernel = quint32 (*)(quint32 crc, const quint8 *data, size_t length);
+
+quint32 crc32SliceBy8(const Crc32Tables &tables, quint32 crc, const quint8 *data, size_t length)
+{
+    const auto &t = tables.table;
+
+    while (length >= 8) {
+        quint32 low = loadLE32(data) ^ crc;
+        quint32 high = loadLE32(data + 4);
+        crc = t[7][low & 0xFF] ^ t[6][(low >> 8) & 0xFF] ^
+              t[5][(low >> 16) & 0xFF] ^ t[4][low >> 24] ^
+              t[3][high & 0xFF] ^ t[2][(high >> 8) & 0xFF] ^
+              t[1][(high >> 16) & 0xFF] ^ t[0][high >> 24];
+        data += 8;
+        length -= 8;
+    }
+
+    while (length--) {
+        crc = t[0][(crc ^ *data++) & 0xFF] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+quint32 crc32Portable(quint32 crc, const quint8 *data, size_t length)
+{
+    return crc32SliceBy8(CRC32_TABLES, crc, data, length);
+}
+
+#if defined(QLTFS_HASH_X86)
+QLTFS_TARGET("pclmul,sse4.1")
+inline __m128i clmulLoad(const quint8 *p)
+{
+    return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+}
+
+// Multiply both halves of x by the two fold constants and add the next block
+QLTFS_TARGET("pclmul,sse4.1")
+inline __m128i clmulFold(__m128i x, __m128i k, __m128i next)
+{
+    __m128i lo = _mm_clmulepi64_si128(x, k, 0x00);
+    __m128i hi = _mm_clmulepi64_si128(x, k, 0x11);
+    return _mm_xor_si128(_mm_xor_si128(hi, lo), next);
+}
+
+/**
+ * @brief CRC-32 by carry-less multiplication folding
+ *
+ * Folds four 128-bit lanes in parallel, reduces them to one lane, then
+ * to 32 bits with a Barrett reduction ("Fast CRC Computation for Generic
+ * Polynomials Using PCLMULQDQ", Intel 2009). Handles the 16-byte
+ * multiple prefix of inputs of at least 64 bytes; the rest goes through
+ * the tables.
+ */
+QLTFS_TARGET("pclmul,sse4.1")
+quint32 crc32Pclmul(quint32 crc, const quint8 *data, size_t length)
+{
+    if (length < 64) {
+        return crc32Portable(crc, data, length);
+    }
+
+    // Bit-reflected x^n mod P for 512- and 128-bit fold distances and the
+    // final 64-bit step, then P and its Barrett constant
+    const __m128i k1k2 = _mm_set_epi64x(0x01c6e41596LL, 0x0154442bd4LL);
+    const __m128i k3k4 = _mm_set_epi64x(0x00ccaa009eLL, 0x01751997d0LL);
+    const __m128i k5 = _mm_set_epi64x(0, 0x0163cd6124LL);
+    const __m128i poly = _mm_set_epi64x(0x01f7011641LL, 0x01db710641LL);
+    const __m128i mask32 = _mm_setr_epi32(~0, 0, ~0, 0);
+
+    __m128i x1 = _mm_xor_si128(clmulLoad(data), _mm_cvtsi32_si128(static_cast<int>(crc)));
+    __m128i x2 = clmulLoad(data + 16);
+    __m128i x3 = clmulLoad(data + 32);
+    __m128i x4 = clmulLoad(data + 48);
+    data += 64;
+    length -= 64;
+
+    while (length >= 64) {
+        x1 = clmulFold(x1, k1k2, clmulLoad(data));
+        x2 = clmulFold(x2, k1k2, clmulLoad(data + 16));
+        x3 = clmulFold(x3, k1k2, clmulLoad(data + 32));
+        x4 = clmulFold(x4, k1k2, clmulLoad(data + 48));
+        data += 64;
+        length -= 64;
+    }
+
+    // Four lanes into one
+    x1 = clmulFold(x1, k3k4, x2);
+    x1 = clmulFold(x1, k3k4, x3);
+    x1 = clmulFold(x1, k3k4, x4);
+
+    while (length >= 16) {
+        x1 = clmulFold(x1, k3k4, clmulLoad(data));
+        data += 16;
+        length -= 16;
+    }
+
+    // 128 bits to 64
+    __m128i t = _mm_clmulepi64_si128(x1, k3k4, 0x10);
+    x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), t);
+
+    t = _mm_srli_si128(x1, 4);
+    x1 = _mm_clmulepi64_si128(_mm_and_si128(x1, mask32), k5, 0x00);
+    x1 = _mm_xor_si128(x1, t);
+
+    // Barrett reduction to 32 bits
+    t = _mm_and_si128(x1, mask32);
+    t = _mm_clmulepi64_si128(t, poly, 0x10);
+    t = _mm_and_si128(t, mask32);
+    t = _mm_clmulepi64_si128(t, poly, 0x00);
+    x1 = _mm_xor_si128(x1, t);
+
+    crc = static_cast<quint32>(_mm_extract_epi32(x1, 1));
+    return crc32Portable(crc, data, length);
+}
+#endif
+
+#if defined(QLTFS_HASH_ARM64) && (defined(__ARM_FEATURE_CRC32) || defined(_M_ARM64))
+#  define QLTFS_HASH_ARM_CRC32 1
+quint32 crc32Armv8(quint32 crc, const quint8 *data, size_t length)
+{
+    // Byte steps up to 8-byte alignment, then whole words
+    while (length > 0 && (reinterpret_cast<uintptr_t>(data) & 7) != 0) {
+        crc = __crc32b(crc, *data++);
+        --length;
+    }
+
+    while (length >= 32) {
+        quint64 w[4];
+        memcpy(w, data, sizeof(w));
+        crc = __crc32d(crc, w[0]);
+        crc = __crc32d(crc, w[1]);
+        crc = __crc32d(crc, w[2]);
+        crc = __crc32d(crc, w[3]);
+        data += 32;
+        length -= 32;
+    }
+    while (length >= 8) {
+        quint64 w;
+        memcpy(&w, data, sizeof(w));
+        crc = __crc32d(crc, w);
+        data += 8;
+        length -= 8;
+    }
+
+    while (length--) {
+        crc = __crc32b(crc, *data++);
+    }
+    return crc;
+}
+#endif
+
+struct Crc32Backend {
+    Crc32Kernel kernel;
+    const char *name;
+};
+
+const Crc32Backend &crc32Backend()
+{
+    static const Crc32Backend backend = []() -> Crc32Backend {
+        const CpuFeatures &cpu = CpuFeatures::host();
+        Q_UNUSED(cpu)
+#if defined(QLTFS_HASH_X86)
+        if (cpu.pclmul && cpu.sse41) {
+            return {crc32Pclmul, "pclmul"};
+        }
+#endif
+#if defined(QLTFS_HASH_ARM_CRC32)
+        if (cpu.armCrc32) {
+            return {crc32Armv8, "armv8"};
+        }
+#endif
+        return {crc32Portable, "slice-by-8"};
+    }();
+    return backend;
+}
+
+} // namespace
+
+// ============================================================================
+// Crc32 Implementation
+// ============================================================================
+
+quint32 Crc32::extend(quint32 crc, const void *data, size_t length)
+{
+    if (length == 0) {
+        return crc;
+    }
+    return ~crc32Backend().kernel(~crc, static_cast<const quint8 *>(data), length);
+}
+
+const char *Crc32::backendName()
+{
+    return crc32Backend().name;
+}
+
+// ============================================================================
+// CRC-32C Kernels
+// ============================================================================
+
+namespace {
+
+quint32 crc32cPortable(quint32 crc, const quint8 *data, size_t length)
+{
+    return crc32SliceBy8(CRC32C_TABLES, crc, data, length);
+}
+
+#if defined(QLTFS_HASH_X86)
+// One crc32 instruction per 8 bytes runs at several GB/s, far ahead of
+// any tape drive, so the streams are not interleaved
+QLTFS_TARGET("sse4.2")
+quint32 crc32cSse42(quint32 crc, const quint8 *data, size_t length)
+{
+#  if defined(__x86_64__) || defined(_M_X64)
+    quint64 crc64 = crc;
+    while (length >= 8) {
+        quint64 w;
+        memcpy(&w, data, sizeof(w));
+        crc64 = _mm_crc32_u64(crc64, w);
+        data += 8;
+        length -= 8;
+    }
+    crc = static_cast<quint32>(crc64);
+#  endif
+    while (length >= 4) {
+        quint32 w;
+        memcpy(&w, data, sizeof(w));
+        crc = _mm_crc32_u32(crc, w);
+        data += 4;
+        length -= 4;
+    }
+    while (length--) {
+        crc = _mm_crc32_u8(crc, *data++);
+    }
+    return crc;
+}
+#endif
+
+#if defined(QLTFS_HASH_ARM_CRC32)
+quint32 crc32cArmv8(quint32 crc, const quint8 *data, size_t length)
+{
+    while (length >= 8) {
+        quint64 w;
+        memcpy(&w, data, sizeof(w));
+        crc = __crc32cd(crc, w);
+        data += 8;
+        length -= 8;
+    }
+    while (length--) {
+        crc = __crc32cb(crc, *data++);
+    }
+    return crc;
+}
+#endif
+
+const Crc32Backend &crc32cBackend()
+{
+    static const Crc32Backend backend = []() -> Crc32Backend {
+        const CpuFeatures &cpu = CpuFeatures::host();
+        Q_UNUSED(cpu)
+#if defined(QLTFS_HASH_X86)
+        if (cpu.sse42) {
+            return {crc32cSse42, "sse4.2"};
+        }
+#endif
+#if defined(QLTFS_HASH_ARM_CRC32)
+        if (cpu.armCrc32) {
+            return {crc32cArmv8, "armv8"};
+        }
+#endif
+        return {crc32cPortable, "slice-by-8"};
+    }();
+    return backend;
+}
+
+} // namespace
+
+// ============================================================================
+// Crc32c Implementation
+// ============================================================================
+
+quint32 Crc32c::extend(quint32 crc, const void *data, size_t length)
+{
+    if (length == 0) {
+        return crc;
+    }
+    return ~crc32cBackend().kernel(~crc, static_cast<const quint8 *>(data), length);
+}
+
+const char *Crc32c::backendName()
+{
+    return crc32cBackend().name;
+}
+
+} // namespace qltfs
@@ -0,0 +1,269 @@
+/*
+ * QLTOTapeMan - Qt-based LTO Tape Manager
+ * libqltfs - LTFS Core Library
+ *
+ * Copyright (c) 2026 Jeffrey ZHU (zhxsh1225@gmail.com)
+ * https://github.com/Gypsop/QLTOTapeMan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "libqltfs_global.h"
+
+#include <cstddef>
+
+class QThreadPool;
+
+namespace qltfs {
+
+/**
+ * @brief CPU features used by the hash kernels
+ *
+ * Detected once on first use. Kernels pick their code path from this
+ * at runtime, so a single build runs on any CPU of its architecture
+ * and uses the fastest instructions available.
+ */
+struct LIBQLTFS_EXPORT CpuFeatures {
+    bool ssse3 = false;     ///< x86 SSSE3
+    bool sse41 = false;     ///< x86 SSE4.1
+    bool sse42 = false;     ///< x86 SSE4.2 (CRC32C instruction)
+    bool avx2 = false;      ///< x86 AVX2 (with OS support for YMM state)
+    bool shaNi = false;     ///< x86 SHA extensions
+    bool pclmul = false;    ///< x86 carry-less multiply (PCLMULQDQ)
+    bool armSha2 = false;   ///< ARMv8 SHA-256 instructions
+    bool armCrc32 = false;  ///< ARMv8 CRC32 and CRC32C instructions
+
+    /**
+     * @brief Features of the CPU the process is running on
+     */
+    static const CpuFeatures &host();
+};
+
+/**
+ * @brief SHA-256 with a runtime-selected compression kernel
+ *
+ * Uses the x86 SHA extensions or the ARMv8 crypto instructions when the
+ * CPU has them and a portable implementation otherwise. All paths
+ * produce the same digest.
+ */
+class LIBQLTFS_EXPORT Sha256
+{
+public:
+    static constexpr int DIGEST_LENGTH = 32;
+
+    Sha256();
+
+    void reset();
+    void update(const void *data, size_t length);
+
+    /**
+     * @brief Write the digest of the data so far; the state is not changed
+     */
+    void finish(quint8 *digest) const;
+
+    /**
+     * @brief Name of the kernel in use ("sha-ni", "armv8" or "portable")
+     */
+    static const char *backendName();
+
+private:
+    quint32 m_state[8];
+    quint8 m_buffer[64];
+    size_t m_bufferSize;
+    quint64 m_totalLength;
+};
+
+/**
+ * @brief BLAKE3 (unkeyed, 256-bit output)
+ *
+ * BLAKE3 hashes its input as a binary tree of 1 KiB chunks, so large
+ * updates can be split into independent subtrees and hashed on several
+ * cores while still producing the standard digest. With a thread pool
+ * set, update() does this for every run of at least PARALLEL_MIN_BYTES
+ * that starts on a subtree boundary; otherwise it hashes serially.
+ */
+class LIBQLTFS_EXPORT Blake3
+{
+public:
+    static constexpr int DIGEST_LENGTH = 32;
+    static constexpr size_t CHUNK_SIZE = 1024;
+    static constexpr size_t SUBTREE_CHUNKS = 64;                  ///< Chunks per parallel work item
+    static constexpr size_t PARALLEL_MIN_BYTES = 4 * SUBTREE_CHUNKS * CHUNK_SIZE;
+
+    Blake3();
+
+    void reset();
+
+    /**
+     * @brief Set the pool used to hash large updates in parallel
+     * @param pool Thread pool, or nullptr to hash on the calling thread
+     */
+    void setThreadPool(QThreadPool *pool);
+
+    void update(const void *data, size_t length);
+
+    /**
+     * @brief Write the digest of the data so far; the state is not changed
+     */
+    void finish(quint8 *digest) const;
+
+private:
+    struct Chunk {
+        quint32 cv[8];
+        quint8 block[64];
+        quint64 counter = 0;
+        quint32 blockLength = 0;
+        quint32 blocksCompressed = 0;
+
+        size_t length() const { return static_cast<size_t>(blocksCompressed) * 64 + blockLength; }
+    };
+
+    void startChunk(quint64 counter);
+    void updateChunk(const quint8 *data, size_t length);
+    void pushSubtree(quint32 cv[8], quint64 totalChunks, int levels);
+    void hashSubtrees(const quint8 *data, size_t count);
+
+    Chunk m_chunk;
+    quint32 m_stack[54][8];         ///< Chaining values of completed subtrees
+    int m_stackSize;
+    QThreadPool *m_pool;
+};
+
+/**
+ * @brief XXH3 with 64-bit and 128-bit output (seed 0, default secret)
+ *
+ * Both digests come from the same streaming state, so a single pass can
+ * produce either or both. Long inputs are accumulated with AVX2 where
+ * the CPU supports it and in portable code otherwise; the results are
+ * identical to the reference xxHash implementation.
+ */
+class LIBQLTFS_EXPORT Xxh3
+{
+public:
+    Xxh3();
+
+    void reset();
+    void update(const void *data, size_t length);
+
+    /**
+     * @brief XXH3-64 of the data so far; the state is not changed
+     */
+    quint64 digest64() const;
+
+    /**
+     * @brief XXH128 of the data so far as (high, low); the state is not changed
+     */
+    void digest128(quint64 &high, quint64 &low) const;
+
+    /**
+     * @brief Name of the accumulation kernel in use ("avx2" or "portable")
+     */
+    static const char *backendName();
+
+private:
+    static constexpr size_t BUFFER_SIZE = 256;
+    static constexpr size_t STRIPE_SIZE = 64;
+
+    bool finishAccumulators(quint64 acc[8]) const;
+
+    alignas(32) quint64 m_acc[8];
+    quint8 m_buffer[BUFFER_SIZE];
+    quint8 m_lastStripe[STRIPE_SIZE];   ///< Last 64 bytes consumed, for a short final stripe
+    size_t m_bufferSize;
+    size_t m_stripesInBlock;
+    quint64 m_totalLength;
+};
+
+/**
+ * @brief CRC-32 as used by zlib, Ethernet and LTFS (reflected 0x04C11DB7)
+ *
+ * The running value is the finished CRC of everything fed so far, so a
+ * stream can be checksummed block by block and extend(extend(0, a), b)
+ * equals the CRC of a followed by b. Large inputs are folded with
+ * PCLMULQDQ on x86 or the ARMv8 CRC32 instructions when the CPU has
+ * them; otherwise slice-by-8 tables are used.
+ */
+class LIBQLTFS_EXPORT Crc32
+{
+public:
+    Crc32() : m_crc(0) {}
+
+    void reset() { m_crc = 0; }
+    void update(const void *data, size_t length) { m_crc = extend(m_crc, data, length); }
+
+    /**
+     * @brief CRC of the data so far
+     */
+    quint32 value() const { return m_crc; }
+
+    /**
+     * @brief Continue a CRC over more data
+     * @param crc CRC of the preceding data (0 to start)
+     * @param data Data to add
+     * @param length Size of data in bytes
+     * @return CRC of the preceding data followed by this data
+     */
+    static quint32 extend(quint32 crc, const void *data, size_t length);
+
+    /**
+     * @brief Name of the kernel in use ("pclmul", "armv8" or "slice-by-8")
+     */
+    static const char *backendName();
+
+private:
+    quint32 m_crc;
+};
+
+/**
+ * @brief CRC-32C (Castagnoli, reflected 0x1EDC6F41)
+ *
+ * The checksum used for logical block protection on LTO drives. Same
+ * interface and chaining rules as Crc32; uses the SSE4.2 or ARMv8 CRC32C
+ * instructions when available and slice-by-8 tables otherwise.
+ */
+class LIBQLTFS_EXPORT Crc32c
+{
+public:
+    Crc32c() : m_crc(0) {}
+
+    void reset() { m_crc = 0; }
+    void update(const void *data, size_t length) { m_crc = extend(m_crc, data, length); }
+
+    /**
+     * @brief CRC of the data so far
+     */
+    quint32 value() const { return m_crc; }
+
+    /**
+     * @brief Continue a CRC over more data
+     * @param crc CRC of the preceding data (0 to start)
+     * @param data Data to add
+     * @param length Size of data in bytes
+     * @return CRC of the preceding data followed by this data
+     */
+    static quint32 extend(quint32 crc, const void *data, size_t length);
+
+    /**
+     * @brief Name of the kernel in use ("sse4.2", "armv8" or "slice-by-8")
+     */
+    static const char *backendName();
+
+private:
+    quint32 m_crc;
+};
+
+} // namespace qltfs
@@ -0,0 +1,555 @@
+/*
+ * QLTOTapeMan - Qt-based LTO Tape Manager
+ * libqltfs - LTFS Core Library
+ *
+ * Copyright (c) 2026 Jeffrey ZHU (zhxsh1225@gmail.com)
+ * https://github.com/Gypsop/QLTOTapeMan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "LibraryWriter.h"
+#include "device/MediumChanger.h"
+#include "device/TapeDevice.h"
+
+#include <QDeadlineTimer>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QWaitCondition>
+
+#include <algorithm>
+
+namespace qltfs {
+
+// ============================================================================
+// LibraryWriter Private Implementation
+// ============================================================================
+
+class LibraryWriter::Private
+{
+public:
+    struct Drive {
+        TapeDevice *device = nullptr;
+        quint16 element = 0;
+    };
+
+    struct Volume {
+        quint16 slot = 0;
+        TapeIO *io = nullptr;
+    };
+
+    LibraryWriter *q = nullptr;
+    MediumChanger *changer = nullptr;
+
+    QList<Drive> drives;
+    QList<quint16> slots;           ///< Slot of each planner cartridge
+    QList<quint16> spareSlots;
+    SpanPlanner planner;
+    TransferOptions options;
+    int concurrentWrites = 1;
+    MountHandler mountHandler;
+    UnmountHandler unmountHandler;
+
+    // Builds the job's item list; never started, has no device
+    TapeIO collector{nullptr};
+
+    // Volumes of the current job and one pipeline thread per drive
+    QList<Volume> volumes;
+    QList<QThread *> lanes;
+    qint64 totalFiles = 0;
+    qint64 totalBytes = 0;
+    QElapsedTimer timer;
+
+    // Guards the scheduling state below
+    mutable QMutex mutex;
+    QWaitCondition turn;
+    int nextWrite = 0;              ///< Volume allowed to start writing next
+    int activeWrites = 0;
+    int runningLanes = 0;
+    bool cancelled = false;
+    QString lastError;
+
+    void runLane(int lane);
+    bool clearDrive(const Drive &drive);
+    void fail(const QString &message);
+    bool isCancelled() const
+    {
+        QMutexLocker locker(&mutex);
+        return cancelled;
+    }
+};
+
+void LibraryWriter::Private::fail(const QString &message)
+{
+    {
+        QMutexLocker locker(&mutex);
+        if (cancelled) {
+            return;
+        }
+        cancelled = true;
+        lastError = message;
+        turn.wakeAll();
+    }
+
+    for (const Volume &volume : volumes) {
+        volume.io->cancel();
+    }
+    emit q->errorOccurred(message);
+}
+
+bool LibraryWriter::Private::clearDrive(const Drive &drive)
+{
+    ChangerElement element;
+    if (!changer->findElement(drive.element, element) || !element.full) {
+        return true;
+    }
+
+    int home = element.sourceValid ? element.sourceAddress : -1;
+    ChangerElement source;
+    if (home < 0 || !changer->findElement(static_cast<quint16>(home), source) || source.full) {
+        home = changer->findEmptySlot();
+    }
+    if (home < 0) {
+        fail(QStringLiteral("Drive element %1 is occupied and no slot is free").arg(drive.element));
+        return false;
+    }
+
+    drive.device->unload();
+    if (!changer->moveMedium(drive.element, static_cast<quint16>(home))) {
+        fail(changer->lastError());
+        return false;
+    }
+    return true;
+}
+
+void LibraryWriter::Private::runLane(int lane)
+{
+    const Drive &drive = drives[lane];
+
+    if (clearDrive(drive)) {
+        for (int volume = lane; volume < volumes.size(); volume += drives.size()) {
+            if (isCancelled()) {
+                break;
+            }
+
+            // Load and mount ahead of this volume's turn
+            const quint16 slot = volumes[volume].slot;
+            TapeIO *io = volumes[volume].io;
+            if (!changer->moveMedium(slot, drive.element)) {
+                fail(changer->lastError());
+                break;
+            }
+
+            QSharedPointer<LtfsIndex> index;
+            bool mounted = drive.device->load();
+            if (!mounted) {
+                fail(QStringLiteral("Volume %1: %2").arg(volume).arg(drive.device->lastError()));
+            } else if (mountHandler) {
+                index = mountHandler(volume, drive.device);
+                mounted = !index.isNull();
+                if (!mounted) {
+                    fail(QStringLiteral("Volume %1: cannot mount cartridge in slot %2").arg(volume).arg(slot));
+                }
+            }
+
+            if (mounted) {
+                emit q->volumeLoaded(volume, lane, slot);
+                if (index) {
+                    io->setIndex(index);
+                }
+
+                bool myTurn;
+                {
+                    QMutexLocker locker(&mutex);
+                    while (!cancelled && (volume != nextWrite || activeWrites >= concurrentWrites)) {
+                        turn.wait(&mutex);
+                    }
+                    myTurn = !cancelled;
+                    if (myTurn) {
+                        nextWrite++;
+                        activeWrites++;
+                        turn.wakeAll();
+                    }
+                }
+
+                if (myTurn) {
+                    const bool started = io->startWrite();
+                    if (started) {
+                        io->waitForCompletion();
+                    }
+
+                    {
+                        QMutexLocker locker(&mutex);
+                        activeWrites--;
+                        turn.wakeAll();
+                    }
+
+                    if (!started) {
+                        fail(QStringLiteral("Volume %1: %2").arg(volume).arg(io->lastError()));
+                    } else {
+                        emit q->volumeCompleted(volume, io->statistics());
+                    }
+
+                    // A partly written cartridge still gets its index
+                    if (started && unmountHandler && !unmountHandler(volume, drive.device, index)) {
+                        fail(QStringLiteral("Volume %1: cannot unmount cartridge from slot %2")
+                                 .arg(volume).arg(slot));
+                    }
+                }
+            }
+
+            // Put the cartridge away while other drives write
+            drive.device->unload();
+            if (!changer->moveMedium(drive.element, slot)) {
+                fail(changer->lastError());
+                break;
+            }
+        }
+    }
+
+    bool last;
+    {
+        QMutexLocker locker(&mutex);
+        last = --runningLanes == 0;
+    }
+    if (last) {
+        emit q->transferCompleted(q->statistics());
+    }
+}
+
+// ============================================================================
+// LibraryWriter Implementation
+// ============================================================================
+
+LibraryWriter::LibraryWriter(MediumChanger *changer, QObject *parent)
+    : QObject(parent)
+    , d(new Private)
+{
+    d->q = this;
+    d->changer = changer;
+}
+
+LibraryWriter::~LibraryWriter()
+{
+    cancel();
+    waitForCompletion();
+    qDeleteAll(d->lanes);
+    // TapeIO destructors wait for their worker threads
+    for (const Private::Volume &volume : d->volumes) {
+        delete volume.io;
+    }
+    delete d;
+}
+
+int LibraryWriter::addDrive(TapeDevice *device, int driveElement)
+{
+    if (driveElement < 0) {
+        driveElement = d->changer->findDrive(device->deviceInfo().serialNumber);
+    }
+    if (driveElement < 0) {
+        d->lastError = QStringLiteral("Drive %1 not found in changer").arg(device->deviceInfo().displayName());
+        return -1;
+    }
+
+    Private::Drive drive;
+    drive.device = device;
+    drive.element = static_cast<quint16>(driveElement);
+    d->drives.append(drive);
+    return d->drives.size() - 1;
+}
+
+int LibraryWriter::driveCount() const
+{
+    return d->drives.size();
+}
+
+int LibraryWriter::addCartridge(quint16 slot, quint64 remainingCapacity)
+{
+    d->slots.append(slot);
+    return d->planner.addCartridge(remainingCapacity);
+}
+
+void LibraryWriter::addSpareSlot(quint16 slot)
+{
+    d->spareSlots.append(slot);
+}
+
+SpanPlanner &LibraryWriter::planner()
+{
+    return d->planner;
+}
+
+TransferOptions LibraryWriter::options() const
+{
+    return d->options;
+}
+
+void LibraryWriter::setOptions(const TransferOptions &options)
+{
+    d->options = options;
+}
+
+int LibraryWriter::concurrentWrites() const
+{
+    return d->concurrentWrites;
+}
+
+void LibraryWriter::setConcurrentWrites(int count)
+{
+    d->concurrentWrites = qMax(1, count);
+}
+
+void LibraryWriter::setMountHandler(MountHandler handler)
+{
+    d->mountHandler = std::move(handler);
+}
+
+void LibraryWriter::setUnmountHandler(UnmountHandler handler)
+{
+    d->unmountHandler = std::move(handler);
+}
+
+void LibraryWriter::addFile(const QString &sourcePath, const QString &destPath)
+{
+    d->collector.addFile(sourcePath, destPath);
+}
+
+void LibraryWriter::addDirectory(const QString &sourceDir, const QString &destDir)
+{
+    d->collector.addDirectory(sourceDir, destDir);
+}
+
+void LibraryWriter::clearQueue()
+{
+    d->collector.clearQueue();
+}
+
+qint64 LibraryWriter::queuedBytes() const
+{
+    return d->collector.queuedBytes();
+}
+
+SpanPlan LibraryWriter::plan() const
+{
+    return d->planner.plan(d->collector.items());
+}
+
+bool LibraryWriter::start()
+{
+    if (isRunning()) {
+        d->lastError = QStringLiteral("Transfer already in progress");
+        return false;
+    }
+
+    if (!d->changer || !d->changer->isOpen()) {
+        d->lastError = QStringLiteral("Changer not open");
+        return false;
+    }
+
+    if (d->drives.isEmpty()) {
+        d->lastError = QStringLiteral("No drives added");
+        return false;
+    }
+
+    const SpanPlan plan = this->plan();
+    if (!plan.isComplete()) {
+        d->lastError = QStringLiteral("%1 files do not fit on the cartridges").arg(plan.unplaced.size());
+        return false;
+    }
+
+    // Assign a slot to every volume that has files to write
+    QList<Private::Volume> volumes;
+    QList<QList<TransferItem>> items;
+    int spare = 0;
+    for (const SpanVolume &volume : plan.volumes) {
+        bool hasFiles = std::any_of(volume.items.begin(), volume.items.end(),
+                                    [](const TransferItem &item) { return !item.isDirectory; });
+        if (volume.cartridge < 0 && spare >= d->spareSlots.size()) {
+            d->lastError = QStringLiteral("Not enough spare slots (%1 needed)").arg(spare + 1);
+            return false;
+        }
+        const quint16 slot = volume.cartridge >= 0 ? d->slots[volume.cartridge] : d->spareSlots[spare++];
+        if (!hasFiles) {
+            continue;
+        }
+
+        Private::Volume entry;
+        entry.slot = slot;
+        volumes.append(entry);
+        items.append(volume.items);
+    }
+
+    if (volumes.isEmpty()) {
+        d->lastError = QStringLiteral("No files in queue");
+        return false;
+    }
+
+    qDeleteAll(d->lanes);
+    d->lanes.clear();
+    for (const Private::Volume &volume : d->volumes) {
+        delete volume.io;
+    }
+    d->volumes.clear();
+    d->totalFiles = 0;
+    d->totalBytes = 0;
+
+    for (int i = 0; i < volumes.size(); ++i) {
+        const Private::Drive &drive = d->drives[i % d->drives.size()];
+        TapeIO *io = new TapeIO(drive.device);
+        io->setOptions(d->options);
+        io->addItems(items[i]);
+        volumes[i].io = io;
+
+        for (const TransferItem &item : items[i]) {
+            if (!item.isDirectory) {
+                d->totalFiles++;
+                d->totalBytes += item.sourceLength >= 0 ? item.sourceLength : item.size - item.sourceOffset;
+            }
+        }
+
+        connect(io, &TapeIO::progressChanged, this, [this]() {
+            TransferStats stats = statistics();
+            emit progressChanged(stats.progressPercent(), stats);
+        });
+        connect(io, &TapeIO::fileError, this, [this, i](const TransferItem &item, const QString &error) {
+            emit fileError(i, item, error);
+        });
+    }
+    d->volumes = volumes;
+
+    const int laneCount = qMin(d->drives.size(), d->volumes.size());
+    {
+        QMutexLocker locker(&d->mutex);
+        d->nextWrite = 0;
+        d->activeWrites = 0;
+        d->runningLanes = laneCount;
+        d->cancelled = false;
+        d->lastError.clear();
+    }
+    d->timer.start();
+
+    for (int lane = 0; lane < laneCount; ++lane) {
+        QThread *thread = QThread::create([this, lane]() { d->runLane(lane); });
+        thread->setObjectName(QStringLiteral("LibraryWriter drive %1").arg(lane));
+        d->lanes.append(thread);
+        thread->start();
+    }
+
+    return true;
+}
+
+bool LibraryWriter::isRunning() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->runningLanes > 0;
+}
+
+void LibraryWriter::pause()
+{
+    for (const Private::Volume &volume : d->volumes) {
+        volume.io->pause();
+    }
+}
+
+void LibraryWriter::resume()
+{
+    for (const Private::Volume &volume : d->volumes) {
+        volume.io->resume();
+    }
+}
+
+void LibraryWriter::cancel()
+{
+    {
+        QMutexLocker locker(&d->mutex);
+        d->cancelled = true;
+        d->turn.wakeAll();
+    }
+
+    for (const Private::Volume &volume : d->volumes) {
+        volume.io->cancel();
+    }
+}
+
+bool LibraryWriter::waitForCompletion(int timeoutMs)
+{
+    QDeadlineTimer deadline(timeoutMs < 0 ? QDeadlineTimer::Forever : QDeadlineTimer(timeoutMs));
+
+    for (QThread *lane : d->lanes) {
+        if (!lane->wait(deadline)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+TransferStats LibraryWriter::statistics() const
+{
+    TransferStats total;
+
+    if (d->volumes.isEmpty()) {
+        total.totalFiles = d->collector.queueCount();
+        total.totalBytes = d->collector.queuedBytes();
+        return total;
+    }
+
+    total.totalFiles = d->totalFiles;
+    total.totalBytes = d->totalBytes;
+    for (const Private::Volume &volume : d->volumes) {
+        const TransferStats stats = volume.io->statistics();
+        total.completedFiles += stats.completedFiles;
+        total.completedBytes += stats.completedBytes;
+        total.failedFiles += stats.failedFiles;
+        total.skippedFiles += stats.skippedFiles;
+        total.bufferUnderruns += stats.bufferUnderruns;
+        total.bufferOverruns += stats.bufferOverruns;
+        total.tapeCommands += stats.tapeCommands;
+
+        // Only volumes being written stream data right now
+        if (volume.io->isRunning()) {
+            total.bufferFill += stats.bufferFill;
+            total.bufferCapacity += stats.bufferCapacity;
+            total.bytesPerSecond += stats.bytesPerSecond;
+        }
+    }
+
+    total.elapsedMs = d->timer.isValid() ? d->timer.elapsed() : 0;
+    if (total.elapsedMs > 0) {
+        total.averageBytesPerSecond = static_cast<double>(total.completedBytes) * 1000.0 / total.elapsedMs;
+    }
+
+    // Cartridge changes are part of the job: estimate from the overall rate
+    if (total.averageBytesPerSecond > 0) {
+        qint64 remainingBytes = total.totalBytes - total.completedBytes;
+        total.estimatedRemainingMs = static_cast<qint64>(remainingBytes * 1000.0 / total.averageBytesPerSecond);
+    }
+
+    return total;
+}
+
+int LibraryWriter::volumeCount() const
+{
+    return d->volumes.size();
+}
+
+QString LibraryWriter::lastError() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->lastError;
+}
+
+} // namespace qltfs
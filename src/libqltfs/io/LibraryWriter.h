@@ -0,0 +1,250 @@
+/*
+ * QLTOTapeMan - Qt-based LTO Tape Manager
+ * libqltfs - LTFS Core Library
+ *
+ * Copyright (c) 2026 Jeffrey ZHU (zhxsh1225@gmail.com)
+ * https://github.com/Gypsop/QLTOTapeMan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "libqltfs_global.h"
+#include "io/SpanPlanner.h"
+#include "io/TapeIO.h"
+
+#include <QObject>
+#include <QList>
+#include <QSharedPointer>
+
+#include <functional>
+
+namespace qltfs {
+
+class MediumChanger;
+
+/**
+ * @brief Writes one job across the cartridges of a tape library
+ *
+ * The job is planned onto cartridges by a SpanPlanner, then written by
+ * the library's drives in volume order. Volume n goes to drive
+ * n modulo the drive count, and each drive runs its own pipeline:
+ * load the cartridge from its slot, mount, wait for its turn, write,
+ * unmount, unload and return it. While one drive writes, the others
+ * already load their next cartridge or put the last one away, so the
+ * write stream only pauses when every drive is still in the robot's
+ * queue. The robot itself moves one cartridge at a time.
+ *
+ * At most concurrentWrites() volumes are written at once (default 1,
+ * one data stream from disk). Writing LTFS indexes is left to the
+ * mount and unmount handlers, which run on the drive's pipeline thread.
+ *
+ * Signals are delivered through the event loop of the thread owning
+ * the writer.
+ */
+class LIBQLTFS_EXPORT LibraryWriter : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Prepares a loaded cartridge for writing
+     * @return Index receiving the files of this volume, or nullptr to fail the job
+     */
+    using MountHandler = std::function<QSharedPointer<LtfsIndex>(int volume, TapeDevice *device)>;
+
+    /**
+     * @brief Finishes a written cartridge before it is unloaded
+     * @return false to fail the job
+     */
+    using UnmountHandler = std::function<bool(int volume, TapeDevice *device, QSharedPointer<LtfsIndex> index)>;
+
+    /**
+     * @brief Create a writer for a library
+     * @param changer Open medium changer (must stay valid)
+     */
+    explicit LibraryWriter(MediumChanger *changer, QObject *parent = nullptr);
+    ~LibraryWriter() override;
+
+    // Disable copy
+    LibraryWriter(const LibraryWriter &) = delete;
+    LibraryWriter &operator=(const LibraryWriter &) = delete;
+
+    // === Library ===
+
+    /**
+     * @brief Add a drive of the library
+     * @param device Tape device (must be open and stay valid)
+     * @param driveElement Changer element address of the drive (-1 = find by serial number)
+     * @return Drive number, or -1 if the drive was not found in the changer
+     */
+    int addDrive(TapeDevice *device, int driveElement = -1);
+
+    /**
+     * @brief Get number of drives
+     */
+    int driveCount() const;
+
+    /**
+     * @brief Add a cartridge to write to
+     * @param slot Storage element holding the cartridge
+     * @param remainingCapacity Free bytes on the cartridge
+     * @return Cartridge number in the planner
+     */
+    int addCartridge(quint16 slot, quint64 remainingCapacity);
+
+    /**
+     * @brief Add a slot holding a blank cartridge of the planner's spare capacity
+     *
+     * Spare slots are used in the order added once the planner opens
+     * spare volumes.
+     */
+    void addSpareSlot(quint16 slot);
+
+    /**
+     * @brief Planner used to place the job (strategy, reserves, spares)
+     */
+    SpanPlanner &planner();
+
+    /**
+     * @brief Get/set transfer options used on every drive
+     */
+    TransferOptions options() const;
+    void setOptions(const TransferOptions &options);
+
+    /**
+     * @brief Get/set the number of volumes written at the same time (default 1)
+     *
+     * Drives beyond this number keep their next cartridge loaded and
+     * mounted, ready to take over the stream.
+     */
+    int concurrentWrites() const;
+    void setConcurrentWrites(int count);
+
+    void setMountHandler(MountHandler handler);
+    void setUnmountHandler(UnmountHandler handler);
+
+    // === Job ===
+
+    /**
+     * @brief Add file to the job
+     * @param sourcePath Local file path
+     * @param destPath Destination path on tape (relative to root)
+     */
+    void addFile(const QString &sourcePath, const QString &destPath = QString());
+
+    /**
+     * @brief Add directory to the job (recursive)
+     * @param sourceDir Local directory path
+     * @param destDir Destination directory on tape
+     */
+    void addDirectory(const QString &sourceDir, const QString &destDir = QString());
+
+    /**
+     * @brief Clear the job
+     */
+    void clearQueue();
+
+    /**
+     * @brief Get total size of the job in bytes
+     */
+    qint64 queuedBytes() const;
+
+    /**
+     * @brief Plan the job onto the cartridges
+     */
+    SpanPlan plan() const;
+
+    // === Control ===
+
+    /**
+     * @brief Plan the job and start the drive pipelines
+     * @return true if the job fits and the pipelines started
+     */
+    bool start();
+
+    /**
+     * @brief Check if any drive pipeline is still running
+     */
+    bool isRunning() const;
+
+    void pause();
+    void resume();
+    void cancel();
+
+    /**
+     * @brief Wait until every cartridge is back in its slot
+     * @param timeoutMs Timeout in milliseconds (-1 = infinite)
+     * @return true if completed, false if timeout
+     */
+    bool waitForCompletion(int timeoutMs = -1);
+
+    // === Statistics ===
+
+    /**
+     * @brief Get combined statistics of the job
+     *
+     * elapsedMs includes cartridge changes, so averageBytesPerSecond is
+     * the throughput of the whole job.
+     */
+    TransferStats statistics() const;
+
+    /**
+     * @brief Get number of volumes with files in the current job
+     */
+    int volumeCount() const;
+
+    /**
+     * @brief Get last error message
+     */
+    QString lastError() const;
+
+signals:
+    /**
+     * @brief Emitted when a volume is loaded and mounted
+     */
+    void volumeLoaded(int volume, int drive, quint16 slot);
+
+    /**
+     * @brief Emitted when a volume has been written
+     */
+    void volumeCompleted(int volume, const TransferStats &stats);
+
+    /**
+     * @brief Emitted when combined progress changes
+     */
+    void progressChanged(int percent, const TransferStats &stats);
+
+    /**
+     * @brief Emitted on a file error on any volume
+     */
+    void fileError(int volume, const TransferItem &item, const QString &error);
+
+    /**
+     * @brief Emitted when the job stops on a robot, drive or handler error
+     */
+    void errorOccurred(const QString &error);
+
+    /**
+     * @brief Emitted when every drive pipeline has finished
+     */
+    void transferCompleted(const TransferStats &stats);
+
+private:
+    class Private;
+    Private *d;
+};
+
+} // namespace qltfs
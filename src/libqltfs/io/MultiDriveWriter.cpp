@@ -0,0 +1,324 @@
+/*
+ * QLTOTapeMan - Qt-based LTO Tape Manager
+ * libqltfs - LTFS Core Library
+ *
+ * Copyright (c) 2026 Jeffrey ZHU (zhxsh1225@gmail.com)
+ * https://github.com/Gypsop/QLTOTapeMan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "MultiDriveWriter.h"
+
+#include <QDeadlineTimer>
+#include <QDebug>
+
+#include <algorithm>
+
+namespace qltfs {
+
+// ============================================================================
+// MultiDriveWriter Private Implementation
+// ============================================================================
+
+class MultiDriveWriter::Private
+{
+public:
+    QList<TapeDevice *> devices;
+    QList<QSharedPointer<LtfsIndex>> indexes;
+    TransferOptions options;
+
+    // Builds the job's item list; never started, has no device
+    TapeIO collector{nullptr};
+
+    // One TapeIO per drive for the current job
+    QList<TapeIO *> ios;
+    int activeDrives = 0;
+    int finishedDrives = 0;
+
+    QString lastError;
+};
+
+// ============================================================================
+// MultiDriveWriter Implementation
+// ============================================================================
+
+MultiDriveWriter::MultiDriveWriter(QObject *parent)
+    : QObject(parent)
+    , d(new Private)
+{
+}
+
+MultiDriveWriter::~MultiDriveWriter()
+{
+    cancel();
+    // TapeIO destructors wait for their worker threads
+    qDeleteAll(d->ios);
+    delete d;
+}
+
+int MultiDriveWriter::addDrive(TapeDevice *device, QSharedPointer<LtfsIndex> index)
+{
+    d->devices.append(device);
+    d->indexes.append(index);
+    return d->devices.size() - 1;
+}
+
+int MultiDriveWriter::driveCount() const
+{
+    return d->devices.size();
+}
+
+TransferOptions MultiDriveWriter::options() const
+{
+    return d->options;
+}
+
+void MultiDriveWriter::setOptions(const TransferOptions &options)
+{
+    d->options = options;
+}
+
+void MultiDriveWriter::addFile(const QString &sourcePath, const QString &destPath)
+{
+    d->collector.addFile(sourcePath, destPath);
+}
+
+void MultiDriveWriter::addDirectory(const QString &sourceDir, const QString &destDir)
+{
+    d->collector.addDirectory(sourceDir, destDir);
+}
+
+void MultiDriveWriter::clearQueue()
+{
+    d->collector.clearQueue();
+}
+
+qint64 MultiDriveWriter::queuedBytes() const
+{
+    return d->collector.queuedBytes();
+}
+
+QList<QList<TransferItem>> MultiDriveWriter::partition() const
+{
+    const int driveCount = d->devices.size();
+    QList<QList<TransferItem>> parts(driveCount);
+    if (driveCount == 0) {
+        return parts;
+    }
+
+    const QList<TransferItem> items = d->collector.items();
+
+    // Longest-processing-time-first: biggest files to the least loaded drive
+    QVector<int> order;
+    for (int i = 0; i < items.size(); ++i) {
+        if (!items[i].isDirectory) {
+            order.append(i);
+        }
+    }
+    std::stable_sort(order.begin(), order.end(), [&items](int a, int b) {
+        return items[a].size > items[b].size;
+    });
+
+    QVector<qint64> load(driveCount, 0);
+    QVector<int> owner(items.size(), -1);
+    for (int index : order) {
+        int target = static_cast<int>(std::min_element(load.begin(), load.end()) - load.begin());
+        owner[index] = target;
+        load[target] += items[index].size;
+    }
+
+    for (int i = 0; i < items.size(); ++i) {
+        if (items[i].isDirectory) {
+            for (auto &part : parts) {
+                part.append(items[i]);
+            }
+        } else {
+            parts[owner[i]].append(items[i]);
+        }
+    }
+
+    return parts;
+}
+
+bool MultiDriveWriter::start()
+{
+    if (isRunning()) {
+        d->lastError = QStringLiteral("Transfer already in progress");
+        return false;
+    }
+
+    if (d->devices.isEmpty()) {
+        d->lastError = QStringLiteral("No drives added");
+        return false;
+    }
+
+    const QList<QList<TransferItem>> parts = partition();
+
+    qDeleteAll(d->ios);
+    d->ios.clear();
+    d->activeDrives = 0;
+    d->finishedDrives = 0;
+
+    for (int drive = 0; drive < d->devices.size(); ++drive) {
+        TapeIO *io = new TapeIO(d->devices[drive]);
+        io->setOptions(d->options);
+        if (d->indexes[drive]) {
+            io->setIndex(d->indexes[drive]);
+        }
+        io->addItems(parts[drive]);
+        d->ios.append(io);
+
+        connect(io, &TapeIO::progressChanged, this, [this]() {
+            TransferStats stats = statistics();
+            emit progressChanged(stats.progressPercent(), stats);
+        });
+        connect(io, &TapeIO::fileError, this, [this, drive](const TransferItem &item, const QString &error) {
+            emit fileError(drive, item, error);
+        });
+        connect(io, &TapeIO::transferCompleted, this, [this, drive](const TransferStats &stats) {
+            emit driveCompleted(drive, stats);
+            if (++d->finishedDrives == d->activeDrives) {
+                emit transferCompleted(statistics());
+            }
+        });
+    }
+
+    for (int drive = 0; drive < d->ios.size(); ++drive) {
+        bool hasFiles = std::any_of(parts[drive].begin(), parts[drive].end(),
+                                    [](const TransferItem &item) { return !item.isDirectory; });
+        if (!hasFiles) {
+            continue;
+        }
+
+        if (!d->ios[drive]->startWrite()) {
+            d->lastError = QStringLiteral("Drive %1: %2").arg(drive).arg(d->ios[drive]->lastError());
+            cancel();
+            return false;
+        }
+        d->activeDrives++;
+    }
+
+    if (d->activeDrives == 0) {
+        d->lastError = QStringLiteral("No files in queue");
+        return false;
+    }
+
+    return true;
+}
+
+bool MultiDriveWriter::isRunning() const
+{
+    return std::any_of(d->ios.begin(), d->ios.end(), [](TapeIO *io) { return io->isRunning(); });
+}
+
+void MultiDriveWriter::pause()
+{
+    for (TapeIO *io : d->ios) {
+        io->pause();
+    }
+}
+
+void MultiDriveWriter::resume()
+{
+    for (TapeIO *io : d->ios) {
+        io->resume();
+    }
+}
+
+void MultiDriveWriter::cancel()
+{
+    for (TapeIO *io : d->ios) {
+        io->cancel();
+    }
+}
+
+bool MultiDriveWriter::waitForCompletion(int timeoutMs)
+{
+    QDeadlineTimer deadline(timeoutMs < 0 ? QDeadlineTimer::Forever : QDeadlineTimer(timeoutMs));
+
+    for (TapeIO *io : d->ios) {
+        int remaining = deadline.isForever() ? -1 : static_cast<int>(deadline.remainingTime());
+        if (!io->waitForCompletion(remaining)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+TransferStats MultiDriveWriter::statistics() const
+{
+    TransferStats total;
+
+    if (d->ios.isEmpty()) {
+        total.totalFiles = d->collector.queueCount();
+        total.totalBytes = d->collector.queuedBytes();
+        return total;
+    }
+
+    for (TapeIO *io : d->ios) {
+        const TransferStats stats = io->statistics();
+        total.totalFiles += stats.totalFiles;
+        total.totalBytes += stats.totalBytes;
+        total.completedFiles += stats.completedFiles;
+        total.completedBytes += stats.completedBytes;
+        total.failedFiles += stats.failedFiles;
+        total.skippedFiles += stats.skippedFiles;
+        total.bufferFill += stats.bufferFill;
+        total.bufferCapacity += stats.bufferCapacity;
+        total.bufferUnderruns += stats.bufferUnderruns;
+        total.bufferOverruns += stats.bufferOverruns;
+        total.bufferPoolHighWater += stats.bufferPoolHighWater;
+        total.tapeCommands += stats.tapeCommands;
+        total.bytesPerSecond += stats.bytesPerSecond;
+
+        // Drives run concurrently; the job lasts as long as the slowest one
+        total.elapsedMs = qMax(total.elapsedMs, stats.elapsedMs);
+    }
+
+    if (total.elapsedMs > 0) {
+        total.averageBytesPerSecond = static_cast<double>(total.completedBytes) * 1000.0 / total.elapsedMs;
+    }
+    if (total.bytesPerSecond > 0) {
+        qint64 remainingBytes = total.totalBytes - total.completedBytes;
+        total.estimatedRemainingMs = static_cast<qint64>(remainingBytes * 1000.0 / total.bytesPerSecond);
+    }
+
+    return total;
+}
+
+TransferStats MultiDriveWriter::driveStatistics(int drive) const
+{
+    if (drive < 0 || drive >= d->ios.size()) {
+        return TransferStats();
+    }
+    return d->ios[drive]->statistics();
+}
+
+TapeIO *MultiDriveWriter::driveIO(int drive) const
+{
+    if (drive < 0 || drive >= d->ios.size()) {
+        return nullptr;
+    }
+    return d->ios[drive];
+}
+
+QString MultiDriveWriter::lastError() const
+{
+    return d->lastError;
+}
+
+} // namespace qltfs
@@ -0,0 +1,189 @@
+/*
+ * QLTOTapeMan - Qt-based LTO Tape Manager
+ * libqltfs - LTFS Core Library
+ *
+ * Copyright (c) 2026 Jeffrey ZHU (zhxsh1225@gmail.com)
+ * https://github.com/Gypsop/QLTOTapeMan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "libqltfs_global.h"
+#include "io/TapeIO.h"
+
+#include <QObject>
+#include <QList>
+#include <QSharedPointer>
+
+namespace qltfs {
+
+/**
+ * @brief Writes one job to several tape drives at once
+ *
+ * Splits the queued files across the added drives so that each drive
+ * gets about the same number of bytes, then runs one TapeIO per drive
+ * concurrently. Each drive writes its share into its own LTFS index.
+ * Directory entries are written to every drive so each tape has a
+ * complete tree for the files it holds.
+ *
+ * Per-drive progress is combined into aggregate statistics. Signals are
+ * delivered through the event loop of the thread owning the writer.
+ */
+class LIBQLTFS_EXPORT MultiDriveWriter : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit MultiDriveWriter(QObject *parent = nullptr);
+    ~MultiDriveWriter() override;
+
+    // Disable copy
+    MultiDriveWriter(const MultiDriveWriter &) = delete;
+    MultiDriveWriter &operator=(const MultiDriveWriter &) = delete;
+
+    /**
+     * @brief Add a drive to write to
+     * @param device Tape device (must be open and stay valid)
+     * @param index LTFS index receiving the files written to this drive
+     * @return Drive number
+     */
+    int addDrive(TapeDevice *device, QSharedPointer<LtfsIndex> index = QSharedPointer<LtfsIndex>());
+
+    /**
+     * @brief Get number of drives
+     */
+    int driveCount() const;
+
+    /**
+     * @brief Get/set transfer options used on every drive
+     */
+    TransferOptions options() const;
+    void setOptions(const TransferOptions &options);
+
+    // === Job ===
+
+    /**
+     * @brief Add file to the job
+     * @param sourcePath Local file path
+     * @param destPath Destination path on tape (relative to root)
+     */
+    void addFile(const QString &sourcePath, const QString &destPath = QString());
+
+    /**
+     * @brief Add directory to the job (recursive)
+     * @param sourceDir Local directory path
+     * @param destDir Destination directory on tape
+     */
+    void addDirectory(const QString &sourceDir, const QString &destDir = QString());
+
+    /**
+     * @brief Clear the job
+     */
+    void clearQueue();
+
+    /**
+     * @brief Get total size of the job in bytes
+     */
+    qint64 queuedBytes() const;
+
+    /**
+     * @brief Split the job across the drives
+     *
+     * Largest files are assigned first, each to the drive with the fewest
+     * bytes so far. Items keep their original order within a drive.
+     *
+     * @return One item list per drive
+     */
+    QList<QList<TransferItem>> partition() const;
+
+    // === Control ===
+
+    /**
+     * @brief Partition the job and start writing on all drives
+     * @return true if every drive started
+     */
+    bool start();
+
+    /**
+     * @brief Check if any drive is still writing
+     */
+    bool isRunning() const;
+
+    void pause();
+    void resume();
+    void cancel();
+
+    /**
+     * @brief Wait until all drives have finished
+     * @param timeoutMs Timeout in milliseconds (-1 = infinite)
+     * @return true if completed, false if timeout
+     */
+    bool waitForCompletion(int timeoutMs = -1);
+
+    // === Statistics ===
+
+    /**
+     * @brief Get combined statistics of all drives
+     *
+     * Counts, bytes and the recent bytesPerSecond of each drive are
+     * summed; averageBytesPerSecond is the aggregate throughput since
+     * start().
+     */
+    TransferStats statistics() const;
+
+    /**
+     * @brief Get statistics of one drive
+     */
+    TransferStats driveStatistics(int drive) const;
+
+    /**
+     * @brief Get the TapeIO driving one drive (valid after start())
+     */
+    TapeIO *driveIO(int drive) const;
+
+    /**
+     * @brief Get last error message
+     */
+    QString lastError() const;
+
+signals:
+    /**
+     * @brief Emitted when combined progress changes
+     */
+    void progressChanged(int percent, const TransferStats &stats);
+
+    /**
+     * @brief Emitted when one drive has finished its share
+     */
+    void driveCompleted(int drive, const TransferStats &stats);
+
+    /**
+     * @brief Emitted when all drives have finished
+     */
+    void transferCompleted(const TransferStats &stats);
+
+    /**
+     * @brief Emitted on a file error on any drive
+     */
+    void fileError(int drive, const TransferItem &item, const QString &error);
+
+private:
+    class Private;
+    Private *d;
+};
+
+} // namespace qltfs
@@ -0,0 +1,515 @@
+/*
+ * QLTOTapeMan - Qt-based LTO Tape Manager
+ * libqltfs - LTFS Core Library
+ *
+ * Copyright (c) 2026 Jeffrey ZHU (zhxsh1225@gmail.com)
+ * https://github.com/Gypsop/QLTOTapeMan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "SourceReader.h"
+#include "BlockRing.h"
+#include "../util/Tracer.h"
+
+#include <QFile>
+
+#include <deque>
+#include <limits>
+
+#if defined(Q_OS_WIN)
+#include "../device/platform/WinScsi.h"
+#include <QDir>
+#include <windows.h>
+#else
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(QLTFS_HAVE_LIBURING)
+#include <liburing.h>
+#endif
+
+namespace qltfs {
+
+// Page cache released behind the reader per fadvise call
+static constexpr qint64 DONTNEED_CHUNK = 32 * 1024 * 1024;
+
+// Upper bound for concurrently read slots
+static constexpr int MAX_READ_DEPTH = 64;
+
+namespace {
+
+qint64 alignUp(qint64 value, qint64 alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+#if !defined(Q_OS_WIN)
+QString errnoString(int error)
+{
+    return QString::fromLocal8Bit(strerror(error));
+}
+#endif
+
+} // namespace
+
+// ============================================================================
+// SourceReader Private Implementation
+// ============================================================================
+
+class SourceReader::Private
+{
+public:
+    QString path;
+    SourceReadMode mode = SourceReadMode::Sequential;
+    int depth = 1;
+    qint64 size = 0;
+    qint64 releasedUpTo = 0;        ///< Page cache dropped before this offset
+    QString error;
+
+#if defined(Q_OS_WIN)
+    HANDLE handle = INVALID_HANDLE_VALUE;
+#else
+    int fd = -1;
+#endif
+
+#if defined(QLTFS_HAVE_LIBURING)
+    struct io_uring uring;
+    bool async = false;
+#endif
+
+    bool isDirect() const { return mode == SourceReadMode::Direct; }
+
+    bool isOpen() const
+    {
+#if defined(Q_OS_WIN)
+        return handle != INVALID_HANDLE_VALUE;
+#else
+        return fd >= 0;
+#endif
+    }
+
+    bool openHandle(bool direct);
+    void closeHandle();
+    qint64 readAt(char *buffer, qint64 length, qint64 offset);
+    void releaseCache(qint64 upTo, bool force);
+    void fillSync(qint64 offset, qint64 limit, BlockRing &ring, QString &message);
+#if defined(QLTFS_HAVE_LIBURING)
+    void fillAsync(qint64 offset, qint64 limit, BlockRing &ring, QString &message);
+#endif
+};
+
+bool SourceReader::Private::openHandle(bool direct)
+{
+#if defined(Q_OS_WIN)
+    const DWORD flags = direct ? FILE_FLAG_NO_BUFFERING : FILE_FLAG_SEQUENTIAL_SCAN;
+    handle = CreateFileW(reinterpret_cast<LPCWSTR>(QDir::toNativeSeparators(path).utf16()),
+                         GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                         nullptr, OPEN_EXISTING, flags, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) {
+        error = QStringLiteral("Failed to open source file: %1").arg(WinScsi::formatWinError(GetLastError()));
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    size = GetFileSizeEx(handle, &fileSize) ? fileSize.QuadPart : 0;
+#else
+    int flags = O_RDONLY | O_CLOEXEC;
+#if defined(Q_OS_LINUX)
+    if (direct) {
+        flags |= O_DIRECT;
+    }
+#else
+    Q_UNUSED(direct);
+#endif
+    fd = ::open(QFile::encodeName(path).constData(), flags);
+    if (fd < 0) {
+        error = QStringLiteral("Failed to open source file: %1").arg(errnoString(errno));
+        return false;
+    }
+
+#if defined(Q_OS_LINUX)
+    if (!direct) {
+        ::posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    }
+#endif
+
+    struct stat st;
+    size = ::fstat(fd, &st) == 0 ? static_cast<qint64>(st.st_size) : 0;
+#endif
+    return true;
+}
+
+void SourceReader::Private::closeHandle()
+{
+#if defined(Q_OS_WIN)
+    if (handle != INVALID_HANDLE_VALUE) {
+        CloseHandle(handle);
+        handle = INVALID_HANDLE_VALUE;
+    }
+#else
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+#endif
+}
+
+qint64 SourceReader::Private::readAt(char *buffer, qint64 length, qint64 offset)
+{
+    // Unbuffered reads cover whole alignment units; slots have the room
+    const qint64 request = isDirect() ? alignUp(length, DIRECT_ALIGNMENT) : length;
+
+    qint64 filled = 0;
+    while (filled < request) {
+#if defined(Q_OS_WIN)
+        OVERLAPPED overlapped = {};
+        const qint64 position = offset + filled;
+        overlapped.Offset = static_cast<DWORD>(position);
+        overlapped.OffsetHigh = static_cast<DWORD>(position >> 32);
+        DWORD n = 0;
+        const DWORD chunk = static_cast<DWORD>(qMin<qint64>(request - filled, 1 << 30));
+        if (!ReadFile(handle, buffer + filled, chunk, &n, &overlapped)) {
+            const DWORD code = GetLastError();
+            if (code == ERROR_HANDLE_EOF) {
+                break;
+            }
+            error = WinScsi::formatWinError(code);
+            return -1;
+        }
+#else
+        const ssize_t n = ::pread(fd, buffer + filled, static_cast<size_t>(request - filled), offset + filled);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            error = errnoString(errno);
+            return -1;
+        }
+#endif
+        if (n == 0) {
+            break;
+        }
+        filled += n;
+
+        // An unaligned count from an unbuffered read means end of file
+        if (isDirect() && filled % DIRECT_ALIGNMENT != 0) {
+            break;
+        }
+    }
+    return qMin(filled, length);
+}
+
+void SourceReader::Private::releaseCache(qint64 upTo, bool force)
+{
+#if defined(Q_OS_LINUX)
+    if (isDirect() || upTo <= releasedUpTo) {
+        return;
+    }
+    if (force || upTo - releasedUpTo >= DONTNEED_CHUNK) {
+        ::posix_fadvise(fd, releasedUpTo, upTo - releasedUpTo, POSIX_FADV_DONTNEED);
+        releasedUpTo = upTo;
+    }
+#else
+    Q_UNUSED(upTo);
+    Q_UNUSED(force);
+#endif
+}
+
+void SourceReader::Private::fillSync(qint64 offset, qint64 limit, BlockRing &ring, QString &message)
+{
+    qint64 position = offset;
+    qint64 remaining = limit < 0 ? std::numeric_limits<qint64>::max() : limit;
+    for (;;) {
+        BlockSlot *slot = ring.acquireWrite();
+        if (!slot) {
+            return;
+        }
+
+        TraceSpan span("tapeio", "readSource");
+        const qint64 wanted = qMin<qint64>(slot->capacity, remaining);
+        const qint64 filled = readAt(slot->data, wanted, position);
+        if (filled < 0) {
+            message = error;
+            ring.abort();
+            return;
+        }
+
+        span.setArg("bytes", filled);
+        position += filled;
+        remaining -= filled;
+        bool last = filled < wanted || remaining == 0 || position >= size;
+        releaseCache(position, last);
+        ring.commitWrite(static_cast<uint32_t>(filled), last);
+        if (last) {
+            return;
+        }
+    }
+}
+
+#if defined(QLTFS_HAVE_LIBURING)
+
+void SourceReader::Private::fillAsync(qint64 offset, qint64 limit, BlockRing &ring, QString &message)
+{
+    struct Read {
+        BlockSlot *slot;
+        qint64 offset;
+        qint64 wanted;
+        qint64 result;
+        bool done;
+    };
+
+    // Completion data points into the deque; push_back keeps elements in place
+    std::deque<Read> reads;
+    qint64 next = offset;
+    qint64 remaining = limit < 0 ? std::numeric_limits<qint64>::max() : limit;
+    bool submittedAll = false;
+
+    auto reapOne = [this]() {
+        struct io_uring_cqe *cqe = nullptr;
+        int rc;
+        do {
+            rc = io_uring_wait_cqe(&uring, &cqe);
+        } while (rc == -EINTR);
+        if (rc < 0) {
+            return false;
+        }
+        Read *read = static_cast<Read *>(io_uring_cqe_get_data(cqe));
+        read->result = cqe->res;
+        read->done = true;
+        io_uring_cqe_seen(&uring, cqe);
+        return true;
+    };
+
+    // Slot buffers must not go back to the ring while the kernel fills them
+    auto drain = [&]() {
+        for (const Read &read : reads) {
+            while (!read.done) {
+                if (!reapOne()) {
+                    // Tearing the ring down waits for what is still in flight
+                    io_uring_queue_exit(&uring);
+                    async = false;
+                    reads.clear();
+                    return;
+                }
+            }
+        }
+        reads.clear();
+    };
+
+    auto fail = [&](const QString &text) {
+        message = text;
+        ring.abort();
+        drain();
+    };
+
+    for (;;) {
+        // Keep up to depth slots being read. Only the first slot may be
+        // waited for: with reads in flight the consumer may be waiting on them.
+        while (!submittedAll && static_cast<int>(reads.size()) < depth && io_uring_sq_space_left(&uring) > 0) {
+            BlockSlot *slot = reads.empty() ? ring.acquireWrite() : ring.tryAcquireWrite();
+            if (!slot) {
+                break;
+            }
+
+            struct io_uring_sqe *sqe = io_uring_get_sqe(&uring);
+
+            const qint64 wanted = qMin<qint64>(slot->capacity, remaining);
+            reads.push_back(Read{slot, next, wanted, 0, false});
+            const qint64 request = isDirect() ? alignUp(wanted, DIRECT_ALIGNMENT) : wanted;
+            io_uring_prep_read(sqe, fd, slot->data, static_cast<unsigned>(request), static_cast<__u64>(next));
+            io_uring_sqe_set_data(sqe, &reads.back());
+
+            const int rc = io_uring_submit(&uring);
+            if (rc < 0) {
+                reads.pop_back();
+                fail(QStringLiteral("io_uring submit failed: %1").arg(errnoString(-rc)));
+                return;
+            }
+
+            next += wanted;
+            remaining -= wanted;
+            submittedAll = remaining == 0 || next >= size;
+        }
+
+        if (reads.empty()) {
+            return;     // Ring aborted by the consumer
+        }
+
+        Read &front = reads.front();
+        {
+            TraceSpan span("tapeio", "readSource");
+            while (!front.done) {
+                if (!reapOne()) {
+                    fail(QStringLiteral("io_uring wait failed"));
+                    return;
+                }
+            }
+            span.setArg("bytes", front.result);
+        }
+
+        if (ring.isAborted()) {
+            drain();
+            return;
+        }
+        if (front.result < 0) {
+            fail(errnoString(static_cast<int>(-front.result)));
+            return;
+        }
+
+        qint64 filled = qMin(front.result, front.wanted);
+
+        // A short read before end of file: finish the slot synchronously
+        if (filled < front.wanted && front.offset + filled < size &&
+            (!isDirect() || filled % DIRECT_ALIGNMENT == 0)) {
+            const qint64 more = readAt(front.slot->data + filled, front.wanted - filled, front.offset + filled);
+            if (more < 0) {
+                fail(error);
+                return;
+            }
+            filled += more;
+        }
+
+        const bool last = filled < front.wanted || (submittedAll && reads.size() == 1);
+        releaseCache(front.offset + filled, last);
+        ring.commitWrite(static_cast<uint32_t>(filled), last);
+        reads.pop_front();
+
+        if (last) {
+            drain();
+            return;
+        }
+    }
+}
+
+#endif // QLTFS_HAVE_LIBURING
+
+// ============================================================================
+// SourceReader Implementation
+// ============================================================================
+
+SourceReader::SourceReader()
+    : d(new Private)
+{
+}
+
+SourceReader::~SourceReader()
+{
+    close();
+    delete d;
+}
+
+bool SourceReader::open(const QString &path, SourceReadMode mode, int depth)
+{
+    close();
+
+    d->path = path;
+    d->depth = qBound(1, depth, MAX_READ_DEPTH);
+
+#if defined(Q_OS_LINUX) || defined(Q_OS_WIN)
+    bool direct = mode == SourceReadMode::Direct;
+#else
+    bool direct = false;
+#endif
+
+    if (!d->openHandle(direct)) {
+        // tmpfs and many FUSE file systems refuse unbuffered access
+        if (!direct || !d->openHandle(false)) {
+            return false;
+        }
+        direct = false;
+    }
+    d->mode = direct ? SourceReadMode::Direct : SourceReadMode::Sequential;
+
+#if defined(QLTFS_HAVE_LIBURING)
+    d->async = d->depth > 1 && io_uring_queue_init(static_cast<unsigned>(d->depth), &d->uring, 0) == 0;
+#endif
+    return true;
+}
+
+void SourceReader::close()
+{
+#if defined(QLTFS_HAVE_LIBURING)
+    if (d->async) {
+        io_uring_queue_exit(&d->uring);
+        d->async = false;
+    }
+#endif
+    d->closeHandle();
+}
+
+bool SourceReader::isOpen() const
+{
+    return d->isOpen();
+}
+
+SourceReadMode SourceReader::mode() const
+{
+    return d->mode;
+}
+
+bool SourceReader::isAsync() const
+{
+#if defined(QLTFS_HAVE_LIBURING)
+    return d->async;
+#else
+    return false;
+#endif
+}
+
+qint64 SourceReader::size() const
+{
+    return d->size;
+}
+
+void SourceReader::fillRing(qint64 offset, qint64 limit, BlockRing &ring, QString &error)
+{
+    if (!d->isOpen()) {
+        error = QStringLiteral("Source file not open");
+        ring.abort();
+        return;
+    }
+
+    // Segments or slots off the alignment cannot be read unbuffered
+    if (d->isDirect() && (offset % DIRECT_ALIGNMENT != 0 || ring.slotSize() % DIRECT_ALIGNMENT != 0)) {
+        d->closeHandle();
+        if (!d->openHandle(false)) {
+            error = d->error;
+            ring.abort();
+            return;
+        }
+        d->mode = SourceReadMode::Sequential;
+    }
+
+    d->releasedUpTo = offset;
+
+#if defined(QLTFS_HAVE_LIBURING)
+    if (d->async) {
+        d->fillAsync(offset, limit, ring, error);
+        return;
+    }
+#endif
+    d->fillSync(offset, limit, ring, error);
+}
+
+QString SourceReader::errorString() const
+{
+    return d->error;
+}
+
+} // namespace qltfs
@@ -0,0 +1,116 @@
+/*
+ * QLTOTapeMan - Qt-based LTO Tape Manager
+ * libqltfs - LTFS Core Library
+ *
+ * Copyright (c) 2026 Jeffrey ZHU (zhxsh1225@gmail.com)
+ * https://github.com/Gypsop/QLTOTapeMan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "libqltfs_global.h"
+
+#include <QString>
+
+namespace qltfs {
+
+class BlockRing;
+
+/**
+ * @brief How source files are read for writes
+ */
+enum class SourceReadMode {
+    Buffered,       ///< QFile through the page cache
+    Sequential,     ///< Page cache with sequential readahead; pages are dropped once read
+    Direct          ///< Bypass the page cache (O_DIRECT / FILE_FLAG_NO_BUFFERING)
+};
+
+/**
+ * @brief Reads a source file into BlockRing slots without filling the page cache
+ *
+ * Archive data is read once and never again, so caching it only evicts
+ * the working set of the rest of the host. Sequential mode keeps the
+ * kernel's readahead but tells it to drop pages behind the reader;
+ * Direct mode reads straight into the aligned pool buffers.
+ *
+ * On Linux with liburing, up to depth() slots are read asynchronously
+ * through io_uring so the disk sees a queue of large requests.
+ * Elsewhere, or if io_uring cannot be set up, reads are synchronous.
+ *
+ * Direct mode needs file offsets and slot sizes aligned to 4 KiB; when
+ * they are not, or the file system refuses unbuffered access, the reader
+ * falls back to Sequential mode. Not thread-safe.
+ */
+class LIBQLTFS_EXPORT SourceReader
+{
+public:
+    /// Alignment of offsets, lengths and buffers in Direct mode
+    static constexpr quint32 DIRECT_ALIGNMENT = 4096;
+
+    SourceReader();
+    ~SourceReader();
+
+    // Disable copy
+    SourceReader(const SourceReader &) = delete;
+    SourceReader &operator=(const SourceReader &) = delete;
+
+    /**
+     * @brief Open a file for reading
+     * @param path Source file path
+     * @param mode Requested mode (Buffered is treated as Sequential)
+     * @param depth Slots read concurrently with io_uring (1 = synchronous)
+     * @return true on success
+     */
+    bool open(const QString &path, SourceReadMode mode, int depth = 4);
+
+    void close();
+    bool isOpen() const;
+
+    /**
+     * @brief Mode in effect after fallbacks
+     */
+    SourceReadMode mode() const;
+
+    /**
+     * @brief Check if reads are queued asynchronously
+     */
+    bool isAsync() const;
+
+    /**
+     * @brief File size when opened
+     */
+    qint64 size() const;
+
+    /**
+     * @brief Fill ring slots from the file
+     *
+     * Reads from @p offset until end of file, or until @p limit bytes if
+     * it is not negative. Every slot but the final one is full. On error
+     * the ring is aborted and the message is left in @p error.
+     */
+    void fillRing(qint64 offset, qint64 limit, BlockRing &ring, QString &error);
+
+    /**
+     * @brief Get last error message
+     */
+    QString errorString() const;
+
+private:
+    class Private;
+    Private *d;
+};
+
+} // namespace qltfs
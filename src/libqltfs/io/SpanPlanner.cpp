@@ -0,0 +1,426 @@
+/*
+ * QLTOTapeMan - Qt-based LTO Tape Manager
+ * libqltfs - LTFS Core Library
+ *
+ * Copyright (c) 2026 Jeffrey ZHU (zhxsh1225@gmail.com)
+ * https://github.com/Gypsop/QLTOTapeMan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "SpanPlanner.h"
+#include "BlockManager.h"
+
+#include <QVector>
+
+#include <algorithm>
+#include <cmath>
+
+namespace qltfs {
+
+// ============================================================================
+// SpanPlanner Private Implementation
+// ============================================================================
+
+class SpanPlanner::Private
+{
+public:
+    QList<quint64> cartridges;
+    quint64 spareCapacity = 0;
+    SpanStrategy strategy = SpanStrategy::Sequential;
+    quint32 blockSize = BlockManager::DEFAULT_BLOCK_SIZE;
+    double compressionRatio = 1.0;
+    quint64 indexReserve = 64ULL * 1024 * 1024;
+    quint64 indexBytesPerFile = 1024;
+    qint64 spanThreshold = 1024LL * 1024 * 1024;
+
+    /**
+     * @brief Cartridge being filled during planning
+     */
+    struct Bin {
+        SpanVolume volume;
+        QVector<int> order;     ///< Queue index of each item, to restore queue order
+    };
+
+    /**
+     * @brief Bytes on tape for @p length bytes of file data plus its index entry
+     */
+    quint64 tapeCost(qint64 length) const
+    {
+        const quint64 blocks = (static_cast<quint64>(length) + blockSize - 1) / blockSize;
+        const double onTape = std::ceil(static_cast<double>(blocks * blockSize) / compressionRatio);
+        return static_cast<quint64>(onTape) + indexBytesPerFile;
+    }
+
+    /**
+     * @brief Largest block-aligned part of a file that still fits into a bin
+     */
+    qint64 fittingLength(const Bin &bin) const
+    {
+        const quint64 free = bin.volume.capacity - bin.volume.plannedBytes;
+        if (free <= indexBytesPerFile) {
+            return 0;
+        }
+        const double data = static_cast<double>(free - indexBytesPerFile) * compressionRatio;
+        return static_cast<qint64>(data / blockSize) * blockSize;
+    }
+
+    bool fits(const Bin &bin, qint64 length) const
+    {
+        return bin.volume.plannedBytes + tapeCost(length) <= bin.volume.capacity;
+    }
+
+    /**
+     * @brief Open the next cartridge, or return false if none is left
+     */
+    bool openBin(QList<Bin> &bins) const
+    {
+        Bin bin;
+        const int next = bins.size();
+        if (next < cartridges.size()) {
+            bin.volume.cartridge = next;
+            bin.volume.capacity = cartridges[next];
+        } else if (spareCapacity > 0) {
+            bin.volume.capacity = spareCapacity;
+        } else {
+            return false;
+        }
+
+        bin.volume.capacity = bin.volume.capacity > indexReserve ? bin.volume.capacity - indexReserve : 0;
+        bins.append(bin);
+        return true;
+    }
+
+    static void place(Bin &bin, int order, const TransferItem &item, quint64 cost)
+    {
+        bin.volume.items.append(item);
+        bin.volume.plannedBytes += cost;
+        bin.order.append(order);
+    }
+
+    static TransferItem part(const TransferItem &item, qint64 offset, qint64 length)
+    {
+        TransferItem segment = item;
+        segment.sourceOffset = item.sourceOffset + offset;
+        segment.sourceLength = length;
+        segment.size = length;
+        return segment;
+    }
+
+    quint64 room(const Bin &bin) const
+    {
+        return bin.volume.capacity - bin.volume.plannedBytes;
+    }
+
+    /**
+     * @brief Split a file over the bins from @p first on, opening more as needed
+     * @return false if capacity ran out; nothing is placed then
+     */
+    bool span(QList<Bin> &bins, int first, int order, const TransferItem &item) const
+    {
+        struct Piece {
+            int bin;
+            qint64 offset;
+            qint64 length;
+        };
+
+        const int opened = bins.size();
+        QVector<Piece> pieces;
+        qint64 offset = 0;
+        for (int b = first; offset < item.size; ++b) {
+            if (b >= bins.size() && !openBin(bins)) {
+                break;
+            }
+
+            const qint64 rest = item.size - offset;
+            const qint64 length = fits(bins[b], rest) ? rest : qMin(rest, fittingLength(bins[b]));
+            if (length <= 0) {
+                if (b >= opened) {
+                    break;      // Even an empty cartridge takes nothing
+                }
+                continue;
+            }
+            pieces.append({b, offset, length});
+            offset += length;
+        }
+
+        if (offset < item.size) {
+            while (bins.size() > opened) {
+                bins.removeLast();
+            }
+            return false;
+        }
+
+        for (const Piece &piece : pieces) {
+            place(bins[piece.bin], order, part(item, piece.offset, piece.length), tapeCost(piece.length));
+        }
+        return true;
+    }
+
+    void planSequential(const QList<TransferItem> &items, const QVector<int> &files,
+                        QList<Bin> &bins, SpanPlan &plan) const;
+    void planBestFit(const QList<TransferItem> &items, QVector<int> files,
+                     QList<Bin> &bins, SpanPlan &plan) const;
+};
+
+void SpanPlanner::Private::planSequential(const QList<TransferItem> &items, const QVector<int> &files,
+                                          QList<Bin> &bins, SpanPlan &plan) const
+{
+    int current = 0;
+    for (int index : files) {
+        const TransferItem &item = items[index];
+
+        for (;;) {
+            if (current >= bins.size() && !openBin(bins)) {
+                plan.unplaced.append(item);
+                break;
+            }
+
+            Bin &bin = bins[current];
+            if (fits(bin, item.size)) {
+                place(bin, index, item, tapeCost(item.size));
+                break;
+            }
+
+            if (item.size >= spanThreshold && fittingLength(bin) > 0) {
+                if (span(bins, current, index, item)) {
+                    plan.spannedFiles++;
+                    current = bins.size() - 1;
+                } else {
+                    plan.unplaced.append(item);
+                }
+                break;
+            }
+
+            if (bin.volume.items.isEmpty()) {
+                // Not even an empty cartridge takes it
+                plan.unplaced.append(item);
+                break;
+            }
+
+            // Does not fit and is not split: this cartridge is done
+            current++;
+        }
+    }
+}
+
+void SpanPlanner::Private::planBestFit(const QList<TransferItem> &items, QVector<int> files,
+                                       QList<Bin> &bins, SpanPlan &plan) const
+{
+    std::stable_sort(files.begin(), files.end(), [&items](int a, int b) {
+        return items[a].size > items[b].size;
+    });
+
+    for (int index : files) {
+        const TransferItem &item = items[index];
+
+        // Open cartridge with the least room left that still takes the whole file
+        int best = -1;
+        for (int b = 0; b < bins.size(); ++b) {
+            if (fits(bins[b], item.size) && (best < 0 || room(bins[b]) < room(bins[best]))) {
+                best = b;
+            }
+        }
+
+        if (best < 0 && (bins.isEmpty() || !bins.last().volume.items.isEmpty()) && openBin(bins) &&
+            fits(bins.last(), item.size)) {
+            best = bins.size() - 1;
+        }
+
+        if (best >= 0) {
+            place(bins[best], index, item, tapeCost(item.size));
+            continue;
+        }
+
+        if (item.size >= spanThreshold) {
+            // Start on the cartridge with the most room so the file uses few of them
+            int first = 0;
+            for (int b = 1; b < bins.size(); ++b) {
+                if (room(bins[b]) > room(bins[first])) {
+                    first = b;
+                }
+            }
+            if (!bins.isEmpty() && span(bins, first, index, item)) {
+                plan.spannedFiles++;
+                continue;
+            }
+        }
+        plan.unplaced.append(item);
+    }
+}
+
+// ============================================================================
+// SpanPlanner Implementation
+// ============================================================================
+
+SpanPlanner::SpanPlanner()
+    : d(new Private)
+{
+}
+
+SpanPlanner::~SpanPlanner()
+{
+    delete d;
+}
+
+int SpanPlanner::addCartridge(quint64 remainingCapacity)
+{
+    d->cartridges.append(remainingCapacity);
+    return d->cartridges.size() - 1;
+}
+
+int SpanPlanner::addCartridge(const TapeMediaInfo &media)
+{
+    return addCartridge(media.remainingCapacity);
+}
+
+int SpanPlanner::cartridgeCount() const
+{
+    return d->cartridges.size();
+}
+
+void SpanPlanner::clearCartridges()
+{
+    d->cartridges.clear();
+}
+
+void SpanPlanner::setSpareCapacity(quint64 capacity)
+{
+    d->spareCapacity = capacity;
+}
+
+quint64 SpanPlanner::spareCapacity() const
+{
+    return d->spareCapacity;
+}
+
+void SpanPlanner::setStrategy(SpanStrategy strategy)
+{
+    d->strategy = strategy;
+}
+
+SpanStrategy SpanPlanner::strategy() const
+{
+    return d->strategy;
+}
+
+void SpanPlanner::setBlockSize(quint32 blockSize)
+{
+    d->blockSize = blockSize > 0 ? blockSize : BlockManager::DEFAULT_BLOCK_SIZE;
+}
+
+quint32 SpanPlanner::blockSize() const
+{
+    return d->blockSize;
+}
+
+void SpanPlanner::setCompressionRatio(double ratio)
+{
+    d->compressionRatio = std::isfinite(ratio) ? qMax(1.0, ratio) : 1.0;
+}
+
+double SpanPlanner::compressionRatio() const
+{
+    return d->compressionRatio;
+}
+
+void SpanPlanner::setIndexReserve(quint64 baseBytes, quint64 bytesPerFile)
+{
+    d->indexReserve = baseBytes;
+    d->indexBytesPerFile = bytesPerFile;
+}
+
+quint64 SpanPlanner::indexReserve() const
+{
+    return d->indexReserve;
+}
+
+quint64 SpanPlanner::indexBytesPerFile() const
+{
+    return d->indexBytesPerFile;
+}
+
+void SpanPlanner::setSpanThreshold(qint64 bytes)
+{
+    d->spanThreshold = qMax<qint64>(d->blockSize, bytes);
+}
+
+qint64 SpanPlanner::spanThreshold() const
+{
+    return d->spanThreshold;
+}
+
+SpanPlan SpanPlanner::plan(const QList<TransferItem> &items) const
+{
+    SpanPlan plan;
+
+    QVector<int> directories;
+    QVector<int> files;
+    for (int i = 0; i < items.size(); ++i) {
+        if (items[i].isDirectory) {
+            directories.append(i);
+        } else {
+            files.append(i);
+        }
+    }
+
+    QList<Private::Bin> bins;
+    if (d->strategy == SpanStrategy::BestFit) {
+        d->planBestFit(items, files, bins, plan);
+    } else {
+        d->planSequential(items, files, bins, plan);
+    }
+
+    for (Private::Bin &bin : bins) {
+        if (bin.volume.items.isEmpty()) {
+            continue;
+        }
+
+        // Directories on every cartridge, then everything in queue order
+        for (int index : directories) {
+            bin.volume.items.append(items[index]);
+            bin.order.append(index);
+        }
+
+        QVector<int> positions(bin.order.size());
+        for (int i = 0; i < positions.size(); ++i) {
+            positions[i] = i;
+        }
+        std::stable_sort(positions.begin(), positions.end(), [&bin](int a, int b) {
+            return bin.order[a] < bin.order[b];
+        });
+
+        SpanVolume volume;
+        volume.cartridge = bin.volume.cartridge;
+        volume.capacity = bin.volume.capacity;
+        volume.plannedBytes = bin.volume.plannedBytes;
+        volume.items.reserve(positions.size());
+        for (int position : positions) {
+            volume.items.append(bin.volume.items[position]);
+        }
+        plan.volumes.append(volume);
+    }
+
+    return plan;
+}
+
+double SpanPlanner::measureCompressionRatio(quint64 hostBytes, quint64 tapeBytes)
+{
+    if (hostBytes == 0 || tapeBytes == 0) {
+        return 1.0;
+    }
+    return static_cast<double>(hostBytes) / static_cast<double>(tapeBytes);
+}
+
+} // namespace qltfs
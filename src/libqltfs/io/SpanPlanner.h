@@ -0,0 +1,160 @@
+/*
+ * QLTOTapeMan - Qt-based LTO Tape Manager
+ * libqltfs - LTFS Core Library
+ *
+ * Copyright (c) 2026 Jeffrey ZHU (zhxsh1225@gmail.com)
+ * https://github.com/Gypsop/QLTOTapeMan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "libqltfs_global.h"
+#include "io/TapeIO.h"
+
+#include <QList>
+
+namespace qltfs {
+
+/**
+ * @brief How SpanPlanner assigns files to cartridges
+ */
+enum class SpanStrategy {
+    Sequential,     ///< Keep queue order; fill one cartridge after the other
+    BestFit         ///< Largest files first into the fullest cartridge they fit (fewer spans)
+};
+
+/**
+ * @brief Files planned for one cartridge
+ */
+struct LIBQLTFS_EXPORT SpanVolume {
+    int cartridge = -1;             ///< Index of the added cartridge, or -1 for a spare
+    quint64 capacity = 0;           ///< Usable bytes after the index reserve (on tape)
+    quint64 plannedBytes = 0;       ///< Bytes planned on tape, including index growth
+    QList<TransferItem> items;      ///< Items to queue on this cartridge, in queue order
+};
+
+/**
+ * @brief Result of SpanPlanner::plan()
+ */
+struct LIBQLTFS_EXPORT SpanPlan {
+    QList<SpanVolume> volumes;
+    QList<TransferItem> unplaced;   ///< Files for which no capacity was left
+    int spannedFiles = 0;           ///< Files split across cartridges
+
+    bool isComplete() const { return unplaced.isEmpty(); }
+};
+
+/**
+ * @brief Plans a write job across several cartridges by capacity
+ *
+ * Each cartridge offers its remaining capacity minus a reserve for the
+ * index copy LTFS writes at the end of the data partition. The reserve
+ * grows with the number of files placed. File data is counted in whole
+ * blocks and divided by the expected compression ratio.
+ *
+ * A file larger than the spanning threshold that does not fit is split
+ * at block boundaries. Each part is a TransferItem with sourceOffset /
+ * sourceLength set, and becomes an extent at that file offset on its
+ * cartridge. Smaller files move to the next cartridge whole.
+ *
+ * After the added cartridges, spare cartridges of a fixed capacity are
+ * opened as needed if a spare capacity is set.
+ */
+class LIBQLTFS_EXPORT SpanPlanner
+{
+public:
+    SpanPlanner();
+    ~SpanPlanner();
+
+    // Disable copy
+    SpanPlanner(const SpanPlanner &) = delete;
+    SpanPlanner &operator=(const SpanPlanner &) = delete;
+
+    /**
+     * @brief Add a cartridge by its remaining capacity in bytes
+     * @return Cartridge index
+     */
+    int addCartridge(quint64 remainingCapacity);
+
+    /**
+     * @brief Add a cartridge from a drive's media information
+     */
+    int addCartridge(const TapeMediaInfo &media);
+
+    int cartridgeCount() const;
+    void clearCartridges();
+
+    /**
+     * @brief Capacity of blank cartridges used once the added ones are full (0 = none)
+     */
+    void setSpareCapacity(quint64 capacity);
+    quint64 spareCapacity() const;
+
+    void setStrategy(SpanStrategy strategy);
+    SpanStrategy strategy() const;
+
+    /**
+     * @brief Block size data is written in (default DEFAULT_BLOCK_SIZE)
+     */
+    void setBlockSize(quint32 blockSize);
+    quint32 blockSize() const;
+
+    /**
+     * @brief Expected ratio of host bytes to bytes on tape (default 1.0)
+     *
+     * Use measureCompressionRatio() with the counters of the current session on
+     * the drive. Values below 1.0 are treated as 1.0.
+     */
+    void setCompressionRatio(double ratio);
+    double compressionRatio() const;
+
+    /**
+     * @brief Space kept free on every cartridge for the index
+     * @param baseBytes Fixed reserve (default 64 MiB)
+     * @param bytesPerFile Index growth per file placed (default 1 KiB)
+     */
+    void setIndexReserve(quint64 baseBytes, quint64 bytesPerFile);
+    quint64 indexReserve() const;
+    quint64 indexBytesPerFile() const;
+
+    /**
+     * @brief Files at least this large may be split (default 1 GiB)
+     */
+    void setSpanThreshold(qint64 bytes);
+    qint64 spanThreshold() const;
+
+    /**
+     * @brief Assign items to cartridges
+     *
+     * Directory items are put on every cartridge, files on one or (when
+     * split) several.
+     *
+     * @param items Queue to plan, e.g. TapeIO::items()
+     */
+    SpanPlan plan(const QList<TransferItem> &items) const;
+
+    /**
+     * @brief Compression ratio from host and tape byte counters
+     * @return Ratio, or 1.0 if nothing has been written yet
+     */
+    static double measureCompressionRatio(quint64 hostBytes, quint64 tapeBytes);
+
+private:
+    class Private;
+    Private *d;
+};
+
+} // namespace qltfs
@@ -20,16 +20,346 @@
  */
 
 #include "TapeIO.h"
+#include "BlockManager.h"
+#include "BlockRing.h"
+#include "BlockSizeTuner.h"
+#include "DirectoryScanner.h"
+#include "TarWriter.h"
+#include "TransferJournal.h"
+#include "TransferProgress.h"
+#include "TransferQueue.h"
+#include "../util/Tracer.h"
 
 #include <QFileInfo>
 #include <QDirIterator>
+#include <QAbstractSocket>
+#include <QLocalSocket>
 #include <QElapsedTimer>
 #include <QThread>
 #include <QMutexLocker>
+#include <QWaitCondition>
+#include <QDeadlineTimer>
+#include <QScopedPointer>
+#include <QThreadPool>
+#include <QQueue>
+#include <QtConcurrent>
 #include <QDebug>
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
 namespace qltfs {
 
+// Minimum time between progress signals; pollers read TransferProgress instead
+static constexpr qint64 PROGRESS_INTERVAL_MS = 100;
+
+// Minimum time between compression log page reads while writing
+static constexpr qint64 COMPRESSION_POLL_MS = 2000;
+
+// MAM attribute holding the cartridge serial number; names the journal's volume
+static constexpr quint16 MAM_MEDIUM_SERIAL_NUMBER = 0x0401;
+
+// Longest wait for stream data before checking whether the write was aborted
+static constexpr int STREAM_POLL_MS = 200;
+
+// Restore cost model: a short LOCATE stops the drive, repositions and
+// ramps back up to speed; reading a gap through costs its length at the
+// read rate (measured in the current pass, or assumed until enough of
+// it has been read to be past the drive's ramp-up)
+static constexpr double LOCATE_SECONDS = 3.0;
+static constexpr double DEFAULT_READ_RATE = 300.0 * 1024 * 1024;
+static constexpr qint64 MIN_READ_RATE_SAMPLE = 64LL * 1024 * 1024;
+
+namespace {
+
+/**
+ * @brief Read-ahead loop run on the reader thread
+ *
+ * Fills ring slots with full blocks from the file until end of file, or
+ * until @p limit bytes were read if it is not negative. Only the final
+ * block may be short. On error the ring is aborted and the message is
+ * left in @p error.
+ */
+void fillRingFromFile(QFile &file, qint64 limit, BlockRing &ring, QString &error)
+{
+    qint64 remaining = limit < 0 ? std::numeric_limits<qint64>::max() : limit;
+    for (;;) {
+        BlockSlot *slot = ring.acquireWrite();
+        if (!slot) {
+            return;
+        }
+
+        TraceSpan span("tapeio", "readSource");
+        const qint64 wanted = qMin<qint64>(slot->capacity, remaining);
+        qint64 filled = 0;
+        while (filled < wanted) {
+            qint64 n = file.read(slot->data + filled, wanted - filled);
+            if (n < 0) {
+                error = file.errorString();
+                ring.abort();
+                return;
+            }
+            if (n == 0) {
+                break;
+            }
+            filled += n;
+        }
+
+        span.setArg("bytes", filled);
+        remaining -= filled;
+        bool last = filled < wanted || remaining == 0 || file.atEnd();
+        ring.commitWrite(static_cast<uint32_t>(filled), last);
+        if (last) {
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Whether a failed read on a sequential device is a clean end
+ *
+ * Sockets say why read() failed; any other sequential device only
+ * fails read() once it has been closed.
+ */
+bool isPeerClosed(const QIODevice &device)
+{
+    if (auto *socket = qobject_cast<const QAbstractSocket *>(&device)) {
+        return socket->error() == QAbstractSocket::RemoteHostClosedError;
+    }
+    if (auto *socket = qobject_cast<const QLocalSocket *>(&device)) {
+        return socket->error() == QLocalSocket::PeerClosedError;
+    }
+    return true;
+}
+
+/**
+ * @brief Read-ahead loop for a stream of unknown length
+ *
+ * Fills ring slots with full blocks until the stream ends; only the
+ * final block may be short. A QFile blocks in read() and returns 0 at
+ * the end. Sockets only hand out what has arrived, so an empty read
+ * waits for more. A socket returns -1 both when the peer closed the
+ * connection and when it broke, so only a clean close ends the stream.
+ * The device is pulled onto the reader thread while it is read.
+ */
+void fillRingFromStream(QIODevice &device, BlockRing &ring, QString &error)
+{
+    device.moveToThread(QThread::currentThread());
+    const bool blocking = qobject_cast<QFileDevice *>(&device) || !device.isSequential();
+
+    for (;;) {
+        BlockSlot *slot = ring.acquireWrite();
+        if (!slot) {
+            break;
+        }
+
+        TraceSpan span("tapeio", "readStream");
+        qint64 filled = 0;
+        bool end = false;
+        while (filled < slot->capacity && !end) {
+            const qint64 n = device.read(slot->data + filled, slot->capacity - filled);
+            if (n > 0) {
+                filled += n;
+            } else if (n < 0 && (blocking || !isPeerClosed(device))) {
+                error = device.errorString();
+                ring.abort();
+                device.moveToThread(nullptr);
+                return;
+            } else if (n < 0 || blocking) {
+                end = true;
+            } else if (!device.waitForReadyRead(STREAM_POLL_MS) && ring.isAborted()) {
+                device.moveToThread(nullptr);
+                return;
+            }
+        }
+
+        span.setArg("bytes", filled);
+        ring.commitWrite(static_cast<uint32_t>(filled), end);
+        if (end) {
+            break;
+        }
+    }
+
+    device.moveToThread(nullptr);
+}
+
+/**
+ * @brief Shannon entropy of a sample in bits per byte (0 to 8)
+ *
+ * Four histograms side by side avoid the store-to-load stalls of
+ * counting runs of equal bytes into the same slot.
+ */
+double sampleEntropy(const char *data, qint64 length)
+{
+    if (length <= 0) {
+        return 0.0;
+    }
+
+    quint32 counts[4][256] = {};
+    const quint8 *bytes = reinterpret_cast<const quint8 *>(data);
+    qint64 i = 0;
+    for (; i + 4 <= length; i += 4) {
+        counts[0][bytes[i]]++;
+        counts[1][bytes[i + 1]]++;
+        counts[2][bytes[i + 2]]++;
+        counts[3][bytes[i + 3]]++;
+    }
+    for (; i < length; ++i) {
+        counts[0][bytes[i]]++;
+    }
+
+    double entropy = 0.0;
+    const double total = static_cast<double>(length);
+    for (int value = 0; value < 256; ++value) {
+        const quint32 count = counts[0][value] + counts[1][value] + counts[2][value] + counts[3][value];
+        if (count > 0) {
+            const double p = count / total;
+            entropy -= p * std::log2(p);
+        }
+    }
+    return entropy;
+}
+
+/**
+ * @brief Gives the current thread use of a sink without thread affinity
+ *
+ * Sockets and pipes must be driven from the thread they belong to. An
+ * export hands its sink back and forth between the caller (for archive
+ * headers) and the drain thread (for file data); whoever writes pulls
+ * it over and releases it again when done.
+ */
+class SinkAccess
+{
+public:
+    explicit SinkAccess(QIODevice *sink)
+        : m_sink(sink && !sink->thread() ? sink : nullptr)
+    {
+        if (m_sink) {
+            m_sink->moveToThread(QThread::currentThread());
+        }
+    }
+
+    ~SinkAccess()
+    {
+        if (m_sink) {
+            m_sink->moveToThread(nullptr);
+        }
+    }
+
+    SinkAccess(const SinkAccess &) = delete;
+    SinkAccess &operator=(const SinkAccess &) = delete;
+
+private:
+    QIODevice *m_sink;
+};
+
+/**
+ * @brief Consumer loop run on the drain thread during a restore or verify
+ *
+ * Writes each filled ring slot to @p sink (if any) while the same slot
+ * is hashed on @p hashPool, so neither the disk nor the hash holds up
+ * the tape reads. A slot is only handed back once both are done with
+ * it. On error the ring is aborted and the message is left in @p error;
+ * @p drained counts the bytes that reached the sink.
+ */
+void drainRing(QIODevice *sink, BlockRing &ring, HashCalculator *hasher,
+               QThreadPool *hashPool, QString &error, qint64 &drained)
+{
+    SinkAccess access(sink);
+    for (;;) {
+        BlockSlot *slot = ring.acquireRead();
+        if (!slot) {
+            return;
+        }
+
+        bool last = slot->last;
+        if (slot->length > 0) {
+            TraceSpan span("tapeio", "writeDestination");
+            span.setArg("bytes", slot->length);
+            QFuture<void> hashJob;
+            if (hasher) {
+                hashJob = QtConcurrent::run(hashPool, [hasher, slot]() {
+                    hasher->addData(slot->data, slot->length);
+                });
+            }
+
+            bool written = !sink || TarWriter::writeFully(sink, slot->data, slot->length, error);
+            hashJob.waitForFinished();
+
+            if (!written) {
+                ring.abort();
+                return;
+            }
+            drained += slot->length;
+        }
+
+        ring.releaseRead();
+        if (last) {
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Hashes recorded for a file while it is written
+ *
+ * Feeds the same data to the primary hash and, when configured, to the
+ * fast verify hash, so both come out of the single read of the source.
+ */
+class SourceHasher
+{
+public:
+    explicit SourceHasher(const TransferOptions &options)
+    {
+        if (!options.verifyAfterWrite) {
+            return;
+        }
+        if (options.hashMode != HashMode::None) {
+            m_primary.reset(new HashCalculator(options.hashMode));
+        }
+        if (options.fastHashMode != HashMode::None && options.fastHashMode != options.hashMode) {
+            m_fast.reset(new HashCalculator(options.fastHashMode));
+        }
+    }
+
+    bool isActive() const { return m_primary || m_fast; }
+
+    void addData(const char *data, qint64 length)
+    {
+        if (m_primary) {
+            m_primary->addData(data, length);
+        }
+        if (m_fast) {
+            m_fast->addData(data, length);
+        }
+    }
+
+    void store(TransferItem &item) const
+    {
+        if (m_primary) {
+            HashResult result = m_primary->result();
+            if (result.success) {
+                item.sourceHash = result.hexString;
+            }
+        }
+        if (m_fast) {
+            HashResult result = m_fast->result();
+            if (result.success) {
+                item.fastHash = result.hexString;
+            }
+        }
+    }
+
+private:
+    QScopedPointer<HashCalculator> m_primary;
+    QScopedPointer<HashCalculator> m_fast;
+};
+
+} // namespace
+
 // ============================================================================
 // TransferItem Implementation
 // ============================================================================
@@ -55,6 +385,14 @@ int TransferStats::progressPercent() const
     return static_cast<int>(completedBytes * 100 / totalBytes);
 }
 
+int TransferStats::bufferFillPercent() const
+{
+    if (bufferCapacity <= 0) {
+        return 0;
+    }
+    return bufferFill * 100 / bufferCapacity;
+}
+
 QString TransferStats::speedString() const
 {
     if (bytesPerSecond < 1024) {
@@ -101,524 +439,2243 @@ public:
     TapeDevice *device = nullptr;
     TransferOptions options;
     QSharedPointer<LtfsIndex> index;
+    PathIndex paths;
 
-    QList<TransferItem> queue;
+    TransferQueue queue;
     QMutex queueMutex;
-
-    bool running = false;
-    bool paused = false;
-    bool cancelled = false;
-
+    QWaitCondition queueChanged;    ///< Items appended or scanning finished
+    qint64 scannedBytes = 0;        ///< Bytes queued by scans since the last stats reset
+
+    // Background scanning for scanDirectory(); requests are guarded by queueMutex
+    QScopedPointer<QThread> scanThread;
+    QList<QPair<QString, QString>> scanRequests;
+    std::atomic<bool> scanning{false};
+    std::atomic<bool> scanCancelled{false};
+    DirectoryScanner scanner;
+
+    // Worker thread running processQueue(); control flags are set from
+    // the caller's thread and polled by the worker
+    QScopedPointer<QThread> worker;
+    std::atomic<bool> running{false};
+    std::atomic<bool> paused{false};
+    std::atomic<bool> cancelled{false};
+    QMutex stateMutex;
+    QWaitCondition stateChanged;
+
+    // Owned by the thread doing the transfer; other threads read the
+    // snapshot in publishedStats, or the counters in progress
     TransferStats stats;
+    TransferStats publishedStats;
+    mutable QMutex statsMutex;
+    TransferProgress progress;
+    ThroughputEstimator throughput;
     QElapsedTimer timer;
+    QElapsedTimer progressTimer;
 
-    QString lastError;
-    int currentItemIndex = -1;
+    // Hashes blocks in parallel with the tape write
+    QThreadPool hashPool;
 
-    qint64 calculateQueueSize() const
-    {
-        qint64 total = 0;
-        for (const auto &item : queue) {
-            total += item.size;
-        }
-        return total;
-    }
+    // Aligned block buffers, recycled across files and transfers
+    QScopedPointer<BlockPool> blockPool;
 
-    void resetStats()
-    {
-        stats = TransferStats();
-        stats.totalFiles = queue.size();
-        stats.totalBytes = calculateQueueSize();
-    }
-};
+    // Drive performance samples, taken on the transfer thread
+    QScopedPointer<DriveTelemetry> telemetry;
 
-// ============================================================================
-// TapeIO Implementation
-// ============================================================================
+    // Tag for the next queued tape command
+    quint64 nextTag = 0;
 
-TapeIO::TapeIO(TapeDevice *device, QObject *parent)
-    : QObject(parent)
-    , d(new Private)
-{
-    d->device = device;
-}
+    // Restores: blocks skipped by reading through a gap are dropped here
+    QByteArray gapBuffer;
 
-TapeIO::~TapeIO()
-{
-    cancel();
-    delete d;
-}
+    // Restore pass: tape reads so far, for the read rate and record size
+    qint64 passReadBytes = 0;
+    qint64 passReadNs = 0;
+    quint32 passRecordSize = 0;     ///< Longest record read; every block but a file's last is full
 
-TapeDevice *TapeIO::device() const
-{
-    return d->device;
-}
+    // Restore pass: block the last file ended in, kept for a packed file
+    // that starts in it; the drive is already one block past it
+    QByteArray tailBlock;
+    TapePosition tailPosition;
+    bool tailValid = false;
+    bool headFromTail = false;      ///< Next streamFromTape() starts in tailBlock
 
-TransferOptions TapeIO::options() const
-{
-    return d->options;
-}
+    // Small-file packing: block being filled and files since the last filemark
+    QByteArray packBuffer;
+    quint32 packFill = 0;
+    int packedFiles = 0;
+    bool packing = false;
+    bool packCompressionChosen = false; ///< Adaptive policy already sampled this packed run
 
-void TapeIO::setOptions(const TransferOptions &options)
-{
-    d->options = options;
-}
+    // Resume journal; packed files are journaled once their filemark is written
+    TransferJournal journal;
+    QList<JournalRecord> pendingRecords;
+    IndexCheckpointHandler checkpointHandler;
+    qint64 checkpointBase = 0;      ///< completedBytes at the last index checkpoint
 
-QSharedPointer<LtfsIndex> TapeIO::index() const
-{
-    return d->index;
-}
+    // Compression log counters when the transfer started
+    quint64 compressionHostBase = 0;
+    quint64 compressionTapeBase = 0;
+    QElapsedTimer compressionTimer;
 
-void TapeIO::setIndex(QSharedPointer<LtfsIndex> index)
-{
-    d->index = index;
-}
+    QString lastError;
+    int currentItemIndex = -1;
+    bool autoBlockSize = false;     ///< options.blockSize was 0 and is picked per volume
+    QString resolvedVolume;         ///< Cartridge serial the picked block size belongs to
+    quint32 resolvedBlockSize = 0;
 
-void TapeIO::addFile(const QString &sourcePath, const QString &destPath)
-{
-    QFileInfo info(sourcePath);
-    if (!info.exists()) {
-        qWarning() << "File does not exist:" << sourcePath;
-        return;
+    void resetStats()
+    {
+        stats = TransferStats();
+        stats.totalFiles = queue.size();
+        stats.totalBytes = queue.totalBytes();
+        scannedBytes = 0;
+        tailValid = false;
     }
 
-    TransferItem item;
-    item.sourcePath = info.absoluteFilePath();
-    item.destPath = destPath.isEmpty() ? info.fileName() : destPath;
-    item.relativePath = info.fileName();
-    item.size = info.size();
-    item.modifiedTime = info.lastModified();
-    item.isDirectory = info.isDir();
-    item.status = TransferStatus::Pending;
-
-    QMutexLocker locker(&d->queueMutex);
-    d->queue.append(item);
-}
-
-void TapeIO::addDirectory(const QString &sourceDir, const QString &destDir)
-{
-    QDir dir(sourceDir);
-    if (!dir.exists()) {
-        qWarning() << "Directory does not exist:" << sourceDir;
-        return;
+    /**
+     * @brief Forget what an earlier restore pass measured or kept
+     */
+    void beginRestorePass()
+    {
+        passReadBytes = 0;
+        passReadNs = 0;
+        passRecordSize = 0;
+        tailValid = false;
+        headFromTail = false;
     }
 
-    QString basePath = dir.absolutePath();
-    QString targetDir = destDir.isEmpty() ? dir.dirName() : destDir;
-
-    // Add directory entry itself
-    TransferItem dirItem;
-    dirItem.sourcePath = basePath;
-    dirItem.destPath = targetDir;
-    dirItem.relativePath = targetDir;
-    dirItem.isDirectory = true;
-    dirItem.status = TransferStatus::Pending;
+    void addPassRead(qint64 bytes, qint64 nanoseconds)
+    {
+        passReadBytes += bytes;
+        passReadNs += nanoseconds;
+    }
 
+    double passReadRate() const
     {
-        QMutexLocker locker(&d->queueMutex);
-        d->queue.append(dirItem);
+        if (passReadBytes < MIN_READ_RATE_SAMPLE || passReadNs <= 0) {
+            return DEFAULT_READ_RATE;
+        }
+        return static_cast<double>(passReadBytes) * 1e9 / static_cast<double>(passReadNs);
     }
 
-    // Iterate through all files and subdirectories
-    QDirIterator it(basePath, QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot,
-                    QDirIterator::Subdirectories);
+    /**
+     * @brief Scan a directory tree into the queue
+     */
+    void scanIntoQueue(const QString &sourceDir, const QString &destDir)
+    {
+        QDir dir(sourceDir);
+        if (!dir.exists()) {
+            qWarning() << "Directory does not exist:" << sourceDir;
+            return;
+        }
 
-    while (it.hasNext()) {
-        it.next();
-        QFileInfo info = it.fileInfo();
+        const QString basePath = dir.absolutePath();
+        const QString targetDir = destDir.isEmpty() ? dir.dirName() : destDir;
+
+        // Add directory entry itself
+        TransferItem dirItem;
+        dirItem.sourcePath = basePath;
+        dirItem.destPath = targetDir;
+        dirItem.relativePath = targetDir;
+        dirItem.isDirectory = true;
+        dirItem.status = TransferStatus::Pending;
+
+        {
+            QMutexLocker locker(&queueMutex);
+            queue.append(dirItem);
+            queueChanged.wakeAll();
+        }
 
-        QString relativePath = dir.relativeFilePath(info.absoluteFilePath());
-        QString destPath = targetDir + QLatin1Char('/') + relativePath;
+        const QString destPrefix = targetDir + QLatin1Char('/');
+        QList<TransferItem> items;
+
+        scanner.scan(basePath, [&](QList<ScanEntry> &batch) {
+            // Items are built outside the lock; the queue is locked once per batch
+            items.clear();
+            items.reserve(batch.size());
+            qint64 bytes = 0;
+            for (ScanEntry &entry : batch) {
+                TransferItem item;
+                item.sourcePath = std::move(entry.path);
+                item.destPath = destPrefix + entry.relativePath;
+                item.relativePath = std::move(entry.relativePath);
+                item.size = entry.size;
+                item.modifiedTime = entry.modifiedTime;
+                item.isDirectory = entry.isDirectory;
+                item.status = TransferStatus::Pending;
+                bytes += item.size;
+                items.append(std::move(item));
+            }
 
-        TransferItem item;
-        item.sourcePath = info.absoluteFilePath();
-        item.destPath = destPath;
-        item.relativePath = relativePath;
-        item.size = info.isDir() ? 0 : info.size();
-        item.modifiedTime = info.lastModified();
-        item.isDirectory = info.isDir();
-        item.status = TransferStatus::Pending;
+            QMutexLocker locker(&queueMutex);
+            queue.append(items);
+            scannedBytes += bytes;
+            queueChanged.wakeAll();
+        });
 
-        QMutexLocker locker(&d->queueMutex);
-        d->queue.append(item);
+        for (const QString &path : scanner.errors()) {
+            qWarning() << "Failed to read directory:" << path;
+        }
     }
-}
 
-void TapeIO::addFiles(const QStringList &files, const QString &destDir)
-{
-    for (const QString &file : files) {
-        QString dest = destDir;
-        if (!dest.isEmpty() && !dest.endsWith(QLatin1Char('/'))) {
-            dest += QLatin1Char('/');
+    /**
+     * @brief Body of the background scan thread
+     */
+    void processScanRequests()
+    {
+        for (;;) {
+            QPair<QString, QString> request;
+            {
+                QMutexLocker locker(&queueMutex);
+                if (scanRequests.isEmpty() || scanCancelled) {
+                    scanRequests.clear();
+                    scanning = false;
+                    queueChanged.wakeAll();
+                    return;
+                }
+                request = scanRequests.takeFirst();
+            }
+            scanIntoQueue(request.first, request.second);
         }
-        dest += QFileInfo(file).fileName();
-        addFile(file, dest);
     }
-}
 
-void TapeIO::clearQueue()
-{
-    QMutexLocker locker(&d->queueMutex);
-    d->queue.clear();
-}
+    /**
+     * @brief Get the block pool, recreating it only if the geometry changed
+     * @param blockSize Required block size
+     * @param count Blocks needed at once (ring plus restore buffer)
+     */
+    BlockPool *ensureBlockPool(quint32 blockSize, int count)
+    {
+        if (blockPool && blockPool->inUse() == 0 &&
+            (blockPool->blockSize() != blockSize || blockPool->blockCount() < count)) {
+            blockPool.reset();
+        }
+        if (!blockPool) {
+            blockPool.reset(new BlockPool(blockSize, count));
+        }
+        return blockPool.data();
+    }
 
-int TapeIO::queueCount() const
-{
-    QMutexLocker locker(&d->queueMutex);
-    return d->queue.size();
-}
+    /**
+     * @brief Submit a buffer holding one or more consecutive LTFS blocks
+     *
+     * Full blocks go out in one fixed-mode command; a trailing partial
+     * block is written as its own variable-length block. The buffer
+     * must stay untouched until the returned number of completions has
+     * been reaped from the device.
+     *
+     * @return Number of commands submitted, or -1 on error
+     */
+    int submitCoalesced(const char *data, quint32 length, quint32 blockSize)
+    {
+        TraceSpan span("tapeio", "submitWrite");
+        span.setArg("bytes", length);
+        quint32 fullBlocks = length / blockSize;
+        quint32 tail = length % blockSize;
+        int commands = 0;
+
+        if (fullBlocks > 0) {
+            quint32 fixedSize = fullBlocks > 1 ? blockSize : 0;
+            if (!device->submitWrite(nextTag++, data, fullBlocks * blockSize, fixedSize)) {
+                return -1;
+            }
+            stats.tapeCommands++;
+            commands++;
+        }
 
-qint64 TapeIO::queuedBytes() const
-{
-    QMutexLocker locker(&d->queueMutex);
-    return d->calculateQueueSize();
-}
+        if (tail > 0) {
+            if (!device->submitWrite(nextTag++, data + static_cast<size_t>(fullBlocks) * blockSize, tail)) {
+                return -1;
+            }
+            stats.tapeCommands++;
+            commands++;
+        }
 
-bool TapeIO::startWrite()
-{
-    if (d->running) {
-        d->lastError = QStringLiteral("Transfer already in progress");
-        return false;
+        return commands;
     }
 
-    if (!d->device || !d->device->isOpen()) {
-        d->lastError = QStringLiteral("Device not open");
-        return false;
+    /**
+     * @brief Wait for and discard every outstanding tape command
+     */
+    void discardQueuedCommands()
+    {
+        device->drainQueue();
+        TapeCompletion completion;
+        while (device->pendingCommands() > 0 && device->reapCompletion(completion)) {
+        }
     }
 
-    if (d->queue.isEmpty()) {
-        d->lastError = QStringLiteral("No files in queue");
-        return false;
+    /**
+     * @brief Block while paused
+     * @return false if the transfer was cancelled
+     */
+    bool waitWhilePaused()
+    {
+        QMutexLocker locker(&stateMutex);
+        while (paused && !cancelled) {
+            stateChanged.wait(&stateMutex);
+        }
+        return !cancelled;
     }
 
-    d->running = true;
-    d->paused = false;
-    d->cancelled = false;
-    d->resetStats();
-    d->timer.start();
-
+    /**
+     * @brief Rate limit for per-block progress signals
+     */
+    bool progressDue()
+    {
+        if (progressTimer.isValid() && progressTimer.elapsed() < PROGRESS_INTERVAL_MS) {
+            return false;
+        }
+        progressTimer.restart();
+        return true;
+    }
+
+    void publishStats()
+    {
+        QMutexLocker locker(&statsMutex);
+        publishedStats = stats;
+    }
+
+    /**
+     * @brief Store the counters for pollers; cheap enough for every block
+     */
+    void publishProgress(qint64 fileBytes, qint64 fileSize)
+    {
+        progress.store(stats);
+        progress.setCurrentFile(currentItemIndex, fileBytes, fileSize);
+    }
+
+    /**
+     * @brief Start timing a transfer whose totals are in stats
+     */
+    void startClock()
+    {
+        timer.start();
+        progressTimer.invalidate();
+        throughput.reset();
+        throughput.addSample(0, stats.completedBytes);
+        publishProgress(0, 0);
+    }
+
+    void updatePoolStats()
+    {
+        if (blockPool) {
+            stats.bufferPoolHighWater = qMax(stats.bufferPoolHighWater,
+                                             blockPool->statistics().highWaterMark);
+        }
+    }
+
+    /**
+     * @brief Hash compared by restores and verify passes
+     */
+    HashMode verifyMode() const
+    {
+        return options.verifyHashMode != HashMode::None ? options.verifyHashMode : options.hashMode;
+    }
+
+    /**
+     * @brief Hash recorded for a file in the index for the verify hash mode
+     * @return Hex string, or empty if the file carries no such attribute
+     */
+    QString storedHash(const LtfsFile &file) const
+    {
+        if (verifyMode() == HashMode::None) {
+            return QString();
+        }
+
+        const QString key = HashCalculator::attributeKey(verifyMode());
+        for (const auto &attr : file.extendedAttributes()) {
+            if (attr.key == key) {
+                return attr.value;
+            }
+        }
+        return QString();
+    }
+
+    /**
+     * @brief Journal an item that was written
+     *
+     * @param durable The data is behind a filemark; otherwise the record
+     *                waits for commitPendingRecords(). Pending records are
+     *                kept without a journal too: they are the open packed run.
+     * @return false if the journal failed; journaling stops then
+     */
+    bool journalItem(const TransferItem &item, quint64 startBlock, quint32 byteOffset, qint64 byteCount,
+                     qint64 fileLength, bool durable)
+    {
+        if (durable && !journal.isOpen()) {
+            return true;
+        }
+
+        JournalRecord record;
+        record.kind = item.isDirectory ? JournalRecord::Kind::Directory : JournalRecord::Kind::File;
+        record.sourcePath = item.sourcePath;
+        record.destPath = item.destPath;
+        record.size = item.size;
+        record.modifiedTime = item.modifiedTime;
+        record.sourceOffset = item.sourceOffset;
+        record.sourceLength = item.sourceLength;
+        record.startBlock = startBlock;
+        record.byteOffset = byteOffset;
+        record.byteCount = byteCount;
+        record.fileLength = fileLength;
+        record.sourceHash = item.sourceHash;
+        record.fastHash = item.fastHash;
+
+        if (!durable) {
+            pendingRecords.append(record);
+            return true;
+        }
+        if (!item.isDirectory) {
+            record.endBlock = device->position().blockNumber;
+        }
+        if (!journal.append(record)) {
+            journal.close();
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Journal that a write begins at @p startBlock
+     *
+     * Synced before the first block goes out, so an interrupted write
+     * can be told apart from data appended to the cartridge later.
+     *
+     * @param byteCount Bytes the write puts on tape, or -1 if not known
+     * @return false if the journal failed; journaling stops then
+     */
+    bool journalStart(quint64 startBlock, qint64 byteCount)
+    {
+        if (!journal.isOpen()) {
+            return true;
+        }
+
+        JournalRecord record;
+        record.kind = JournalRecord::Kind::Started;
+        record.startBlock = startBlock;
+        record.byteCount = byteCount;
+        if (byteCount >= 0 && options.blockSize > 0) {
+            // Data blocks plus the filemark behind them
+            const quint64 blocks = (static_cast<quint64>(byteCount) + options.blockSize - 1) / options.blockSize;
+            record.endBlock = startBlock + blocks + 1;
+        }
+        if (!journal.append(record)) {
+            journal.close();
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Journal the packed files now behind a filemark
+     */
+    bool commitPendingRecords()
+    {
+        if (!journal.isOpen() || pendingRecords.isEmpty()) {
+            pendingRecords.clear();
+            return true;
+        }
+
+        const quint64 endBlock = device->position().blockNumber;
+        for (JournalRecord &record : pendingRecords) {
+            record.endBlock = endBlock;
+        }
+        const bool ok = journal.append(pendingRecords);
+        pendingRecords.clear();
+        if (!ok) {
+            journal.close();
+        }
+        return ok;
+    }
+
+    /**
+     * @brief Check if enough data was written since the last index checkpoint
+     */
+    bool checkpointDue() const
+    {
+        return checkpointHandler && options.checkpointBytes > 0 &&
+               stats.completedBytes - checkpointBase >= options.checkpointBytes;
+    }
+
+    /**
+     * @brief Check if a queued file must not be written because of what is on tape
+     *
+     * Applies skipExisting / overwriteExisting by path and skipDuplicates
+     * by content. Only a source whose size matches a file on tape is read
+     * up front, for its cryptographic hash; a duplicate is then indexed
+     * under its own path with the extents of the copy already on tape.
+     *
+     * @return true if the item was skipped or failed (status is set)
+     */
+    bool resolvedWithoutWrite(TransferItem &item)
+    {
+        const PathIndex::Entry *existing = paths.find(item.destPath);
+        if (existing && !existing->directory) {
+            if (options.skipExisting) {
+                item.status = TransferStatus::Skipped;
+                item.errorMessage = QStringLiteral("Already on tape");
+                return true;
+            }
+            if (!options.overwriteExisting) {
+                item.status = TransferStatus::Failed;
+                item.errorMessage = QStringLiteral("File already exists on tape: %1").arg(item.destPath);
+                return true;
+            }
+        }
+
+        // The fast hash is not collision resistant, so it never decides
+        const HashMode mode = options.hashMode;
+        if (!options.skipDuplicates || mode == HashMode::None || item.isStream() || item.isSegment() ||
+            !paths.containsLength(item.size)) {
+            return false;
+        }
+
+        HashResult result = HashCalculator(mode).hashFile(item.sourcePath);
+        if (!result.success) {
+            return false;   // The write reports unreadable sources
+        }
+
+        const QString duplicate = paths.findByHash(HashCalculator::attributeKey(mode), result.hexString);
+        const PathIndex::Entry *copy = duplicate.isEmpty() ? nullptr : paths.find(duplicate);
+        if (!copy || copy->length != item.size || copy->extents.isEmpty()) {
+            return false;
+        }
+
+        const qint64 modifyTime = item.modifiedTime.isValid() ? item.modifiedTime.toMSecsSinceEpoch()
+                                                              : QDateTime::currentMSecsSinceEpoch();
+        if (!paths.addCopy(item.destPath, duplicate, modifyTime)) {
+            return false;
+        }
+
+        item.sourceHash = result.hexString;
+        item.status = TransferStatus::Skipped;
+        item.errorMessage = QStringLiteral("Same content already on tape as %1").arg(duplicate);
+        return true;
+    }
+
+    /**
+     * @brief Fill in the block size when the options leave it to the drive
+     *
+     * A formatted volume keeps the block size its label records: LTFS
+     * readers reject a volume whose records mix sizes, and restores read
+     * fixed-mode with it. Only blank media get the tuned size. The label
+     * is read once per cartridge, told apart by its MAM serial number.
+     */
+    void resolveBlockSize()
+    {
+        if (!autoBlockSize) {
+            return;
+        }
+        options.blockSize = BlockManager::DEFAULT_BLOCK_SIZE;
+        if (!device || !device->isOpen()) {
+            return;
+        }
+
+        const QString serial = device->readVolumeIdentity().serialNumber;
+        if (!serial.isEmpty() && serial == resolvedVolume) {
+            options.blockSize = resolvedBlockSize;
+            return;
+        }
+
+        const LtfsLabel label = device->readLabel();
+        options.blockSize = label.isValid() && label.blockSize > 0
+            ? label.blockSize : BlockSizeTuner(device).recommendedBlockSize();
+        resolvedVolume = serial;
+        resolvedBlockSize = options.blockSize;
+    }
+
+    /**
+     * @brief Bring the drive's logical block protection in line with the options
+     * @return false (with lastError set) if the drive cannot do it
+     */
+    bool applyBlockProtection()
+    {
+        if (device->blockProtectionEnabled() == options.blockProtection) {
+            return true;
+        }
+        if (!device->setBlockProtection(options.blockProtection)) {
+            lastError = device->lastError();
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Apply a fixed compression policy and take the log counter baseline
+     * @return false (with lastError set) if the drive rejects the setting
+     */
+    bool applyCompressionPolicy()
+    {
+        if (options.compressionPolicy == CompressionPolicy::Enabled ||
+            options.compressionPolicy == CompressionPolicy::Disabled) {
+            if (!device->setCompression(options.compressionPolicy == CompressionPolicy::Enabled)) {
+                lastError = device->lastError();
+                return false;
+            }
+        }
+
+        compressionHostBase = 0;
+        compressionTapeBase = 0;
+        if (device->refreshCompressionData()) {
+            compressionHostBase = device->logData().hostBytesWritten;
+            compressionTapeBase = device->logData().tapeBytesWritten;
+        }
+        compressionTimer.start();
+        return true;
+    }
+
+    /**
+     * @brief Switch drive compression for the data starting with @p sample
+     *
+     * Only for the adaptive policy. A failed switch keeps the previous
+     * setting; the data is written either way.
+     */
+    void adaptCompression(const char *sample, qint64 length)
+    {
+        if (options.compressionPolicy != CompressionPolicy::Adaptive) {
+            return;
+        }
+
+        length = qMin<qint64>(length, options.compressionSampleBytes);
+        const bool compress = sampleEntropy(sample, length) < options.compressibleEntropy;
+        const bool wasEnabled = device->compressionEnabled();
+        if (!device->setCompression(compress)) {
+            qWarning() << "Failed to switch compression:" << device->lastError();
+        } else if (compress != wasEnabled) {
+            stats.compressionSwitches++;
+        }
+    }
+
+    /**
+     * @brief Update stats.compressionRatio from the drive's log counters
+     * @param force Read the log page even if the last read was recent
+     */
+    void pollCompressionRatio(bool force)
+    {
+        if (!force && compressionTimer.isValid() && compressionTimer.elapsed() < COMPRESSION_POLL_MS) {
+            return;
+        }
+        compressionTimer.restart();
+
+        if (!device->refreshCompressionData()) {
+            return;
+        }
+
+        const TapeLogData log = device->logData();
+        if (log.hostBytesWritten < compressionHostBase || log.tapeBytesWritten < compressionTapeBase) {
+            // Counters were reset (e.g. the drive was reloaded)
+            compressionHostBase = 0;
+            compressionTapeBase = 0;
+        }
+        const quint64 host = log.hostBytesWritten - compressionHostBase;
+        const quint64 tape = log.tapeBytesWritten - compressionTapeBase;
+        if (host > 0 && tape > 0) {
+            stats.compressionRatio = static_cast<double>(host) / static_cast<double>(tape);
+        }
+    }
+};
+
+// ============================================================================
+// TapeIO Implementation
+// ============================================================================
+
+TapeIO::TapeIO(TapeDevice *device, QObject *parent)
+    : QObject(parent)
+    , d(new Private)
+{
+    d->device = device;
+    d->hashPool.setMaxThreadCount(1);
+    d->telemetry.reset(new DriveTelemetry(device));
+}
+
+TapeIO::~TapeIO()
+{
+    cancelScan();
+    cancel();
+    if (d->scanThread) {
+        d->scanThread->wait();
+    }
+    if (d->worker) {
+        d->worker->wait();
+    }
+    delete d;
+}
+
+TapeDevice *TapeIO::device() const
+{
+    return d->device;
+}
+
+DriveTelemetry *TapeIO::telemetry() const
+{
+    return d->telemetry.data();
+}
+
+TransferOptions TapeIO::options() const
+{
+    return d->options;
+}
+
+void TapeIO::setOptions(const TransferOptions &options)
+{
+    if (d->running) {
+        qWarning() << "TapeIO: options cannot be changed during a transfer";
+        return;
+    }
+    d->options = options;
+    d->autoBlockSize = options.blockSize == 0;
+    d->resolveBlockSize();
+}
+
+QSharedPointer<LtfsIndex> TapeIO::index() const
+{
+    return d->index;
+}
+
+void TapeIO::setIndex(QSharedPointer<LtfsIndex> index)
+{
+    d->index = index;
+    if (d->index) {
+        d->paths.build(*d->index);
+    } else {
+        d->paths.clear();
+    }
+}
+
+const PathIndex &TapeIO::pathIndex() const
+{
+    return d->paths;
+}
+
+void TapeIO::addFile(const QString &sourcePath, const QString &destPath)
+{
+    QFileInfo info(sourcePath);
+    if (!info.exists()) {
+        qWarning() << "File does not exist:" << sourcePath;
+        return;
+    }
+
+    TransferItem item;
+    item.sourcePath = info.absoluteFilePath();
+    item.destPath = destPath.isEmpty() ? info.fileName() : destPath;
+    item.relativePath = info.fileName();
+    item.size = info.size();
+    item.modifiedTime = info.lastModified();
+    item.isDirectory = info.isDir();
+    item.status = TransferStatus::Pending;
+
+    QMutexLocker locker(&d->queueMutex);
+    d->queue.append(item);
+}
+
+void TapeIO::addStream(QIODevice *device, const QString &destPath, const QDateTime &modifiedTime)
+{
+    if (!device || !device->isReadable() || device->parent()) {
+        qWarning() << "Stream is not readable or has a parent:" << destPath;
+        return;
+    }
+
+    // The worker's reader thread pulls it over when the item comes up
+    device->moveToThread(nullptr);
+
+    TransferItem item;
+    item.sourcePath = QFileInfo(destPath).fileName();
+    item.destPath = destPath;
+    item.relativePath = item.sourcePath;
+    item.modifiedTime = modifiedTime.isValid() ? modifiedTime : QDateTime::currentDateTime();
+    item.stream.reset(device);
+    item.status = TransferStatus::Pending;
+
+    QMutexLocker locker(&d->queueMutex);
+    d->queue.append(item);
+}
+
+void TapeIO::addDirectory(const QString &sourceDir, const QString &destDir)
+{
+    // Run behind any background scans so the queue keeps the call order
+    waitForScan();
+    d->scanIntoQueue(sourceDir, destDir);
+}
+
+void TapeIO::scanDirectory(const QString &sourceDir, const QString &destDir)
+{
+    QMutexLocker locker(&d->queueMutex);
+    d->scanRequests.append(qMakePair(sourceDir, destDir));
+    if (d->scanning) {
+        return;     // Picked up by the running scan thread
+    }
+
+    if (d->scanThread) {
+        d->scanThread->wait();
+    }
+    d->scanning = true;
+    d->scanCancelled = false;
+    d->scanThread.reset(QThread::create([this]() { d->processScanRequests(); }));
+    d->scanThread->start();
+}
+
+bool TapeIO::isScanning() const
+{
+    return d->scanning;
+}
+
+void TapeIO::cancelScan()
+{
+    d->scanCancelled = true;
+    d->scanner.cancel();
+}
+
+bool TapeIO::waitForScan(int timeoutMs)
+{
+    QDeadlineTimer deadline(timeoutMs < 0 ? QDeadlineTimer::Forever : QDeadlineTimer(timeoutMs));
+
+    QMutexLocker locker(&d->queueMutex);
+    while (d->scanning) {
+        if (!d->queueChanged.wait(&d->queueMutex, deadline)) {
+            return !d->scanning;
+        }
+    }
+    return true;
+}
+
+void TapeIO::addFiles(const QStringList &files, const QString &destDir)
+{
+    for (const QString &file : files) {
+        QString dest = destDir;
+        if (!dest.isEmpty() && !dest.endsWith(QLatin1Char('/'))) {
+            dest += QLatin1Char('/');
+        }
+        dest += QFileInfo(file).fileName();
+        addFile(file, dest);
+    }
+}
+
+void TapeIO::addItems(const QList<TransferItem> &items)
+{
+    QMutexLocker locker(&d->queueMutex);
+    d->queue.append(items);
+}
+
+void TapeIO::clearQueue()
+{
+    QMutexLocker locker(&d->queueMutex);
+    d->queue.clear();
+}
+
+int TapeIO::queueCount() const
+{
+    QMutexLocker locker(&d->queueMutex);
+    return d->queue.size();
+}
+
+qint64 TapeIO::queuedBytes() const
+{
+    QMutexLocker locker(&d->queueMutex);
+    return d->queue.totalBytes();
+}
+
+bool TapeIO::startWrite()
+{
+    if (d->running) {
+        d->lastError = QStringLiteral("Transfer already in progress");
+        return false;
+    }
+
+    if (!d->device || !d->device->isOpen()) {
+        d->lastError = QStringLiteral("Device not open");
+        return false;
+    }
+
+    {
+        QMutexLocker locker(&d->queueMutex);
+        if (d->queue.isEmpty() && !d->scanning) {
+            d->lastError = QStringLiteral("No files in queue");
+            return false;
+        }
+        d->resetStats();
+    }
+
+    // The cartridge may have changed since setOptions()
+    d->resolveBlockSize();
+
+    if (!d->applyBlockProtection() || !d->applyCompressionPolicy()) {
+        return false;
+    }
+
+    if (!d->options.journalPath.isEmpty() && !openJournal()) {
+        return false;
+    }
+
+    d->telemetry->setInterval(d->options.telemetryInterval);
+    d->telemetry->reset();
+
+    // Reap the worker of the previous transfer
+    if (d->worker) {
+        d->worker->wait();
+    }
+
+    {
+        QMutexLocker locker(&d->stateMutex);
+        d->running = true;
+        d->paused = false;
+        d->cancelled = false;
+    }
+    d->publishStats();
+    d->startClock();
+
     emit runningChanged(true);
     emit transferStarted(TransferType::Write, static_cast<int>(d->stats.totalFiles), d->stats.totalBytes);
 
-    processQueue();
+    d->worker.reset(QThread::create([this]() { processQueue(); }));
+    d->worker->setObjectName(QStringLiteral("TapeIO worker"));
+    d->worker->start();
+
+    return true;
+}
+
+void TapeIO::setCheckpointHandler(IndexCheckpointHandler handler)
+{
+    d->checkpointHandler = std::move(handler);
+}
+
+bool TapeIO::removeJournal()
+{
+    if (d->running) {
+        d->lastError = QStringLiteral("Transfer in progress");
+        return false;
+    }
+
+    d->journal.close();
+    if (!TransferJournal::remove(d->options.journalPath)) {
+        d->lastError = QStringLiteral("Cannot delete journal %1").arg(d->options.journalPath);
+        return false;
+    }
+    return true;
+}
+
+bool TapeIO::readFile(const LtfsFile &tapeFile, const QString &destPath)
+{
+    if (d->running) {
+        d->lastError = QStringLiteral("Transfer already in progress");
+        return false;
+    }
+
+    if (!d->device || !d->device->isOpen()) {
+        d->lastError = QStringLiteral("Device not open");
+        return false;
+    }
+
+    TransferItem item;
+    item.sourcePath = tapeFile.name();  // Name on tape
+    item.destPath = destPath;
+    item.size = tapeFile.length();
+    item.sourceHash = d->storedHash(tapeFile);
+    item.status = TransferStatus::InProgress;
+
+    emit fileStarted(item);
+
+    bool success = locateFile(tapeFile, item) && readFileFromTape(item);
+
+    if (success) {
+        item.status = TransferStatus::Completed;
+        emit fileCompleted(item);
+    } else {
+        item.status = TransferStatus::Failed;
+        emit fileError(item, item.errorMessage);
+    }
+
+    return success;
+}
+
+bool TapeIO::readDirectory(const LtfsDirectory &tapeDir, const QString &destPath)
+{
+    // Create the tree first, then read all files in tape order
+    QList<LtfsFile> files;
+    QStringList destPaths;
+    bool allSuccess = collectDirectory(tapeDir, destPath, files, destPaths);
+    if (!allSuccess && !d->options.continueOnError) {
+        return false;
+    }
+
+    for (int index : scheduleRestore(files)) {
+        if (!readFile(files[index], destPaths[index])) {
+            allSuccess = false;
+            if (!d->options.continueOnError) {
+                return false;
+            }
+        }
+    }
+
+    return allSuccess;
+}
+
+bool TapeIO::collectDirectory(const LtfsDirectory &tapeDir, const QString &destPath,
+                              QList<LtfsFile> &files, QStringList &destPaths)
+{
+    // Create directory
+    QDir dir;
+    if (!dir.mkpath(destPath)) {
+        d->lastError = QStringLiteral("Failed to create directory: %1").arg(destPath);
+        return false;
+    }
+
+    for (const auto &file : tapeDir.files()) {
+        files.append(file);
+        destPaths.append(destPath + QLatin1Char('/') + file.name());
+    }
+
+    // Recurse into subdirectories
+    bool allSuccess = true;
+    for (const auto &subdir : tapeDir.subdirectories()) {
+        QString subdirDest = destPath + QLatin1Char('/') + subdir.name();
+        if (!collectDirectory(subdir, subdirDest, files, destPaths)) {
+            allSuccess = false;
+            if (!d->options.continueOnError) {
+                return false;
+            }
+        }
+    }
+
+    return allSuccess;
+}
+
+bool TapeIO::readFiles(const QList<LtfsFile> &files, const QString &destDir)
+{
+    QDir dir;
+    if (!dir.mkpath(destDir)) {
+        d->lastError = QStringLiteral("Failed to create destination directory");
+        return false;
+    }
+
+    bool allSuccess = true;
+    for (int index : scheduleRestore(files)) {
+        const LtfsFile &file = files[index];
+        QString destPath = destDir + QLatin1Char('/') + file.name();
+        if (!readFile(file, destPath)) {
+            allSuccess = false;
+            if (!d->options.continueOnError) {
+                break;
+            }
+        }
+    }
+
+    return allSuccess;
+}
+
+bool TapeIO::exportFiles(const QList<LtfsFile> &files, const QStringList &paths, QIODevice *sink)
+{
+    if (!canExport(sink)) {
+        return false;
+    }
+    if (paths.size() != files.size()) {
+        d->lastError = QStringLiteral("Archive paths do not match the files");
+        return false;
+    }
+
+    TarWriter tar(sink);
+    return exportToTar(tar, files, paths, sink);
+}
+
+bool TapeIO::exportDirectory(const LtfsDirectory &tapeDir, QIODevice *sink)
+{
+    if (!canExport(sink)) {
+        return false;
+    }
+
+    // Directory entries lead the archive, so extraction can create the
+    // tree before the files arrive in tape order
+    TarWriter tar(sink);
+    QList<LtfsFile> files;
+    QStringList paths;
+    bool written;
+    {
+        SinkAccess access(sink);
+        written = collectArchive(tapeDir, tapeDir.name(), tar, files, paths);
+    }
+    if (!written) {
+        d->lastError = QStringLiteral("Archive write failed: %1").arg(tar.lastError());
+        sink->moveToThread(QThread::currentThread());
+        return false;
+    }
+
+    return exportToTar(tar, files, paths, sink);
+}
+
+bool TapeIO::canExport(QIODevice *sink)
+{
+    if (d->running) {
+        d->lastError = QStringLiteral("Transfer already in progress");
+        return false;
+    }
+    if (!d->device || !d->device->isOpen()) {
+        d->lastError = QStringLiteral("Device not open");
+        return false;
+    }
+    if (!sink || !sink->isWritable() || sink->parent() || sink->thread() != QThread::currentThread()) {
+        d->lastError = QStringLiteral("Archive sink is not writable, has a parent or belongs to another thread");
+        return false;
+    }
+
+    // Pulled over by whichever thread writes next
+    sink->moveToThread(nullptr);
+    return true;
+}
+
+bool TapeIO::collectArchive(const LtfsDirectory &tapeDir, const QString &archivePath, TarWriter &tar,
+                            QList<LtfsFile> &files, QStringList &paths)
+{
+    if (!tar.addDirectory(archivePath, tapeDir.modifyTime())) {
+        return false;
+    }
+
+    for (const auto &file : tapeDir.files()) {
+        files.append(file);
+        paths.append(archivePath + QLatin1Char('/') + file.name());
+    }
+
+    for (const auto &subdir : tapeDir.subdirectories()) {
+        if (!collectArchive(subdir, archivePath + QLatin1Char('/') + subdir.name(), tar, files, paths)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool TapeIO::exportToTar(TarWriter &tar, const QList<LtfsFile> &files, const QStringList &paths,
+                         QIODevice *sink)
+{
+    TraceSpan span("tapeio", "exportTar");
+    span.setArg("files", files.size());
+
+    bool allSuccess = true;
+    bool sinkFailed = false;
+    QString sinkError;
+    for (int index : scheduleRestore(files)) {
+        const LtfsFile &file = files[index];
+
+        TransferItem item;
+        item.sourcePath = file.name();  // Name on tape
+        item.destPath = paths[index];
+        item.size = file.length();
+        item.sourceHash = d->storedHash(file);
+        item.status = TransferStatus::InProgress;
+
+        emit fileStarted(item);
+
+        bool begun;
+        {
+            SinkAccess access(sink);
+            begun = tar.beginFile(item.destPath, item.size, file.modifyTime(), file.readonly());
+        }
+        if (!begun) {
+            sinkFailed = true;
+            sinkError = tar.lastError();
+            break;
+        }
+
+        QScopedPointer<HashCalculator> hasher;
+        if (d->options.verifyAfterWrite && !item.sourceHash.isEmpty() &&
+            d->verifyMode() != HashMode::None) {
+            hasher.reset(new HashCalculator(d->verifyMode()));
+        }
+
+        bool success = locateFile(file, item) && streamFromTape(item, sink, hasher.data(), &sinkFailed);
+
+        // A file cut short by the tape is padded out so the archive stays
+        // readable; its failure is reported through fileError(). When the
+        // sink itself failed the stream position is unknown, so stop there.
+        if (sinkFailed) {
+            sinkError = item.errorMessage;
+        } else {
+            SinkAccess access(sink);
+            sinkFailed = !tar.endFile(success ? item.size : item.bytesTransferred);
+            sinkError = tar.lastError();
+        }
+
+        if (success && hasher) {
+            success = checkHash(item, *hasher);
+        }
+
+        if (success) {
+            item.status = TransferStatus::Completed;
+            emit fileCompleted(item);
+        } else {
+            allSuccess = false;
+            if (item.status != TransferStatus::Cancelled) {
+                item.status = TransferStatus::Failed;
+            }
+            emit fileError(item, item.errorMessage);
+        }
+
+        // A sink that stopped taking data ends the archive for every file
+        if (sinkFailed || item.status == TransferStatus::Cancelled ||
+            (!success && !d->options.continueOnError)) {
+            break;
+        }
+    }
+
+    if (!sinkFailed) {
+        SinkAccess access(sink);
+        sinkFailed = !tar.finish();
+        sinkError = tar.lastError();
+    }
+    sink->moveToThread(QThread::currentThread());
+
+    if (sinkFailed) {
+        d->lastError = QStringLiteral("Archive write failed: %1").arg(sinkError);
+        return false;
+    }
+    return allSuccess;
+}
+
+QList<int> TapeIO::scheduleRestore(const QList<LtfsFile> &files)
+{
+    // Each tape-ordered pass measures the drive afresh
+    d->beginRestorePass();
+
+    QList<int> order;
+    order.reserve(files.size());
+    for (int i = 0; i < files.size(); ++i) {
+        order.append(i);
+    }
+
+    // Sort key: partition and start block of the first extent; files
+    // without extents go last in their original order
+    struct Location {
+        bool onTape = false;
+        quint8 partition = 0;
+        quint64 firstBlock = 0;
+        quint64 lastBlock = 0;
+    };
+
+    quint32 blockSize = qMax<quint32>(1, d->options.blockSize);
+    QVector<Location> locations(files.size());
+    for (int i = 0; i < files.size(); ++i) {
+        const QList<LtfsExtent> extents = files[i].extentInfo();
+        if (extents.isEmpty()) {
+            continue;
+        }
+        const LtfsExtent &first = extents.first();
+        const LtfsExtent &last = extents.last();
+        Location &loc = locations[i];
+        loc.onTape = true;
+        loc.partition = static_cast<quint8>(first.partition());
+        loc.firstBlock = first.startBlock();
+        quint64 lastBytes = static_cast<quint64>(last.byteOffset()) + static_cast<quint64>(last.byteCount());
+        loc.lastBlock = last.startBlock() + (lastBytes > 0 ? (lastBytes - 1) / blockSize : 0);
+    }
+
+    std::stable_sort(order.begin(), order.end(), [&locations](int a, int b) {
+        const Location &la = locations[a];
+        const Location &lb = locations[b];
+        if (la.onTape != lb.onTape) {
+            return la.onTape;
+        }
+        if (la.partition != lb.partition) {
+            return la.partition < lb.partition;
+        }
+        return la.firstBlock < lb.firstBlock;
+    });
+
+    if (!d->options.useRecommendedAccessOrder || !d->device || !d->device->isOpen()) {
+        return order;
+    }
+
+    // Refine each chunk of located files with the drive's own order
+    int located = 0;
+    while (located < order.size() && locations[order[located]].onTape) {
+        ++located;
+    }
+
+    const int chunkSize = TapeDevice::maxAccessOrderSegments();
+    for (int start = 0; start < located; start += chunkSize) {
+        int count = qMin(chunkSize, located - start);
+
+        QList<TapeSegment> segments;
+        segments.reserve(count);
+        for (int i = 0; i < count; ++i) {
+            const Location &loc = locations[order[start + i]];
+            TapeSegment segment;
+            segment.partition = loc.partition;
+            segment.firstBlock = loc.firstBlock;
+            segment.lastBlock = loc.lastBlock;
+            segments.append(segment);
+        }
+
+        QList<int> recommended = d->device->recommendedAccessOrder(segments);
+        if (recommended.isEmpty()) {
+            // Not supported or refused; keep the block order
+            break;
+        }
+
+        QList<int> chunk = order.mid(start, count);
+        for (int i = 0; i < count; ++i) {
+            order[start + i] = chunk[recommended[i]];
+        }
+    }
+
+    return order;
+}
+
+bool TapeIO::verifyFile(const LtfsFile &tapeFile, const QString &localPath)
+{
+    if (d->running) {
+        d->lastError = QStringLiteral("Transfer already in progress");
+        return false;
+    }
+
+    if (!d->device || !d->device->isOpen()) {
+        d->lastError = QStringLiteral("Device not open");
+        return false;
+    }
+
+    if (d->verifyMode() == HashMode::None) {
+        d->lastError = QStringLiteral("No hash mode selected for verification");
+        return false;
+    }
+
+    TransferItem item;
+    item.sourcePath = tapeFile.name();
+    item.destPath = localPath;
+    item.size = tapeFile.length();
+    item.sourceHash = d->storedHash(tapeFile);
+    item.status = TransferStatus::InProgress;
+
+    // Without a recorded hash the local copy is the reference
+    if (item.sourceHash.isEmpty() && !localPath.isEmpty()) {
+        HashResult reference = HashCalculator(d->verifyMode()).hashFile(localPath);
+        if (!reference.success) {
+            d->lastError = QStringLiteral("Failed to hash local file: %1").arg(reference.errorMessage);
+            return false;
+        }
+        item.sourceHash = reference.hexString;
+    }
+
+    if (item.sourceHash.isEmpty()) {
+        d->lastError = QStringLiteral("No %1 hash recorded for %2")
+            .arg(HashCalculator::modeToString(d->verifyMode()), tapeFile.name());
+        return false;
+    }
+
+    emit fileStarted(item);
+
+    bool success = locateFile(tapeFile, item) && verifyFileOnTape(item);
+
+    if (success) {
+        emit fileCompleted(item);
+    } else {
+        item.status = TransferStatus::Failed;
+        d->lastError = item.errorMessage;
+        emit fileError(item, item.errorMessage);
+    }
+
+    return success;
+}
+
+bool TapeIO::verifyFiles(const QList<LtfsFile> &files)
+{
+    if (d->running) {
+        d->lastError = QStringLiteral("Transfer already in progress");
+        return false;
+    }
+
+    if (!d->device || !d->device->isOpen()) {
+        d->lastError = QStringLiteral("Device not open");
+        return false;
+    }
+
+    if (d->verifyMode() == HashMode::None) {
+        d->lastError = QStringLiteral("No hash mode selected for verification");
+        return false;
+    }
+
+    d->cancelled = false;
+    d->stats = TransferStats();
+    d->stats.totalFiles = files.size();
+    for (const auto &file : files) {
+        d->stats.totalBytes += file.length();
+    }
+    d->startClock();
+
+    // One sweep in tape order; consecutive files need no locate because
+    // the cached position already matches the next extent
+    bool allSuccess = true;
+    for (int index : scheduleRestore(files)) {
+        const LtfsFile &file = files[index];
+
+        TransferItem item;
+        item.sourcePath = file.name();
+        item.size = file.length();
+        item.sourceHash = d->storedHash(file);
+        item.status = TransferStatus::InProgress;
+
+        if (item.sourceHash.isEmpty()) {
+            // Nothing to compare against
+            item.status = TransferStatus::Skipped;
+            d->stats.skippedFiles++;
+            continue;
+        }
+
+        emit fileStarted(item);
+
+        if (locateFile(file, item) && verifyFileOnTape(item)) {
+            d->stats.completedFiles++;
+            emit fileCompleted(item);
+        } else if (item.status == TransferStatus::Cancelled) {
+            d->lastError = QStringLiteral("Verification cancelled");
+            allSuccess = false;
+            break;
+        } else {
+            item.status = TransferStatus::Failed;
+            d->stats.failedFiles++;
+            d->lastError = item.errorMessage;
+            emit fileError(item, item.errorMessage);
+            allSuccess = false;
+            if (!d->options.continueOnError) {
+                break;
+            }
+        }
+    }
+
+    updateStatistics();
+    return allSuccess;
+}
+
+bool TapeIO::verifyIndex()
+{
+    if (!d->index) {
+        d->lastError = QStringLiteral("No index loaded");
+        return false;
+    }
+
+    QList<LtfsFile> files;
+    collectFiles(d->index->rootDirectory(), files);
+    return verifyFiles(files);
+}
+
+void TapeIO::collectFiles(const LtfsDirectory &tapeDir, QList<LtfsFile> &files) const
+{
+    for (const auto &file : tapeDir.files()) {
+        files.append(file);
+    }
+    for (const auto &subdir : tapeDir.subdirectories()) {
+        collectFiles(subdir, files);
+    }
+}
+
+bool TapeIO::locateFile(const LtfsFile &tapeFile, TransferItem &item)
+{
+    QLTFS_TRACE_SPAN("tapeio", "locateFile");
+
+    // Position at the first extent; free when the previous file of a
+    // tape-ordered pass ended right there
+    d->headFromTail = false;
+    const QList<LtfsExtent> extents = tapeFile.extentInfo();
+    if (extents.isEmpty()) {
+        return true;
+    }
+
+    const LtfsExtent &first = extents.first();
+    item.tapeByteOffset = static_cast<quint32>(first.byteOffset());
+
+    const TapePosition here = d->device->position();
+    const quint8 partition = static_cast<quint8>(first.partition());
+    const bool samePartition = d->device->isPositionKnown() && here.partition == partition;
+
+    // A packed file that starts in the block the previous file ended in
+    // is read from the copy of that block, not by locating back to it
+    if (samePartition && d->tailValid && d->tailPosition.partition == partition &&
+        d->tailPosition.blockNumber == first.startBlock() && here.blockNumber == first.startBlock() + 1 &&
+        static_cast<qint64>(first.byteOffset()) < d->tailBlock.size() &&
+        static_cast<quint32>(d->tailBlock.size()) <= d->options.blockSize) {
+        d->headFromTail = true;
+        d->stats.locatesAvoided++;
+        return true;
+    }
+
+    // A file a short way ahead is reached by reading on, so the drive
+    // keeps streaming instead of stopping for a locate. The gap is the
+    // blocks up to the extent at the record size this pass has read.
+    const quint32 recordSize = d->passRecordSize > 0 ? d->passRecordSize : d->options.blockSize;
+    if (recordSize > 0 && samePartition && first.startBlock() > here.blockNumber) {
+        const double gapBytes = static_cast<double>(first.startBlock() - here.blockNumber) * recordSize;
+        if (gapBytes <= static_cast<double>(d->options.maxReadThroughBytes) &&
+            gapBytes / d->passReadRate() < LOCATE_SECONDS) {
+            QLTFS_TRACE_SPAN("tapeio", "readThrough");
+            const quint32 bufferSize = qMax(recordSize, d->options.blockSize);
+            d->gapBuffer.resize(static_cast<int>(bufferSize));
+            QElapsedTimer gapTimer;
+            gapTimer.start();
+            const qint64 discarded = d->device->readThrough(first.startBlock(), d->gapBuffer.data(), bufferSize);
+            if (discarded >= 0) {
+                d->addPassRead(discarded, gapTimer.nsecsElapsed());
+                d->stats.locatesAvoided++;
+                d->stats.gapBytesDiscarded += discarded;
+                return true;
+            }
+            // Position is unknown now; the locate below recovers
+        }
+    }
 
+    if (!d->device->locate(partition, first.startBlock())) {
+        item.errorMessage = QStringLiteral("Failed to locate file: %1").arg(d->device->lastError());
+        item.status = TransferStatus::Failed;
+        return false;
+    }
     return true;
 }
 
-bool TapeIO::readFile(const LtfsFile &tapeFile, const QString &destPath)
+HashResult TapeIO::calculateHash(const QString &filePath)
 {
-    if (!d->device || !d->device->isOpen()) {
-        d->lastError = QStringLiteral("Device not open");
-        return false;
+    HashCalculator calc(d->options.hashMode);
+    return calc.hashFile(filePath);
+}
+
+bool TapeIO::isRunning() const
+{
+    return d->running;
+}
+
+bool TapeIO::isPaused() const
+{
+    return d->paused;
+}
+
+void TapeIO::pause()
+{
+    if (d->running && !d->paused) {
+        d->paused = true;
+        emit pausedChanged(true);
     }
+}
 
-    TransferItem item;
-    item.sourcePath = tapeFile.name();  // Name on tape
-    item.destPath = destPath;
-    item.size = tapeFile.length();
-    item.status = TransferStatus::InProgress;
+void TapeIO::resume()
+{
+    if (d->running && d->paused) {
+        {
+            QMutexLocker locker(&d->stateMutex);
+            d->paused = false;
+            d->stateChanged.wakeAll();
+        }
+        emit pausedChanged(false);
+    }
+}
 
-    emit fileStarted(item);
+void TapeIO::cancel()
+{
+    QMutexLocker locker(&d->stateMutex);
+    d->cancelled = true;
+    d->paused = false;
+    d->stateChanged.wakeAll();
+}
 
-    bool success = readFileFromTape(item);
+bool TapeIO::waitForCompletion(int timeoutMs)
+{
+    QDeadlineTimer deadline(timeoutMs < 0 ? QDeadlineTimer::Forever : QDeadlineTimer(timeoutMs));
 
-    if (success) {
-        item.status = TransferStatus::Completed;
-        emit fileCompleted(item);
-    } else {
-        item.status = TransferStatus::Failed;
-        emit fileError(item, item.errorMessage);
+    QMutexLocker locker(&d->stateMutex);
+    while (d->running) {
+        if (!d->stateChanged.wait(&d->stateMutex, deadline)) {
+            return !d->running;
+        }
     }
 
-    return success;
+    return true;
 }
 
-bool TapeIO::readDirectory(const LtfsDirectory &tapeDir, const QString &destPath)
+TransferStats TapeIO::statistics() const
 {
-    // Create directory
-    QDir dir;
-    if (!dir.mkpath(destPath)) {
-        d->lastError = QStringLiteral("Failed to create directory: %1").arg(destPath);
+    QMutexLocker locker(&d->statsMutex);
+    return d->publishedStats;
+}
+
+const TransferProgress &TapeIO::progress() const
+{
+    return d->progress;
+}
+
+QList<TransferItem> TapeIO::items() const
+{
+    QMutexLocker locker(&d->queueMutex);
+    return d->queue.items();
+}
+
+QList<TransferItem> TapeIO::items(int first, int count) const
+{
+    QMutexLocker locker(&d->queueMutex);
+    return d->queue.items(first, count);
+}
+
+TransferItem TapeIO::item(int index) const
+{
+    QMutexLocker locker(&d->queueMutex);
+    if (index < 0 || index >= d->queue.size()) {
+        return TransferItem();
+    }
+    return d->queue.at(index);
+}
+
+QList<TransferItem> TapeIO::failedItems() const
+{
+    QMutexLocker locker(&d->queueMutex);
+    return d->queue.items(TransferStatus::Failed);
+}
+
+QList<TransferItem> TapeIO::failedItems(int first, int count) const
+{
+    QMutexLocker locker(&d->queueMutex);
+    return d->queue.items(TransferStatus::Failed, first, count);
+}
+
+int TapeIO::itemCount(TransferStatus status) const
+{
+    QMutexLocker locker(&d->queueMutex);
+    return d->queue.count(status);
+}
+
+QString TapeIO::lastError() const
+{
+    return d->lastError;
+}
+
+bool TapeIO::writeFileToTape(TransferItem &item)
+{
+    TraceSpan span("tapeio", "writeFile");
+    span.setArg("bytes", item.size);
+
+    if (item.isDirectory) {
+        // Directories are just metadata entries in the index
+        d->paths.addDirectory(item.destPath);
+        item.status = TransferStatus::Completed;
+        if (!d->journalItem(item, 0, 0, 0, -1, true)) {
+            emit errorOccurred(d->journal.lastError());
+        }
+        return true;
+    }
+
+    const bool streamed = item.isStream();
+    QFile file(item.sourcePath);
+    if (!streamed && !file.open(QIODevice::ReadOnly)) {
+        item.errorMessage = QStringLiteral("Failed to open source file: %1").arg(file.errorString());
+        item.status = TransferStatus::Failed;
         return false;
     }
 
-    // Read all files in directory
-    for (const auto &file : tapeDir.files()) {
-        QString fileDest = destPath + QLatin1Char('/') + file.name();
-        if (!readFile(file, fileDest)) {
-            if (!d->options.continueOnError) {
+    // Unbuffered reads keep archive data out of the page cache
+    SourceReader source;
+    const bool unbuffered = !streamed && d->options.sourceReadMode != SourceReadMode::Buffered;
+    if (unbuffered && !source.open(item.sourcePath, d->options.sourceReadMode, d->options.sourceReadDepth)) {
+        item.errorMessage = source.errorString();
+        item.status = TransferStatus::Failed;
+        return false;
+    }
+
+    // A spanned segment starts at a block boundary inside the source
+    if (item.sourceOffset > 0 && !unbuffered && !file.seek(item.sourceOffset)) {
+        item.errorMessage = QStringLiteral("Failed to seek source file: %1").arg(file.errorString());
+        item.status = TransferStatus::Failed;
+        return false;
+    }
+
+    // Seek to end of data partition; no command is issued when the
+    // previous file already left the head there
+    if (!d->device->seekToEnd(1)) {
+        item.errorMessage = QStringLiteral("Failed to seek to end of data");
+        item.status = TransferStatus::Failed;
+        return false;
+    }
+
+    // Record starting position for extent info
+    TapePosition startPos = d->device->position();
+
+    // Write file data in blocks. A reader thread keeps the ring filled
+    // so the drive never waits on the source disk between blocks.
+    // With bulk transfers each slot carries several blocks that go out
+    // in a single fixed-mode command. With a command queue, several
+    // slots are in flight at the drive while the next one is submitted.
+    quint32 blockSize = d->options.blockSize;
+    quint32 blocksPerCommand = d->device->maxBlocksPerCommand(blockSize, d->options.blocksPerCommand);
+    quint32 slotSize = blockSize * blocksPerCommand;
+    // A stream's length is only known once it ends (0 until then)
+    qint64 fileSize = streamed ? 0
+        : item.sourceLength >= 0 ? qMin(item.sourceLength, qMax<qint64>(0, file.size() - item.sourceOffset))
+        : file.size() - item.sourceOffset;
+    int ringSize = qMax(2, BlockManager(blockSize).recommendedBufferCount() / static_cast<int>(blocksPerCommand));
+    BlockRing ring(d->ensureBlockPool(slotSize, ringSize + 1), ringSize);
+    d->stats.bufferCapacity = ring.capacity();
+
+    if (!d->journalStart(startPos.blockNumber, streamed ? -1 : fileSize)) {
+        emit errorOccurred(d->journal.lastError());
+    }
+
+    if (ring.capacity() == 0) {
+        item.errorMessage = QStringLiteral("Failed to allocate transfer buffers");
+        item.status = TransferStatus::Failed;
+        return false;
+    }
+
+    QString readError;
+    QScopedPointer<QThread> reader(streamed
+        ? QThread::create(fillRingFromStream, std::ref(*item.stream), std::ref(ring), std::ref(readError))
+        : unbuffered
+        ? QThread::create([&source, &ring, &readError, offset = item.sourceOffset, fileSize]() {
+              source.fillRing(offset, fileSize, ring, readError);
+          })
+        : QThread::create(fillRingFromFile, std::ref(file), fileSize, std::ref(ring), std::ref(readError)));
+    reader->start();
+
+    // Slots stay held by this side until all of their commands complete
+    int maxHeldSlots = qBound(1, d->device->queueDepth(), qMax(1, ring.capacity() - 1));
+    QQueue<int> heldSlotCommands;
+
+    auto stopReader = [this, &ring, &reader]() {
+        d->discardQueuedCommands();
+        ring.abort();
+        reader->wait();
+    };
+
+    // Source hashes are computed from the same blocks on the hash thread,
+    // so the file is read from disk only once. A segment's hash would not
+    // describe the file, so none is taken.
+    TransferOptions hashOptions = d->options;
+    if (item.isSegment()) {
+        hashOptions.hashMode = HashMode::None;
+        hashOptions.fastHashMode = HashMode::None;
+    }
+    SourceHasher hasher(hashOptions);
+    QFuture<void> hashJob;
+
+    const qint64 underrunBase = d->stats.bufferUnderruns;
+    const qint64 overrunBase = d->stats.bufferOverruns;
+    qint64 totalWritten = 0;
+    bool sampled = false;           // First block checked by the compression policy
+
+    // Reap the commands of the oldest held slot and hand it back to the reader
+    auto retireSlot = [this, &ring, &heldSlotCommands, &totalWritten, &item]() {
+        QLTFS_TRACE_SPAN("tapeio", "retireSlot");
+        int commands = heldSlotCommands.dequeue();
+        bool ok = true;
+        for (int i = 0; i < commands; ++i) {
+            TapeCompletion completion;
+            if (!d->device->reapCompletion(completion) || !completion.success) {
+                ok = false;
+                break;
+            }
+            totalWritten += completion.bytesTransferred;
+            d->stats.completedBytes += completion.bytesTransferred;
+        }
+        item.bytesTransferred = totalWritten;
+        ring.releaseRead();
+        return ok;
+    };
+
+    for (;;) {
+        if (!d->waitWhilePaused()) {
+            stopReader();
+            item.status = TransferStatus::Cancelled;
+            return false;
+        }
+
+        BlockSlot *slot = ring.acquireRead();
+        if (!slot) {
+            // Reader aborted the ring on a source error
+            reader->wait();
+            item.errorMessage = QStringLiteral("Read error: %1").arg(readError);
+            item.status = TransferStatus::Failed;
+            return false;
+        }
+
+        bool last = slot->last;
+        if (slot->length > 0) {
+            if (!sampled) {
+                d->adaptCompression(slot->data, slot->length);
+                sampled = true;
+            }
+
+            if (hasher.isActive()) {
+                hashJob = QtConcurrent::run(&d->hashPool, [&hasher, slot]() {
+                    hasher.addData(slot->data, slot->length);
+                });
+            }
+
+            int commands = d->submitCoalesced(slot->data, slot->length, blockSize);
+
+            // The slot must not be recycled while it is still being hashed
+            hashJob.waitForFinished();
+
+            if (commands < 0) {
+                stopReader();
+                item.errorMessage = QStringLiteral("Write error: %1").arg(d->device->lastError());
+                item.status = TransferStatus::Failed;
                 return false;
             }
+            heldSlotCommands.enqueue(commands);
+        } else {
+            heldSlotCommands.enqueue(0);
         }
-    }
 
-    // Recurse into subdirectories
-    for (const auto &subdir : tapeDir.subdirectories()) {
-        QString subdirDest = destPath + QLatin1Char('/') + subdir.name();
-        if (!readDirectory(subdir, subdirDest)) {
-            if (!d->options.continueOnError) {
+        // Retire everything at the end of the file or for a telemetry
+        // sample, otherwise only enough to keep the reader supplied
+        // with free slots
+        const bool sampleDue = d->telemetry->isDue();
+        while (!heldSlotCommands.isEmpty() &&
+               (last || sampleDue || heldSlotCommands.size() >= maxHeldSlots)) {
+            if (!retireSlot()) {
+                stopReader();
+                item.errorMessage = QStringLiteral("Write error: %1").arg(d->device->lastError());
+                item.status = TransferStatus::Failed;
                 return false;
             }
         }
+
+        d->stats.bufferFill = ring.fillLevel();
+        d->stats.bufferUnderruns = underrunBase + static_cast<qint64>(ring.underruns());
+        d->stats.bufferOverruns = overrunBase + static_cast<qint64>(ring.overruns());
+
+        if (sampleDue) {
+            sampleTelemetry();
+        }
+
+        d->publishProgress(totalWritten, fileSize);
+        if (d->progressDue()) {
+            emit fileProgress(item, totalWritten, fileSize);
+            updateStatistics();
+        }
+
+        if (last) {
+            break;
+        }
+    }
+
+    reader->wait();
+    d->stats.bufferFill = 0;
+    d->updatePoolStats();
+
+    // A truncated stream must not leave a hash that looks like the source's
+    if (!readError.isEmpty()) {
+        item.errorMessage = QStringLiteral("Read error: %1").arg(readError);
+        item.status = TransferStatus::Failed;
+        return false;
+    }
+
+    if (streamed) {
+        // Release the source now; the queue keeps the item for its whole run
+        fileSize = totalWritten;
+        item.size = totalWritten;
+        item.stream.reset();
+        d->stats.totalBytes += totalWritten;
+    }
+
+    hasher.store(item);
+
+    // Write filemark after file
+    if (!d->device->writeFilemark(1)) {
+        item.errorMessage = QStringLiteral("Failed to write filemark");
+        item.status = TransferStatus::Failed;
+        return false;
+    }
+
+    const qint64 fileLength = item.isSegment() ? file.size() : -1;
+    addToIndex(item, fileSize, startPos.blockNumber, 0, fileLength);
+
+    // Behind the filemark the data survives a crash of this host
+    if (!d->journalItem(item, startPos.blockNumber, 0, fileSize, fileLength, true)) {
+        emit errorOccurred(d->journal.lastError());
     }
 
+    item.status = TransferStatus::Completed;
     return true;
 }
 
-bool TapeIO::readFiles(const QList<LtfsFile> &files, const QString &destDir)
+bool TapeIO::writePackedFile(TransferItem &item)
 {
-    QDir dir;
-    if (!dir.mkpath(destDir)) {
-        d->lastError = QStringLiteral("Failed to create destination directory");
+    TraceSpan span("tapeio", "writePackedFile");
+    span.setArg("bytes", item.size);
+
+    QFile file(item.sourcePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        item.errorMessage = QStringLiteral("Failed to open source file: %1").arg(file.errorString());
+        item.status = TransferStatus::Failed;
         return false;
     }
 
-    bool allSuccess = true;
-    for (const auto &file : files) {
-        QString destPath = destDir + QLatin1Char('/') + file.name();
-        if (!readFile(file, destPath)) {
-            allSuccess = false;
-            if (!d->options.continueOnError) {
-                break;
-            }
+    quint32 blockSize = d->options.blockSize;
+
+    // Only the first file of a run needs to find the end of data
+    if (!d->packing) {
+        if (!d->device->seekToEnd(1)) {
+            item.errorMessage = QStringLiteral("Failed to seek to end of data");
+            item.status = TransferStatus::Failed;
+            return false;
+        }
+        d->packBuffer.resize(static_cast<int>(blockSize));
+        d->packFill = 0;
+        d->packedFiles = 0;
+        d->packing = true;
+        d->packCompressionChosen = false;
+
+        // How far a run reaches is not known when it starts
+        if (!d->journalStart(d->device->position().blockNumber, -1)) {
+            emit errorOccurred(d->journal.lastError());
         }
     }
 
-    return allSuccess;
-}
+    // The file starts inside the block currently being filled
+    quint64 startBlock = d->device->position().blockNumber;
+    quint32 byteOffset = d->packFill;
 
-bool TapeIO::verifyFile(const LtfsFile &tapeFile, const QString &localPath)
-{
-    Q_UNUSED(tapeFile)
-    Q_UNUSED(localPath)
+    SourceHasher hasher(d->options);
 
-    // Read file from tape and compare hash
-    // This is a placeholder - full implementation would read from tape
-    // and compare with local file hash
+    qint64 fileSize = file.size();
+    qint64 total = 0;
 
-    return true;
-}
+    while (total < fileSize) {
+        char *dest = d->packBuffer.data() + d->packFill;
+        qint64 bytesRead = file.read(dest, qMin<qint64>(blockSize - d->packFill, fileSize - total));
+        if (bytesRead <= 0) {
+            item.errorMessage = QStringLiteral("Read error: %1").arg(file.errorString());
+            item.status = TransferStatus::Failed;
+            return false;
+        }
 
-HashResult TapeIO::calculateHash(const QString &filePath)
-{
-    HashCalculator calc(d->options.hashMode);
-    return calc.hashFile(filePath);
-}
+        hasher.addData(dest, bytesRead);
+        d->packFill += static_cast<quint32>(bytesRead);
+        total += bytesRead;
 
-bool TapeIO::isRunning() const
-{
-    return d->running;
-}
+        if (d->packFill == blockSize) {
+            // The first full block of a run decides for all of its files
+            if (!d->packCompressionChosen) {
+                d->adaptCompression(d->packBuffer.constData(), blockSize);
+                d->packCompressionChosen = true;
+            }
 
-bool TapeIO::isPaused() const
-{
-    return d->paused;
-}
+            qint64 written = d->device->writeBlock(d->packBuffer.constData(), blockSize);
+            d->stats.tapeCommands++;
+            d->packFill = 0;
+            if (written < 0) {
+                item.errorMessage = QStringLiteral("Write error: %1").arg(d->device->lastError());
+                item.status = TransferStatus::Failed;
+                failPackedRun(item.errorMessage);
+                return false;
+            }
+        }
+    }
+
+    file.close();
+
+    hasher.store(item);
+
+    item.bytesTransferred = total;
+    d->stats.completedBytes += total;
 
-void TapeIO::pause()
-{
-    if (d->running && !d->paused) {
-        d->paused = true;
-        emit pausedChanged(true);
+    // Bound the amount of data a reader has to scan between filemarks
+    d->packedFiles++;
+    if (d->options.packFilemarkInterval > 0 && d->packedFiles >= d->options.packFilemarkInterval) {
+        if (!flushPack(true)) {
+            item.errorMessage = d->lastError;
+            item.status = TransferStatus::Failed;
+            return false;
+        }
     }
+
+    addToIndex(item, fileSize, startBlock, byteOffset);
+    d->journalItem(item, startBlock, byteOffset, fileSize, -1, false);
+
+    // Packed files are small and fileCompleted follows right away; a
+    // progress signal per file would only flood the receiver
+    d->publishProgress(total, fileSize);
+
+    item.status = TransferStatus::Completed;
+    return true;
 }
 
-void TapeIO::resume()
+bool TapeIO::flushPack(bool keepPacking)
 {
-    if (d->running && d->paused) {
-        d->paused = false;
-        emit pausedChanged(false);
-        processQueue();
+    if (!d->packing) {
+        return true;
     }
-}
 
-void TapeIO::cancel()
-{
-    d->cancelled = true;
-    d->paused = false;
-}
+    QLTFS_TRACE_SPAN("tapeio", "flushPack");
 
-bool TapeIO::waitForCompletion(int timeoutMs)
-{
-    QElapsedTimer timer;
-    timer.start();
+    d->packing = keepPacking;
+    d->packedFiles = 0;
 
-    while (d->running) {
-        if (timeoutMs >= 0 && timer.elapsed() >= timeoutMs) {
+    if (d->packFill > 0) {
+        // A short block is fine here: a filemark follows immediately
+        qint64 written = d->device->writeBlock(d->packBuffer.constData(), d->packFill);
+        d->stats.tapeCommands++;
+        d->packFill = 0;
+        if (written < 0) {
+            d->lastError = QStringLiteral("Failed to write packed block: %1").arg(d->device->lastError());
+            failPackedRun(d->lastError);
             return false;
         }
-        QThread::msleep(100);
     }
 
-    return true;
-}
+    if (!d->device->writeFilemark(1)) {
+        d->lastError = QStringLiteral("Failed to write filemark");
+        failPackedRun(d->lastError);
+        return false;
+    }
 
-TransferStats TapeIO::statistics() const
-{
-    return d->stats;
-}
+    if (!d->commitPendingRecords()) {
+        emit errorOccurred(d->journal.lastError());
+    }
 
-QList<TransferItem> TapeIO::items() const
-{
-    QMutexLocker locker(&d->queueMutex);
-    return d->queue;
+    return true;
 }
 
-QList<TransferItem> TapeIO::failedItems() const
+void TapeIO::failPackedRun(const QString &reason)
 {
-    QMutexLocker locker(&d->queueMutex);
+    // No filemark protects any file of the open run, and the block that
+    // failed may hold the data of any of them: none of them counts
+    d->packing = false;
+    d->packFill = 0;
+    d->packedFiles = 0;
+
+    auto key = [](const QString &destPath, qint64 sourceOffset) {
+        return destPath + QLatin1Char('\n') + QString::number(sourceOffset);
+    };
+    QHash<QString, qint64> lost;
+    for (const JournalRecord &record : d->pendingRecords) {
+        d->paths.remove(record.destPath);
+        lost.insert(key(record.destPath, record.sourceOffset), record.byteCount);
+    }
+    d->pendingRecords.clear();
+    if (lost.isEmpty()) {
+        return;
+    }
+
     QList<TransferItem> failed;
-    for (const auto &item : d->queue) {
-        if (item.status == TransferStatus::Failed) {
+    {
+        QMutexLocker locker(&d->queueMutex);
+        for (int i = 0; i < d->queue.size() && failed.size() < lost.size(); ++i) {
+            if (d->queue.status(i) != TransferStatus::Completed) {
+                continue;
+            }
+            TransferItem item = d->queue.at(i);
+            auto it = lost.constFind(key(item.destPath, item.sourceOffset));
+            if (it == lost.constEnd()) {
+                continue;
+            }
+            d->stats.completedBytes -= *it;
+            item.status = TransferStatus::Failed;
+            item.errorMessage = QStringLiteral("Lost with its packed run: %1").arg(reason);
+            d->queue.update(i, item);
             failed.append(item);
         }
     }
-    return failed;
-}
 
-QString TapeIO::lastError() const
-{
-    return d->lastError;
+    d->stats.completedFiles -= failed.size();
+    d->stats.failedFiles += failed.size();
+    for (const TransferItem &item : failed) {
+        emit fileError(item, item.errorMessage);
+    }
 }
 
-bool TapeIO::writeFileToTape(TransferItem &item)
+bool TapeIO::openJournal()
 {
-    if (item.isDirectory) {
-        // Directories are just metadata entries in the index
-        item.status = TransferStatus::Completed;
-        return true;
+    // The journal only applies to the cartridge it was written for
+    const QString volumeId = QString::fromLatin1(
+        d->device->readMamAttributes().value(MAM_MEDIUM_SERIAL_NUMBER)).trimmed();
+    if (volumeId.isEmpty()) {
+        d->lastError = QStringLiteral("Cannot read the cartridge serial number; the journal cannot be matched to it");
+        return false;
     }
-
-    QFile file(item.sourcePath);
-    if (!file.open(QIODevice::ReadOnly)) {
-        item.errorMessage = QStringLiteral("Failed to open source file: %1").arg(file.errorString());
-        item.status = TransferStatus::Failed;
+    if (!d->journal.open(d->options.journalPath, volumeId)) {
+        d->lastError = d->journal.lastError();
         return false;
     }
+    d->pendingRecords.clear();
+    d->checkpointBase = 0;
 
-    // Calculate source hash if verification is enabled
-    if (d->options.verifyAfterWrite) {
-        HashCalculator calc(d->options.hashMode);
-        HashResult hashResult = calc.hashFile(item.sourcePath,
-            [this, &item](qint64 processed, qint64 total) {
-                Q_UNUSED(total)
-                // Don't count hash calculation in transfer progress
-                Q_UNUSED(processed)
-            });
-
-        if (hashResult.success) {
-            item.sourceHash = hashResult.hexString;
-        }
+    if (d->journal.records().isEmpty()) {
+        return true;
     }
 
-    // Seek to end of data partition
+    // Only what actually reached tape counts. Records are in tape order,
+    // so the consistent point is the last one ending at or before end of
+    // data (a Started record: beginning there).
     if (!d->device->seekToEnd(1)) {
-        item.errorMessage = QStringLiteral("Failed to seek to end of data");
-        item.status = TransferStatus::Failed;
+        d->lastError = QStringLiteral("Failed to seek to end of data: %1").arg(d->device->lastError());
         return false;
     }
-
-    // Record starting position for extent info
-    TapePosition startPos = d->device->position();
-
-    // Write file data in blocks
-    quint32 blockSize = d->options.blockSize;
-    QByteArray buffer;
-    buffer.reserve(static_cast<int>(blockSize));
-    qint64 totalWritten = 0;
-    qint64 fileSize = file.size();
-
-    while (!file.atEnd()) {
-        if (d->cancelled) {
-            item.status = TransferStatus::Cancelled;
+    const quint64 endOfData = d->device->position().blockNumber;
+
+    auto onTape = [endOfData](const JournalRecord &record) {
+        return record.kind == JournalRecord::Kind::Started
+            ? record.startBlock <= endOfData : record.endBlock <= endOfData;
+    };
+    int consistent = 0;
+    while (consistent < d->journal.records().size() && onTape(d->journal.records()[consistent])) {
+        consistent++;
+    }
+    if (consistent < d->journal.records().size()) {
+        qWarning() << "Journal runs past end of data at block" << endOfData << "- dropping"
+                   << d->journal.records().size() - consistent << "records";
+        if (!d->journal.truncate(consistent)) {
+            d->lastError = d->journal.lastError();
             return false;
         }
+    }
 
-        while (d->paused) {
-            QThread::msleep(100);
-            if (d->cancelled) {
-                item.status = TransferStatus::Cancelled;
+    // Data past the last completed record is only this journal's to
+    // overwrite when it is the write that was in progress: a Started
+    // record is last and end of data lies inside the extent it bounds.
+    // Anything else may have been appended by another job or tool after
+    // the interruption, so writing resumes behind it.
+    const QList<JournalRecord> &journaled = d->journal.records();
+    if (!journaled.isEmpty() && journaled.last().kind == JournalRecord::Kind::Started) {
+        const JournalRecord started = journaled.last();
+        if (!d->journal.truncate(journaled.size() - 1)) {
+            d->lastError = d->journal.lastError();
+            return false;
+        }
+        if (endOfData > started.startBlock && started.endBlock > 0 && endOfData <= started.endBlock) {
+            qWarning() << "Overwriting" << endOfData - started.startBlock
+                       << "blocks of an interrupted write at block" << started.startBlock;
+            if (!d->device->locateForOverwrite(1, started.startBlock)) {
+                d->lastError = QStringLiteral("Failed to locate to resume point: %1").arg(d->device->lastError());
                 return false;
             }
+        } else if (endOfData > started.startBlock) {
+            qWarning() << "Cannot bound the interrupted write at block" << started.startBlock
+                       << "- appending at end of data";
         }
+    }
 
-        buffer = file.read(static_cast<qint64>(blockSize));
-        if (buffer.isEmpty()) {
-            if (file.error() != QFile::NoError) {
-                item.errorMessage = QStringLiteral("Read error: %1").arg(file.errorString());
-                item.status = TransferStatus::Failed;
-                return false;
-            }
-            break;
+    const QList<JournalRecord> &records = d->journal.records();
+    auto key = [](const QString &destPath, qint64 sourceOffset) {
+        return destPath + QLatin1Char('\n') + QString::number(sourceOffset);
+    };
+    auto msecs = [](const QDateTime &time) {
+        return time.isValid() ? time.toMSecsSinceEpoch() : std::numeric_limits<qint64>::min();
+    };
+
+    QHash<QString, int> written;
+    for (int i = 0; i < records.size(); ++i) {
+        if (records[i].kind == JournalRecord::Kind::File || records[i].kind == JournalRecord::Kind::Directory) {
+            written.insert(key(records[i].destPath, records[i].sourceOffset), i);
         }
+    }
 
-        qint64 written = d->device->writeBlock(buffer);
-        if (written < 0) {
-            item.errorMessage = QStringLiteral("Write error: %1").arg(d->device->lastError());
-            item.status = TransferStatus::Failed;
-            return false;
+    // Items whose source changed since are written again
+    QMutexLocker locker(&d->queueMutex);
+    for (int i = 0; i < d->queue.size(); ++i) {
+        TransferItem item = d->queue.at(i);
+        auto it = written.constFind(key(item.destPath, item.sourceOffset));
+        if (item.status != TransferStatus::Pending || item.isStream() || it == written.constEnd()) {
+            continue;
         }
 
-        totalWritten += written;
-        item.bytesTransferred = totalWritten;
-        d->stats.completedBytes += written;
+        const JournalRecord &record = records[*it];
+        if (item.isDirectory != (record.kind == JournalRecord::Kind::Directory)) {
+            continue;
+        }
+        if (item.isDirectory) {
+            d->paths.addDirectory(item.destPath);
+        } else {
+            if (record.size != item.size || record.sourceLength != item.sourceLength ||
+                msecs(record.modifiedTime) != msecs(item.modifiedTime)) {
+                continue;
+            }
+            item.sourceHash = record.sourceHash;
+            item.fastHash = record.fastHash;
+            item.bytesTransferred = record.byteCount;
+            addToIndex(item, record.byteCount, record.startBlock, record.byteOffset, record.fileLength);
+            d->stats.completedBytes += record.byteCount;
+        }
 
-        emit fileProgress(item, totalWritten, fileSize);
-        updateStatistics();
+        item.status = TransferStatus::Completed;
+        d->queue.update(i, item);
+        d->stats.completedFiles++;
     }
 
-    // Write filemark after file
-    if (!d->device->writeFilemark(1)) {
-        item.errorMessage = QStringLiteral("Failed to write filemark");
-        item.status = TransferStatus::Failed;
-        return false;
+    return true;
+}
+
+void TapeIO::writeCheckpoint()
+{
+    QLTFS_TRACE_SPAN("tapeio", "checkpoint");
+
+    d->checkpointBase = d->stats.completedBytes;
+
+    // The index goes behind the last filemark, after every packed file
+    if (!flushPack() || !d->device->seekToEnd(1)) {
+        emit errorOccurred(QStringLiteral("Index checkpoint skipped: %1").arg(d->lastError));
+        return;
+    }
+    if (!d->checkpointHandler(d->paths)) {
+        emit errorOccurred(QStringLiteral("Index checkpoint failed"));
+        return;
     }
 
-    // Update index with extent info
-    if (d->index) {
-        LtfsFile newFile;
-        newFile.setName(QFileInfo(item.destPath).fileName());
-        newFile.setLength(fileSize);
-        newFile.setReadonly(false);
-
-        QDateTime now = QDateTime::currentDateTimeUtc();
-        newFile.setCreationTime(item.modifiedTime.isValid() ? item.modifiedTime : now);
-        newFile.setModifyTime(item.modifiedTime.isValid() ? item.modifiedTime : now);
-        newFile.setAccessTime(now);
-        newFile.setChangeTime(now);
-
-        // Add extent info
-        LtfsExtent extent;
-        extent.setPartition(PartitionLabel::DataPartition);
-        extent.setStartBlock(startPos.blockNumber);
-        extent.setByteOffset(0);
-        extent.setByteCount(fileSize);
-        extent.setFileOffset(0);
-
-        QList<LtfsExtent> extents;
-        extents.append(extent);
-        newFile.setExtentInfo(extents);
-
-        // Set hash if calculated
-        if (!item.sourceHash.isEmpty()) {
-            ExtendedAttribute hashAttr;
-            hashAttr.key = hashTypeToString(d->options.hashMode);
-            hashAttr.value = item.sourceHash;
-            QList<ExtendedAttribute> attrs;
-            attrs.append(hashAttr);
-            newFile.setExtendedAttributes(attrs);
-        }
-
-        // Add to index (simplified - real implementation would handle paths)
-        // d->index->rootDirectory().addFile(newFile);
+    if (d->journal.isOpen()) {
+        JournalRecord record;
+        record.kind = JournalRecord::Kind::Checkpoint;
+        record.endBlock = d->device->position().blockNumber;
+        if (!d->journal.append(record)) {
+            d->journal.close();
+            emit errorOccurred(d->journal.lastError());
+        }
     }
+}
 
-    item.status = TransferStatus::Completed;
-    return true;
+void TapeIO::addToIndex(const TransferItem &item, qint64 byteCount, quint64 startBlock, quint32 byteOffset,
+                        qint64 fileLength)
+{
+    // PathIndex is the record of what was written; index() stays as set
+    LtfsFile newFile;
+    newFile.setName(QFileInfo(item.destPath).fileName());
+    newFile.setLength(fileLength < 0 ? byteCount : fileLength);
+    newFile.setReadonly(false);
+
+    QDateTime now = QDateTime::currentDateTimeUtc();
+    newFile.setCreationTime(item.modifiedTime.isValid() ? item.modifiedTime : now);
+    newFile.setModifyTime(item.modifiedTime.isValid() ? item.modifiedTime : now);
+    newFile.setAccessTime(now);
+    newFile.setChangeTime(now);
+
+    // Add extent info
+    LtfsExtent extent;
+    extent.setPartition(PartitionLabel::DataPartition);
+    extent.setStartBlock(startBlock);
+    extent.setByteOffset(byteOffset);
+    extent.setByteCount(byteCount);
+    extent.setFileOffset(item.sourceOffset);
+
+    QList<LtfsExtent> extents;
+    extents.append(extent);
+    newFile.setExtentInfo(extents);
+
+    // Set hashes if calculated; the fast one lets verify passes
+    // skip the cryptographic hash while the index keeps both
+    QList<ExtendedAttribute> attrs;
+    if (!item.sourceHash.isEmpty()) {
+        ExtendedAttribute hashAttr;
+        hashAttr.key = HashCalculator::attributeKey(d->options.hashMode);
+        hashAttr.value = item.sourceHash;
+        attrs.append(hashAttr);
+    }
+    if (!item.fastHash.isEmpty()) {
+        ExtendedAttribute hashAttr;
+        hashAttr.key = HashCalculator::attributeKey(d->options.fastHashMode);
+        hashAttr.value = item.fastHash;
+        attrs.append(hashAttr);
+    }
+    if (!attrs.isEmpty()) {
+        newFile.setExtendedAttributes(attrs);
+    }
+
+    d->paths.addFile(item.destPath, newFile);
 }
 
 bool TapeIO::readFileFromTape(TransferItem &item)
 {
+    TraceSpan span("tapeio", "readFile");
+    span.setArg("bytes", item.size);
+
     // Create parent directories
     if (d->options.createDirectories) {
         QFileInfo destInfo(item.destPath);
@@ -637,80 +2694,225 @@ bool TapeIO::readFileFromTape(TransferItem &item)
         return false;
     }
 
-    // Read data from tape
+    QScopedPointer<HashCalculator> hasher;
+    if (d->options.verifyAfterWrite && !item.sourceHash.isEmpty() &&
+        d->verifyMode() != HashMode::None) {
+        hasher.reset(new HashCalculator(d->verifyMode()));
+    }
+
+    bool success = streamFromTape(item, &file, hasher.data());
+    file.close();
+    if (!success) {
+        QFile::remove(item.destPath);
+        return false;
+    }
+
+    // Compare the hash taken in flight with the one recorded at write time
+    if (hasher && !checkHash(item, *hasher)) {
+        return false;
+    }
+
+    item.status = TransferStatus::Completed;
+    return true;
+}
+
+bool TapeIO::verifyFileOnTape(TransferItem &item)
+{
+    TraceSpan span("tapeio", "verifyFile");
+    span.setArg("bytes", item.size);
+
+    HashCalculator hasher(d->verifyMode());
+    if (!streamFromTape(item, nullptr, &hasher)) {
+        return false;
+    }
+
+    if (!checkHash(item, hasher)) {
+        return false;
+    }
+
+    item.status = TransferStatus::Completed;
+    return true;
+}
+
+bool TapeIO::streamFromTape(TransferItem &item, QIODevice *sink, HashCalculator *hasher, bool *sinkFailed)
+{
+    // Read data from tape. Blocks are read straight into pooled ring
+    // slots; a drain thread writes them to disk (if restoring) while the
+    // hash thread digests the same slots, so the drive keeps streaming
+    // and nothing is read back from disk for verification.
+    if (!d->applyBlockProtection()) {
+        item.errorMessage = d->lastError;
+        item.status = TransferStatus::Failed;
+        return false;
+    }
+
     quint32 blockSize = d->options.blockSize;
-    QByteArray buffer;
+    quint32 blocksPerCommand = d->device->maxBlocksPerCommand(blockSize, d->options.blocksPerCommand);
+    quint32 slotSize = blockSize * blocksPerCommand;
+    int ringSize = qMax(2, BlockManager(blockSize).recommendedBufferCount() / static_cast<int>(blocksPerCommand));
+    BlockRing ring(d->ensureBlockPool(slotSize, ringSize + 1), ringSize);
+    d->stats.bufferCapacity = ring.capacity();
+
+    if (ring.capacity() == 0) {
+        item.errorMessage = QStringLiteral("Failed to allocate transfer buffer");
+        item.status = TransferStatus::Failed;
+        return false;
+    }
+
+    QString writeError;
+    qint64 drained = 0;
+    bool drainFailed = false;
+    if (!sinkFailed) {
+        sinkFailed = &drainFailed;
+    }
+    *sinkFailed = false;
+    QScopedPointer<QThread> drain(QThread::create(drainRing,
+        sink, std::ref(ring), hasher, &d->hashPool, std::ref(writeError), std::ref(drained)));
+    drain->start();
+
+    auto restoreBlockMode = [this, blocksPerCommand]() {
+        if (blocksPerCommand > 1 && d->device->isFixedBlockMode()) {
+            d->device->setBlockSize(0);
+        }
+    };
+
+    auto fail = [&item, &ring, &drain, &drained, &restoreBlockMode](TransferStatus status, const QString &message) {
+        ring.abort();
+        drain->wait();
+        restoreBlockMode();
+        item.bytesTransferred = drained;
+        item.errorMessage = message;
+        item.status = status;
+        return false;
+    };
+
+    const qint64 underrunBase = d->stats.bufferUnderruns;
+    const qint64 overrunBase = d->stats.bufferOverruns;
     qint64 totalRead = 0;
     qint64 expectedSize = item.size;
+    quint32 skip = item.tapeByteOffset;  // Packed files start inside a shared block
+    bool fromTail = d->headFromTail;     // locateFile() left the drive past the first block
+    d->headFromTail = false;
+    bool last = false;
+    QElapsedTimer readTimer;
+    readTimer.start();
+
+    while (!last) {
+        if (!d->waitWhilePaused()) {
+            return fail(TransferStatus::Cancelled, QString());
+        }
 
-    while (totalRead < expectedSize) {
-        if (d->cancelled) {
-            item.status = TransferStatus::Cancelled;
-            file.close();
-            QFile::remove(item.destPath);
-            return false;
+        BlockSlot *slot = ring.acquireWrite();
+        if (!slot) {
+            // Drain thread aborted the ring on a disk error
+            *sinkFailed = true;
+            return fail(TransferStatus::Failed, QStringLiteral("Write error: %1").arg(writeError));
         }
 
-        while (d->paused) {
-            QThread::msleep(100);
-            if (d->cancelled) {
-                item.status = TransferStatus::Cancelled;
-                file.close();
-                QFile::remove(item.destPath);
-                return false;
-            }
+        if (totalRead >= expectedSize) {
+            // Empty file: only the end marker goes to the drain thread
+            ring.commitWrite(0, true);
+            break;
         }
 
-        qint64 toRead = qMin(static_cast<qint64>(blockSize), expectedSize - totalRead);
-        qint64 bytesRead = d->device->readBlock(buffer, static_cast<quint32>(toRead));
+        // Whole blocks of the file are read in bulk; the last (possibly
+        // short) block is read on its own in variable mode
+        quint32 fullBlocks = static_cast<quint32>(
+            qMin<qint64>(blocksPerCommand, (expectedSize - totalRead + skip) / blockSize));
+        qint64 bytesRead = 0;
+        if (fromTail) {
+            bytesRead = d->tailBlock.size();
+            memcpy(slot->data, d->tailBlock.constData(), static_cast<size_t>(bytesRead));
+        } else {
+            bytesRead = fullBlocks > 1
+                ? d->device->readBlocks(slot->data, fullBlocks, blockSize)
+                : d->device->readBlock(slot->data, blockSize);
+            d->stats.tapeCommands++;
+        }
 
         if (bytesRead < 0) {
-            item.errorMessage = QStringLiteral("Read error: %1").arg(d->device->lastError());
-            item.status = TransferStatus::Failed;
-            file.close();
-            QFile::remove(item.destPath);
-            return false;
+            return fail(TransferStatus::Failed,
+                        QStringLiteral("Read error: %1").arg(d->device->lastError()));
         }
 
+        if (bytesRead > 0 && !fromTail) {
+            // Every record but a file's last is full, so the longest one
+            // read is the block size the tape was written with
+            const qint64 record = fullBlocks > 1 ? bytesRead / fullBlocks : bytesRead;
+            d->passRecordSize = qMax(d->passRecordSize, static_cast<quint32>(record));
+        }
+
+        qint64 length = 0;
         if (bytesRead == 0) {
             // End of data (filemark or blank)
-            break;
-        }
+            last = true;
+        } else {
+            // Data ahead of a packed file's first byte is dropped in place
+            quint32 skipped = static_cast<quint32>(qMin<qint64>(skip, bytesRead));
+            skip -= skipped;
+
+            length = qMin(bytesRead - skipped, expectedSize - totalRead);
+
+            // The next packed file may start in the block this one ends in
+            if (totalRead + length >= expectedSize && !fromTail && d->device->isPositionKnown()) {
+                const qint64 tailStart = fullBlocks > 1 ? bytesRead - blockSize : 0;
+                d->tailBlock = QByteArray(slot->data + tailStart, static_cast<int>(bytesRead - tailStart));
+                d->tailPosition = d->device->position();
+                d->tailPosition.blockNumber -= 1;
+                d->tailValid = true;
+            }
+            fromTail = false;
 
-        if (file.write(buffer) != buffer.size()) {
-            item.errorMessage = QStringLiteral("Write error: %1").arg(file.errorString());
-            item.status = TransferStatus::Failed;
-            file.close();
-            QFile::remove(item.destPath);
-            return false;
+            if (skipped > 0 && length > 0) {
+                memmove(slot->data, slot->data + skipped, static_cast<size_t>(length));
+            }
+
+            totalRead += length;
+            last = totalRead >= expectedSize;
         }
+        ring.commitWrite(static_cast<uint32_t>(length), last);
 
-        totalRead += bytesRead;
         item.bytesTransferred = totalRead;
-        d->stats.completedBytes += bytesRead;
-
-        emit fileProgress(item, totalRead, expectedSize);
-        updateStatistics();
+        d->stats.completedBytes += length;
+        d->stats.bufferFill = ring.fillLevel();
+        d->stats.bufferUnderruns = underrunBase + static_cast<qint64>(ring.underruns());
+        d->stats.bufferOverruns = overrunBase + static_cast<qint64>(ring.overruns());
+
+        d->publishProgress(totalRead, expectedSize);
+        if (d->progressDue()) {
+            emit fileProgress(item, totalRead, expectedSize);
+            updateStatistics();
+        }
     }
 
-    file.close();
+    drain->wait();
+    restoreBlockMode();
+    d->stats.bufferFill = 0;
+    d->updatePoolStats();
+    item.bytesTransferred = drained;
+    d->addPassRead(totalRead, readTimer.nsecsElapsed());
 
-    // Verify hash if enabled
-    if (d->options.verifyAfterWrite && !item.sourceHash.isEmpty()) {
-        if (!verifyFileHash(item)) {
-            return false;
-        }
+    if (!writeError.isEmpty()) {
+        *sinkFailed = true;
+        item.errorMessage = QStringLiteral("Write error: %1").arg(writeError);
+        item.status = TransferStatus::Failed;
+        return false;
+    }
+
+    if (totalRead < expectedSize) {
+        item.errorMessage = QStringLiteral("Unexpected end of data after %1 of %2 bytes")
+            .arg(totalRead).arg(expectedSize);
+        item.status = TransferStatus::Failed;
+        return false;
     }
 
-    item.status = TransferStatus::Completed;
     return true;
 }
 
-bool TapeIO::verifyFileHash(TransferItem &item)
+bool TapeIO::checkHash(TransferItem &item, const HashCalculator &hasher)
 {
-    HashCalculator calc(d->options.hashMode);
-    HashResult result = calc.hashFile(item.destPath);
-
+    QLTFS_TRACE_SPAN("tapeio", "checkHash");
+    HashResult result = hasher.result();
     if (!result.success) {
         item.errorMessage = QStringLiteral("Hash calculation failed");
         item.status = TransferStatus::Failed;
@@ -733,66 +2935,181 @@ void TapeIO::updateStatistics()
 {
     d->stats.elapsedMs = d->timer.elapsed();
 
+    // Speed and ETA follow the recent rate; the lifetime average hides
+    // slowdowns until long after they started
+    d->throughput.addSample(d->stats.elapsedMs, d->stats.completedBytes);
+    d->stats.bytesPerSecond = d->throughput.bytesPerSecond();
+    d->stats.estimatedRemainingMs =
+        d->throughput.estimatedRemainingMs(d->stats.totalBytes - d->stats.completedBytes);
     if (d->stats.elapsedMs > 0) {
-        d->stats.bytesPerSecond = static_cast<double>(d->stats.completedBytes) * 1000.0 / d->stats.elapsedMs;
-
-        if (d->stats.bytesPerSecond > 0) {
-            qint64 remainingBytes = d->stats.totalBytes - d->stats.completedBytes;
-            d->stats.estimatedRemainingMs = static_cast<qint64>(remainingBytes * 1000.0 / d->stats.bytesPerSecond);
-        }
+        d->stats.averageBytesPerSecond =
+            static_cast<double>(d->stats.completedBytes) * 1000.0 / d->stats.elapsedMs;
     }
 
+    d->progress.store(d->stats);
+    d->publishStats();
     emit progressChanged(d->stats.progressPercent(), d->stats);
 }
 
+void TapeIO::sampleTelemetry()
+{
+    // Only called with no tape commands in flight
+    if (!d->telemetry->sample()) {
+        return;
+    }
+
+    DriveTelemetrySample sample = d->telemetry->last();
+    sample.hostBufferFillPercent = d->stats.bufferFillPercent();
+    emit telemetrySampled(sample);
+}
+
 void TapeIO::processQueue()
 {
-    for (int i = 0; i < d->queue.size(); ++i) {
-        if (d->cancelled) {
+    if (d->options.queueDepth > 1) {
+        d->device->setQueueDepth(d->options.queueDepth);
+    }
+
+    // Make sure the cached position is trustworthy before relying on it
+    // to append without repositioning
+    d->device->verifyPosition();
+
+    for (int i = 0;; ++i) {
+        if (!d->waitWhilePaused()) {
             break;
         }
 
-        while (d->paused) {
-            QThread::msleep(100);
-            if (d->cancelled) {
+        // Work on a copy so items() stays safe to call from other threads.
+        // While a background scan is running the queue may still grow.
+        TransferItem item;
+        {
+            QMutexLocker locker(&d->queueMutex);
+            while (i >= d->queue.size() && d->scanning && !d->cancelled) {
+                d->queueChanged.wait(&d->queueMutex, 100);
+            }
+            if (i >= d->queue.size()) {
                 break;
             }
-        }
+            item = d->queue.at(i);
 
-        if (d->cancelled) {
-            break;
+            d->stats.totalFiles = qMax<qint64>(d->stats.totalFiles, d->queue.size());
+            d->stats.totalBytes += d->scannedBytes;
+            d->scannedBytes = 0;
         }
-
-        TransferItem &item = d->queue[i];
         if (item.status != TransferStatus::Pending) {
             continue;
         }
 
+        if (!item.isDirectory && d->resolvedWithoutWrite(item)) {
+            {
+                QMutexLocker locker(&d->queueMutex);
+                if (i < d->queue.size()) {
+                    d->queue.update(i, item);
+                }
+            }
+            if (item.status == TransferStatus::Skipped) {
+                d->stats.skippedFiles++;
+            } else {
+                d->stats.failedFiles++;
+                emit fileError(item, item.errorMessage);
+            }
+            d->progress.store(d->stats);
+            if (d->progressDue()) {
+                updateStatistics();
+            }
+            if (item.status == TransferStatus::Failed && !d->options.continueOnError) {
+                break;
+            }
+            continue;
+        }
+
         d->currentItemIndex = i;
         item.status = TransferStatus::InProgress;
+        {
+            QMutexLocker locker(&d->queueMutex);
+            if (i < d->queue.size()) {
+                d->queue.setStatus(i, TransferStatus::InProgress);
+            }
+        }
         emit fileStarted(item);
 
-        bool success = writeFileToTape(item);
+        bool packed = d->options.packThreshold > 0 && !item.isDirectory && !item.isSegment() &&
+                      !item.isStream() && item.size < d->options.packThreshold;
+        bool success;
+        if (packed) {
+            success = writePackedFile(item);
+        } else if (!item.isDirectory && !flushPack()) {
+            // Large file ends the packed run
+            item.errorMessage = d->lastError;
+            item.status = TransferStatus::Failed;
+            success = false;
+        } else {
+            success = writeFileToTape(item);
+        }
+
+        {
+            QMutexLocker locker(&d->queueMutex);
+            if (i < d->queue.size()) {
+                d->queue.update(i, item);
+            }
+        }
 
         if (success) {
             d->stats.completedFiles++;
             emit fileCompleted(item);
+            if (d->checkpointDue()) {
+                writeCheckpoint();
+            }
         } else {
             d->stats.failedFiles++;
             emit fileError(item, item.errorMessage);
+        }
 
-            if (!d->options.continueOnError) {
-                break;
-            }
+        d->pollCompressionRatio(false);
+        if (d->telemetry->isDue()) {
+            sampleTelemetry();
+        }
+        d->publishProgress(item.bytesTransferred, item.size);
+        if (d->progressDue()) {
+            updateStatistics();
+        }
+
+        if (!success && !d->options.continueOnError) {
+            break;
         }
+    }
+
+    // Close the last packed run, also after a cancel: its files are
+    // already recorded as completed
+    if (!flushPack()) {
+        emit errorOccurred(d->lastError);
+    }
+    d->pollCompressionRatio(true);
+
+    if (d->stats.completedFiles > 0 && !d->device->verifyPosition()) {
+        emit errorOccurred(QStringLiteral("Tape position changed unexpectedly during the write session"));
+    }
 
-        updateStatistics();
+    // Leave the drive in variable-block mode as LTFS expects
+    if (d->device->isFixedBlockMode()) {
+        d->device->setBlockSize(0);
+    }
+    if (d->device->isQueued()) {
+        d->device->setQueueDepth(1);
     }
 
-    d->running = false;
+    d->journal.close();
+
     d->currentItemIndex = -1;
+    updateStatistics();
+    d->publishProgress(0, 0);
 
     emit transferCompleted(d->stats);
+
+    {
+        QMutexLocker locker(&d->stateMutex);
+        d->running = false;
+        d->stateChanged.wakeAll();
+    }
     emit runningChanged(false);
 }
 
@@ -24,10 +24,15 @@
 #include "libqltfs_global.h"
 #include "core/LtfsTypes.h"
 #include "core/LtfsIndex.h"
+#include "core/PathIndex.h"
 #include "device/TapeDevice.h"
+#include "device/DriveTelemetry.h"
 #include "io/HashCalculator.h"
+#include "io/SourceReader.h"
 
+#include <QIODevice>
 #include <QObject>
+#include <QSharedPointer>
 #include <QString>
 #include <QStringList>
 #include <QFile>
@@ -38,6 +43,9 @@
 
 namespace qltfs {
 
+class TarWriter;
+class TransferProgress;
+
 /**
  * @brief File transfer operation type
  */
@@ -59,6 +67,16 @@ enum class TransferStatus {
     Cancelled       ///< Cancelled by user
 };
 
+/**
+ * @brief When drive hardware compression is used for writes
+ */
+enum class CompressionPolicy {
+    Drive,          ///< Leave the drive setting alone
+    Enabled,        ///< Compress everything
+    Disabled,       ///< Compress nothing
+    Adaptive        ///< Per file, from the byte entropy of its first block
+};
+
 /**
  * @brief Information about a file to be transferred
  */
@@ -76,12 +94,33 @@ struct LIBQLTFS_EXPORT TransferItem {
     // Hash verification
     QString sourceHash;
     QString destHash;
+    QString fastHash;           ///< Fast verify hash (TransferOptions::fastHashMode) of the source
     bool hashVerified = false;
 
     // Metadata
     QDateTime modifiedTime;
     bool isDirectory = false;
 
+    // Tape location (reads)
+    quint32 tapeByteOffset = 0;     ///< Offset of the file data in its first tape block
+
+    // Spanning (writes): only part of the source goes to this cartridge
+    qint64 sourceOffset = 0;        ///< First source byte written by this item
+    qint64 sourceLength = -1;       ///< Bytes written from sourceOffset, -1 for the whole file
+
+    // Streaming (writes): data comes from a device instead of sourcePath
+    QSharedPointer<QIODevice> stream;   ///< Set by TapeIO::addStream(); size is 0 until it ends
+
+    /**
+     * @brief Check if this item carries only part of its source file
+     */
+    bool isSegment() const { return sourceOffset > 0 || sourceLength >= 0; }
+
+    /**
+     * @brief Check if this item is read from a stream of unknown length
+     */
+    bool isStream() const { return !stream.isNull(); }
+
     /**
      * @brief Get display name for UI
      */
@@ -101,14 +140,34 @@ struct LIBQLTFS_EXPORT TransferStats {
 
     // Speed tracking
     qint64 elapsedMs = 0;
-    double bytesPerSecond = 0.0;
-    qint64 estimatedRemainingMs = 0;
+    double bytesPerSecond = 0.0;            ///< Over the last few seconds (ThroughputEstimator)
+    double averageBytesPerSecond = 0.0;     ///< Since the transfer started
+    qint64 estimatedRemainingMs = 0;        ///< At bytesPerSecond
+
+    // Read-ahead pipeline
+    int bufferFill = 0;             ///< Blocks read ahead and waiting to be written
+    int bufferCapacity = 0;         ///< Size of the read-ahead ring in blocks
+    qint64 bufferUnderruns = 0;     ///< Times the tape waited for the source (source is the bottleneck)
+    qint64 bufferOverruns = 0;      ///< Times the source waited for the tape (tape is the bottleneck)
+    int bufferPoolHighWater = 0;    ///< Peak number of pooled blocks in use at once
+    qint64 tapeCommands = 0;        ///< SCSI data commands issued (read or write)
+    qint64 locatesAvoided = 0;      ///< Restore locates replaced by reading through a short gap
+    qint64 gapBytesDiscarded = 0;   ///< Bytes read and dropped to get past those gaps
+
+    // Hardware compression
+    double compressionRatio = 0.0;  ///< Host bytes per tape byte written so far (0 = not known yet)
+    qint64 compressionSwitches = 0; ///< Times the adaptive policy toggled drive compression
 
     /**
      * @brief Get progress percentage (0-100)
      */
     int progressPercent() const;
 
+    /**
+     * @brief Get read-ahead ring fill level percentage (0-100)
+     */
+    int bufferFillPercent() const;
+
     /**
      * @brief Get human-readable speed string
      */
@@ -125,20 +184,39 @@ struct LIBQLTFS_EXPORT TransferStats {
  */
 using TransferProgressCallback = std::function<void(const TransferItem &item, const TransferStats &stats)>;
 using TransferErrorCallback = std::function<bool(const TransferItem &item, const QString &error)>;  // Return true to continue
+using IndexCheckpointHandler = std::function<bool(const PathIndex &paths)>;  // Return true once the index is on tape
 
 /**
  * @brief Transfer options
  */
 struct LIBQLTFS_EXPORT TransferOptions {
     HashMode hashMode = HashMode::SHA256;   ///< Hash algorithm for verification
+    HashMode fastHashMode = HashMode::None; ///< Extra fast hash (e.g. XXH3) recorded in the same pass
+    HashMode verifyHashMode = HashMode::None; ///< Hash compared on restore and verify (None = hashMode)
     bool verifyAfterWrite = true;           ///< Verify hashes after writing
     bool preserveTimestamps = true;         ///< Preserve file timestamps
     bool skipExisting = false;              ///< Skip files that already exist
     bool overwriteExisting = true;          ///< Overwrite existing files
+    bool skipDuplicates = false;            ///< Index files matching one on tape in size and hashMode hash as a copy of it, without writing them
     bool createDirectories = true;          ///< Create directories as needed
     bool continueOnError = true;            ///< Continue after errors
     int maxRetries = 3;                     ///< Maximum retries per file
-    quint32 blockSize = DEFAULT_BLOCK_SIZE; ///< Block size for tape I/O
+    quint32 blockSize = DEFAULT_BLOCK_SIZE; ///< Block size for tape I/O (0 = the volume label's, or the BlockSizeTuner choice for blank media)
+    quint32 blocksPerCommand = 1;           ///< Blocks coalesced per fixed-mode SCSI command (1 = per-block variable mode)
+    int queueDepth = 1;                     ///< Write commands kept in flight at the drive (1 = synchronous)
+    qint64 packThreshold = 0;               ///< Files smaller than this are packed back-to-back without own filemark (0 = off)
+    int packFilemarkInterval = 1000;        ///< Packed files written between filemarks (0 = only at end of run)
+    bool useRecommendedAccessOrder = true;  ///< Let the drive order restores (RAO) when it supports it
+    qint64 maxReadThroughBytes = 1024LL * 1024 * 1024; ///< Largest gap ahead a restore reads through instead of locating (0 = always locate)
+    bool blockProtection = false;           ///< CRC32C on every block, checked by the drive (LTO-5 and later)
+    CompressionPolicy compressionPolicy = CompressionPolicy::Drive; ///< Hardware compression for writes
+    double compressibleEntropy = 7.5;       ///< Adaptive: compress when the sample has fewer bits per byte
+    quint32 compressionSampleBytes = 64 * 1024; ///< Adaptive: bytes sampled from the start of each file
+    int telemetryInterval = 0;              ///< Drive telemetry period during writes in ms (0 = off)
+    SourceReadMode sourceReadMode = SourceReadMode::Buffered; ///< How source files are read (large files only)
+    int sourceReadDepth = 4;                ///< Slots read concurrently with io_uring (Linux, 1 = synchronous)
+    QString journalPath;                    ///< Journal of items on tape, to resume an interrupted write (empty = off)
+    qint64 checkpointBytes = 0;             ///< Data written between index checkpoints (0 = off)
 };
 
 /**
@@ -147,6 +225,11 @@ struct LIBQLTFS_EXPORT TransferOptions {
  * Manages file transfers between local filesystem and LTFS tape,
  * with support for progress tracking, hash verification, and
  * error handling.
+ *
+ * Write transfers run on a worker thread owned by TapeIO, so signals
+ * are delivered to receivers in other threads as queued events. Per-block
+ * progress signals are rate limited. The tape device must not be used
+ * by anyone else while a transfer is running.
  */
 class LIBQLTFS_EXPORT TapeIO : public QObject
 {
@@ -180,6 +263,9 @@ public:
 
     /**
      * @brief Get current LTFS index
+     *
+     * The index as given to setIndex(); files written since are only in
+     * pathIndex().
      */
     QSharedPointer<LtfsIndex> index() const;
 
@@ -188,6 +274,25 @@ public:
      */
     void setIndex(QSharedPointer<LtfsIndex> index);
 
+    /**
+     * @brief Path and content hash lookup over the current index
+     *
+     * Rebuilt by setIndex() and updated as files are written, with or
+     * without an index set: it is the record of what is on tape that
+     * checkpoints and the final index are written from. Must not be
+     * used from another thread while a transfer is running.
+     */
+    const PathIndex &pathIndex() const;
+
+    /**
+     * @brief Drive telemetry sampled during writes
+     *
+     * Sampling runs while TransferOptions::telemetryInterval is set. The
+     * vendor counters and drive buffer size may be configured here
+     * before a transfer starts.
+     */
+    DriveTelemetry *telemetry() const;
+
     // === Write Operations ===
 
     /**
@@ -199,11 +304,44 @@ public:
 
     /**
      * @brief Add directory to write queue (recursive)
+     *
+     * The tree is listed by a DirectoryScanner on several threads and
+     * the entries are queued in batches. Returns when the scan is done.
+     *
      * @param sourceDir Local directory path
      * @param destDir Destination directory on tape
      */
     void addDirectory(const QString &sourceDir, const QString &destDir = QString());
 
+    /**
+     * @brief Add directory to write queue without waiting for the scan
+     *
+     * Scans on a background thread; further calls are scanned in order
+     * after the current one. A write started meanwhile takes entries as
+     * they arrive and only finishes once all scans are done.
+     *
+     * @param sourceDir Local directory path
+     * @param destDir Destination directory on tape
+     */
+    void scanDirectory(const QString &sourceDir, const QString &destDir = QString());
+
+    /**
+     * @brief Check if background directory scans are still running
+     */
+    bool isScanning() const;
+
+    /**
+     * @brief Stop background directory scans; queued entries are kept
+     */
+    void cancelScan();
+
+    /**
+     * @brief Wait for background directory scans to finish
+     * @param timeoutMs Timeout in milliseconds (-1 = infinite)
+     * @return true if no scan is running anymore
+     */
+    bool waitForScan(int timeoutMs = -1);
+
     /**
      * @brief Add multiple files to write queue
      * @param files List of local file paths
@@ -211,6 +349,35 @@ public:
      */
     void addFiles(const QStringList &files, const QString &destDir = QString());
 
+    /**
+     * @brief Add a stream of unknown length to write queue
+     *
+     * The data takes the same path as a file: read-ahead ring, hashing
+     * on the hash thread and the drive's command pipeline. Its length
+     * and extent go into the index once the stream ends.
+     *
+     * The stream is read on the worker thread. TapeIO takes ownership
+     * and moves the device off its thread, so call this from the thread
+     * the device lives in, pass a device without a parent and do not
+     * use it afterwards. The stream ends when read() returns 0 on a
+     * QFile (stdin, a pipe, a FIFO, or a socket descriptor opened with
+     * QFile::open()) or -1 on a socket whose peer closed the connection.
+     *
+     * Streams are never packed, spanned, skipped as duplicates or
+     * resumed from the journal, since they cannot be read twice.
+     *
+     * @param device Source of the data, open for reading
+     * @param destPath Destination path on tape (relative to root)
+     * @param modifiedTime Modification time for the index (invalid = now)
+     */
+    void addStream(QIODevice *device, const QString &destPath, const QDateTime &modifiedTime = QDateTime());
+
+    /**
+     * @brief Add already prepared items to write queue
+     * @param items Items as returned by items() of another TapeIO
+     */
+    void addItems(const QList<TransferItem> &items);
+
     /**
      * @brief Clear pending write queue
      */
@@ -228,10 +395,39 @@ public:
 
     /**
      * @brief Start writing queued files to tape
+     *
+     * Returns immediately; the transfer runs on the worker thread. Use
+     * waitForCompletion() or transferCompleted() to know when it ends.
+     *
+     * With TransferOptions::journalPath set, every item is journaled
+     * once it is on tape. If the journal already holds records for this
+     * cartridge, the end of data is checked against them first: records
+     * past it are dropped, and queued items matching the rest (same
+     * destination, size and modification time) are marked completed and
+     * added to the index without being written again.
+     *
      * @return true if started successfully
      */
     bool startWrite();
 
+    /**
+     * @brief Set the handler writing index checkpoints during writes
+     *
+     * Called on the worker thread every TransferOptions::checkpointBytes
+     * of file data, with the tape at end of data behind a filemark. The
+     * handler writes the index of pathIndex() to tape; each successful
+     * checkpoint is journaled.
+     */
+    void setCheckpointHandler(IndexCheckpointHandler handler);
+
+    /**
+     * @brief Delete the journal at TransferOptions::journalPath
+     *
+     * Call once the final index of the job is on tape; otherwise the
+     * next startWrite() with this journal resumes from it.
+     */
+    bool removeJournal();
+
     // === Read Operations ===
 
     /**
@@ -257,15 +453,87 @@ public:
      */
     bool readFiles(const QList<LtfsFile> &files, const QString &destDir);
 
+    /**
+     * @brief Stream files from tape as a tar archive
+     *
+     * Writes a POSIX (pax) tar stream straight to @p sink, without
+     * staging anything on local disk. Files are read in restore order
+     * (see scheduleRestore()) through the same ring and drain thread as
+     * readFile(), so the drive streams at full speed as long as the sink
+     * keeps up; a socket or pipe that lags holds the drive back instead
+     * of piling data up in memory. Recorded hashes are checked in flight
+     * like on restore.
+     *
+     * A file that cannot be read is padded out with zeros and reported
+     * through fileError(), so the archive stays well formed. Writing to
+     * the sink failing ends the archive.
+     *
+     * @param files Files to export
+     * @param paths Path of each file inside the archive
+     * @param sink Open, writable device without a parent owned by the
+     *             calling thread, e.g. a QFile on stdout or a socket
+     * @return true if every file was exported
+     */
+    bool exportFiles(const QList<LtfsFile> &files, const QStringList &paths, QIODevice *sink);
+
+    /**
+     * @brief Stream a directory from tape as a tar archive (recursive)
+     *
+     * Like exportFiles(); all directory entries are written first, with
+     * paths relative to and starting with @p tapeDir.
+     */
+    bool exportDirectory(const LtfsDirectory &tapeDir, QIODevice *sink);
+
+    /**
+     * @brief Order files for restore by their position on tape
+     *
+     * Files are sorted by partition and start block of their first
+     * extent, so a restore sweeps the tape instead of locating back and
+     * forth. With TransferOptions::useRecommendedAccessOrder the drive's
+     * Recommended Access Order is applied on top where supported. When
+     * the next file starts a short way ahead, the gap is read through
+     * and discarded instead of located (see
+     * TransferOptions::maxReadThroughBytes), keeping the drive streaming.
+     *
+     * @param files Files to restore
+     * @return Indices into @p files in read order
+     */
+    QList<int> scheduleRestore(const QList<LtfsFile> &files);
+
     // === Verification ===
 
     /**
-     * @brief Verify file on tape matches local file
+     * @brief Verify a file on tape against its recorded hash
+     *
+     * Locates to the file's extents and streams its blocks through the
+     * hash in memory; nothing is written to disk. The reference is the
+     * file's extended attribute for TransferOptions::hashMode, or the
+     * hash of @p localPath if the index carries none.
+     *
      * @param tapeFile File entry from index
-     * @param localPath Local file path
+     * @param localPath Optional local copy used when no hash is recorded
      * @return true if verification passed
      */
-    bool verifyFile(const LtfsFile &tapeFile, const QString &localPath);
+    bool verifyFile(const LtfsFile &tapeFile, const QString &localPath = QString());
+
+    /**
+     * @brief Verify several files in one pass in tape order
+     *
+     * Files are ordered like a restore (see scheduleRestore()), so a
+     * run of adjacent files is read sequentially without locates. Files
+     * without a recorded hash are skipped and counted in
+     * TransferStats::skippedFiles.
+     *
+     * @param files Files to verify
+     * @return true if every file with a recorded hash matched
+     */
+    bool verifyFiles(const QList<LtfsFile> &files);
+
+    /**
+     * @brief Verify every file in the current index in one tape pass
+     * @return true if every file with a recorded hash matched
+     */
+    bool verifyIndex();
 
     /**
      * @brief Calculate and store hash for file
@@ -315,16 +583,51 @@ public:
      */
     TransferStats statistics() const;
 
+    /**
+     * @brief Live progress counters of the current transfer
+     *
+     * Updated after every block without locking or signalling; poll
+     * TransferProgress::snapshot() from a timer at the display's own
+     * rate. Lives as long as this TapeIO.
+     */
+    const TransferProgress &progress() const;
+
     /**
      * @brief Get list of transfer items
+     *
+     * Copies the whole queue; prefer the paged overload for large queues.
      */
     QList<TransferItem> items() const;
 
+    /**
+     * @brief Get a page of transfer items
+     * @param first Index of the first item
+     * @param count Number of items (-1 = up to the end)
+     */
+    QList<TransferItem> items(int first, int count) const;
+
+    /**
+     * @brief Get one transfer item (default item if out of range)
+     */
+    TransferItem item(int index) const;
+
     /**
      * @brief Get failed items
      */
     QList<TransferItem> failedItems() const;
 
+    /**
+     * @brief Get a page of failed items
+     * @param first Number of failed items to skip
+     * @param count Number of items (-1 = all)
+     */
+    QList<TransferItem> failedItems(int first, int count) const;
+
+    /**
+     * @brief Number of queued items with a status, without copying the queue
+     */
+    int itemCount(TransferStatus status) const;
+
     /**
      * @brief Get last error message
      */
@@ -342,7 +645,9 @@ signals:
     void fileStarted(const TransferItem &item);
 
     /**
-     * @brief Emitted during file transfer
+     * @brief Emitted during file transfer, at most ten times a second
+     *
+     * @p totalBytes is 0 while a stream of unknown length is written.
      */
     void fileProgress(const TransferItem &item, qint64 bytesTransferred, qint64 totalBytes);
 
@@ -362,10 +667,15 @@ signals:
     void transferCompleted(const TransferStats &stats);
 
     /**
-     * @brief Emitted on overall progress change
+     * @brief Emitted on overall progress change, at most ten times a second
      */
     void progressChanged(int percent, const TransferStats &stats);
 
+    /**
+     * @brief Emitted for each drive telemetry sample taken during a write
+     */
+    void telemetrySampled(const DriveTelemetrySample &sample);
+
     /**
      * @brief Emitted when running state changes
      */
@@ -386,9 +696,29 @@ private:
     Private *d;
 
     bool writeFileToTape(TransferItem &item);
+    bool writePackedFile(TransferItem &item);
+    bool flushPack(bool keepPacking = false);
+    void failPackedRun(const QString &reason);
+    bool openJournal();
+    void writeCheckpoint();
+    void addToIndex(const TransferItem &item, qint64 byteCount, quint64 startBlock, quint32 byteOffset,
+                    qint64 fileLength = -1);
     bool readFileFromTape(TransferItem &item);
-    bool verifyFileHash(TransferItem &item);
+    bool verifyFileOnTape(TransferItem &item);
+    bool streamFromTape(TransferItem &item, QIODevice *sink, HashCalculator *hasher,
+                        bool *sinkFailed = nullptr);
+    bool checkHash(TransferItem &item, const HashCalculator &hasher);
+    bool locateFile(const LtfsFile &tapeFile, TransferItem &item);
+    void collectFiles(const LtfsDirectory &tapeDir, QList<LtfsFile> &files) const;
+    bool collectDirectory(const LtfsDirectory &tapeDir, const QString &destPath,
+                          QList<LtfsFile> &files, QStringList &destPaths);
+    bool canExport(QIODevice *sink);
+    bool collectArchive(const LtfsDirectory &tapeDir, const QString &archivePath, TarWriter &tar,
+                        QList<LtfsFile> &files, QStringList &paths);
+    bool exportToTar(TarWriter &tar, const QList<LtfsFile> &files, const QStringList &paths,
+                     QIODevice *sink);
     void updateStatistics();
+    void sampleTelemetry();
     void processQueue();
 };
 
@@ -0,0 +1,225 @@
+/*
+ * QLTOTapeMan - Qt-based LTO Tape Manager
+ * libqltfs - LTFS Core Library
+ *
+ * Copyright (c) 2026 Jeffrey ZHU (zhxsh1225@gmail.com)
+ * https://github.com/Gypsop/QLTOTapeMan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "TarWriter.h"
+
+#include <QFileDevice>
+
+#include <cstdio>
+#include <cstring>
+
+namespace qltfs {
+
+// ustar field limits; anything beyond goes into a pax extended header
+static constexpr int NAME_LENGTH = 100;
+static constexpr qint64 MAX_OCTAL_SIZE = 077777777777LL;   // 11 octal digits
+static constexpr qint64 MAX_OCTAL_TIME = 077777777777LL;
+
+// Longest wait for a socket or pipe consumer to take written data
+static constexpr int SINK_WRITE_TIMEOUT_MS = 60000;
+
+namespace {
+
+void writeOctal(char *field, int width, qint64 value)
+{
+    // width - 1 digits and a terminating NUL
+    std::snprintf(field, static_cast<size_t>(width), "%0*llo", width - 1, static_cast<unsigned long long>(value));
+}
+
+bool isAscii(const QByteArray &text)
+{
+    for (char c : text) {
+        if (static_cast<unsigned char>(c) >= 0x80) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief One "length key=value\n" record; the length counts itself
+ */
+QByteArray paxRecord(const QByteArray &key, const QByteArray &value)
+{
+    const qsizetype body = 1 + key.size() + 1 + value.size() + 1;  // ' ' key '=' value '\n'
+    qsizetype length = body + 1;
+    while (QByteArray::number(length).size() + body != length) {
+        length = QByteArray::number(length).size() + body;
+    }
+    return QByteArray::number(length) + ' ' + key + '=' + value + '\n';
+}
+
+} // namespace
+
+TarWriter::TarWriter(QIODevice *device)
+    : m_device(device)
+{
+}
+
+bool TarWriter::addDirectory(const QString &path, const QDateTime &modified)
+{
+    return writeEntry(path + QLatin1Char('/'), '5', 0, modified, 0755);
+}
+
+bool TarWriter::beginFile(const QString &path, qint64 size, const QDateTime &modified, bool readOnly)
+{
+    if (m_entrySize >= 0) {
+        m_lastError = QStringLiteral("Previous file entry not closed");
+        return false;
+    }
+    if (!writeEntry(path, '0', size, modified, readOnly ? 0444 : 0644)) {
+        return false;
+    }
+    m_entrySize = size;
+    return true;
+}
+
+bool TarWriter::endFile(qint64 written)
+{
+    if (m_entrySize < 0 || written > m_entrySize) {
+        m_lastError = QStringLiteral("File entry not open or overrun");
+        return false;
+    }
+
+    const qint64 size = m_entrySize;
+    m_entrySize = -1;
+    const qint64 tail = size % BLOCK_SIZE;
+    return writeZeros(size - written + (tail ? BLOCK_SIZE - tail : 0));
+}
+
+bool TarWriter::finish()
+{
+    if (!writeZeros(2 * BLOCK_SIZE)) {
+        return false;
+    }
+    if (auto *file = qobject_cast<QFileDevice *>(m_device); file && !file->flush()) {
+        m_lastError = file->errorString();
+        return false;
+    }
+    return true;
+}
+
+bool TarWriter::writeFully(QIODevice *device, const char *data, qint64 length, QString &error)
+{
+    // Files block in write(); sockets queue the data and need a push
+    const bool queued = !qobject_cast<QFileDevice *>(device);
+
+    qint64 done = 0;
+    while (done < length) {
+        const qint64 n = device->write(data + done, length - done);
+        if (n < 0) {
+            error = device->errorString();
+            return false;
+        }
+        done += n;
+
+        while (queued && device->bytesToWrite() > 0) {
+            if (!device->waitForBytesWritten(SINK_WRITE_TIMEOUT_MS)) {
+                error = device->errorString();
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool TarWriter::writeEntry(const QString &path, char type, qint64 size, const QDateTime &modified, int mode)
+{
+    const QByteArray name = path.toUtf8();
+    const qint64 msecs = modified.isValid() ? modified.toMSecsSinceEpoch() : 0;
+    const qint64 seconds = msecs >= 0 ? msecs / 1000 : -((-msecs + 999) / 1000);
+
+    PaxRecords pax;
+    if (name.size() > NAME_LENGTH || !isAscii(name)) {
+        pax.append(qMakePair(QByteArray("path"), name));
+    }
+    if (size > MAX_OCTAL_SIZE) {
+        pax.append(qMakePair(QByteArray("size"), QByteArray::number(size)));
+    }
+    if (msecs % 1000 != 0 || seconds < 0 || seconds > MAX_OCTAL_TIME) {
+        pax.append(qMakePair(QByteArray("mtime"), QByteArray::number(msecs / 1000.0, 'f', 3)));
+    }
+
+    if (!pax.isEmpty()) {
+        QByteArray records;
+        for (const auto &record : pax) {
+            records += paxRecord(record.first, record.second);
+        }
+
+        // Readers without pax support extract the records as a file here
+        const QByteArray baseName = name.mid(name.lastIndexOf('/', name.size() - 2) + 1).left(NAME_LENGTH - 10);
+        const qint64 tail = records.size() % BLOCK_SIZE;
+        QString error;
+        if (!writeHeader("PaxHeader/" + baseName, 'x', records.size(), qBound<qint64>(0, seconds, MAX_OCTAL_TIME), 0644) ||
+            !writeFully(m_device, records.constData(), records.size(), error)) {
+            if (!error.isEmpty()) {
+                m_lastError = error;
+            }
+            return false;
+        }
+        if (!writeZeros(tail ? BLOCK_SIZE - tail : 0)) {
+            return false;
+        }
+    }
+
+    return writeHeader(name.left(NAME_LENGTH), type, size > MAX_OCTAL_SIZE ? 0 : size,
+                       qBound<qint64>(0, seconds, MAX_OCTAL_TIME), mode);
+}
+
+bool TarWriter::writeHeader(const QByteArray &name, char type, qint64 size, qint64 mtime, int mode)
+{
+    char header[BLOCK_SIZE] = {};
+    std::memcpy(header, name.constData(), static_cast<size_t>(qMin<qsizetype>(name.size(), NAME_LENGTH)));
+    writeOctal(header + 100, 8, mode);
+    writeOctal(header + 108, 8, 0);         // uid
+    writeOctal(header + 116, 8, 0);         // gid
+    writeOctal(header + 124, 12, size);
+    writeOctal(header + 136, 12, mtime);
+    header[156] = type;
+    std::memcpy(header + 257, "ustar", 6);  // Magic with its NUL
+    std::memcpy(header + 263, "00", 2);
+
+    // Checksum over the header with the checksum field taken as spaces
+    std::memset(header + 148, ' ', 8);
+    unsigned int sum = 0;
+    for (char c : header) {
+        sum += static_cast<unsigned char>(c);
+    }
+    std::snprintf(header + 148, 7, "%06o", sum);
+    header[155] = ' ';
+
+    return writeFully(m_device, header, BLOCK_SIZE, m_lastError);
+}
+
+bool TarWriter::writeZeros(qint64 count)
+{
+    static const char zeros[BLOCK_SIZE * 2] = {};
+    while (count > 0) {
+        const qint64 chunk = qMin<qint64>(count, sizeof(zeros));
+        if (!writeFully(m_device, zeros, chunk, m_lastError)) {
+            return false;
+        }
+        count -= chunk;
+    }
+    return true;
+}
+
+} // namespace qltfs
@@ -0,0 +1,114 @@
+/*
+ * QLTOTapeMan - Qt-based LTO Tape Manager
+ * libqltfs - LTFS Core Library
+ *
+ * Copyright (c) 2026 Jeffrey ZHU (zhxsh1225@gmail.com)
+ * https://github.com/Gypsop/QLTOTapeMan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "libqltfs_global.h"
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QIODevice>
+#include <QList>
+#include <QPair>
+#include <QString>
+
+namespace qltfs {
+
+/**
+ * @brief Writes a POSIX (pax) tar stream to a device
+ *
+ * Entries are ustar headers, preceded by a pax extended header when a
+ * path is longer than the ustar name field or not ASCII, a file is
+ * larger than 8 GiB, or a timestamp needs sub-second precision. File
+ * data is written by the caller between beginFile() and endFile(),
+ * directly to the device or through writeFully(), so it can come
+ * straight from a ring slot without being copied.
+ *
+ * Sockets are waited on until each write has been sent, which bounds
+ * the memory they buffer and lets a slow consumer hold back the
+ * producer. Not thread-safe; calls may come from different threads
+ * one after the other.
+ */
+class LIBQLTFS_EXPORT TarWriter
+{
+public:
+    static constexpr int BLOCK_SIZE = 512;
+
+    explicit TarWriter(QIODevice *device);
+
+    // Disable copy
+    TarWriter(const TarWriter &) = delete;
+    TarWriter &operator=(const TarWriter &) = delete;
+
+    /**
+     * @brief Write the header of a directory entry
+     * @param path Path in the archive, without trailing slash
+     */
+    bool addDirectory(const QString &path, const QDateTime &modified);
+
+    /**
+     * @brief Write the header of a file entry; @p size bytes of data must follow
+     * @param path Path in the archive
+     * @param size Length of the file data
+     * @param modified Modification time
+     * @param readOnly Mark the file read-only (mode 0444 instead of 0644)
+     */
+    bool beginFile(const QString &path, qint64 size, const QDateTime &modified, bool readOnly = false);
+
+    /**
+     * @brief Close the current file entry
+     *
+     * Data short of the size announced in beginFile() is filled with
+     * zeros, so a file that failed part way keeps the archive readable.
+     *
+     * @param written Bytes of file data written since beginFile()
+     */
+    bool endFile(qint64 written);
+
+    /**
+     * @brief Write the end-of-archive marker and flush the device
+     */
+    bool finish();
+
+    /**
+     * @brief Get last error message
+     */
+    QString lastError() const { return m_lastError; }
+
+    /**
+     * @brief Write all of @p data, waiting on sockets until it has been sent
+     * @param error Set to the device's error message on failure
+     */
+    static bool writeFully(QIODevice *device, const char *data, qint64 length, QString &error);
+
+private:
+    using PaxRecords = QList<QPair<QByteArray, QByteArray>>;
+
+    bool writeEntry(const QString &path, char type, qint64 size, const QDateTime &modified, int mode);
+    bool writeHeader(const QByteArray &name, char type, qint64 size, qint64 mtime, int mode);
+    bool writeZeros(qint64 count);
+
+    QIODevice *m_device;
+    qint64 m_entrySize = -1;        ///< Data length of the open file entry, -1 = none
+    QString m_lastError;
+};
+
+} // namespace qltfs
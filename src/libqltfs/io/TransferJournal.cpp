@@ -0,0 +1,345 @@
+/*
+ * QLTOTapeMan - Qt-based LTO Tape Manager
+ * libqltfs - LTFS Core Library
+ *
+ * Copyright (c) 2026 Jeffrey ZHU (zhxsh1225@gmail.com)
+ * https://github.com/Gypsop/QLTOTapeMan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "TransferJournal.h"
+#include "HashKernels.h"
+
+#include <QDataStream>
+#include <QFile>
+#include <QtEndian>
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace qltfs {
+
+// Identifies the header frame
+static constexpr quint32 JOURNAL_MAGIC = 0x514C4A4E;   // "QLJN"
+static constexpr quint16 JOURNAL_VERSION = 2;
+
+// Oldest version still read; it has no Started records
+static constexpr quint16 JOURNAL_MIN_VERSION = 1;
+
+// Frame prefix: payload length and CRC32C of the payload, little endian
+static constexpr int FRAME_HEADER_SIZE = 8;
+
+// Larger frames can only come from a damaged file
+static constexpr quint32 MAX_FRAME_SIZE = 1024 * 1024;
+
+namespace {
+
+QByteArray encodeRecord(const JournalRecord &record)
+{
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << static_cast<quint8>(record.kind)
+        << record.sourcePath << record.destPath << record.size << record.modifiedTime
+        << record.sourceOffset << record.sourceLength
+        << record.startBlock << record.byteOffset << record.byteCount << record.fileLength
+        << record.endBlock << record.sourceHash << record.fastHash;
+    return payload;
+}
+
+bool decodeRecord(const QByteArray &payload, JournalRecord &record)
+{
+    QDataStream in(payload);
+    in.setVersion(QDataStream::Qt_6_0);
+    quint8 kind = 0;
+    in >> kind
+       >> record.sourcePath >> record.destPath >> record.size >> record.modifiedTime
+       >> record.sourceOffset >> record.sourceLength
+       >> record.startBlock >> record.byteOffset >> record.byteCount >> record.fileLength
+       >> record.endBlock >> record.sourceHash >> record.fastHash;
+    record.kind = static_cast<JournalRecord::Kind>(kind);
+    return in.status() == QDataStream::Ok && kind >= 1 && kind <= 4;
+}
+
+QByteArray frame(const QByteArray &payload)
+{
+    QByteArray bytes(FRAME_HEADER_SIZE, Qt::Uninitialized);
+    qToLittleEndian<quint32>(static_cast<quint32>(payload.size()), bytes.data());
+    qToLittleEndian<quint32>(Crc32c::extend(0, payload.constData(), payload.size()), bytes.data() + 4);
+    return bytes + payload;
+}
+
+// Read the next frame; false at the end of the file or on a torn frame
+bool readFrame(QFile &file, QByteArray &payload)
+{
+    char header[FRAME_HEADER_SIZE];
+    if (file.read(header, FRAME_HEADER_SIZE) != FRAME_HEADER_SIZE) {
+        return false;
+    }
+
+    const quint32 length = qFromLittleEndian<quint32>(header);
+    const quint32 crc = qFromLittleEndian<quint32>(header + 4);
+    if (length > MAX_FRAME_SIZE) {
+        return false;
+    }
+
+    payload = file.read(length);
+    return payload.size() == static_cast<int>(length) &&
+           Crc32c::extend(0, payload.constData(), payload.size()) == crc;
+}
+
+// Push written data through the OS cache to the disk
+bool syncFile(QFile &file)
+{
+    if (!file.flush()) {
+        return false;
+    }
+#if defined(Q_OS_WIN)
+    return FlushFileBuffers(reinterpret_cast<HANDLE>(_get_osfhandle(file.handle()))) != 0;
+#else
+    return ::fsync(file.handle()) == 0;
+#endif
+}
+
+} // namespace
+
+// ============================================================================
+// TransferJournal Private Implementation
+// ============================================================================
+
+class TransferJournal::Private
+{
+public:
+    QFile file;
+    QString volumeId;
+    QList<JournalRecord> records;
+    QList<qint64> recordEnds;       ///< File offset after each record
+    qint64 headerEnd = 0;
+    QString lastError;
+
+    bool writeFrames(const QByteArray &bytes)
+    {
+        if (file.write(bytes) != bytes.size() || !syncFile(file)) {
+            lastError = QStringLiteral("Cannot write journal: %1").arg(file.errorString());
+            return false;
+        }
+        return true;
+    }
+
+    bool load(const QString &expectedVolume);
+};
+
+bool TransferJournal::Private::load(const QString &expectedVolume)
+{
+    QByteArray payload;
+    if (!readFrame(file, payload)) {
+        lastError = QStringLiteral("%1 is not a transfer journal").arg(file.fileName());
+        return false;
+    }
+
+    QDataStream in(payload);
+    in.setVersion(QDataStream::Qt_6_0);
+    quint32 magic = 0;
+    quint16 version = 0;
+    in >> magic >> version >> volumeId;
+    if (in.status() != QDataStream::Ok || magic != JOURNAL_MAGIC ||
+        version < JOURNAL_MIN_VERSION || version > JOURNAL_VERSION) {
+        lastError = QStringLiteral("%1 is not a transfer journal").arg(file.fileName());
+        return false;
+    }
+    if (volumeId != expectedVolume) {
+        lastError = QStringLiteral("Journal belongs to volume %1, not %2").arg(volumeId, expectedVolume);
+        return false;
+    }
+    headerEnd = file.pos();
+
+    qint64 end = headerEnd;
+    while (readFrame(file, payload)) {
+        JournalRecord record;
+        if (!decodeRecord(payload, record)) {
+            break;
+        }
+        records.append(record);
+        end = file.pos();
+        recordEnds.append(end);
+    }
+
+    // Drop a frame torn by a crash so appends follow valid data
+    if (end != file.size() && !file.resize(end)) {
+        lastError = QStringLiteral("Cannot repair journal: %1").arg(file.errorString());
+        return false;
+    }
+    return file.seek(end);
+}
+
+// ============================================================================
+// TransferJournal Implementation
+// ============================================================================
+
+TransferJournal::TransferJournal()
+    : d(new Private)
+{
+}
+
+TransferJournal::~TransferJournal()
+{
+    close();
+    delete d;
+}
+
+bool TransferJournal::open(const QString &path, const QString &volumeId)
+{
+    close();
+
+    // An unnamed cartridge would match any other unnamed one
+    if (volumeId.isEmpty()) {
+        d->lastError = QStringLiteral("Cannot open journal %1: no volume id").arg(path);
+        return false;
+    }
+
+    d->file.setFileName(path);
+    if (!d->file.open(QIODevice::ReadWrite)) {
+        d->lastError = QStringLiteral("Cannot open journal %1: %2").arg(path, d->file.errorString());
+        return false;
+    }
+
+    if (d->file.size() > 0) {
+        if (!d->load(volumeId)) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    QByteArray header;
+    QDataStream out(&header, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << JOURNAL_MAGIC << JOURNAL_VERSION << volumeId;
+    if (!d->writeFrames(frame(header))) {
+        close();
+        return false;
+    }
+
+    d->volumeId = volumeId;
+    d->headerEnd = d->file.pos();
+    return true;
+}
+
+void TransferJournal::close()
+{
+    d->file.close();
+    d->volumeId.clear();
+    d->records.clear();
+    d->recordEnds.clear();
+    d->headerEnd = 0;
+}
+
+bool TransferJournal::isOpen() const
+{
+    return d->file.isOpen();
+}
+
+QString TransferJournal::path() const
+{
+    return d->file.fileName();
+}
+
+QString TransferJournal::volumeId() const
+{
+    return d->volumeId;
+}
+
+const QList<JournalRecord> &TransferJournal::records() const
+{
+    return d->records;
+}
+
+int TransferJournal::lastCheckpoint() const
+{
+    for (int i = d->records.size() - 1; i >= 0; --i) {
+        if (d->records[i].kind == JournalRecord::Kind::Checkpoint) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+bool TransferJournal::append(const JournalRecord &record)
+{
+    return append(QList<JournalRecord>{record});
+}
+
+bool TransferJournal::append(const QList<JournalRecord> &records)
+{
+    if (!d->file.isOpen()) {
+        d->lastError = QStringLiteral("Journal is not open");
+        return false;
+    }
+    if (records.isEmpty()) {
+        return true;
+    }
+
+    // One write and one sync for the whole batch
+    QByteArray bytes;
+    QList<qint64> ends;
+    qint64 end = d->file.pos();
+    for (const JournalRecord &record : records) {
+        bytes += frame(encodeRecord(record));
+        ends.append(end + bytes.size());
+    }
+
+    if (!d->writeFrames(bytes)) {
+        return false;
+    }
+    d->records.append(records);
+    d->recordEnds.append(ends);
+    return true;
+}
+
+bool TransferJournal::truncate(int count)
+{
+    if (!d->file.isOpen()) {
+        d->lastError = QStringLiteral("Journal is not open");
+        return false;
+    }
+    if (count < 0 || count >= d->records.size()) {
+        return true;
+    }
+
+    const qint64 end = count == 0 ? d->headerEnd : d->recordEnds[count - 1];
+    if (!d->file.resize(end) || !d->file.seek(end) || !syncFile(d->file)) {
+        d->lastError = QStringLiteral("Cannot truncate journal: %1").arg(d->file.errorString());
+        return false;
+    }
+    d->records.resize(count);
+    d->recordEnds.resize(count);
+    return true;
+}
+
+bool TransferJournal::remove(const QString &path)
+{
+    return !QFile::exists(path) || QFile::remove(path);
+}
+
+QString TransferJournal::lastError() const
+{
+    return d->lastError;
+}
+
+} // namespace qltfs
@@ -0,0 +1,145 @@
+/*
+ * QLTOTapeMan - Qt-based LTO Tape Manager
+ * libqltfs - LTFS Core Library
+ *
+ * Copyright (c) 2026 Jeffrey ZHU (zhxsh1225@gmail.com)
+ * https://github.com/Gypsop/QLTOTapeMan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "libqltfs_global.h"
+
+#include <QDateTime>
+#include <QList>
+#include <QString>
+
+namespace qltfs {
+
+/**
+ * @brief One entry of a transfer journal
+ */
+struct LIBQLTFS_EXPORT JournalRecord {
+    /**
+     * @brief What the record describes
+     */
+    enum class Kind : quint8 {
+        Directory = 1,          ///< Directory entry created in the index
+        File = 2,               ///< File (or spanned segment) written to tape
+        Checkpoint = 3,         ///< Index written to tape by the checkpoint handler
+        Started = 4             ///< Write begun at startBlock; endBlock bounds it (0 = unbounded)
+    };
+
+    Kind kind = Kind::File;
+
+    // Item as queued
+    QString sourcePath;
+    QString destPath;
+    qint64 size = 0;                ///< Source file size when written
+    QDateTime modifiedTime;         ///< Source modification time when written
+    qint64 sourceOffset = 0;
+    qint64 sourceLength = -1;
+
+    // Where the data went
+    quint64 startBlock = 0;         ///< First block of the file data
+    quint32 byteOffset = 0;         ///< Offset of the data in its first block (packed files)
+    qint64 byteCount = 0;           ///< Bytes of file data on tape
+    qint64 fileLength = -1;         ///< Length recorded in the index (-1 = byteCount)
+    quint64 endBlock = 0;           ///< Position after the data and its filemark (0 = no tape data)
+
+    // Hashes of the source, as recorded in the index
+    QString sourceHash;
+    QString fastHash;
+};
+
+/**
+ * @brief Append-only, crash-safe record of what reached tape
+ *
+ * Each record is appended as one checksummed frame and synced to disk
+ * before append() returns, so after a crash or power loss the journal
+ * holds every record that was appended and at most one torn frame at
+ * the end. open() drops such a frame. A journal belongs to one
+ * cartridge, identified by the volume id given when it is created.
+ *
+ * Records are only appended after their data is on tape (behind a
+ * filemark), so positions in the journal never run ahead of the
+ * cartridge. The one exception is a Started record, appended before a
+ * write begins, so a resume can tell the partial data of that write
+ * from data appended to the cartridge by anything else. Not thread-safe.
+ */
+class LIBQLTFS_EXPORT TransferJournal
+{
+public:
+    TransferJournal();
+    ~TransferJournal();
+
+    // Disable copy
+    TransferJournal(const TransferJournal &) = delete;
+    TransferJournal &operator=(const TransferJournal &) = delete;
+
+    /**
+     * @brief Open a journal, creating it if it does not exist
+     *
+     * Records of an existing journal are loaded.
+     *
+     * @param path Journal file path
+     * @param volumeId Identity of the cartridge (not empty); must match an existing journal's
+     * @return true on success
+     */
+    bool open(const QString &path, const QString &volumeId);
+
+    void close();
+    bool isOpen() const;
+    QString path() const;
+    QString volumeId() const;
+
+    /**
+     * @brief Records loaded or appended so far
+     */
+    const QList<JournalRecord> &records() const;
+
+    /**
+     * @brief Index of the last checkpoint record, or -1
+     */
+    int lastCheckpoint() const;
+
+    /**
+     * @brief Append records and sync them to disk
+     */
+    bool append(const JournalRecord &record);
+    bool append(const QList<JournalRecord> &records);
+
+    /**
+     * @brief Drop every record from @p count on
+     */
+    bool truncate(int count);
+
+    /**
+     * @brief Delete a journal file that is not open
+     */
+    static bool remove(const QString &path);
+
+    /**
+     * @brief Get last error message
+     */
+    QString lastError() const;
+
+private:
+    class Private;
+    Private *d;
+};
+
+} // namespace qltfs
@@ -0,0 +1,155 @@
+/*
+ * QLTOTapeMan - Qt-based LTO Tape Manager
+ * libqltfs - LTFS Core Library
+ *
+ * Copyright (c) 2026 Jeffrey ZHU (zhxsh1225@gmail.com)
+ * https://github.com/Gypsop/QLTOTapeMan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "TransferProgress.h"
+
+namespace qltfs {
+
+// ============================================================================
+// TransferProgressSnapshot Implementation
+// ============================================================================
+
+int TransferProgressSnapshot::progressPercent() const
+{
+    if (totalBytes <= 0) {
+        return totalFiles > 0 ? static_cast<int>(completedFiles * 100 / totalFiles) : 0;
+    }
+    return static_cast<int>(qBound<qint64>(0, completedBytes * 100 / totalBytes, 100));
+}
+
+int TransferProgressSnapshot::bufferFillPercent() const
+{
+    if (bufferCapacity <= 0) {
+        return 0;
+    }
+    return bufferFill * 100 / bufferCapacity;
+}
+
+// ============================================================================
+// TransferProgress Implementation
+// ============================================================================
+
+void TransferProgress::reset()
+{
+    store(TransferStats());
+    setCurrentFile(-1, 0, 0);
+}
+
+void TransferProgress::store(const TransferStats &stats)
+{
+    // A single writer, and readers only need each counter to be whole
+    m_totalFiles.store(stats.totalFiles, std::memory_order_relaxed);
+    m_totalBytes.store(stats.totalBytes, std::memory_order_relaxed);
+    m_completedFiles.store(stats.completedFiles, std::memory_order_relaxed);
+    m_completedBytes.store(stats.completedBytes, std::memory_order_relaxed);
+    m_failedFiles.store(stats.failedFiles, std::memory_order_relaxed);
+    m_skippedFiles.store(stats.skippedFiles, std::memory_order_relaxed);
+    m_bufferFill.store(stats.bufferFill, std::memory_order_relaxed);
+    m_bufferCapacity.store(stats.bufferCapacity, std::memory_order_relaxed);
+}
+
+void TransferProgress::setCurrentFile(int index, qint64 bytes, qint64 size)
+{
+    m_currentItem.store(index, std::memory_order_relaxed);
+    m_currentFileBytes.store(bytes, std::memory_order_relaxed);
+    m_currentFileSize.store(size, std::memory_order_relaxed);
+}
+
+TransferProgressSnapshot TransferProgress::snapshot() const
+{
+    TransferProgressSnapshot snapshot;
+    snapshot.totalFiles = m_totalFiles.load(std::memory_order_relaxed);
+    snapshot.totalBytes = m_totalBytes.load(std::memory_order_relaxed);
+    snapshot.completedFiles = m_completedFiles.load(std::memory_order_relaxed);
+    snapshot.completedBytes = m_completedBytes.load(std::memory_order_relaxed);
+    snapshot.failedFiles = m_failedFiles.load(std::memory_order_relaxed);
+    snapshot.skippedFiles = m_skippedFiles.load(std::memory_order_relaxed);
+    snapshot.currentItem = m_currentItem.load(std::memory_order_relaxed);
+    snapshot.currentFileBytes = m_currentFileBytes.load(std::memory_order_relaxed);
+    snapshot.currentFileSize = m_currentFileSize.load(std::memory_order_relaxed);
+    snapshot.bufferFill = m_bufferFill.load(std::memory_order_relaxed);
+    snapshot.bufferCapacity = m_bufferCapacity.load(std::memory_order_relaxed);
+    return snapshot;
+}
+
+// ============================================================================
+// ThroughputEstimator Implementation
+// ============================================================================
+
+ThroughputEstimator::ThroughputEstimator(qint64 windowMs)
+    : m_windowMs(qMax<qint64>(windowMs, CAPACITY))
+{
+}
+
+void ThroughputEstimator::reset()
+{
+    m_newest = -1;
+    m_count = 0;
+}
+
+void ThroughputEstimator::addSample(qint64 timeMs, qint64 bytes)
+{
+    // A counter or clock that went backwards belongs to a new transfer
+    if (m_count > 0 && (timeMs < sampleAt(0).timeMs || bytes < sampleAt(0).bytes)) {
+        reset();
+    }
+
+    if (m_count >= 2 && timeMs - sampleAt(1).timeMs < m_windowMs / CAPACITY) {
+        m_samples[m_newest] = {timeMs, bytes};
+    } else {
+        m_newest = (m_newest + 1) % CAPACITY;
+        m_samples[m_newest] = {timeMs, bytes};
+        m_count = qMin(m_count + 1, CAPACITY);
+    }
+
+    // Keep one sample at or before the start of the window, so the
+    // rate spans a full window once one has passed
+    while (m_count > 2 && timeMs - sampleAt(m_count - 2).timeMs >= m_windowMs) {
+        --m_count;
+    }
+}
+
+double ThroughputEstimator::bytesPerSecond() const
+{
+    if (m_count < 2) {
+        return 0.0;
+    }
+
+    const Sample &newest = sampleAt(0);
+    const Sample &oldest = sampleAt(m_count - 1);
+    const qint64 span = newest.timeMs - oldest.timeMs;
+    if (span <= 0) {
+        return 0.0;
+    }
+    return static_cast<double>(newest.bytes - oldest.bytes) * 1000.0 / span;
+}
+
+qint64 ThroughputEstimator::estimatedRemainingMs(qint64 remainingBytes) const
+{
+    const double rate = bytesPerSecond();
+    if (rate <= 0.0 || remainingBytes <= 0) {
+        return 0;
+    }
+    return static_cast<qint64>(remainingBytes * 1000.0 / rate);
+}
+
+} // namespace qltfs
@@ -0,0 +1,181 @@
+/*
+ * QLTOTapeMan - Qt-based LTO Tape Manager
+ * libqltfs - LTFS Core Library
+ *
+ * Copyright (c) 2026 Jeffrey ZHU (zhxsh1225@gmail.com)
+ * https://github.com/Gypsop/QLTOTapeMan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "libqltfs_global.h"
+#include "io/TapeIO.h"
+
+#include <QtGlobal>
+
+#include <array>
+#include <atomic>
+
+namespace qltfs {
+
+/**
+ * @brief Point-in-time copy of a transfer's progress counters
+ */
+struct LIBQLTFS_EXPORT TransferProgressSnapshot {
+    qint64 totalFiles = 0;
+    qint64 totalBytes = 0;
+    qint64 completedFiles = 0;
+    qint64 completedBytes = 0;
+    qint64 failedFiles = 0;
+    qint64 skippedFiles = 0;
+
+    int currentItem = -1;           ///< Queue index of the file in progress (-1 = none)
+    qint64 currentFileBytes = 0;    ///< Bytes of the current file transferred so far
+    qint64 currentFileSize = 0;     ///< Size of the current file
+
+    int bufferFill = 0;             ///< Blocks read ahead and waiting to be written
+    int bufferCapacity = 0;         ///< Size of the read-ahead ring in blocks
+
+    /**
+     * @brief Get progress percentage (0-100)
+     */
+    int progressPercent() const;
+
+    /**
+     * @brief Get read-ahead ring fill level percentage (0-100)
+     */
+    int bufferFillPercent() const;
+};
+
+/**
+ * @brief Lock-free progress counters of a running transfer
+ *
+ * The transfer thread stores its counters after every block with
+ * relaxed atomic stores; any other thread polls snapshot() at whatever
+ * rate its display needs. Nothing is queued between the two, so the
+ * cost on the transfer thread does not depend on how often, or whether,
+ * anyone looks.
+ *
+ * Each counter is read atomically, but a snapshot taken while a block
+ * completes may mix counters from before and after it.
+ */
+class LIBQLTFS_EXPORT TransferProgress
+{
+public:
+    TransferProgress() = default;
+
+    // Disable copy
+    TransferProgress(const TransferProgress &) = delete;
+    TransferProgress &operator=(const TransferProgress &) = delete;
+
+    /**
+     * @brief Zero every counter
+     */
+    void reset();
+
+    /**
+     * @brief Store the transfer totals (transfer thread only)
+     */
+    void store(const TransferStats &stats);
+
+    /**
+     * @brief Store the progress of the file being transferred (transfer thread only)
+     */
+    void setCurrentFile(int index, qint64 bytes, qint64 size);
+
+    /**
+     * @brief Read the counters (any thread)
+     */
+    TransferProgressSnapshot snapshot() const;
+
+private:
+    std::atomic<qint64> m_totalFiles{0};
+    std::atomic<qint64> m_totalBytes{0};
+    std::atomic<qint64> m_completedFiles{0};
+    std::atomic<qint64> m_completedBytes{0};
+    std::atomic<qint64> m_failedFiles{0};
+    std::atomic<qint64> m_skippedFiles{0};
+    std::atomic<int> m_currentItem{-1};
+    std::atomic<qint64> m_currentFileBytes{0};
+    std::atomic<qint64> m_currentFileSize{0};
+    std::atomic<int> m_bufferFill{0};
+    std::atomic<int> m_bufferCapacity{0};
+};
+
+/**
+ * @brief Throughput over a sliding time window
+ *
+ * Fed with (time, byte counter) samples, reports the rate across the
+ * last window instead of the lifetime average, so speed and ETA follow
+ * changes such as a slow directory of small files or a drive that has
+ * started to back-hitch. Samples arriving closer together than
+ * window / capacity replace the newest one, so a fixed number of
+ * slots still covers the whole window at any sampling rate.
+ *
+ * Not thread-safe; each poller keeps its own.
+ */
+class LIBQLTFS_EXPORT ThroughputEstimator
+{
+public:
+    static constexpr qint64 DEFAULT_WINDOW_MS = 5000;
+
+    explicit ThroughputEstimator(qint64 windowMs = DEFAULT_WINDOW_MS);
+
+    /**
+     * @brief Forget all samples
+     */
+    void reset();
+
+    /**
+     * @brief Add a sample
+     * @param timeMs Monotonic time of the sample in milliseconds
+     * @param bytes Byte counter at that time (never decreasing)
+     */
+    void addSample(qint64 timeMs, qint64 bytes);
+
+    /**
+     * @brief Rate across the window in bytes per second (0 = not known yet)
+     */
+    double bytesPerSecond() const;
+
+    /**
+     * @brief Time to transfer the given bytes at the window rate (0 = not known)
+     */
+    qint64 estimatedRemainingMs(qint64 remainingBytes) const;
+
+    qint64 windowMs() const { return m_windowMs; }
+
+private:
+    static constexpr int CAPACITY = 64;
+
+    struct Sample {
+        qint64 timeMs;
+        qint64 bytes;
+    };
+
+    const Sample &sampleAt(int age) const
+    {
+        return m_samples[(m_newest + CAPACITY - age) % CAPACITY];
+    }
+
+    std::array<Sample, CAPACITY> m_samples{};
+    qint64 m_windowMs;
+    int m_newest = -1;              ///< Slot of the newest sample (-1 = empty)
+    int m_count = 0;
+};
+
+} // namespace qltfs
@@ -0,0 +1,340 @@
+/*
+ * QLTOTapeMan - Qt-based LTO Tape Manager
+ * libqltfs - LTFS Core Library
+ *
+ * Copyright (c) 2026 Jeffrey ZHU (zhxsh1225@gmail.com)
+ * https://github.com/Gypsop/QLTOTapeMan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "TransferQueue.h"
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+
+namespace qltfs {
+
+namespace {
+
+constexpr qint64 INVALID_TIME = std::numeric_limits<qint64>::min();
+
+} // namespace
+
+TransferQueue::TransferQueue()
+{
+}
+
+TransferQueue::~TransferQueue()
+{
+}
+
+void TransferQueue::append(const TransferItem &item)
+{
+    const PathRef source = addPath(item.sourcePath, nullptr);
+    const PathRef dest = addPath(item.destPath, &source);
+    const PathRef relative = addPath(item.relativePath, &dest);
+
+    m_sourcePaths.append(source);
+    m_destPaths.append(dest);
+    m_relativePaths.append(relative);
+    m_sizes.append(item.size);
+    m_modified.append(item.modifiedTime.isValid() ? item.modifiedTime.toMSecsSinceEpoch() : INVALID_TIME);
+    m_status.append(static_cast<quint8>(item.status));
+    m_flags.append((item.isDirectory ? FLAG_DIRECTORY : 0) | (item.hashVerified ? FLAG_HASH_VERIFIED : 0));
+
+    const int index = m_sizes.size() - 1;
+    setProgress(index, item);
+    if (item.isStream()) {
+        m_streams.insert(index, item.stream);
+    }
+
+    m_totalBytes += item.size;
+    m_counts[static_cast<int>(item.status)]++;
+    m_bytes[static_cast<int>(item.status)] += item.size;
+}
+
+void TransferQueue::append(const QList<TransferItem> &items)
+{
+    const int total = m_sizes.size() + items.size();
+    m_sourcePaths.reserve(total);
+    m_destPaths.reserve(total);
+    m_relativePaths.reserve(total);
+    m_sizes.reserve(total);
+    m_modified.reserve(total);
+    m_status.reserve(total);
+    m_flags.reserve(total);
+
+    for (const TransferItem &item : items) {
+        append(item);
+    }
+}
+
+void TransferQueue::clear()
+{
+    m_sourcePaths.clear();
+    m_destPaths.clear();
+    m_relativePaths.clear();
+    m_sizes.clear();
+    m_modified.clear();
+    m_status.clear();
+    m_flags.clear();
+    m_directories.clear();
+    m_directoryIds.clear();
+    m_names.clear();
+    m_progress.clear();
+    m_streams.clear();
+
+    m_totalBytes = 0;
+    std::fill(std::begin(m_counts), std::end(m_counts), 0);
+    std::fill(std::begin(m_bytes), std::end(m_bytes), 0);
+}
+
+void TransferQueue::remove(QList<int> indexes)
+{
+    std::sort(indexes.begin(), indexes.end());
+    indexes.erase(std::unique(indexes.begin(), indexes.end()), indexes.end());
+    indexes.erase(indexes.begin(), std::lower_bound(indexes.begin(), indexes.end(), 0));
+    if (indexes.isEmpty()) {
+        return;
+    }
+
+    // Compact every array in place; progress entries are keyed by index
+    // and are rebuilt under the new positions
+    QHash<int, Progress> progress;
+    QHash<int, QSharedPointer<QIODevice>> streams;
+    int next = 0;
+    int kept = 0;
+    for (int i = 0; i < size(); ++i) {
+        if (next < indexes.size() && indexes[next] == i) {
+            next++;
+            const int status = m_status[i];
+            m_counts[status]--;
+            m_bytes[status] -= m_sizes[i];
+            m_totalBytes -= m_sizes[i];
+            continue;
+        }
+
+        if (kept != i) {
+            m_sourcePaths[kept] = m_sourcePaths[i];
+            m_destPaths[kept] = m_destPaths[i];
+            m_relativePaths[kept] = m_relativePaths[i];
+            m_sizes[kept] = m_sizes[i];
+            m_modified[kept] = m_modified[i];
+            m_status[kept] = m_status[i];
+            m_flags[kept] = m_flags[i];
+        }
+        auto it = m_progress.find(i);
+        if (it != m_progress.end()) {
+            progress.insert(kept, std::move(it.value()));
+        }
+        auto stream = m_streams.find(i);
+        if (stream != m_streams.end()) {
+            streams.insert(kept, std::move(stream.value()));
+        }
+        kept++;
+    }
+
+    m_sourcePaths.resize(kept);
+    m_destPaths.resize(kept);
+    m_relativePaths.resize(kept);
+    m_sizes.resize(kept);
+    m_modified.resize(kept);
+    m_status.resize(kept);
+    m_flags.resize(kept);
+    m_progress.swap(progress);
+    m_streams.swap(streams);
+}
+
+TransferItem TransferQueue::at(int index) const
+{
+    TransferItem item;
+    item.sourcePath = path(m_sourcePaths[index]);
+    item.destPath = path(m_destPaths[index]);
+    item.relativePath = path(m_relativePaths[index]);
+    item.size = m_sizes[index];
+    item.status = status(index);
+    item.isDirectory = m_flags[index] & FLAG_DIRECTORY;
+    item.hashVerified = m_flags[index] & FLAG_HASH_VERIFIED;
+    if (m_modified[index] != INVALID_TIME) {
+        item.modifiedTime = QDateTime::fromMSecsSinceEpoch(m_modified[index]);
+    }
+
+    auto it = m_progress.constFind(index);
+    if (it != m_progress.constEnd()) {
+        item.bytesTransferred = it->bytesTransferred;
+        item.tapeByteOffset = it->tapeByteOffset;
+        item.sourceOffset = it->sourceOffset;
+        item.sourceLength = it->sourceLength;
+        item.errorMessage = it->errorMessage;
+        item.sourceHash = it->sourceHash;
+        item.destHash = it->destHash;
+        item.fastHash = it->fastHash;
+    }
+    item.stream = m_streams.value(index);
+    return item;
+}
+
+void TransferQueue::update(int index, const TransferItem &item)
+{
+    auto stream = m_streams.find(index);
+    if (stream != m_streams.end()) {
+        // Only known once the stream has been read
+        const int status = m_status[index];
+        const qint64 grown = item.size - m_sizes[index];
+        m_sizes[index] = item.size;
+        m_totalBytes += grown;
+        m_bytes[status] += grown;
+        if (!item.isStream()) {
+            m_streams.erase(stream);
+        }
+    }
+
+    changeStatus(index, item.status);
+    m_flags[index] = (m_flags[index] & ~FLAG_HASH_VERIFIED) | (item.hashVerified ? FLAG_HASH_VERIFIED : 0);
+    setProgress(index, item);
+}
+
+void TransferQueue::setStatus(int index, TransferStatus status)
+{
+    changeStatus(index, status);
+}
+
+void TransferQueue::changeStatus(int index, TransferStatus status)
+{
+    const int from = m_status[index];
+    const int to = static_cast<int>(status);
+    if (from == to) {
+        return;
+    }
+
+    m_counts[from]--;
+    m_bytes[from] -= m_sizes[index];
+    m_counts[to]++;
+    m_bytes[to] += m_sizes[index];
+    m_status[index] = static_cast<quint8>(to);
+}
+
+void TransferQueue::setProgress(int index, const TransferItem &item)
+{
+    if (item.bytesTransferred == 0 && item.tapeByteOffset == 0 && !item.isSegment() &&
+        item.errorMessage.isEmpty() && item.sourceHash.isEmpty() && item.destHash.isEmpty() && item.fastHash.isEmpty()) {
+        m_progress.remove(index);
+        return;
+    }
+
+    Progress &progress = m_progress[index];
+    progress.bytesTransferred = item.bytesTransferred;
+    progress.tapeByteOffset = item.tapeByteOffset;
+    progress.sourceOffset = item.sourceOffset;
+    progress.sourceLength = item.sourceLength;
+    progress.errorMessage = item.errorMessage;
+    progress.sourceHash = item.sourceHash;
+    progress.destHash = item.destHash;
+    progress.fastHash = item.fastHash;
+}
+
+QList<TransferItem> TransferQueue::items(int first, int count) const
+{
+    first = qBound(0, first, size());
+    const int last = count < 0 ? size() : qMin(size(), first + count);
+
+    QList<TransferItem> result;
+    result.reserve(last - first);
+    for (int i = first; i < last; ++i) {
+        result.append(at(i));
+    }
+    return result;
+}
+
+QList<TransferItem> TransferQueue::items(TransferStatus status, int first, int count) const
+{
+    QList<TransferItem> result;
+    if (count == 0) {
+        return result;
+    }
+
+    const quint8 wanted = static_cast<quint8>(status);
+    int skipped = 0;
+    for (int i = 0; i < size(); ++i) {
+        if (m_status[i] != wanted) {
+            continue;
+        }
+        if (skipped < first) {
+            skipped++;
+            continue;
+        }
+        result.append(at(i));
+        if (count > 0 && result.size() >= count) {
+            break;
+        }
+    }
+    return result;
+}
+
+qint64 TransferQueue::memoryUsage() const
+{
+    qint64 usage = 0;
+    usage += (m_sourcePaths.capacity() + m_destPaths.capacity() + m_relativePaths.capacity()) * qint64(sizeof(PathRef));
+    usage += (m_sizes.capacity() + m_modified.capacity()) * qint64(sizeof(qint64));
+    usage += m_status.capacity() + m_flags.capacity();
+    usage += m_names.capacity() * qint64(sizeof(QChar));
+    for (const QString &directory : m_directories) {
+        usage += directory.capacity() * qint64(sizeof(QChar)) * 2;  // List and hash key
+    }
+    usage += m_progress.size() * qint64(sizeof(Progress) + 4 * 64 * sizeof(QChar));
+    usage += m_streams.size() * qint64(sizeof(QSharedPointer<QIODevice>) + sizeof(int));
+    return usage;
+}
+
+TransferQueue::PathRef TransferQueue::addPath(const QString &path, const PathRef *sameName)
+{
+    const qsizetype slash = path.lastIndexOf(QLatin1Char('/'));
+    const QStringView directory = QStringView(path).left(slash + 1);
+    const QStringView name = QStringView(path).mid(slash + 1);
+
+    PathRef ref;
+
+    auto it = m_directoryIds.constFind(directory.toString());
+    if (it != m_directoryIds.constEnd()) {
+        ref.directory = it.value();
+    } else {
+        ref.directory = static_cast<quint32>(m_directories.size());
+        m_directories.append(directory.toString());
+        m_directoryIds.insert(m_directories.last(), ref.directory);
+    }
+
+    // Source, destination and relative path usually end in the same name
+    if (sameName && QStringView(m_names).mid(sameName->nameOffset, sameName->nameLength) == name) {
+        ref.nameOffset = sameName->nameOffset;
+        ref.nameLength = sameName->nameLength;
+        return ref;
+    }
+
+    ref.nameOffset = static_cast<quint32>(m_names.size());
+    ref.nameLength = static_cast<quint32>(name.size());
+    m_names.append(name);
+    return ref;
+}
+
+QString TransferQueue::path(const PathRef &ref) const
+{
+    QString result = m_directories[ref.directory];
+    result.append(QStringView(m_names).mid(ref.nameOffset, ref.nameLength));
+    return result;
+}
+
+} // namespace qltfs
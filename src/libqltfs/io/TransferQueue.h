@@ -0,0 +1,190 @@
+/*
+ * QLTOTapeMan - Qt-based LTO Tape Manager
+ * libqltfs - LTFS Core Library
+ *
+ * Copyright (c) 2026 Jeffrey ZHU (zhxsh1225@gmail.com)
+ * https://github.com/Gypsop/QLTOTapeMan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "libqltfs_global.h"
+#include "io/TapeIO.h"
+
+#include <QHash>
+#include <QIODevice>
+#include <QList>
+#include <QSharedPointer>
+#include <QString>
+#include <QStringView>
+#include <QVector>
+
+namespace qltfs {
+
+/**
+ * @brief Compact table of queued transfers
+ *
+ * Holds the fields of each TransferItem in parallel arrays. Paths are
+ * split into a directory part, interned once for all items under it,
+ * and a name in a shared character arena; the source, destination and
+ * relative path of an item usually share one name. Fields that are only
+ * set once an item has been processed (hashes, error message) are kept
+ * in a side table for just those items.
+ *
+ * Counts and bytes per status are maintained on every change, so totals
+ * cost O(1). Items are materialized on access with at() or page-wise
+ * with items(). A stream item's size is taken over from update() once
+ * the stream has ended. Not thread-safe; TapeIO guards it with its
+ * queue mutex.
+ */
+class LIBQLTFS_EXPORT TransferQueue
+{
+public:
+    TransferQueue();
+    ~TransferQueue();
+
+    // Disable copy
+    TransferQueue(const TransferQueue &) = delete;
+    TransferQueue &operator=(const TransferQueue &) = delete;
+
+    int size() const { return m_sizes.size(); }
+    bool isEmpty() const { return m_sizes.isEmpty(); }
+
+    void append(const TransferItem &item);
+    void append(const QList<TransferItem> &items);
+    void clear();
+
+    /**
+     * @brief Remove items in one pass; later items move up
+     *
+     * Path text of removed items stays in the arena until clear().
+     *
+     * @param indexes Items to remove, in any order
+     */
+    void remove(QList<int> indexes);
+
+    /**
+     * @brief Materialize one item
+     */
+    TransferItem at(int index) const;
+
+    /**
+     * @brief Store the progress of an item (status, hashes, error); paths and size are kept
+     *
+     * A stream item takes the size it was read with, and drops its
+     * device once update() is given the item without one.
+     */
+    void update(int index, const TransferItem &item);
+
+    TransferStatus status(int index) const { return static_cast<TransferStatus>(m_status[index]); }
+    void setStatus(int index, TransferStatus status);
+
+    qint64 itemSize(int index) const { return m_sizes[index]; }
+    QString sourcePath(int index) const { return path(m_sourcePaths[index]); }
+
+    /**
+     * @brief Name part of an item's source path, without materializing it
+     *
+     * The view is valid until the next append().
+     */
+    QStringView sourceName(int index) const
+    {
+        return QStringView(m_names).mid(m_sourcePaths[index].nameOffset, m_sourcePaths[index].nameLength);
+    }
+    bool isDirectory(int index) const { return m_flags[index] & FLAG_DIRECTORY; }
+
+    // === Totals ===
+
+    qint64 totalBytes() const { return m_totalBytes; }
+    int count(TransferStatus status) const { return m_counts[static_cast<int>(status)]; }
+    qint64 bytes(TransferStatus status) const { return m_bytes[static_cast<int>(status)]; }
+
+    // === Paged access ===
+
+    /**
+     * @brief Materialize a range of items
+     * @param first Index of the first item
+     * @param count Number of items (-1 = up to the end)
+     */
+    QList<TransferItem> items(int first = 0, int count = -1) const;
+
+    /**
+     * @brief Materialize items with a given status
+     * @param status Status to select
+     * @param first Skip this many matching items
+     * @param count Number of items (-1 = all)
+     */
+    QList<TransferItem> items(TransferStatus status, int first = 0, int count = -1) const;
+
+    /**
+     * @brief Approximate heap memory used in bytes
+     */
+    qint64 memoryUsage() const;
+
+private:
+    static constexpr int STATUS_COUNT = static_cast<int>(TransferStatus::Cancelled) + 1;
+    static constexpr quint8 FLAG_DIRECTORY = 0x01;
+    static constexpr quint8 FLAG_HASH_VERIFIED = 0x02;
+
+    /**
+     * @brief Path as interned directory part plus name in the arena
+     */
+    struct PathRef {
+        quint32 directory = 0;      ///< Index into m_directories (with trailing '/')
+        quint32 nameOffset = 0;
+        quint32 nameLength = 0;
+    };
+
+    /**
+     * @brief Fields set only once an item has been worked on, or only for segments
+     */
+    struct Progress {
+        qint64 bytesTransferred = 0;
+        quint32 tapeByteOffset = 0;
+        qint64 sourceOffset = 0;
+        qint64 sourceLength = -1;
+        QString errorMessage;
+        QString sourceHash;
+        QString destHash;
+        QString fastHash;
+    };
+
+    PathRef addPath(const QString &path, const PathRef *sameName);
+    QString path(const PathRef &ref) const;
+    void setProgress(int index, const TransferItem &item);
+    void changeStatus(int index, TransferStatus status);
+
+    QVector<PathRef> m_sourcePaths;
+    QVector<PathRef> m_destPaths;
+    QVector<PathRef> m_relativePaths;
+    QVector<qint64> m_sizes;
+    QVector<qint64> m_modified;         ///< Milliseconds since the epoch, or INVALID_TIME
+    QVector<quint8> m_status;
+    QVector<quint8> m_flags;
+
+    QVector<QString> m_directories;
+    QHash<QString, quint32> m_directoryIds;
+    QString m_names;                    ///< Arena for all path names
+    QHash<int, Progress> m_progress;
+    QHash<int, QSharedPointer<QIODevice>> m_streams;    ///< Sources of stream items still to be read
+
+    qint64 m_totalBytes = 0;
+    int m_counts[STATUS_COUNT] = {};
+    qint64 m_bytes[STATUS_COUNT] = {};
+};
+
+} // namespace qltfs
@@ -11,7 +11,10 @@
 #include <QTextStream>
 #include <QDir>
 #include <QFileInfo>
+#include <QThread>
+#include <QWaitCondition>
 #include <iostream>
+#include <memory>
 
 #ifdef Q_OS_WIN
 #include <windows.h>
@@ -19,12 +22,125 @@
 
 namespace qltfs {
 
+// Longest time an entry waits in the queue when nothing wakes the writer
+static constexpr int WRITER_INTERVAL_MS = 100;
+
+// Entries written per batch (one file flush each)
+static constexpr int WRITER_BATCH_SIZE = 1024;
+
+// =============================================================================
+// Asynchronous Queue
+// =============================================================================
+
+/**
+ * @brief Bounded lock-free multi-producer / single-consumer ring
+ *
+ * Each cell carries a sequence number: producers claim a position with
+ * one compare-and-swap and publish the cell by advancing its sequence,
+ * the writer thread consumes cells in order. Only waking the writer
+ * touches a mutex, and only when the ring is half full or an error is
+ * logged.
+ */
+class Logger::AsyncQueue
+{
+public:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        LogEntry entry;
+        QString line;
+    };
+
+    explicit AsyncQueue(int capacity)
+    {
+        size_t size = 2;
+        while (size < static_cast<size_t>(qMax(2, capacity))) {
+            size <<= 1;
+        }
+        mask = size - 1;
+        cells.reset(new Cell[size]);
+        for (size_t i = 0; i < size; ++i) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    bool tryPush(const LogEntry &entry, const QString &line)
+    {
+        size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        Cell *cell;
+        for (;;) {
+            cell = &cells[pos & mask];
+            const size_t seq = cell->sequence.load(std::memory_order_acquire);
+            const qintptr diff = static_cast<qintptr>(seq) - static_cast<qintptr>(pos);
+            if (diff == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;   // Full
+            } else {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->entry = entry;
+        cell->line = line;
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool tryPop(LogEntry &entry, QString &line)
+    {
+        Cell &cell = cells[dequeuePos & mask];
+        const size_t seq = cell.sequence.load(std::memory_order_acquire);
+        if (static_cast<qintptr>(seq) - static_cast<qintptr>(dequeuePos + 1) < 0) {
+            return false;       // Empty, or the producer has not published yet
+        }
+
+        entry = std::move(cell.entry);
+        line = std::move(cell.line);
+        cell.sequence.store(dequeuePos + mask + 1, std::memory_order_release);
+        dequeuePos++;
+        written.store(dequeuePos, std::memory_order_release);
+        return true;
+    }
+
+    size_t capacity() const { return mask + 1; }
+
+    /// Approximate number of queued entries
+    size_t size() const
+    {
+        const size_t consumed = written.load(std::memory_order_acquire);
+        return enqueuePos.load(std::memory_order_acquire) - consumed;
+    }
+
+    void wakeWriter()
+    {
+        QMutexLocker locker(&wakeMutex);
+        wakeCondition.wakeOne();
+    }
+
+    std::unique_ptr<Cell[]> cells;
+    size_t mask = 0;
+    alignas(64) std::atomic<size_t> enqueuePos{0};
+    alignas(64) size_t dequeuePos = 0;      ///< Writer thread only
+    std::atomic<size_t> written{0};         ///< Entries consumed so far
+
+    QScopedPointer<QThread> writer;
+    bool stopping = false;                  ///< Guarded by wakeMutex
+    QMutex wakeMutex;
+    QWaitCondition wakeCondition;           ///< Work available or stop requested
+    QWaitCondition drained;                 ///< A batch was written
+};
+
 // =============================================================================
 // Logger Implementation
 // =============================================================================
 
 Logger::Logger()
-    : m_logLevel(LogLevel::Info)
+    : m_logLevel(static_cast<int>(LogLevel::Info))
+    , m_asyncEnabled(false)
+    , m_overflowPolicy(static_cast<int>(LogOverflowPolicy::Drop))
+    , m_droppedEntries(0)
     , m_consoleOutput(true)
     , m_fileOutput(true)
     , m_nextHandlerId(1)
@@ -91,6 +207,8 @@ bool Logger::init(const QString& logFilePath, bool append)
 
 void Logger::shutdown()
 {
+    stopAsync();
+
     QMutexLocker locker(&m_mutex);
 
     if (m_logFile.isOpen()) {
@@ -109,8 +227,72 @@ void Logger::shutdown()
 
 void Logger::setLogLevel(LogLevel level)
 {
+    m_logLevel.store(static_cast<int>(level), std::memory_order_relaxed);
+}
+
+void Logger::setAsync(bool enabled, int capacity)
+{
+    if (!enabled) {
+        stopAsync();
+        return;
+    }
+
     QMutexLocker locker(&m_mutex);
-    m_logLevel = level;
+    if (m_asyncEnabled.load(std::memory_order_acquire)) {
+        return;
+    }
+
+    if (!m_async) {
+        m_async.reset(new AsyncQueue(capacity));
+    }
+
+    m_async->stopping = false;
+    m_async->writer.reset(QThread::create([this]() { runWriter(); }));
+    m_async->writer->start(QThread::LowPriority);
+    m_asyncEnabled.store(true, std::memory_order_release);
+}
+
+void Logger::stopAsync()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        if (!m_asyncEnabled.exchange(false, std::memory_order_acq_rel)) {
+            return;
+        }
+    }
+
+    // Producers that already saw async mode may still be pushing; the
+    // writer drains the ring once more after it is told to stop
+    {
+        QMutexLocker locker(&m_async->wakeMutex);
+        m_async->stopping = true;
+        m_async->wakeCondition.wakeOne();
+    }
+    m_async->writer->wait();
+    m_async->writer.reset();
+}
+
+void Logger::setOverflowPolicy(LogOverflowPolicy policy)
+{
+    m_overflowPolicy.store(static_cast<int>(policy));
+}
+
+void Logger::flush()
+{
+    if (m_asyncEnabled.load(std::memory_order_acquire)) {
+        const size_t target = m_async->enqueuePos.load(std::memory_order_acquire);
+        QMutexLocker locker(&m_async->wakeMutex);
+        while (m_async->written.load(std::memory_order_acquire) < target &&
+               m_asyncEnabled.load(std::memory_order_acquire)) {
+            m_async->wakeCondition.wakeOne();
+            m_async->drained.wait(&m_async->wakeMutex, WRITER_INTERVAL_MS);
+        }
+    }
+
+    QMutexLocker locker(&m_mutex);
+    if (m_logFile.isOpen()) {
+        m_logFile.flush();
+    }
 }
 
 void Logger::setConsoleOutput(bool enabled)
@@ -143,7 +325,7 @@ void Logger::log(LogLevel level, const QString& category, const QString& message
                  const char* file, int line, const char* function)
 {
     // Check log level (without lock for performance)
-    if (level < m_logLevel) {
+    if (!isEnabled(level)) {
         return;
     }
 
@@ -157,11 +339,29 @@ void Logger::log(LogLevel level, const QString& category, const QString& message
     entry.line = line;
     entry.function = function ? QString::fromUtf8(function) : QString();
 
+    if (m_asyncEnabled.load(std::memory_order_acquire)) {
+        const QString formatted = formatEntry(entry);
+        while (!m_async->tryPush(entry, formatted)) {
+            if (m_overflowPolicy.load(std::memory_order_relaxed) == static_cast<int>(LogOverflowPolicy::Drop)) {
+                m_droppedEntries.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            m_async->wakeWriter();
+            QThread::yieldCurrentThread();
+        }
+
+        // Errors go out promptly; otherwise the writer wakes on its own
+        if (level >= LogLevel::Error || m_async->size() > m_async->capacity() / 2) {
+            m_async->wakeWriter();
+        }
+        return;
+    }
+
     QMutexLocker locker(&m_mutex);
 
     // Write to console
     if (m_consoleOutput) {
-        writeToConsole(entry);
+        writeToConsole(entry, formatEntry(entry), true);
     }
 
     // Write to file
@@ -169,6 +369,11 @@ void Logger::log(LogLevel level, const QString& category, const QString& message
         writeToFile(entry);
     }
 
+    callHandlers(entry);
+}
+
+void Logger::callHandlers(const LogEntry& entry)
+{
     // Call custom handlers
     for (auto& handler : m_handlers) {
         try {
@@ -179,6 +384,63 @@ void Logger::log(LogLevel level, const QString& category, const QString& message
     }
 }
 
+void Logger::runWriter()
+{
+    LogEntry entry;
+    QString line;
+    QByteArray batch;
+
+    for (;;) {
+        bool stopping;
+        {
+            QMutexLocker locker(&m_async->wakeMutex);
+            if (!m_async->stopping && m_async->size() == 0) {
+                m_async->wakeCondition.wait(&m_async->wakeMutex, WRITER_INTERVAL_MS);
+            }
+            stopping = m_async->stopping;
+        }
+
+        // Write everything queued, one file write and flush per batch
+        for (;;) {
+            QMutexLocker locker(&m_mutex);
+            const bool toFile = m_fileOutput && m_logFile.isOpen();
+            int count = 0;
+            batch.clear();
+            while (count < WRITER_BATCH_SIZE && m_async->tryPop(entry, line)) {
+                if (m_consoleOutput) {
+                    writeToConsole(entry, line, false);
+                }
+                if (toFile) {
+                    batch += line.toUtf8();
+                    batch += '\n';
+                }
+                callHandlers(entry);
+                count++;
+            }
+
+            if (count == 0) {
+                break;
+            }
+            if (m_consoleOutput) {
+                std::cout.flush();
+            }
+            if (toFile) {
+                m_logFile.write(batch);
+                m_logFile.flush();
+            }
+        }
+
+        {
+            QMutexLocker locker(&m_async->wakeMutex);
+            m_async->drained.wakeAll();
+        }
+
+        if (stopping && m_async->size() == 0) {
+            return;
+        }
+    }
+}
+
 QString Logger::levelToString(LogLevel level)
 {
     switch (level) {
@@ -243,11 +505,12 @@ void Logger::writeToFile(const LogEntry& entry)
     stream.flush();
 }
 
-void Logger::writeToConsole(const LogEntry& entry)
+void Logger::writeToConsole(const LogEntry& entry, const QString& formatted, bool flush)
 {
-    QString formatted = formatEntry(entry);
-
 #ifdef Q_OS_WIN
+    // The colour is applied when the text reaches the console
+    Q_UNUSED(flush)
+
     // Windows: Handle console colors
     HANDLE hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
     WORD originalAttrs = FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE;
@@ -308,7 +571,10 @@ void Logger::writeToConsole(const LogEntry& entry)
         break;
     }
 
-    std::cout << colorCode << formatted.toLocal8Bit().constData() << "\033[0m" << std::endl;
+    std::cout << colorCode << formatted.toLocal8Bit().constData() << "\033[0m" << '\n';
+    if (flush) {
+        std::cout.flush();
+    }
 #endif
 }
 
@@ -15,6 +15,8 @@
 #include <QFile>
 #include <QMutex>
 #include <QDateTime>
+#include <QScopedPointer>
+#include <atomic>
 #include <functional>
 
 namespace qltfs {
@@ -31,6 +33,14 @@ enum class LogLevel {
     Fatal       ///< Fatal errors
 };
 
+/**
+ * @brief What an asynchronous logger does when its queue is full
+ */
+enum class LogOverflowPolicy {
+    Drop,       ///< Discard the entry and count it (never blocks the caller)
+    Block       ///< Wait for the writer thread to make room
+};
+
 /**
  * @brief Log entry structure
  */
@@ -53,6 +63,12 @@ using LogHandler = std::function<void(const LogEntry&)>;
  * @brief Thread-safe logging utility
  *
  * Provides centralized logging with multiple output destinations.
+ *
+ * In synchronous mode (the default) every entry is written and the file
+ * flushed on the calling thread. In asynchronous mode entries are
+ * formatted by the caller, pushed into a lock-free multi-producer ring
+ * and written in batches by a background thread, with one file flush
+ * per batch; handlers are then called on that thread.
  */
 class LIBQLTFS_EXPORT Logger
 {
@@ -83,7 +99,54 @@ public:
     /**
      * @brief Get current log level
      */
-    LogLevel logLevel() const { return m_logLevel; }
+    LogLevel logLevel() const { return static_cast<LogLevel>(m_logLevel.load(std::memory_order_relaxed)); }
+
+    /**
+     * @brief Check if entries of a level are logged
+     *
+     * A single relaxed atomic load, so disabled QLTFS_TRACE / QLTFS_DEBUG
+     * statements cost a compare and do not build their message.
+     */
+    bool isEnabled(LogLevel level) const
+    {
+        return static_cast<int>(level) >= m_logLevel.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Switch between synchronous and asynchronous writing
+     *
+     * Disabling waits until every queued entry has been written.
+     *
+     * @param enabled true to write on a background thread
+     * @param capacity Ring size in entries (rounded up to a power of two,
+     *                 fixed once the ring exists)
+     */
+    void setAsync(bool enabled, int capacity = 8192);
+
+    /**
+     * @brief Check if asynchronous writing is active
+     */
+    bool isAsync() const { return m_asyncEnabled.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Set what happens when the asynchronous queue is full
+     */
+    void setOverflowPolicy(LogOverflowPolicy policy);
+
+    /**
+     * @brief Get the overflow policy
+     */
+    LogOverflowPolicy overflowPolicy() const { return static_cast<LogOverflowPolicy>(m_overflowPolicy.load()); }
+
+    /**
+     * @brief Number of entries discarded because the queue was full
+     */
+    quint64 droppedEntries() const { return m_droppedEntries.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Wait until all entries logged so far are written and flushed
+     */
+    void flush();
 
     /**
      * @brief Enable/disable console output
@@ -133,18 +196,27 @@ public:
     void fatal(const QString& category, const QString& message);
 
 private:
+    class AsyncQueue;
+
     Logger();
     ~Logger();
     Logger(const Logger&) = delete;
     Logger& operator=(const Logger&) = delete;
 
     void writeToFile(const LogEntry& entry);
-    void writeToConsole(const LogEntry& entry);
+    void writeToConsole(const LogEntry& entry, const QString& formatted, bool flush);
     QString formatEntry(const LogEntry& entry) const;
+    void callHandlers(const LogEntry& entry);
+    void stopAsync();
+    void runWriter();
 
     QMutex m_mutex;
     QFile m_logFile;
-    LogLevel m_logLevel;
+    std::atomic<int> m_logLevel;
+    std::atomic<bool> m_asyncEnabled;
+    std::atomic<int> m_overflowPolicy;
+    std::atomic<quint64> m_droppedEntries;
+    QScopedPointer<AsyncQueue> m_async;     ///< Created on first setAsync(true), kept until exit
     bool m_consoleOutput;
     bool m_fileOutput;
     QMap<int, LogHandler> m_handlers;
@@ -155,8 +227,13 @@ private:
 // Logging Macros
 // =============================================================================
 
+// The message expression is only evaluated when the level is enabled
 #define QLTFS_LOG(level, category, message) \
-    qltfs::Logger::instance().log(level, category, message, __FILE__, __LINE__, Q_FUNC_INFO)
+    do { \
+        if (qltfs::Logger::instance().isEnabled(level)) { \
+            qltfs::Logger::instance().log(level, category, message, __FILE__, __LINE__, Q_FUNC_INFO); \
+        } \
+    } while (0)
 
 #define QLTFS_TRACE(category, message) \
     QLTFS_LOG(qltfs::LogLevel::Trace, category, message)
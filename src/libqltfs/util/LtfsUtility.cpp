@@ -8,6 +8,7 @@
  */
 
 #include "LtfsUtility.h"
+#include "../io/HashKernels.h"
 
 #include <QUuid>
 #include <QFile>
@@ -367,28 +368,16 @@ QString LtfsUtility::generateUuid()
 
 quint32 LtfsUtility::calculateCrc32(const QByteArray &data)
 {
-    // CRC-32 polynomial used in LTFS (same as used in Ethernet, ZIP, etc.)
-    static quint32 crcTable[256];
-    static bool tableInitialized = false;
-
-    if (!tableInitialized) {
-        for (int i = 0; i < 256; i++) {
-            quint32 crc = static_cast<quint32>(i);
-            for (int j = 0; j < 8; j++) {
-                crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320 : crc >> 1;
-            }
-            crcTable[i] = crc;
-        }
-        tableInitialized = true;
-    }
+    return calculateCrc32(0, data.constData(), data.size());
+}
 
-    quint32 crc = 0xFFFFFFFF;
-    for (int i = 0; i < data.size(); i++) {
-        quint8 index = (crc ^ static_cast<quint8>(data[i])) & 0xFF;
-        crc = crcTable[index] ^ (crc >> 8);
+quint32 LtfsUtility::calculateCrc32(quint32 crc, const char *data, qint64 length)
+{
+    // CRC-32 polynomial used in LTFS (same as used in Ethernet, ZIP, etc.)
+    if (!data || length <= 0) {
+        return crc;
     }
-
-    return crc ^ 0xFFFFFFFF;
+    return Crc32::extend(crc, data, static_cast<size_t>(length));
 }
 
 bool LtfsUtility::verifyLtfsIndexSignature(const QByteArray &xmlData)
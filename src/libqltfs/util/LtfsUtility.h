@@ -180,6 +180,19 @@ public:
      */
     static quint32 calculateCrc32(const QByteArray &data);
 
+    /**
+     * @brief Continue a CRC32 checksum over the next block of data
+     *
+     * Feeding a stream block by block, each call passing the previous
+     * result, gives the same value as one call over the whole stream.
+     *
+     * @param crc CRC32 of the preceding data (0 to start)
+     * @param data Block to add
+     * @param length Size of the block in bytes
+     * @return CRC32 of the preceding data followed by this block
+     */
+    static quint32 calculateCrc32(quint32 crc, const char *data, qint64 length);
+
     /**
      * @brief Verify LTFS index XML signature
      * @param xmlData The XML data to verify
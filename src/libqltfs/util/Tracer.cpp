@@ -0,0 +1,384 @@
+/**
+ * QLTOTapeMan - Qt-based LTO Tape Manager
+ * Tracer Implementation
+ *
+ * Copyright (c) 2026 Jeffrey ZHU (zhxsh1225@gmail.com)
+ * https://github.com/Gypsop/QLTOTapeMan
+ */
+
+#include "Tracer.h"
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QThread>
+
+#include <algorithm>
+
+namespace qltfs {
+
+// Events kept per thread unless changed with setBufferCapacity()
+static constexpr int DEFAULT_BUFFER_CAPACITY = 1 << 20;
+
+struct Tracer::ThreadBuffer {
+    QMutex mutex;                   ///< Taken by the owning thread and by export
+    QVector<TraceEvent> events;
+    quint64 threadId = 0;
+    QString threadName;
+};
+
+// =============================================================================
+// Serialization Helpers
+// =============================================================================
+
+static void appendJsonString(QByteArray &out, const QByteArray &text)
+{
+    out.append('"');
+    for (char c : text) {
+        switch (c) {
+        case '"':  out.append("\\\""); break;
+        case '\\': out.append("\\\\"); break;
+        case '\n': out.append("\\n"); break;
+        case '\r': out.append("\\r"); break;
+        case '\t': out.append("\\t"); break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                out.append("\\u00");
+                out.append(QByteArray::number(static_cast<int>(c), 16).rightJustified(2, '0'));
+            } else {
+                out.append(c);
+            }
+        }
+    }
+    out.append('"');
+}
+
+static QByteArray microseconds(qint64 ns)
+{
+    return QByteArray::number(static_cast<double>(ns) / 1000.0, 'f', 3);
+}
+
+// Minimal protobuf encoding, enough for the Perfetto trace packets below
+static void appendVarint(QByteArray &out, quint64 value)
+{
+    while (value >= 0x80) {
+        out.append(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.append(static_cast<char>(value));
+}
+
+static void appendVarintField(QByteArray &out, quint32 field, quint64 value)
+{
+    appendVarint(out, (static_cast<quint64>(field) << 3) | 0);
+    appendVarint(out, value);
+}
+
+static void appendBytesField(QByteArray &out, quint32 field, const QByteArray &bytes)
+{
+    appendVarint(out, (static_cast<quint64>(field) << 3) | 2);
+    appendVarint(out, static_cast<quint64>(bytes.size()));
+    out.append(bytes);
+}
+
+// Field numbers from perfetto/protos/perfetto/trace
+namespace perfetto {
+constexpr quint32 TRACE_PACKET = 1;                 // Trace.packet
+constexpr quint32 PACKET_TIMESTAMP = 8;             // TracePacket.timestamp
+constexpr quint32 PACKET_SEQUENCE_ID = 10;          // TracePacket.trusted_packet_sequence_id
+constexpr quint32 PACKET_TRACK_EVENT = 11;          // TracePacket.track_event
+constexpr quint32 PACKET_SEQUENCE_FLAGS = 13;       // TracePacket.sequence_flags
+constexpr quint32 PACKET_TRACK_DESCRIPTOR = 60;     // TracePacket.track_descriptor
+constexpr quint32 TRACK_UUID = 1;                   // TrackDescriptor.uuid
+constexpr quint32 TRACK_THREAD = 4;                 // TrackDescriptor.thread
+constexpr quint32 THREAD_PID = 1;                   // ThreadDescriptor.pid
+constexpr quint32 THREAD_TID = 2;                   // ThreadDescriptor.tid
+constexpr quint32 THREAD_NAME = 5;                  // ThreadDescriptor.thread_name
+constexpr quint32 EVENT_ANNOTATION = 4;             // TrackEvent.debug_annotations
+constexpr quint32 EVENT_TYPE = 9;                   // TrackEvent.type
+constexpr quint32 EVENT_TRACK_UUID = 11;            // TrackEvent.track_uuid
+constexpr quint32 EVENT_CATEGORY = 22;              // TrackEvent.categories
+constexpr quint32 EVENT_NAME = 23;                  // TrackEvent.name
+constexpr quint32 ANNOTATION_INT = 4;               // DebugAnnotation.int_value
+constexpr quint32 ANNOTATION_NAME = 10;             // DebugAnnotation.name
+constexpr quint64 TYPE_SLICE_BEGIN = 1;
+constexpr quint64 TYPE_SLICE_END = 2;
+constexpr quint64 SEQ_INCREMENTAL_STATE_CLEARED = 1;
+} // namespace perfetto
+
+// =============================================================================
+// Constructor / Destructor
+// =============================================================================
+
+Tracer::Tracer()
+    : m_enabled(false)
+    , m_capacity(DEFAULT_BUFFER_CAPACITY)
+    , m_dropped(0)
+{
+    m_clock.start();
+}
+
+Tracer::~Tracer() = default;
+
+Tracer& Tracer::instance()
+{
+    static Tracer instance;
+    return instance;
+}
+
+// =============================================================================
+// Recording
+// =============================================================================
+
+void Tracer::setEnabled(bool enabled)
+{
+    m_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void Tracer::setBufferCapacity(int events)
+{
+    m_capacity.store(qMax(1, events), std::memory_order_relaxed);
+}
+
+void Tracer::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    for (const QSharedPointer<ThreadBuffer> &buffer : m_buffers) {
+        QMutexLocker bufferLocker(&buffer->mutex);
+        buffer->events.clear();
+        buffer->events.squeeze();
+    }
+    m_dropped.store(0, std::memory_order_relaxed);
+}
+
+int Tracer::eventCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    int count = 0;
+    for (const QSharedPointer<ThreadBuffer> &buffer : m_buffers) {
+        QMutexLocker bufferLocker(&buffer->mutex);
+        count += buffer->events.size();
+    }
+    return count;
+}
+
+Tracer::ThreadBuffer *Tracer::localBuffer()
+{
+    // The calling thread's buffer, owned by m_buffers
+    static thread_local ThreadBuffer *local = nullptr;
+    if (local) {
+        return local;
+    }
+
+    QSharedPointer<ThreadBuffer> buffer(new ThreadBuffer);
+    const QThread *thread = QThread::currentThread();
+    if (thread && !thread->objectName().isEmpty()) {
+        buffer->threadName = thread->objectName();
+    }
+
+    QMutexLocker locker(&m_mutex);
+    buffer->threadId = static_cast<quint64>(m_buffers.size()) + 1;
+    if (buffer->threadName.isEmpty()) {
+        buffer->threadName = QStringLiteral("Thread %1").arg(buffer->threadId);
+    }
+    m_buffers.append(buffer);
+    local = buffer.data();
+    return local;
+}
+
+void Tracer::record(const TraceEvent &event)
+{
+    ThreadBuffer *buffer = localBuffer();
+    const int capacity = m_capacity.load(std::memory_order_relaxed);
+
+    QMutexLocker locker(&buffer->mutex);
+    if (buffer->events.size() >= capacity) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    buffer->events.append(event);
+}
+
+void Tracer::setThreadName(const QString &name)
+{
+    ThreadBuffer *buffer = localBuffer();
+    QMutexLocker locker(&buffer->mutex);
+    buffer->threadName = name;
+}
+
+// =============================================================================
+// Export
+// =============================================================================
+
+QVector<Tracer::ThreadSnapshot> Tracer::snapshot() const
+{
+    QMutexLocker locker(&m_mutex);
+    QVector<ThreadSnapshot> threads;
+    threads.reserve(m_buffers.size());
+    for (const QSharedPointer<ThreadBuffer> &buffer : m_buffers) {
+        QMutexLocker bufferLocker(&buffer->mutex);
+        ThreadSnapshot thread;
+        thread.threadId = buffer->threadId;
+        thread.threadName = buffer->threadName;
+        thread.events = buffer->events;
+        threads.append(thread);
+    }
+    return threads;
+}
+
+QByteArray Tracer::toChromeJson() const
+{
+    const QVector<ThreadSnapshot> threads = snapshot();
+    const QByteArray pid = QByteArray::number(QCoreApplication::applicationPid());
+
+    QByteArray out;
+    out.append("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+    bool first = true;
+
+    for (const ThreadSnapshot &thread : threads) {
+        const QByteArray tid = QByteArray::number(thread.threadId);
+
+        if (!first) {
+            out.append(',');
+        }
+        first = false;
+        out.append("\n{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":").append(pid);
+        out.append(",\"tid\":").append(tid).append(",\"args\":{\"name\":");
+        appendJsonString(out, thread.threadName.toUtf8());
+        out.append("}}");
+
+        for (const TraceEvent &event : thread.events) {
+            out.append(",\n{\"ph\":\"X\",\"cat\":");
+            appendJsonString(out, QByteArray(event.category));
+            out.append(",\"name\":");
+            appendJsonString(out, QByteArray(event.name));
+            out.append(",\"pid\":").append(pid);
+            out.append(",\"tid\":").append(tid);
+            out.append(",\"ts\":").append(microseconds(event.startNs));
+            out.append(",\"dur\":").append(microseconds(event.durationNs));
+            if (event.argName) {
+                out.append(",\"args\":{");
+                appendJsonString(out, QByteArray(event.argName));
+                out.append(':').append(QByteArray::number(event.argValue)).append('}');
+            }
+            out.append('}');
+        }
+    }
+
+    out.append("\n]}\n");
+    return out;
+}
+
+QByteArray Tracer::toPerfetto() const
+{
+    using namespace perfetto;
+
+    const QVector<ThreadSnapshot> threads = snapshot();
+    const quint64 pid = static_cast<quint64>(QCoreApplication::applicationPid());
+
+    QByteArray out;
+    QByteArray packet;
+    QByteArray message;
+    QByteArray nested;
+
+    for (const ThreadSnapshot &thread : threads) {
+        // One packet sequence and one track per thread
+        const quint64 sequence = thread.threadId;
+        const quint64 track = thread.threadId;
+
+        nested.clear();
+        appendVarintField(nested, THREAD_PID, pid);
+        appendVarintField(nested, THREAD_TID, thread.threadId);
+        appendBytesField(nested, THREAD_NAME, thread.threadName.toUtf8());
+        message.clear();
+        appendVarintField(message, TRACK_UUID, track);
+        appendBytesField(message, TRACK_THREAD, nested);
+        packet.clear();
+        appendVarintField(packet, PACKET_SEQUENCE_ID, sequence);
+        appendVarintField(packet, PACKET_SEQUENCE_FLAGS, SEQ_INCREMENTAL_STATE_CLEARED);
+        appendBytesField(packet, PACKET_TRACK_DESCRIPTOR, message);
+        appendBytesField(out, TRACE_PACKET, packet);
+
+        // Spans are stored in completion order; emit begin/end pairs in
+        // time order so nested slices open outermost first and close
+        // innermost first
+        struct Edge {
+            qint64 timeNs;
+            bool end;
+            const TraceEvent *event;
+        };
+        QVector<Edge> edges;
+        edges.reserve(thread.events.size() * 2);
+        for (const TraceEvent &event : thread.events) {
+            edges.append({event.startNs, false, &event});
+            edges.append({event.startNs + event.durationNs, true, &event});
+        }
+        std::stable_sort(edges.begin(), edges.end(), [](const Edge &a, const Edge &b) {
+            if (a.timeNs != b.timeNs) {
+                return a.timeNs < b.timeNs;
+            }
+            if (a.end != b.end) {
+                return a.end;
+            }
+            return a.end ? a.event->durationNs < b.event->durationNs
+                         : a.event->durationNs > b.event->durationNs;
+        });
+
+        for (const Edge &edge : edges) {
+            message.clear();
+            appendVarintField(message, EVENT_TYPE, edge.end ? TYPE_SLICE_END : TYPE_SLICE_BEGIN);
+            appendVarintField(message, EVENT_TRACK_UUID, track);
+            if (!edge.end) {
+                appendBytesField(message, EVENT_CATEGORY, QByteArray(edge.event->category));
+                appendBytesField(message, EVENT_NAME, QByteArray(edge.event->name));
+                if (edge.event->argName) {
+                    nested.clear();
+                    appendBytesField(nested, ANNOTATION_NAME, QByteArray(edge.event->argName));
+                    appendVarintField(nested, ANNOTATION_INT, static_cast<quint64>(edge.event->argValue));
+                    appendBytesField(message, EVENT_ANNOTATION, nested);
+                }
+            }
+
+            packet.clear();
+            appendVarintField(packet, PACKET_TIMESTAMP, static_cast<quint64>(edge.timeNs));
+            appendVarintField(packet, PACKET_SEQUENCE_ID, sequence);
+            appendBytesField(packet, PACKET_TRACK_EVENT, message);
+            appendBytesField(out, TRACE_PACKET, packet);
+        }
+    }
+
+    return out;
+}
+
+bool Tracer::exportTrace(const QString &filePath, TraceFormat format, QString *error) const
+{
+    const QByteArray data = format == TraceFormat::Perfetto ? toPerfetto() : toChromeJson();
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        if (error) {
+            *error = QStringLiteral("Failed to open trace file: %1").arg(file.errorString());
+        }
+        return false;
+    }
+    if (file.write(data) != data.size()) {
+        if (error) {
+            *error = QStringLiteral("Failed to write trace file: %1").arg(file.errorString());
+        }
+        return false;
+    }
+    return true;
+}
+
+TraceFormat Tracer::formatForFile(const QString &filePath)
+{
+    const QString suffix = QFileInfo(filePath).suffix().toLower();
+    if (suffix == QLatin1String("pftrace") || suffix == QLatin1String("perfetto-trace")
+        || suffix == QLatin1String("pb")) {
+        return TraceFormat::Perfetto;
+    }
+    return TraceFormat::ChromeJson;
+}
+
+} // namespace qltfs
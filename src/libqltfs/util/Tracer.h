@@ -0,0 +1,241 @@
+/**
+ * QLTOTapeMan - Qt-based LTO Tape Manager
+ * Tracer Header
+ *
+ * Copyright (c) 2026 Jeffrey ZHU (zhxsh1225@gmail.com)
+ * https://github.com/Gypsop/QLTOTapeMan
+ */
+
+#ifndef QLTFS_TRACER_H
+#define QLTFS_TRACER_H
+
+#include "../libqltfs_global.h"
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QString>
+#include <QVector>
+#include <atomic>
+
+namespace qltfs {
+
+/**
+ * @brief File format written by Tracer::exportTrace()
+ */
+enum class TraceFormat {
+    ChromeJson,     ///< Chrome trace event JSON (chrome://tracing, ui.perfetto.dev)
+    Perfetto        ///< Perfetto protobuf trace (ui.perfetto.dev, trace_processor)
+};
+
+/**
+ * @brief One finished span
+ *
+ * Category, name and argument name must be string literals (or otherwise
+ * outlive the tracer); only the pointers are stored.
+ */
+struct LIBQLTFS_EXPORT TraceEvent {
+    const char *category = nullptr;
+    const char *name = nullptr;
+    const char *argName = nullptr;  ///< Optional integer argument (nullptr = none)
+    qint64 argValue = 0;
+    qint64 startNs = 0;             ///< Since the tracer epoch
+    qint64 durationNs = 0;
+};
+
+/**
+ * @brief Collector for hot-path trace spans
+ *
+ * Spans are recorded with TraceSpan / QLTFS_TRACE_SPAN into a buffer
+ * owned by the recording thread, so threads never contend with each
+ * other; a buffer's lock is only taken by its own thread and by export.
+ * Buffers outlive their threads until clear() and are bounded: once a
+ * thread has bufferCapacity() events, further spans are counted in
+ * droppedEvents() instead.
+ *
+ * Disabled by default. While disabled a span costs one relaxed atomic
+ * load and records nothing.
+ */
+class LIBQLTFS_EXPORT Tracer
+{
+public:
+    /**
+     * @brief Get singleton instance
+     */
+    static Tracer& instance();
+
+    /**
+     * @brief Start or stop recording
+     *
+     * Spans already open when tracing is enabled are not recorded.
+     */
+    void setEnabled(bool enabled);
+
+    /**
+     * @brief Check if spans are being recorded
+     */
+    bool isEnabled() const { return m_enabled.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Set the maximum events kept per thread (applies to new events)
+     */
+    void setBufferCapacity(int events);
+
+    /**
+     * @brief Maximum events kept per thread
+     */
+    int bufferCapacity() const { return m_capacity.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Discard all recorded events and reset the drop counter
+     */
+    void clear();
+
+    /**
+     * @brief Number of events recorded across all threads
+     */
+    int eventCount() const;
+
+    /**
+     * @brief Number of spans lost because a thread buffer was full
+     */
+    quint64 droppedEvents() const { return m_dropped.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Nanoseconds since the tracer epoch
+     */
+    qint64 now() const { return m_clock.nsecsElapsed(); }
+
+    /**
+     * @brief Record a finished span on the calling thread
+     */
+    void record(const TraceEvent &event);
+
+    /**
+     * @brief Name the calling thread in exported traces
+     *
+     * Threads that are not named here use their QThread objectName.
+     */
+    void setThreadName(const QString &name);
+
+    /**
+     * @brief Serialize recorded events as Chrome trace event JSON
+     */
+    QByteArray toChromeJson() const;
+
+    /**
+     * @brief Serialize recorded events as a Perfetto protobuf trace
+     */
+    QByteArray toPerfetto() const;
+
+    /**
+     * @brief Write recorded events to a file
+     * @param filePath Output file
+     * @param format File format
+     * @param error Set on failure
+     * @return True if the whole trace was written
+     */
+    bool exportTrace(const QString &filePath, TraceFormat format = TraceFormat::ChromeJson,
+                     QString *error = nullptr) const;
+
+    /**
+     * @brief Pick the format for an output file by its extension
+     *
+     * .pftrace, .perfetto-trace and .pb select Perfetto, anything else
+     * Chrome JSON.
+     */
+    static TraceFormat formatForFile(const QString &filePath);
+
+private:
+    Tracer();
+    ~Tracer();
+
+    // Prevent copying
+    Tracer(const Tracer&) = delete;
+    Tracer& operator=(const Tracer&) = delete;
+
+    struct ThreadBuffer;
+
+    ThreadBuffer *localBuffer();
+
+    /**
+     * @brief Copy of one thread's events, taken under its lock
+     */
+    struct ThreadSnapshot {
+        quint64 threadId = 0;
+        QString threadName;
+        QVector<TraceEvent> events;
+    };
+
+    QVector<ThreadSnapshot> snapshot() const;
+
+    std::atomic<bool> m_enabled;
+    std::atomic<int> m_capacity;
+    std::atomic<quint64> m_dropped;
+    QElapsedTimer m_clock;
+
+    mutable QMutex m_mutex;         ///< Guards m_buffers
+    QVector<QSharedPointer<ThreadBuffer>> m_buffers;
+};
+
+/**
+ * @brief RAII span: records the time between construction and destruction
+ *
+ * Use QLTFS_TRACE_SPAN unless the span needs an argument.
+ */
+class LIBQLTFS_EXPORT TraceSpan
+{
+public:
+    TraceSpan(const char *category, const char *name)
+        : m_startNs(Tracer::instance().isEnabled() ? Tracer::instance().now() : -1)
+    {
+        m_event.category = category;
+        m_event.name = name;
+    }
+
+    ~TraceSpan()
+    {
+        if (m_startNs >= 0) {
+            Tracer &tracer = Tracer::instance();
+            m_event.startNs = m_startNs;
+            m_event.durationNs = tracer.now() - m_startNs;
+            tracer.record(m_event);
+        }
+    }
+
+    // Prevent copying
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+    /**
+     * @brief Attach an integer argument (e.g. a byte count) to the span
+     */
+    void setArg(const char *name, qint64 value)
+    {
+        m_event.argName = name;
+        m_event.argValue = value;
+    }
+
+    /**
+     * @brief Check if this span is being recorded
+     */
+    bool isActive() const { return m_startNs >= 0; }
+
+private:
+    TraceEvent m_event;
+    qint64 m_startNs;
+};
+
+} // namespace qltfs
+
+#define QLTFS_TRACE_CONCAT_(a, b) a##b
+#define QLTFS_TRACE_CONCAT(a, b) QLTFS_TRACE_CONCAT_(a, b)
+
+/**
+ * @brief Trace the rest of the enclosing scope
+ */
+#define QLTFS_TRACE_SPAN(category, name) \
+    qltfs::TraceSpan QLTFS_TRACE_CONCAT(qltfsTraceSpan, __LINE__)(category, name)
+
+#endif // QLTFS_TRACER_H
@@ -20,6 +20,7 @@
  */
 
 #include "IndexParser.h"
+#include "../util/Tracer.h"
 
 #include <QFile>
 #include <QDebug>
@@ -60,8 +61,182 @@ static const QString ELEM_EA_KEY = QStringLiteral("key");
 static const QString ELEM_EA_VALUE = QStringLiteral("value");
 static const QString ELEM_UID = QStringLiteral("uid");
 
+static const QString ELEM_CONTENTS = QStringLiteral("contents");
+
 static const QString ATTR_VERSION = QStringLiteral("version");
 
+namespace {
+
+/**
+ * @brief Element names as tokens for the compact parser
+ */
+enum class Element {
+    Unknown,
+    LtfsIndex,
+    Creator,
+    VolumeUuid,
+    Generation,
+    UpdateTime,
+    Location,
+    PreviousGeneration,
+    Partition,
+    StartBlock,
+    AllowPolicyUpdate,
+    HighestFileUid,
+    Directory,
+    Contents,
+    File,
+    Name,
+    Readonly,
+    CreationTime,
+    ChangeTime,
+    ModifyTime,
+    AccessTime,
+    BackupTime,
+    Length,
+    Uid,
+    ExtentInfo,
+    Extent,
+    FileOffset,
+    ByteOffset,
+    ByteCount,
+    ExtendedAttribute,
+    Key,
+    Value
+};
+
+/**
+ * @brief Map an element name to its token without creating a string
+ */
+Element elementToken(QStringView name)
+{
+    struct Entry {
+        const QString *name;
+        Element element;
+    };
+
+    // Per-file elements first; they make up almost all of a large index
+    static const Entry table[] = {
+        {&ELEM_NAME, Element::Name},
+        {&ELEM_LENGTH, Element::Length},
+        {&ELEM_UID, Element::Uid},
+        {&ELEM_READONLY, Element::Readonly},
+        {&ELEM_CREATION_TIME, Element::CreationTime},
+        {&ELEM_CHANGE_TIME, Element::ChangeTime},
+        {&ELEM_MODIFY_TIME, Element::ModifyTime},
+        {&ELEM_ACCESS_TIME, Element::AccessTime},
+        {&ELEM_BACKUP_TIME, Element::BackupTime},
+        {&ELEM_FILE, Element::File},
+        {&ELEM_EXTENT_INFO, Element::ExtentInfo},
+        {&ELEM_EXTENT, Element::Extent},
+        {&ELEM_PARTITION, Element::Partition},
+        {&ELEM_STARTBLOCK, Element::StartBlock},
+        {&ELEM_FILE_OFFSET, Element::FileOffset},
+        {&ELEM_BYTE_OFFSET, Element::ByteOffset},
+        {&ELEM_BYTE_COUNT, Element::ByteCount},
+        {&ELEM_EXTENDED_ATTRIBUTE, Element::ExtendedAttribute},
+        {&ELEM_EA_KEY, Element::Key},
+        {&ELEM_EA_VALUE, Element::Value},
+        {&ELEM_DIRECTORY, Element::Directory},
+        {&ELEM_CONTENTS, Element::Contents},
+        {&ELEM_LTFSINDEX, Element::LtfsIndex},
+        {&ELEM_CREATOR, Element::Creator},
+        {&ELEM_VOLUME_UUID, Element::VolumeUuid},
+        {&ELEM_GENERATION, Element::Generation},
+        {&ELEM_UPDATE_TIME, Element::UpdateTime},
+        {&ELEM_LOCATION, Element::Location},
+        {&ELEM_PREVIOUS_GENERATION, Element::PreviousGeneration},
+        {&ELEM_ALLOW_POLICY_UPDATE, Element::AllowPolicyUpdate},
+        {&ELEM_HIGHEST_FILE_UID, Element::HighestFileUid},
+    };
+
+    for (const Entry &entry : table) {
+        if (entry.name->size() == name.size() && *entry.name == name) {
+            return entry.element;
+        }
+    }
+    return Element::Unknown;
+}
+
+/**
+ * @brief Parse a non-negative decimal number (0 if the text is not one)
+ */
+quint64 toUnsigned(QStringView text)
+{
+    text = text.trimmed();
+    if (text.isEmpty()) {
+        return 0;
+    }
+
+    quint64 value = 0;
+    for (QChar c : text) {
+        if (c < QLatin1Char('0') || c > QLatin1Char('9')) {
+            return 0;
+        }
+        value = value * 10 + (c.unicode() - '0');
+    }
+    return value;
+}
+
+qint64 toSigned(QStringView text)
+{
+    text = text.trimmed();
+    if (text.startsWith(QLatin1Char('-'))) {
+        return -static_cast<qint64>(toUnsigned(text.mid(1)));
+    }
+    return static_cast<qint64>(toUnsigned(text));
+}
+
+bool toBoolean(QStringView text)
+{
+    return text.trimmed().compare(QLatin1String("true"), Qt::CaseInsensitive) == 0;
+}
+
+PartitionLabel toPartition(QStringView text)
+{
+    text = text.trimmed();
+    if (text.compare(QLatin1String("a"), Qt::CaseInsensitive) == 0 || text == QLatin1String("0")) {
+        return PartitionLabel::IndexPartition;
+    }
+    return PartitionLabel::DataPartition;  // Default
+}
+
+/**
+ * @brief Days from 1970-01-01 to a proleptic Gregorian date
+ */
+qint64 daysFromCivil(qint64 year, int month, int day)
+{
+    year -= month <= 2 ? 1 : 0;
+    const qint64 era = (year >= 0 ? year : year - 399) / 400;
+    const qint64 yearOfEra = year - era * 400;
+    const qint64 dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    const qint64 dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + dayOfEra - 719468;
+}
+
+/**
+ * @brief Timestamp in nanoseconds, trying the LTFS format first
+ */
+qint64 toTimestamp(QStringView text)
+{
+    qint64 nanoseconds;
+    if (IndexParser::parseLtfsTimestamp(text, nanoseconds)) {
+        return nanoseconds;
+    }
+
+    QDateTime dt = QDateTime::fromString(text.toString(), Qt::ISODateWithMs);
+    if (!dt.isValid()) {
+        dt = QDateTime::fromString(text.toString(), Qt::ISODate);
+    }
+    if (!dt.isValid()) {
+        qWarning() << "Failed to parse timestamp:" << text;
+        return CompactIndex::NO_TIME;
+    }
+    return dt.toMSecsSinceEpoch() * 1000000;
+}
+
+} // namespace
+
 // ============================================================================
 // IndexParser Private Implementation
 // ============================================================================
@@ -74,6 +249,11 @@ public:
     int errorColumn = 0;
     bool hasError = false;
 
+    QString text;   ///< Element text buffer reused by the compact parser
+
+    QStringView readText(QXmlStreamReader &xml);
+    bool parseCompact(QXmlStreamReader &xml, CompactIndex &index);
+
     void setError(const QString &msg, int line = 0, int column = 0)
     {
         errorMessage = msg;
@@ -91,6 +271,245 @@ public:
     }
 };
 
+QStringView IndexParser::Private::readText(QXmlStreamReader &xml)
+{
+    // Same as readElementText(SkipChildElements), but into a reused buffer
+    text.resize(0);
+    while (!xml.atEnd()) {
+        QXmlStreamReader::TokenType token = xml.readNext();
+        if (token == QXmlStreamReader::Characters || token == QXmlStreamReader::EntityReference) {
+            text.append(xml.text());
+        } else if (token == QXmlStreamReader::StartElement) {
+            xml.skipCurrentElement();
+        } else if (token == QXmlStreamReader::EndElement || token == QXmlStreamReader::Invalid) {
+            break;
+        }
+    }
+    return text;
+}
+
+bool IndexParser::Private::parseCompact(QXmlStreamReader &xml, CompactIndex &index)
+{
+    // Nesting is tracked on an explicit stack, so deep directory trees
+    // need no recursion. Elements not in the token table (the LTFS
+    // <contents> wrapper, policies) are passed through transparently.
+    struct Frame {
+        Element element;
+        quint32 record;     ///< Directory or file index; 0/1 = self/previous location
+        QVector<CompactIndex::Attribute> attributes;    ///< Pending attributes of a directory
+    };
+
+    QVector<Frame> stack;
+    stack.reserve(64);
+
+    CompactIndex::Header &header = index.header();
+    CompactIndex::Extent extent;
+    CompactIndex::Attribute attribute;
+
+    auto ownerOf = [&stack]() -> Frame & { return stack[stack.size() - 2]; };
+    auto timesOf = [&index](const Frame &frame) -> CompactIndex::Times & {
+        return frame.element == Element::File ? index.file(frame.record).times
+                                              : index.directory(frame.record).times;
+    };
+
+    while (!xml.atEnd()) {
+        QXmlStreamReader::TokenType token = xml.readNext();
+
+        if (token == QXmlStreamReader::EndElement) {
+            if (stack.isEmpty() || elementToken(xml.name()) != stack.last().element) {
+                continue;
+            }
+
+            Frame &top = stack.last();
+            switch (top.element) {
+            case Element::Directory: {
+                // Attributes of a directory may be interleaved with its
+                // children's, so they are stored once it is complete
+                CompactIndex::Directory &directory = index.directory(top.record);
+                directory.firstAttribute = static_cast<quint32>(index.attributeCount());
+                directory.attributeCount = static_cast<quint32>(top.attributes.size());
+                for (const auto &attr : top.attributes) {
+                    index.addAttribute(attr.key, attr.value);
+                }
+                break;
+            }
+            case Element::Extent:
+                if (ownerOf().element == Element::File) {
+                    index.addExtent(ownerOf().record, extent);
+                }
+                break;
+            case Element::ExtendedAttribute: {
+                Frame &owner = ownerOf();
+                if (owner.element == Element::File) {
+                    index.addAttribute(attribute.key, attribute.value);
+                    index.file(owner.record).attributeCount++;
+                } else if (owner.element == Element::Directory) {
+                    owner.attributes.append(attribute);
+                }
+                break;
+            }
+            default:
+                break;
+            }
+
+            stack.removeLast();
+            continue;
+        }
+
+        if (token != QXmlStreamReader::StartElement) {
+            continue;
+        }
+
+        const Element element = elementToken(xml.name());
+        const Element context = stack.isEmpty() ? Element::Unknown : stack.last().element;
+
+        switch (context) {
+        case Element::Unknown:
+            if (element == Element::LtfsIndex) {
+                header.version = xml.attributes().value(ATTR_VERSION).toString();
+                stack.append({element, 0, {}});
+            }
+            break;
+
+        case Element::LtfsIndex:
+            switch (element) {
+            case Element::Creator: header.creator = readText(xml).toString(); break;
+            case Element::VolumeUuid: header.volumeUuid = QUuid::fromString(readText(xml)); break;
+            case Element::Generation: header.generationNumber = toUnsigned(readText(xml)); break;
+            case Element::UpdateTime: header.updateTime = toTimestamp(readText(xml)); break;
+            case Element::AllowPolicyUpdate: header.allowPolicyUpdate = toBoolean(readText(xml)); break;
+            case Element::HighestFileUid: header.highestFileUid = toUnsigned(readText(xml)); break;
+            case Element::Location: stack.append({element, 0, {}}); break;
+            case Element::PreviousGeneration: stack.append({element, 1, {}}); break;
+            case Element::Directory:
+                if (index.directoryCount() == 0) {
+                    stack.append({element, index.addDirectory(CompactIndex::NONE), {}});
+                } else {
+                    xml.skipCurrentElement();
+                }
+                break;
+            default: break;
+            }
+            break;
+
+        case Element::Location:
+        case Element::PreviousGeneration: {
+            LocationData &location = stack.last().record == 0 ? header.selfLocation
+                                                              : header.previousGenerationLocation;
+            if (element == Element::Partition) {
+                location.partition = toPartition(readText(xml));
+            } else if (element == Element::StartBlock) {
+                location.startBlock = toUnsigned(readText(xml));
+            }
+            break;
+        }
+
+        case Element::Directory:
+        case Element::File: {
+            Frame &top = stack.last();
+            const bool isFile = context == Element::File;
+            switch (element) {
+            case Element::Name: {
+                CompactIndex::StringRef name = index.addString(readText(xml));
+                if (isFile) {
+                    index.file(top.record).name = name;
+                } else {
+                    index.directory(top.record).name = name;
+                }
+                break;
+            }
+            case Element::Readonly: {
+                bool readonly = toBoolean(readText(xml));
+                if (isFile) {
+                    index.file(top.record).readonly = readonly;
+                } else {
+                    index.directory(top.record).readonly = readonly;
+                }
+                break;
+            }
+            case Element::Uid: {
+                quint64 uid = toUnsigned(readText(xml));
+                if (isFile) {
+                    index.file(top.record).uid = uid;
+                } else {
+                    index.directory(top.record).uid = uid;
+                }
+                break;
+            }
+            case Element::CreationTime: timesOf(top).creation = toTimestamp(readText(xml)); break;
+            case Element::ChangeTime: timesOf(top).change = toTimestamp(readText(xml)); break;
+            case Element::ModifyTime: timesOf(top).modify = toTimestamp(readText(xml)); break;
+            case Element::AccessTime: timesOf(top).access = toTimestamp(readText(xml)); break;
+            case Element::BackupTime: timesOf(top).backup = toTimestamp(readText(xml)); break;
+            case Element::Length:
+                if (isFile) {
+                    index.file(top.record).length = toSigned(readText(xml));
+                }
+                break;
+            case Element::Extent:
+                if (isFile) {
+                    extent = CompactIndex::Extent();
+                    stack.append({element, top.record, {}});
+                }
+                break;
+            case Element::ExtendedAttribute:
+                attribute = CompactIndex::Attribute();
+                stack.append({element, top.record, {}});
+                break;
+            case Element::File:
+                if (!isFile) {
+                    stack.append({element, index.addFile(top.record), {}});
+                }
+                break;
+            case Element::Directory:
+                if (!isFile) {
+                    stack.append({element, index.addDirectory(top.record), {}});
+                }
+                break;
+            default:
+                break;
+            }
+            break;
+        }
+
+        case Element::Extent:
+            switch (element) {
+            case Element::Partition: extent.partition = toPartition(readText(xml)); break;
+            case Element::StartBlock: extent.startBlock = toUnsigned(readText(xml)); break;
+            case Element::FileOffset: extent.fileOffset = toSigned(readText(xml)); break;
+            case Element::ByteOffset: extent.byteOffset = toSigned(readText(xml)); break;
+            case Element::ByteCount: extent.byteCount = toSigned(readText(xml)); break;
+            default: break;
+            }
+            break;
+
+        case Element::ExtendedAttribute:
+            if (element == Element::Key) {
+                attribute.key = index.internString(readText(xml));
+            } else if (element == Element::Value) {
+                attribute.value = index.addString(readText(xml));
+            }
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    if (xml.hasError()) {
+        setError(xml.errorString(),
+                 static_cast<int>(xml.lineNumber()),
+                 static_cast<int>(xml.columnNumber()));
+        return false;
+    }
+
+    if (index.directoryCount() == 0) {
+        index.addDirectory(CompactIndex::NONE);
+    }
+    index.squeeze();
+    return true;
+}
+
 // ============================================================================
 // IndexParser Implementation
 // ============================================================================
@@ -107,6 +526,9 @@ IndexParser::~IndexParser()
 
 QSharedPointer<LtfsIndex> IndexParser::parse(const QByteArray &xmlData)
 {
+    TraceSpan span("index", "parse");
+    span.setArg("bytes", xmlData.size());
+
     d->clearError();
 
     QXmlStreamReader xml(xmlData);
@@ -150,6 +572,107 @@ QSharedPointer<LtfsIndex> IndexParser::parseFile(const QString &filePath)
     return parse(data);
 }
 
+QSharedPointer<CompactIndex> IndexParser::parseCompact(const QByteArray &xmlData)
+{
+    TraceSpan span("index", "parseCompact");
+    span.setArg("bytes", xmlData.size());
+
+    d->clearError();
+
+    QXmlStreamReader xml(xmlData);
+    auto index = QSharedPointer<CompactIndex>::create();
+    if (!d->parseCompact(xml, *index)) {
+        return nullptr;
+    }
+    return index;
+}
+
+QSharedPointer<CompactIndex> IndexParser::parseCompactFile(const QString &filePath)
+{
+    QLTFS_TRACE_SPAN("index", "parseCompactFile");
+
+    d->clearError();
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        d->setError(QStringLiteral("Failed to open file: %1").arg(file.errorString()));
+        return nullptr;
+    }
+
+    QXmlStreamReader xml(&file);
+    auto index = QSharedPointer<CompactIndex>::create();
+    if (!d->parseCompact(xml, *index)) {
+        return nullptr;
+    }
+    return index;
+}
+
+bool IndexParser::parseLtfsTimestamp(QStringView text, qint64 &nanoseconds)
+{
+    // YYYY-MM-DDThh:mm:ss[.f...]Z, fixed positions up to the seconds
+    const qsizetype size = text.size();
+    if (size < 20) {
+        return false;
+    }
+
+    bool ok = true;
+    auto field = [&text, &ok](qsizetype pos, int count) {
+        int value = 0;
+        for (int i = 0; i < count; ++i) {
+            const char16_t c = text[pos + i].unicode();
+            if (c < u'0' || c > u'9') {
+                ok = false;
+                return 0;
+            }
+            value = value * 10 + (c - u'0');
+        }
+        return value;
+    };
+
+    const int year = field(0, 4);
+    const int month = field(5, 2);
+    const int day = field(8, 2);
+    const int hour = field(11, 2);
+    const int minute = field(14, 2);
+    const int second = field(17, 2);
+    if (!ok || text[4] != u'-' || text[7] != u'-' || text[10] != u'T' ||
+        text[13] != u':' || text[16] != u':') {
+        return false;
+    }
+    if (month < 1 || month > 12 || day < 1 || day > 31 || hour > 23 || minute > 59 || second > 60) {
+        return false;
+    }
+
+    qsizetype pos = 19;
+    qint64 fraction = 0;
+    if (text[pos] == u'.') {
+        ++pos;
+        int digits = 0;
+        while (pos < size && text[pos] >= u'0' && text[pos] <= u'9') {
+            // Digits beyond nanoseconds are dropped
+            if (digits < 9) {
+                fraction = fraction * 10 + (text[pos].unicode() - u'0');
+                ++digits;
+            }
+            ++pos;
+        }
+        if (digits == 0) {
+            return false;
+        }
+        for (; digits < 9; ++digits) {
+            fraction *= 10;
+        }
+    }
+
+    if (pos != size - 1 || text[pos] != u'Z') {
+        return false;
+    }
+
+    const qint64 seconds = daysFromCivil(year, month, day) * 86400 + hour * 3600 + minute * 60 + second;
+    nanoseconds = seconds * 1000000000 + fraction;
+    return true;
+}
+
 QString IndexParser::errorMessage() const
 {
     return d->errorMessage;
@@ -182,7 +705,7 @@ void IndexParser::parseIndex(QXmlStreamReader &xml, LtfsIndex &index)
         }
 
         if (token == QXmlStreamReader::StartElement) {
-            QString name = xml.name().toString();
+            const QStringView name = xml.name();
 
             if (name == ELEM_CREATOR) {
                 index.setCreator(readElementText(xml));
@@ -215,17 +738,22 @@ void IndexParser::parseIndex(QXmlStreamReader &xml, LtfsIndex &index)
 
 void IndexParser::parseDirectory(QXmlStreamReader &xml, LtfsDirectory &directory)
 {
+    QList<ExtendedAttribute> attributes;
+
     while (!xml.atEnd() && !xml.hasError()) {
         QXmlStreamReader::TokenType token = xml.readNext();
 
         if (token == QXmlStreamReader::EndElement) {
             if (xml.name() == ELEM_DIRECTORY) {
+                if (!attributes.isEmpty()) {
+                    directory.setExtendedAttributes(attributes);
+                }
                 return;
             }
         }
 
         if (token == QXmlStreamReader::StartElement) {
-            QString name = xml.name().toString();
+            const QStringView name = xml.name();
 
             if (name == ELEM_NAME) {
                 directory.setName(readElementText(xml));
@@ -254,9 +782,7 @@ void IndexParser::parseDirectory(QXmlStreamReader &xml, LtfsDirectory &directory
             } else if (name == ELEM_EXTENDED_ATTRIBUTE) {
                 ExtendedAttribute attr;
                 parseExtendedAttribute(xml, attr);
-                QList<ExtendedAttribute> attrs = directory.extendedAttributes();
-                attrs.append(attr);
-                directory.setExtendedAttributes(attrs);
+                attributes.append(attr);
             }
         }
     }
@@ -265,6 +791,7 @@ void IndexParser::parseDirectory(QXmlStreamReader &xml, LtfsDirectory &directory
 void IndexParser::parseFile(QXmlStreamReader &xml, LtfsFile &file)
 {
     QList<LtfsExtent> extents;
+    QList<ExtendedAttribute> attributes;
 
     while (!xml.atEnd() && !xml.hasError()) {
         QXmlStreamReader::TokenType token = xml.readNext();
@@ -272,12 +799,15 @@ void IndexParser::parseFile(QXmlStreamReader &xml, LtfsFile &file)
         if (token == QXmlStreamReader::EndElement) {
             if (xml.name() == ELEM_FILE) {
                 file.setExtentInfo(extents);
+                if (!attributes.isEmpty()) {
+                    file.setExtendedAttributes(attributes);
+                }
                 return;
             }
         }
 
         if (token == QXmlStreamReader::StartElement) {
-            QString name = xml.name().toString();
+            const QStringView name = xml.name();
 
             if (name == ELEM_NAME) {
                 file.setName(readElementText(xml));
@@ -306,9 +836,7 @@ void IndexParser::parseFile(QXmlStreamReader &xml, LtfsFile &file)
             } else if (name == ELEM_EXTENDED_ATTRIBUTE) {
                 ExtendedAttribute attr;
                 parseExtendedAttribute(xml, attr);
-                QList<ExtendedAttribute> attrs = file.extendedAttributes();
-                attrs.append(attr);
-                file.setExtendedAttributes(attrs);
+                attributes.append(attr);
             }
         }
     }
@@ -326,7 +854,7 @@ void IndexParser::parseExtent(QXmlStreamReader &xml, LtfsExtent &extent)
         }
 
         if (token == QXmlStreamReader::StartElement) {
-            QString name = xml.name().toString();
+            const QStringView name = xml.name();
 
             if (name == ELEM_PARTITION) {
                 extent.setPartition(parsePartition(readElementText(xml)));
@@ -355,7 +883,7 @@ void IndexParser::parseExtendedAttribute(QXmlStreamReader &xml, ExtendedAttribut
         }
 
         if (token == QXmlStreamReader::StartElement) {
-            QString name = xml.name().toString();
+            const QStringView name = xml.name();
 
             if (name == ELEM_EA_KEY) {
                 attr.key = readElementText(xml);
@@ -379,7 +907,7 @@ void IndexParser::parseLocation(QXmlStreamReader &xml, LocationData &location)
         }
 
         if (token == QXmlStreamReader::StartElement) {
-            QString name = xml.name().toString();
+            const QStringView name = xml.name();
 
             if (name == ELEM_PARTITION) {
                 location.partition = parsePartition(readElementText(xml));
@@ -398,7 +926,12 @@ QString IndexParser::readElementText(QXmlStreamReader &xml)
 QDateTime IndexParser::parseTimestamp(const QString &text)
 {
     // LTFS uses ISO 8601 format: 2024-01-15T12:30:45.123456Z
-    // Try various formats
+    qint64 nanoseconds;
+    if (parseLtfsTimestamp(text, nanoseconds)) {
+        return CompactIndex::toDateTime(nanoseconds);
+    }
+
+    // Fall back to the other accepted formats
 
     // Full precision with microseconds
     QDateTime dt = QDateTime::fromString(text, Qt::ISODateWithMs);
@@ -435,13 +968,7 @@ QDateTime IndexParser::parseTimestamp(const QString &text)
 
 PartitionLabel IndexParser::parsePartition(const QString &text)
 {
-    QString lower = text.toLower().trimmed();
-    if (lower == QLatin1String("a") || lower == QLatin1String("0")) {
-        return PartitionLabel::IndexPartition;
-    } else if (lower == QLatin1String("b") || lower == QLatin1String("1")) {
-        return PartitionLabel::DataPartition;
-    }
-    return PartitionLabel::DataPartition;  // Default
+    return toPartition(text);
 }
 
 } // namespace qltfs
@@ -24,8 +24,10 @@
 #include "libqltfs_global.h"
 #include "core/LtfsTypes.h"
 #include "core/LtfsIndex.h"
+#include "core/CompactIndex.h"
 
 #include <QString>
+#include <QStringView>
 #include <QByteArray>
 #include <QXmlStreamReader>
 #include <QSharedPointer>
@@ -37,6 +39,11 @@ namespace qltfs {
  *
  * Parses LTFS index XML documents according to the LTFS specification.
  * Supports both reading from files and parsing from byte arrays.
+ *
+ * parseCompact() is the mode for very large indexes: it streams the XML,
+ * matches element names against a fixed token table without creating
+ * strings, decodes timestamps with a fixed-format parser and builds a
+ * CompactIndex instead of an LtfsIndex value tree.
  */
 class LIBQLTFS_EXPORT IndexParser
 {
@@ -62,6 +69,36 @@ public:
      */
     QSharedPointer<LtfsIndex> parseFile(const QString &filePath);
 
+    /**
+     * @brief Parse index from XML data into a compact representation
+     * @param xmlData Raw XML data
+     * @return Parsed index, or null on error
+     */
+    QSharedPointer<CompactIndex> parseCompact(const QByteArray &xmlData);
+
+    /**
+     * @brief Parse index from a file into a compact representation
+     *
+     * The file is streamed; it is never loaded into memory as a whole.
+     *
+     * @param filePath Path to XML file
+     * @return Parsed index, or null on error
+     */
+    QSharedPointer<CompactIndex> parseCompactFile(const QString &filePath);
+
+    /**
+     * @brief Parse an LTFS timestamp (YYYY-MM-DDThh:mm:ss[.fraction]Z)
+     *
+     * Accepts exactly the fixed UTC format LTFS writes, with up to nine
+     * fraction digits; anything else is rejected so callers can fall back
+     * to a general parser.
+     *
+     * @param text Timestamp text
+     * @param nanoseconds Receives nanoseconds since the Unix epoch
+     * @return true if the text was in the LTFS format
+     */
+    static bool parseLtfsTimestamp(QStringView text, qint64 &nanoseconds);
+
     /**
      * @brief Get last error message
      */
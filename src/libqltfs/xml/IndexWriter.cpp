@@ -20,10 +20,14 @@
  */
 
 #include "IndexWriter.h"
+#include "../util/Tracer.h"
 
 #include <QFile>
+#include <QHash>
 #include <QDebug>
 
+#include <cstring>
+
 namespace qltfs {
 
 // XML element names as per LTFS spec
@@ -63,6 +67,237 @@ static const QString ELEM_UID = QStringLiteral("uid");
 static const QString ATTR_VERSION = QStringLiteral("version");
 static const QString LTFS_NAMESPACE = QStringLiteral("http://www.lto.org/ltfs");
 
+namespace {
+
+// Text output for writeBlocks(). Produces the same layout as
+// QXmlStreamWriter with auto-formatting (indent 2) but appends straight
+// into a reused buffer without per-element allocations.
+
+void appendUnsigned(QString &out, quint64 value, int width = 1)
+{
+    char16_t digits[20];
+    int count = 0;
+    do {
+        digits[count++] = static_cast<char16_t>(u'0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+
+    for (int i = count; i < width; ++i) {
+        out += QLatin1Char('0');
+    }
+    while (count > 0) {
+        out += QChar(digits[--count]);
+    }
+}
+
+void appendSigned(QString &out, qint64 value)
+{
+    if (value < 0) {
+        out += QLatin1Char('-');
+        appendUnsigned(out, 0 - static_cast<quint64>(value));
+    } else {
+        appendUnsigned(out, static_cast<quint64>(value));
+    }
+}
+
+void appendEscaped(QString &out, QStringView text, bool attribute = false)
+{
+    for (QChar c : text) {
+        switch (c.unicode()) {
+        case u'<': out += QLatin1String("&lt;"); break;
+        case u'>': out += QLatin1String("&gt;"); break;
+        case u'&': out += QLatin1String("&amp;"); break;
+        case u'\r': out += QLatin1String("&#13;"); break;
+        case u'"':
+            if (attribute) {
+                out += QLatin1String("&quot;");
+                break;
+            }
+            out += c;
+            break;
+        default:
+            out += c;
+            break;
+        }
+    }
+}
+
+/**
+ * @brief Append an LTFS timestamp (same format as formatTimestamp())
+ */
+void appendTimestamp(QString &out, const QDateTime &dt)
+{
+    const qint64 msecs = (dt.isValid() ? dt : QDateTime::currentDateTimeUtc()).toMSecsSinceEpoch();
+    constexpr qint64 MSECS_PER_DAY = 86400000;
+
+    qint64 days = msecs / MSECS_PER_DAY;
+    qint64 rest = msecs % MSECS_PER_DAY;
+    if (rest < 0) {
+        rest += MSECS_PER_DAY;
+        days--;
+    }
+
+    // Civil date from days since 1970-01-01 (proleptic Gregorian)
+    days += 719468;
+    const qint64 era = (days >= 0 ? days : days - 146096) / 146097;
+    const qint64 dayOfEra = days - era * 146097;
+    const qint64 yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    const qint64 dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    const qint64 mp = (5 * dayOfYear + 2) / 153;
+    const int day = static_cast<int>(dayOfYear - (153 * mp + 2) / 5 + 1);
+    const int month = static_cast<int>(mp < 10 ? mp + 3 : mp - 9);
+    const qint64 year = yearOfEra + era * 400 + (month <= 2 ? 1 : 0);
+
+    if (year < 0) {
+        out += QLatin1Char('-');
+    }
+    appendUnsigned(out, static_cast<quint64>(year < 0 ? -year : year), 4);
+    out += QLatin1Char('-');
+    appendUnsigned(out, month, 2);
+    out += QLatin1Char('-');
+    appendUnsigned(out, day, 2);
+    out += QLatin1Char('T');
+    appendUnsigned(out, rest / 3600000, 2);
+    out += QLatin1Char(':');
+    appendUnsigned(out, rest / 60000 % 60, 2);
+    out += QLatin1Char(':');
+    appendUnsigned(out, rest / 1000 % 60, 2);
+
+    const int msec = static_cast<int>(rest % 1000);
+    if (msec > 0) {
+        out += QLatin1Char('.');
+        appendUnsigned(out, msec, 3);
+    }
+    out += QLatin1Char('Z');
+}
+
+QLatin1String partitionName(PartitionLabel partition)
+{
+    return partition == PartitionLabel::IndexPartition ? QLatin1String("a") : QLatin1String("b");
+}
+
+QLatin1String booleanName(bool value)
+{
+    return value ? QLatin1String("true") : QLatin1String("false");
+}
+
+/**
+ * @brief QString builder for one part of the streamed document
+ */
+class XmlText
+{
+public:
+    XmlText(QString &out, bool formatted)
+        : m_out(out)
+        , m_formatted(formatted)
+    {
+    }
+
+    void startElement(int depth, const QString &name)
+    {
+        indent(depth);
+        m_out += QLatin1Char('<');
+        m_out += name;
+        m_out += QLatin1Char('>');
+        newline();
+    }
+
+    void endElement(int depth, const QString &name)
+    {
+        indent(depth);
+        m_out += QLatin1String("</");
+        m_out += name;
+        m_out += QLatin1Char('>');
+        newline();
+    }
+
+    /** @brief Start a text element; the caller appends the text and calls close() */
+    QString &open(int depth, const QString &name)
+    {
+        indent(depth);
+        m_out += QLatin1Char('<');
+        m_out += name;
+        m_out += QLatin1Char('>');
+        return m_out;
+    }
+
+    void close(const QString &name)
+    {
+        m_out += QLatin1String("</");
+        m_out += name;
+        m_out += QLatin1Char('>');
+        newline();
+    }
+
+    void text(int depth, const QString &name, QStringView value)
+    {
+        appendEscaped(open(depth, name), value);
+        close(name);
+    }
+
+    void text(int depth, const QString &name, QLatin1String value)
+    {
+        open(depth, name) += value;
+        close(name);
+    }
+
+    void number(int depth, const QString &name, quint64 value)
+    {
+        appendUnsigned(open(depth, name), value);
+        close(name);
+    }
+
+    void signedNumber(int depth, const QString &name, qint64 value)
+    {
+        appendSigned(open(depth, name), value);
+        close(name);
+    }
+
+    void timestamp(int depth, const QString &name, const QDateTime &value)
+    {
+        appendTimestamp(open(depth, name), value);
+        close(name);
+    }
+
+    void attribute(int depth, const ExtendedAttribute &attr)
+    {
+        startElement(depth, ELEM_EXTENDED_ATTRIBUTE);
+        text(depth + 1, ELEM_EA_KEY, attr.key);
+        text(depth + 1, ELEM_EA_VALUE, attr.value);
+        endElement(depth, ELEM_EXTENDED_ATTRIBUTE);
+    }
+
+    void location(int depth, const QString &name, const LocationData &location)
+    {
+        startElement(depth, name);
+        text(depth + 1, ELEM_PARTITION, partitionName(location.partition));
+        number(depth + 1, ELEM_STARTBLOCK, location.startBlock);
+        endElement(depth, name);
+    }
+
+private:
+    void indent(int depth)
+    {
+        if (m_formatted) {
+            for (int i = 0; i < depth; ++i) {
+                m_out += QLatin1String("  ");
+            }
+        }
+    }
+
+    void newline()
+    {
+        if (m_formatted) {
+            m_out += QLatin1Char('\n');
+        }
+    }
+
+    QString &m_out;
+    bool m_formatted;
+};
+
+} // namespace
+
 // ============================================================================
 // IndexWriter Private Implementation
 // ============================================================================
@@ -72,8 +307,181 @@ class IndexWriter::Private
 public:
     bool formatted = true;
     QString errorMessage;
+
+    /**
+     * @brief Serialized entries of one directory (everything before its subdirectories)
+     */
+    struct CachedDirectory {
+        QByteArray head;
+        qsizetype fileCount = 0;
+        qint64 changeTime = 0;
+        qint64 modifyTime = 0;
+        quint64 pass = 0;           ///< Last writeBlocks() call that used this entry
+    };
+
+    QHash<QString, CachedDirectory> cache;
+    quint64 pass = 0;
+    QString text;                   ///< Reused text buffer
+
+    // Block output of writeBlocks()
+    QByteArray block;
+    qsizetype blockFill = 0;
+    const IndexBlockSink *sink = nullptr;
+    bool sinkFailed = false;
+
+    void output(const char *data, qsizetype length);
+    void output(const QByteArray &data) { output(data.constData(), data.size()); }
+    void outputText();
+    bool finishOutput();
+
+    void streamDirectory(const LtfsDirectory &directory, const QString &path, int depth);
+    void serializeHead(const LtfsDirectory &directory, int depth);
+
+    static QString cacheKey(const QString &path);
 };
 
+void IndexWriter::Private::output(const char *data, qsizetype length)
+{
+    while (length > 0 && !sinkFailed) {
+        const qsizetype count = qMin(length, block.size() - blockFill);
+        memcpy(block.data() + blockFill, data, count);
+        blockFill += count;
+        data += count;
+        length -= count;
+
+        if (blockFill == block.size()) {
+            sinkFailed = !(*sink)(block.constData(), blockFill);
+            blockFill = 0;
+        }
+    }
+}
+
+void IndexWriter::Private::outputText()
+{
+    output(text.toUtf8());
+    text.resize(0);
+}
+
+bool IndexWriter::Private::finishOutput()
+{
+    if (blockFill > 0 && !sinkFailed) {
+        sinkFailed = !(*sink)(block.constData(), blockFill);
+    }
+    blockFill = 0;
+    sink = nullptr;
+    block = QByteArray();
+
+    if (sinkFailed) {
+        errorMessage = QStringLiteral("Index block sink failed");
+        return false;
+    }
+    return true;
+}
+
+void IndexWriter::Private::streamDirectory(const LtfsDirectory &directory, const QString &path, int depth)
+{
+    const qint64 changeTime = directory.changeTime().toMSecsSinceEpoch();
+    const qint64 modifyTime = directory.modifyTime().toMSecsSinceEpoch();
+
+    auto it = cache.find(path);
+    if (it == cache.end() || it->fileCount != directory.files().size() ||
+        it->changeTime != changeTime || it->modifyTime != modifyTime) {
+        serializeHead(directory, depth);
+
+        CachedDirectory entry;
+        entry.head = text.toUtf8();
+        entry.fileCount = directory.files().size();
+        entry.changeTime = changeTime;
+        entry.modifyTime = modifyTime;
+        text.resize(0);
+        it = cache.insert(path, entry);
+    }
+    it->pass = pass;
+    output(it->head);
+
+    // The cache may rehash while subdirectories are added
+    it = cache.end();
+
+    for (const auto &subdir : directory.subdirectories()) {
+        streamDirectory(subdir, path + QLatin1Char('/') + subdir.name(), depth + 1);
+    }
+
+    XmlText(text, formatted).endElement(depth, ELEM_DIRECTORY);
+    outputText();
+}
+
+void IndexWriter::Private::serializeHead(const LtfsDirectory &directory, int depth)
+{
+    // Same elements and order as IndexWriter::writeDirectory()/writeFile()
+    XmlText xml(text, formatted);
+
+    xml.startElement(depth, ELEM_DIRECTORY);
+    xml.text(depth + 1, ELEM_NAME, directory.name());
+    if (directory.uid() > 0) {
+        xml.number(depth + 1, ELEM_UID, directory.uid());
+    }
+    xml.text(depth + 1, ELEM_READONLY, booleanName(directory.readonly()));
+    xml.timestamp(depth + 1, ELEM_CREATION_TIME, directory.creationTime());
+    xml.timestamp(depth + 1, ELEM_CHANGE_TIME, directory.changeTime());
+    xml.timestamp(depth + 1, ELEM_MODIFY_TIME, directory.modifyTime());
+    xml.timestamp(depth + 1, ELEM_ACCESS_TIME, directory.accessTime());
+    if (directory.backupTime().isValid()) {
+        xml.timestamp(depth + 1, ELEM_BACKUP_TIME, directory.backupTime());
+    }
+    for (const auto &attr : directory.extendedAttributes()) {
+        xml.attribute(depth + 1, attr);
+    }
+
+    const int fileDepth = depth + 1;
+    for (const auto &file : directory.files()) {
+        xml.startElement(fileDepth, ELEM_FILE);
+        xml.text(fileDepth + 1, ELEM_NAME, file.name());
+        if (file.uid() > 0) {
+            xml.number(fileDepth + 1, ELEM_UID, file.uid());
+        }
+        xml.signedNumber(fileDepth + 1, ELEM_LENGTH, file.length());
+        xml.text(fileDepth + 1, ELEM_READONLY, booleanName(file.readonly()));
+        xml.timestamp(fileDepth + 1, ELEM_CREATION_TIME, file.creationTime());
+        xml.timestamp(fileDepth + 1, ELEM_CHANGE_TIME, file.changeTime());
+        xml.timestamp(fileDepth + 1, ELEM_MODIFY_TIME, file.modifyTime());
+        xml.timestamp(fileDepth + 1, ELEM_ACCESS_TIME, file.accessTime());
+        if (file.backupTime().isValid()) {
+            xml.timestamp(fileDepth + 1, ELEM_BACKUP_TIME, file.backupTime());
+        }
+        for (const auto &attr : file.extendedAttributes()) {
+            xml.attribute(fileDepth + 1, attr);
+        }
+
+        const auto &extents = file.extentInfo();
+        if (!extents.isEmpty()) {
+            const int extentDepth = fileDepth + 2;
+            xml.startElement(fileDepth + 1, ELEM_EXTENT_INFO);
+            for (const auto &extent : extents) {
+                xml.startElement(extentDepth, ELEM_EXTENT);
+                xml.text(extentDepth + 1, ELEM_PARTITION, partitionName(extent.partition()));
+                xml.number(extentDepth + 1, ELEM_STARTBLOCK, extent.startBlock());
+                xml.signedNumber(extentDepth + 1, ELEM_FILE_OFFSET, extent.fileOffset());
+                xml.signedNumber(extentDepth + 1, ELEM_BYTE_OFFSET, extent.byteOffset());
+                xml.signedNumber(extentDepth + 1, ELEM_BYTE_COUNT, extent.byteCount());
+                xml.endElement(extentDepth, ELEM_EXTENT);
+            }
+            xml.endElement(fileDepth + 1, ELEM_EXTENT_INFO);
+        }
+        xml.endElement(fileDepth, ELEM_FILE);
+    }
+}
+
+QString IndexWriter::Private::cacheKey(const QString &path)
+{
+    // Keys are "" for the root and "/a/b" below it
+    QString key;
+    for (const auto &part : QStringView(path).split(QLatin1Char('/'), Qt::SkipEmptyParts)) {
+        key += QLatin1Char('/');
+        key += part;
+    }
+    return key;
+}
+
 // ============================================================================
 // IndexWriter Implementation
 // ============================================================================
@@ -90,6 +498,9 @@ IndexWriter::~IndexWriter()
 
 void IndexWriter::setFormatted(bool formatted)
 {
+    if (d->formatted != formatted) {
+        d->cache.clear();
+    }
     d->formatted = formatted;
 }
 
@@ -100,6 +511,8 @@ bool IndexWriter::isFormatted() const
 
 QByteArray IndexWriter::write(const LtfsIndex &index)
 {
+    TraceSpan span("index", "write");
+
     QByteArray data;
     QXmlStreamWriter xml(&data);
 
@@ -112,6 +525,7 @@ QByteArray IndexWriter::write(const LtfsIndex &index)
 
     xml.writeEndDocument();
 
+    span.setArg("bytes", data.size());
     return data;
 }
 
@@ -154,6 +568,93 @@ bool IndexWriter::writeFile(const QSharedPointer<LtfsIndex> &index, const QStrin
     return writeFile(*index, filePath);
 }
 
+bool IndexWriter::writeBlocks(const LtfsIndex &index, quint32 blockSize, const IndexBlockSink &sink)
+{
+    QLTFS_TRACE_SPAN("index", "writeBlocks");
+
+    d->errorMessage.clear();
+
+    if (blockSize == 0 || !sink) {
+        d->errorMessage = QStringLiteral("Invalid block size or sink");
+        return false;
+    }
+
+    d->block = QByteArray(static_cast<qsizetype>(blockSize), Qt::Uninitialized);
+    d->blockFill = 0;
+    d->sink = &sink;
+    d->sinkFailed = false;
+    d->pass++;
+
+    // Document start and index header
+    d->text.resize(0);
+    d->text += QLatin1String("<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>");
+    if (d->formatted) {
+        d->text += QLatin1Char('\n');
+    }
+
+    d->text += QLatin1Char('<');
+    d->text += ELEM_LTFSINDEX;
+    d->text += QLatin1Char(' ');
+    d->text += ATTR_VERSION;
+    d->text += QLatin1String("=\"");
+    appendEscaped(d->text, index.version().isEmpty() ? QStringLiteral("2.4.0") : index.version(), true);
+    d->text += QLatin1String("\" xmlns=\"");
+    d->text += LTFS_NAMESPACE;
+    d->text += QLatin1String("\">");
+    if (d->formatted) {
+        d->text += QLatin1Char('\n');
+    }
+
+    XmlText xml(d->text, d->formatted);
+    xml.text(1, ELEM_CREATOR, index.creator());
+    xml.text(1, ELEM_VOLUME_UUID, index.volumeUuid().toString(QUuid::WithoutBraces));
+    xml.number(1, ELEM_GENERATION, index.generationNumber());
+    xml.timestamp(1, ELEM_UPDATE_TIME, index.updateTime());
+    xml.location(1, ELEM_LOCATION, index.selfLocation());
+    if (index.previousGenerationLocation().startBlock > 0) {
+        xml.location(1, ELEM_PREVIOUS_GENERATION, index.previousGenerationLocation());
+    }
+    xml.text(1, ELEM_ALLOW_POLICY_UPDATE, booleanName(index.allowPolicyUpdate()));
+    xml.number(1, ELEM_HIGHEST_FILE_UID, index.highestFileUid());
+    d->outputText();
+
+    // Directory tree, reusing unchanged directories
+    d->streamDirectory(index.rootDirectory(), QString(), 1);
+
+    xml.endElement(0, ELEM_LTFSINDEX);
+    d->outputText();
+
+    // Forget directories that no longer exist
+    for (auto it = d->cache.begin(); it != d->cache.end();) {
+        if (it->pass != d->pass) {
+            it = d->cache.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    return d->finishOutput();
+}
+
+void IndexWriter::invalidateDirectory(const QString &path)
+{
+    d->cache.remove(Private::cacheKey(path));
+}
+
+void IndexWriter::clearCache()
+{
+    d->cache.clear();
+}
+
+qint64 IndexWriter::cacheSize() const
+{
+    qint64 size = 0;
+    for (const auto &entry : d->cache) {
+        size += entry.head.size();
+    }
+    return size;
+}
+
 QString IndexWriter::errorMessage() const
 {
     return d->errorMessage;
@@ -326,21 +827,11 @@ QString IndexWriter::formatTimestamp(const QDateTime &dt)
     }
 
     // LTFS uses ISO 8601 format with 'Z' suffix for UTC
-    // Format: 2024-01-15T12:30:45.123456Z
-    QDateTime utc = dt.toUTC();
-
-    // Get microseconds precision
-    QString base = utc.toString(QStringLiteral("yyyy-MM-ddTHH:mm:ss"));
-
-    // Add milliseconds/microseconds
-    int msec = utc.time().msec();
-    if (msec > 0) {
-        base += QStringLiteral(".%1").arg(msec, 3, 10, QLatin1Char('0'));
-    }
-
-    base += QLatin1Char('Z');
-
-    return base;
+    // Format: 2024-01-15T12:30:45.123Z (milliseconds only when non-zero)
+    QString text;
+    text.reserve(24);
+    appendTimestamp(text, dt);
+    return text;
 }
 
 QString IndexWriter::formatPartition(PartitionLabel partition)
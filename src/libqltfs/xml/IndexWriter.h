@@ -30,12 +30,27 @@
 #include <QXmlStreamWriter>
 #include <QSharedPointer>
 
+#include <functional>
+
 namespace qltfs {
 
+/**
+ * @brief Receives a serialized index one tape block at a time
+ * @return false to abort writing
+ */
+using IndexBlockSink = std::function<bool(const char *data, qint64 length)>;
+
 /**
  * @brief Writer for LTFS index XML format
  *
  * Generates LTFS index XML documents according to the LTFS specification.
+ *
+ * writeBlocks() streams the document to a block sink instead of building
+ * it in memory, and keeps the serialized entries of each directory from
+ * the previous call. Directories whose file count and change/modify
+ * times are unchanged are emitted from that cache; call
+ * invalidateDirectory() after changing a directory in a way these do
+ * not reflect (e.g. updating extents or attributes of an existing file).
  */
 class LIBQLTFS_EXPORT IndexWriter
 {
@@ -83,6 +98,36 @@ public:
      */
     bool writeFile(const QSharedPointer<LtfsIndex> &index, const QString &filePath);
 
+    /**
+     * @brief Stream index to a block sink
+     *
+     * The sink receives full blocks of @p blockSize bytes and a final
+     * shorter block, so it can pass them straight to TapeDevice::writeBlock().
+     * Memory use is one block plus the directory cache.
+     *
+     * @param index Index to serialize
+     * @param blockSize Size of each block in bytes
+     * @param sink Receiver for the blocks
+     * @return true if successful
+     */
+    bool writeBlocks(const LtfsIndex &index, quint32 blockSize, const IndexBlockSink &sink);
+
+    /**
+     * @brief Drop the cached entries of a directory
+     * @param path Directory path relative to the root ("" or "/" is the root)
+     */
+    void invalidateDirectory(const QString &path);
+
+    /**
+     * @brief Drop all cached directory entries
+     */
+    void clearCache();
+
+    /**
+     * @brief Bytes held by the directory cache
+     */
+    qint64 cacheSize() const;
+
     /**
      * @brief Get last error message
      */